@@ -9,12 +9,28 @@
 #include "audio_engine.h"
 
 
-AudioEngine::AudioEngine(AAssetManager *amgr) {
-    assert(mOutputChannelCount == mInputChannelCount);
-    mgr = amgr;
+AudioEngine::AudioEngine(AAssetManager *amgr)
+        : triggerWordCallback(&mSoundRecording, amgr), vadCallback(&mSoundRecording, amgr), mgr(amgr) {
+    // The vad starts right after the trigger word, from the audio already recorded
+    triggerWordCallback.setTriggerListener([this](int64_t triggerEnd) {
+        vadCallback.startFrom(triggerEnd);
+        recordTriggerDirection(triggerWordCallback.getTriggerOnset(), triggerEnd);
+    });
+    triggerWordCallback.setEventRecorder(&eventRecorder);
+    getSessionRecorder().setAudioListener([this](int64_t firstSample, const float *samples, int32_t numSamples) {
+        writeReplayedAudio(firstSample, samples, numSamples);
+    });
+    rkai_echo_canceller_config_t echoConfig;
+    rkai_echo_canceller_default_config(mEchoSampleRate, &echoConfig);
+    mEchoCanceller = rkai_create_echo_canceller(&echoConfig);
+    if (mEchoCanceller == nullptr) {
+        LOGE(TAG, "Failed to create the echo canceller");
+    }
 }
 
 AudioEngine::~AudioEngine() {
+    getSessionRecorder().stopReplay();
+    getSessionRecorder().setAudioListener(nullptr);
     if (mRecordingStream != nullptr) {
         mRecordingStream->stop();
         mRecordingStream->close();
@@ -24,12 +40,18 @@ AudioEngine::~AudioEngine() {
         mPlaybackStream->stop();
         mPlaybackStream->close();
     }
+    rkai_release_echo_canceller(mEchoCanceller);
+    recordingCallback.setBeamformer(nullptr, nullptr, 1);
+    rkai_release_beamformer(mBeamformer);
 }
 
 void AudioEngine::startRecording() {
     LOGD(TAG, "startRecording() called");
     openRecordingStream();
     if (mRecordingStream != nullptr) {
+        bool isEchoRate = mRecordingStream->getSampleRate() == mEchoSampleRate;
+        recordingCallback.setEchoCanceller(isEchoRate ? mEchoCanceller : nullptr, &mPlaybackReference);
+        setUpBeamformer(mRecordingStream);
         startStream(mRecordingStream);
     } else {
         LOGE(TAG, "Failed to create recording stream (%p). Restart the app", mRecordingStream);
@@ -42,6 +64,18 @@ void AudioEngine::stopRecording() {
     LOGD(TAG, "stopRecording() called");
     stopStream(mRecordingStream);
     closeStream(mRecordingStream);
+    rkai_echo_canceller_stats_t echoStats;
+    if (rkai_echo_canceller_get_stats(mEchoCanceller, &echoStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("Echo canceller ran on %llu of %llu blocks, %llu with double talk, ERLE %.1f dB, delay %d samples",
+                 (unsigned long long) echoStats.echo_block_count, (unsigned long long) echoStats.block_count,
+                 (unsigned long long) echoStats.double_talk_count, echoStats.erle_db, echoStats.delay);
+    }
+    rkai_beamformer_stats_t beamStats;
+    if (mBeamformer != nullptr && rkai_beamformer_get_stats(mBeamformer, &beamStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("Beamformer made %llu direction estimates and moved %llu times, last at %.0f degrees",
+                 (unsigned long long) beamStats.estimate_count, (unsigned long long) beamStats.steer_count,
+                 beamStats.look_angle);
+    }
 }
 
 void AudioEngine::startPlayingRecordedStream() {
@@ -49,7 +83,7 @@ void AudioEngine::startPlayingRecordedStream() {
     openPlaybackStreamFromRecordedStreamParameters();
     if (mPlaybackStream != nullptr) {
         startStream(mPlaybackStream);
-//        triggerWordCallback.start();
+        triggerWordCallback.start();
         vadCallback.start();
     } else {
         LOGE(TAG, "Failed to create playback stream (%p). Restart the app", mPlaybackStream);
@@ -60,7 +94,8 @@ void AudioEngine::startPlayingRecordedStream() {
 void AudioEngine::stopPlayingRecordedStream() {
     LOGD(TAG, "stopPlayingRecordedStream() called");
     stopStream(mPlaybackStream);
-//    triggerWordCallback.stop();
+    // The trigger thread hands off to the vad, it is joined first so that no handoff restarts the stopped vad
+    triggerWordCallback.stop();
     vadCallback.stop();
     closeStream(mPlaybackStream);
     mSoundRecording.setReadPositionToStart();
@@ -89,13 +124,127 @@ void AudioEngine::writeToFile(const char *filePath) {
     mSoundRecording.initiateWritingToFile(filePath, mOutputChannelCount, mSampleRate);
 }
 
+bool AudioEngine::recordEvent(ClipReason reason) {
+    return eventRecorder.record(reason, mSoundRecording.getLength());
+}
+
+void AudioEngine::startReplay(const char *sessionPath, bool isPaced) {
+    LOGD(TAG, "startReplay() called");
+    getSessionRecorder().startReplay(sessionPath, isPaced);
+}
+
+void AudioEngine::setEchoCancellation(bool isEnabled) {
+    recordingCallback.setEchoCancelling(isEnabled);
+}
+
+void AudioEngine::setNoiseSuppression(bool isEnabled) {
+    triggerWordCallback.setNoiseSuppression(isEnabled);
+    vadCallback.setNoiseSuppression(isEnabled);
+}
+
+bool AudioEngine::setMicArray(const float *positions, int32_t micCount) {
+    if (micCount < 1 || micCount > RKAI_BEAMFORMER_MAX_CHANNELS || (micCount > 1 && positions == nullptr)) {
+        LOGE(TAG, "setMicArray(): %d microphones are not supported", micCount);
+        return false;
+    }
+    mMicPositions.assign(positions, positions + (micCount > 1 ? 2 * micCount : 0));
+    mInputChannelCount = micCount;
+    return true;
+}
+
+void AudioEngine::steerBeam(float angle) {
+    if (mBeamformer != nullptr) {
+        rkai_beamformer_steer(mBeamformer, angle);
+    }
+}
+
+bool AudioEngine::getTriggerDirection(rkai_beamformer_direction_t *direction) {
+    std::lock_guard<std::mutex> lock(mDirectionMutex);
+    *direction = mTriggerDirection;
+    return direction->estimate_count > 0;
+}
+
+void AudioEngine::setUpBeamformer(oboe::AudioStream *stream) {
+    int32_t channelCount = stream->getChannelCount();
+    rkai_beamformer_t previous = mBeamformer;
+    mBeamformer = nullptr;
+    if (channelCount > 1 && (int32_t) mMicPositions.size() == 2 * channelCount) {
+        rkai_beamformer_config_t config;
+        rkai_beamformer_default_config(stream->getSampleRate(), &config);
+        config.channel_count = channelCount;
+        for (int32_t c = 0; c < channelCount; ++c) {
+            config.mic_x[c] = mMicPositions[2 * c];
+            config.mic_y[c] = mMicPositions[2 * c + 1];
+        }
+        mBeamformer = rkai_create_beamformer(&config);
+    }
+    if (channelCount > 1 && mBeamformer == nullptr) {
+        LOGW(TAG, "No beamformer for the %d channel capture, the first channel is recorded", channelCount);
+    }
+    if (channelCount != mCaptureChannelCount) {
+        // The frames stay aligned on the channels from the start of the ring
+        mCaptureRecording.clear();
+        mCaptureChannelCount = channelCount;
+    }
+    recordingCallback.setBeamformer(mBeamformer, &mCaptureRecording, channelCount);
+    if (previous != nullptr) {
+        rkai_release_beamformer(previous);
+    }
+}
+
+void AudioEngine::recordTriggerDirection(int64_t triggerOnset, int64_t triggerEnd) {
+    rkai_beamformer_direction_t direction = {};
+    // Without an onset, the second before the end of the trigger window
+    int64_t start = triggerOnset >= 0 && triggerOnset < triggerEnd ? triggerOnset : triggerEnd - mSampleRate;
+    if (!recordingCallback.getDirection(start, triggerEnd, &direction)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mDirectionMutex);
+        mTriggerDirection = direction;
+    }
+    if (direction.estimate_count > 0) {
+        LOG_INFO("Trigger word from %.0f degrees, confidence %.2f over %d estimates", direction.angle,
+                 direction.confidence, direction.estimate_count);
+    }
+    // Next to the trigger event of the session, at the same position
+    getSessionRecorder().record(RKAI_CHUNK_EVENT, SESSION_SOURCE_BEAMFORMER, triggerEnd, &direction,
+                                sizeof(rkai_beamformer_direction_t));
+}
+
+void AudioEngine::setPlaybackReference(oboe::AudioStream *stream) {
+    // A file at another rate or in stereo cannot be a reference for the mono capture
+    bool isReference = stream->getSampleRate() == mEchoSampleRate && stream->getChannelCount() == 1 &&
+                       stream->getFormat() == oboe::AudioFormat::Float;
+    playingCallback.setPlaybackReference(isReference ? &mPlaybackReference : nullptr);
+    if (!isReference) {
+        LOGW(TAG, "The playback is not cancelled from the recording");
+    }
+}
+
+void AudioEngine::writeReplayedAudio(int64_t firstSample, const float *samples, int32_t numSamples) {
+    // Silence up to the first recorded sample, the detectors see the capture indices of the session
+    float silence[256] = {0};
+    while (mSoundRecording.getLength() < firstSample) {
+        mSoundRecording.write(silence, (int32_t) std::min<int64_t>(256, firstSample - mSoundRecording.getLength()));
+    }
+    // Samples the recording already has, e.g. a replay after the microphone ran
+    int64_t skipped = std::min<int64_t>(numSamples, mSoundRecording.getLength() - firstSample);
+    if (skipped < numSamples) {
+        mSoundRecording.write(samples + skipped, (int32_t) (numSamples - skipped));
+    }
+}
+
 void AudioEngine::openRecordingStream() {
     LOGD(TAG, "openRecordingStream() called");
     oboe::AudioStreamBuilder builder;
     setUpRecordingStreamParameters(&builder);
     oboe::Result result = builder.openStream(&mRecordingStream);
     if (result == oboe::Result::OK && mRecordingStream) {
-        assert(mRecordingStream->getChannelCount() == mInputChannelCount);
+        if (mRecordingStream->getChannelCount() != mInputChannelCount) {
+            LOGW(TAG, "openRecordingStream(): %d channels asked, the device gives %d", mInputChannelCount,
+                 mRecordingStream->getChannelCount());
+        }
         mSampleRate = mRecordingStream->getSampleRate();
         mFormat = mRecordingStream->getFormat();
         LOGV(TAG, "openRecordingStream(): mSampleRate = ");
@@ -120,6 +269,7 @@ void AudioEngine::openPlaybackStreamFromRecordedStreamParameters() {
         assert(mPlaybackStream->getChannelCount() == mOutputChannelCount);
         mFormat = mPlaybackStream->getFormat();
         mSampleRate = mPlaybackStream->getSampleRate();
+        setPlaybackReference(mPlaybackStream);
         LOGD(TAG, "openPlaybackStreamFromRecordedStreamParameters(): mSampleRate = ");
         LOGD(TAG, std::to_string(mSampleRate).c_str());
 
@@ -156,6 +306,7 @@ void AudioEngine::openPlaybackStreamFromFileParameters() {
         assert(mPlaybackStream->getFormat() == mFormat);
 
         mSampleRate = mPlaybackStream->getSampleRate();
+        setPlaybackReference(mPlaybackStream);
         LOGV(TAG, "openPlaybackStreamFromFileParameters(): mSampleRate = ");
         LOGV(TAG, std::to_string(mSampleRate).c_str());
         mFramesPerBurst = mPlaybackStream->getFramesPerBurst();
@@ -207,7 +358,8 @@ void AudioEngine::closeStream(oboe::AudioStream *stream) {
 oboe::AudioStreamBuilder *AudioEngine::setUpRecordingStreamParameters(
         oboe::AudioStreamBuilder *builder) {
     LOGD(TAG, "setUpRecordingStreamParameters() called");
-    builder->setAudioApi(mAudioApi)
+    // OpenSL ES records at most two channels
+    builder->setAudioApi(mInputChannelCount > 2 ? oboe::AudioApi::AAudio : mAudioApi)
             ->setFormat(mFormat)
             ->setSharingMode(oboe::SharingMode::Exclusive)
             ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
@@ -13,7 +13,11 @@
 #include "playing_callback.h"
 #include "triggerword_callback.h"
 #include "vad_callback.h"
+#include "event_recorder.h"
+#include "session_recorder.h"
 #include <android/asset_manager_jni.h>
+#include <mutex>
+#include <vector>
 
 
 class AudioEngine {
@@ -21,10 +25,15 @@ public:
     AudioEngine(AAssetManager *mgr);
     ~AudioEngine();
 
-    RecordingCallback recordingCallback = RecordingCallback(&mSoundRecording);
+    // Built in place, the echo state is not movable
+    RecordingCallback recordingCallback{&mSoundRecording};
     PlayingCallback playingCallback = PlayingCallback(&mSoundRecording, &sndfileHandle);
-    TriggerCallback triggerWordCallback = TriggerCallback(&mSoundRecording, mgr);
-    VADCallback vadCallback = VADCallback(&mSoundRecording, mgr);
+    // Clips around the trigger decisions, declared before the detectors that record into it
+    EventRecorder eventRecorder{&mSoundRecording, 16000};
+    // Built in place from the asset manager of the constructor, the callback holds atomics
+    TriggerCallback triggerWordCallback;
+    // Built in place from the asset manager of the constructor, the handoff state is not movable
+    VADCallback vadCallback;
 
 
     void startRecording();
@@ -34,6 +43,27 @@ public:
     void startPlayingFromFile(const char* filaPath);
     void stopPlayingFromFile();
     void writeToFile(const char* filePath);
+    // Record a clip around the newest recorded sample, e.g. on a vad timeout decided by the app
+    bool recordEvent(ClipReason reason);
+    // Replay a session into the recording in place of the microphone, the detectors read it as usual
+    void startReplay(const char* sessionPath, bool isPaced);
+    // Cancel the playback echo in the recorded audio, on by default
+    void setEchoCancellation(bool isEnabled);
+    // Suppress the steady noise in the spectrum of the detectors and in the vad packets, off by default
+    void setNoiseSuppression(bool isEnabled);
+    bool isDoubleTalk() const { return recordingCallback.getIsDoubleTalk(); };
+    /**
+     * Positions x, y in meters of the microphones in the channel order, set while not recording. The next recording
+     * captures that many channels and records their beam, one microphone records mono
+     */
+    bool setMicArray(const float *positions, int32_t micCount);
+    // Point the beam to a direction in degrees, it goes on following the talker
+    void steerBeam(float angle);
+    // Direction of the talker over the last trigger word, false if none was estimated
+    bool getTriggerDirection(rkai_beamformer_direction_t *direction);
+    // Interleaved frames of all the microphones, getCaptureChannelCount() samples per frame
+    SoundRecording *getCaptureRecording() { return &mCaptureRecording; };
+    int32_t getCaptureChannelCount() const { return mCaptureChannelCount; };
 
 
 private:
@@ -52,9 +82,30 @@ private:
     oboe::AudioStream *mPlaybackStream = nullptr;
     SoundRecording mSoundRecording;
     SndfileHandle sndfileHandle;
+    // What the playback stream played, the echo canceller aligns it with the capture
+    SoundRecording mPlaybackReference;
+    // The canceller only runs with the capture and the playback at its rate
+    int32_t mEchoSampleRate = 16000;
+    rkai_echo_canceller_t mEchoCanceller = nullptr;
+    // Multichannel capture before the beam, 7.5 s of a 4 microphone array at 16 kHz
+    SoundRecording mCaptureRecording;
+    int32_t mCaptureChannelCount = 1;
+    // x, y of each microphone
+    std::vector<float> mMicPositions;
+    rkai_beamformer_t mBeamformer = nullptr;
+    std::mutex mDirectionMutex;
+    rkai_beamformer_direction_t mTriggerDirection = {};
 
     AAssetManager *mgr;
 
+    void writeReplayedAudio(int64_t firstSample, const float *samples, int32_t numSamples);
+
+    void setPlaybackReference(oboe::AudioStream *stream);
+
+    void setUpBeamformer(oboe::AudioStream *stream);
+
+    void recordTriggerDirection(int64_t triggerOnset, int64_t triggerEnd);
+
     void openRecordingStream();
     void openPlaybackStreamFromRecordedStreamParameters();
     void openPlaybackStreamFromFileParameters();
@@ -5,7 +5,6 @@
 #include <jni.h>
 #include "audio_engine.h"
 #include <android/asset_manager_jni.h>
-#include "android_fopen.h"
 #include "logging_macros.h"
 
 const char *TAG = "AudioEngineJNI:: %s";
@@ -18,7 +17,6 @@ Java_org_rikkei_smartrobot_AudioEngine_create(JNIEnv *env, jclass, jobject asset
     if (audioEngine == nullptr) {
 
         AAssetManager* mgr = AAssetManager_fromJava(env, assetManager);
-        android_fopen_set_asset_manager(mgr);
         audioEngine = new AudioEngine(mgr);
     }
     return (audioEngine != nullptr);
@@ -105,4 +103,219 @@ Java_org_rikkei_smartrobot_AudioEngine_stopPlayingFromFile(JNIEnv *env, jclass)
     }
     audioEngine->stopPlayingFromFile();
 }
-}
\ No newline at end of file
+
+/**
+ * Wait up to timeoutMs for the next vad packet. Its samples are written as PCM16 to the direct buffer pcm and
+ * sequence, segment id, flags and start sample to info. Returns the bytes written, -1 if no packet came
+ */
+JNIEXPORT jint JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_pollSpeechPacket(JNIEnv *env, jclass, jobject pcm, jlongArray info,
+                                                        jint timeoutMs) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return -1;
+    }
+    uint8_t *out = (uint8_t *) env->GetDirectBufferAddress(pcm);
+    jlong outSize = env->GetDirectBufferCapacity(pcm);
+    if (out == nullptr || outSize < RKAI_PACKET_MAX_SAMPLES * 2 || env->GetArrayLength(info) < 4) {
+        LOGE(TAG, "pollSpeechPacket needs a direct buffer of %d bytes and 4 infos", RKAI_PACKET_MAX_SAMPLES * 2);
+        return -1;
+    }
+    rkai_audio_packet_t packet;
+    int hasPacket = 0;
+    rkai_packetizer_poll(audioEngine->vadCallback.getPacketizer(), &packet, timeoutMs, &hasPacket);
+    if (!hasPacket) {
+        return -1;
+    }
+    rkai_pcm16_config_t config;
+    rkai_pcm16_default_config(16000, &config);
+    int written = 0;
+    rkai_pcm16_encode(&config, packet.samples, packet.sample_num, out, (int) outSize, &written);
+    jlong values[4] = {packet.sequence, packet.segment_id, packet.flags, packet.start_sample};
+    env->SetLongArrayRegion(info, 0, 4, values);
+    return written;
+}
+
+/**
+ * Copy the telemetry of a detector, 0 for the trigger word and 1 for the vad, oldest first into the direct buffer
+ * entries as rkai_telemetry_entry_t in native order. Returns the number of entries, -1 on error
+ */
+JNIEXPORT jint JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_getTelemetry(JNIEnv *env, jclass, jint detector, jobject entries) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return -1;
+    }
+    rkai_telemetry_t telemetry = detector == 0 ? audioEngine->triggerWordCallback.getTelemetry()
+                                               : audioEngine->vadCallback.getTelemetry();
+    void *out = env->GetDirectBufferAddress(entries);
+    jlong outSize = env->GetDirectBufferCapacity(entries);
+    if (out == nullptr || (uintptr_t) out % alignof(rkai_telemetry_entry_t) != 0) {
+        LOGE(TAG, "getTelemetry needs an aligned direct buffer");
+        return -1;
+    }
+    int entryNum = 0;
+    if (rkai_telemetry_snapshot(telemetry, (rkai_telemetry_entry_t *) out,
+                                (int) (outSize / sizeof(rkai_telemetry_entry_t)), &entryNum) != RKAI_RET_SUCCESS) {
+        return -1;
+    }
+    return entryNum;
+}
+
+/**
+ * Keep clips of the trigger word events in directory, at most maxFiles and maxBytes. An empty directory stops it
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_setEventSpool(JNIEnv *env, jclass, jstring directory, jint maxFiles,
+                                                     jlong maxBytes) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return false;
+    }
+    const char *path = env->GetStringUTFChars(directory, nullptr);
+    bool isSet = audioEngine->eventRecorder.setSpool(path, maxFiles, maxBytes);
+    env->ReleaseStringUTFChars(directory, path);
+    return isSet;
+}
+
+/**
+ * Record a clip around the current audio, reason is a ClipReason such as 4 for a vad timeout. Returns false if the
+ * clip is not recorded
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_recordAudioEvent(JNIEnv *env, jclass, jint reason) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return false;
+    }
+    return audioEngine->recordEvent((ClipReason) reason);
+}
+
+/**
+ * Record the capture audio, the face detection frames and the detector outputs and events into a session file.
+ * maxImageWidth is the width frames are downscaled to, 0 keeps them whole
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_startSession(JNIEnv *env, jclass, jstring sessionPath, jint maxImageWidth) {
+    const char *path = env->GetStringUTFChars(sessionPath, nullptr);
+    rkai_session_config_t config;
+    rkai_session_default_config(&config);
+    config.max_image_width = maxImageWidth;
+    bool isStarted = getSessionRecorder().startRecording(path, config);
+    env->ReleaseStringUTFChars(sessionPath, path);
+    return isStarted;
+}
+
+JNIEXPORT void JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_stopSession(JNIEnv *env, jclass) {
+    getSessionRecorder().stopRecording();
+}
+
+/**
+ * Replay a session to the detectors and the face detection, at the recorded pace or as fast as possible. The
+ * microphone should not be recording meanwhile
+ */
+JNIEXPORT void JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_replaySession(JNIEnv *env, jclass, jstring sessionPath, jboolean isPaced) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return;
+    }
+    const char *path = env->GetStringUTFChars(sessionPath, nullptr);
+    audioEngine->startReplay(path, isPaced);
+    env->ReleaseStringUTFChars(sessionPath, path);
+}
+
+JNIEXPORT void JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_stopReplay(JNIEnv *env, jclass) {
+    getSessionRecorder().stopReplay();
+}
+
+/**
+ * Cancel the echo of the playback in the recorded audio, the detectors and the sessions get the cleaned audio. On by
+ * default
+ */
+JNIEXPORT void JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_setEchoCancellation(JNIEnv *env, jclass, jboolean isEnabled) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return;
+    }
+    audioEngine->setEchoCancellation(isEnabled);
+}
+
+/**
+ * Suppress the steady noise, e.g. HVAC or crowd noise, in the spectrum the trigger word and vad models get and in the
+ * vad packets. Off by default
+ */
+JNIEXPORT void JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_setNoiseSuppression(JNIEnv *env, jclass, jboolean isEnabled) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return;
+    }
+    audioEngine->setNoiseSuppression(isEnabled);
+}
+
+/**
+ * True while the near end talks over the playback, e.g. to stop the robot speech on a barge-in
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_isDoubleTalk(JNIEnv *env, jclass) {
+    if (audioEngine == nullptr) {
+        return false;
+    }
+    return audioEngine->isDoubleTalk();
+}
+
+/**
+ * Describe the microphone array as x, y pairs in meters in the channel order, before startRecording. The recording
+ * then captures every microphone and records their beam, an empty or single pair array records mono
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_setMicArray(JNIEnv *env, jclass, jfloatArray positions) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return false;
+    }
+    jsize size = env->GetArrayLength(positions);
+    if (size % 2 != 0) {
+        LOGE(TAG, "setMicArray needs x, y pairs");
+        return false;
+    }
+    jfloat *values = env->GetFloatArrayElements(positions, 0);
+    bool isSet = audioEngine->setMicArray(values, std::max(1, (int) size / 2));
+    env->ReleaseFloatArrayElements(positions, values, JNI_ABORT);
+    return isSet;
+}
+
+/**
+ * Point the beam of the microphone array to a direction in degrees, counter clockwise from the x axis of the array
+ */
+JNIEXPORT void JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_steerBeam(JNIEnv *env, jclass, jfloat angle) {
+    if (audioEngine == nullptr) {
+        LOGE(TAG, "Engine is null, please call create() first");
+        return;
+    }
+    audioEngine->steerBeam(angle);
+}
+
+/**
+ * Write the direction in degrees and the confidence of the talker of the last trigger word to direction. Returns
+ * false if no direction was estimated for it
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_rikkei_smartrobot_AudioEngine_getTriggerDirection(JNIEnv *env, jclass, jfloatArray direction) {
+    if (audioEngine == nullptr || env->GetArrayLength(direction) < 2) {
+        return false;
+    }
+    rkai_beamformer_direction_t triggerDirection;
+    if (!audioEngine->getTriggerDirection(&triggerDirection)) {
+        return false;
+    }
+    jfloat values[2] = {triggerDirection.angle, triggerDirection.confidence};
+    env->SetFloatArrayRegion(direction, 0, 2, values);
+    return true;
+}
+}
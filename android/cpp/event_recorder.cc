@@ -0,0 +1,263 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "logging_macros.h"
+#include "segment_encoder.h"
+#include "event_recorder.h"
+
+// Wait of the writer for the audio after a queued event
+constexpr int kWriterPollMs = 50;
+
+static const char *getReasonName(int reasons) {
+    if (reasons & CLIP_TRIGGERED) {
+        return "triggered";
+    }
+    if (reasons & CLIP_VAD_TIMEOUT) {
+        return "vad_timeout";
+    }
+    return "near_miss";
+}
+
+EventRecorder::EventRecorder(SoundRecording *soundRecording, int32_t sampleRate) {
+    mSoundRecording = soundRecording;
+    mSampleRate = sampleRate;
+    mWriter = std::thread(&EventRecorder::runWriter, this);
+}
+
+EventRecorder::~EventRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        isStopping = true;
+        mCondition.notify_one();
+    }
+    mWriter.join();
+}
+
+bool EventRecorder::setSpool(const std::string &directory, int maxFiles, int64_t maxBytes) {
+    // The clips queued for the previous spool are written there first
+    flush();
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSpoolDirectory.clear();
+    mSpoolFiles.clear();
+    mSpoolBytes = 0;
+    if (directory.empty()) {
+        return true;
+    }
+    if (maxFiles <= 0 || maxBytes <= 0) {
+        LOG_ERROR("Invalid event spool quotas, %d files and %lld bytes", maxFiles, (long long) maxBytes);
+        return false;
+    }
+    if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        LOG_ERROR("Cannot create the event spool %s: %s", directory.c_str(), strerror(errno));
+        return false;
+    }
+    mSpoolDirectory = directory;
+    mMaxSpoolFiles = maxFiles;
+    mMaxSpoolBytes = maxBytes;
+    loadSpool();
+    enforceQuotas();
+    LOG_INFO("Event spool %s holds %zu clips, %lld bytes", directory.c_str(), mSpoolFiles.size(),
+             (long long) mSpoolBytes.load());
+    return true;
+}
+
+void EventRecorder::setClipSeconds(float preSeconds, float postSeconds, float maxSeconds) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPreSeconds = preSeconds;
+    mPostSeconds = postSeconds;
+    mMaxClipSeconds = std::max(maxSeconds, preSeconds + postSeconds);
+}
+
+bool EventRecorder::record(ClipReason reason, int64_t sample) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!(mReasons & reason) || mSpoolDirectory.empty()) {
+        return false;
+    }
+    int64_t start = std::max<int64_t>(0, sample - (int64_t) (mPreSeconds * mSampleRate));
+    int64_t end = sample + (int64_t) (mPostSeconds * mSampleRate);
+    if (!mQueue.empty() && start < mQueue.back().end) {
+        // The same utterance, e.g. near misses before the trigger fires on it
+        Clip &clip = mQueue.back();
+        clip.reasons |= reason;
+        int64_t maxEnd = clip.start + (int64_t) (mMaxClipSeconds * mSampleRate);
+        if (end <= maxEnd) {
+            clip.end = std::max(clip.end, end);
+            mLastClipEnd = clip.end;
+            return true;
+        }
+        clip.end = maxEnd;
+        mLastClipEnd = maxEnd;
+    }
+    // The audio already in a clip is not recorded again
+    start = std::max(start, mLastClipEnd);
+    if (start >= end) {
+        return true;
+    }
+    if (mQueue.size() >= mMaxPendingClips) {
+        mDroppedCount++;
+        return false;
+    }
+    mQueue.push_back({reason, start, end});
+    mLastClipEnd = end;
+    mCondition.notify_one();
+    return true;
+}
+
+void EventRecorder::flush() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    isFlushing = true;
+    mCondition.notify_one();
+    mFlushCondition.wait(lock, [this] { return mQueue.empty() && !isWriting; });
+    isFlushing = false;
+    // The clips were cut at the recording end, the audio after it is free for the next clip
+    mLastClipEnd = std::min(mLastClipEnd, mSoundRecording->getLength());
+}
+
+void EventRecorder::runWriter() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        if (mQueue.empty()) {
+            mFlushCondition.notify_all();
+            if (isStopping) {
+                break;
+            }
+            mCondition.wait(lock);
+            continue;
+        }
+        // The audio after the event is not recorded yet
+        if (!isStopping && !isFlushing && mSoundRecording->getLength() < mQueue.front().end) {
+            mCondition.wait_for(lock, std::chrono::milliseconds(kWriterPollMs));
+            continue;
+        }
+        Clip clip = mQueue.front();
+        mQueue.pop_front();
+        isWriting = true;
+        lock.unlock();
+        bool isWritten = writeClip(clip);
+        lock.lock();
+        isWriting = false;
+        if (!isWritten) {
+            mDroppedCount++;
+        }
+    }
+}
+
+bool EventRecorder::writeClip(const Clip &clip) {
+    // Only the audio the ring still holds, and up to the recording end on a flush
+    int64_t start = std::max(clip.start, mSoundRecording->getOldestIndex());
+    int64_t end = std::min(clip.end, mSoundRecording->getLength());
+    if (end <= start) {
+        LOG_WARN("Event clip [%lld, %lld) is no longer recorded", (long long) clip.start, (long long) clip.end);
+        return false;
+    }
+    int32_t sampleNum = (int32_t) (end - start);
+    std::vector<float> audio(sampleNum);
+    if (!mSoundRecording->getData(audio.data(), start, end)) {
+        LOG_WARN("Event clip [%lld, %lld) was overwritten", (long long) start, (long long) end);
+        return false;
+    }
+    rkai_pcm16_config_t pcmConfig;
+    rkai_pcm16_default_config(mSampleRate, &pcmConfig);
+    std::vector<int16_t> pcm(sampleNum);
+    int written = 0;
+    rkai_pcm16_encode(&pcmConfig, audio.data(), sampleNum, (uint8_t *) pcm.data(), sampleNum * sizeof(int16_t),
+                      &written);
+    std::vector<uint8_t> encoded;
+    if (!SegmentEncoder::encode(pcm.data(), sampleNum, mSampleRate, 1, encoded)) {
+        LOG_ERROR("Cannot encode the event clip at %lld", (long long) start);
+        return false;
+    }
+
+    std::string directory;
+    int64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        directory = mSpoolDirectory;
+        sequence = mNextSequence++;
+        if (directory.empty() || (int64_t) encoded.size() > mMaxSpoolBytes) {
+            LOG_WARN("Event clip of %zu bytes does not fit the spool", encoded.size());
+            return false;
+        }
+    }
+    bool isFlac = (SegmentEncoder::getFormat(mSampleRate, 1) & SF_FORMAT_TYPEMASK) == SF_FORMAT_FLAC;
+    char name[96];
+    snprintf(name, sizeof(name), "clip_%06lld_%s_%lld.%s", (long long) sequence, getReasonName(clip.reasons),
+             (long long) start, isFlac ? "flac" : "caf");
+    std::string path = directory + "/" + name;
+    // Renamed once complete, a reader of the spool never sees a partial clip
+    std::string partPath = path + ".part";
+    FILE *file = fopen(partPath.c_str(), "wb");
+    if (file == nullptr) {
+        LOG_ERROR("Cannot create %s: %s", partPath.c_str(), strerror(errno));
+        return false;
+    }
+    bool isOk = fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    isOk = fclose(file) == 0 && isOk;
+    if (!isOk || rename(partPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Cannot write %s", path.c_str());
+        unlink(partPath.c_str());
+        return false;
+    }
+    LOG_INFO("Event clip %s, %.1f s in %zu bytes", name, (float) sampleNum / mSampleRate, encoded.size());
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSpoolFiles.push_back({sequence, path, (int64_t) encoded.size()});
+    mSpoolBytes += (int64_t) encoded.size();
+    mClipCount++;
+    enforceQuotas();
+    return true;
+}
+
+void EventRecorder::loadSpool() {
+    DIR *dir = opendir(mSpoolDirectory.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string path = mSpoolDirectory + "/" + entry->d_name;
+        long long sequence;
+        int length = 0;
+        if (sscanf(entry->d_name, "clip_%lld_%n", &sequence, &length) != 1 || length == 0) {
+            continue;
+        }
+        size_t nameLength = strlen(entry->d_name);
+        if (nameLength > 5 && strcmp(entry->d_name + nameLength - 5, ".part") == 0) {
+            // Left by a write cut short
+            unlink(path.c_str());
+            continue;
+        }
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            continue;
+        }
+        mSpoolFiles.push_back({sequence, path, (int64_t) info.st_size});
+        mSpoolBytes += (int64_t) info.st_size;
+        mNextSequence = std::max<int64_t>(mNextSequence, sequence + 1);
+    }
+    closedir(dir);
+    std::sort(mSpoolFiles.begin(), mSpoolFiles.end(),
+              [](const SpoolFile &a, const SpoolFile &b) { return a.sequence < b.sequence; });
+}
+
+void EventRecorder::enforceQuotas() {
+    while (!mSpoolFiles.empty() &&
+           ((int) mSpoolFiles.size() > mMaxSpoolFiles || mSpoolBytes > mMaxSpoolBytes)) {
+        const SpoolFile &oldest = mSpoolFiles.front();
+        if (unlink(oldest.path.c_str()) != 0 && errno != ENOENT) {
+            LOG_WARN("Cannot remove %s: %s", oldest.path.c_str(), strerror(errno));
+        }
+        mSpoolBytes -= oldest.bytes;
+        mEvictedCount++;
+        mSpoolFiles.pop_front();
+    }
+}
@@ -0,0 +1,138 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_EVENT_RECORDER_H
+#define SMARTROBOT_EVENT_RECORDER_H
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "sound_recording.h"
+
+// Events a clip can be recorded on, combined as a mask by setReasons
+enum ClipReason {
+    CLIP_TRIGGERED = 1,
+    CLIP_NEAR_MISS = 2,
+    CLIP_VAD_TIMEOUT = 4,
+};
+
+/**
+ * Black box of the detectors: on an event, the audio from mPreSeconds before it to mPostSeconds after it is kept as
+ * a compressed clip in a spool directory, for offline review.
+ *
+ * The audio before the event is the ring of the sound recording, nothing is copied until an event. record only
+ * queues the clip. A writer thread waits until the audio after the event is recorded, encodes the clip with
+ * SegmentEncoder, writes the file and removes the oldest clips while the spool is over mMaxSpoolFiles or
+ * mMaxSpoolBytes. An event inside a queued clip extends it up to mMaxClipSeconds, clips never overlap.
+ *
+ * The files are named clip_<sequence>_<reason>_<first capture sample>.<flac|caf>, the sequence goes on from the
+ * clips already in the spool. A clip only appears under its name once it is complete.
+ */
+class EventRecorder {
+public:
+    EventRecorder(SoundRecording *soundRecording, int32_t sampleRate);
+
+    ~EventRecorder();
+
+    /**
+     * Record into directory, created if needed, with at most maxFiles clips and maxBytes in it. The clips left by a
+     * previous run count in the quotas. An empty directory stops recording
+     */
+    bool setSpool(const std::string &directory, int maxFiles, int64_t maxBytes);
+
+    // Set before the events, the clips already queued keep their bounds
+    void setClipSeconds(float preSeconds, float postSeconds, float maxSeconds);
+
+    // Mask of ClipReason recorded, all by default
+    void setReasons(int reasons) { mReasons = reasons; };
+
+    // Lowest keyword score of a window recorded as a near miss when the trigger word does not fire
+    void setNearMissThreshold(float threshold) { mNearMissThreshold = threshold; };
+
+    float getNearMissThreshold() const { return mNearMissThreshold; };
+
+    /**
+     * Queue the clip around the capture sample of an event, can be called from any thread. Returns false if the
+     * reason is not recorded, no spool is set or mMaxPendingClips are already queued
+     */
+    bool record(ClipReason reason, int64_t sample);
+
+    /**
+     * Write the queued clips now with the audio recorded so far, and wait for them
+     */
+    void flush();
+
+    uint64_t getClipCount() const { return mClipCount; };
+
+    // Events refused by a full queue and clips that could not be read or written
+    uint64_t getDroppedCount() const { return mDroppedCount; };
+
+    uint64_t getEvictedCount() const { return mEvictedCount; };
+
+    int64_t getSpoolBytes() const { return mSpoolBytes; };
+
+private:
+    const char *TAG = "EventRecorder:: %s";
+
+    struct Clip {
+        int reasons;
+        int64_t start;
+        int64_t end;
+    };
+
+    struct SpoolFile {
+        int64_t sequence;
+        std::string path;
+        int64_t bytes;
+    };
+
+    SoundRecording *mSoundRecording = nullptr;
+    int32_t mSampleRate;
+    // Set from the app thread, read by the detector threads
+    std::atomic<int> mReasons{CLIP_TRIGGERED | CLIP_NEAR_MISS | CLIP_VAD_TIMEOUT};
+    std::atomic<float> mNearMissThreshold{0.4f};
+    float mPreSeconds = 4; // seconds
+    float mPostSeconds = 2; // seconds
+    float mMaxClipSeconds = 20; // seconds
+    size_t mMaxPendingClips = 8;
+
+    std::string mSpoolDirectory;
+    int mMaxSpoolFiles = 0;
+    int64_t mMaxSpoolBytes = 0;
+    // Oldest first
+    std::deque<SpoolFile> mSpoolFiles;
+    std::atomic<int64_t> mSpoolBytes{0};
+    int64_t mNextSequence = 0;
+
+    std::deque<Clip> mQueue;
+    // End of the newest clip, queued or written, a new clip starts after it
+    int64_t mLastClipEnd = 0;
+    // Read from any thread by the getters
+    std::atomic<uint64_t> mClipCount{0};
+    std::atomic<uint64_t> mDroppedCount{0};
+    std::atomic<uint64_t> mEvictedCount{0};
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::condition_variable mFlushCondition;
+    std::thread mWriter;
+    bool isStopping = false;
+    bool isFlushing = false;
+    bool isWriting = false;
+
+    void runWriter();
+
+    bool writeClip(const Clip &clip);
+
+    void loadSpool();
+
+    // Called with mMutex held
+    void enforceQuotas();
+};
+
+#endif //SMARTROBOT_EVENT_RECORDER_H
@@ -6,12 +6,46 @@
 #include <android/asset_manager_jni.h>
 #include <android/log.h>
 #include <android/bitmap.h>
+#include <stddef.h>
 #include <time.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include "rkai.h"
-#include "android_fopen.h"
+#include "npu_scheduler.h"
+#include "session_recorder.h"
 
-rkai_handle_t face_detect_handle;
+// Frames in flight: one preprocessed by a caller, one on the NPU and one being decoded
+#define FACE_DETECT_STAGING_NUM 3
+#define FACE_DETECT_SUBMIT_TIMEOUT_MS 1000
+// How often the collector thread looks at the stop flag while no result comes
+#define FACE_DETECT_COLLECT_POLL_MS 100
+rkai_handle_t face_detect_handle = nullptr;
+rkai_face_pipeline_t face_detect_pipeline = nullptr;
+
+/**
+ * A submitted frame: its number in the recorded session and the scale from the model input back to the caller image
+ */
+struct PendingFrame {
+    int64_t frame;
+    float scale;
+};
+
+/**
+ * Results of the pipeline by frame id. The pipeline gives them back in submission order, the collector thread hands
+ * each one to the caller that submitted the frame. So concurrent callers (front and side camera, a replayed session)
+ * overlap the preprocessing, the inference and the decoding of their frames, and each gets its own faces
+ */
+static std::mutex face_result_mutex;
+static std::condition_variable face_result_ready;
+static std::map<uint64_t, std::pair<rkai_ret_t, rkai_det_array_t>> face_results;
+static std::map<uint64_t, PendingFrame> pending_frames;
+static std::thread face_collector;
+static std::atomic<bool> is_collecting{false};
 
 static jclass objCls = NULL;
 static jmethodID constructortorId;
@@ -19,43 +53,104 @@ static jfieldID xId;
 static jfieldID yId;
 static jfieldID wId;
 static jfieldID hId;
+// Number of the frames given to detectModel and submitFrame, in the recorded sessions
+static std::atomic<int64_t> face_frame_count{0};
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_smart_1robot_FaceDetect_initModel(JNIEnv *env, jobject thiz,
-                                                   jobject asset_manager) {
-    AAssetManager* mgr = AAssetManager_fromJava(env, asset_manager);
-    android_fopen_set_asset_manager(mgr);
-    face_detect_handle = rkai_create_handle();
-    rkai_init_detector_android(face_detect_handle, mgr);
-    LOG_DEBUG("Success");
-
-    jclass localObjCls = env->FindClass("com/example/smart_robot/FaceDetect$Obj");
-    objCls = reinterpret_cast<jclass>(env->NewGlobalRef(localObjCls));
-
+static void collectFaceResults() {
+    while (is_collecting) {
+        uint64_t frame_id;
+        rkai_det_array_t faces;
+        rkai_ret_t ret = rkai_face_pipeline_get_result(face_detect_pipeline, FACE_DETECT_COLLECT_POLL_MS, &frame_id,
+                                                       &faces);
+        if (ret == RKAI_RET_TIMEOUT) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(face_result_mutex);
+            face_results[frame_id] = std::make_pair(ret, faces);
+        }
+        face_result_ready.notify_all();
+    }
+    // Wake the callers still waiting, their frames will not come
+    face_result_ready.notify_all();
+}
 
-    constructortorId = env->GetMethodID(objCls, "<init>", "(Lcom/example/smart_robot/FaceDetect;)V");
+/**
+ * Queue an image at the model input size for detection and return at once
+ */
+static rkai_ret_t submitFaces(int64_t frame, rkai_image_t *image, float scale, uint64_t *frame_id) {
+    if (face_detect_pipeline == nullptr || !is_collecting) {
+        return RKAI_RET_COMMON_FAIL;
+    }
+    rkai_ret_t ret = rkai_face_pipeline_submit(face_detect_pipeline, image, FACE_DETECT_SUBMIT_TIMEOUT_MS, frame_id);
+    if (ret == RKAI_RET_SUCCESS) {
+        // The result may already be in, it is only looked up with the frame id given back from here
+        std::lock_guard<std::mutex> lock(face_result_mutex);
+        pending_frames[*frame_id] = {frame, scale};
+    }
+    return ret;
+}
 
-    xId = env->GetFieldID(objCls, "x", "F");
-    yId = env->GetFieldID(objCls, "y", "F");
-    wId = env->GetFieldID(objCls, "w", "F");
-    hId = env->GetFieldID(objCls, "h", "F");
+/**
+ * Wait for the faces of a submitted frame, timeout_ms < 0 waits until they come. The faces go to the session
+ * recorded. Returns RKAI_RET_TIMEOUT if they did not come in time, the frame can be collected again later
+ */
+static rkai_ret_t collectFaces(uint64_t frame_id, int timeout_ms, rkai_det_array_t *faces, float *scale) {
+    faces->count = 0;
+    std::unique_lock<std::mutex> lock(face_result_mutex);
+    auto pending = pending_frames.find(frame_id);
+    if (pending == pending_frames.end()) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    // Every submitted frame gets a result, an error one if its inference or decoding fails
+    auto is_ready = [frame_id] { return face_results.count(frame_id) != 0 || !is_collecting; };
+    if (timeout_ms < 0) {
+        face_result_ready.wait(lock, is_ready);
+    } else if (!face_result_ready.wait_for(lock, std::chrono::milliseconds(timeout_ms), is_ready)) {
+        return RKAI_RET_TIMEOUT;
+    }
+    auto result = face_results.find(frame_id);
+    if (result == face_results.end()) {
+        return RKAI_RET_COMMON_FAIL;
+    }
+    rkai_ret_t ret = result->second.first;
+    *faces = result->second.second;
+    *scale = pending->second.scale;
+    int64_t frame = pending->second.frame;
+    face_results.erase(result);
+    pending_frames.erase(pending);
+    lock.unlock();
+    getSessionRecorder().record(RKAI_CHUNK_MODEL_OUTPUT, SESSION_SOURCE_FACE, frame, faces,
+                                (int) (offsetof(rkai_det_array_t, face) + faces->count * sizeof(rkai_det_t)));
+    return ret;
+}
 
+/**
+ * Detect the faces of an image at the model input size and wait for them. Nothing else is in flight for the caller,
+ * so this one frame gets no overlap, callers of a frame stream use submitFaces and collectFaces
+ */
+static rkai_ret_t detectFaces(int64_t frame, rkai_image_t *image, rkai_det_array_t *faces) {
+    faces->count = 0;
+    uint64_t frame_id;
+    float scale;
+    rkai_ret_t ret = submitFaces(frame, image, 1, &frame_id);
+    if (ret == RKAI_RET_SUCCESS) {
+        ret = collectFaces(frame_id, -1, faces, &scale);
+    }
+    return ret;
 }
-extern "C"
-JNIEXPORT jobjectArray JNICALL
-Java_com_example_smart_1robot_FaceDetect_detectModel(JNIEnv *env, jobject thiz, jobject bitmap) {
+
+/**
+ * The bitmap at the model input size, recorded in the session, with the scale of the faces back to the bitmap
+ */
+static bool prepareFrame(JNIEnv *env, jobject bitmap, int64_t frame, rkai_image_t *resized_image, float *scale) {
     AndroidBitmapInfo info;
     AndroidBitmap_getInfo(env, bitmap, &info);
 
-    if(info.format != ANDROID_BITMAP_FORMAT_RGBA_8888){
-        // Return
-    }
-
     int width = info.width;
     int height = info.height;
     if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888)
-        return NULL;
+        return false;
 
     void *data;
     AndroidBitmap_lockPixels(env, bitmap, &data);
@@ -64,33 +159,29 @@ Java_com_example_smart_1robot_FaceDetect_detectModel(JNIEnv *env, jobject thiz,
     AndroidBitmap_unlockPixels(env, bitmap);
 
     rkai_size_t diserted_size = {.w=640, .h=480};
-    rkai_image_t resized_image;
-    rkai_image_resize_rgb(&image, diserted_size, &resized_image);
+    rkai_image_resize_rgb(&image, diserted_size, resized_image);
     LOG_ERROR("Origin Image width - heigh -stride(%d %d %d)\n", width, height, info.stride);
-    rkai_det_array_t detected_face_array;
-
-    LOG_ERROR("Image width - heigh (%d %d)\n", resized_image.width, resized_image.height);
-    clock_t begin = clock();
-    rkai_ret_t ret = rkai_face_detect(face_detect_handle, &resized_image, &detected_face_array);
-    clock_t end = clock();
-    double time_spent = (double)(end - begin) / CLOCKS_PER_SEC;
-    LOG_ERROR("Number of face: %d - error code: %d execute time: %f\n", detected_face_array.count, (int)ret, time_spent);
-
-    jobjectArray jObjArray = env->NewObjectArray(detected_face_array.count, objCls, NULL);
-
-    float slop= 1;
+    LOG_ERROR("Image width - heigh (%d %d)\n", resized_image->width, resized_image->height);
+    getSessionRecorder().recordImage(frame, *resized_image);
 
     float original_ratio = (float)image.width/image.height;
-    float resize_ratio = (float)resized_image.width/resized_image.height;
+    float resize_ratio = (float)resized_image->width/resized_image->height;
     if(original_ratio > resize_ratio){
         // Padding height. Change slope
-        slop = (float)image.width/resized_image.width;
+        *scale = (float)image.width/resized_image->width;
     } else {
         // Padding width
-        slop = (float)image.height/resized_image.height;
+        *scale = (float)image.height/resized_image->height;
     }
+    rkai_image_release(&image);
+    return true;
+}
+
+static jobjectArray toFaceObjects(JNIEnv *env, jobject thiz, const rkai_det_array_t &detected_face_array,
+                                  float slop) {
+    jobjectArray jObjArray = env->NewObjectArray(detected_face_array.count, objCls, NULL);
 
-    for (size_t i=0; i< detected_face_array.count; i++)
+    for (size_t i=0; i< (size_t) detected_face_array.count; i++)
     {
         jobject jObj = env->NewObject(objCls, constructortorId, thiz);
 
@@ -105,8 +196,130 @@ Java_com_example_smart_1robot_FaceDetect_detectModel(JNIEnv *env, jobject thiz,
 
         env->SetObjectArrayElement(jObjArray, i, jObj);
     }
+    return jObjArray;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_smart_1robot_FaceDetect_initModel(JNIEnv *env, jobject thiz,
+                                                   jobject asset_manager) {
+    if (face_detect_pipeline != nullptr) {
+        return;
+    }
+    AAssetManager* mgr = AAssetManager_fromJava(env, asset_manager);
+    face_detect_handle = rkai_create_handle();
+    rkai_init_detector_android(face_detect_handle, mgr);
+    rkai_scheduler_attach(getNpuScheduler(), face_detect_handle, RKAI_PRIORITY_VISION,
+                          kFaceDetectDeadlineMs, getFaceDetectCoreMask());
+    // The pipeline runs the handle from its own NPU thread until releaseModel
+    face_detect_pipeline = rkai_create_face_pipeline(face_detect_handle, FACE_DETECT_STAGING_NUM);
+    if (face_detect_pipeline == nullptr) {
+        LOG_ERROR("Failed to create the face detection pipeline\n");
+        rkai_release_handle(face_detect_handle);
+        face_detect_handle = nullptr;
+        return;
+    }
+    is_collecting = true;
+    face_collector = std::thread(collectFaceResults);
+    LOG_DEBUG("Success");
+
+    jclass localObjCls = env->FindClass("com/example/smart_robot/FaceDetect$Obj");
+    objCls = reinterpret_cast<jclass>(env->NewGlobalRef(localObjCls));
+
+
+    constructortorId = env->GetMethodID(objCls, "<init>", "(Lcom/example/smart_robot/FaceDetect;)V");
+
+    xId = env->GetFieldID(objCls, "x", "F");
+    yId = env->GetFieldID(objCls, "y", "F");
+    wId = env->GetFieldID(objCls, "w", "F");
+    hId = env->GetFieldID(objCls, "h", "F");
+
+    // Frames of a replayed session, recorded downscaled, are brought back to the model input size
+    getSessionRecorder().setFrameListener([](int64_t frame, const rkai_image_t &image) {
+        rkai_image_t input = image;
+        rkai_image_t resized_image;
+        rkai_size_t model_size = {.w=640, .h=480};
+        if (rkai_image_resize_rgb(&input, model_size, &resized_image) != RKAI_RET_SUCCESS) {
+            return;
+        }
+        rkai_det_array_t detected_face_array;
+        detectFaces(frame, &resized_image, &detected_face_array);
+        rkai_image_release(&resized_image);
+    });
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_smart_1robot_FaceDetect_releaseModel(JNIEnv *env, jobject thiz) {
+    if (face_detect_pipeline == nullptr) {
+        return;
+    }
+    getSessionRecorder().setFrameListener(nullptr);
+    is_collecting = false;
+    face_collector.join();
+    rkai_release_face_pipeline(face_detect_pipeline);
+    face_detect_pipeline = nullptr;
+    rkai_release_handle(face_detect_handle);
+    face_detect_handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(face_result_mutex);
+        face_results.clear();
+        pending_frames.clear();
+    }
+    env->DeleteGlobalRef(objCls);
+    objCls = NULL;
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_smart_1robot_FaceDetect_detectModel(JNIEnv *env, jobject thiz, jobject bitmap) {
+    int64_t frame = face_frame_count++;
+    rkai_image_t resized_image;
+    float slop = 1;
+    if (!prepareFrame(env, bitmap, frame, &resized_image, &slop)) {
+        return NULL;
+    }
+    rkai_det_array_t detected_face_array;
+    clock_t begin = clock();
+    rkai_ret_t ret = detectFaces(frame, &resized_image, &detected_face_array);
+    clock_t end = clock();
+    double time_spent = (double)(end - begin) / CLOCKS_PER_SEC;
+    LOG_ERROR("Number of face: %d - error code: %d execute time: %f\n", detected_face_array.count, (int)ret, time_spent);
 
-    rkai_image_release(&image);
     rkai_image_release(&resized_image);
-    return jObjArray;
-}
\ No newline at end of file
+    return toFaceObjects(env, thiz, detected_face_array, slop);
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_example_smart_1robot_FaceDetect_submitFrame(JNIEnv *env, jobject thiz, jobject bitmap) {
+    int64_t frame = face_frame_count++;
+    rkai_image_t resized_image;
+    float slop = 1;
+    if (!prepareFrame(env, bitmap, frame, &resized_image, &slop)) {
+        return -1;
+    }
+    uint64_t frame_id;
+    rkai_ret_t ret = submitFaces(frame, &resized_image, slop, &frame_id);
+    rkai_image_release(&resized_image);
+    if (ret != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Failed to submit the frame - error code: %d\n", (int)ret);
+        return -1;
+    }
+    return (jlong) frame_id;
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_smart_1robot_FaceDetect_collectFaces(JNIEnv *env, jobject thiz, jlong frame_id, jint timeout_ms) {
+    if (frame_id < 0) {
+        return NULL;
+    }
+    rkai_det_array_t detected_face_array;
+    float slop = 1;
+    rkai_ret_t ret = collectFaces((uint64_t) frame_id, timeout_ms, &detected_face_array, &slop);
+    if (ret == RKAI_RET_TIMEOUT || ret == RKAI_RET_INVALID_INPUT_PARAM) {
+        return NULL;
+    }
+    return toFaceObjects(env, thiz, detected_face_array, slop);
+}
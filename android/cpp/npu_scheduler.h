@@ -0,0 +1,46 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_NPU_SCHEDULER_H
+#define SMARTROBOT_NPU_SCHEDULER_H
+
+#include "rkai.h"
+
+// Relative deadline of one inference per model
+constexpr int kTriggerWordDeadlineMs = 50;
+constexpr int kVadDeadlineMs = 100;
+constexpr int kFaceDetectDeadlineMs = 66;
+
+inline int getNpuCoreNum() {
+    static int coreNum = rkai_get_npu_core_num();
+    return coreNum;
+}
+
+/**
+ * NPU cores per model. With three cores the trigger word, the VAD and the cameras each have their own core, so
+ * no model waits for another. With two, the audio models share one core and the cameras have the other. A single
+ * core NPU has no core mask
+ */
+inline int getTriggerWordCoreMask(int coreNum = getNpuCoreNum()) {
+    return coreNum > 1 ? RKNN_NPU_CORE_0 : RKNN_NPU_CORE_AUTO;
+}
+
+inline int getVadCoreMask(int coreNum = getNpuCoreNum()) {
+    return coreNum > 2 ? RKNN_NPU_CORE_1 : getTriggerWordCoreMask(coreNum);
+}
+
+inline int getFaceDetectCoreMask(int coreNum = getNpuCoreNum()) {
+    return coreNum > 2 ? RKNN_NPU_CORE_2 : coreNum > 1 ? RKNN_NPU_CORE_1 : RKNN_NPU_CORE_AUTO;
+}
+
+/**
+ * Scheduler shared by every model of the process, one job per NPU core, so trigger word windows are not delayed
+ * behind face detection frames and models on different cores run at the same time.
+ */
+inline rkai_scheduler_t getNpuScheduler() {
+    static rkai_scheduler_t scheduler = rkai_create_scheduler(getNpuCoreNum());
+    return scheduler;
+}
+
+#endif //SMARTROBOT_NPU_SCHEDULER_H
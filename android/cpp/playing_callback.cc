@@ -19,7 +19,12 @@ oboe::DataCallbackResult PlayingCallback::processPlaybackFrames(oboe::AudioStrea
     if (!isPlayingFromFile()) {
         framesWritten = mSoundRecording->read(static_cast<float *>(audioData), numFrames);
     } else {
-        framesWritten = static_cast<sf_count_t>(mFileHandle->read(static_cast<int16_t *>(audioData), numFrames));
+        // The stream is float, libsndfile scales the file samples to it
+        framesWritten = static_cast<sf_count_t>(mFileHandle->read(static_cast<float *>(audioData), numFrames));
+    }
+    if (mPlaybackReference != nullptr) {
+        // The whole buffer, the zeros after the end of the file are played too
+        mPlaybackReference->write(static_cast<float *>(audioData), numFrames);
     }
 
     if (framesWritten == 0){
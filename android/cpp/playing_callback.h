@@ -16,6 +16,9 @@ private:
     SoundRecording* mSoundRecording = nullptr;
     SndfileHandle* mFileHandle = nullptr;
     bool isPlaybackFromFile = false;
+    // Gets every played buffer, the reference of the echo canceller. Null when the playback does not match the
+    // capture format
+    SoundRecording* mPlaybackReference = nullptr;
 
 public:
     PlayingCallback() = default;
@@ -29,6 +32,9 @@ public:
 
     void setPlaybackFromFile(bool isFile) { isPlaybackFromFile = isFile; };
 
+    // Set while the stream is stopped
+    void setPlaybackReference(SoundRecording* reference) { mPlaybackReference = reference; };
+
     oboe::DataCallbackResult
     onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames);
 
@@ -4,15 +4,105 @@
 
 #include "logging_macros.h"
 #include "recording_callback.h"
+#include "session_recorder.h"
+
+void RecordingCallback::setEchoCanceller(rkai_echo_canceller_t echoCanceller, SoundRecording *playbackReference) {
+    mEchoCanceller = echoCanceller;
+    mPlaybackReference = playbackReference;
+    mReferenceIndex = playbackReference != nullptr ? playbackReference->getLength() : 0;
+    isReferenceStreaming = false;
+    isDoubleTalk = false;
+    if (echoCanceller != nullptr) {
+        rkai_echo_canceller_reset(echoCanceller);
+    }
+}
+
+void RecordingCallback::setBeamformer(rkai_beamformer_t beamformer, SoundRecording *captureRecording,
+                                      int32_t channelCount) {
+    std::lock_guard<std::mutex> lock(mBeamMutex);
+    mBeamformer = beamformer;
+    mCaptureRecording = captureRecording;
+    mChannelCount = std::max(1, channelCount);
+    mBeamStart = mSoundRecording->getLength();
+    if (beamformer != nullptr) {
+        rkai_beamformer_reset(beamformer);
+    }
+}
+
+bool RecordingCallback::getDirection(int64_t start, int64_t end, rkai_beamformer_direction_t *direction) {
+    std::lock_guard<std::mutex> lock(mBeamMutex);
+    if (mBeamformer == nullptr || rkai_beamformer_get_direction(mBeamformer, start - mBeamStart, end - mBeamStart,
+                                                                direction) != RKAI_RET_SUCCESS) {
+        return false;
+    }
+    direction->position += mBeamStart;
+    return true;
+}
+
+float *RecordingCallback::mixToMono(float *frames, int32_t numFrames) {
+    if (mChannelCount == 1) {
+        return frames;
+    }
+    if (mBeamformer != nullptr) {
+        rkai_beamformer_process(mBeamformer, frames, numFrames, mBeam.data());
+    } else {
+        for (int32_t i = 0; i < numFrames; ++i) {
+            mBeam[i] = frames[i * mChannelCount];
+        }
+    }
+    return mBeam.data();
+}
+
+void RecordingCallback::readReference(float *reference, int32_t numSamples) {
+    int64_t lead = mPlaybackReference->getLength() - mReferenceIndex;
+    if (lead > kMaxReferenceLead) {
+        // The canceller finds the new delay, the lost samples were played while nothing was captured
+        mReferenceIndex = mPlaybackReference->getLength() - kReferenceSlack;
+        lead = kReferenceSlack;
+    }
+    if (!isReferenceStreaming && lead < kReferenceSlack) {
+        // Not playing, or the playback just started and is let ahead first
+        std::fill(reference, reference + numSamples, 0.0f);
+        return;
+    }
+    int32_t readNum = (int32_t) std::min<int64_t>(numSamples, lead);
+    if (readNum > 0 && !mPlaybackReference->getData(reference, mReferenceIndex, mReferenceIndex + readNum)) {
+        readNum = 0;
+    }
+    mReferenceIndex += readNum;
+    std::fill(reference + readNum, reference + numSamples, 0.0f);
+    // The playback stopped or fell behind, it builds its lead again
+    isReferenceStreaming = readNum == numSamples;
+}
 
 oboe::DataCallbackResult RecordingCallback::onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames) {
     //LOGD(TAG, std::to_string(numFrames).c_str());
-    return processRecordingFrames(audioStream, audioData, numFrames * audioStream->getChannelCount());
+    return processRecordingFrames(audioStream, audioData, numFrames);
 }
 
 oboe::DataCallbackResult RecordingCallback::processRecordingFrames(oboe::AudioStream *audioStream, void *audioData,
                                                                    int32_t numFrames) {
-    int32_t framesWritten = mSoundRecording->write(static_cast<float *>(audioData), numFrames);
+    float *frames = static_cast<float *>(audioData);
+    if (mChannelCount > 1 && mCaptureRecording != nullptr) {
+        mCaptureRecording->write(frames, numFrames * mChannelCount);
+    }
+    bool isCancelling = mEchoCanceller != nullptr && mPlaybackReference != nullptr && isEchoCancelling;
+    int isTalking = 0;
+    for (int32_t done = 0; done < numFrames; done += kMaxEchoBurst) {
+        int32_t count = std::min(kMaxEchoBurst, numFrames - done);
+        float *samples = mixToMono(frames + done * mChannelCount, count);
+        if (isCancelling) {
+            // Cleaned in place, the detectors and the session see the audio without the playback
+            readReference(mReference.data(), count);
+            rkai_echo_canceller_process(mEchoCanceller, samples, mReference.data(), count, samples, &isTalking);
+        }
+        int64_t firstSample = mSoundRecording->getLength();
+        int32_t framesWritten = mSoundRecording->write(samples, count);
+        getSessionRecorder().recordAudio(firstSample, samples, framesWritten);
+    }
+    if (isCancelling) {
+        isDoubleTalk = isTalking != 0;
+    }
 //    if (framesWritten < numFrames) {
 //        return oboe::DataCallbackResult::Stop;
 //    }
@@ -5,21 +5,82 @@
 #ifndef SMARTROBOT_RECORDING_CALLBACK_H
 #define SMARTROBOT_RECORDING_CALLBACK_H
 
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include <oboe/AudioStream.h>
 #include <oboe/AudioStream.h>
 #include "sound_recording.h"
+#include "rkai.h"
 
+// Frames given to the beamformer and the echo canceller at once, the bursts of the callback are cut to it
+constexpr int32_t kMaxEchoBurst = 1024;
+// Playback kept ahead of the capture before the reference is read, absorbs the jitter of the two callbacks
+constexpr int64_t kReferenceSlack = 1024;
+// The reference further ahead than this is skipped down to the slack, e.g. after the capture stopped
+constexpr int64_t kMaxReferenceLead = 4096;
 
 class RecordingCallback : public oboe::AudioStreamCallback {
 private:
     const char* TAG = "RecordingCallback:: %s";
     SoundRecording* mSoundRecording = nullptr;
+
+    // Cancels the playback echo before the audio is recorded, not owned
+    rkai_echo_canceller_t mEchoCanceller = nullptr;
+    // What the playback callback played, the reference of the canceller
+    SoundRecording* mPlaybackReference = nullptr;
+    int64_t mReferenceIndex = 0;
+    bool isReferenceStreaming = false;
+    std::atomic<bool> isEchoCancelling{true};
+    std::atomic<bool> isDoubleTalk{false};
+    std::vector<float> mReference = std::vector<float>(kMaxEchoBurst);
+
+    // Mixes a multichannel capture into the mono recording, not owned
+    rkai_beamformer_t mBeamformer = nullptr;
+    // Held while the beamformer changes and while its directions are read, not by the audio callback
+    std::mutex mBeamMutex;
+    // Interleaved frames of all the microphones, before the beam
+    SoundRecording* mCaptureRecording = nullptr;
+    int32_t mChannelCount = 1;
+    // Recording index of the first frame given to the beamformer, its frames count from there
+    int64_t mBeamStart = 0;
+    std::vector<float> mBeam = std::vector<float>(kMaxEchoBurst);
+
+    void readReference(float *reference, int32_t numSamples);
+
+    // The mono samples of numFrames interleaved frames, the beam or the first channel
+    float *mixToMono(float *frames, int32_t numFrames);
+
 public:
     RecordingCallback() = default;
     explicit RecordingCallback(SoundRecording* soundRecording){
         mSoundRecording = soundRecording;
     };
 
+    /**
+     * Set while the stream is stopped. The reference is read from the end of what was played so far
+     */
+    void setEchoCanceller(rkai_echo_canceller_t echoCanceller, SoundRecording *playbackReference);
+
+    /**
+     * Set while the stream is stopped, with the channel count of the stream. With more than one channel the
+     * interleaved frames go to captureRecording, and the beam, or the first channel without a beamformer, goes on
+     * to the echo canceller and the recording. The previous beamformer is no longer used once this returns
+     */
+    void setBeamformer(rkai_beamformer_t beamformer, SoundRecording *captureRecording, int32_t channelCount);
+
+    /**
+     * Direction of the talker over the recording samples [start, end), e.g. the span of a trigger word. Can be
+     * called from any thread, false without a beamformer
+     */
+    bool getDirection(int64_t start, int64_t end, rkai_beamformer_direction_t *direction);
+
+    // Can be called while recording, the audio is recorded as captured when off
+    void setEchoCancelling(bool isEnabled) { isEchoCancelling = isEnabled; };
+
+    // The near end talks over the playback, e.g. a barge-in on the robot speech
+    bool getIsDoubleTalk() const { return isDoubleTalk; };
+
     oboe::DataCallbackResult onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames);
 
     oboe::DataCallbackResult processRecordingFrames(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames);
@@ -17,6 +17,8 @@ extern "C" {
 
 void android_fopen_set_asset_manager(AAssetManager* manager);
 AAsset*  android_fopen(const char* fname, const char* mode);
+/* open with the given manager, or the one set by android_fopen_set_asset_manager if it is NULL */
+AAsset*  android_fopen_with_manager(AAssetManager* manager, const char* fname, const char* mode);
 int android_close(void* cookie);
 int android_ftell(void *cookie);
 int android_read(void* cookie, char* buf, int size);
@@ -21,6 +21,24 @@
 #include "rkai_trigger_word.h"
 #include "rkai_vad.h"
 #include "rkai_facedetect.h"
+#include "rkai_handle_pool.h"
+#include "rkai_scheduler.h"
+#include "rkai_trigger_word_cascade.h"
+#include "rkai_energy_gate.h"
+#include "rkai_adaptive_stride.h"
+#include "rkai_window_scheduler.h"
+#include "rkai_decision_fusion.h"
+#include "rkai_keyword_spotter.h"
+#include "rkai_stream.h"
+#include "rkai_vad_segmenter.h"
+#include "rkai_vad_score_stream.h"
+#include "rkai_pcm.h"
+#include "rkai_packetizer.h"
+#include "rkai_telemetry.h"
+#include "rkai_session.h"
+#include "rkai_echo_canceller.h"
+#include "rkai_beamformer.h"
+#include "rkai_noise_suppressor.h"
 #include "utils/logger.h"
 /**
  * @mainpage RIKKEI AI SDK FOR ROBOT
@@ -64,6 +82,19 @@
  * rkai_release_handle(face_handle);
  * ```
  *
+ * @subsection Thread safety
+ *
+ * All state of a model (rknn context, configs, anchors, tracker) is owned by its handle, there is no library global
+ * model state. So:
+ *  - Different handles can be used at the same time from different threads, e.g. one face detector per camera.
+ *  - One handle must be used by one thread at a time. Use @ref rkai_duplicate_handle or a handle pool to run the
+ *    same model from several threads.
+ *  - Duplicated handles share the read only model state of the original handle, so the original handle must be
+ *    released last. Session state (e.g. the tracker of @ref rkai_object_autotrack) is never shared.
+ *  - Handle pools, schedulers and face detection pipelines are thread safe, see their own documentation.
+ *  - @ref rkai_setting_logger and android_fopen_set_asset_manager change process wide settings, call them before
+ *    starting the other threads.
+ *
  * @subsection API Function List
  *
  * All of API functions provided by SDK will be listed bellow:
@@ -95,6 +126,33 @@ rkai_handle_t rkai_create_handle();
  */
 rkai_ret_t rkai_release_handle(rkai_handle_t handle);
 
+/**
+ * @brief Create a new handle running the same model as @p handle. The new handle has its own rknn context
+ *        (created by rknn_dup_context, so the model weights are shared) and can be used from another thread
+ *        at the same time as @p handle. It shares the read only model state of @p handle, which must outlive it.
+ *
+ * @param handle [in] Initialized handle to be duplicated
+ * @return @ref rkai_handle_t or NULL on failure. Release it with @ref rkai_release_handle
+ */
+rkai_handle_t rkai_duplicate_handle(rkai_handle_t handle);
+
+/**
+ * @brief Bind the context of the handle to NPU cores. Only supported on multi-core NPU (RK3588)
+ *
+ * @param handle [in] Initialized handle
+ * @param core_mask [in] rknn_core_mask value, e.g. RKNN_NPU_CORE_0 or RKNN_NPU_CORE_0_1_2
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_set_core_mask(rkai_handle_t handle, int core_mask);
+
+/**
+ * @brief Number of NPU cores of the SoC the process runs on, from the device tree: 3 on RK3588, 2 on RK3576 and 1
+ *        on the others (RK3566, RK3568) or when it cannot be read
+ *
+ * @return number of NPU cores, 1 to RKAI_MAX_NPU_CORE_NUM
+ */
+int rkai_get_npu_core_num(void);
+
 /**
  * @brief Setting logger for this library
  * 
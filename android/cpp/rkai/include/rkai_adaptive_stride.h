@@ -0,0 +1,93 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_ADAPTIVE_STRIDE_H
+#define SMARTROBOT_RKAI_ADAPTIVE_STRIDE_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default strides for a 1 s trigger word window: 0.5 s coarse, 0.3 s normal, 0.15 s fine, 0.5 s worst-case
+ *        latency. Candidates score within 0.1 under the 0.6 threshold of the first model and are held for 0.1 s,
+ *        windows scoring under 0.2 are quiet and the coarse stride starts after 1 s of them
+ *
+ * @param sample_rate [in] sample rate of the audio
+ * @param config [out] policy parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_adaptive_stride_default_config(int sample_rate, rkai_adaptive_stride_config_t *config);
+
+/**
+ * @brief Create a stride policy for a sliding window detector. The window advances by the coarse stride while the
+ *        audio has no energy or the first model scores it under the quiet score, by the fine stride after the windows
+ *        scoring just under the threshold of the first model, and by the normal stride otherwise. Every stride is
+ *        bounded by the worst-case detection latency and by the window size.
+ *
+ * ```
+ *  int stride = config.normal_stride;
+ *  while (running) {
+ *      read_window(start); start += stride;
+ *      score = is_active ? run_model(window) : -1;
+ *      rkai_adaptive_stride_next(policy, score, is_active, &stride);
+ *  }
+ * ```
+ *
+ * @param config [in] policy parameters
+ * @return @ref rkai_adaptive_stride_t or NULL on failure
+ */
+rkai_adaptive_stride_t rkai_create_adaptive_stride(const rkai_adaptive_stride_config_t *config);
+
+/**
+ * @brief Release the policy
+ *
+ * @param policy [in] policy to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_adaptive_stride(rkai_adaptive_stride_t policy);
+
+/**
+ * @brief Report the outcome of the current window and get the stride to the next one
+ *
+ * @param policy [in] stride policy
+ * @param score [in] Score of the first (cheapest) model on the window, negative if no model was run
+ * @param is_active [in] 1 if the window has energy above the noise floor, see @ref rkai_energy_gate_process
+ * @param stride [out] Samples to advance the window by
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_adaptive_stride_next(rkai_adaptive_stride_t policy, float score, int is_active, int *stride);
+
+/**
+ * @brief Go back to the normal stride and forget the recent scores, e.g. when the stream restarts
+ *
+ * @param policy [in] stride policy
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_adaptive_stride_reset(rkai_adaptive_stride_t policy);
+
+/**
+ * @brief Get the window counters and the inference rate compared with the normal stride. Can be called from any
+ *        thread
+ *
+ * @param policy [in] stride policy
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_adaptive_stride_get_stats(rkai_adaptive_stride_t policy, rkai_adaptive_stride_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_ADAPTIVE_STRIDE_H
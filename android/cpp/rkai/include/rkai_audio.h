@@ -34,6 +34,30 @@ rkai_ret_t rkai_audio_melspectrogram_release(rkai_melspectrogram_t *melspectrogr
  */
 
 rkai_ret_t rkai_audio_to_melspectrogram(rkai_audio_t *audio, rkai_melspectrogram_t *melspectrogram, rkai_melspectrogram_config_t config);
+
+/**
+ * @brief Convert audio waveform to mel spectrogram with the noise suppressed. The short-time spectrum is computed
+ *        once: the suppressor gains are applied to it, then it gives the mel spectrogram and, if asked, the denoised
+ *        audio by overlap-add
+ * @param audio [in] Window of the capture
+ * @param position [in] Capture sample of the first sample of the window, places its frames for the noise estimate
+ * @param suppressor [in] Suppressor created for the transform of config, NULL to only compute the mel spectrogram
+ * @param melspectrogram [out] Mel spectrogram, to be released with @ref rkai_audio_melspectrogram_release
+ * @param config [in] front-end of the model
+ * @param denoised [out] audio->size samples of denoised audio, NULL if not needed. The last n_fft / 2 samples come
+ *        from the frames reaching past the window, the next window gives them better
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_audio_to_denoised_melspectrogram(rkai_audio_t *audio, int64_t position,
+                                                 rkai_noise_suppressor_t suppressor,
+                                                 rkai_melspectrogram_t *melspectrogram,
+                                                 rkai_melspectrogram_config_t config, float *denoised);
+
+/**
+ * @brief Two models can share a melspectrogram when every parameter of the front-end is the same
+ * @return 1 if they can, 0 otherwise
+ */
+int rkai_audio_is_same_front_end(const rkai_melspectrogram_config_t *a, const rkai_melspectrogram_config_t *b);
 #ifdef __cplusplus
 };
 #endif
@@ -0,0 +1,121 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+
+#ifndef SMARTROBOT_RKAI_BEAMFORMER_H
+#define SMARTROBOT_RKAI_BEAMFORMER_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default beamformer parameters: 32 ms frames, 5 degree candidates, 300 to 4000 Hz, -50 dBFS, beam along the
+ *        x axis following the estimates from a confidence of 0.3. The channel count and the microphone positions
+ *        are left to the caller
+ *
+ * @param sample_rate [in] sample rate of the capture
+ * @param config [out] beamformer parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_beamformer_default_config(int sample_rate, rkai_beamformer_config_t *config);
+
+/**
+ * @brief Create a beamformer for a microphone array with a far talker.
+ *
+ *        The output is a fixed delay and sum beam: each channel is delayed by a windowed sinc fractional delay so
+ *        that a wave from the look direction adds up in phase, the others partly cancel. Moving the beam cross
+ *        fades from the old delays to the new ones.
+ *
+ *        Every half frame the direction is estimated by a steered GCC-PHAT (SRP-PHAT): the phase transformed cross
+ *        spectra of all the microphone pairs are steered to each candidate direction and summed, the direction is
+ *        the peak. The bins are weighted by their level over a tracked noise floor and the frames not clearly over
+ *        it give no estimate, so a steady noise source such as a fan neither gives directions nor pulls the beam.
+ *        The beam follows the peak of the estimates smoothed over about 80 ms. The steered responses are kept for a
+ *        few seconds, so the direction of a past span of the capture, e.g. a trigger word, can be asked for after
+ *        its detection.
+ *
+ *        A linear array cannot tell the two sides of its axis apart, the candidates then only cover the half circle
+ *        from the direction of the second microphone seen from the first one, counter clockwise.
+ *
+ * @param config [in] beamformer parameters
+ * @return @ref rkai_beamformer_t or NULL on failure
+ */
+rkai_beamformer_t rkai_create_beamformer(const rkai_beamformer_config_t *config);
+
+/**
+ * @brief Release the beamformer
+ *
+ * @param beamformer [in] beamformer to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_beamformer(rkai_beamformer_t beamformer);
+
+/**
+ * @brief Mix the channels into the beam and update the direction estimates. The output lags the input by the
+ *        latency of the stats. Must be called by one thread at a time, on consecutive frames of the capture
+ *
+ * @param beamformer [in] beamformer
+ * @param input [in] frame_num frames of channel_count interleaved samples
+ * @param frame_num [in] Number of frames
+ * @param output [out] Beam, frame_num mono samples, cannot be input
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_beamformer_process(rkai_beamformer_t beamformer, const float *input, int frame_num, float *output);
+
+/**
+ * @brief Point the beam to a direction from the next process call. Can be called from any thread, the beam goes on
+ *        following the estimates if steer_confidence allows it
+ *
+ * @param beamformer [in] beamformer
+ * @param angle [in] look direction in degrees
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_beamformer_steer(rkai_beamformer_t beamformer, float angle);
+
+/**
+ * @brief Direction of the talker over the input frames [start, end), from the summed steered responses of the
+ *        estimates centred in the span. Only the last seconds are kept. Can be called from any thread
+ *
+ * @param beamformer [in] beamformer
+ * @param start [in] First input frame, counted from the creation or the last reset
+ * @param end [in] Frame after the span
+ * @param direction [out] Direction, estimate_count is 0 if no estimate above the level is in the span
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_beamformer_get_direction(rkai_beamformer_t beamformer, int64_t start, int64_t end,
+                                         rkai_beamformer_direction_t *direction);
+
+/**
+ * @brief Forget the input and the estimates and point the beam back to the configured direction, the frames are
+ *        counted from 0 again
+ *
+ * @param beamformer [in] beamformer
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_beamformer_reset(rkai_beamformer_t beamformer);
+
+/**
+ * @brief Get the counters, the beam direction and the last estimate. Can be called from any thread
+ *
+ * @param beamformer [in] beamformer
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_beamformer_get_stats(rkai_beamformer_t beamformer, rkai_beamformer_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_BEAMFORMER_H
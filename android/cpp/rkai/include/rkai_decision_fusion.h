@@ -0,0 +1,96 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_DECISION_FUSION_H
+#define SMARTROBOT_RKAI_DECISION_FUSION_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default keyword decision: max over the last 3 windows, fires at 0.7, re-arms under 0.5, 2 s refractory
+ *
+ * @param sample_rate [in] sample rate of the audio
+ * @param config [out] decision parameters of one keyword
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_decision_fusion_default_config(int sample_rate, rkai_fusion_config_t *config);
+
+/**
+ * @brief Create a decision fusion stage turning the per-window keyword scores of overlapping windows into one event
+ *        per utterance. For each keyword the scores are smoothed over the last windows, the keyword fires when the
+ *        smoothed score reaches on_threshold, cannot fire again before it drops under off_threshold, and not before
+ *        the refractory period is over.
+ *
+ * @param configs [in] Decision parameters, one per keyword
+ * @param keyword_num [in] Number of keywords, 1 to RKAI_FUSION_MAX_KEYWORDS
+ * @return @ref rkai_decision_fusion_t or NULL on failure
+ */
+rkai_decision_fusion_t rkai_create_decision_fusion(const rkai_fusion_config_t *configs, int keyword_num);
+
+/**
+ * @brief Release the decision fusion
+ *
+ * @param fusion [in] fusion to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_decision_fusion(rkai_decision_fusion_t fusion);
+
+/**
+ * @brief Change the thresholds of a keyword, from the thread updating the fusion. The score history is kept
+ *
+ * @param fusion [in] decision fusion
+ * @param keyword [in] index of the keyword
+ * @param on_threshold [in] the keyword fires when the smoothed score reaches it
+ * @param off_threshold [in] the keyword re-arms when the smoothed score drops under it, at most on_threshold
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_decision_fusion_set_thresholds(rkai_decision_fusion_t fusion, int keyword, float on_threshold,
+                                               float off_threshold);
+
+/**
+ * @brief Add the scores of the next window. Windows skipped without inference should be added with zero scores so
+ *        the smoothing sees them
+ *
+ * @param fusion [in] decision fusion
+ * @param scores [in] One score per keyword
+ * @param window_start [in] Absolute sample index of the first sample of the window
+ * @param event [out] Debounced event, is_triggered is set on the window a keyword fires
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_decision_fusion_update(rkai_decision_fusion_t fusion, const float *scores, int64_t window_start,
+                                       rkai_fusion_event_t *event);
+
+/**
+ * @brief Forget the score history and the refractory periods
+ *
+ * @param fusion [in] decision fusion
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_decision_fusion_reset(rkai_decision_fusion_t fusion);
+
+/**
+ * @brief Get the event counters. Can be called from any thread
+ *
+ * @param fusion [in] decision fusion
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_decision_fusion_get_stats(rkai_decision_fusion_t fusion, rkai_fusion_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_DECISION_FUSION_H
@@ -0,0 +1,92 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+
+#ifndef SMARTROBOT_RKAI_ECHO_CANCELLER_H
+#define SMARTROBOT_RKAI_ECHO_CANCELLER_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default canceller parameters: 8 ms blocks, 128 ms echo tail, delays up to 500 ms estimated every second,
+ *        double talk 6 dB over the converged residual, -60 dBFS silent reference
+ *
+ * @param sample_rate [in] sample rate of the capture and the reference
+ * @param config [out] canceller parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_echo_canceller_default_config(int sample_rate, rkai_echo_canceller_config_t *config);
+
+/**
+ * @brief Create an acoustic echo canceller. The reference (the audio being played) is delayed by an estimate of
+ *        the echo delay, from the cross-correlation of the capture with the reference, then a partitioned block
+ *        frequency domain NLMS filter models the echo path and subtracts the echo from the capture.
+ *
+ *        Two filters are kept: one adapts on every block, the other one makes the output and only takes the
+ *        coefficients of the first when it cancels better. Near end speech during the playback (double talk)
+ *        makes the adapting filter diverge without harming the output, and the output filter follows an echo path
+ *        change as soon as the adapting filter has learnt it.
+ *
+ * @param config [in] canceller parameters
+ * @return @ref rkai_echo_canceller_t or NULL on failure
+ */
+rkai_echo_canceller_t rkai_create_echo_canceller(const rkai_echo_canceller_config_t *config);
+
+/**
+ * @brief Release the canceller
+ *
+ * @param canceller [in] canceller to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_echo_canceller(rkai_echo_canceller_t canceller);
+
+/**
+ * @brief Cancel the echo of the reference in the capture. The reference sample i is the one sent to the speaker
+ *        when the capture sample i was recorded, give zeros when nothing is played. The output lags the capture
+ *        by block_size samples. Must be called by one thread at a time, on consecutive samples of the streams
+ *
+ * @param canceller [in] echo canceller
+ * @param capture [in] Microphone samples, mono
+ * @param reference [in] Played samples, mono, as many as capture
+ * @param size [in] Number of samples
+ * @param output [out] Capture without the echo, size samples, can be capture
+ * @param is_double_talk [out] 1 if the last block had near end speech over the echo, can be NULL
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_echo_canceller_process(rkai_echo_canceller_t canceller, const float *capture, const float *reference,
+                                       int size, float *output, int *is_double_talk);
+
+/**
+ * @brief Forget the echo path and the delay, e.g. when the audio route changes
+ *
+ * @param canceller [in] echo canceller
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_echo_canceller_reset(rkai_echo_canceller_t canceller);
+
+/**
+ * @brief Get the counters, the delay and the echo return loss enhancement. Can be called from any thread
+ *
+ * @param canceller [in] echo canceller
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_echo_canceller_get_stats(rkai_echo_canceller_t canceller, rkai_echo_canceller_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_ECHO_CANCELLER_H
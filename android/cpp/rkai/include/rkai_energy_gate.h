@@ -0,0 +1,85 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_ENERGY_GATE_H
+#define SMARTROBOT_RKAI_ENERGY_GATE_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default gate parameters: 20 ms frames, noise floor tracked over the last 3 s, 10 dB margin, -60 dBFS
+ *        absolute floor
+ *
+ * @param sample_rate [in] sample rate of the audio
+ * @param config [out] gate parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_energy_gate_default_config(int sample_rate, rkai_energy_gate_config_t *config);
+
+/**
+ * @brief Create an energy gate to put in front of the melspectrogram and the inference. It tracks the noise floor
+ *        with minimum statistics on the smoothed frame power, and lets a window through only when one of its frames
+ *        is louder than the noise floor plus a margin. Stationary noise (air conditioning, a silent lobby) is skipped
+ *        without running the models.
+ *
+ * @param config [in] gate parameters
+ * @return @ref rkai_energy_gate_t or NULL on failure
+ */
+rkai_energy_gate_t rkai_create_energy_gate(const rkai_energy_gate_config_t *config);
+
+/**
+ * @brief Release the gate
+ *
+ * @param gate [in] gate to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_energy_gate(rkai_energy_gate_t gate);
+
+/**
+ * @brief Update the noise floor with the new samples of the window, then check whether the window has energy above
+ *        the floor. Must be called by one thread at a time, on consecutive windows of the same stream
+ *
+ * @param gate [in] energy gate
+ * @param audio [in] Window of float samples, mono
+ * @param new_sample_count [in] Number of samples at the end of the window not seen by the previous call
+ *                              (the stride, or the whole window for the first call)
+ * @param is_active [out] 1 if the window should be processed, 0 if it can be skipped
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_energy_gate_process(rkai_energy_gate_t gate, rkai_audio_t *audio, int new_sample_count,
+                                    int *is_active);
+
+/**
+ * @brief Forget the noise floor, e.g. when the stream restarts
+ *
+ * @param gate [in] energy gate
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_energy_gate_reset(rkai_energy_gate_t gate);
+
+/**
+ * @brief Get the skip counters and the current noise floor. Can be called from any thread
+ *
+ * @param gate [in] energy gate
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_energy_gate_get_stats(rkai_energy_gate_t gate, rkai_energy_gate_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_ENERGY_GATE_H
@@ -16,9 +16,11 @@ extern "C" {
 #endif
 
 /**
- * @brief This function will init the content of the handle.
+ * @brief This function will init the content of the handle. Anchors and input size are stored in the handle, so
+ *        several detectors (e.g. one per camera) can run at the same time
  *
  * @param handle [in] rkai handle
+ * @param asset_mgr [in] asset manager to load the model from, NULL to use the one set by android_fopen_set_asset_manager
  * @return @ref rkai_ret_t return code.
  */
 rkai_ret_t rkai_init_detector(rkai_handle_t handle);
@@ -59,12 +61,86 @@ rkai_ret_t rkai_person_detect(rkai_handle_t handle, rkai_image_t *image, rkai_de
  * @param enable_autotrack [in] If this option is true, autotrack will enable then interpolate the output base on
  *                              history trajectory. Otherwise, output will be interpolate by history and current detection input
  * @return rkai_ret_t
+ * @note The tracker is owned by the handle, use one handle per video stream
  */
 rkai_ret_t rkai_object_autotrack(rkai_handle_t handle, rkai_image_t *image, \
                                 int time_out, rkai_det_array_t *in_track_object, \
                                 rkai_det_array_t *out_track_object, bool enable_autotrack, int track_frame, bool flush_all_id);
 
-rkai_ret_t rkai_required_detect_size(rkai_size_t *required_size);
+/**
+ * @brief Get the input size of the face detection model loaded in the handle
+ *
+ * @param handle [in] initialized rkai handle
+ * @param required_size [out] model input size
+ * @return rkai_ret_t return code
+ */
+rkai_ret_t rkai_required_detect_size(rkai_handle_t handle, rkai_size_t *required_size);
+
+/**
+ * @brief Create a pipelined face detector. @ref rkai_face_detect runs preprocessing, inference and postprocessing of
+ *        one frame in sequence, so the CPU waits for the NPU and the NPU waits for the CPU. The pipeline keeps
+ *        @p staging_num frames in flight: frame N+1 is preprocessed on the submitting thread while frame N is on the
+ *        NPU thread and frame N-1 is decoded on the postprocess thread. Results are delivered in submission order.
+ *
+ * ```
+ *  rkai_face_pipeline_t pipeline = rkai_create_face_pipeline(handle, 3);
+ *  // Camera thread
+ *  rkai_face_pipeline_submit(pipeline, &image, 0, &frame_id);
+ *  // Consumer thread
+ *  while (rkai_face_pipeline_get_result(pipeline, -1, &frame_id, &detected_face_array) != RKAI_RET_TIMEOUT) { ... }
+ * ```
+ *
+ * @param handle [in] Handle initialized by @ref rkai_init_detector. The pipeline runs it from its own NPU thread,
+ *                    so it must not be used elsewhere until the pipeline is released. It is not owned by the pipeline
+ * @param staging_num [in] Number of staging buffers (>= 2). 3 lets all three stages work at the same time
+ * @return @ref rkai_face_pipeline_t or NULL on failure
+ */
+rkai_face_pipeline_t rkai_create_face_pipeline(rkai_handle_t handle, int staging_num);
+
+/**
+ * @brief Stop the pipeline threads and free the staging buffers. Frames not collected yet are dropped.
+ *        No other pipeline function may be running when calling this function
+ *
+ * @param pipeline [in] pipeline to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_face_pipeline(rkai_face_pipeline_t pipeline);
+
+/**
+ * @brief Preprocess the image into a free staging buffer on the calling thread and queue it for inference.
+ *        The image can be released as soon as the function returns
+ *
+ * @param pipeline [in] face detection pipeline
+ * @param image [in] Input image
+ * @param timeout_ms [in] Maximum waiting time when all staging buffers are in flight. 0: do not wait, < 0: wait forever.
+ *                        Buffers are only freed by @ref rkai_face_pipeline_get_result, so a caller that submits and
+ *                        collects on the same thread must not wait forever
+ * @param frame_id [out] Sequence number of the frame, can be NULL
+ * @return @ref rkai_ret_t RKAI_RET_TIMEOUT if no staging buffer became free in time
+ */
+rkai_ret_t rkai_face_pipeline_submit(rkai_face_pipeline_t pipeline, rkai_image_t *image, int timeout_ms,
+                                     uint64_t *frame_id);
+
+/**
+ * @brief Collect the result of the oldest frame not collected yet
+ *
+ * @param pipeline [in] face detection pipeline
+ * @param timeout_ms [in] Maximum waiting time for the result. 0: do not wait, < 0: wait forever
+ * @param frame_id [out] Sequence number of the frame given by @ref rkai_face_pipeline_submit, can be NULL
+ * @param detected_face_array [out] Output face array, in the coordinate of the submitted image
+ * @return @ref rkai_ret_t return code of the frame, RKAI_RET_TIMEOUT if no result became ready in time
+ */
+rkai_ret_t rkai_face_pipeline_get_result(rkai_face_pipeline_t pipeline, int timeout_ms, uint64_t *frame_id,
+                                         rkai_det_array_t *detected_face_array);
+
+/**
+ * @brief Get throughput and per stage timing counters of the pipeline
+ *
+ * @param pipeline [in] face detection pipeline
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_face_pipeline_get_stats(rkai_face_pipeline_t pipeline, rkai_face_pipeline_stats_t *stats);
 #ifdef __cplusplus
 }
 #endif
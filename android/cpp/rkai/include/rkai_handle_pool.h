@@ -0,0 +1,84 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_HANDLE_POOL_H
+#define SMARTROBOT_RKAI_HANDLE_POOL_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a pool of handles running the same model. A single rknn context must not be used by two threads
+ *        at the same time, so callers on different threads check out their own handle from the pool, run the
+ *        inference, then check it back in.
+ *
+ * ```
+ *  rkai_handle_t handle = rkai_create_handle();
+ *  rkai_init_detector(handle);
+ *  rkai_handle_pool_t pool = rkai_create_handle_pool(handle, 2);
+ *
+ *  rkai_handle_t worker_handle;
+ *  if (rkai_handle_pool_checkout(pool, 100, &worker_handle) == RKAI_RET_SUCCESS) {
+ *      rkai_face_detect(worker_handle, image, &detected_face_array);
+ *      rkai_handle_pool_checkin(pool, worker_handle);
+ *  }
+ * ```
+ *
+ * @param handle [in] Initialized handle. The pool takes the ownership of it, do not release it directly
+ * @param pool_size [in] Number of contexts in the pool (>= 1). pool_size - 1 contexts are duplicated from @p handle
+ * @return @ref rkai_handle_pool_t or NULL on failure
+ */
+rkai_handle_pool_t rkai_create_handle_pool(rkai_handle_t handle, int pool_size);
+
+/**
+ * @brief Release the pool and all of its handles. All handles must be checked in before calling this function
+ *
+ * @param pool [in] pool to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_handle_pool(rkai_handle_pool_t pool);
+
+/**
+ * @brief Take a free handle from the pool for exclusive use by the calling thread
+ *
+ * @param pool [in] handle pool
+ * @param timeout_ms [in] Maximum waiting time when all handles are in use. 0: do not wait, < 0: wait forever
+ * @param handle [out] checked out handle
+ * @return @ref rkai_ret_t RKAI_RET_TIMEOUT if no handle became free in time
+ */
+rkai_ret_t rkai_handle_pool_checkout(rkai_handle_pool_t pool, int timeout_ms, rkai_handle_t *handle);
+
+/**
+ * @brief Return a handle taken by @ref rkai_handle_pool_checkout to the pool
+ *
+ * @param pool [in] handle pool
+ * @param handle [in] handle to be returned
+ * @return @ref rkai_ret_t RKAI_RET_INVALID_INPUT_PARAM if the handle is not checked out from this pool
+ */
+rkai_ret_t rkai_handle_pool_checkin(rkai_handle_pool_t pool, rkai_handle_t handle);
+
+/**
+ * @brief Get usage and contention counters of the pool
+ *
+ * @param pool [in] handle pool
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_handle_pool_get_stats(rkai_handle_pool_t pool, rkai_handle_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_HANDLE_POOL_H
@@ -0,0 +1,82 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_KEYWORD_SPOTTER_H
+#define SMARTROBOT_RKAI_KEYWORD_SPOTTER_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a keyword spotter running several keyword models on the same window. Models with the same
+ *        melspectrogram config share one front-end, computed once per window, and each model may output K classes:
+ *        class 0 is the background and classes 1 to K-1 are keywords. The scores of all the models are gathered in
+ *        one vector per window, to be given to @ref rkai_decision_fusion_update with one policy per keyword.
+ *
+ * ```
+ *  rkai_keyword_spotter_t spotter = rkai_create_keyword_spotter();
+ *  rkai_keyword_spotter_add_model(spotter, hello_robot_handle, &first, &num);    // keyword 0
+ *  rkai_keyword_spotter_add_model(spotter, stop_handle, &first, &num);           // keyword 1, same front-end
+ *  rkai_keyword_spotter_detect(spotter, &audio, &scores);
+ * ```
+ *
+ * @return @ref rkai_keyword_spotter_t or NULL on failure
+ */
+rkai_keyword_spotter_t rkai_create_keyword_spotter(void);
+
+/**
+ * @brief Release the keyword spotter. The handles of the models are not released
+ *
+ * @param spotter [in] keyword spotter to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_keyword_spotter(rkai_keyword_spotter_t spotter);
+
+/**
+ * @brief Register a trigger word model. Its keywords are appended to the score vector
+ *
+ * @param spotter [in] keyword spotter
+ * @param handle [in] Initialized trigger word handle, must outlive the spotter
+ * @param first_keyword [out] Index of the first keyword of the model in the score vector
+ * @param keyword_num [out] Number of keywords of the model (output classes - 1)
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_keyword_spotter_add_model(rkai_keyword_spotter_t spotter, rkai_handle_t handle, int *first_keyword,
+                                          int *keyword_num);
+
+/**
+ * @brief Compute each front-end once and run every model on the window
+ *
+ * @param spotter [in] keyword spotter
+ * @param audio [in] Window of audio
+ * @param scores [out] Score of each keyword
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_keyword_spotter_detect(rkai_keyword_spotter_t spotter, rkai_audio_t *audio,
+                                       rkai_keyword_scores_t *scores);
+
+/**
+ * @brief Get the time spent in the front-ends and in the models. Can be called from any thread
+ *
+ * @param spotter [in] keyword spotter
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_keyword_spotter_get_stats(rkai_keyword_spotter_t spotter, rkai_keyword_spotter_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_KEYWORD_SPOTTER_H
@@ -0,0 +1,94 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+
+#ifndef SMARTROBOT_RKAI_NOISE_SUPPRESSOR_H
+#define SMARTROBOT_RKAI_NOISE_SUPPRESSOR_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default suppressor for the transform of a melspectrogram front-end: Wiener gain, noise estimate following
+ *        a lower level in 0.5 s and rising 3 dB per second under speech, gain floor of -12 dB
+ *
+ * @param front_end [in] melspectrogram config of the model the gains are applied for
+ * @param config [out] suppressor parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_noise_suppressor_default_config(const rkai_melspectrogram_config_t *front_end,
+                                                rkai_noise_suppressor_config_t *config);
+
+/**
+ * @brief Create a noise suppressor working on the short-time spectra of the capture.
+ *
+ *        The noise power of each bin is tracked by a recursive average over the frames where the bin is near the
+ *        estimate, and rises slowly while it is far above, e.g. under speech or when the HVAC starts. The gains are
+ *        a Wiener gain of the decision directed a priori SNR, or a power spectral subtraction, floored.
+ *
+ *        The spectra are given by window, and the windows of the detectors overlap: the frames are placed on the
+ *        capture by their position, the noise estimate only learns from the frames after the last one it learned
+ *        from, the others are only given gains. See @ref rkai_audio_to_denoised_melspectrogram for the front-end
+ *        using it.
+ *
+ * @param config [in] suppressor parameters
+ * @return @ref rkai_noise_suppressor_t or NULL on failure
+ */
+rkai_noise_suppressor_t rkai_create_noise_suppressor(const rkai_noise_suppressor_config_t *config);
+
+/**
+ * @brief Release the suppressor
+ *
+ * @param suppressor [in] suppressor to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_noise_suppressor(rkai_noise_suppressor_t suppressor);
+
+/**
+ * @brief Update the noise estimate and compute the gains of the frames of a window. Must be called by one thread at
+ *        a time
+ *
+ * @param suppressor [in] noise suppressor
+ * @param position [in] Capture sample the first frame is centered on, the next ones are hop_length apart
+ * @param power [in] Power spectra, frame_num frames of bin_num bins
+ * @param frame_num [in] Number of frames
+ * @param bin_num [in] Bins per frame, n_fft / 2 + 1
+ * @param gains [out] Amplitude gains in the layout of power, can be power
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_noise_suppressor_process(rkai_noise_suppressor_t suppressor, int64_t position, const float *power,
+                                         int frame_num, int bin_num, float *gains);
+
+/**
+ * @brief Forget the noise estimate, the next frame is learned from whatever its position
+ *
+ * @param suppressor [in] noise suppressor
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_noise_suppressor_reset(rkai_noise_suppressor_t suppressor);
+
+/**
+ * @brief Get the counters, the noise level and the last reduction. Can be called from any thread
+ *
+ * @param suppressor [in] noise suppressor
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_noise_suppressor_get_stats(rkai_noise_suppressor_t suppressor, rkai_noise_suppressor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_NOISE_SUPPRESSOR_H
@@ -0,0 +1,128 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_PACKETIZER_H
+#define SMARTROBOT_RKAI_PACKETIZER_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Packetizer config: 20 ms packets, 2 s of packets queued
+ *
+ * @param sample_rate [in] sample rate of the audio
+ * @param config [out] packetizer parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_packetizer_default_config(int sample_rate, rkai_packetizer_config_t *config);
+
+/**
+ * @brief Create a packetizer. It cuts the audio of the speech segments into fixed size packets as soon as the
+ *        segmenter confirms a segment, the first packets starting at the segment start, and queues them for a
+ *        consumer thread. Packets are numbered in order, a packet that does not fit in the queue is dropped and
+ *        its sequence number skipped, so packets are never reordered nor repeated. The queue is allocated here.
+ *
+ * ```
+ *  // vad thread
+ *  rkai_packetizer_on_event(packetizer, &event);                 // for each segmenter event
+ *  rkai_packetizer_get_cursor(packetizer, &next_sample);         // then as often as new audio comes
+ *  if (next_sample >= 0) { read(next_sample, write_index); rkai_packetizer_produce(...); }
+ *  // consumer thread
+ *  rkai_packetizer_poll(packetizer, &packet, timeout_ms, &has_packet);
+ * ```
+ *
+ * @param config [in] packetizer parameters
+ * @return @ref rkai_packetizer_t or NULL on failure
+ */
+rkai_packetizer_t rkai_create_packetizer(const rkai_packetizer_config_t *config);
+
+/**
+ * @brief Release the packetizer, no thread may use it any more
+ *
+ * @param packetizer [in] packetizer to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_packetizer(rkai_packetizer_t packetizer);
+
+/**
+ * @brief Open or close a segment from a segmenter event. A segment is sent from its start sample, even if the
+ *        previous one was sent past it. The audio sent after the end of a segment, while the segmenter waited for
+ *        the silence, is not taken back: the end packet then holds no sample and its start_sample is the end.
+ *        An end the audio has not reached yet is sent by the next produce, which must come before the next start
+ *        event, or the segment is closed without its last packet
+ *
+ * @param packetizer [in] packetizer
+ * @param event [in] Event of @ref rkai_vad_segmenter_push
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_packetizer_on_event(rkai_packetizer_t packetizer, const rkai_vad_segment_event_t *event);
+
+/**
+ * @brief Get the next capture sample the packetizer needs
+ *
+ * @param packetizer [in] packetizer
+ * @param next_sample [out] Absolute index of the next sample to produce, -1 if no segment is open
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_packetizer_get_cursor(rkai_packetizer_t packetizer, int64_t *next_sample);
+
+/**
+ * @brief Queue the packets of the open segment found in a span of the capture. Whole packets only, except the
+ *        last one of a segment. Samples before the cursor are ignored, samples missing between the cursor and the
+ *        span are skipped and counted
+ *
+ * @param packetizer [in] packetizer
+ * @param audio [in] Samples of the span
+ * @param first_sample [in] Absolute index of audio[0]
+ * @param sample_num [in] Number of samples
+ * @param packet_num [out] Number of packets produced, queued or dropped. Can be NULL
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_packetizer_produce(rkai_packetizer_t packetizer, const float *audio, int64_t first_sample,
+                                   int sample_num, int *packet_num);
+
+/**
+ * @brief Take the oldest packet, waiting up to timeout_ms for one
+ *
+ * @param packetizer [in] packetizer
+ * @param packet [out] Packet, set if has_packet
+ * @param timeout_ms [in] Time to wait, 0 to return at once
+ * @param has_packet [out] 1 if packet is set
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_packetizer_poll(rkai_packetizer_t packetizer, rkai_audio_packet_t *packet, int timeout_ms,
+                                int *has_packet);
+
+/**
+ * @brief Close the open segment without an end packet and empty the queue, e.g. when the capture stops
+ *
+ * @param packetizer [in] packetizer
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_packetizer_reset(rkai_packetizer_t packetizer);
+
+/**
+ * @brief Get the packet counters. Can be called from any thread
+ *
+ * @param packetizer [in] packetizer
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_packetizer_get_stats(rkai_packetizer_t packetizer, rkai_packetizer_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_PACKETIZER_H
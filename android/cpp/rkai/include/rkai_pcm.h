@@ -0,0 +1,72 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_PCM_H
+#define SMARTROBOT_RKAI_PCM_H
+
+#include "rkai_type.h"
+
+#define RKAI_WAV_HEADER_SIZE 44
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief PCM16 export of mono 16kHz audio: no dither, no wav header
+ *
+ * @param sample_rate [in] sample rate of the audio
+ * @param config [out] export parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_pcm16_default_config(int sample_rate, rkai_pcm16_config_t *config);
+
+/**
+ * @brief Bytes written by @ref rkai_pcm16_encode for a number of samples
+ *
+ * @param config [in] export parameters
+ * @param sample_num [in] Number of samples, all channels
+ * @return size in bytes
+ */
+int rkai_pcm16_encoded_size(const rkai_pcm16_config_t *config, int sample_num);
+
+/**
+ * @brief Write the 44 byte header of a little-endian PCM16 wav file
+ *
+ * @param sample_rate [in] sample rate of the audio
+ * @param n_channels [in] number of interleaved channels
+ * @param sample_num [in] Number of samples following the header, all channels
+ * @param out [out] RKAI_WAV_HEADER_SIZE bytes
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_wav_write_header(int sample_rate, int n_channels, int sample_num, uint8_t *out);
+
+/**
+ * @brief Convert float samples in [-1, 1] to little-endian PCM16, clipped, with triangular dither of one LSB if
+ *        enabled, after a wav header if enabled. Vectorized with NEON on arm64. The output only depends on the
+ *        samples and the config, the same dither_seed gives the same bytes
+ *
+ * @param config [in] export parameters
+ * @param samples [in] float samples
+ * @param sample_num [in] Number of samples, all channels
+ * @param out [out] Output bytes, e.g. the address of a direct ByteBuffer
+ * @param out_size [in] Capacity of out, at least @ref rkai_pcm16_encoded_size
+ * @param written [out] Number of bytes written
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_pcm16_encode(const rkai_pcm16_config_t *config, const float *samples, int sample_num,
+                             uint8_t *out, int out_size, int *written);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_PCM_H
@@ -0,0 +1,69 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_SCHEDULER_H
+#define SMARTROBOT_RKAI_SCHEDULER_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create an inference scheduler. Handles attached to the same scheduler do not call rknn_run freely from
+ *        their own threads any more: each inference waits for a free NPU core, and waiting jobs are served by
+ *        priority class first, then by earliest deadline. A job of a handle bound to cores waits for the cores of
+ *        its mask, the others take any free core and are bound to it for the run. A waiting job keeps the cores it
+ *        needs from the jobs served after it, so a lower class never starves it. A running job is never
+ *        preempted, so a latency critical job waits at most for the inference already running on its core.
+ *
+ * @param core_num [in] Number of NPU cores, see @ref rkai_get_npu_core_num. 1 to RKAI_MAX_NPU_CORE_NUM
+ * @return @ref rkai_scheduler_t or NULL on failure
+ */
+rkai_scheduler_t rkai_create_scheduler(int core_num);
+
+/**
+ * @brief Release the scheduler. Handles attached to it must be detached or released first
+ *
+ * @param scheduler [in] scheduler to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_scheduler(rkai_scheduler_t scheduler);
+
+/**
+ * @brief Run all inferences of the handle through the scheduler
+ *
+ * @param scheduler [in] scheduler, NULL to detach the handle and run it directly
+ * @param handle [in] Initialized handle. Handles duplicated from it afterwards inherit the same settings
+ * @param priority_class [in] @ref rkai_priority_class_t of the model
+ * @param deadline_ms [in] Relative deadline of one inference, counted from the time the job is submitted
+ * @param core_mask [in] rknn_core_mask of the model within the cores of the scheduler, RKNN_NPU_CORE_AUTO to
+ *                       run it on any free core
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_scheduler_attach(rkai_scheduler_t scheduler, rkai_handle_t handle,
+                                 rkai_priority_class_t priority_class, int deadline_ms, int core_mask);
+
+/**
+ * @brief Get per priority class queueing counters
+ *
+ * @param scheduler [in] scheduler
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_scheduler_get_stats(rkai_scheduler_t scheduler, rkai_scheduler_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_SCHEDULER_H
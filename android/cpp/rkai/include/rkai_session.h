@@ -0,0 +1,156 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_SESSION_H
+#define SMARTROBOT_RKAI_SESSION_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Session writer config: 4 MB of chunks queued, images decimated to at most 160 pixels wide
+ *
+ * @param config [out] writer parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_session_default_config(rkai_session_config_t *config);
+
+/**
+ * @brief Create a session file and the thread writing it. A session is a 16 byte file header, the magic "RKSN",
+ *        a version and the wall clock time of the start in us, then chunks in the order they were written, each a
+ *        @ref rkai_chunk_header_t followed by its payload. Writing a chunk only copies it into a queue allocated
+ *        here and never waits for the disk, a chunk that does not fit is dropped and counted. Several threads can
+ *        write.
+ *
+ * ```
+ *  rkai_session_write_audio(writer, source, first_sample, samples, sample_num);    // capture thread
+ *  rkai_session_write_image(writer, source, frame, &image);                       // camera thread
+ *  rkai_session_write(writer, RKAI_CHUNK_EVENT, source, sample, -1, &event, sizeof(event));
+ * ```
+ *
+ * @param path [in] File to create
+ * @param config [in] writer parameters
+ * @return @ref rkai_session_writer_t or NULL on failure
+ */
+rkai_session_writer_t rkai_create_session_writer(const char *path, const rkai_session_config_t *config);
+
+/**
+ * @brief Write the chunks still queued, close the file and release the writer. No thread may use it any more
+ *
+ * @param writer [in] writer to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_session_writer(rkai_session_writer_t writer);
+
+/**
+ * @brief Time since the session start, as the chunks written without a timestamp get it
+ *
+ * @param writer [in] writer
+ * @param timestamp_us [out] Time in us
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_session_get_time(rkai_session_writer_t writer, int64_t *timestamp_us);
+
+/**
+ * @brief Queue a chunk
+ *
+ * @param writer [in] writer
+ * @param type [in] @ref rkai_chunk_type
+ * @param source [in] Producer of the chunk
+ * @param position [in] Capture sample or frame number the chunk is about
+ * @param timestamp_us [in] Time since the session start, negative for now
+ * @param payload [in] size bytes, can be NULL if size is 0
+ * @param size [in] Payload bytes
+ * @return @ref rkai_ret_t, RKAI_RET_COMMON_FAIL if the chunk was dropped
+ */
+rkai_ret_t rkai_session_write(rkai_session_writer_t writer, uint32_t type, uint32_t source, int64_t position,
+                              int64_t timestamp_us, const void *payload, int size);
+
+/**
+ * @brief Queue a chunk of capture samples, stored as they are so a replay gives the detectors the same input
+ *
+ * @param writer [in] writer
+ * @param source [in] Producer of the chunk
+ * @param first_sample [in] Capture index of samples[0]
+ * @param samples [in] Mono capture samples
+ * @param sample_num [in] Number of samples
+ * @return @ref rkai_ret_t, RKAI_RET_COMMON_FAIL if the chunk was dropped
+ */
+rkai_ret_t rkai_session_write_audio(rkai_session_writer_t writer, uint32_t source, int64_t first_sample,
+                                    const float *samples, int sample_num);
+
+/**
+ * @brief Queue an image chunk, decimated to config.max_image_width by keeping one pixel in factor on each axis
+ *
+ * @param writer [in] writer
+ * @param source [in] Producer of the chunk
+ * @param frame [in] Frame number
+ * @param image [in] Image in a packed format, gray, RGB or RGBA
+ * @return @ref rkai_ret_t, RKAI_RET_COMMON_FAIL if the chunk was dropped
+ */
+rkai_ret_t rkai_session_write_image(rkai_session_writer_t writer, uint32_t source, int64_t frame,
+                                    const rkai_image_t *image);
+
+/**
+ * @brief Get the counters of the writer. Can be called from any thread
+ *
+ * @param writer [in] writer
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_session_get_stats(rkai_session_writer_t writer, rkai_session_stats_t *stats);
+
+/**
+ * @brief Open a session file for reading
+ *
+ * @param path [in] Session file
+ * @param start_time_us [out] Wall clock time of the session start in us, can be NULL
+ * @return @ref rkai_session_reader_t or NULL if the file is not a session
+ */
+rkai_session_reader_t rkai_open_session_reader(const char *path, int64_t *start_time_us);
+
+/**
+ * @brief Close the file and release the reader
+ *
+ * @param reader [in] reader to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_session_reader(rkai_session_reader_t reader);
+
+/**
+ * @brief Read the header of the next chunk. Its payload is read with @ref rkai_session_read_payload or skipped by
+ *        the next call
+ *
+ * @param reader [in] reader
+ * @param header [out] Header of the chunk
+ * @param has_chunk [out] 0 at the end of the session, or on a chunk cut short by the end of the file
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_session_next_chunk(rkai_session_reader_t reader, rkai_chunk_header_t *header, int *has_chunk);
+
+/**
+ * @brief Read the payload of the chunk of the last @ref rkai_session_next_chunk
+ *
+ * @param reader [in] reader
+ * @param payload [out] header.size bytes
+ * @param max_size [in] Capacity of payload, at least header.size
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_session_read_payload(rkai_session_reader_t reader, void *payload, int max_size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_SESSION_H
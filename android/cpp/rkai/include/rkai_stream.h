@@ -0,0 +1,102 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_STREAM_H
+#define SMARTROBOT_RKAI_STREAM_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Prepare a handle to run a streaming model. A streaming model takes a short chunk (e.g. 100 ms of mel
+ *        frames) instead of a whole window and carries its recurrent state between the chunks:
+ *
+ *        - input 0 is the chunk, inputs 1 to n-1 are the state tensors
+ *        - output 0 is the scores, outputs 1 to n-1 are the updated state tensors, in the same order as the inputs
+ *
+ *        The state is held by the handle (duplicated handles start with their own zero state), so each chunk only
+ *        costs the new audio instead of recomputing the overlap of the windows.
+ *
+ * @param handle [in] Handle initialized with a streaming model
+ * @param config [in] Streaming parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_stream_init(rkai_handle_t handle, const rkai_stream_config_t *config);
+
+/**
+ * @brief Run the model on the next chunk and keep the updated state. Silent chunks do not run the model, after
+ *        silence_reset_chunks of them in a row the state is reset so the next utterance starts clean
+ *
+ * @param handle [in] Handle prepared by @ref rkai_stream_init
+ * @param chunk [in] Input of the chunk, the size of the input 0 of the model
+ * @param is_silent [in] 1 if the chunk has no energy, see @ref rkai_energy_gate_process
+ * @param scores [out] Output 0 of the model, zeros for silent chunks
+ * @param max_score_num [in] Capacity of scores
+ * @param score_num [out] Number of scores written
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_stream_run(rkai_handle_t handle, const float *chunk, int is_silent, float *scores, int max_score_num,
+                           int *score_num);
+
+/**
+ * @brief Set the state back to zeros
+ *
+ * @param handle [in] Handle prepared by @ref rkai_stream_init
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_stream_reset(rkai_handle_t handle);
+
+/**
+ * @brief Get the number of floats of all the state tensors, the size of a snapshot
+ *
+ * @param handle [in] Handle prepared by @ref rkai_stream_init
+ * @param size [out] Number of floats
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_stream_get_state_size(rkai_handle_t handle, int *size);
+
+/**
+ * @brief Copy the state to a buffer of the caller, e.g. before speculatively running a chunk
+ *
+ * @param handle [in] Handle prepared by @ref rkai_stream_init
+ * @param snapshot [out] Buffer of @ref rkai_stream_get_state_size floats
+ * @param size [in] Number of floats of snapshot
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_stream_snapshot(rkai_handle_t handle, float *snapshot, int size);
+
+/**
+ * @brief Set the state from a snapshot
+ *
+ * @param handle [in] Handle prepared by @ref rkai_stream_init
+ * @param snapshot [in] State saved by @ref rkai_stream_snapshot
+ * @param size [in] Number of floats of snapshot
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_stream_restore(rkai_handle_t handle, const float *snapshot, int size);
+
+/**
+ * @brief Get the run counters of the stream
+ *
+ * @param handle [in] Handle prepared by @ref rkai_stream_init
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_stream_get_stats(rkai_handle_t handle, rkai_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_STREAM_H
@@ -0,0 +1,74 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_TELEMETRY_H
+#define SMARTROBOT_RKAI_TELEMETRY_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a ring keeping the last capacity entries written by a detector. Writing takes no lock and does
+ *        not allocate, it can be done on the detector thread for every window. Several threads can write, a
+ *        snapshot can be taken from any thread at any time and only holds whole entries
+ *
+ * @param capacity [in] Entries kept
+ * @return @ref rkai_telemetry_t or NULL on failure
+ */
+rkai_telemetry_t rkai_create_telemetry(int capacity);
+
+/**
+ * @brief Release the ring, no thread may use it any more
+ *
+ * @param telemetry [in] ring to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_telemetry(rkai_telemetry_t telemetry);
+
+/**
+ * @brief Write an entry over the oldest one. Its sequence and timestamp_us are set by the ring. If a writer
+ *        lapped by capacity entries still holds the slot, the entry is dropped and counted
+ *
+ * @param telemetry [in] ring
+ * @param entry [in] Entry to write
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_telemetry_write(rkai_telemetry_t telemetry, const rkai_telemetry_entry_t *entry);
+
+/**
+ * @brief Copy the entries of the ring, oldest first. An entry being written during the copy is left out
+ *
+ * @param telemetry [in] ring
+ * @param entries [out] Entries, up to max_entry_num of the newest
+ * @param max_entry_num [in] Capacity of entries
+ * @param entry_num [out] Number of entries copied
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_telemetry_snapshot(rkai_telemetry_t telemetry, rkai_telemetry_entry_t *entries, int max_entry_num,
+                                   int *entry_num);
+
+/**
+ * @brief Get the counters of the ring. Can be called from any thread
+ *
+ * @param telemetry [in] ring
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_telemetry_get_stats(rkai_telemetry_t telemetry, rkai_telemetry_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_TELEMETRY_H
@@ -13,17 +13,26 @@
 extern "C" {
 #endif
 /**
- * @brief This function will init the content of the handle.
+ * @brief This function will init the content of the handle. The model config is stored in the handle, so several
+ *        handles can be initialized and used independently
  *
  * @param handle [in] rkai handle
+ * @param asset_mgr [in] asset manager to load the model from, NULL to use the one set by android_fopen_set_asset_manager
  * @return @ref rkai_ret_t return code.
  */
 rkai_ret_t rkai_init_trigger_word_bc_model(rkai_handle_t handle);
 rkai_ret_t rkai_init_trigger_word_android_bc_model(rkai_handle_t handle, AAssetManager *asset_mgr);
 rkai_ret_t rkai_init_trigger_word_conv_model(rkai_handle_t handle);
 rkai_ret_t rkai_init_trigger_word_android_conv_model(rkai_handle_t handle, AAssetManager *asset_mgr);
-rkai_melspectrogram_config_t rkai_get_bc_config();
-rkai_melspectrogram_config_t rkai_get_conv_config();
+
+/**
+ * @brief Get the melspectrogram config of the trigger word model loaded in the handle
+ *
+ * @param handle [in] initialized rkai handle
+ * @param config [out] model config
+ * @return @ref rkai_ret_t return code.
+ */
+rkai_ret_t rkai_get_trigger_word_config(rkai_handle_t handle, rkai_melspectrogram_config_t *config);
 
 /**
  * @brief This function will run an inference session to detect if the audio contains trigger word
@@ -36,6 +45,20 @@ rkai_ret_t rkai_trigger_word_detect(rkai_handle_t handle, rkai_audio_t *audio,
                                     rkai_melspectrogram_config_t config,
                                     rkai_trigger_word_result_t *detected_trigger_word,
                                     float low_threshold, float high_threshold);
+
+/**
+ * @brief Run the model on a melspectrogram computed by the caller, so one melspectrogram can be given to several
+ *        models with the same config
+ *
+ * @param handle [in] rkai handle
+ * @param melspectrogram [in] Melspectrogram of the window, made with the config of the model
+ * @param scores [out] Probability of each output class, class 0 is the background
+ * @param max_score_num [in] Capacity of scores
+ * @param score_num [out] Number of scores written
+ * @return @ref rkai_ret_t return code.
+ */
+rkai_ret_t rkai_trigger_word_infer(rkai_handle_t handle, const rkai_melspectrogram_t *melspectrogram,
+                                   float *scores, int max_score_num, int *score_num);
 #ifdef __cplusplus
 };
 #endif
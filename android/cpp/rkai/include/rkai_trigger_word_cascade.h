@@ -0,0 +1,104 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_TRIGGER_WORD_CASCADE_H
+#define SMARTROBOT_RKAI_TRIGGER_WORD_CASCADE_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a cascade of trigger word models. Each window is run through the stages in order and stops at the
+ *        first stage whose score is not higher than its threshold, so the later (bigger) models and their
+ *        melspectrogram only run on windows the cheaper models could not reject.
+ *
+ * ```
+ *  rkai_cascade_stage_t stages[2] = {{bc_handle, 0.6}, {conv_handle, 0.7}};
+ *  rkai_trigger_word_cascade_t cascade = rkai_create_trigger_word_cascade(stages, 2);
+ *  rkai_cascade_result_t result;
+ *  if (rkai_trigger_word_cascade_detect(cascade, &audio, &result) == RKAI_RET_SUCCESS && result.is_detected) { ... }
+ * ```
+ *
+ * @param stages [in] Stages in running order. The handles are not owned by the cascade and must outlive it
+ * @param stage_num [in] Number of stages, 1 to RKAI_CASCADE_MAX_STAGES
+ * @return @ref rkai_trigger_word_cascade_t or NULL on failure
+ */
+rkai_trigger_word_cascade_t rkai_create_trigger_word_cascade(const rkai_cascade_stage_t *stages, int stage_num);
+
+/**
+ * @brief Release the cascade. The stage handles are not released
+ *
+ * @param cascade [in] cascade to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_trigger_word_cascade(rkai_trigger_word_cascade_t cascade);
+
+/**
+ * @brief Change the threshold of a stage
+ *
+ * @param cascade [in] trigger word cascade
+ * @param stage [in] index of the stage
+ * @param threshold [in] new threshold
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_trigger_word_cascade_set_threshold(rkai_trigger_word_cascade_t cascade, int stage, float threshold);
+
+/**
+ * @brief Run the cascade on one window. Like the stage handles, a cascade must be used by one thread at a time
+ *
+ * @param cascade [in] trigger word cascade
+ * @param audio [in] Input audio window, shared by all stages without copy
+ * @param result [out] scores and exit stage
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_trigger_word_cascade_detect(rkai_trigger_word_cascade_t cascade, rkai_audio_t *audio,
+                                            rkai_cascade_result_t *result);
+
+/**
+ * @brief Suppress the noise in the melspectrogram of the stages with the transform of the suppressor, in the windows
+ *        given with their position. The stages with the same front-end share one melspectrogram
+ *
+ * @param cascade [in] trigger word cascade
+ * @param suppressor [in] Suppressor, not owned by the cascade, NULL to stop suppressing
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_trigger_word_cascade_set_noise_suppressor(rkai_trigger_word_cascade_t cascade,
+                                                          rkai_noise_suppressor_t suppressor);
+
+/**
+ * @brief Run the cascade on one window placed on the capture, the noise suppressor learns from its new frames
+ *
+ * @param cascade [in] trigger word cascade
+ * @param audio [in] Input audio window, shared by all stages without copy
+ * @param position [in] Capture sample of the first sample of the window, -1 to not suppress the noise
+ * @param result [out] scores and exit stage
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_trigger_word_cascade_detect_at(rkai_trigger_word_cascade_t cascade, rkai_audio_t *audio,
+                                               int64_t position, rkai_cascade_result_t *result);
+
+/**
+ * @brief Get the run, pass and skip counters of each stage. Can be called from any thread
+ *
+ * @param cascade [in] trigger word cascade
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_trigger_word_cascade_get_stats(rkai_trigger_word_cascade_t cascade, rkai_cascade_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_TRIGGER_WORD_CASCADE_H
@@ -30,11 +30,20 @@ extern "C" {
 
 typedef struct _rkai_handle_t {
     rknn_context context;
+    struct _rkai_scheduler_t *scheduler;   /// Scheduler that orders rknn_run of this handle with other models. NULL: run directly
+    int priority_class;                    /// @ref rkai_priority_class_t used when the handle is run through the scheduler
+    int64_t deadline_us;                   /// Relative deadline of one inference of this handle
+    int core_mask;                         /// rknn_core_mask of the context, RKNN_NPU_CORE_AUTO by default
     rknn_input_output_num io_num; /// Save number of input, output
     rknn_tensor_attr *input_tensor_attr;    /// Pointer to input tensor attribute. This will be created dynamically on init function
     uint64_t input_tensor_attr_size;    /// Size of input tensor attribute in byte. sizeof(rknn_tensor_attr)*io_num.n_input
     rknn_tensor_attr *output_tensor_attr;   ///Pointer to output tensor attribute. This will be created dynamically on init function
     uint64_t output_tensor_attr_size; /// Size of output tensor attribute in byte. sizeof(rknn_tensor_attr)*io_num.n_output
+    struct AAssetManager *asset_manager;    /// Asset manager the model files are loaded from. NULL: the one set by android_fopen_set_asset_manager
+    void *model_data;                       /// Read only model state (configs, anchors...) created by the init function, shared with duplicated handles
+    void (*release_model_data)(void *model_data);  /// Release model_data. NULL for handles that only share it
+    void *session_data;                     /// Mutable state of this handle only (e.g. tracker), never shared
+    void (*release_session_data)(void *session_data);  /// Release session_data
 } _rkai_handle_t;
 
 /**
@@ -43,6 +52,116 @@ typedef struct _rkai_handle_t {
  */
 typedef _rkai_handle_t *rkai_handle_t;
 
+/**
+ * @brief Pool of handles sharing one model. See @ref rkai_create_handle_pool
+ *
+ */
+typedef struct _rkai_handle_pool_t *rkai_handle_pool_t;
+
+/**
+ * @brief Scheduler ordering the inferences of several models. See @ref rkai_create_scheduler
+ *
+ */
+typedef struct _rkai_scheduler_t *rkai_scheduler_t;
+
+/**
+ * @brief Pipelined face detection overlapping preprocessing, inference and postprocessing. See @ref rkai_create_face_pipeline
+ *
+ */
+typedef struct _rkai_face_pipeline_t *rkai_face_pipeline_t;
+
+/**
+ * @brief Chain of trigger word models run with early exit. See @ref rkai_create_trigger_word_cascade
+ *
+ */
+typedef struct _rkai_trigger_word_cascade_t *rkai_trigger_word_cascade_t;
+
+/**
+ * @brief Adaptive noise floor gate skipping silent audio windows. See @ref rkai_create_energy_gate
+ *
+ */
+typedef struct _rkai_energy_gate_t *rkai_energy_gate_t;
+
+/**
+ * @brief Sliding window stride chosen from the recent scores and energy. See @ref rkai_create_adaptive_stride
+ *
+ */
+typedef struct _rkai_adaptive_stride_t *rkai_adaptive_stride_t;
+
+/**
+ * @brief Picks the next window to read from a recording, bounding the lag. See @ref rkai_create_window_scheduler
+ *
+ */
+typedef struct _rkai_window_scheduler_t *rkai_window_scheduler_t;
+
+/**
+ * @brief Turns per-window keyword scores into debounced events. See @ref rkai_create_decision_fusion
+ *
+ */
+typedef struct _rkai_decision_fusion_t *rkai_decision_fusion_t;
+
+/**
+ * @brief Several keyword models sharing their front-ends. See @ref rkai_create_keyword_spotter
+ *
+ */
+typedef struct _rkai_keyword_spotter_t *rkai_keyword_spotter_t;
+
+/**
+ * @brief Streaming speech segmentation over vad frame scores. See @ref rkai_create_vad_segmenter
+ *
+ */
+typedef struct _rkai_vad_segmenter_t *rkai_vad_segmenter_t;
+
+/**
+ * @brief Merges the frame scores of overlapping vad windows. See @ref rkai_create_vad_score_stream
+ *
+ */
+typedef struct _rkai_vad_score_stream_t *rkai_vad_score_stream_t;
+
+/**
+ * @brief Cuts speech segments into packets for streaming. See @ref rkai_create_packetizer
+ *
+ */
+typedef struct _rkai_packetizer_t *rkai_packetizer_t;
+
+/**
+ * @brief Ring of the recent decisions of a detector. See @ref rkai_create_telemetry
+ *
+ */
+typedef struct _rkai_telemetry_t *rkai_telemetry_t;
+
+/**
+ * @brief Writer of a session file of timestamped perception inputs and outputs. See @ref rkai_create_session_writer
+ *
+ */
+typedef struct _rkai_session_writer_t *rkai_session_writer_t;
+
+/**
+ * @brief Reader of a session file. See @ref rkai_open_session_reader
+ *
+ */
+typedef struct _rkai_session_reader_t *rkai_session_reader_t;
+
+/**
+ * @brief Removes the echo of the playback from the capture. See @ref rkai_create_echo_canceller
+ *
+ */
+typedef struct _rkai_echo_canceller_t *rkai_echo_canceller_t;
+
+/**
+ * @brief Mixes the channels of a microphone array into one beam and estimates the direction of the talker. See
+ *        @ref rkai_create_beamformer
+ *
+ */
+typedef struct _rkai_beamformer_t *rkai_beamformer_t;
+
+/**
+ * @brief Estimates the noise of each frequency bin and gives the gains that suppress it. See
+ *        @ref rkai_create_noise_suppressor
+ *
+ */
+typedef struct _rkai_noise_suppressor_t *rkai_noise_suppressor_t;
+
 /*\public
  * @brief return code
  * 
@@ -53,6 +172,7 @@ typedef enum {
     RKAI_RET_INVALID_INPUT_PARAM = -2, /// Invalid
     RKAI_NOT_SUPPORT = -3,
     RKAI_RET_THIRD_PARTY_FAIL = -4,
+    RKAI_RET_TIMEOUT = -5, /// Waiting for a shared resource exceeded the given timeout
     RKAI_RET_UNKNOW = -100
 } rkai_ret_t;
 
@@ -491,6 +611,599 @@ typedef struct rkai_vad_model_config_t {
     double log_mel;
 } rkai_vad_model_config_t;
 
+/**
+ * @brief Usage and contention counters of a handle pool
+ */
+typedef struct rkai_handle_pool_stats_t {
+    int pool_size;              ///< Number of contexts owned by the pool
+    int in_use;                 ///< Number of contexts currently checked out
+    int peak_in_use;            ///< Highest number of contexts checked out at the same time
+    uint64_t checkout_count;    ///< Number of successful checkouts
+    uint64_t contended_count;   ///< Number of checkouts that had to wait for a free context
+    uint64_t timeout_count;     ///< Number of checkouts that gave up after the timeout
+    int64_t total_wait_us;      ///< Total time spent waiting for a free context
+    int64_t max_wait_us;        ///< Longest single wait for a free context
+} rkai_handle_pool_stats_t;
+
+/**
+ * @brief Priority class of an inference job. Lower value is served first
+ */
+typedef enum rkai_priority_class_t {
+    RKAI_PRIORITY_AUDIO_CRITICAL = 0,   ///< Latency critical audio, e.g. trigger word
+    RKAI_PRIORITY_AUDIO = 1,            ///< Other audio models, e.g. VAD
+    RKAI_PRIORITY_VISION = 2,           ///< Vision models, e.g. face detection
+    RKAI_PRIORITY_CLASS_NUM = 3
+} rkai_priority_class_t;
+
+/**
+ * @brief Queueing counters of one priority class
+ */
+typedef struct rkai_scheduler_class_stats_t {
+    uint64_t job_count;             ///< Number of finished jobs
+    uint64_t deadline_miss_count;   ///< Number of jobs finished after their deadline
+    int64_t total_queue_delay_us;   ///< Total time jobs waited before running
+    int64_t max_queue_delay_us;     ///< Longest time a job waited before running
+    int64_t total_run_us;           ///< Total inference time
+} rkai_scheduler_class_stats_t;
+
+#define RKAI_MAX_NPU_CORE_NUM 3     ///< Most NPU cores of the supported SoCs (RK3588)
+
+/**
+ * @brief Scheduler counters for all priority classes
+ */
+typedef struct rkai_scheduler_stats_t {
+    rkai_scheduler_class_stats_t classes[RKAI_PRIORITY_CLASS_NUM];  ///< Indexed by @ref rkai_priority_class_t
+    int64_t core_busy_us[RKAI_MAX_NPU_CORE_NUM];    ///< Inference time per NPU core of the scheduler
+} rkai_scheduler_stats_t;
+
+/**
+ * @brief Throughput and per stage timing counters of a face detection pipeline
+ */
+typedef struct rkai_face_pipeline_stats_t {
+    int staging_num;                ///< Number of frames that can be in flight
+    uint64_t submitted_count;       ///< Number of frames accepted by the pipeline
+    uint64_t completed_count;       ///< Number of results collected by the caller
+    uint64_t failed_count;          ///< Number of collected results with an error
+    int64_t total_preprocess_us;    ///< Total resize and color conversion time, on the submitting threads
+    int64_t total_inference_us;     ///< Total input copy, rknn_run and output copy time, on the NPU thread
+    int64_t total_postprocess_us;   ///< Total decoding and NMS time, on the postprocess thread
+    int64_t total_latency_us;       ///< Total time from submission to result collection
+    int64_t max_latency_us;         ///< Longest time from submission to result collection
+    int64_t first_submit_us;        ///< Time of the first submission, to compute frames per second
+    int64_t last_complete_us;       ///< Time of the last result collection, to compute frames per second
+} rkai_face_pipeline_stats_t;
+
+#define RKAI_CASCADE_MAX_STAGES 4
+
+/**
+ * @brief One model of a trigger word cascade
+ */
+typedef struct rkai_cascade_stage_t {
+    rkai_handle_t handle;   ///< Handle initialized with a trigger word model
+    float threshold;        ///< The window goes to the next stage only if the score is higher than this threshold
+} rkai_cascade_stage_t;
+
+/**
+ * @brief Result of a trigger word cascade on one window
+ */
+typedef struct rkai_cascade_result_t {
+    int is_detected;                        ///< All stages passed
+    int stage_count;                        ///< Number of stages run on the window
+    int exit_stage;                         ///< Index of the stage that rejected the window, -1 if detected
+    float scores[RKAI_CASCADE_MAX_STAGES];  ///< Score of each stage run, 0 for skipped stages
+} rkai_cascade_result_t;
+
+/**
+ * @brief Counters of one stage of a trigger word cascade
+ */
+typedef struct rkai_cascade_stage_stats_t {
+    uint64_t run_count;     ///< Number of windows the stage ran on
+    uint64_t pass_count;    ///< Number of windows passed to the next stage
+    uint64_t skip_count;    ///< Number of windows rejected before reaching the stage
+    int64_t total_us;       ///< Total melspectrogram and inference time of the stage
+} rkai_cascade_stage_stats_t;
+
+/**
+ * @brief Counters of a trigger word cascade
+ */
+typedef struct rkai_cascade_stats_t {
+    int stage_num;                                          ///< Number of stages of the cascade
+    uint64_t window_count;                                  ///< Number of windows processed
+    uint64_t detected_count;                                ///< Number of windows passing all stages
+    rkai_cascade_stage_stats_t stages[RKAI_CASCADE_MAX_STAGES];
+} rkai_cascade_stats_t;
+
+/**
+ * @brief Parameters of an energy gate
+ */
+typedef struct rkai_energy_gate_config_t {
+    int frame_length;       ///< Samples per power frame
+    float smoothing;        ///< Recursive smoothing factor of the frame power, in [0, 1)
+    int subwindow_frames;   ///< Frames per minimum statistics sub-window
+    int subwindow_num;      ///< Sub-windows kept, the floor follows the last subwindow_frames * subwindow_num frames
+    float margin_db;        ///< A window is active if a frame is louder than the noise floor plus this margin
+    float min_level_db;     ///< Windows whose loudest frame is under this level (dBFS) are always skipped
+} rkai_energy_gate_config_t;
+
+/**
+ * @brief Counters of an energy gate
+ */
+typedef struct rkai_energy_gate_stats_t {
+    rkai_energy_gate_config_t config;   ///< Parameters of the gate
+    uint64_t window_count;              ///< Number of windows checked
+    uint64_t skipped_count;             ///< Number of windows skipped, skip rate is skipped_count / window_count
+    float noise_floor_db;               ///< Current noise floor (dBFS)
+    float last_level_db;                ///< Level of the loudest frame of the last window (dBFS)
+} rkai_energy_gate_stats_t;
+
+/**
+ * @brief Stride used for a window by the adaptive stride policy
+ */
+typedef enum {
+    RKAI_STRIDE_MODE_COARSE = 0,    ///< No energy or no score for a while
+    RKAI_STRIDE_MODE_NORMAL,        ///< Energy and a score but no candidate keyword
+    RKAI_STRIDE_MODE_FINE,          ///< Around a candidate keyword
+    RKAI_STRIDE_MODE_NUM
+} rkai_stride_mode_t;
+
+/**
+ * @brief Parameters of an adaptive stride policy, all lengths in samples
+ */
+typedef struct rkai_adaptive_stride_config_t {
+    int sample_rate;        ///< Sample rate of the audio
+    int window_size;        ///< Window length, the stride never exceeds it
+    int coarse_stride;      ///< Stride while the audio is quiet
+    int normal_stride;      ///< Stride while the audio has energy but no candidate
+    int fine_stride;        ///< Stride around candidate keywords
+    int max_latency;        ///< Worst-case delay between the end of a keyword and the window covering it
+    float threshold;        ///< Threshold of the first model, see @ref rkai_cascade_stage_t
+    float candidate_margin; ///< A window scoring under the threshold by at most this is a candidate keyword
+    int candidate_hold;     ///< The fine stride is kept for this long after the last candidate
+    float quiet_score;      ///< A window without energy or scoring under this is quiet
+    int quiet_hold;         ///< The coarse stride starts after this long of quiet windows
+} rkai_adaptive_stride_config_t;
+
+/**
+ * @brief Counters of an adaptive stride policy
+ */
+typedef struct rkai_adaptive_stride_stats_t {
+    uint64_t window_count;                          ///< Number of windows
+    uint64_t mode_window_count[RKAI_STRIDE_MODE_NUM];   ///< Windows per @ref rkai_stride_mode_t
+    uint64_t inference_count;                       ///< Windows the model was run on
+    uint64_t advanced_samples;                      ///< Audio covered by the strides
+    float inferences_per_hour;                      ///< Model runs per hour of audio
+    float normal_inferences_per_hour;               ///< Model runs per hour of audio with the fixed normal stride
+} rkai_adaptive_stride_stats_t;
+
+/**
+ * @brief What a window scheduler does with the pending windows once the lag is over the limit
+ */
+typedef enum {
+    RKAI_LAG_POLICY_PROCESS_ALL = 0,    ///< Process every window in order, the lag is only reported
+    RKAI_LAG_POLICY_SKIP_TO_NEWEST,     ///< Drop the pending windows and process the newest one
+    RKAI_LAG_POLICY_COALESCE,           ///< Give the pending windows as one span ending at the newest window
+    RKAI_LAG_POLICY_EVERY_KTH,          ///< Process one pending window out of keep_every
+    RKAI_LAG_POLICY_NUM
+} rkai_lag_policy_t;
+
+/**
+ * @brief Parameters of a window scheduler, all lengths in samples
+ */
+typedef struct rkai_window_scheduler_config_t {
+    int sample_rate;            ///< Sample rate of the recording, for the lag in ms
+    int window_size;            ///< Window length
+    int stride;                 ///< Stride until the first @ref rkai_window_scheduler_advance
+    int buffer_size;            ///< Samples kept by the recording, older windows are dropped
+    rkai_lag_policy_t policy;   ///< Policy applied when the lag is over max_lag
+    int max_lag;                ///< Lag between the end of the window and the write head allowed before the policy
+    int keep_every;             ///< k of @ref RKAI_LAG_POLICY_EVERY_KTH
+    int max_coalesce_size;      ///< Longest span of @ref RKAI_LAG_POLICY_COALESCE
+} rkai_window_scheduler_config_t;
+
+/**
+ * @brief A window given by a window scheduler
+ */
+typedef struct rkai_scheduled_window_t {
+    int64_t start;          ///< Absolute index of the first sample
+    int size;               ///< Length, window_size unless windows were coalesced. The newest window is the last
+                            ///< window_size samples
+    int new_sample_count;   ///< Samples at the end of the span not in the previous window
+    int64_t lag;            ///< Samples written after the end of the span
+    int skipped_count;      ///< Windows dropped right before this one
+    int coalesced_count;    ///< Windows merged into this span besides the newest one
+} rkai_scheduled_window_t;
+
+/**
+ * @brief Counters of a window scheduler
+ */
+typedef struct rkai_window_scheduler_stats_t {
+    uint64_t window_count;      ///< Windows given to the caller
+    uint64_t dropped_count;     ///< Windows dropped by the policy or overwritten
+    uint64_t overrun_count;     ///< Windows overwritten in the recording before being read
+    uint64_t coalesced_count;   ///< Windows merged into a span
+    float lag_p50_ms;           ///< Median lag when a window is given, in 10 ms steps
+    float lag_p90_ms;           ///< 90th percentile of the lag
+    float lag_p99_ms;           ///< 99th percentile of the lag
+    float max_lag_ms;           ///< Largest lag
+} rkai_window_scheduler_stats_t;
+
+#define RKAI_FUSION_MAX_KEYWORDS 8
+#define RKAI_FUSION_MAX_HISTORY 16
+
+/**
+ * @brief Smoothing of the keyword scores over the last windows
+ */
+typedef enum {
+    RKAI_FUSION_SMOOTHING_MEAN = 0,     ///< Moving average
+    RKAI_FUSION_SMOOTHING_MAX,          ///< Max pooling
+} rkai_fusion_smoothing_t;
+
+/**
+ * @brief Decision parameters of one keyword
+ */
+typedef struct rkai_fusion_config_t {
+    rkai_fusion_smoothing_t smoothing;  ///< Smoothing of the scores
+    int history_size;                   ///< Windows smoothed, 1 to RKAI_FUSION_MAX_HISTORY
+    float on_threshold;                 ///< The keyword fires when the smoothed score reaches it
+    float off_threshold;                ///< The keyword re-arms when the smoothed score drops under it
+    int refractory;                     ///< Samples after an event during which the keyword cannot fire again
+} rkai_fusion_config_t;
+
+/**
+ * @brief Output of a decision fusion on one window
+ */
+typedef struct rkai_fusion_event_t {
+    int is_triggered;                           ///< 1 if a keyword fired on this window
+    int keyword;                                ///< Index of the keyword fired, -1 if none
+    int64_t onset;                              ///< Start sample of the first window of the utterance
+    float scores[RKAI_FUSION_MAX_KEYWORDS];     ///< Smoothed score of each keyword
+} rkai_fusion_event_t;
+
+/**
+ * @brief Counters of a decision fusion
+ */
+typedef struct rkai_fusion_stats_t {
+    uint64_t window_count;          ///< Windows added
+    uint64_t raw_trigger_count;     ///< Windows a single window threshold at on_threshold would fire on
+    uint64_t event_count;           ///< Debounced events
+    uint64_t suppressed_count;      ///< Events blocked by the refractory period
+} rkai_fusion_stats_t;
+
+#define RKAI_SPOTTER_MAX_MODELS 4
+#define RKAI_SPOTTER_MAX_KEYWORDS RKAI_FUSION_MAX_KEYWORDS
+
+/**
+ * @brief Keyword scores of one window
+ */
+typedef struct rkai_keyword_scores_t {
+    int keyword_num;                            ///< Number of keywords of all the models
+    float scores[RKAI_SPOTTER_MAX_KEYWORDS];    ///< Probability of each keyword
+} rkai_keyword_scores_t;
+
+/**
+ * @brief Counters of a keyword spotter
+ */
+typedef struct rkai_keyword_spotter_stats_t {
+    int model_num;                  ///< Models registered
+    int front_end_num;              ///< Distinct melspectrogram configs, computed once per window each
+    int keyword_num;                ///< Keywords of all the models
+    uint64_t window_count;          ///< Windows detected
+    int64_t total_front_end_us;     ///< Time spent computing melspectrograms
+    int64_t total_inference_us;     ///< Time spent in the models
+} rkai_keyword_spotter_stats_t;
+
+/**
+ * @brief Parameters of a streaming model, see @ref rkai_stream_init
+ */
+typedef struct rkai_stream_config_t {
+    int silence_reset_chunks;   ///< Silent chunks in a row after which the state is reset, 0 to never reset
+} rkai_stream_config_t;
+
+/**
+ * @brief Counters of a streaming model
+ */
+typedef struct rkai_stream_stats_t {
+    uint64_t chunk_count;       ///< Chunks given to @ref rkai_stream_run
+    uint64_t run_count;         ///< NPU invocations, silent chunks are not run
+    uint64_t reset_count;       ///< State resets, on silence or explicit
+    int64_t total_run_us;       ///< Time spent running the model
+} rkai_stream_stats_t;
+
+/**
+ * @brief Parameters of a vad segmenter, durations in samples
+ */
+typedef struct rkai_vad_segmenter_config_t {
+    int hop_length;             ///< Samples per vad frame
+    float onset_threshold;      ///< Score starting a segment
+    float offset_threshold;     ///< Score under which a frame is no longer speech, lower than onset_threshold
+    int min_speech;             ///< Shorter bursts over the onset are ignored
+    int hangover;               ///< Silence kept after the last speech frame before the segment ends
+    int max_segment;            ///< Segments are cut at this length
+} rkai_vad_segmenter_config_t;
+
+typedef enum {
+    RKAI_VAD_SEGMENT_START = 0,
+    RKAI_VAD_SEGMENT_END,
+} rkai_vad_segment_event_type_t;
+
+/**
+ * @brief Start or end of a speech segment, in absolute samples of the stream
+ */
+typedef struct rkai_vad_segment_event_t {
+    rkai_vad_segment_event_type_t type;
+    int is_truncated;           ///< The segment ended at max_segment, not on silence
+    int64_t start_sample;       ///< First sample of the segment
+    int64_t end_sample;         ///< Sample after the last speech frame, -1 for a start
+    int64_t decision_sample;    ///< Sample after the frame that decided the event
+} rkai_vad_segment_event_t;
+
+/**
+ * @brief Counters of a vad segmenter
+ */
+typedef struct rkai_vad_segmenter_stats_t {
+    int64_t frame_count;        ///< Frames added, including the missing ones
+    uint64_t segment_count;     ///< Segments ended
+    uint64_t truncated_count;   ///< Segments cut at max_segment
+    int64_t speech_samples;     ///< Total length of the ended segments
+} rkai_vad_segmenter_stats_t;
+
+typedef enum {
+    RKAI_VAD_MERGE_MEAN = 0,    ///< Average of the windows covering the frame
+    RKAI_VAD_MERGE_MAX,         ///< Highest score of the windows covering the frame
+} rkai_vad_merge_t;
+
+/**
+ * @brief Parameters of a vad score stream, see @ref rkai_create_vad_score_stream
+ */
+typedef struct rkai_vad_score_stream_config_t {
+    int hop_length;             ///< Samples per vad frame
+    int window_frame_num;       ///< Frames output per window
+    int capacity;               ///< Frames held, at least window_frame_num
+    rkai_vad_merge_t merge;     ///< How the estimates of a frame are merged
+} rkai_vad_score_stream_config_t;
+
+/**
+ * @brief Counters of a vad score stream
+ */
+typedef struct rkai_vad_score_stream_stats_t {
+    uint64_t window_count;          ///< Windows added
+    uint64_t merged_frame_count;    ///< Estimates added to a frame that already had one
+    uint64_t read_frame_count;      ///< Final frames read
+    uint64_t dropped_frame_count;   ///< Frames lost unread when the reader fell behind
+} rkai_vad_score_stream_stats_t;
+
+/**
+ * @brief Parameters of a PCM16 export, see @ref rkai_pcm16_encode
+ */
+typedef struct rkai_pcm16_config_t {
+    int sample_rate;            ///< Written in the wav header
+    int n_channels;             ///< Interleaved channels, written in the wav header
+    int dither;                 ///< Add triangular noise of one LSB before rounding
+    uint32_t dither_seed;       ///< Seed of the dither noise
+    int wav_header;             ///< Write a 44 byte wav header before the samples
+} rkai_pcm16_config_t;
+
+#define RKAI_PACKET_MAX_SAMPLES 960
+
+#define RKAI_PACKET_SEGMENT_START 1     ///< First packet of a segment
+#define RKAI_PACKET_SEGMENT_END 2       ///< Last packet of a segment, can hold no sample
+
+/**
+ * @brief Parameters of a packetizer, see @ref rkai_create_packetizer
+ */
+typedef struct rkai_packetizer_config_t {
+    int sample_rate;
+    int packet_size;            ///< Samples per packet, at most RKAI_PACKET_MAX_SAMPLES
+    int queue_capacity;         ///< Packets queued before the newest are dropped
+} rkai_packetizer_config_t;
+
+/**
+ * @brief Audio packet of a speech segment
+ */
+typedef struct rkai_audio_packet_t {
+    uint32_t sequence;          ///< Increases by one per packet produced, a gap is a dropped packet
+    uint32_t segment_id;        ///< Increases by one per segment
+    int flags;                  ///< RKAI_PACKET_SEGMENT_START, RKAI_PACKET_SEGMENT_END
+    int64_t start_sample;       ///< Absolute index of samples[0], the segment end for an end packet with no sample
+    int sample_num;
+    float samples[RKAI_PACKET_MAX_SAMPLES];
+} rkai_audio_packet_t;
+
+/**
+ * @brief Counters of a packetizer
+ */
+typedef struct rkai_packetizer_stats_t {
+    uint64_t segment_count;     ///< Segments opened
+    uint64_t packet_count;      ///< Packets produced, including the dropped ones
+    uint64_t dropped_count;     ///< Packets dropped on a full queue
+    int64_t skipped_samples;    ///< Segment samples gone from the recording before they were produced
+} rkai_packetizer_stats_t;
+
+#define RKAI_TELEMETRY_MAX_STAGES 4
+
+/**
+ * @brief Decision of a detector on one window. Plain data of a fixed 56 byte layout, the JNI copies it as it is
+ */
+typedef struct rkai_telemetry_entry_t {
+    uint64_t sequence;                          ///< Number of the entry in the ring, set by the ring
+    int64_t timestamp_us;                       ///< Monotonic time of the write, set by the ring
+    int64_t window_index;                       ///< Start sample of the window in the capture stream
+    float energy_db;                            ///< Loudest frame of the window (dBFS), NAN if not measured
+    int32_t gate_decision;                      ///< 1 if the window passed the energy gate
+    int32_t stage_num;                          ///< Stages that scored the window
+    int32_t decision;                           ///< Output of the detector: trigger fired, speech segment open
+    float scores[RKAI_TELEMETRY_MAX_STAGES];    ///< Score of each stage, e.g. bc then conv
+} rkai_telemetry_entry_t;
+
+/**
+ * @brief Counters of a telemetry ring
+ */
+typedef struct rkai_telemetry_stats_t {
+    uint64_t write_count;       ///< Entries written
+    uint64_t dropped_count;     ///< Entries not written because another writer held their slot
+    int capacity;               ///< Entries kept
+} rkai_telemetry_stats_t;
+
+/**
+ * @brief Payload of a session chunk
+ */
+typedef enum {
+    RKAI_CHUNK_AUDIO = 1,           ///< Capture samples as float, position is the capture index of the first one
+    RKAI_CHUNK_IMAGE = 2,           ///< @ref rkai_chunk_image_t then the pixels, position is the frame number
+    RKAI_CHUNK_MODEL_OUTPUT = 3,    ///< Output of a model, laid out by its producer
+    RKAI_CHUNK_EVENT = 4,           ///< Decision emitted by a detector, laid out by its producer
+} rkai_chunk_type;
+
+/**
+ * @brief Header of a session chunk, a fixed 32 byte layout followed by size bytes of payload
+ */
+typedef struct rkai_chunk_header_t {
+    uint32_t type;              ///< @ref rkai_chunk_type
+    uint32_t source;            ///< Producer of the chunk, numbered by the app
+    int64_t timestamp_us;       ///< Time since the session start
+    int64_t position;           ///< Capture sample or frame number the chunk is about
+    uint32_t size;              ///< Payload bytes
+    uint32_t reserved;
+} rkai_chunk_header_t;
+
+/**
+ * @brief Start of the payload of an image chunk, followed by height rows of width * channels bytes
+ */
+typedef struct rkai_chunk_image_t {
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixel_format;      ///< @ref rkai_pixel_format, packed formats only
+    uint32_t channels;          ///< Bytes per pixel
+} rkai_chunk_image_t;
+
+/**
+ * @brief Parameters of a session writer, see @ref rkai_create_session_writer
+ */
+typedef struct rkai_session_config_t {
+    int queue_bytes;            ///< Chunks waiting for the disk, a chunk that does not fit is dropped
+    int max_image_width;        ///< Images are decimated by a whole factor down to this width, 0 keeps them
+} rkai_session_config_t;
+
+/**
+ * @brief Counters of a session writer
+ */
+typedef struct rkai_session_stats_t {
+    uint64_t chunk_count;       ///< Chunks written to the file
+    uint64_t byte_count;        ///< Bytes written to the file, headers included
+    uint64_t dropped_count;     ///< Chunks dropped on a full queue or a failed write
+    uint64_t dropped_bytes;     ///< Payload bytes of the dropped chunks
+} rkai_session_stats_t;
+
+/**
+ * @brief Parameters of an echo canceller, see @ref rkai_create_echo_canceller
+ */
+typedef struct rkai_echo_canceller_config_t {
+    int sample_rate;
+    int block_size;             ///< Samples per block, the output lags the capture by one block
+    int filter_length;          ///< Echo tail covered after the delay, in samples, rounded up to whole blocks
+    int max_delay;              ///< Longest delay of the echo behind the reference, in samples
+    int delay_interval;         ///< Samples between two delay estimates
+    float step_size;            ///< Normalized step of the adaptive filter, in (0, 1]
+    float double_talk_margin_db;    ///< Double talk when the residual is this much above the converged residual
+    float min_reference_db;     ///< Reference blocks under this level (dBFS) are silent, nothing to cancel
+} rkai_echo_canceller_config_t;
+
+/**
+ * @brief Counters of an echo canceller
+ */
+typedef struct rkai_echo_canceller_stats_t {
+    rkai_echo_canceller_config_t config;    ///< Parameters of the canceller
+    uint64_t block_count;           ///< Blocks processed
+    uint64_t echo_block_count;      ///< Blocks with a reference to cancel
+    uint64_t double_talk_count;     ///< Blocks with a reference and near end speech
+    uint64_t filter_copy_count;     ///< Times the adapting filter replaced the output filter
+    uint64_t delay_change_count;    ///< Times the estimated delay moved
+    int delay;                      ///< Current delay of the reference, -1 before the first estimate
+    float delay_correlation;        ///< Normalized correlation of the last accepted delay estimate
+    float erle_db;                  ///< Echo return loss enhancement on the blocks without double talk
+} rkai_echo_canceller_stats_t;
+
+#define RKAI_BEAMFORMER_MAX_CHANNELS 8
+
+/**
+ * @brief Parameters of a beamformer, see @ref rkai_create_beamformer. Angles are azimuths in degrees, counter
+ *        clockwise from the x axis of the array, towards the talker
+ */
+typedef struct rkai_beamformer_config_t {
+    int sample_rate;
+    int channel_count;          ///< Microphones, interleaved in this order in the input
+    float mic_x[RKAI_BEAMFORMER_MAX_CHANNELS];  ///< Position of each microphone in the array plane, in meters
+    float mic_y[RKAI_BEAMFORMER_MAX_CHANNELS];
+    int frame_size;             ///< Samples per channel of a direction estimate, a power of 2, hops by half of it
+    int angle_count;            ///< Candidate directions over the full circle
+    float min_frequency;        ///< Band of the direction estimate, in Hz
+    float max_frequency;
+    float min_level_db;         ///< Frames under this level (dBFS) give no estimate, nor the ones near the noise
+    float look_angle;           ///< Initial direction of the beam
+    float steer_confidence;     ///< The beam follows the estimates from this confidence, over 1 keeps it fixed
+} rkai_beamformer_config_t;
+
+/**
+ * @brief Direction of the talker over a span of the capture, see @ref rkai_beamformer_get_direction
+ */
+typedef struct rkai_beamformer_direction_t {
+    float angle;                ///< Direction of the strongest steered response
+    float confidence;           ///< Weighted phase coherence of the pairs in that direction, 1 for a single source
+    int estimate_count;         ///< Estimates above the level in the span, 0 when the angle is not known
+    int64_t position;           ///< Input frame after the last estimate used
+} rkai_beamformer_direction_t;
+
+/**
+ * @brief Counters of a beamformer
+ */
+typedef struct rkai_beamformer_stats_t {
+    rkai_beamformer_config_t config;    ///< Parameters of the beamformer
+    uint64_t frame_count;           ///< Input frames processed
+    uint64_t estimate_count;        ///< Direction estimates above the level
+    uint64_t steer_count;           ///< Times the beam moved
+    int latency;                    ///< The output lags the input by this many frames
+    float look_angle;               ///< Current direction of the beam
+    float angle;                    ///< Last direction estimate above the level
+    float confidence;               ///< Its confidence
+} rkai_beamformer_stats_t;
+
+/**
+ * @brief Gain rule of a noise suppressor
+ */
+typedef enum {
+    RKAI_NOISE_GAIN_WIENER = 0,             ///< Wiener gain of a decision directed a priori SNR
+    RKAI_NOISE_GAIN_SPECTRAL_SUBTRACTION,   ///< Power spectral subtraction of the noise estimate
+    RKAI_NOISE_GAIN_NUM
+} rkai_noise_gain_t;
+
+/**
+ * @brief Parameters of a noise suppressor, see @ref rkai_create_noise_suppressor. The transform is the one of the
+ *        melspectrogram front-end the gains are applied in
+ */
+typedef struct rkai_noise_suppressor_config_t {
+    int sample_rate;
+    int n_fft;                  ///< Transform size, the spectra have n_fft / 2 + 1 bins
+    int win_length;             ///< Hann window of the frames, centered in n_fft
+    int hop_length;             ///< Samples between two frames
+    rkai_noise_gain_t gain;     ///< Gain rule
+    float noise_time_constant;  ///< Seconds the noise estimate of a bin takes to follow a lower level
+    float noise_rise_db;        ///< dB per second the noise estimate of a bin rises while speech covers it
+    float prior_smoothing;      ///< Weight per frame of the previous frame in the a priori SNR, Wiener only
+    float over_subtraction;     ///< Noise power removed relative to the estimate, spectral subtraction only
+    float gain_floor_db;        ///< Lowest gain, some noise is left rather than musical tones
+} rkai_noise_suppressor_config_t;
+
+/**
+ * @brief Counters of a noise suppressor
+ */
+typedef struct rkai_noise_suppressor_stats_t {
+    rkai_noise_suppressor_config_t config;  ///< Parameters of the suppressor
+    uint64_t frame_count;           ///< Frames given gains, the ones of overlapping windows as many times
+    uint64_t update_count;          ///< Frames the noise estimate learned from, each frame of the capture once
+    float noise_level_db;           ///< Level of the noise estimate, dBFS
+    float reduction_db;             ///< Power taken out of the frames of the last call
+} rkai_noise_suppressor_stats_t;
+
 typedef struct rkai_melspectrogram_t {
     int size;
     int n_mels;
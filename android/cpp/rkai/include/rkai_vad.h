@@ -13,15 +13,23 @@
 extern "C" {
 #endif
 /**
- * @brief This function will init the content of the handle.
+ * @brief This function will init the content of the handle. The model config is stored in the handle
  *
  * @param handle [in] rkai handle
+ * @param asset_mgr [in] asset manager to load the model from, NULL to use the one set by android_fopen_set_asset_manager
  * @return @ref rkai_ret_t return code.
  */
 rkai_ret_t rkai_init_vad_model(rkai_handle_t handle);
 rkai_ret_t rkai_init_vad_android_model(rkai_handle_t handle, AAssetManager *asset_mgr);
 
-rkai_melspectrogram_config_t rkai_get_vad_config();
+/**
+ * @brief Get the melspectrogram config of the vad model loaded in the handle
+ *
+ * @param handle [in] initialized rkai handle
+ * @param config [out] model config
+ * @return @ref rkai_ret_t return code.
+ */
+rkai_ret_t rkai_get_vad_config(rkai_handle_t handle, rkai_melspectrogram_config_t *config);
 /**
  * @brief This function will run an inference session to detect if the audio contains voice
  *
@@ -34,6 +42,54 @@ rkai_melspectrogram_config_t rkai_get_vad_config();
                           rkai_vad_result_t *vad_result,
                           float low_threshold, float high_threshold);
 
+/**
+ * @brief Run the vad model on a window and get the speech probability of each frame. Frame i starts at sample
+ *        i * hop_length of the window
+ *
+ * @param handle [in] rkai handle
+ * @param audio [in] Input audio
+ * @param vad_model_config [in] Model config, see @ref rkai_get_vad_config
+ * @param frame_scores [out] Speech probability of each frame
+ * @param max_frame_num [in] Capacity of frame_scores
+ * @param frame_num [out] Number of frames written
+ * @return @ref rkai_ret_t return code.
+ */
+ rkai_ret_t rkai_vad_detect_frames(rkai_handle_t handle, rkai_audio_t *audio,
+                                  rkai_melspectrogram_config_t vad_model_config,
+                                  float *frame_scores, int max_frame_num, int *frame_num);
+
+/**
+ * @brief Run the vad model on the melspectrogram of a window, e.g. from
+ *        @ref rkai_audio_to_denoised_melspectrogram, and get the speech probability of each frame
+ *
+ * @param handle [in] rkai handle
+ * @param melspectrogram [in] Melspectrogram of the window with the front-end of @ref rkai_get_vad_config
+ * @param frame_scores [out] Speech probability of each frame
+ * @param max_frame_num [in] Capacity of frame_scores
+ * @param frame_num [out] Number of frames written
+ * @return @ref rkai_ret_t return code.
+ */
+rkai_ret_t rkai_vad_infer_frames(rkai_handle_t handle, const rkai_melspectrogram_t *melspectrogram,
+                                 float *frame_scores, int max_frame_num, int *frame_num);
+
+/**
+ * @brief Speech ratio of a window from the speech probability of its frames: the frames of the runs over
+ *        low_threshold that reach high_threshold, over all the frames. Does not allocate
+ *
+ * @param frame_scores [in] Speech probability of each frame, see @ref rkai_vad_detect_frames
+ * @param frame_num [in] Number of frames
+ * @param vad_result [out] Speech ratio, is_speech when over 0.4
+ * @param low_threshold [in] Score of the frames of a speech run
+ * @param high_threshold [in] Score a speech run must reach
+ * @return @ref rkai_ret_t return code.
+ */
+ rkai_ret_t rkai_vad_postprocess_frames(const float *frame_scores, int frame_num,
+                                       rkai_vad_result_t *vad_result,
+                                       float low_threshold, float high_threshold);
+
+/**
+ * @brief Same as @ref rkai_vad_postprocess_frames on the two class output of a 1 s window (51 frames)
+ */
  rkai_ret_t rkai_vad_postprocess(float *output,
                                  rkai_vad_result_t *vad_result,
                                  float low_threshold, float high_threshold);
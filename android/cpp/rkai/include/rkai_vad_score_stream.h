@@ -0,0 +1,107 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_VAD_SCORE_STREAM_H
+#define SMARTROBOT_RKAI_VAD_SCORE_STREAM_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Score stream config for a vad model: the frames per window are the model input size over the mel bins,
+ *        mean merge, room for 4 windows
+ *
+ * @param model_config [in] Model config, see @ref rkai_get_vad_config
+ * @param config [out] score stream parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_score_stream_default_config(const rkai_melspectrogram_config_t *model_config,
+                                                rkai_vad_score_stream_config_t *config);
+
+/**
+ * @brief Create a vad score stream. The frame scores of overlapping windows are put at their absolute frame index
+ *        and the estimates of the same frame are merged. A frame is final, and can be read, once a window starting
+ *        after it was added. All the storage is allocated here
+ *
+ * @param config [in] score stream parameters
+ * @return @ref rkai_vad_score_stream_t or NULL on failure
+ */
+rkai_vad_score_stream_t rkai_create_vad_score_stream(const rkai_vad_score_stream_config_t *config);
+
+/**
+ * @brief Release the score stream
+ *
+ * @param stream [in] score stream to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_vad_score_stream(rkai_vad_score_stream_t stream);
+
+/**
+ * @brief Add the frame scores of a window. Windows must be added in start order. Frames already read are ignored,
+ *        frames between the previous window and this one have no estimate and read as 0. When the frames held
+ *        exceed the capacity the oldest ones are dropped unread
+ *
+ * @param stream [in] score stream
+ * @param first_frame [in] Absolute index of the first frame of the window
+ * @param scores [in] Speech probability of each frame, see @ref rkai_vad_detect_frames
+ * @param frame_num [in] Number of frames
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_score_stream_add(rkai_vad_score_stream_t stream, int64_t first_frame, const float *scores,
+                                     int frame_num);
+
+/**
+ * @brief Take the merged scores of the final frames, oldest first
+ *
+ * @param stream [in] score stream
+ * @param scores [out] Merged score of each frame
+ * @param max_frame_num [in] Capacity of scores
+ * @param first_frame [out] Absolute index of the frame of scores[0]
+ * @param frame_num [out] Number of frames written, 0 if none is final
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_score_stream_read(rkai_vad_score_stream_t stream, float *scores, int max_frame_num,
+                                      int64_t *first_frame, int *frame_num);
+
+/**
+ * @brief Make all the frames added final, e.g. at the end of the capture, so that they can be read
+ *
+ * @param stream [in] score stream
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_score_stream_flush(rkai_vad_score_stream_t stream);
+
+/**
+ * @brief Drop all the frames and start again from a frame
+ *
+ * @param stream [in] score stream
+ * @param next_frame [in] Absolute index of the first frame expected
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_score_stream_reset(rkai_vad_score_stream_t stream, int64_t next_frame);
+
+/**
+ * @brief Get the stream counters. Can be called from any thread
+ *
+ * @param stream [in] score stream
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_score_stream_get_stats(rkai_vad_score_stream_t stream, rkai_vad_score_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_VAD_SCORE_STREAM_H
@@ -0,0 +1,93 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_VAD_SEGMENTER_H
+#define SMARTROBOT_RKAI_VAD_SEGMENTER_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default segmentation for the vad model: onset 0.6, offset 0.3, 100 ms minimum speech, 600 ms hangover,
+ *        15 s maximum segment
+ *
+ * @param sample_rate [in] sample rate of the audio
+ * @param hop_length [in] samples per vad frame
+ * @param config [out] segmentation parameters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_segmenter_default_config(int sample_rate, int hop_length, rkai_vad_segmenter_config_t *config);
+
+/**
+ * @brief Create a streaming vad segmenter. It takes the vad frame scores of the capture stream as they come and
+ *        emits the start and the end of each speech segment as absolute sample indices, frame i covering the
+ *        samples [i * hop_length, (i + 1) * hop_length).
+ *
+ *        A segment starts when the score reaches onset_threshold and stays over offset_threshold for min_speech
+ *        samples, the start being the first frame over the onset. It ends hangover samples after the last frame over
+ *        offset_threshold, or is cut at max_segment samples (a new segment starts right after if the speech goes on).
+ *
+ * @param config [in] segmentation parameters
+ * @return @ref rkai_vad_segmenter_t or NULL on failure
+ */
+rkai_vad_segmenter_t rkai_create_vad_segmenter(const rkai_vad_segmenter_config_t *config);
+
+/**
+ * @brief Release the segmenter
+ *
+ * @param segmenter [in] segmenter to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_vad_segmenter(rkai_vad_segmenter_t segmenter);
+
+/**
+ * @brief Add the scores of consecutive frames. Frames already added are ignored, so overlapping windows can be given
+ *        as they are; frames missing between two calls count as silence
+ *
+ * @param segmenter [in] vad segmenter
+ * @param first_frame [in] Absolute index of the frame of scores[0]
+ * @param scores [in] Speech probability of each frame
+ * @param frame_num [in] Number of frames
+ * @param events [out] Segment events emitted by these frames, in order
+ * @param max_event_num [in] Capacity of events
+ * @param event_num [out] Number of events written
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_segmenter_push(rkai_vad_segmenter_t segmenter, int64_t first_frame, const float *scores,
+                                   int frame_num, rkai_vad_segment_event_t *events, int max_event_num,
+                                   int *event_num);
+
+/**
+ * @brief Start again from a frame, ending nothing. E.g. when the capture restarts
+ *
+ * @param segmenter [in] vad segmenter
+ * @param next_frame [in] Absolute index of the next frame to be pushed
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_segmenter_reset(rkai_vad_segmenter_t segmenter, int64_t next_frame);
+
+/**
+ * @brief Get the segment counters. Can be called from any thread
+ *
+ * @param segmenter [in] vad segmenter
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_vad_segmenter_get_stats(rkai_vad_segmenter_t segmenter, rkai_vad_segmenter_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_VAD_SEGMENTER_H
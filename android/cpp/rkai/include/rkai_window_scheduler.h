@@ -0,0 +1,104 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef SMARTROBOT_RKAI_WINDOW_SCHEDULER_H
+#define SMARTROBOT_RKAI_WINDOW_SCHEDULER_H
+
+#include "rkai_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a scheduler for the sliding windows read from a recording. It measures how far the next window is
+ *        behind the write head and, once the lag is over the limit, applies the @ref rkai_lag_policy_t of the
+ *        config so the detection latency stays bounded under load. Windows already overwritten in the recording
+ *        buffer are always dropped.
+ *
+ * ```
+ *  while (running) {
+ *      rkai_window_scheduler_poll(scheduler, recording_write_index, &is_ready, &window);
+ *      if (!is_ready) { sleep(); continue; }
+ *      read(window.start, window.start + window.size); process();
+ *      rkai_window_scheduler_advance(scheduler, stride);
+ *  }
+ * ```
+ *
+ * @param config [in] scheduler parameters
+ * @return @ref rkai_window_scheduler_t or NULL on failure
+ */
+rkai_window_scheduler_t rkai_create_window_scheduler(const rkai_window_scheduler_config_t *config);
+
+/**
+ * @brief Release the scheduler
+ *
+ * @param scheduler [in] scheduler to be released
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_release_window_scheduler(rkai_window_scheduler_t scheduler);
+
+/**
+ * @brief Get the next window to process, if it is fully written
+ *
+ * @param scheduler [in] window scheduler
+ * @param write_index [in] Absolute index of the next sample the recording will write
+ * @param is_ready [out] 1 if window is set, 0 if the next window is not written yet
+ * @param window [out] Window to process
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_window_scheduler_poll(rkai_window_scheduler_t scheduler, int64_t write_index, int *is_ready,
+                                      rkai_scheduled_window_t *window);
+
+/**
+ * @brief Move past the window given by the last poll
+ *
+ * @param scheduler [in] window scheduler
+ * @param stride [in] Samples between the start of the last window of the span and the next window
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_window_scheduler_advance(rkai_window_scheduler_t scheduler, int stride);
+
+/**
+ * @brief Start again from a sample index, e.g. when the recording restarts
+ *
+ * @param scheduler [in] window scheduler
+ * @param start [in] Absolute index of the next window start
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_window_scheduler_reset(rkai_window_scheduler_t scheduler, int64_t start);
+
+/**
+ * @brief Start again from an older sample to process the history already recorded, e.g. the audio before a trigger.
+ *        The windows ending before write_index are all processed whatever the lag, the lag policy applies again
+ *        after them. Windows already overwritten are still dropped
+ *
+ * @param scheduler [in] window scheduler
+ * @param start [in] Absolute index of the next window start
+ * @param write_index [in] Absolute index of the next sample the recording will write
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_window_scheduler_rewind(rkai_window_scheduler_t scheduler, int64_t start, int64_t write_index);
+
+/**
+ * @brief Get the window counters and the lag percentiles. Can be called from any thread
+ *
+ * @param scheduler [in] window scheduler
+ * @param stats [out] counters
+ * @return @ref rkai_ret_t
+ */
+rkai_ret_t rkai_window_scheduler_get_stats(rkai_window_scheduler_t scheduler, rkai_window_scheduler_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_RKAI_WINDOW_SCHEDULER_H
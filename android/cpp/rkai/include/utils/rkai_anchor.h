@@ -0,0 +1,81 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#ifndef _SMARTROBOT_RKAI_ANCHOR_H_
+#define _SMARTROBOT_RKAI_ANCHOR_H_
+
+#include "rkai_type.h"
+
+#define RKAI_ANCHOR_MAX_LEVEL 4
+#define RKAI_ANCHOR_MAX_SIZE_PER_LEVEL 4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Parameters of RetinaFace style priors. Level k covers the image with a grid of
+ *        ceil(image_height / steps[k]) x ceil(image_width / steps[k]) cells, each cell has one square prior per
+ *        min_sizes[k][i]
+ */
+typedef struct rkai_anchor_config_t {
+    int image_width;                                                        ///< Model input width
+    int image_height;                                                       ///< Model input height
+    int level_num;                                                          ///< Number of feature map levels
+    int size_num;                                                           ///< Number of priors per cell
+    int steps[RKAI_ANCHOR_MAX_LEVEL];                                       ///< Stride of each level in pixel
+    int min_sizes[RKAI_ANCHOR_MAX_LEVEL][RKAI_ANCHOR_MAX_SIZE_PER_LEVEL];   ///< Prior sizes of each level in pixel
+} rkai_anchor_config_t;
+
+/**
+ * @brief Priors of the face detection model (model/face_detect/best.rknn). Same values as
+ *        model/face_detect/anchor_information.txt, which only stores them rounded to 4 decimals
+ *        (checked by tools/anchor_check)
+ */
+extern const rkai_anchor_config_t FACE_DETECT_ANCHOR_CONFIG;
+
+/**
+ * @brief Number of priors described by the config
+ *
+ * @param config [in] anchor parameters
+ * @return int number of priors
+ */
+int rkai_anchor_count(const rkai_anchor_config_t *config);
+
+/**
+ * @brief Generate the priors as (cx, cy, w, h) normalized by the image size, in the order level, row, column, size.
+ *        anchors->data is allocated by this function, previous data of @p anchors is released
+ *
+ * @param config [in] anchor parameters
+ * @param anchors [out] generated anchors
+ * @return rkai_ret_t
+ */
+rkai_ret_t rkai_generate_anchors(const rkai_anchor_config_t *config, anchors_t *anchors);
+
+/**
+ * @brief Read the priors from the legacy anchor file: "num_anchors array_size width height" then one "cx cy w h"
+ *        line per prior. Only used with RKAI_ANCHOR_FROM_FILE. anchors->data is allocated by this function, previous
+ *        data of @p anchors is released on success
+ *
+ * @param asset_mgr [in] asset manager to read from, NULL to use the one set by android_fopen_set_asset_manager
+ * @param file_name [in] asset path of the file
+ * @param anchors [out] anchors of the file
+ * @param input_size [out] model input size in the header of the file
+ * @return rkai_ret_t
+ */
+rkai_ret_t rkai_load_anchor_file(struct AAssetManager *asset_mgr, const char *file_name, anchors_t *anchors,
+                                 rkai_size_t *input_size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //_SMARTROBOT_RKAI_ANCHOR_H_
@@ -28,11 +28,12 @@ extern "C" {
 /**
  * @brief load model from the file and return the model in binary format
  * 
+ * @param asset_mgr [in] asset manager to read from, NULL to use the one set by android_fopen_set_asset_manager
  * @param model_path [in] path to model in the system memory
  * @param model_size [out] size of model binary array
  * @return rkai_ret_t [out] pointer to binary array
  */
-unsigned char *rkai_util_load_model_from_file(char *model_path, int *model_size);
+unsigned char *rkai_util_load_model_from_file(struct AAssetManager *asset_mgr, const char *model_path, int *model_size);
 
 /**
  * @brief Common function for init model
@@ -43,6 +44,15 @@ unsigned char *rkai_util_load_model_from_file(char *model_path, int *model_size)
  */
 rkai_ret_t model_init(rkai_handle_t handle, const char *model_path);
 
+/**
+ * @brief Common function for running the inference of a model. If the handle is attached to a scheduler,
+ *        the call waits for its turn according to the priority class and deadline of the handle
+ *
+ * @param handle Resource keeper
+ * @return int rknn return code
+ */
+int model_run(rkai_handle_t handle);
+
 rkai_ret_t init_yuv420p_table();
 
 /**
@@ -131,7 +141,27 @@ static inline int64_t get_current_time_us()
   return tv.tv_sec * 1000000 + tv.tv_usec;
 }
 
-rkai_ret_t load_config_file(const char *file_name, rkai_melspectrogram_config_t *config);
+rkai_ret_t load_config_file(struct AAssetManager *asset_mgr, const char *file_name, rkai_melspectrogram_config_t *config);
+
+/**
+ * @brief Common function for init an audio model: load its melspectrogram config into handle->model_data, then
+ *        init the model from handle->asset_manager
+ *
+ * @param handle Resource keeper
+ * @param config_path Path of the melspectrogram config
+ * @param model_path Path of the model
+ * @return rkai_ret_t
+ */
+rkai_ret_t audio_model_init(rkai_handle_t handle, const char *config_path, const char *model_path);
+
+/**
+ * @brief Get the melspectrogram config loaded by @ref audio_model_init
+ *
+ * @param handle Resource keeper
+ * @param config [out] config of the model
+ * @return rkai_ret_t
+ */
+rkai_ret_t audio_model_get_config(rkai_handle_t handle, rkai_melspectrogram_config_t *config);
 
 #ifdef __cplusplus
 }
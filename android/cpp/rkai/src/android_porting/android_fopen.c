@@ -38,9 +38,13 @@ void android_fopen_set_asset_manager(AAssetManager* manager) {
 }
 
 AAsset* android_fopen(const char* fname, const char* mode) {
+    return android_fopen_with_manager(NULL, fname, mode);
+}
+
+AAsset* android_fopen_with_manager(AAssetManager* manager, const char* fname, const char* mode) {
     if(mode[0] == 'w') return NULL;
 
-    AAsset* asset = AAssetManager_open(android_asset_manager, fname, 0);
+    AAsset* asset = AAssetManager_open(manager != NULL ? manager : android_asset_manager, fname, 0);
     if(!asset) return NULL;
 
     return asset;
@@ -12,6 +12,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "rkai.h"
 #include "util.h"
 #include "logger.h"
@@ -25,8 +26,8 @@ extern rkai_logger_t logger_setting;
 
 rkai_handle_t rkai_create_handle()
 {
-    // memory dynamic allocation
-    rkai_handle_t handle = (rkai_handle_t)malloc(sizeof(_rkai_handle_t));
+    // memory dynamic allocation. Zero it so release is safe even if the model was never initialized
+    rkai_handle_t handle = (rkai_handle_t)calloc(1, sizeof(_rkai_handle_t));
 
     if (handle == NULL) {
         LOG_ERROR("Error while allocate handle\n");
@@ -54,8 +55,21 @@ rkai_ret_t rkai_release_handle(rkai_handle_t handle)
         handle->output_tensor_attr = NULL;
     }
 
+    // Release model state, only the handle that created it owns it
+    if (handle->model_data != NULL && handle->release_model_data != NULL)
+    {
+        handle->release_model_data(handle->model_data);
+    }
+    if (handle->session_data != NULL && handle->release_session_data != NULL)
+    {
+        handle->release_session_data(handle->session_data);
+    }
+
     // Release model context
-    rknn_destroy(handle->context);
+    if (handle->context != 0)
+    {
+        rknn_destroy(handle->context);
+    }
 
     //relase the handle
     free(handle);
@@ -64,6 +78,102 @@ rkai_ret_t rkai_release_handle(rkai_handle_t handle)
     return RKAI_RET_SUCCESS;
 }
 
+rkai_handle_t rkai_duplicate_handle(rkai_handle_t handle)
+{
+    if (handle == NULL || handle->context == 0) {
+        LOG_ERROR("Cannot duplicate an uninitialized handle\n");
+        return NULL;
+    }
+
+    rkai_handle_t duplicated = rkai_create_handle();
+    if (duplicated == NULL) {
+        return NULL;
+    }
+
+    int rknn_ret_code = rknn_dup_context(&handle->context, &duplicated->context);
+    if (rknn_ret_code != RKNN_SUCC) {
+        LOG_ERROR("Cannot duplicate rknn context, rknn_dup_context return code %d\n", rknn_ret_code);
+        free(duplicated);
+        return NULL;
+    }
+
+    // Keep the same scheduling properties
+    duplicated->scheduler = handle->scheduler;
+    duplicated->priority_class = handle->priority_class;
+    duplicated->deadline_us = handle->deadline_us;
+    if (handle->core_mask != RKNN_NPU_CORE_AUTO) {
+        rkai_set_core_mask(duplicated, handle->core_mask);
+    }
+
+    // Share the read only model state, the session state is created again when needed
+    duplicated->asset_manager = handle->asset_manager;
+    duplicated->model_data = handle->model_data;
+    duplicated->release_model_data = NULL;
+
+    // Copy the input, output properties
+    duplicated->io_num = handle->io_num;
+    duplicated->input_tensor_attr_size = handle->input_tensor_attr_size;
+    duplicated->input_tensor_attr = (rknn_tensor_attr *)malloc(handle->input_tensor_attr_size);
+    duplicated->output_tensor_attr_size = handle->output_tensor_attr_size;
+    duplicated->output_tensor_attr = (rknn_tensor_attr *)malloc(handle->output_tensor_attr_size);
+    if (duplicated->input_tensor_attr == NULL || duplicated->output_tensor_attr == NULL) {
+        LOG_ERROR("Error while allocate tensor attribute for duplicated handle\n");
+        rkai_release_handle(duplicated);
+        return NULL;
+    }
+    memcpy(duplicated->input_tensor_attr, handle->input_tensor_attr, handle->input_tensor_attr_size);
+    memcpy(duplicated->output_tensor_attr, handle->output_tensor_attr, handle->output_tensor_attr_size);
+
+    return duplicated;
+}
+
+rkai_ret_t rkai_set_core_mask(rkai_handle_t handle, int core_mask)
+{
+    if (handle == NULL || handle->context == 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    int rknn_ret_code = rknn_set_core_mask(handle->context, (rknn_core_mask)core_mask);
+    if (rknn_ret_code != RKNN_SUCC) {
+        LOG_ERROR("Failed to set core mask %d, rknn_set_core_mask return code %d\n", core_mask, rknn_ret_code);
+        return RKAI_RET_THIRD_PARTY_FAIL;
+    }
+    handle->core_mask = core_mask;
+    return RKAI_RET_SUCCESS;
+}
+
+/**
+ * @brief Whether one of the NUL separated strings of a device tree property starts with @p prefix
+ */
+static int has_compatible(const char *compatible, int size, const char *prefix)
+{
+    int prefix_length = (int)strlen(prefix);
+    for (int i = 0; i < size; i += (int)strnlen(compatible + i, size - i) + 1) {
+        if (size - i >= prefix_length && strncmp(compatible + i, prefix, prefix_length) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int rkai_get_npu_core_num(void)
+{
+    char compatible[256];
+    FILE *file = fopen("/proc/device-tree/compatible", "rb");
+    if (file == NULL) {
+        return 1;
+    }
+    int size = (int)fread(compatible, 1, sizeof(compatible), file);
+    fclose(file);
+
+    if (has_compatible(compatible, size, "rockchip,rk3588")) {
+        return 3;
+    }
+    if (has_compatible(compatible, size, "rockchip,rk3576")) {
+        return 2;
+    }
+    return 1;
+}
+
 void rkai_setting_logger(rkai_logger_t setting)
 {
     logger_setting = setting;
@@ -0,0 +1,146 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_adaptive_stride.h"
+
+#define SECONDS_PER_HOUR 3600.0f
+
+struct _rkai_adaptive_stride_t {
+    rkai_adaptive_stride_config_t config;
+    int max_stride;                 // min(window size, worst-case latency)
+    int64_t since_candidate;        // Samples since the last window scoring just under the threshold
+    int64_t since_sound;            // Samples since the last window that was not quiet
+    std::mutex stats_mutex;
+    rkai_adaptive_stride_stats_t stats;
+};
+
+static void adaptive_stride_clear(rkai_adaptive_stride_t policy)
+{
+    // Start in normal mode: neither fine nor coarse until the holds say otherwise
+    policy->since_candidate = policy->config.candidate_hold;
+    policy->since_sound = 0;
+}
+
+extern "C" rkai_ret_t rkai_adaptive_stride_default_config(int sample_rate, rkai_adaptive_stride_config_t *config)
+{
+    if (sample_rate <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->sample_rate = sample_rate;
+    config->window_size = sample_rate;
+    config->coarse_stride = sample_rate / 2;
+    config->normal_stride = sample_rate * 3 / 10;
+    config->fine_stride = sample_rate * 3 / 20;
+    config->max_latency = sample_rate / 2;
+    config->threshold = 0.6f;
+    config->candidate_margin = 0.1f;
+    config->candidate_hold = sample_rate / 10;
+    config->quiet_score = 0.2f;
+    config->quiet_hold = sample_rate;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_adaptive_stride_t rkai_create_adaptive_stride(const rkai_adaptive_stride_config_t *config)
+{
+    if (config == NULL || config->sample_rate <= 0 || config->window_size <= 0 || config->fine_stride <= 0 ||
+        config->fine_stride > config->normal_stride || config->normal_stride > config->coarse_stride ||
+        config->max_latency < config->fine_stride) {
+        LOG_ERROR("Invalid adaptive stride config \n");
+        return NULL;
+    }
+    rkai_adaptive_stride_t policy = new _rkai_adaptive_stride_t();
+    policy->config = *config;
+    // A stride longer than the window leaves audio unseen, one longer than the latency delays the detection
+    policy->max_stride = std::min(config->window_size, config->max_latency);
+    adaptive_stride_clear(policy);
+    memset(&policy->stats, 0, sizeof(rkai_adaptive_stride_stats_t));
+    return policy;
+}
+
+extern "C" rkai_ret_t rkai_release_adaptive_stride(rkai_adaptive_stride_t policy)
+{
+    if (policy == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete policy;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_adaptive_stride_next(rkai_adaptive_stride_t policy, float score, int is_active,
+                                                int *stride)
+{
+    if (policy == NULL || stride == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    const rkai_adaptive_stride_config_t *config = &policy->config;
+    // A window over the threshold already goes to the next stage. One just under it may pass once better aligned,
+    // the partial keywords at the edges of the window score well under it
+    if (score >= config->threshold - config->candidate_margin && score < config->threshold) {
+        policy->since_candidate = 0;
+    }
+    // Steady noise over the floor of the gate is active, the model says whether it is quiet
+    if (is_active && (score < 0 || score >= config->quiet_score)) {
+        policy->since_sound = 0;
+    }
+
+    rkai_stride_mode_t mode;
+    if (policy->since_candidate < config->candidate_hold) {
+        mode = RKAI_STRIDE_MODE_FINE;
+        *stride = config->fine_stride;
+    } else if (policy->since_sound >= config->quiet_hold) {
+        mode = RKAI_STRIDE_MODE_COARSE;
+        *stride = config->coarse_stride;
+    } else {
+        mode = RKAI_STRIDE_MODE_NORMAL;
+        *stride = config->normal_stride;
+    }
+    *stride = std::min(*stride, policy->max_stride);
+    policy->since_candidate += *stride;
+    policy->since_sound += *stride;
+
+    std::lock_guard<std::mutex> lock(policy->stats_mutex);
+    policy->stats.window_count++;
+    policy->stats.mode_window_count[mode]++;
+    if (score >= 0) {
+        policy->stats.inference_count++;
+    }
+    policy->stats.advanced_samples += *stride;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_adaptive_stride_reset(rkai_adaptive_stride_t policy)
+{
+    if (policy == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    adaptive_stride_clear(policy);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_adaptive_stride_get_stats(rkai_adaptive_stride_t policy,
+                                                     rkai_adaptive_stride_stats_t *stats)
+{
+    if (policy == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(policy->stats_mutex);
+    *stats = policy->stats;
+    float audio_hours = (float) stats->advanced_samples / policy->config.sample_rate / SECONDS_PER_HOUR;
+    stats->inferences_per_hour = audio_hours > 0 ? stats->inference_count / audio_hours : 0;
+    stats->normal_inferences_per_hour = SECONDS_PER_HOUR * policy->config.sample_rate / policy->config.normal_stride;
+    return RKAI_RET_SUCCESS;
+}
@@ -8,6 +8,7 @@
 #include "utils/logger.h"
 #include "rkai_type.h"
 #include "rkai_audio.h"
+#include "rkai_noise_suppressor.h"
 
 rkai_ret_t rkai_audio_release(rkai_audio_t *audio) {
     if (audio->data != NULL) {
@@ -25,9 +26,31 @@ rkai_ret_t rkai_audio_melspectrogram_release(rkai_melspectrogram_t *melspectrogr
     return RKAI_RET_SUCCESS;
 }
 
+/**
+ * @brief Copy the mel spectrogram given by librosa into rkai_melspectrogram_t
+ */
+static rkai_ret_t store_melspectrogram(const std::vector<std::vector<float>> &melspectrogram_vector,
+                                       const rkai_melspectrogram_config_t &config,
+                                       rkai_melspectrogram_t *melspectrogram) {
+    // Convert back to rkai_melspectrogram_t
+    melspectrogram->size = melspectrogram_vector.size() * melspectrogram_vector[0].size();
+    melspectrogram->n_mels = config.transpose == 0 ? melspectrogram_vector.size() : melspectrogram_vector[0].size() ;
+    melspectrogram->n_frames = config.transpose ==0 ? melspectrogram_vector[0].size() : melspectrogram_vector.size();
+    melspectrogram->data = (float *) malloc(melspectrogram->size * sizeof(float));
+    if (melspectrogram->data == NULL) {
+        LOG_ERROR("Cannot allocate memory for melspectrogram \n");
+        return RKAI_RET_COMMON_FAIL;
+    }
+    for (size_t i = 0; i < melspectrogram_vector.size(); ++i) {
+        for (size_t j = 0; j < melspectrogram_vector[i].size(); ++j) {
+            melspectrogram->data[i * melspectrogram_vector[i].size() + j] = melspectrogram_vector[i][j];
+        }
+    }
+    return RKAI_RET_SUCCESS;
+}
+
 rkai_ret_t rkai_audio_to_melspectrogram(rkai_audio_t *audio, rkai_melspectrogram_t *melspectrogram,
                                         rkai_melspectrogram_config_t config) {
-    rkai_ret_t ret = RKAI_RET_SUCCESS;
     if (audio->format != RKAI_AUDIO_FORMAT_FLOAT) {
         LOG_WARN("Only support float format for audio \n");
         return RKAI_RET_INVALID_INPUT_PARAM;
@@ -49,19 +72,56 @@ rkai_ret_t rkai_audio_to_melspectrogram(rkai_audio_t *audio, rkai_melspectrogram
                                                                                      (bool) config.norm_mel,
                                                                                      config.transpose,
                                                                                      config.log_mel);
-    // Convert back to rkai_melspectrogram_t
-    melspectrogram->size = melspectrogram_vector.size() * melspectrogram_vector[0].size();
-    melspectrogram->n_mels = config.transpose == 0 ? melspectrogram_vector.size() : melspectrogram_vector[0].size() ;
-    melspectrogram->n_frames = config.transpose ==0 ? melspectrogram_vector[0].size() : melspectrogram_vector.size();
-    melspectrogram->data = (float *) malloc(melspectrogram->size * sizeof(float));
-    if (melspectrogram->data == NULL) {
-        LOG_ERROR("Cannot allocate memory for melspectrogram \n");
-        return RKAI_RET_COMMON_FAIL;
+    return store_melspectrogram(melspectrogram_vector, config, melspectrogram);
+}
+
+rkai_ret_t rkai_audio_to_denoised_melspectrogram(rkai_audio_t *audio, int64_t position,
+                                                 rkai_noise_suppressor_t suppressor,
+                                                 rkai_melspectrogram_t *melspectrogram,
+                                                 rkai_melspectrogram_config_t config, float *denoised) {
+    if (audio == NULL || melspectrogram == NULL || audio->data == NULL || audio->size <= 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
     }
-    for (int i = 0; i < melspectrogram_vector.size(); ++i) {
-        for (int j = 0; j < melspectrogram_vector[i].size(); ++j) {
-            melspectrogram->data[i * melspectrogram_vector[i].size() + j] = melspectrogram_vector[i][j];
+    melspectrogram->data = NULL;
+    if (audio->format != RKAI_AUDIO_FORMAT_FLOAT) {
+        LOG_WARN("Only support float format for audio \n");
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    librosa::Vectorf audio_vector = Eigen::Map<librosa::Vectorf>(audio->data, audio->size);
+    librosa::Matrixcf spectrum = librosa::internal::stft(audio_vector, config.n_fft, config.win_length,
+                                                         config.hop_length, "hann", true, "reflect");
+    if (suppressor != NULL) {
+        // Frames by bins, row major as the suppressor takes them
+        librosa::Matrixf gains = spectrum.cwiseAbs2();
+        rkai_ret_t ret = rkai_noise_suppressor_process(suppressor, position, gains.data(), (int) gains.rows(),
+                                                       (int) gains.cols(), gains.data());
+        if (ret != RKAI_RET_SUCCESS) {
+            LOG_WARN("Noise suppressor does not match the front-end, n_fft %d \n", config.n_fft);
+            return ret;
         }
+        spectrum = spectrum.array() * gains.cast<std::complex<float>>().array();
+    }
+    std::vector<std::vector<float>> melspectrogram_vector = librosa::Feature::melspectrogram(spectrum,
+                                                                                             config.sample_rate,
+                                                                                             config.n_fft, 2.0,
+                                                                                             config.n_mels, 0,
+                                                                                             config.f_max,
+                                                                                             (bool) config.htk,
+                                                                                             (bool) config.norm,
+                                                                                             (bool) config.norm_mel,
+                                                                                             config.transpose,
+                                                                                             config.log_mel);
+    if (denoised != NULL) {
+        librosa::Vectorf output = librosa::internal::istft(spectrum, config.n_fft, config.win_length,
+                                                           config.hop_length, true, audio->size);
+        Eigen::Map<librosa::Vectorf>(denoised, audio->size) = output;
     }
-    return ret;
+    return store_melspectrogram(melspectrogram_vector, config, melspectrogram);
+}
+
+int rkai_audio_is_same_front_end(const rkai_melspectrogram_config_t *a, const rkai_melspectrogram_config_t *b) {
+    return a->sample_rate == b->sample_rate && a->n_fft == b->n_fft && a->f_max == b->f_max &&
+           a->n_mels == b->n_mels && a->hop_length == b->hop_length && a->win_length == b->win_length &&
+           a->output_size == b->output_size && a->transpose == b->transpose && a->htk == b->htk &&
+           a->norm == b->norm && a->norm_mel == b->norm_mel && a->log_mel == b->log_mel;
 }
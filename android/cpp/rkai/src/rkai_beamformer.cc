@@ -0,0 +1,594 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <mutex>
+#include <vector>
+#include <unsupported/Eigen/FFT>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_beamformer.h"
+
+// Speed of sound in air at 20 degrees, m/s
+#define BEAM_SOUND_SPEED 343.0f
+// Power of a digital silence frame, keeps log10 finite
+#define BEAM_MIN_POWER 1e-12f
+// Magnitude under which a cross spectrum bin is left out of the phase transform
+#define BEAM_MIN_MAGNITUDE 1e-20f
+// Taps of the fractional delays on each side of the delay
+#define BEAM_HALF_TAPS 8
+// Frames the output cross fades over when the beam moves
+#define BEAM_STEER_FADE 256
+// The beam follows an estimate further than this from the look direction, in degrees
+#define BEAM_STEER_TOLERANCE 10.0f
+// Steered responses kept for the direction queries, 4 s of 32 ms frames
+#define BEAM_DIRECTION_HISTORY 256
+// Spacing under which the microphones are at the same place, in meters
+#define BEAM_MIN_SPACING 0.001f
+// Smoothing per frame of the power of a bin the noise floor tracks, about 3 frames
+#define BEAM_POWER_SMOOTHING 0.7f
+// A bin under this many times its noise floor only has noise, the floor follows it
+#define BEAM_NOISE_THRESHOLD 4.0f
+// Smoothing per frame of the noise floor following the noise, about 20 frames
+#define BEAM_NOISE_SMOOTHING 0.05f
+// Rise per frame of the noise floor over a louder bin, about 3 dB per second with 16 ms hops
+#define BEAM_NOISE_RISE 1.011f
+// A bin weighs 1 - this times its noise floor over its power
+#define BEAM_NOISE_OVERESTIMATE 3.0f
+// Power of the band over its noise floor under which a frame gives no estimate, 3 dB
+#define BEAM_MIN_SNR 2.0f
+// Smoothing per estimate of the response the beam follows, about 5 estimates
+#define BEAM_TRACK_SMOOTHING 0.8f
+// Cross product under which the array is taken as linear, relative to the squared aperture
+#define BEAM_LINEAR_TOLERANCE 1e-3f
+
+typedef std::complex<float> beam_complex;
+
+/**
+ * @brief Steered response of one frame, for the direction queries
+ */
+struct beam_estimate {
+    int64_t position;                   // Input frame after the estimate
+    bool is_active;                     // Above the level and the noise floor
+    std::vector<float> response;        // Per candidate direction
+};
+
+struct _rkai_beamformer_t {
+    rkai_beamformer_config_t config;
+    int channel_count;
+    float mic_x[RKAI_BEAMFORMER_MAX_CHANNELS];  // Relative to the centre of the array
+    float mic_y[RKAI_BEAMFORMER_MAX_CHANNELS];
+    int latency;                        // Bulk delay of the beam, covers the largest advance of a channel
+    int tap_count;
+    std::vector<float> angles;          // Candidate directions, in degrees
+    bool is_linear;                     // The candidates cover a half circle
+    // Delays of the beam for the look direction, channel c at c * tap_count, and the ones it fades from
+    std::vector<float> taps;
+    std::vector<float> fading_taps;
+    int fade_left;
+    float look_angle;
+    std::atomic<float> requested_angle; // NAN when no steer is pending
+    // Input of each channel written twice, at i and i + tap_count, the last tap_count samples are contiguous
+    std::vector<float> history;
+    int history_index;
+    // Last frame_size samples of each channel for the direction, sample i at i % frame_size
+    std::vector<float> frame_history;
+    int64_t frame_count;
+    int hop_fill;
+    Eigen::FFT<float> fft;
+    int min_bin;
+    int max_bin;
+    std::vector<int> pair_first;
+    std::vector<int> pair_second;
+    // Delay of the second microphone of a pair behind the first one for each candidate, in samples, pair p at
+    // p * angle_count
+    std::vector<float> pair_delays;
+    std::vector<beam_estimate> estimates;   // Estimate i at i % BEAM_DIRECTION_HISTORY
+    int64_t estimate_num;
+    // Scratch, allocated once, the beamformer runs in the capture callback
+    std::vector<float> window;
+    std::vector<float> time_buffer;
+    std::vector<std::vector<beam_complex>> spectra;
+    std::vector<beam_complex> cross_spectrum;
+    // Noise floor of each bin, the mean of the smoothed power when it only has noise
+    std::vector<float> smoothed_power;
+    std::vector<float> noise_power;
+    std::vector<float> weights;
+    bool is_noise_known;
+    std::vector<float> response;
+    // Smoothed response of the active estimates, the beam follows its peak
+    std::vector<float> tracked_response;
+    std::mutex stats_mutex;             // Guards the estimates and the stats
+    rkai_beamformer_stats_t stats;
+};
+
+static float wrap_angle(float angle)
+{
+    angle = fmodf(angle, 360.0f);
+    return angle < 0 ? angle + 360.0f : angle;
+}
+
+static float angle_distance(float first, float second)
+{
+    float distance = wrap_angle(first - second);
+    return std::min(distance, 360.0f - distance);
+}
+
+/**
+ * @brief Taps of a delay and sum beam towards angle: a wave from there reaches the channels at the same time, and
+ *        the sum of all taps is 1
+ */
+static void beam_compute_taps(rkai_beamformer_t beamformer, float angle, std::vector<float> &taps)
+{
+    float radians = angle * (float) M_PI / 180.0f;
+    float direction_x = cosf(radians);
+    float direction_y = sinf(radians);
+    float scale = beamformer->config.sample_rate / BEAM_SOUND_SPEED;
+    int tap_count = beamformer->tap_count;
+    for (int c = 0; c < beamformer->channel_count; ++c) {
+        // A microphone towards the talker hears it early and is delayed more
+        float advance = (beamformer->mic_x[c] * direction_x + beamformer->mic_y[c] * direction_y) * scale;
+        float delay = beamformer->latency + advance;
+        float *channel_taps = taps.data() + c * tap_count;
+        float sum = 0;
+        for (int k = 0; k < tap_count; ++k) {
+            float t = k - delay;
+            float tap = 0;
+            if (fabsf(t) < BEAM_HALF_TAPS + 1) {
+                float sinc = fabsf(t) < 1e-6f ? 1.0f : sinf((float) M_PI * t) / ((float) M_PI * t);
+                tap = sinc * (0.5f + 0.5f * cosf((float) M_PI * t / (BEAM_HALF_TAPS + 1)));
+            }
+            channel_taps[k] = tap;
+            sum += tap;
+        }
+        for (int k = 0; k < tap_count; ++k) {
+            channel_taps[k] /= sum * beamformer->channel_count;
+        }
+    }
+}
+
+static void beam_steer(rkai_beamformer_t beamformer, float angle, bool is_faded)
+{
+    if (is_faded) {
+        beamformer->fading_taps.swap(beamformer->taps);
+        beamformer->fade_left = BEAM_STEER_FADE;
+    }
+    beamformer->look_angle = wrap_angle(angle);
+    beam_compute_taps(beamformer, beamformer->look_angle, beamformer->taps);
+    std::lock_guard<std::mutex> lock(beamformer->stats_mutex);
+    beamformer->stats.look_angle = beamformer->look_angle;
+    if (is_faded) {
+        beamformer->stats.steer_count++;
+    }
+}
+
+static void beamformer_clear(rkai_beamformer_t beamformer)
+{
+    std::fill(beamformer->history.begin(), beamformer->history.end(), 0.0f);
+    beamformer->history_index = 0;
+    std::fill(beamformer->frame_history.begin(), beamformer->frame_history.end(), 0.0f);
+    std::fill(beamformer->tracked_response.begin(), beamformer->tracked_response.end(), 0.0f);
+    beamformer->frame_count = 0;
+    beamformer->hop_fill = 0;
+    beamformer->is_noise_known = false;
+    beamformer->fade_left = 0;
+    beamformer->requested_angle = NAN;
+    std::lock_guard<std::mutex> lock(beamformer->stats_mutex);
+    beamformer->estimate_num = 0;
+}
+
+/**
+ * @brief Peak of a steered response, refined between the candidates by a parabola through the peak and its
+ *        neighbours
+ */
+static void beam_find_peak(rkai_beamformer_t beamformer, const std::vector<float> &response, float *angle,
+                           float *value)
+{
+    int angle_count = (int) beamformer->angles.size();
+    int peak = (int) (std::max_element(response.begin(), response.end()) - response.begin());
+    *angle = beamformer->angles[peak];
+    *value = response[peak];
+    bool is_edge = beamformer->is_linear && (peak == 0 || peak == angle_count - 1);
+    if (is_edge) {
+        return;
+    }
+    float previous = response[(peak + angle_count - 1) % angle_count];
+    float next = response[(peak + 1) % angle_count];
+    float curvature = previous - 2 * response[peak] + next;
+    if (curvature < 0) {
+        float offset = 0.5f * (previous - next) / curvature;
+        float step = beamformer->is_linear ? 180.0f / (angle_count - 1) : 360.0f / angle_count;
+        *angle = wrap_angle(*angle + offset * step);
+    }
+}
+
+/**
+ * @brief SRP-PHAT of the last frame_size samples of the channels, the response of a direction is the mean over the
+ *        pairs and the band of the phase transformed cross spectra steered to it, each bin weighted by how far it
+ *        stands over its noise floor
+ */
+static void beam_estimate_direction(rkai_beamformer_t beamformer)
+{
+    const rkai_beamformer_config_t &config = beamformer->config;
+    int frame_size = config.frame_size;
+    int channel_count = beamformer->channel_count;
+    int angle_count = (int) beamformer->angles.size();
+    int oldest = (int) (beamformer->frame_count % frame_size);
+    double energy = 0;
+    for (int c = 0; c < channel_count; ++c) {
+        const float *samples = beamformer->frame_history.data() + c * frame_size;
+        for (int i = 0; i < frame_size; ++i) {
+            float sample = samples[(oldest + i) % frame_size];
+            energy += (double) sample * sample;
+            beamformer->time_buffer[i] = sample * beamformer->window[i];
+        }
+        beamformer->fft.fwd(beamformer->spectra[c].data(), beamformer->time_buffer.data(), frame_size);
+    }
+    float level_db = 10.0f * log10f(std::max((float) (energy / (channel_count * frame_size)), BEAM_MIN_POWER));
+
+    // Bins above the noise floor get a weight, a steady noise source does not steer the estimate
+    float weight_sum = 0;
+    float power_sum = 0;
+    float noise_sum = 0;
+    for (int k = beamformer->min_bin; k <= beamformer->max_bin; ++k) {
+        float power = 0;
+        for (int c = 0; c < channel_count; ++c) {
+            power += std::norm(beamformer->spectra[c][k]) / channel_count;
+        }
+        float &smoothed = beamformer->smoothed_power[k];
+        float &noise = beamformer->noise_power[k];
+        smoothed = beamformer->is_noise_known ? BEAM_POWER_SMOOTHING * smoothed + (1 - BEAM_POWER_SMOOTHING) * power
+                                              : power;
+        if (!beamformer->is_noise_known) {
+            noise = smoothed;
+        } else if (smoothed < BEAM_NOISE_THRESHOLD * noise) {
+            noise += BEAM_NOISE_SMOOTHING * (smoothed - noise);
+        } else {
+            noise *= BEAM_NOISE_RISE;
+        }
+        float weight = power > BEAM_MIN_MAGNITUDE ? std::max(0.0f, 1 - BEAM_NOISE_OVERESTIMATE * noise / power) : 0;
+        beamformer->weights[k] = weight;
+        weight_sum += weight;
+        power_sum += power;
+        noise_sum += noise;
+    }
+    beamformer->is_noise_known = true;
+    bool is_active = level_db >= config.min_level_db && power_sum >= BEAM_MIN_SNR * noise_sum && weight_sum > 0;
+    std::vector<float> &response = beamformer->response;
+    std::fill(response.begin(), response.end(), 0.0f);
+    if (is_active) {
+        int pair_count = (int) beamformer->pair_first.size();
+        for (int p = 0; p < pair_count; ++p) {
+            const std::vector<beam_complex> &first = beamformer->spectra[beamformer->pair_first[p]];
+            const std::vector<beam_complex> &second = beamformer->spectra[beamformer->pair_second[p]];
+            for (int k = beamformer->min_bin; k <= beamformer->max_bin; ++k) {
+                beam_complex cross = first[k] * std::conj(second[k]);
+                float magnitude = std::abs(cross);
+                beamformer->cross_spectrum[k] = magnitude > BEAM_MIN_MAGNITUDE ? cross * (beamformer->weights[k] /
+                                                                                          magnitude)
+                                                                               : beam_complex(0, 0);
+            }
+            const float *delays = beamformer->pair_delays.data() + p * angle_count;
+            for (int a = 0; a < angle_count; ++a) {
+                // The phase of the bins turns by a fixed step for a delay, rotated instead of a sincos per bin
+                float step = 2 * (float) M_PI * delays[a] / frame_size;
+                beam_complex rotation(cosf(step), sinf(step));
+                beam_complex phasor(cosf(step * beamformer->min_bin), sinf(step * beamformer->min_bin));
+                float sum = 0;
+                for (int k = beamformer->min_bin; k <= beamformer->max_bin; ++k) {
+                    sum += (beamformer->cross_spectrum[k] * phasor).real();
+                    phasor *= rotation;
+                }
+                response[a] += sum;
+            }
+        }
+        for (int a = 0; a < angle_count; ++a) {
+            response[a] /= pair_count * weight_sum;
+        }
+    }
+    float angle = 0;
+    float confidence = 0;
+    if (is_active) {
+        beam_find_peak(beamformer, response, &angle, &confidence);
+    }
+    {
+        std::lock_guard<std::mutex> lock(beamformer->stats_mutex);
+        beam_estimate &estimate = beamformer->estimates[beamformer->estimate_num % BEAM_DIRECTION_HISTORY];
+        estimate.position = beamformer->frame_count;
+        estimate.is_active = is_active;
+        estimate.response.assign(response.begin(), response.end());
+        beamformer->estimate_num++;
+        if (is_active) {
+            beamformer->stats.estimate_count++;
+            beamformer->stats.angle = angle;
+            beamformer->stats.confidence = confidence;
+        }
+    }
+    if (!is_active) {
+        return;
+    }
+    for (int a = 0; a < angle_count; ++a) {
+        float &tracked = beamformer->tracked_response[a];
+        tracked = BEAM_TRACK_SMOOTHING * tracked + (1 - BEAM_TRACK_SMOOTHING) * response[a];
+    }
+    float tracked_angle;
+    float tracked_confidence;
+    beam_find_peak(beamformer, beamformer->tracked_response, &tracked_angle, &tracked_confidence);
+    if (tracked_confidence >= config.steer_confidence &&
+        angle_distance(tracked_angle, beamformer->look_angle) > BEAM_STEER_TOLERANCE) {
+        beam_steer(beamformer, tracked_angle, true);
+    }
+}
+
+extern "C" rkai_ret_t rkai_beamformer_default_config(int sample_rate, rkai_beamformer_config_t *config)
+{
+    if (sample_rate <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    memset(config, 0, sizeof(rkai_beamformer_config_t));
+    config->sample_rate = sample_rate;
+    int frame_size = 4;
+    while (frame_size < sample_rate * 32 / 1000) {
+        frame_size *= 2;
+    }
+    config->frame_size = frame_size;
+    config->angle_count = 72;
+    config->min_frequency = 300.0f;
+    config->max_frequency = std::min(4000.0f, sample_rate / 2.0f);
+    config->min_level_db = -50.0f;
+    config->look_angle = 0.0f;
+    config->steer_confidence = 0.3f;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_beamformer_t rkai_create_beamformer(const rkai_beamformer_config_t *config)
+{
+    if (config == NULL || config->sample_rate <= 0 || config->channel_count < 2 ||
+        config->channel_count > RKAI_BEAMFORMER_MAX_CHANNELS || config->frame_size < 16 ||
+        (config->frame_size & (config->frame_size - 1)) != 0 || config->angle_count < 4 ||
+        config->min_frequency < 0 || config->max_frequency <= config->min_frequency ||
+        config->max_frequency > config->sample_rate / 2.0f) {
+        LOG_ERROR("Invalid beamformer config \n");
+        return NULL;
+    }
+    int channel_count = config->channel_count;
+    float centre_x = 0;
+    float centre_y = 0;
+    for (int c = 0; c < channel_count; ++c) {
+        centre_x += config->mic_x[c] / channel_count;
+        centre_y += config->mic_y[c] / channel_count;
+    }
+    float radius = 0;
+    float aperture = 0;
+    int far_mic = 0;
+    for (int c = 0; c < channel_count; ++c) {
+        radius = std::max(radius, hypotf(config->mic_x[c] - centre_x, config->mic_y[c] - centre_y));
+        float spacing = hypotf(config->mic_x[c] - config->mic_x[0], config->mic_y[c] - config->mic_y[0]);
+        if (spacing > aperture) {
+            aperture = spacing;
+            far_mic = c;
+        }
+    }
+    if (aperture < BEAM_MIN_SPACING) {
+        LOG_ERROR("The microphones of the beamformer are at the same place \n");
+        return NULL;
+    }
+    rkai_beamformer_t beamformer = new _rkai_beamformer_t();
+    beamformer->config = *config;
+    beamformer->channel_count = channel_count;
+    for (int c = 0; c < channel_count; ++c) {
+        beamformer->mic_x[c] = config->mic_x[c] - centre_x;
+        beamformer->mic_y[c] = config->mic_y[c] - centre_y;
+    }
+
+    // The array is linear when every microphone is on the line from the first one to the farthest one
+    float axis_x = config->mic_x[far_mic] - config->mic_x[0];
+    float axis_y = config->mic_y[far_mic] - config->mic_y[0];
+    beamformer->is_linear = true;
+    for (int c = 0; c < channel_count; ++c) {
+        float cross = axis_x * (config->mic_y[c] - config->mic_y[0]) - axis_y * (config->mic_x[c] - config->mic_x[0]);
+        if (fabsf(cross) > BEAM_LINEAR_TOLERANCE * aperture * aperture) {
+            beamformer->is_linear = false;
+        }
+    }
+    int angle_count = config->angle_count;
+    beamformer->angles.resize(angle_count);
+    float axis_angle = atan2f(axis_y, axis_x) * 180.0f / (float) M_PI;
+    for (int a = 0; a < angle_count; ++a) {
+        beamformer->angles[a] = beamformer->is_linear ? wrap_angle(axis_angle + 180.0f * a / (angle_count - 1))
+                                                      : 360.0f * a / angle_count;
+    }
+
+    beamformer->latency = (int) ceilf(radius * config->sample_rate / BEAM_SOUND_SPEED) + BEAM_HALF_TAPS;
+    beamformer->tap_count = 2 * beamformer->latency + 1;
+    beamformer->taps.resize(channel_count * beamformer->tap_count);
+    beamformer->fading_taps.resize(beamformer->taps.size());
+    beamformer->history.resize(channel_count * 2 * beamformer->tap_count);
+    int frame_size = config->frame_size;
+    beamformer->frame_history.resize(channel_count * frame_size);
+    beamformer->min_bin = std::max(1, (int) ceilf(config->min_frequency * frame_size / config->sample_rate));
+    beamformer->max_bin = std::min(frame_size / 2, (int) floorf(config->max_frequency * frame_size /
+                                                                config->sample_rate));
+    beamformer->max_bin = std::max(beamformer->max_bin, beamformer->min_bin);
+    float scale = config->sample_rate / BEAM_SOUND_SPEED;
+    for (int first = 0; first < channel_count; ++first) {
+        for (int second = first + 1; second < channel_count; ++second) {
+            beamformer->pair_first.push_back(first);
+            beamformer->pair_second.push_back(second);
+            for (int a = 0; a < angle_count; ++a) {
+                float radians = beamformer->angles[a] * (float) M_PI / 180.0f;
+                float offset_x = beamformer->mic_x[first] - beamformer->mic_x[second];
+                float offset_y = beamformer->mic_y[first] - beamformer->mic_y[second];
+                // The first microphone hears the talker this much earlier than the second one
+                float advance = (offset_x * cosf(radians) + offset_y * sinf(radians)) * scale;
+                beamformer->pair_delays.push_back(-advance);
+            }
+        }
+    }
+    beamformer->estimates.resize(BEAM_DIRECTION_HISTORY);
+    for (beam_estimate &estimate : beamformer->estimates) {
+        estimate.response.resize(angle_count);
+    }
+    beamformer->window.resize(frame_size);
+    for (int i = 0; i < frame_size; ++i) {
+        beamformer->window[i] = 0.5f - 0.5f * cosf(2 * (float) M_PI * i / frame_size);
+    }
+    beamformer->fft.SetFlag(Eigen::FFT<float>::HalfSpectrum);
+    beamformer->time_buffer.resize(frame_size);
+    beamformer->spectra.resize(channel_count, std::vector<beam_complex>(frame_size / 2 + 1));
+    beamformer->cross_spectrum.resize(frame_size / 2 + 1);
+    beamformer->response.resize(angle_count);
+    beamformer->tracked_response.resize(angle_count);
+    beamformer->smoothed_power.resize(frame_size / 2 + 1);
+    beamformer->noise_power.resize(frame_size / 2 + 1);
+    beamformer->weights.resize(frame_size / 2 + 1);
+    memset(&beamformer->stats, 0, sizeof(rkai_beamformer_stats_t));
+    beamformer->stats.latency = beamformer->latency;
+    beamformer_clear(beamformer);
+    beam_steer(beamformer, config->look_angle, false);
+    return beamformer;
+}
+
+extern "C" rkai_ret_t rkai_release_beamformer(rkai_beamformer_t beamformer)
+{
+    if (beamformer == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete beamformer;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_beamformer_process(rkai_beamformer_t beamformer, const float *input, int frame_num,
+                                              float *output)
+{
+    if (beamformer == NULL || input == NULL || output == NULL || frame_num < 0 || input == output) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    float requested = beamformer->requested_angle.exchange(NAN);
+    if (!isnan(requested)) {
+        beam_steer(beamformer, requested, true);
+    }
+    int channel_count = beamformer->channel_count;
+    int tap_count = beamformer->tap_count;
+    int frame_size = beamformer->config.frame_size;
+    for (int n = 0; n < frame_num; ++n) {
+        const float *frame = input + (int64_t) n * channel_count;
+        int index = beamformer->history_index;
+        int frame_index = (int) (beamformer->frame_count % frame_size);
+        float sum = 0;
+        float fading_sum = 0;
+        for (int c = 0; c < channel_count; ++c) {
+            float *history = beamformer->history.data() + c * 2 * tap_count;
+            history[index] = frame[c];
+            history[index + tap_count] = frame[c];
+            beamformer->frame_history[c * frame_size + frame_index] = frame[c];
+            // The newest sample is at index + tap_count, tap k reads the sample k frames older
+            const float *newest = history + index + tap_count;
+            const float *taps = beamformer->taps.data() + c * tap_count;
+            for (int k = 0; k < tap_count; ++k) {
+                sum += taps[k] * newest[-k];
+            }
+            if (beamformer->fade_left > 0) {
+                const float *fading_taps = beamformer->fading_taps.data() + c * tap_count;
+                for (int k = 0; k < tap_count; ++k) {
+                    fading_sum += fading_taps[k] * newest[-k];
+                }
+            }
+        }
+        if (beamformer->fade_left > 0) {
+            float gain = (float) beamformer->fade_left / (BEAM_STEER_FADE + 1);
+            sum += gain * (fading_sum - sum);
+            beamformer->fade_left--;
+        }
+        output[n] = sum;
+        beamformer->history_index = (index + 1) % tap_count;
+        beamformer->frame_count++;
+        if (++beamformer->hop_fill == frame_size / 2) {
+            beamformer->hop_fill = 0;
+            if (beamformer->frame_count >= frame_size) {
+                beam_estimate_direction(beamformer);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(beamformer->stats_mutex);
+    beamformer->stats.frame_count += frame_num;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_beamformer_steer(rkai_beamformer_t beamformer, float angle)
+{
+    if (beamformer == NULL || isnan(angle) || isinf(angle)) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    beamformer->requested_angle = angle;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_beamformer_get_direction(rkai_beamformer_t beamformer, int64_t start, int64_t end,
+                                                    rkai_beamformer_direction_t *direction)
+{
+    if (beamformer == NULL || direction == NULL || end < start) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    memset(direction, 0, sizeof(rkai_beamformer_direction_t));
+    int angle_count = (int) beamformer->angles.size();
+    int half_frame = beamformer->config.frame_size / 2;
+    std::vector<float> response(angle_count, 0.0f);
+    std::lock_guard<std::mutex> lock(beamformer->stats_mutex);
+    int64_t first = std::max<int64_t>(0, beamformer->estimate_num - BEAM_DIRECTION_HISTORY);
+    for (int64_t i = first; i < beamformer->estimate_num; ++i) {
+        const beam_estimate &estimate = beamformer->estimates[i % BEAM_DIRECTION_HISTORY];
+        int64_t centre = estimate.position - half_frame;
+        if (!estimate.is_active || centre < start || centre >= end) {
+            continue;
+        }
+        for (int a = 0; a < angle_count; ++a) {
+            response[a] += estimate.response[a];
+        }
+        direction->estimate_count++;
+        direction->position = estimate.position;
+    }
+    if (direction->estimate_count > 0) {
+        beam_find_peak(beamformer, response, &direction->angle, &direction->confidence);
+        direction->confidence /= direction->estimate_count;
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_beamformer_reset(rkai_beamformer_t beamformer)
+{
+    if (beamformer == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    beamformer_clear(beamformer);
+    beam_steer(beamformer, beamformer->config.look_angle, false);
+    std::lock_guard<std::mutex> lock(beamformer->stats_mutex);
+    beamformer->stats.angle = 0;
+    beamformer->stats.confidence = 0;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_beamformer_get_stats(rkai_beamformer_t beamformer, rkai_beamformer_stats_t *stats)
+{
+    if (beamformer == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(beamformer->stats_mutex);
+    *stats = beamformer->stats;
+    stats->config = beamformer->config;
+    return RKAI_RET_SUCCESS;
+}
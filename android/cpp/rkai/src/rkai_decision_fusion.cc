@@ -0,0 +1,202 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_decision_fusion.h"
+
+typedef struct rkai_fusion_keyword_t {
+    rkai_fusion_config_t config;
+    float history[RKAI_FUSION_MAX_HISTORY];
+    int history_count;
+    int next_history;
+    int is_active;              // Fired and not yet under off_threshold
+    int64_t onset;              // Start of the first window of the current rise, -1 outside of a rise
+    int64_t refractory_end;     // No event on windows starting before this sample
+} rkai_fusion_keyword_t;
+
+struct _rkai_decision_fusion_t {
+    int keyword_num;
+    rkai_fusion_keyword_t keywords[RKAI_FUSION_MAX_KEYWORDS];
+    std::mutex stats_mutex;
+    rkai_fusion_stats_t stats;
+};
+
+static float smooth_score(const rkai_fusion_keyword_t *keyword)
+{
+    float smoothed = 0;
+    for (int i = 0; i < keyword->history_count; ++i) {
+        if (keyword->config.smoothing == RKAI_FUSION_SMOOTHING_MAX) {
+            smoothed = std::max(smoothed, keyword->history[i]);
+        } else {
+            smoothed += keyword->history[i];
+        }
+    }
+    if (keyword->config.smoothing == RKAI_FUSION_SMOOTHING_MEAN) {
+        smoothed /= keyword->history_count;
+    }
+    return smoothed;
+}
+
+static void decision_fusion_clear(rkai_decision_fusion_t fusion)
+{
+    for (int i = 0; i < fusion->keyword_num; ++i) {
+        rkai_fusion_keyword_t *keyword = &fusion->keywords[i];
+        keyword->history_count = 0;
+        keyword->next_history = 0;
+        keyword->is_active = 0;
+        keyword->onset = -1;
+        keyword->refractory_end = 0;
+    }
+}
+
+extern "C" rkai_ret_t rkai_decision_fusion_default_config(int sample_rate, rkai_fusion_config_t *config)
+{
+    if (sample_rate <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->smoothing = RKAI_FUSION_SMOOTHING_MAX;
+    config->history_size = 3;
+    config->on_threshold = 0.7f;
+    config->off_threshold = 0.5f;
+    config->refractory = 2 * sample_rate;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_decision_fusion_t rkai_create_decision_fusion(const rkai_fusion_config_t *configs, int keyword_num)
+{
+    if (configs == NULL || keyword_num < 1 || keyword_num > RKAI_FUSION_MAX_KEYWORDS) {
+        LOG_ERROR("Invalid number of keywords %d \n", keyword_num);
+        return NULL;
+    }
+    for (int i = 0; i < keyword_num; ++i) {
+        if (configs[i].history_size < 1 || configs[i].history_size > RKAI_FUSION_MAX_HISTORY ||
+            configs[i].off_threshold > configs[i].on_threshold || configs[i].refractory < 0) {
+            LOG_ERROR("Invalid decision fusion config for keyword %d \n", i);
+            return NULL;
+        }
+    }
+    rkai_decision_fusion_t fusion = new _rkai_decision_fusion_t();
+    fusion->keyword_num = keyword_num;
+    for (int i = 0; i < keyword_num; ++i) {
+        fusion->keywords[i].config = configs[i];
+    }
+    decision_fusion_clear(fusion);
+    memset(&fusion->stats, 0, sizeof(rkai_fusion_stats_t));
+    return fusion;
+}
+
+extern "C" rkai_ret_t rkai_release_decision_fusion(rkai_decision_fusion_t fusion)
+{
+    if (fusion == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete fusion;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_decision_fusion_set_thresholds(rkai_decision_fusion_t fusion, int keyword,
+                                                          float on_threshold, float off_threshold)
+{
+    if (fusion == NULL || keyword < 0 || keyword >= fusion->keyword_num || off_threshold > on_threshold) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    fusion->keywords[keyword].config.on_threshold = on_threshold;
+    fusion->keywords[keyword].config.off_threshold = off_threshold;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_decision_fusion_update(rkai_decision_fusion_t fusion, const float *scores,
+                                                  int64_t window_start, rkai_fusion_event_t *event)
+{
+    if (fusion == NULL || scores == NULL || event == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    memset(event, 0, sizeof(rkai_fusion_event_t));
+    event->keyword = -1;
+    int raw_count = 0;
+    int suppressed_count = 0;
+    for (int i = 0; i < fusion->keyword_num; ++i) {
+        rkai_fusion_keyword_t *keyword = &fusion->keywords[i];
+        const rkai_fusion_config_t *config = &keyword->config;
+        keyword->history[keyword->next_history] = scores[i];
+        keyword->next_history = (keyword->next_history + 1) % config->history_size;
+        keyword->history_count = std::min(keyword->history_count + 1, config->history_size);
+        float smoothed = smooth_score(keyword);
+        event->scores[i] = smoothed;
+
+        // The onset is the first window of the rise, before the smoothed score reaches the threshold
+        if (scores[i] >= config->off_threshold && keyword->onset < 0) {
+            keyword->onset = window_start;
+        }
+        if (scores[i] >= config->on_threshold) {
+            raw_count++;
+        }
+
+        if (keyword->is_active) {
+            if (smoothed < config->off_threshold) {
+                keyword->is_active = 0;
+                keyword->onset = -1;
+            }
+            continue;
+        }
+        if (smoothed < config->on_threshold) {
+            if (smoothed < config->off_threshold && scores[i] < config->off_threshold) {
+                keyword->onset = -1;
+            }
+            continue;
+        }
+        if (window_start < keyword->refractory_end) {
+            suppressed_count++;
+            continue;
+        }
+        keyword->is_active = 1;
+        keyword->refractory_end = window_start + config->refractory;
+        // Only the highest keyword is reported when several fire on the same window
+        if (!event->is_triggered || smoothed > event->scores[event->keyword]) {
+            event->is_triggered = 1;
+            event->keyword = i;
+            event->onset = keyword->onset >= 0 ? keyword->onset : window_start;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(fusion->stats_mutex);
+    fusion->stats.window_count++;
+    fusion->stats.raw_trigger_count += raw_count;
+    fusion->stats.suppressed_count += suppressed_count;
+    if (event->is_triggered) {
+        fusion->stats.event_count++;
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_decision_fusion_reset(rkai_decision_fusion_t fusion)
+{
+    if (fusion == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    decision_fusion_clear(fusion);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_decision_fusion_get_stats(rkai_decision_fusion_t fusion, rkai_fusion_stats_t *stats)
+{
+    if (fusion == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(fusion->stats_mutex);
+    *stats = fusion->stats;
+    return RKAI_RET_SUCCESS;
+}
@@ -0,0 +1,628 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <complex>
+#include <mutex>
+#include <vector>
+#include <unsupported/Eigen/FFT>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_echo_canceller.h"
+
+// Power of a digital silence block, keeps log10 finite
+#define ECHO_MIN_POWER 1e-12f
+// The delay is estimated on the capture and the reference decimated by this factor
+#define ECHO_DELAY_DECIMATION 4
+// Normalized correlation under which a delay estimate is ignored
+#define ECHO_MIN_DELAY_CORRELATION 0.2f
+// Whitened correlation, relative to the highest peak, from which the earliest peak is the direct path
+#define ECHO_DELAY_PEAK_RATIO 0.5f
+// A new delay is taken once two estimates agree within this many decimated samples
+#define ECHO_DELAY_TOLERANCE 2
+// Smoothing per block of the powers compared by the double talk detection and the two filters, about 10 blocks
+#define ECHO_SHORT_SMOOTHING 0.9f
+// Smoothing per block of the enhancement in dB, about 50 blocks
+#define ECHO_LONG_SMOOTHING 0.98f
+// The adapting filter replaces the output filter when its residual is this much lower
+#define ECHO_COPY_RATIO 0.8f
+// The adapting filter restarts from the output filter when its residual is this much higher, it diverged
+#define ECHO_RESET_RATIO 4.0f
+// Enhancement needed before double talk is looked for, a residual over the capture means nothing before
+#define ECHO_CONVERGED_ERLE_DB 15.0f
+// Blocks a double talk decision is held for, covers the pauses between words
+#define ECHO_DOUBLE_TALK_HOLD 12
+// Step of the adapting filter during double talk relative to step_size, still follows an echo path change
+#define ECHO_DOUBLE_TALK_STEP 0.1f
+
+// Floor of the reference power of a bin relative to the mean over the bins
+#define ECHO_BIN_POWER_FLOOR 0.03f
+
+typedef std::complex<float> echo_complex;
+typedef std::vector<echo_complex> echo_spectrum;
+
+struct _rkai_echo_canceller_t {
+    rkai_echo_canceller_config_t config;
+    int partition_num;                  // Blocks of the filter
+    int bin_num;                        // block_size + 1 bins of the 2 * block_size FFT
+    float regularization;               // Added to the reference power of a bin, the power of a silent reference
+    Eigen::FFT<float> fft;
+    std::vector<float> capture_block;   // Block being filled
+    std::vector<float> output_block;    // Output of the previous block, given while the next one fills
+    int block_fill;
+    int64_t sample_count;               // Index of the next capture and reference sample
+    std::vector<float> reference_history;   // Sample i at i % size, enough for the delay and the filter
+    // Spectra of the delayed reference blocks, partition p (p blocks older than the newest) at
+    // (newest_partition + p) % partition_num
+    std::vector<echo_spectrum> reference_spectra;
+    int newest_partition;
+    bool are_spectra_stale;             // Not kept up while the reference is silent or the delay moves
+    int silent_block_count;             // Blocks since the delayed reference was last above the silence level
+    std::vector<float> reference_power; // Power per bin summed over the partitions, the whole filter span
+    std::vector<echo_spectrum> output_filter;       // Makes the output
+    std::vector<echo_spectrum> adapting_filter;     // Adapts on every block
+    float capture_power;
+    float output_error_power;
+    float adapting_error_power;
+    float erle_db;                      // Long term, on the blocks without double talk
+    int double_talk_hold;
+    int delay;                          // -1 before the first estimate, the reference is then not delayed
+    // Decimated capture and reference for the delay estimates, sample i at i % size
+    std::vector<float> decimated_capture;
+    std::vector<float> decimated_reference;
+    int64_t decimated_count;
+    float capture_sum;
+    float reference_sum;
+    int64_t next_delay_estimate;
+    int pending_lag;                    // Decimated lag waiting for a second estimate, -1 for none
+    // Scratch, allocated once, the canceller runs in the capture callback
+    std::vector<float> time_buffer;
+    std::vector<float> adapting_error;
+    std::vector<float> taps;
+    std::vector<float> delay_capture;
+    std::vector<float> delay_reference;
+    std::vector<double> delay_energy;
+    std::vector<float> delay_correlation;
+    echo_spectrum delay_capture_spectrum;
+    echo_spectrum delay_reference_spectrum;
+    echo_spectrum spectrum_buffer;
+    echo_spectrum echo_spectrum_buffer;
+    echo_spectrum error_spectrum;
+    std::mutex stats_mutex;
+    rkai_echo_canceller_stats_t stats;
+};
+
+static float power_to_db(float power)
+{
+    return 10.0f * log10f(std::max(power, ECHO_MIN_POWER));
+}
+
+static void echo_canceller_clear(rkai_echo_canceller_t canceller)
+{
+    int bin_num = canceller->bin_num;
+    std::fill(canceller->capture_block.begin(), canceller->capture_block.end(), 0.0f);
+    std::fill(canceller->output_block.begin(), canceller->output_block.end(), 0.0f);
+    canceller->block_fill = 0;
+    canceller->sample_count = 0;
+    std::fill(canceller->reference_history.begin(), canceller->reference_history.end(), 0.0f);
+    for (int p = 0; p < canceller->partition_num; ++p) {
+        canceller->reference_spectra[p].assign(bin_num, echo_complex(0, 0));
+        canceller->output_filter[p].assign(bin_num, echo_complex(0, 0));
+        canceller->adapting_filter[p].assign(bin_num, echo_complex(0, 0));
+    }
+    canceller->newest_partition = 0;
+    canceller->are_spectra_stale = true;
+    canceller->silent_block_count = canceller->partition_num + 1;
+    std::fill(canceller->reference_power.begin(), canceller->reference_power.end(), 0.0f);
+    canceller->capture_power = 0;
+    canceller->output_error_power = 0;
+    canceller->adapting_error_power = 0;
+    canceller->erle_db = 0;
+    canceller->double_talk_hold = 0;
+    canceller->delay = -1;
+    std::fill(canceller->decimated_capture.begin(), canceller->decimated_capture.end(), 0.0f);
+    std::fill(canceller->decimated_reference.begin(), canceller->decimated_reference.end(), 0.0f);
+    canceller->decimated_count = 0;
+    canceller->capture_sum = 0;
+    canceller->reference_sum = 0;
+    canceller->next_delay_estimate = canceller->config.delay_interval;
+    canceller->pending_lag = -1;
+}
+
+/**
+ * @brief Spectrum of the 2 * block_size delayed reference samples ending at end, the overlap-save input of a block
+ */
+static void echo_reference_spectrum(rkai_echo_canceller_t canceller, int64_t end, echo_spectrum &spectrum)
+{
+    int fft_size = 2 * canceller->config.block_size;
+    int64_t history_size = (int64_t) canceller->reference_history.size();
+    for (int i = 0; i < fft_size; ++i) {
+        int64_t index = end - fft_size + i;
+        canceller->time_buffer[i] = index < 0 ? 0.0f : canceller->reference_history[index % history_size];
+    }
+    canceller->fft.fwd(spectrum.data(), canceller->time_buffer.data(), fft_size);
+}
+
+static void echo_rebuild_spectra(rkai_echo_canceller_t canceller, int64_t end)
+{
+    int block_size = canceller->config.block_size;
+    int bin_num = canceller->bin_num;
+    std::fill(canceller->reference_power.begin(), canceller->reference_power.end(), 0.0f);
+    canceller->newest_partition = 0;
+    for (int p = 0; p < canceller->partition_num; ++p) {
+        echo_spectrum &spectrum = canceller->reference_spectra[p];
+        echo_reference_spectrum(canceller, end - (int64_t) p * block_size, spectrum);
+        for (int k = 0; k < bin_num; ++k) {
+            canceller->reference_power[k] += std::norm(spectrum[k]);
+        }
+    }
+    canceller->are_spectra_stale = false;
+}
+
+/**
+ * @brief Move the taps of a filter by shift samples, the echo path seen through a delay of shift samples
+ */
+static void echo_shift_filter(rkai_echo_canceller_t canceller, std::vector<echo_spectrum> &filter, int shift)
+{
+    int block_size = canceller->config.block_size;
+    int fft_size = 2 * block_size;
+    int tap_num = canceller->partition_num * block_size;
+    std::vector<float> &taps = canceller->taps;
+    for (int p = 0; p < canceller->partition_num; ++p) {
+        canceller->fft.inv(canceller->time_buffer.data(), filter[p].data(), fft_size);
+        std::copy(canceller->time_buffer.begin(), canceller->time_buffer.begin() + block_size,
+                  taps.begin() + p * block_size);
+    }
+    for (int p = 0; p < canceller->partition_num; ++p) {
+        for (int i = 0; i < fft_size; ++i) {
+            int tap = p * block_size + i + shift;
+            canceller->time_buffer[i] = i < block_size && tap >= 0 && tap < tap_num ? taps[tap] : 0.0f;
+        }
+        canceller->fft.fwd(filter[p].data(), canceller->time_buffer.data(), fft_size);
+    }
+}
+
+static void echo_set_delay(rkai_echo_canceller_t canceller, int delay, float correlation)
+{
+    // The first estimate finds the echo the filter adapted to without delay. A later move is the playback or the
+    // capture latency changing, the echo path behind the delay stays the same
+    if (canceller->delay < 0) {
+        echo_shift_filter(canceller, canceller->output_filter, delay);
+        echo_shift_filter(canceller, canceller->adapting_filter, delay);
+    }
+    canceller->delay = delay;
+    canceller->are_spectra_stale = true;
+    LOG_INFO("Echo delay %d samples, correlation %.2f \n", delay, correlation);
+    std::lock_guard<std::mutex> lock(canceller->stats_mutex);
+    canceller->stats.delay_change_count++;
+    canceller->stats.delay = delay;
+    canceller->stats.delay_correlation = correlation;
+}
+
+/**
+ * @brief Cross-correlate the last delay_interval of the decimated capture with the decimated reference up to
+ *        max_delay before it. The earliest strong peak of the whitened correlation is the delay of the direct path
+ */
+static void echo_estimate_delay(rkai_echo_canceller_t canceller)
+{
+    int window = canceller->config.delay_interval / ECHO_DELAY_DECIMATION;
+    int max_lag = canceller->config.max_delay / ECHO_DELAY_DECIMATION;
+    int64_t decimated_size = (int64_t) canceller->decimated_capture.size();
+    if (canceller->decimated_count < window + max_lag) {
+        return;
+    }
+    int fft_size = (int) canceller->delay_capture.size();
+    std::vector<float> &capture = canceller->delay_capture;
+    std::vector<float> &reference = canceller->delay_reference;
+    std::fill(capture.begin(), capture.end(), 0.0f);
+    std::fill(reference.begin(), reference.end(), 0.0f);
+    int64_t start = canceller->decimated_count - window - max_lag;
+    for (int i = 0; i < window + max_lag; ++i) {
+        reference[i] = canceller->decimated_reference[(start + i) % decimated_size];
+        if (i >= max_lag) {
+            capture[i - max_lag] = canceller->decimated_capture[(start + i) % decimated_size];
+        }
+    }
+    // Prefix sums of the reference power for the energy under the window at each lag
+    std::vector<double> &reference_energy = canceller->delay_energy;
+    for (int i = 0; i < window + max_lag; ++i) {
+        reference_energy[i + 1] = reference_energy[i] + reference[i] * reference[i];
+    }
+    double capture_energy = 0;
+    for (int i = 0; i < window; ++i) {
+        capture_energy += capture[i] * capture[i];
+    }
+    float min_energy = powf(10.0f, canceller->config.min_reference_db / 10) * window;
+    if (reference_energy[window + max_lag] < min_energy || capture_energy < ECHO_MIN_POWER * window) {
+        return;
+    }
+    echo_spectrum &capture_spectrum = canceller->delay_capture_spectrum;
+    echo_spectrum &reference_spectrum = canceller->delay_reference_spectrum;
+    canceller->fft.fwd(capture_spectrum.data(), capture.data(), fft_size);
+    canceller->fft.fwd(reference_spectrum.data(), reference.data(), fft_size);
+    // Phase transform: the cross spectrum is whitened, voiced speech would otherwise give a peak at each pitch
+    // period around the delay
+    for (int k = 0; k <= fft_size / 2; ++k) {
+        echo_complex cross = reference_spectrum[k] * std::conj(capture_spectrum[k]);
+        float magnitude = std::abs(cross);
+        reference_spectrum[k] = magnitude > ECHO_MIN_POWER ? cross / magnitude : echo_complex(0, 0);
+    }
+    // Peak of the whitened correlation of capture[n] with reference[n + m], the lag is max_lag - m
+    std::vector<float> &whitened = canceller->delay_correlation;
+    canceller->fft.inv(whitened.data(), reference_spectrum.data(), fft_size);
+    float peak = *std::max_element(whitened.begin(), whitened.begin() + max_lag + 1);
+    // The reflections come after the direct path and can be higher, the earliest peak near the highest is taken
+    int best_m = max_lag;
+    while (whitened[best_m] < ECHO_DELAY_PEAK_RATIO * peak) {
+        best_m--;
+    }
+    while (best_m > 0 && whitened[best_m - 1] > whitened[best_m]) {
+        best_m--;
+    }
+    int best_lag = max_lag - best_m;
+    // Confidence from the plain normalized correlation at the peak
+    double product = 0;
+    for (int n = 0; n < window; ++n) {
+        product += capture[n] * reference[n + best_m];
+    }
+    double energy = capture_energy * (reference_energy[best_m + window] - reference_energy[best_m]);
+    float best_correlation = energy > 0 ? (float) (product / sqrt(energy)) : 0.0f;
+    if (best_correlation < ECHO_MIN_DELAY_CORRELATION) {
+        return;
+    }
+    // One block of margin before the direct path, the filter takes the jitter of the estimate
+    int block_size = canceller->config.block_size;
+    int delay = std::max(0, best_lag * ECHO_DELAY_DECIMATION - block_size);
+    if (canceller->delay >= 0 && std::abs(delay - canceller->delay) <= block_size / 2) {
+        canceller->pending_lag = -1;
+        return;
+    }
+    // The first estimate is taken at once, a move needs two estimates agreeing
+    if (canceller->delay < 0 ||
+        (canceller->pending_lag >= 0 && std::abs(best_lag - canceller->pending_lag) <= ECHO_DELAY_TOLERANCE)) {
+        canceller->pending_lag = -1;
+        echo_set_delay(canceller, delay, best_correlation);
+    } else {
+        canceller->pending_lag = best_lag;
+    }
+}
+
+static void echo_filter_output(rkai_echo_canceller_t canceller, const std::vector<echo_spectrum> &filter,
+                               const float *capture, float *error)
+{
+    int block_size = canceller->config.block_size;
+    int bin_num = canceller->bin_num;
+    echo_spectrum &echo = canceller->echo_spectrum_buffer;
+    std::fill(echo.begin(), echo.end(), echo_complex(0, 0));
+    for (int p = 0; p < canceller->partition_num; ++p) {
+        const echo_spectrum &reference = canceller->reference_spectra[(canceller->newest_partition + p) %
+                                                                      canceller->partition_num];
+        const echo_spectrum &weights = filter[p];
+        for (int k = 0; k < bin_num; ++k) {
+            echo[k] += weights[k] * reference[k];
+        }
+    }
+    // Overlap-save, the last half is the linear convolution
+    canceller->fft.inv(canceller->time_buffer.data(), echo.data(), 2 * block_size);
+    for (int i = 0; i < block_size; ++i) {
+        error[i] = capture[i] - canceller->time_buffer[block_size + i];
+    }
+}
+
+/**
+ * @brief Constrained frequency domain NLMS step of the adapting filter, normalized per bin by the reference power
+ */
+static void echo_adapt(rkai_echo_canceller_t canceller, const float *error, float step)
+{
+    int block_size = canceller->config.block_size;
+    int fft_size = 2 * block_size;
+    int bin_num = canceller->bin_num;
+    std::fill(canceller->time_buffer.begin(), canceller->time_buffer.begin() + block_size, 0.0f);
+    std::copy(error, error + block_size, canceller->time_buffer.begin() + block_size);
+    canceller->fft.fwd(canceller->error_spectrum.data(), canceller->time_buffer.data(), fft_size);
+    // The unscaled transforms give half the step of a time domain NLMS over the block
+    float scaled_step = 2 * step;
+    // The bins between the harmonics of voiced speech are floored by the mean power, their step would be too large
+    float mean_power = 0;
+    for (int k = 0; k < bin_num; ++k) {
+        mean_power += canceller->reference_power[k];
+    }
+    float power_floor = ECHO_BIN_POWER_FLOOR * mean_power / bin_num + canceller->regularization;
+    for (int p = 0; p < canceller->partition_num; ++p) {
+        const echo_spectrum &reference = canceller->reference_spectra[(canceller->newest_partition + p) %
+                                                                      canceller->partition_num];
+        echo_spectrum &gradient = canceller->spectrum_buffer;
+        for (int k = 0; k < bin_num; ++k) {
+            float norm = canceller->reference_power[k] + power_floor;
+            gradient[k] = std::conj(reference[k]) * canceller->error_spectrum[k] * (scaled_step / norm);
+        }
+        // Only the first block_size taps, the others would wrap around in the circular convolution
+        canceller->fft.inv(canceller->time_buffer.data(), gradient.data(), fft_size);
+        std::fill(canceller->time_buffer.begin() + block_size, canceller->time_buffer.end(), 0.0f);
+        canceller->fft.fwd(gradient.data(), canceller->time_buffer.data(), fft_size);
+        echo_spectrum &weights = canceller->adapting_filter[p];
+        for (int k = 0; k < bin_num; ++k) {
+            weights[k] += gradient[k];
+        }
+    }
+}
+
+static float block_power(const float *samples, int size)
+{
+    float sum = 0;
+    for (int i = 0; i < size; ++i) {
+        sum += samples[i] * samples[i];
+    }
+    return sum / size;
+}
+
+static void echo_process_block(rkai_echo_canceller_t canceller)
+{
+    int block_size = canceller->config.block_size;
+    const float *capture = canceller->capture_block.data();
+    float *output = canceller->output_block.data();
+    int64_t history_size = (int64_t) canceller->reference_history.size();
+    int64_t reference_end = canceller->sample_count - std::max(canceller->delay, 0);
+
+    float reference_level = 0;
+    for (int i = 0; i < block_size; ++i) {
+        int64_t index = reference_end - block_size + i;
+        float sample = index < 0 ? 0.0f : canceller->reference_history[index % history_size];
+        reference_level += sample * sample;
+    }
+    reference_level = power_to_db(reference_level / block_size);
+    canceller->silent_block_count = reference_level < canceller->config.min_reference_db ?
+                                    canceller->silent_block_count + 1 : 0;
+    if (canceller->silent_block_count > canceller->partition_num) {
+        // No reference under the filter, nothing to cancel
+        std::copy(capture, capture + block_size, output);
+        canceller->are_spectra_stale = true;
+        canceller->double_talk_hold = 0;
+        std::lock_guard<std::mutex> lock(canceller->stats_mutex);
+        canceller->stats.block_count++;
+        return;
+    }
+
+    if (canceller->are_spectra_stale) {
+        echo_rebuild_spectra(canceller, reference_end);
+    } else {
+        // The oldest partition leaves the span and takes the newest block
+        canceller->newest_partition = (canceller->newest_partition + canceller->partition_num - 1) %
+                                      canceller->partition_num;
+        echo_spectrum &newest = canceller->reference_spectra[canceller->newest_partition];
+        for (int k = 0; k < canceller->bin_num; ++k) {
+            canceller->reference_power[k] -= std::norm(newest[k]);
+        }
+        echo_reference_spectrum(canceller, reference_end, newest);
+        for (int k = 0; k < canceller->bin_num; ++k) {
+            canceller->reference_power[k] = std::max(0.0f, canceller->reference_power[k] + std::norm(newest[k]));
+        }
+    }
+
+    std::vector<float> &adapting_error = canceller->adapting_error;
+    echo_filter_output(canceller, canceller->output_filter, capture, output);
+    echo_filter_output(canceller, canceller->adapting_filter, capture, adapting_error.data());
+
+    float alpha = ECHO_SHORT_SMOOTHING;
+    float capture_power = block_power(capture, block_size);
+    float output_error_power = block_power(output, block_size);
+    canceller->capture_power = alpha * canceller->capture_power + (1 - alpha) * capture_power;
+    canceller->output_error_power = alpha * canceller->output_error_power + (1 - alpha) * output_error_power;
+    canceller->adapting_error_power = alpha * canceller->adapting_error_power +
+                                      (1 - alpha) * block_power(adapting_error.data(), block_size);
+
+    // Two filters: the output filter takes the adapting one when it cancels better, and gives it back its
+    // coefficients when it diverged
+    bool is_copied = false;
+    if (canceller->adapting_error_power < ECHO_COPY_RATIO * canceller->output_error_power) {
+        canceller->output_filter = canceller->adapting_filter;
+        canceller->output_error_power = canceller->adapting_error_power;
+        is_copied = true;
+    } else if (canceller->adapting_error_power > ECHO_RESET_RATIO * canceller->output_error_power) {
+        canceller->adapting_filter = canceller->output_filter;
+        canceller->adapting_error_power = canceller->output_error_power;
+        echo_filter_output(canceller, canceller->adapting_filter, capture, adapting_error.data());
+    }
+    // Both diverged, adding more than they cancel, they start over
+    if (canceller->output_error_power > ECHO_RESET_RATIO * canceller->capture_power) {
+        for (int p = 0; p < canceller->partition_num; ++p) {
+            std::fill(canceller->output_filter[p].begin(), canceller->output_filter[p].end(), echo_complex(0, 0));
+            std::fill(canceller->adapting_filter[p].begin(), canceller->adapting_filter[p].end(),
+                      echo_complex(0, 0));
+        }
+        std::copy(capture, capture + block_size, output);
+        std::copy(capture, capture + block_size, adapting_error.begin());
+        canceller->output_error_power = canceller->capture_power;
+        canceller->adapting_error_power = canceller->capture_power;
+        canceller->erle_db = 0;
+        canceller->double_talk_hold = 0;
+        LOG_WARN("Echo canceller diverged, the filters are cleared\n");
+    }
+
+    // Double talk: the residual is well over what the converged filter leaves of the echo alone. The enhancement
+    // follows slowly in dB, a burst of near end speech does not pull it down before it is detected
+    float block_erle_db = power_to_db(canceller->capture_power) - power_to_db(canceller->output_error_power);
+    if (is_copied && block_erle_db >= ECHO_CONVERGED_ERLE_DB) {
+        // The adapting filter took the residual well under the capture: an echo path change, near end speech is
+        // not in the reference and cannot be cancelled
+        canceller->double_talk_hold = 0;
+        canceller->erle_db = std::min(canceller->erle_db, block_erle_db);
+    } else if (canceller->erle_db >= ECHO_CONVERGED_ERLE_DB &&
+               block_erle_db < canceller->erle_db - canceller->config.double_talk_margin_db) {
+        canceller->double_talk_hold = ECHO_DOUBLE_TALK_HOLD;
+    } else if (canceller->double_talk_hold > 0) {
+        canceller->double_talk_hold--;
+    }
+    bool is_double_talk = canceller->double_talk_hold > 0;
+    if (!is_double_talk && reference_level >= canceller->config.min_reference_db) {
+        float beta = ECHO_LONG_SMOOTHING;
+        canceller->erle_db = beta * canceller->erle_db + (1 - beta) * block_erle_db;
+    }
+    float erle_db = canceller->erle_db;
+    echo_adapt(canceller, adapting_error.data(),
+               canceller->config.step_size * (is_double_talk ? ECHO_DOUBLE_TALK_STEP : 1.0f));
+
+    std::lock_guard<std::mutex> lock(canceller->stats_mutex);
+    canceller->stats.block_count++;
+    canceller->stats.echo_block_count++;
+    if (is_double_talk) {
+        canceller->stats.double_talk_count++;
+    }
+    if (is_copied) {
+        canceller->stats.filter_copy_count++;
+    }
+    canceller->stats.erle_db = erle_db;
+}
+
+extern "C" rkai_ret_t rkai_echo_canceller_default_config(int sample_rate, rkai_echo_canceller_config_t *config)
+{
+    if (sample_rate <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->sample_rate = sample_rate;
+    config->block_size = sample_rate / 125;
+    config->filter_length = sample_rate * 128 / 1000;
+    config->max_delay = sample_rate / 2;
+    config->delay_interval = sample_rate;
+    config->step_size = 0.5f;
+    config->double_talk_margin_db = 6.0f;
+    config->min_reference_db = -60.0f;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_echo_canceller_t rkai_create_echo_canceller(const rkai_echo_canceller_config_t *config)
+{
+    // The real transforms of the blocks take multiples of 4
+    if (config == NULL || config->sample_rate <= 0 || config->block_size <= 0 || config->block_size % 2 != 0 ||
+        config->filter_length <= 0 || config->max_delay < 0 || config->delay_interval < ECHO_DELAY_DECIMATION ||
+        config->step_size <= 0 || config->step_size > 1) {
+        LOG_ERROR("Invalid echo canceller config \n");
+        return NULL;
+    }
+    rkai_echo_canceller_t canceller = new _rkai_echo_canceller_t();
+    canceller->config = *config;
+    int block_size = config->block_size;
+    canceller->partition_num = (config->filter_length + block_size - 1) / block_size;
+    canceller->bin_num = block_size + 1;
+    canceller->regularization = 2 * block_size * powf(10.0f, config->min_reference_db / 10);
+    canceller->fft.SetFlag(Eigen::FFT<float>::HalfSpectrum);
+    canceller->capture_block.resize(block_size);
+    canceller->output_block.resize(block_size);
+    canceller->reference_history.resize(config->max_delay + (canceller->partition_num + 2) * block_size);
+    canceller->reference_spectra.resize(canceller->partition_num);
+    canceller->output_filter.resize(canceller->partition_num);
+    canceller->adapting_filter.resize(canceller->partition_num);
+    canceller->reference_power.resize(canceller->bin_num);
+    canceller->decimated_capture.resize(config->delay_interval / ECHO_DELAY_DECIMATION +
+                                        config->max_delay / ECHO_DELAY_DECIMATION + 1);
+    canceller->decimated_reference.resize(canceller->decimated_capture.size());
+    canceller->time_buffer.resize(2 * block_size);
+    canceller->adapting_error.resize(block_size);
+    canceller->taps.resize(canceller->partition_num * block_size);
+    int delay_size = (int) canceller->decimated_capture.size();
+    int delay_fft_size = 4;
+    while (delay_fft_size < delay_size) {
+        delay_fft_size *= 2;
+    }
+    canceller->delay_capture.resize(delay_fft_size);
+    canceller->delay_reference.resize(delay_fft_size);
+    canceller->delay_energy.resize(delay_size, 0.0);
+    canceller->delay_correlation.resize(delay_fft_size);
+    canceller->delay_capture_spectrum.resize(delay_fft_size / 2 + 1);
+    canceller->delay_reference_spectrum.resize(delay_fft_size / 2 + 1);
+    canceller->spectrum_buffer.resize(canceller->bin_num);
+    canceller->echo_spectrum_buffer.resize(canceller->bin_num);
+    canceller->error_spectrum.resize(canceller->bin_num);
+    echo_canceller_clear(canceller);
+    memset(&canceller->stats, 0, sizeof(rkai_echo_canceller_stats_t));
+    canceller->stats.delay = -1;
+    return canceller;
+}
+
+extern "C" rkai_ret_t rkai_release_echo_canceller(rkai_echo_canceller_t canceller)
+{
+    if (canceller == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete canceller;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_echo_canceller_process(rkai_echo_canceller_t canceller, const float *capture,
+                                                  const float *reference, int size, float *output,
+                                                  int *is_double_talk)
+{
+    if (canceller == NULL || capture == NULL || reference == NULL || output == NULL || size < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    int block_size = canceller->config.block_size;
+    int64_t history_size = (int64_t) canceller->reference_history.size();
+    int64_t decimated_size = (int64_t) canceller->decimated_capture.size();
+    for (int i = 0; i < size; ++i) {
+        // Read before the output is written, it can be the capture
+        float capture_sample = capture[i];
+        float reference_sample = reference[i];
+        output[i] = canceller->output_block[canceller->block_fill];
+        canceller->capture_block[canceller->block_fill++] = capture_sample;
+        canceller->reference_history[canceller->sample_count % history_size] = reference_sample;
+        canceller->sample_count++;
+        canceller->capture_sum += capture_sample;
+        canceller->reference_sum += reference_sample;
+        if (canceller->sample_count % ECHO_DELAY_DECIMATION == 0) {
+            int64_t index = canceller->decimated_count++ % decimated_size;
+            canceller->decimated_capture[index] = canceller->capture_sum / ECHO_DELAY_DECIMATION;
+            canceller->decimated_reference[index] = canceller->reference_sum / ECHO_DELAY_DECIMATION;
+            canceller->capture_sum = 0;
+            canceller->reference_sum = 0;
+        }
+        if (canceller->block_fill == block_size) {
+            canceller->block_fill = 0;
+            echo_process_block(canceller);
+            if (canceller->sample_count >= canceller->next_delay_estimate) {
+                canceller->next_delay_estimate += canceller->config.delay_interval;
+                echo_estimate_delay(canceller);
+            }
+        }
+    }
+    if (is_double_talk != NULL) {
+        *is_double_talk = canceller->double_talk_hold > 0;
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_echo_canceller_reset(rkai_echo_canceller_t canceller)
+{
+    if (canceller == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    echo_canceller_clear(canceller);
+    std::lock_guard<std::mutex> lock(canceller->stats_mutex);
+    canceller->stats.delay = -1;
+    canceller->stats.delay_correlation = 0;
+    canceller->stats.erle_db = 0;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_echo_canceller_get_stats(rkai_echo_canceller_t canceller,
+                                                    rkai_echo_canceller_stats_t *stats)
+{
+    if (canceller == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(canceller->stats_mutex);
+    *stats = canceller->stats;
+    stats->config = canceller->config;
+    return RKAI_RET_SUCCESS;
+}
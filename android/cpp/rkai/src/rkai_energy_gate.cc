@@ -0,0 +1,178 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_energy_gate.h"
+
+// Power of a digital silence frame, keeps log10 finite
+#define ENERGY_GATE_MIN_POWER 1e-12f
+
+struct _rkai_energy_gate_t {
+    rkai_energy_gate_config_t config;
+    float smoothed_power;           // Recursively smoothed frame power, < 0 before the first frame
+    float subwindow_min;            // Minimum of the smoothed power in the current sub-window
+    int subwindow_frame_count;      // Frames in the current sub-window
+    std::vector<float> subwindow_mins;  // Minimum of the last complete sub-windows
+    int next_subwindow;
+    int complete_subwindow_count;
+    std::mutex stats_mutex;
+    rkai_energy_gate_stats_t stats;
+};
+
+static float power_to_db(float power)
+{
+    return 10.0f * log10f(std::max(power, ENERGY_GATE_MIN_POWER));
+}
+
+static float frame_power(const float *samples, int frame_length)
+{
+    float sum = 0;
+    for (int i = 0; i < frame_length; ++i) {
+        sum += samples[i] * samples[i];
+    }
+    return sum / frame_length;
+}
+
+static void energy_gate_clear(rkai_energy_gate_t gate)
+{
+    gate->smoothed_power = -1;
+    gate->subwindow_min = INFINITY;
+    gate->subwindow_frame_count = 0;
+    gate->next_subwindow = 0;
+    gate->complete_subwindow_count = 0;
+    std::fill(gate->subwindow_mins.begin(), gate->subwindow_mins.end(), INFINITY);
+}
+
+/**
+ * @brief Minimum statistics: the floor is the minimum of the smoothed power over the last complete sub-windows and
+ *        the current one. Speech shorter than the tracking length always has pauses lower than itself in it
+ */
+static float energy_gate_noise_floor(rkai_energy_gate_t gate)
+{
+    float floor_power = gate->subwindow_min;
+    for (int i = 0; i < gate->complete_subwindow_count; ++i) {
+        floor_power = std::min(floor_power, gate->subwindow_mins[i]);
+    }
+    return floor_power;
+}
+
+static void energy_gate_update(rkai_energy_gate_t gate, float power)
+{
+    float alpha = gate->config.smoothing;
+    gate->smoothed_power = gate->smoothed_power < 0 ? power : alpha * gate->smoothed_power + (1 - alpha) * power;
+    gate->subwindow_min = std::min(gate->subwindow_min, gate->smoothed_power);
+    gate->subwindow_frame_count++;
+    if (gate->subwindow_frame_count >= gate->config.subwindow_frames) {
+        gate->subwindow_mins[gate->next_subwindow] = gate->subwindow_min;
+        gate->next_subwindow = (gate->next_subwindow + 1) % gate->config.subwindow_num;
+        gate->complete_subwindow_count = std::min(gate->complete_subwindow_count + 1, gate->config.subwindow_num);
+        gate->subwindow_min = INFINITY;
+        gate->subwindow_frame_count = 0;
+    }
+}
+
+extern "C" rkai_ret_t rkai_energy_gate_default_config(int sample_rate, rkai_energy_gate_config_t *config)
+{
+    if (sample_rate <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->frame_length = sample_rate / 50;
+    config->smoothing = 0.8f;
+    config->subwindow_frames = 25;
+    config->subwindow_num = 6;
+    config->margin_db = 10.0f;
+    config->min_level_db = -60.0f;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_energy_gate_t rkai_create_energy_gate(const rkai_energy_gate_config_t *config)
+{
+    if (config == NULL || config->frame_length <= 0 || config->subwindow_frames <= 0 || config->subwindow_num <= 0 ||
+        config->smoothing < 0 || config->smoothing >= 1) {
+        LOG_ERROR("Invalid energy gate config \n");
+        return NULL;
+    }
+    rkai_energy_gate_t gate = new _rkai_energy_gate_t();
+    gate->config = *config;
+    gate->subwindow_mins.resize(config->subwindow_num);
+    energy_gate_clear(gate);
+    memset(&gate->stats, 0, sizeof(rkai_energy_gate_stats_t));
+    return gate;
+}
+
+extern "C" rkai_ret_t rkai_release_energy_gate(rkai_energy_gate_t gate)
+{
+    if (gate == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete gate;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_energy_gate_process(rkai_energy_gate_t gate, rkai_audio_t *audio, int new_sample_count,
+                                               int *is_active)
+{
+    if (gate == NULL || audio == NULL || audio->data == NULL || is_active == NULL || new_sample_count < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    int frame_length = gate->config.frame_length;
+    int size = (int) audio->size;
+    new_sample_count = std::min(new_sample_count, size);
+
+    // The new samples feed the noise floor once, the overlap with the previous window was already counted
+    for (int start = size - new_sample_count; start + frame_length <= size; start += frame_length) {
+        energy_gate_update(gate, frame_power(audio->data + start, frame_length));
+    }
+
+    float max_power = 0;
+    for (int start = 0; start + frame_length <= size; start += frame_length) {
+        max_power = std::max(max_power, frame_power(audio->data + start, frame_length));
+    }
+    float level_db = power_to_db(max_power);
+    float noise_floor_db = power_to_db(energy_gate_noise_floor(gate));
+    *is_active = level_db > gate->config.min_level_db && level_db > noise_floor_db + gate->config.margin_db;
+
+    std::lock_guard<std::mutex> lock(gate->stats_mutex);
+    gate->stats.window_count++;
+    if (!*is_active) {
+        gate->stats.skipped_count++;
+    }
+    gate->stats.noise_floor_db = noise_floor_db;
+    gate->stats.last_level_db = level_db;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_energy_gate_reset(rkai_energy_gate_t gate)
+{
+    if (gate == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    energy_gate_clear(gate);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_energy_gate_get_stats(rkai_energy_gate_t gate, rkai_energy_gate_stats_t *stats)
+{
+    if (gate == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(gate->stats_mutex);
+    *stats = gate->stats;
+    stats->config = gate->config;
+    return RKAI_RET_SUCCESS;
+}
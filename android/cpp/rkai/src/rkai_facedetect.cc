@@ -14,8 +14,15 @@
  ******************************************************************************/
 
 #include <stdlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "utils/rkai_postprocess.h"
+#include "utils/rkai_anchor.h"
 #include "utils/util.h"
 #include "rkai_facedetect.h"
 #include "utils/logger.h"
@@ -26,119 +33,100 @@
 
 // Private macro
 #define DETECT_MODEL_PATH "model/face_detect/best.rknn"
-#define ANCHOR_INFORMATION_PATH "model/face_detect/anchor_information.txt"
+#define ANCHOR_INFORMATION_PATH "model/face_detect/anchor_information.txt" // Only read with RKAI_ANCHOR_FROM_FILE
 #define MAX_COAST_CYCLES 12
-rkai_size_t required_detect_size = {.w=640, .h=480};
+#define FACE_PIPELINE_OUTPUT_NUM 3 // loc, conf, landmark
 
-anchors_t anchors;
-// Private tracker declaration
-BaseBYTETracker <BaseSTrack, rkai_det_t> rkai_tracker_detect;
-rkai_ret_t load_anchor_file(const char *file_name)
-{
-    AAsset *fp = android_fopen(file_name, "r");
-    char line[1024000];
-    int count = 0;
-    if (fp == NULL)
-    {
-        LOG_ERROR("Cannot open file %s \n", file_name);
-        return RKAI_RET_COMMON_FAIL;
-    }
-
-    if( android_read(fp, line, 1024000) < 0){
-        LOG_ERROR("Cannot read file %s \n", file_name);
-        return RKAI_RET_COMMON_FAIL;
-    }
+/**
+ * @brief Read only state of the face detection model, stored in handle->model_data
+ */
+typedef struct rkai_face_detect_data_t {
+    anchors_t anchors;
+    rkai_size_t required_detect_size;
+} rkai_face_detect_data_t;
 
-    char *token;
+// Tracker of a handle, stored in handle->session_data
+typedef BaseBYTETracker <BaseSTrack, rkai_det_t> rkai_face_tracker_t;
 
-    token = strtok(line, "\n");
-    // Read the file to anchors array
-    while(token != NULL)
-    {
-        LOG_DEBUG("Read data from file---------------- %s\n", token);
-        if (count == 0)
-        {
-            if(sscanf(token, "%d %d %d %d", &anchors.num_anchors, &anchors.anchors_array_size, &required_detect_size.w, &required_detect_size.h) == 0)
-            {
-                LOG_ERROR("Failed to read anchor information from file %s, please check th number of anchors and total size of anchor array\n", file_name);
-                return RKAI_RET_COMMON_FAIL;
-            }
-            anchors.curr_idx = 0;
-            anchors.data = (float *)malloc(anchors.anchors_array_size * sizeof(float));
-        } else {
-            float x, y, w, h;
-            if(sscanf(token, "%f %f %f %f", &x, &y, &w, &h) == 0)
-            {
-                LOG_ERROR("open file %s failed\n", file_name);
-                return RKAI_RET_COMMON_FAIL;
-            }
+static void release_face_detect_data(void *model_data)
+{
+    rkai_face_detect_data_t *data = (rkai_face_detect_data_t *) model_data;
+    free(data->anchors.data);
+    delete data;
+}
 
-            anchors.data[anchors.curr_idx*4+0] = x;
-            anchors.data[anchors.curr_idx*4+1] = y;
-            anchors.data[anchors.curr_idx*4+2] = w;
-            anchors.data[anchors.curr_idx*4+3] = h;
-            anchors.curr_idx += 1;
-        }
+static void release_face_tracker(void *session_data)
+{
+    delete (rkai_face_tracker_t *) session_data;
+}
 
-        token = strtok(NULL, "\n");
-        count += 1;
+static rkai_face_detect_data_t *get_face_detect_data(rkai_handle_t handle)
+{
+    if (handle == NULL || handle->model_data == NULL) {
+        LOG_ERROR("Face detector is not initialized \n");
+        return NULL;
     }
-    android_close(fp);
-    return RKAI_RET_SUCCESS;
+    return (rkai_face_detect_data_t *) handle->model_data;
 }
 
-extern "C" rkai_ret_t rkai_init_detector(rkai_handle_t handle)
+/**
+ * @brief Build the priors of the detector. They are generated from @ref FACE_DETECT_ANCHOR_CONFIG unless
+ *        RKAI_ANCHOR_FROM_FILE is defined, in which case the legacy text file is parsed
+ */
+static rkai_ret_t load_anchors(rkai_handle_t handle, rkai_face_detect_data_t *data)
 {
-    // memset(&anchors, 0, sizeof(anchors_t));
-    rkai_ret_t ret = load_anchor_file(ANCHOR_INFORMATION_PATH);
+    int64_t start_time = get_current_time_us();
+#ifdef RKAI_ANCHOR_FROM_FILE
+    rkai_ret_t ret = rkai_load_anchor_file(handle->asset_manager, ANCHOR_INFORMATION_PATH, &data->anchors,
+                                           &data->required_detect_size);
+#else
+    (void) handle;
+    rkai_ret_t ret = rkai_generate_anchors(&FACE_DETECT_ANCHOR_CONFIG, &data->anchors);
+    data->required_detect_size.w = FACE_DETECT_ANCHOR_CONFIG.image_width;
+    data->required_detect_size.h = FACE_DETECT_ANCHOR_CONFIG.image_height;
+#endif
     if (ret != RKAI_RET_SUCCESS)
     {
-        LOG_ERROR("Load anchor file failed \n");
+        LOG_ERROR("Load anchors failed \n");
         return RKAI_RET_COMMON_FAIL;
     }
-    return model_init(handle, DETECT_MODEL_PATH);
+    LOG_INFO("Loaded %d anchors in %lld us \n", data->anchors.num_anchors,
+             (long long) (get_current_time_us() - start_time));
+    return RKAI_RET_SUCCESS;
 }
 
-extern "C" rkai_ret_t rkai_init_detector_android(rkai_handle_t handle, AAssetManager *asset_mgr)
+extern "C" rkai_ret_t rkai_init_detector(rkai_handle_t handle)
 {
-    rkai_ret_t ret = load_anchor_file(ANCHOR_INFORMATION_PATH);
+    return rkai_init_detector_android(handle, NULL);
+}
 
+extern "C" rkai_ret_t rkai_init_detector_android(rkai_handle_t handle, AAssetManager *asset_mgr)
+{
+    handle->asset_manager = asset_mgr;
+    rkai_face_detect_data_t *data = new rkai_face_detect_data_t();
+    rkai_ret_t ret = load_anchors(handle, data);
+    if (ret == RKAI_RET_SUCCESS)
+    {
+        ret = model_init(handle, DETECT_MODEL_PATH);
+    }
     if (ret != RKAI_RET_SUCCESS)
     {
-        LOG_ERROR("Load anchor file failed \n");
-        return RKAI_RET_COMMON_FAIL;
+        release_face_detect_data(data);
+        return ret;
     }
-    return model_init(handle, DETECT_MODEL_PATH);
+    handle->model_data = data;
+    handle->release_model_data = release_face_detect_data;
+    return RKAI_RET_SUCCESS;
 }
 
-extern "C" rkai_ret_t rkai_face_detect(rkai_handle_t handle, rkai_image_t *image, rkai_det_array_t *detected_face_array)
+/**
+ * @brief Copy the preprocessed image to the model input, run the model and get the float outputs.
+ *        @p outputs must hold handle->io_num.n_output entries, either preallocated or not
+ */
+static rkai_ret_t face_detect_inference(rkai_handle_t handle, unsigned char *input_image, rknn_output *outputs)
 {
-
     rknn_input inputs[1];
-
-    float variances[2] = {0.1, 0.2};
-    // Init model output info
     int rknn_ret_code;
-    rkai_ret_t rkai_ret_code = RKAI_RET_SUCCESS;
-
-    // convert to rgb24 and resize
-    int req_width = required_detect_size.w;
-    int req_height = required_detect_size.h;
-    int input_buffer_size = req_width * req_height * 3;
-    unsigned char *input_image = (unsigned char *) malloc(input_buffer_size);
-
-    if (input_image == NULL) {
-        LOG_ERROR("Malloc input image failed \n");
-        rkai_ret_code = RKAI_RET_COMMON_FAIL;
-        return rkai_ret_code;
-    }
-
-    int64_t start_time = get_current_time_us();
-    rkai_ret_code = preprocess(image, input_image, req_width, req_height);
-    if (rkai_ret_code != RKAI_RET_SUCCESS) {
-        free(input_image);
-        return rkai_ret_code;
-    }
     memset(inputs, 0, sizeof(inputs));
 
     // Set input data
@@ -147,68 +135,431 @@ extern "C" rkai_ret_t rkai_face_detect(rkai_handle_t handle, rkai_image_t *image
     inputs[0].size = handle->input_tensor_attr[0].size;
     inputs[0].fmt = RKNN_TENSOR_NHWC;
     inputs[0].buf = input_image;
-    int64_t start_time_input = get_current_time_us();
     rknn_ret_code = rknn_inputs_set(handle->context, handle->io_num.n_input, inputs);
     if (rknn_ret_code != RKNN_SUCC) {
         LOG_WARN("Failed to Init Face detection Input data. Return code of function rknn_input_set = %d\n",
                  rknn_ret_code);
-        rkai_ret_code = RKAI_RET_COMMON_FAIL;
-        free(input_image);
-        return rkai_ret_code;
+        return RKAI_RET_COMMON_FAIL;
     }
 
     // Inference
-    int64_t start_time_inference = get_current_time_us();
-    rknn_ret_code = rknn_run(handle->context, NULL);
+    rknn_ret_code = model_run(handle);
     if (rknn_ret_code != RKNN_SUCC)
     {
         LOG_WARN("Failed to run inference. rknn_run return code = %d\n", rknn_ret_code);
-        rkai_ret_code = RKAI_RET_COMMON_FAIL;
-        free(input_image);
-        return rkai_ret_code;
+        return RKAI_RET_COMMON_FAIL;
     }
 
     // Get output
-    rknn_output outputs[handle->io_num.n_output];
-    memset(outputs, 0, sizeof(outputs));
-    for (int j = 0; j < handle->io_num.n_output; j++) {
-        outputs[j].want_float = 1;
-    }
-    int64_t start_time_output = get_current_time_us();
     rknn_ret_code = rknn_outputs_get(handle->context, handle->io_num.n_output, outputs, NULL);
     if (rknn_ret_code != RKNN_SUCC) {
         LOG_WARN("Failed to get output after inference, rknn_outputs_get return code %d \n", rknn_ret_code);
-        rkai_ret_code = RKAI_RET_COMMON_FAIL;
-        free(input_image);
-        return rkai_ret_code;
+        return RKAI_RET_COMMON_FAIL;
     }
+    return RKAI_RET_SUCCESS;
+}
 
-    //Extract output
-    float *loc = (float *) outputs[0].buf;
-    float *conf = (float *) outputs[1].buf;
-    float *landmark = (float *) outputs[2].buf;
+/**
+ * @brief Decode the model outputs to faces in the coordinate of the original image
+ */
+static rkai_ret_t face_detect_decode(rkai_face_detect_data_t *data, float *loc, float *conf, float *landmark,
+                                     int image_width, int image_height, rkai_det_array_t *detected_face_array)
+{
+    float variances[2] = {0.1, 0.2};
+    int req_width = data->required_detect_size.w;
+    int req_height = data->required_detect_size.h;
 
     //Post process and get detected faces
-    int64_t start_time_postprocess = get_current_time_us();
-    rkai_ret_code = postprocess(anchors,loc, conf, landmark, variances, detected_face_array,req_width,req_height);
+    rkai_ret_t rkai_ret_code = postprocess(data->anchors, loc, conf, landmark, variances, detected_face_array,
+                                           req_width, req_height);
     if (rkai_ret_code != RKAI_RET_SUCCESS)
     {
         LOG_WARN("Failed to postprocess \n");
+        return RKAI_RET_COMMON_FAIL;
+    }
+    convert_cordinate(detected_face_array, req_width, req_height, image_width, image_height);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_face_detect(rkai_handle_t handle, rkai_image_t *image, rkai_det_array_t *detected_face_array)
+{
+    int rknn_ret_code;
+    rkai_ret_t rkai_ret_code = RKAI_RET_SUCCESS;
+    rkai_face_detect_data_t *data = get_face_detect_data(handle);
+    if (data == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+
+    // convert to rgb24 and resize
+    int req_width = data->required_detect_size.w;
+    int req_height = data->required_detect_size.h;
+    int input_buffer_size = req_width * req_height * 3;
+    unsigned char *input_image = (unsigned char *) malloc(input_buffer_size);
+
+    if (input_image == NULL) {
+        LOG_ERROR("Malloc input image failed \n");
         rkai_ret_code = RKAI_RET_COMMON_FAIL;
+        return rkai_ret_code;
+    }
+
+    rkai_ret_code = preprocess(image, input_image, req_width, req_height);
+    if (rkai_ret_code != RKAI_RET_SUCCESS) {
         free(input_image);
         return rkai_ret_code;
     }
-    convert_cordinate(detected_face_array, req_width, req_height, image->width, image->height);
+
+    rknn_output outputs[handle->io_num.n_output];
+    memset(outputs, 0, sizeof(outputs));
+    for (uint32_t j = 0; j < handle->io_num.n_output; j++) {
+        outputs[j].want_float = 1;
+    }
+    rkai_ret_code = face_detect_inference(handle, input_image, outputs);
+    free(input_image);
+    if (rkai_ret_code != RKAI_RET_SUCCESS) {
+        return rkai_ret_code;
+    }
+
+    //Extract output
+    float *loc = (float *) outputs[0].buf;
+    float *conf = (float *) outputs[1].buf;
+    float *landmark = (float *) outputs[2].buf;
+    rkai_ret_code = face_detect_decode(data, loc, conf, landmark, image->width, image->height, detected_face_array);
 
     //Release dynamic allocation resource here
     rknn_ret_code = rknn_outputs_release(handle->context, handle->io_num.n_output, outputs);
     if (rknn_ret_code != RKAI_RET_SUCCESS) {
         LOG_WARN("Failed to release dynamic allocation resource %d \n", rknn_ret_code);
     }
-    free(input_image);
     return rkai_ret_code;
 }
 
+/**
+ * @brief Life cycle of a staging slot of the face detection pipeline
+ */
+typedef enum rkai_face_slot_state_t {
+    RKAI_FACE_SLOT_FREE = 0,            ///< Available for a new frame
+    RKAI_FACE_SLOT_PREPROCESSING,       ///< Owned by a submitting thread
+    RKAI_FACE_SLOT_PREPROCESSED,        ///< Waiting for the NPU
+    RKAI_FACE_SLOT_INFERRED,            ///< Waiting for decoding and NMS
+    RKAI_FACE_SLOT_DONE                 ///< Waiting for the caller to collect the result
+} rkai_face_slot_state_t;
+
+/**
+ * @brief Staging buffers of one frame in flight. Output buffers are allocated once and handed to rknn_outputs_get
+ */
+typedef struct rkai_face_slot_t {
+    rkai_face_slot_state_t state;
+    uint64_t frame_id;
+    uint32_t image_width;
+    uint32_t image_height;
+    int64_t submit_us;
+    unsigned char *input_image;
+    float *output_buffers[FACE_PIPELINE_OUTPUT_NUM];
+    rkai_det_array_t detected_face_array;
+    rkai_ret_t ret;
+} rkai_face_slot_t;
+
+struct _rkai_face_pipeline_t {
+    rkai_handle_t handle;
+    rkai_face_detect_data_t *data;
+    int req_width;
+    int req_height;
+    uint32_t output_sizes[FACE_PIPELINE_OUTPUT_NUM];
+    std::vector<rkai_face_slot_t> slots;
+    // Slot indices of each stage, in frame order. Every stage has a single worker so the order is kept until the end
+    std::deque<int> preprocessed_slots;
+    std::deque<int> inferred_slots;
+    std::deque<int> done_slots;
+    std::mutex mutex;
+    // One condition per waiter, so a stage only wakes the one that has work from it
+    std::condition_variable slot_freed;
+    std::condition_variable preprocessed_ready;
+    std::condition_variable inferred_ready;
+    std::condition_variable done_ready;
+    uint64_t next_frame_id;
+    bool is_running;
+    std::thread inference_thread;
+    std::thread postprocess_thread;
+    rkai_face_pipeline_stats_t stats;
+};
+
+/**
+ * @brief Wait for @p condition with the timeout convention of the pipeline. 0: do not wait, < 0: wait forever
+ */
+template<typename Predicate>
+static bool face_pipeline_wait(std::condition_variable &changed, std::unique_lock<std::mutex> &lock, int timeout_ms,
+                               Predicate condition)
+{
+    if (timeout_ms < 0) {
+        changed.wait(lock, condition);
+        return true;
+    }
+    return changed.wait_for(lock, std::chrono::milliseconds(timeout_ms), condition);
+}
+
+static void face_pipeline_inference_loop(rkai_face_pipeline_t pipeline)
+{
+    rkai_handle_t handle = pipeline->handle;
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    while (true) {
+        pipeline->preprocessed_ready.wait(lock, [pipeline] {
+            return !pipeline->is_running || !pipeline->preprocessed_slots.empty();
+        });
+        if (!pipeline->is_running) {
+            return;
+        }
+        int index = pipeline->preprocessed_slots.front();
+        pipeline->preprocessed_slots.pop_front();
+        rkai_face_slot_t *slot = &pipeline->slots[index];
+        lock.unlock();
+
+        rknn_output outputs[FACE_PIPELINE_OUTPUT_NUM];
+        memset(outputs, 0, sizeof(outputs));
+        for (int j = 0; j < FACE_PIPELINE_OUTPUT_NUM; j++) {
+            outputs[j].want_float = 1;
+            outputs[j].is_prealloc = 1;
+            outputs[j].buf = slot->output_buffers[j];
+            outputs[j].size = pipeline->output_sizes[j];
+        }
+        int64_t start_us = get_current_time_us();
+        rkai_ret_t ret = face_detect_inference(handle, slot->input_image, outputs);
+        if (ret == RKAI_RET_SUCCESS) {
+            rknn_outputs_release(handle->context, FACE_PIPELINE_OUTPUT_NUM, outputs);
+        }
+        int64_t end_us = get_current_time_us();
+
+        lock.lock();
+        slot->ret = ret;
+        slot->state = RKAI_FACE_SLOT_INFERRED;
+        pipeline->inferred_slots.push_back(index);
+        pipeline->stats.total_inference_us += end_us - start_us;
+        pipeline->inferred_ready.notify_one();
+    }
+}
+
+static void face_pipeline_postprocess_loop(rkai_face_pipeline_t pipeline)
+{
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    while (true) {
+        pipeline->inferred_ready.wait(lock, [pipeline] {
+            return !pipeline->is_running || !pipeline->inferred_slots.empty();
+        });
+        if (!pipeline->is_running) {
+            return;
+        }
+        int index = pipeline->inferred_slots.front();
+        pipeline->inferred_slots.pop_front();
+        rkai_face_slot_t *slot = &pipeline->slots[index];
+        lock.unlock();
+
+        int64_t start_us = get_current_time_us();
+        slot->detected_face_array.count = 0;
+        if (slot->ret == RKAI_RET_SUCCESS) {
+            slot->ret = face_detect_decode(pipeline->data, slot->output_buffers[0], slot->output_buffers[1],
+                                           slot->output_buffers[2], slot->image_width, slot->image_height,
+                                           &slot->detected_face_array);
+        }
+        int64_t end_us = get_current_time_us();
+
+        lock.lock();
+        slot->state = RKAI_FACE_SLOT_DONE;
+        pipeline->done_slots.push_back(index);
+        pipeline->stats.total_postprocess_us += end_us - start_us;
+        pipeline->done_ready.notify_all();
+    }
+}
+
+static void face_pipeline_free_slots(rkai_face_pipeline_t pipeline)
+{
+    for (rkai_face_slot_t &slot : pipeline->slots) {
+        free(slot.input_image);
+        for (int j = 0; j < FACE_PIPELINE_OUTPUT_NUM; j++) {
+            free(slot.output_buffers[j]);
+        }
+    }
+}
+
+extern "C" rkai_face_pipeline_t rkai_create_face_pipeline(rkai_handle_t handle, int staging_num)
+{
+    rkai_face_detect_data_t *data = get_face_detect_data(handle);
+    if (data == NULL || staging_num < 2) {
+        LOG_ERROR("Invalid handle or number of staging buffers %d \n", staging_num);
+        return NULL;
+    }
+    if (handle->io_num.n_output != FACE_PIPELINE_OUTPUT_NUM) {
+        LOG_ERROR("Face detection model has %d outputs, expect %d \n", handle->io_num.n_output,
+                  FACE_PIPELINE_OUTPUT_NUM);
+        return NULL;
+    }
+
+    rkai_face_pipeline_t pipeline = new _rkai_face_pipeline_t();
+    pipeline->handle = handle;
+    pipeline->data = data;
+    pipeline->req_width = data->required_detect_size.w;
+    pipeline->req_height = data->required_detect_size.h;
+    pipeline->next_frame_id = 0;
+    pipeline->is_running = true;
+    memset(&pipeline->stats, 0, sizeof(rkai_face_pipeline_stats_t));
+    pipeline->stats.staging_num = staging_num;
+    for (int j = 0; j < FACE_PIPELINE_OUTPUT_NUM; j++) {
+        pipeline->output_sizes[j] = handle->output_tensor_attr[j].n_elems * sizeof(float);
+    }
+
+    bool is_allocated = true;
+    pipeline->slots.resize(staging_num);
+    for (rkai_face_slot_t &slot : pipeline->slots) {
+        memset(&slot, 0, sizeof(rkai_face_slot_t));
+        slot.input_image = (unsigned char *) malloc(pipeline->req_width * pipeline->req_height * 3);
+        is_allocated = is_allocated && slot.input_image != NULL;
+        for (int j = 0; j < FACE_PIPELINE_OUTPUT_NUM; j++) {
+            slot.output_buffers[j] = (float *) malloc(pipeline->output_sizes[j]);
+            is_allocated = is_allocated && slot.output_buffers[j] != NULL;
+        }
+    }
+    if (!is_allocated) {
+        LOG_ERROR("Malloc staging buffers failed \n");
+        face_pipeline_free_slots(pipeline);
+        delete pipeline;
+        return NULL;
+    }
+
+    pipeline->inference_thread = std::thread(face_pipeline_inference_loop, pipeline);
+    pipeline->postprocess_thread = std::thread(face_pipeline_postprocess_loop, pipeline);
+    return pipeline;
+}
+
+extern "C" rkai_ret_t rkai_release_face_pipeline(rkai_face_pipeline_t pipeline)
+{
+    if (pipeline == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pipeline->mutex);
+        pipeline->is_running = false;
+    }
+    pipeline->preprocessed_ready.notify_all();
+    pipeline->inferred_ready.notify_all();
+    pipeline->inference_thread.join();
+    pipeline->postprocess_thread.join();
+    face_pipeline_free_slots(pipeline);
+    delete pipeline;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_face_pipeline_submit(rkai_face_pipeline_t pipeline, rkai_image_t *image, int timeout_ms,
+                                                uint64_t *frame_id)
+{
+    if (pipeline == NULL || image == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+
+    rkai_face_slot_t *slot = NULL;
+    int index = -1;
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    auto find_free_slot = [pipeline, &index] {
+        for (size_t i = 0; i < pipeline->slots.size(); ++i) {
+            if (pipeline->slots[i].state == RKAI_FACE_SLOT_FREE) {
+                index = (int) i;
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!face_pipeline_wait(pipeline->slot_freed, lock, timeout_ms, find_free_slot)) {
+        LOG_WARN("No free staging buffer after %d ms \n", timeout_ms);
+        return RKAI_RET_TIMEOUT;
+    }
+    slot = &pipeline->slots[index];
+    slot->state = RKAI_FACE_SLOT_PREPROCESSING;
+    lock.unlock();
+
+    // The slot was freed by the frame that left the NPU, the NPU thread is about to start the next one. Let it take
+    // the CPU first, or with fewer CPUs than stages the NPU waits for the preprocessing and nothing overlaps
+    std::this_thread::yield();
+    // Preprocess on the calling thread, while the NPU and the postprocess thread work on the previous frames
+    int64_t start_us = get_current_time_us();
+    rkai_ret_t ret = preprocess(image, slot->input_image, pipeline->req_width, pipeline->req_height);
+    int64_t end_us = get_current_time_us();
+
+    lock.lock();
+    if (ret != RKAI_RET_SUCCESS) {
+        slot->state = RKAI_FACE_SLOT_FREE;
+        lock.unlock();
+        pipeline->slot_freed.notify_all();
+        return ret;
+    }
+    // Frame ids are given after preprocessing so that they follow the order the frames enter the NPU
+    slot->frame_id = pipeline->next_frame_id++;
+    slot->image_width = image->width;
+    slot->image_height = image->height;
+    slot->submit_us = start_us;
+    slot->state = RKAI_FACE_SLOT_PREPROCESSED;
+    pipeline->preprocessed_slots.push_back(index);
+    if (pipeline->stats.submitted_count == 0) {
+        pipeline->stats.first_submit_us = start_us;
+    }
+    pipeline->stats.submitted_count++;
+    pipeline->stats.total_preprocess_us += end_us - start_us;
+    if (frame_id != NULL) {
+        *frame_id = slot->frame_id;
+    }
+    lock.unlock();
+    pipeline->preprocessed_ready.notify_one();
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_face_pipeline_get_result(rkai_face_pipeline_t pipeline, int timeout_ms, uint64_t *frame_id,
+                                                    rkai_det_array_t *detected_face_array)
+{
+    if (pipeline == NULL || detected_face_array == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    auto has_result = [pipeline] { return !pipeline->done_slots.empty(); };
+    if (!face_pipeline_wait(pipeline->done_ready, lock, timeout_ms, has_result)) {
+        return RKAI_RET_TIMEOUT;
+    }
+    int index = pipeline->done_slots.front();
+    pipeline->done_slots.pop_front();
+    rkai_face_slot_t *slot = &pipeline->slots[index];
+    rkai_ret_t ret = slot->ret;
+    if (frame_id != NULL) {
+        *frame_id = slot->frame_id;
+    }
+    if (ret == RKAI_RET_SUCCESS) {
+        *detected_face_array = slot->detected_face_array;
+    } else {
+        detected_face_array->count = 0;
+    }
+
+    int64_t now_us = get_current_time_us();
+    int64_t latency_us = now_us - slot->submit_us;
+    pipeline->stats.completed_count++;
+    if (ret != RKAI_RET_SUCCESS) {
+        pipeline->stats.failed_count++;
+    }
+    pipeline->stats.total_latency_us += latency_us;
+    if (latency_us > pipeline->stats.max_latency_us) {
+        pipeline->stats.max_latency_us = latency_us;
+    }
+    pipeline->stats.last_complete_us = now_us;
+    slot->state = RKAI_FACE_SLOT_FREE;
+    lock.unlock();
+    pipeline->slot_freed.notify_all();
+    return ret;
+}
+
+extern "C" rkai_ret_t rkai_face_pipeline_get_stats(rkai_face_pipeline_t pipeline, rkai_face_pipeline_stats_t *stats)
+{
+    if (pipeline == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(pipeline->mutex);
+    *stats = pipeline->stats;
+    return RKAI_RET_SUCCESS;
+}
+
 std::vector <rkai_det_t> process_label(rkai_det_array_t *detected_face_array) {
     std::vector <rkai_det_t> detections_per_frame;
     if (detected_face_array == NULL) {
@@ -273,8 +624,9 @@ std::vector <rkai_det_t> process_label(rkai_det_array_t *detected_face_array) {
 
 // }
 
-rkai_ret_t rkai_sort_tracking_cplusplus_wrapper(rkai_det_array_t *detections,rkai_det_array_t *out_track, bool enable_autotrack, int track_frame, bool flush_all_id)
+rkai_ret_t rkai_sort_tracking_cplusplus_wrapper(rkai_face_tracker_t &rkai_tracker_detect, rkai_det_array_t *detections,rkai_det_array_t *out_track, bool enable_autotrack, int track_frame, bool flush_all_id)
 {
+    (void) enable_autotrack;
     const std::vector<rkai_det_t> box_per_frame = process_label(detections);
     std::vector <BaseSTrack<rkai_det_t>> tracks;
     // Check if the tracks need to be flushed
@@ -305,14 +657,27 @@ extern "C" rkai_ret_t rkai_object_autotrack(rkai_handle_t handle, rkai_image_t *
                                 int time_out, rkai_det_array_t *in_track_object, \
                                 rkai_det_array_t *out_track_object, bool enable_autotrack, int track_frame, bool flush_all_id)
 {
+    (void) image;
     (void) time_out;
-    rkai_ret_t rkai_ret_code = RKAI_RET_SUCCESS;
-    return rkai_sort_tracking_cplusplus_wrapper(in_track_object, out_track_object, enable_autotrack, track_frame, flush_all_id);
+    if (handle == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    // Each handle tracks its own stream
+    if (handle->session_data == NULL) {
+        handle->session_data = new rkai_face_tracker_t();
+        handle->release_session_data = release_face_tracker;
+    }
+    rkai_face_tracker_t *tracker = (rkai_face_tracker_t *) handle->session_data;
+    return rkai_sort_tracking_cplusplus_wrapper(*tracker, in_track_object, out_track_object, enable_autotrack, track_frame, flush_all_id);
 }
 
-rkai_ret_t rkai_required_detect_size(rkai_size_t *required_size)
+rkai_ret_t rkai_required_detect_size(rkai_handle_t handle, rkai_size_t *required_size)
 {
-    *required_size = required_detect_size;
+    rkai_face_detect_data_t *data = get_face_detect_data(handle);
+    if (data == NULL || required_size == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *required_size = data->required_detect_size;
     return RKAI_RET_SUCCESS;
 }
 
@@ -0,0 +1,149 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "utils/util.h"
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_handle_pool.h"
+
+struct _rkai_handle_pool_t {
+    std::mutex mutex;
+    std::condition_variable handle_available;
+    std::vector<rkai_handle_t> handles;     // All handles owned by the pool, index 0 is the original handle
+    std::vector<rkai_handle_t> free_handles;
+    rkai_handle_pool_stats_t stats;
+};
+
+extern "C" rkai_handle_pool_t rkai_create_handle_pool(rkai_handle_t handle, int pool_size) {
+    if (handle == NULL || pool_size < 1) {
+        LOG_ERROR("Invalid handle or pool size %d \n", pool_size);
+        return NULL;
+    }
+
+    rkai_handle_pool_t pool = new _rkai_handle_pool_t();
+    memset(&pool->stats, 0, sizeof(rkai_handle_pool_stats_t));
+    pool->handles.push_back(handle);
+    for (int i = 1; i < pool_size; ++i) {
+        rkai_handle_t duplicated = rkai_duplicate_handle(handle);
+        if (duplicated == NULL) {
+            // Keep the original handle alive, the caller still owns it on failure
+            LOG_ERROR("Cannot create handle %d of the pool \n", i);
+            for (size_t j = 1; j < pool->handles.size(); ++j) {
+                rkai_release_handle(pool->handles[j]);
+            }
+            delete pool;
+            return NULL;
+        }
+        pool->handles.push_back(duplicated);
+    }
+    pool->free_handles = pool->handles;
+    pool->stats.pool_size = pool_size;
+    return pool;
+}
+
+extern "C" rkai_ret_t rkai_release_handle_pool(rkai_handle_pool_t pool) {
+    if (pool == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (pool->stats.in_use != 0) {
+            LOG_ERROR("Cannot release handle pool, %d handles are still in use \n", pool->stats.in_use);
+            return RKAI_RET_COMMON_FAIL;
+        }
+    }
+    // Duplicated handles share the model state of the original one, release them first
+    for (size_t i = pool->handles.size(); i > 0; --i) {
+        rkai_release_handle(pool->handles[i - 1]);
+    }
+    delete pool;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_handle_pool_checkout(rkai_handle_pool_t pool, int timeout_ms, rkai_handle_t *handle) {
+    if (pool == NULL || handle == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    if (pool->free_handles.empty()) {
+        pool->stats.contended_count++;
+        int64_t start_wait = get_current_time_us();
+        auto has_free_handle = [pool] { return !pool->free_handles.empty(); };
+        bool is_available = true;
+        if (timeout_ms < 0) {
+            pool->handle_available.wait(lock, has_free_handle);
+        } else {
+            is_available = pool->handle_available.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                                           has_free_handle);
+        }
+        int64_t wait_us = get_current_time_us() - start_wait;
+        pool->stats.total_wait_us += wait_us;
+        if (wait_us > pool->stats.max_wait_us) {
+            pool->stats.max_wait_us = wait_us;
+        }
+        if (!is_available) {
+            pool->stats.timeout_count++;
+            LOG_WARN("No free handle in pool after %d ms \n", timeout_ms);
+            return RKAI_RET_TIMEOUT;
+        }
+    }
+
+    *handle = pool->free_handles.back();
+    pool->free_handles.pop_back();
+    pool->stats.checkout_count++;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.peak_in_use) {
+        pool->stats.peak_in_use = pool->stats.in_use;
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_handle_pool_checkin(rkai_handle_pool_t pool, rkai_handle_t handle) {
+    if (pool == NULL || handle == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        bool is_owned = false;
+        for (rkai_handle_t owned_handle : pool->handles) {
+            is_owned = is_owned || owned_handle == handle;
+        }
+        for (rkai_handle_t free_handle : pool->free_handles) {
+            if (free_handle == handle) {
+                is_owned = false;
+            }
+        }
+        if (!is_owned) {
+            LOG_ERROR("Handle %p is not checked out from this pool \n", (void *) handle);
+            return RKAI_RET_INVALID_INPUT_PARAM;
+        }
+        pool->free_handles.push_back(handle);
+        pool->stats.in_use--;
+    }
+    pool->handle_available.notify_one();
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_handle_pool_get_stats(rkai_handle_pool_t pool, rkai_handle_pool_stats_t *stats) {
+    if (pool == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    *stats = pool->stats;
+    return RKAI_RET_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <mutex>
+#include "utils/util.h"
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_keyword_spotter.h"
+
+typedef struct rkai_spotter_model_t {
+    rkai_handle_t handle;
+    int front_end;          // Index of the front-end config
+    int first_keyword;
+    int keyword_num;
+} rkai_spotter_model_t;
+
+struct _rkai_keyword_spotter_t {
+    int model_num;
+    rkai_spotter_model_t models[RKAI_SPOTTER_MAX_MODELS];
+    int front_end_num;
+    rkai_melspectrogram_config_t front_ends[RKAI_SPOTTER_MAX_MODELS];
+    int keyword_num;
+    std::mutex stats_mutex;
+    rkai_keyword_spotter_stats_t stats;
+};
+
+extern "C" rkai_keyword_spotter_t rkai_create_keyword_spotter(void)
+{
+    rkai_keyword_spotter_t spotter = new _rkai_keyword_spotter_t();
+    spotter->model_num = 0;
+    spotter->front_end_num = 0;
+    spotter->keyword_num = 0;
+    memset(&spotter->stats, 0, sizeof(rkai_keyword_spotter_stats_t));
+    return spotter;
+}
+
+extern "C" rkai_ret_t rkai_release_keyword_spotter(rkai_keyword_spotter_t spotter)
+{
+    if (spotter == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete spotter;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_keyword_spotter_add_model(rkai_keyword_spotter_t spotter, rkai_handle_t handle,
+                                                     int *first_keyword, int *keyword_num)
+{
+    if (spotter == NULL || handle == NULL || first_keyword == NULL || keyword_num == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (spotter->model_num >= RKAI_SPOTTER_MAX_MODELS) {
+        LOG_ERROR("Keyword spotter already has %d models \n", spotter->model_num);
+        return RKAI_RET_COMMON_FAIL;
+    }
+    rkai_melspectrogram_config_t config;
+    if (rkai_get_trigger_word_config(handle, &config) != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Handle is not an initialized trigger word model \n");
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (handle->output_tensor_attr == NULL || handle->output_tensor_attr[0].n_elems < 2) {
+        LOG_ERROR("Trigger word model needs a background class and at least one keyword \n");
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    int class_num = (int) handle->output_tensor_attr[0].n_elems;
+    if (spotter->keyword_num + class_num - 1 > RKAI_SPOTTER_MAX_KEYWORDS) {
+        LOG_ERROR("Too many keywords, %d are supported \n", RKAI_SPOTTER_MAX_KEYWORDS);
+        return RKAI_RET_COMMON_FAIL;
+    }
+
+    rkai_spotter_model_t *model = &spotter->models[spotter->model_num];
+    model->handle = handle;
+    model->front_end = -1;
+    for (int i = 0; i < spotter->front_end_num; ++i) {
+        if (rkai_audio_is_same_front_end(&spotter->front_ends[i], &config)) {
+            model->front_end = i;
+            break;
+        }
+    }
+    if (model->front_end < 0) {
+        model->front_end = spotter->front_end_num;
+        spotter->front_ends[spotter->front_end_num++] = config;
+    }
+    model->first_keyword = spotter->keyword_num;
+    model->keyword_num = class_num - 1;
+    spotter->keyword_num += model->keyword_num;
+    spotter->model_num++;
+    *first_keyword = model->first_keyword;
+    *keyword_num = model->keyword_num;
+
+    std::lock_guard<std::mutex> lock(spotter->stats_mutex);
+    spotter->stats.model_num = spotter->model_num;
+    spotter->stats.front_end_num = spotter->front_end_num;
+    spotter->stats.keyword_num = spotter->keyword_num;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_keyword_spotter_detect(rkai_keyword_spotter_t spotter, rkai_audio_t *audio,
+                                                  rkai_keyword_scores_t *scores)
+{
+    if (spotter == NULL || audio == NULL || scores == NULL || spotter->model_num == 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    memset(scores, 0, sizeof(rkai_keyword_scores_t));
+    scores->keyword_num = spotter->keyword_num;
+
+    rkai_ret_t ret = RKAI_RET_SUCCESS;
+    int64_t front_end_us = 0;
+    int64_t inference_us = 0;
+    for (int f = 0; f < spotter->front_end_num && ret == RKAI_RET_SUCCESS; ++f) {
+        int64_t start_us = get_current_time_us();
+        rkai_melspectrogram_t melspectrogram;
+        ret = rkai_audio_to_melspectrogram(audio, &melspectrogram, spotter->front_ends[f]);
+        int64_t end_us = get_current_time_us();
+        front_end_us += end_us - start_us;
+        if (ret != RKAI_RET_SUCCESS) {
+            LOG_ERROR("Cannot convert audio to melspectrogram for front-end %d \n", f);
+            rkai_audio_melspectrogram_release(&melspectrogram);
+            break;
+        }
+        for (int m = 0; m < spotter->model_num; ++m) {
+            rkai_spotter_model_t *model = &spotter->models[m];
+            if (model->front_end != f) {
+                continue;
+            }
+            float class_scores[RKAI_SPOTTER_MAX_KEYWORDS + 1];
+            int class_num = 0;
+            ret = rkai_trigger_word_infer(model->handle, &melspectrogram, class_scores, model->keyword_num + 1,
+                                          &class_num);
+            if (ret != RKAI_RET_SUCCESS) {
+                LOG_ERROR("Cannot run keyword model %d \n", m);
+                break;
+            }
+            // Skip the background class
+            for (int k = 1; k < class_num; ++k) {
+                scores->scores[model->first_keyword + k - 1] = class_scores[k];
+            }
+        }
+        inference_us += get_current_time_us() - end_us;
+        rkai_audio_melspectrogram_release(&melspectrogram);
+    }
+
+    std::lock_guard<std::mutex> lock(spotter->stats_mutex);
+    spotter->stats.window_count++;
+    spotter->stats.total_front_end_us += front_end_us;
+    spotter->stats.total_inference_us += inference_us;
+    return ret;
+}
+
+extern "C" rkai_ret_t rkai_keyword_spotter_get_stats(rkai_keyword_spotter_t spotter,
+                                                     rkai_keyword_spotter_stats_t *stats)
+{
+    if (spotter == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(spotter->stats_mutex);
+    *stats = spotter->stats;
+    return RKAI_RET_SUCCESS;
+}
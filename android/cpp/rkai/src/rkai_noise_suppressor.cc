@@ -0,0 +1,221 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_noise_suppressor.h"
+
+// Power of a digital silence bin, keeps the ratios and log10 finite
+#define NS_MIN_POWER 1e-12f
+// A bin under this many times its noise estimate is taken as noise and averaged in
+#define NS_NOISE_THRESHOLD 4.0f
+
+struct _rkai_noise_suppressor_t {
+    rkai_noise_suppressor_config_t config;
+    int bin_num;
+    float noise_smoothing;      // Weight of a new frame in the noise average
+    float noise_rise;           // Factor per frame of the noise estimate of a bin far above it
+    float gain_floor;           // Amplitude
+    float level_scale;          // Power of the bins summed to mean square of the samples
+    std::vector<float> noise;   // Noise power per bin, 0 before the first frame
+    bool is_noise_known;
+    int64_t learned_position;   // Center of the last frame learned from
+    std::vector<float> clean_power; // Estimated speech power per bin of the previous frame of the window
+    std::mutex stats_mutex;
+    rkai_noise_suppressor_stats_t stats;
+};
+
+static void noise_suppressor_clear(rkai_noise_suppressor_t suppressor)
+{
+    std::fill(suppressor->noise.begin(), suppressor->noise.end(), 0.0f);
+    suppressor->is_noise_known = false;
+    suppressor->learned_position = std::numeric_limits<int64_t>::min();
+}
+
+/**
+ * @brief Follow the power of the bins near the noise estimate, let the estimate rise under the others
+ */
+static void noise_suppressor_learn(rkai_noise_suppressor_t suppressor, const float *power)
+{
+    std::vector<float> &noise = suppressor->noise;
+    if (!suppressor->is_noise_known) {
+        for (int k = 0; k < suppressor->bin_num; ++k) {
+            noise[k] = std::max(power[k], NS_MIN_POWER);
+        }
+        suppressor->is_noise_known = true;
+        return;
+    }
+    for (int k = 0; k < suppressor->bin_num; ++k) {
+        if (power[k] < NS_NOISE_THRESHOLD * noise[k]) {
+            noise[k] += suppressor->noise_smoothing * (power[k] - noise[k]);
+            noise[k] = std::max(noise[k], NS_MIN_POWER);
+        } else {
+            noise[k] *= suppressor->noise_rise;
+        }
+    }
+}
+
+extern "C" rkai_ret_t rkai_noise_suppressor_default_config(const rkai_melspectrogram_config_t *front_end,
+                                                           rkai_noise_suppressor_config_t *config)
+{
+    if (front_end == NULL || config == NULL || front_end->sample_rate <= 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->sample_rate = front_end->sample_rate;
+    config->n_fft = front_end->n_fft;
+    config->win_length = front_end->win_length;
+    config->hop_length = front_end->hop_length;
+    config->gain = RKAI_NOISE_GAIN_WIENER;
+    config->noise_time_constant = 0.5f;
+    config->noise_rise_db = 3.0f;
+    config->prior_smoothing = 0.98f;
+    config->over_subtraction = 2.0f;
+    config->gain_floor_db = -12.0f;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_noise_suppressor_t rkai_create_noise_suppressor(const rkai_noise_suppressor_config_t *config)
+{
+    if (config == NULL || config->sample_rate <= 0 || config->n_fft < 2 || config->win_length <= 0 ||
+        config->win_length > config->n_fft || config->hop_length <= 0 || config->gain < 0 ||
+        config->gain >= RKAI_NOISE_GAIN_NUM || config->noise_time_constant <= 0 || config->noise_rise_db < 0 ||
+        config->prior_smoothing < 0 || config->prior_smoothing >= 1 || config->over_subtraction <= 0 ||
+        config->gain_floor_db > 0) {
+        LOG_ERROR("Invalid noise suppressor config \n");
+        return NULL;
+    }
+    rkai_noise_suppressor_t suppressor = new _rkai_noise_suppressor_t();
+    suppressor->config = *config;
+    suppressor->bin_num = config->n_fft / 2 + 1;
+    float hop_seconds = (float) config->hop_length / config->sample_rate;
+    suppressor->noise_smoothing = 1.0f - expf(-hop_seconds / config->noise_time_constant);
+    suppressor->noise_rise = powf(10.0f, config->noise_rise_db * hop_seconds / 10);
+    suppressor->gain_floor = powf(10.0f, config->gain_floor_db / 20);
+    // Parseval over the half spectrum, with the power of the Hann window of the frames
+    double window_power = 0;
+    for (int i = 0; i < config->win_length; ++i) {
+        double window = 0.5 - 0.5 * cos(2 * M_PI * i / config->win_length);
+        window_power += window * window;
+    }
+    suppressor->level_scale = (float) (2.0 / (config->n_fft * std::max(window_power, 1e-6)));
+    suppressor->noise.resize(suppressor->bin_num);
+    suppressor->clean_power.resize(suppressor->bin_num);
+    noise_suppressor_clear(suppressor);
+    memset(&suppressor->stats, 0, sizeof(rkai_noise_suppressor_stats_t));
+    suppressor->stats.noise_level_db = -120.0f;
+    return suppressor;
+}
+
+extern "C" rkai_ret_t rkai_release_noise_suppressor(rkai_noise_suppressor_t suppressor)
+{
+    if (suppressor == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete suppressor;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_noise_suppressor_process(rkai_noise_suppressor_t suppressor, int64_t position,
+                                                    const float *power, int frame_num, int bin_num, float *gains)
+{
+    if (suppressor == NULL || power == NULL || gains == NULL || frame_num < 0 ||
+        bin_num != suppressor->bin_num) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    const rkai_noise_suppressor_config_t &config = suppressor->config;
+    std::vector<float> &noise = suppressor->noise;
+    std::vector<float> &clean_power = suppressor->clean_power;
+    float prior_smoothing = config.prior_smoothing;
+    float floor_power = suppressor->gain_floor * suppressor->gain_floor;
+    uint64_t update_count = 0;
+    double input_sum = 0;
+    double output_sum = 0;
+    for (int t = 0; t < frame_num; ++t) {
+        const float *frame_power = power + (int64_t) t * bin_num;
+        float *frame_gains = gains + (int64_t) t * bin_num;
+        int64_t center = position + (int64_t) t * config.hop_length;
+        if (center > suppressor->learned_position) {
+            noise_suppressor_learn(suppressor, frame_power);
+            suppressor->learned_position = center;
+            update_count++;
+        }
+        for (int k = 0; k < bin_num; ++k) {
+            // Read before the gain is written, it can be the power
+            float bin_power = frame_power[k];
+            float posterior_snr = bin_power / noise[k];
+            float gain_power;
+            if (config.gain == RKAI_NOISE_GAIN_WIENER) {
+                // The first frame of the window has no previous estimate, its own SNR is taken
+                float instant_snr = std::max(posterior_snr - 1.0f, 0.0f);
+                float prior_snr = t == 0 ? instant_snr : prior_smoothing * clean_power[k] / noise[k] +
+                                                         (1.0f - prior_smoothing) * instant_snr;
+                float gain = prior_snr / (1.0f + prior_snr);
+                gain_power = gain * gain;
+            } else {
+                gain_power = 1.0f - config.over_subtraction / std::max(posterior_snr, NS_MIN_POWER);
+            }
+            gain_power = std::max(gain_power, floor_power);
+            clean_power[k] = gain_power * bin_power;
+            frame_gains[k] = sqrtf(gain_power);
+            input_sum += bin_power;
+            output_sum += clean_power[k];
+        }
+    }
+
+    float noise_sum = 0;
+    for (int k = 0; k < bin_num; ++k) {
+        noise_sum += noise[k];
+    }
+    std::lock_guard<std::mutex> lock(suppressor->stats_mutex);
+    suppressor->stats.frame_count += frame_num;
+    suppressor->stats.update_count += update_count;
+    if (suppressor->is_noise_known) {
+        suppressor->stats.noise_level_db = 10.0f * log10f(std::max(noise_sum * suppressor->level_scale,
+                                                                   NS_MIN_POWER));
+    }
+    if (frame_num > 0) {
+        suppressor->stats.reduction_db = (float) (10.0 * log10(std::max(input_sum, (double) NS_MIN_POWER) /
+                                                               std::max(output_sum, (double) NS_MIN_POWER)));
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_noise_suppressor_reset(rkai_noise_suppressor_t suppressor)
+{
+    if (suppressor == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    noise_suppressor_clear(suppressor);
+    std::lock_guard<std::mutex> lock(suppressor->stats_mutex);
+    suppressor->stats.noise_level_db = -120.0f;
+    suppressor->stats.reduction_db = 0;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_noise_suppressor_get_stats(rkai_noise_suppressor_t suppressor,
+                                                      rkai_noise_suppressor_stats_t *stats)
+{
+    if (suppressor == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(suppressor->stats_mutex);
+    *stats = suppressor->stats;
+    stats->config = suppressor->config;
+    return RKAI_RET_SUCCESS;
+}
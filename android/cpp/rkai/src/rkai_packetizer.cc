@@ -0,0 +1,231 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_packetizer.h"
+
+struct _rkai_packetizer_t {
+    rkai_packetizer_config_t config;
+    // Producer side, only used by the vad thread
+    int is_open;                // A segment is open
+    int is_first;               // No packet of the open segment was produced yet
+    uint32_t segment_id;        // Id of the open segment, or of the last one
+    int64_t cursor;             // Next sample to produce
+    int64_t segment_end;        // End sample of the open segment, -1 until its end event
+    uint32_t next_sequence;
+    // Queue of packets, config.queue_capacity slots
+    std::mutex mutex;
+    std::condition_variable condition;
+    rkai_audio_packet_t *queue;
+    int queue_start;
+    int queue_count;
+    rkai_packetizer_stats_t stats;
+};
+
+/**
+ * @brief Number the packet and queue it, or drop it if the queue is full
+ */
+static void packetizer_emit(rkai_packetizer_t packetizer, int64_t start_sample, const float *audio, int sample_num,
+                            int flags)
+{
+    std::lock_guard<std::mutex> lock(packetizer->mutex);
+    uint32_t sequence = packetizer->next_sequence++;
+    packetizer->stats.packet_count++;
+    if (packetizer->queue_count == packetizer->config.queue_capacity) {
+        // The consumer is behind, the gap shows in the sequence numbers
+        packetizer->stats.dropped_count++;
+        return;
+    }
+    int slot = (packetizer->queue_start + packetizer->queue_count) % packetizer->config.queue_capacity;
+    rkai_audio_packet_t *packet = &packetizer->queue[slot];
+    packet->sequence = sequence;
+    packet->segment_id = packetizer->segment_id;
+    packet->flags = flags;
+    packet->start_sample = start_sample;
+    packet->sample_num = sample_num;
+    if (sample_num > 0) {
+        memcpy(packet->samples, audio, sizeof(float) * sample_num);
+    }
+    packetizer->queue_count++;
+    packetizer->condition.notify_one();
+}
+
+extern "C" rkai_ret_t rkai_packetizer_default_config(int sample_rate, rkai_packetizer_config_t *config)
+{
+    if (sample_rate <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->sample_rate = sample_rate;
+    config->packet_size = sample_rate / 50;
+    config->queue_capacity = 100;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_packetizer_t rkai_create_packetizer(const rkai_packetizer_config_t *config)
+{
+    if (config == NULL || config->packet_size <= 0 || config->packet_size > RKAI_PACKET_MAX_SAMPLES ||
+        config->queue_capacity <= 0) {
+        LOG_ERROR("Invalid packetizer config \n");
+        return NULL;
+    }
+    rkai_packetizer_t packetizer = new _rkai_packetizer_t();
+    packetizer->config = *config;
+    packetizer->queue = new rkai_audio_packet_t[config->queue_capacity];
+    packetizer->segment_id = 0;
+    packetizer->next_sequence = 0;
+    memset(&packetizer->stats, 0, sizeof(rkai_packetizer_stats_t));
+    rkai_packetizer_reset(packetizer);
+    return packetizer;
+}
+
+extern "C" rkai_ret_t rkai_release_packetizer(rkai_packetizer_t packetizer)
+{
+    if (packetizer == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete[] packetizer->queue;
+    delete packetizer;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_packetizer_on_event(rkai_packetizer_t packetizer, const rkai_vad_segment_event_t *event)
+{
+    if (packetizer == NULL || event == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (event->type == RKAI_VAD_SEGMENT_START) {
+        if (packetizer->is_open) {
+            LOG_WARN("Vad segment %u started before the end of the previous one \n", packetizer->segment_id + 1);
+        }
+        packetizer->is_open = 1;
+        packetizer->is_first = 1;
+        packetizer->segment_id++;
+        // From the segment start even if the hangover of the previous segment already went past it
+        packetizer->cursor = event->start_sample;
+        packetizer->segment_end = -1;
+        std::lock_guard<std::mutex> lock(packetizer->mutex);
+        packetizer->stats.segment_count++;
+        return RKAI_RET_SUCCESS;
+    }
+    if (!packetizer->is_open) {
+        return RKAI_RET_SUCCESS;
+    }
+    packetizer->segment_end = event->end_sample;
+    if (packetizer->cursor >= packetizer->segment_end) {
+        // The audio up to the end was already sent, the end marker goes alone and gives the end
+        packetizer->is_open = 0;
+        packetizer_emit(packetizer, packetizer->segment_end, NULL, 0, RKAI_PACKET_SEGMENT_END |
+                                             (packetizer->is_first ? RKAI_PACKET_SEGMENT_START : 0));
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_packetizer_get_cursor(rkai_packetizer_t packetizer, int64_t *next_sample)
+{
+    if (packetizer == NULL || next_sample == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *next_sample = packetizer->is_open ? packetizer->cursor : -1;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_packetizer_produce(rkai_packetizer_t packetizer, const float *audio, int64_t first_sample,
+                                              int sample_num, int *packet_num)
+{
+    if (packetizer == NULL || audio == NULL || sample_num < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    int produced = 0;
+    if (packetizer->is_open && first_sample > packetizer->cursor) {
+        // Audio the recording no longer holds
+        std::lock_guard<std::mutex> lock(packetizer->mutex);
+        packetizer->stats.skipped_samples += first_sample - packetizer->cursor;
+        packetizer->cursor = first_sample;
+    }
+    int64_t span_end = first_sample + sample_num;
+    int packet_size = packetizer->config.packet_size;
+    while (packetizer->is_open) {
+        int64_t end = packetizer->cursor + packet_size;
+        int is_last = packetizer->segment_end >= 0 && packetizer->segment_end <= end;
+        if (is_last) {
+            end = packetizer->segment_end;
+        }
+        if (end > span_end) {
+            break;
+        }
+        int flags = (packetizer->is_first ? RKAI_PACKET_SEGMENT_START : 0) | (is_last ? RKAI_PACKET_SEGMENT_END : 0);
+        packetizer_emit(packetizer, packetizer->cursor, audio + (packetizer->cursor - first_sample),
+                        (int) (end - packetizer->cursor), flags);
+        produced++;
+        packetizer->is_first = 0;
+        packetizer->cursor = end;
+        if (is_last) {
+            packetizer->is_open = 0;
+        }
+    }
+    if (packet_num != NULL) {
+        *packet_num = produced;
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_packetizer_poll(rkai_packetizer_t packetizer, rkai_audio_packet_t *packet, int timeout_ms,
+                                           int *has_packet)
+{
+    if (packetizer == NULL || packet == NULL || has_packet == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::unique_lock<std::mutex> lock(packetizer->mutex);
+    *has_packet = packetizer->condition.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                                 [packetizer] { return packetizer->queue_count > 0; });
+    if (!*has_packet) {
+        return RKAI_RET_SUCCESS;
+    }
+    const rkai_audio_packet_t *oldest = &packetizer->queue[packetizer->queue_start];
+    // Header then the samples used, not the whole packet
+    memcpy(packet, oldest, offsetof(rkai_audio_packet_t, samples));
+    memcpy(packet->samples, oldest->samples, sizeof(float) * oldest->sample_num);
+    packetizer->queue_start = (packetizer->queue_start + 1) % packetizer->config.queue_capacity;
+    packetizer->queue_count--;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_packetizer_reset(rkai_packetizer_t packetizer)
+{
+    if (packetizer == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    packetizer->is_open = 0;
+    packetizer->is_first = 0;
+    packetizer->cursor = 0;
+    packetizer->segment_end = -1;
+    std::lock_guard<std::mutex> lock(packetizer->mutex);
+    packetizer->queue_start = 0;
+    packetizer->queue_count = 0;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_packetizer_get_stats(rkai_packetizer_t packetizer, rkai_packetizer_stats_t *stats)
+{
+    if (packetizer == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(packetizer->mutex);
+    *stats = packetizer->stats;
+    return RKAI_RET_SUCCESS;
+}
@@ -0,0 +1,224 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_pcm.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define PCM16_SCALE 32767.0f
+// Four interleaved xorshift32 generators, sample i draws from generator i % 4 so that every path gives the same bytes
+#define PCM16_DITHER_LANES 4
+
+static void put_le16(uint8_t *out, int value)
+{
+    out[0] = (uint8_t) (value & 0xff);
+    out[1] = (uint8_t) ((value >> 8) & 0xff);
+}
+
+static void put_le32(uint8_t *out, uint32_t value)
+{
+    put_le16(out, (int) (value & 0xffff));
+    put_le16(out + 2, (int) (value >> 16));
+}
+
+static void dither_seed_lanes(uint32_t seed, uint32_t *lanes)
+{
+    for (int i = 0; i < PCM16_DITHER_LANES; ++i) {
+        // xorshift32 never leaves 0
+        lanes[i] = (seed + 0x9e3779b9u * (uint32_t) (i + 1)) | 1u;
+    }
+}
+
+static uint32_t xorshift32(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Sum of the two 16 bit halves of a draw, triangular in (-1, 1) LSB
+static float tpdf_noise(uint32_t x)
+{
+    return (float) ((int) (x & 0xffff) + (int) (x >> 16) - 65535) * (1.0f / 65536.0f);
+}
+
+static int16_t quantize(float sample, float noise)
+{
+    float scaled = sample * PCM16_SCALE;
+    scaled = scaled + noise;
+    scaled = scaled > PCM16_SCALE ? PCM16_SCALE : scaled;
+    scaled = scaled < -PCM16_SCALE - 1 ? -PCM16_SCALE - 1 : scaled;
+    // Round half to even, as the vector conversions do
+    return (int16_t) lrintf(scaled);
+}
+
+/**
+ * @brief Scalar conversion from sample start, lanes is the dither state of the generator of sample start
+ */
+static void encode_scalar(const float *samples, int start, int sample_num, int dither, uint32_t *lanes,
+                          uint8_t *out)
+{
+    for (int i = start; i < sample_num; ++i) {
+        float noise = 0;
+        if (dither) {
+            uint32_t *lane = &lanes[i % PCM16_DITHER_LANES];
+            *lane = xorshift32(*lane);
+            noise = tpdf_noise(*lane);
+        }
+        put_le16(out + 2 * i, quantize(samples[i], noise));
+    }
+}
+
+#if defined(__aarch64__)
+static int encode_simd(const float *samples, int sample_num, int dither, uint32_t *lanes, uint8_t *out)
+{
+    const float32x4_t scale = vdupq_n_f32(PCM16_SCALE);
+    const float32x4_t max_value = vdupq_n_f32(PCM16_SCALE);
+    const float32x4_t min_value = vdupq_n_f32(-PCM16_SCALE - 1);
+    const float32x4_t noise_scale = vdupq_n_f32(1.0f / 65536.0f);
+    const int32x4_t noise_offset = vdupq_n_s32(65535);
+    const uint32x4_t low_mask = vdupq_n_u32(0xffff);
+    uint32x4_t state = vld1q_u32(lanes);
+    int i = 0;
+    for (; i + 8 <= sample_num; i += 8) {
+        float32x4_t scaled[2];
+        for (int half = 0; half < 2; ++half) {
+            scaled[half] = vmulq_f32(vld1q_f32(samples + i + 4 * half), scale);
+            if (dither) {
+                state = veorq_u32(state, vshlq_n_u32(state, 13));
+                state = veorq_u32(state, vshrq_n_u32(state, 17));
+                state = veorq_u32(state, vshlq_n_u32(state, 5));
+                int32x4_t sum = vaddq_s32(vreinterpretq_s32_u32(vandq_u32(state, low_mask)),
+                                          vreinterpretq_s32_u32(vshrq_n_u32(state, 16)));
+                float32x4_t noise = vmulq_f32(vcvtq_f32_s32(vsubq_s32(sum, noise_offset)), noise_scale);
+                scaled[half] = vaddq_f32(scaled[half], noise);
+            }
+            scaled[half] = vmaxq_f32(vminq_f32(scaled[half], max_value), min_value);
+        }
+        int16x8_t pcm = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(scaled[0])), vqmovn_s32(vcvtnq_s32_f32(scaled[1])));
+        // arm64 Android is little-endian, the lanes are stored as they are
+        vst1q_s16((int16_t *) (out + 2 * i), pcm);
+    }
+    vst1q_u32(lanes, state);
+    return i;
+}
+#elif defined(__SSE2__)
+static int encode_simd(const float *samples, int sample_num, int dither, uint32_t *lanes, uint8_t *out)
+{
+    const __m128 scale = _mm_set1_ps(PCM16_SCALE);
+    const __m128 max_value = _mm_set1_ps(PCM16_SCALE);
+    const __m128 min_value = _mm_set1_ps(-PCM16_SCALE - 1);
+    const __m128 noise_scale = _mm_set1_ps(1.0f / 65536.0f);
+    const __m128i noise_offset = _mm_set1_epi32(65535);
+    const __m128i low_mask = _mm_set1_epi32(0xffff);
+    __m128i state = _mm_loadu_si128((const __m128i *) lanes);
+    int i = 0;
+    for (; i + 8 <= sample_num; i += 8) {
+        __m128 scaled[2];
+        for (int half = 0; half < 2; ++half) {
+            scaled[half] = _mm_mul_ps(_mm_loadu_ps(samples + i + 4 * half), scale);
+            if (dither) {
+                state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+                state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+                state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+                __m128i sum = _mm_add_epi32(_mm_and_si128(state, low_mask), _mm_srli_epi32(state, 16));
+                __m128 noise = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(sum, noise_offset)), noise_scale);
+                scaled[half] = _mm_add_ps(scaled[half], noise);
+            }
+            scaled[half] = _mm_max_ps(_mm_min_ps(scaled[half], max_value), min_value);
+        }
+        __m128i pcm = _mm_packs_epi32(_mm_cvtps_epi32(scaled[0]), _mm_cvtps_epi32(scaled[1]));
+        _mm_storeu_si128((__m128i *) (out + 2 * i), pcm);
+    }
+    _mm_storeu_si128((__m128i *) lanes, state);
+    return i;
+}
+#else
+static int encode_simd(const float *, int, int, uint32_t *, uint8_t *)
+{
+    return 0;
+}
+#endif
+
+extern "C" rkai_ret_t rkai_pcm16_default_config(int sample_rate, rkai_pcm16_config_t *config)
+{
+    if (sample_rate <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->sample_rate = sample_rate;
+    config->n_channels = 1;
+    config->dither = 0;
+    config->dither_seed = 1;
+    config->wav_header = 0;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" int rkai_pcm16_encoded_size(const rkai_pcm16_config_t *config, int sample_num)
+{
+    return (config != NULL && config->wav_header ? RKAI_WAV_HEADER_SIZE : 0) + 2 * sample_num;
+}
+
+extern "C" rkai_ret_t rkai_wav_write_header(int sample_rate, int n_channels, int sample_num, uint8_t *out)
+{
+    if (sample_rate <= 0 || n_channels <= 0 || sample_num < 0 || out == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    uint32_t data_size = (uint32_t) sample_num * 2;
+    memcpy(out, "RIFF", 4);
+    put_le32(out + 4, 36 + data_size);
+    memcpy(out + 8, "WAVE", 4);
+    memcpy(out + 12, "fmt ", 4);
+    put_le32(out + 16, 16);                                     // fmt chunk size
+    put_le16(out + 20, 1);                                      // PCM
+    put_le16(out + 22, n_channels);
+    put_le32(out + 24, (uint32_t) sample_rate);
+    put_le32(out + 28, (uint32_t) sample_rate * n_channels * 2); // byte rate
+    put_le16(out + 32, n_channels * 2);                         // block align
+    put_le16(out + 34, 16);                                     // bits per sample
+    memcpy(out + 36, "data", 4);
+    put_le32(out + 40, data_size);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_pcm16_encode(const rkai_pcm16_config_t *config, const float *samples, int sample_num,
+                                        uint8_t *out, int out_size, int *written)
+{
+    if (config == NULL || samples == NULL || sample_num < 0 || out == NULL || written == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *written = 0;
+    int size = rkai_pcm16_encoded_size(config, sample_num);
+    if (out_size < size) {
+        LOG_ERROR("PCM16 output of %d bytes is too small for %d samples \n", out_size, sample_num);
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (config->wav_header) {
+        rkai_wav_write_header(config->sample_rate, config->n_channels, sample_num, out);
+        out += RKAI_WAV_HEADER_SIZE;
+    }
+    uint32_t lanes[PCM16_DITHER_LANES];
+    dither_seed_lanes(config->dither_seed, lanes);
+    // The vector loop takes whole blocks of 8, each lane of the state stays the generator of its samples
+    int done = encode_simd(samples, sample_num, config->dither, lanes, out);
+    encode_scalar(samples, done, sample_num, config->dither, lanes, out);
+    *written = size;
+    return RKAI_RET_SUCCESS;
+}
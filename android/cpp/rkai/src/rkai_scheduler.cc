@@ -0,0 +1,215 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "utils/util.h"
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_scheduler.h"
+
+/**
+ * @brief A job waiting for a free NPU core. It lives on the stack of the calling thread
+ */
+typedef struct rkai_scheduler_job_t {
+    int priority_class;
+    int core_mask;
+    int64_t submit_us;
+    int64_t deadline_us;
+    uint64_t sequence;
+} rkai_scheduler_job_t;
+
+struct _rkai_scheduler_t {
+    std::mutex mutex;
+    std::condition_variable core_released;
+    int core_num;
+    int busy_core_mask;
+    uint64_t next_sequence;
+    std::vector<rkai_scheduler_job_t *> waiting_jobs;
+    rkai_scheduler_stats_t stats;
+};
+
+/**
+ * @brief Order of service: priority class, then earliest deadline, then submission order
+ */
+static bool is_served_before(const rkai_scheduler_job_t *a, const rkai_scheduler_job_t *b)
+{
+    if (a->priority_class != b->priority_class) {
+        return a->priority_class < b->priority_class;
+    }
+    if (a->deadline_us != b->deadline_us) {
+        return a->deadline_us < b->deadline_us;
+    }
+    return a->sequence < b->sequence;
+}
+
+/**
+ * @brief Cores @p job would run on out of @p free_core_mask: all the cores of a bound job, the first free one of
+ *        the others. 0 if they are not all free
+ */
+static int take_cores(const rkai_scheduler_job_t *job, int free_core_mask)
+{
+    if (job->core_mask != RKNN_NPU_CORE_AUTO) {
+        return (free_core_mask & job->core_mask) == job->core_mask ? job->core_mask : 0;
+    }
+    return free_core_mask & -free_core_mask;
+}
+
+/**
+ * @brief Cores @p job can start on now, 0 if it has to wait. The jobs served before it keep the cores they need
+ *        even when they cannot start yet
+ */
+static int find_cores(rkai_scheduler_t scheduler, const rkai_scheduler_job_t *job)
+{
+    int all_core_mask = (1 << scheduler->core_num) - 1;
+    int free_core_mask = all_core_mask & ~scheduler->busy_core_mask;
+    for (const rkai_scheduler_job_t *other : scheduler->waiting_jobs) {
+        if (other == job || !is_served_before(other, job)) {
+            continue;
+        }
+        int other_cores = take_cores(other, free_core_mask);
+        if (other_cores == 0) {
+            // Keep the cores of a bound job, or every core for a job that takes any
+            other_cores = other->core_mask != RKNN_NPU_CORE_AUTO ? other->core_mask : all_core_mask;
+        }
+        free_core_mask &= ~other_cores;
+    }
+    return take_cores(job, free_core_mask);
+}
+
+extern "C" rkai_scheduler_t rkai_create_scheduler(int core_num) {
+    if (core_num < 1 || core_num > RKAI_MAX_NPU_CORE_NUM) {
+        LOG_ERROR("Invalid number of NPU cores %d \n", core_num);
+        return NULL;
+    }
+    rkai_scheduler_t scheduler = new _rkai_scheduler_t();
+    scheduler->core_num = core_num;
+    scheduler->busy_core_mask = 0;
+    scheduler->next_sequence = 0;
+    memset(&scheduler->stats, 0, sizeof(rkai_scheduler_stats_t));
+    return scheduler;
+}
+
+extern "C" rkai_ret_t rkai_release_scheduler(rkai_scheduler_t scheduler) {
+    if (scheduler == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        if (!scheduler->waiting_jobs.empty()) {
+            LOG_ERROR("Cannot release scheduler, %d jobs are waiting \n", (int) scheduler->waiting_jobs.size());
+            return RKAI_RET_COMMON_FAIL;
+        }
+    }
+    delete scheduler;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_scheduler_attach(rkai_scheduler_t scheduler, rkai_handle_t handle,
+                                            rkai_priority_class_t priority_class, int deadline_ms, int core_mask) {
+    if (handle == NULL || priority_class < 0 || priority_class >= RKAI_PRIORITY_CLASS_NUM || deadline_ms < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (scheduler != NULL && (core_mask < RKNN_NPU_CORE_AUTO || (core_mask >> scheduler->core_num) != 0)) {
+        LOG_ERROR("Core mask %d is out of the %d cores of the scheduler \n", core_mask, scheduler->core_num);
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (core_mask != RKNN_NPU_CORE_AUTO) {
+        rkai_ret_t ret = rkai_set_core_mask(handle, core_mask);
+        if (ret != RKAI_RET_SUCCESS) {
+            return ret;
+        }
+    }
+    handle->scheduler = scheduler;
+    handle->priority_class = priority_class;
+    handle->deadline_us = (int64_t) deadline_ms * 1000;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_scheduler_get_stats(rkai_scheduler_t scheduler, rkai_scheduler_stats_t *stats) {
+    if (scheduler == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+    *stats = scheduler->stats;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" int model_run(rkai_handle_t handle) {
+    rkai_scheduler_t scheduler = handle->scheduler;
+    if (scheduler == NULL) {
+        return rknn_run(handle->context, NULL);
+    }
+
+    rkai_scheduler_job_t job;
+    job.priority_class = handle->priority_class;
+    job.core_mask = handle->core_mask;
+    job.submit_us = get_current_time_us();
+    job.deadline_us = job.submit_us + handle->deadline_us;
+
+    // Wait until the cores of the job are free and no job served before it needs them
+    std::unique_lock<std::mutex> lock(scheduler->mutex);
+    job.sequence = scheduler->next_sequence++;
+    scheduler->waiting_jobs.push_back(&job);
+    int cores = 0;
+    scheduler->core_released.wait(lock, [scheduler, &job, &cores] {
+        cores = find_cores(scheduler, &job);
+        return cores != 0;
+    });
+    scheduler->waiting_jobs.erase(std::find(scheduler->waiting_jobs.begin(), scheduler->waiting_jobs.end(), &job));
+    scheduler->busy_core_mask |= cores;
+    bool has_free_core = scheduler->busy_core_mask != (1 << scheduler->core_num) - 1 &&
+                         !scheduler->waiting_jobs.empty();
+    lock.unlock();
+    if (has_free_core) {
+        // Let the next job take a remaining core
+        scheduler->core_released.notify_all();
+    }
+
+    // A job free to run anywhere is bound to the core it was given, so the driver does not place it on a core
+    // another job is running on. A single core NPU has no core mask
+    if (job.core_mask == RKNN_NPU_CORE_AUTO && scheduler->core_num > 1) {
+        int rknn_ret_code = rknn_set_core_mask(handle->context, (rknn_core_mask) cores);
+        if (rknn_ret_code != RKNN_SUCC) {
+            LOG_WARN("Failed to bind the job to core mask %d, rknn_set_core_mask return code %d\n", cores,
+                     rknn_ret_code);
+        }
+    }
+
+    int64_t start_us = get_current_time_us();
+    int rknn_ret_code = rknn_run(handle->context, NULL);
+    int64_t end_us = get_current_time_us();
+
+    lock.lock();
+    scheduler->busy_core_mask &= ~cores;
+    rkai_scheduler_class_stats_t *class_stats = &scheduler->stats.classes[job.priority_class];
+    int64_t queue_delay_us = start_us - job.submit_us;
+    class_stats->job_count++;
+    class_stats->total_queue_delay_us += queue_delay_us;
+    class_stats->max_queue_delay_us = std::max(class_stats->max_queue_delay_us, queue_delay_us);
+    class_stats->total_run_us += end_us - start_us;
+    if (end_us > job.deadline_us) {
+        class_stats->deadline_miss_count++;
+    }
+    for (int core = 0; core < scheduler->core_num; core++) {
+        if ((cores & (1 << core)) != 0) {
+            scheduler->stats.core_busy_us[core] += end_us - start_us;
+        }
+    }
+    lock.unlock();
+    // Every waiting job re-checks whether its cores are free now
+    scheduler->core_released.notify_all();
+    return rknn_ret_code;
+}
@@ -0,0 +1,369 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_session.h"
+
+#define SESSION_MAGIC "RKSN"
+#define SESSION_VERSION 1
+
+/**
+ * @brief Start of a session file
+ */
+typedef struct session_file_header_t {
+    char magic[4];
+    uint32_t version;
+    int64_t start_time_us;      // Wall clock
+} session_file_header_t;
+
+static_assert(sizeof(session_file_header_t) == 16, "The session file header is read as it is");
+static_assert(sizeof(rkai_chunk_header_t) == 32, "The chunk header is read as it is");
+
+struct _rkai_session_writer_t {
+    rkai_session_config_t config;
+    FILE *file;
+    std::chrono::steady_clock::time_point start;
+    // Chunks are appended to filling while the thread writes the other buffer, both of queue_bytes / 2
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<uint8_t> filling;
+    std::vector<uint8_t> writing;
+    uint64_t filling_chunk_num;
+    int is_stopping;
+    std::thread thread;
+    rkai_session_stats_t stats;
+};
+
+struct _rkai_session_reader_t {
+    FILE *file;
+    int64_t file_size;
+    int64_t position;
+    // Payload of the last chunk header not read yet
+    uint32_t payload_size;
+};
+
+static int64_t session_now_us(rkai_session_writer_t writer)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                 writer->start).count();
+}
+
+static void session_write_thread(rkai_session_writer_t writer)
+{
+    std::unique_lock<std::mutex> lock(writer->mutex);
+    while (true) {
+        writer->condition.wait(lock, [writer] { return !writer->filling.empty() || writer->is_stopping; });
+        if (writer->filling.empty()) {
+            break;
+        }
+        // The producers go on in the other buffer during the write
+        writer->filling.swap(writer->writing);
+        uint64_t chunk_num = writer->filling_chunk_num;
+        writer->filling_chunk_num = 0;
+        lock.unlock();
+        size_t size = writer->writing.size();
+        int is_written = fwrite(writer->writing.data(), 1, size, writer->file) == size;
+        lock.lock();
+        if (is_written) {
+            writer->stats.chunk_count += chunk_num;
+            writer->stats.byte_count += size;
+        } else {
+            LOG_ERROR("Failed to write %zu bytes of session \n", size);
+            writer->stats.dropped_count += chunk_num;
+            writer->stats.dropped_bytes += size - chunk_num * sizeof(rkai_chunk_header_t);
+        }
+        writer->writing.clear();
+    }
+}
+
+/**
+ * @brief Append the header of a chunk to the queue, called with the mutex held. Returns where its payload goes,
+ *        or NULL if the chunk does not fit and was counted as dropped
+ */
+static uint8_t *session_append(rkai_session_writer_t writer, uint32_t type, uint32_t source, int64_t position,
+                               int64_t timestamp_us, int size)
+{
+    size_t chunk_size = sizeof(rkai_chunk_header_t) + size;
+    if (writer->filling.size() + chunk_size > writer->filling.capacity()) {
+        writer->stats.dropped_count++;
+        writer->stats.dropped_bytes += size;
+        return NULL;
+    }
+    rkai_chunk_header_t header;
+    header.type = type;
+    header.source = source;
+    header.timestamp_us = timestamp_us >= 0 ? timestamp_us : session_now_us(writer);
+    header.position = position;
+    header.size = size;
+    header.reserved = 0;
+    size_t offset = writer->filling.size();
+    // Within the capacity reserved at creation, nothing is allocated
+    writer->filling.resize(offset + chunk_size);
+    memcpy(writer->filling.data() + offset, &header, sizeof(rkai_chunk_header_t));
+    writer->filling_chunk_num++;
+    return writer->filling.data() + offset + sizeof(rkai_chunk_header_t);
+}
+
+extern "C" rkai_ret_t rkai_session_default_config(rkai_session_config_t *config)
+{
+    if (config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->queue_bytes = 4 << 20;
+    config->max_image_width = 160;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_session_writer_t rkai_create_session_writer(const char *path, const rkai_session_config_t *config)
+{
+    if (path == NULL || config == NULL || config->queue_bytes < 2 * (int) sizeof(rkai_chunk_header_t) ||
+        config->max_image_width < 0) {
+        LOG_ERROR("Invalid session writer config \n");
+        return NULL;
+    }
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        LOG_ERROR("Cannot create the session %s \n", path);
+        return NULL;
+    }
+    session_file_header_t file_header;
+    memcpy(file_header.magic, SESSION_MAGIC, 4);
+    file_header.version = SESSION_VERSION;
+    file_header.start_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    if (fwrite(&file_header, sizeof(session_file_header_t), 1, file) != 1) {
+        LOG_ERROR("Cannot write the session %s \n", path);
+        fclose(file);
+        return NULL;
+    }
+    rkai_session_writer_t writer = new _rkai_session_writer_t();
+    writer->config = *config;
+    writer->file = file;
+    writer->start = std::chrono::steady_clock::now();
+    writer->filling.reserve(config->queue_bytes / 2);
+    writer->writing.reserve(config->queue_bytes / 2);
+    writer->filling_chunk_num = 0;
+    writer->is_stopping = 0;
+    memset(&writer->stats, 0, sizeof(rkai_session_stats_t));
+    writer->stats.byte_count = sizeof(session_file_header_t);
+    writer->thread = std::thread(session_write_thread, writer);
+    return writer;
+}
+
+extern "C" rkai_ret_t rkai_release_session_writer(rkai_session_writer_t writer)
+{
+    if (writer == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        writer->is_stopping = 1;
+        writer->condition.notify_one();
+    }
+    writer->thread.join();
+    fclose(writer->file);
+    delete writer;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_session_get_time(rkai_session_writer_t writer, int64_t *timestamp_us)
+{
+    if (writer == NULL || timestamp_us == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *timestamp_us = session_now_us(writer);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_session_write(rkai_session_writer_t writer, uint32_t type, uint32_t source,
+                                         int64_t position, int64_t timestamp_us, const void *payload, int size)
+{
+    if (writer == NULL || size < 0 || (payload == NULL && size > 0)) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    uint8_t *out = session_append(writer, type, source, position, timestamp_us, size);
+    if (out == NULL) {
+        return RKAI_RET_COMMON_FAIL;
+    }
+    if (size > 0) {
+        memcpy(out, payload, size);
+    }
+    writer->condition.notify_one();
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_session_write_audio(rkai_session_writer_t writer, uint32_t source, int64_t first_sample,
+                                               const float *samples, int sample_num)
+{
+    if (sample_num < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    return rkai_session_write(writer, RKAI_CHUNK_AUDIO, source, first_sample, -1, samples,
+                              (int) (sizeof(float) * sample_num));
+}
+
+extern "C" rkai_ret_t rkai_session_write_image(rkai_session_writer_t writer, uint32_t source, int64_t frame,
+                                               const rkai_image_t *image)
+{
+    if (writer == NULL || image == NULL || image->data == NULL || image->width == 0 || image->height == 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    uint32_t channels;
+    switch (image->pixel_format) {
+        case RKAI_PIXEL_FORMAT_GRAY8:
+            channels = 1;
+            break;
+        case RKAI_PIXEL_FORMAT_RGB888:
+        case RKAI_PIXEL_FORMAT_BGR888:
+            channels = 3;
+            break;
+        case RKAI_PIXEL_FORMAT_RGBA8888:
+        case RKAI_PIXEL_FORMAT_BGRA8888:
+            channels = 4;
+            break;
+        default:
+            LOG_ERROR("Session images are packed gray, RGB or RGBA, not format %d \n", (int) image->pixel_format);
+            return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    uint32_t max_width = (uint32_t) writer->config.max_image_width;
+    uint32_t factor = max_width > 0 ? (image->width + max_width - 1) / max_width : 1;
+    rkai_chunk_image_t info;
+    info.width = image->width / factor;
+    info.height = image->height / factor;
+    info.pixel_format = image->pixel_format;
+    info.channels = channels;
+    int size = (int) (sizeof(rkai_chunk_image_t) + info.width * info.height * channels);
+
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    uint8_t *out = session_append(writer, RKAI_CHUNK_IMAGE, source, frame, -1, size);
+    if (out == NULL) {
+        return RKAI_RET_COMMON_FAIL;
+    }
+    memcpy(out, &info, sizeof(rkai_chunk_image_t));
+    out += sizeof(rkai_chunk_image_t);
+    size_t row_size = (size_t) image->width * channels;
+    for (uint32_t y = 0; y < info.height; ++y) {
+        const uint8_t *row = image->data + (size_t) y * factor * row_size;
+        if (factor == 1) {
+            memcpy(out, row, row_size);
+            out += row_size;
+            continue;
+        }
+        for (uint32_t x = 0; x < info.width; ++x) {
+            memcpy(out, row + (size_t) x * factor * channels, channels);
+            out += channels;
+        }
+    }
+    writer->condition.notify_one();
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_session_get_stats(rkai_session_writer_t writer, rkai_session_stats_t *stats)
+{
+    if (writer == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    *stats = writer->stats;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_session_reader_t rkai_open_session_reader(const char *path, int64_t *start_time_us)
+{
+    if (path == NULL) {
+        return NULL;
+    }
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        LOG_ERROR("Cannot open the session %s \n", path);
+        return NULL;
+    }
+    session_file_header_t file_header;
+    struct stat info;
+    if (fread(&file_header, sizeof(session_file_header_t), 1, file) != 1 ||
+        memcmp(file_header.magic, SESSION_MAGIC, 4) != 0 || file_header.version != SESSION_VERSION ||
+        fstat(fileno(file), &info) != 0) {
+        LOG_ERROR("%s is not a session of version %d \n", path, SESSION_VERSION);
+        fclose(file);
+        return NULL;
+    }
+    if (start_time_us != NULL) {
+        *start_time_us = file_header.start_time_us;
+    }
+    rkai_session_reader_t reader = new _rkai_session_reader_t();
+    reader->file = file;
+    reader->file_size = info.st_size;
+    reader->position = sizeof(session_file_header_t);
+    reader->payload_size = 0;
+    return reader;
+}
+
+extern "C" rkai_ret_t rkai_release_session_reader(rkai_session_reader_t reader)
+{
+    if (reader == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    fclose(reader->file);
+    delete reader;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_session_next_chunk(rkai_session_reader_t reader, rkai_chunk_header_t *header,
+                                              int *has_chunk)
+{
+    if (reader == NULL || header == NULL || has_chunk == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *has_chunk = 0;
+    if (reader->payload_size > 0) {
+        reader->position += reader->payload_size;
+        reader->payload_size = 0;
+        if (fseek(reader->file, (long) reader->position, SEEK_SET) != 0) {
+            return RKAI_RET_COMMON_FAIL;
+        }
+    }
+    // A session cut by a crash ends at its last whole chunk
+    if (reader->position + (int64_t) sizeof(rkai_chunk_header_t) > reader->file_size ||
+        fread(header, sizeof(rkai_chunk_header_t), 1, reader->file) != 1) {
+        return RKAI_RET_SUCCESS;
+    }
+    reader->position += sizeof(rkai_chunk_header_t);
+    if (reader->position + header->size > reader->file_size) {
+        return RKAI_RET_SUCCESS;
+    }
+    reader->payload_size = header->size;
+    *has_chunk = 1;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_session_read_payload(rkai_session_reader_t reader, void *payload, int max_size)
+{
+    if (reader == NULL || (payload == NULL && reader->payload_size > 0) || max_size < (int64_t) reader->payload_size) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (reader->payload_size > 0 && fread(payload, 1, reader->payload_size, reader->file) != reader->payload_size) {
+        return RKAI_RET_COMMON_FAIL;
+    }
+    reader->position += reader->payload_size;
+    reader->payload_size = 0;
+    return RKAI_RET_SUCCESS;
+}
@@ -0,0 +1,212 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "utils/util.h"
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_stream.h"
+
+// Recurrent state of a handle, stored in handle->session_data
+typedef struct rkai_stream_state_t {
+    rkai_stream_config_t config;
+    int chunk_size;                         // Floats of input 0
+    int state_num;                          // Inputs after the chunk
+    std::vector<int> state_offsets;         // Offset of each state tensor in state
+    std::vector<int> state_sizes;           // Floats of each state tensor
+    std::vector<float> state;               // All the state tensors
+    int silent_chunk_count;                 // Silent chunks in a row
+    rkai_stream_stats_t stats;
+} rkai_stream_state_t;
+
+static void release_stream_state(void *session_data)
+{
+    delete (rkai_stream_state_t *) session_data;
+}
+
+static rkai_stream_state_t *get_stream_state(rkai_handle_t handle)
+{
+    if (handle == NULL || handle->release_session_data != release_stream_state) {
+        return NULL;
+    }
+    return (rkai_stream_state_t *) handle->session_data;
+}
+
+extern "C" rkai_ret_t rkai_stream_init(rkai_handle_t handle, const rkai_stream_config_t *config)
+{
+    if (handle == NULL || config == NULL || config->silence_reset_chunks < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (handle->input_tensor_attr == NULL || handle->output_tensor_attr == NULL) {
+        LOG_ERROR("Handle has no model \n");
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (handle->session_data != NULL) {
+        LOG_ERROR("Handle already has a session \n");
+        return RKAI_RET_COMMON_FAIL;
+    }
+    if (handle->io_num.n_input != handle->io_num.n_output) {
+        LOG_ERROR("Streaming model needs one output per input, got %d inputs and %d outputs \n",
+                  handle->io_num.n_input, handle->io_num.n_output);
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+
+    rkai_stream_state_t *stream = new rkai_stream_state_t();
+    stream->config = *config;
+    stream->chunk_size = (int) handle->input_tensor_attr[0].n_elems;
+    stream->state_num = (int) handle->io_num.n_input - 1;
+    int offset = 0;
+    for (int i = 1; i < (int) handle->io_num.n_input; ++i) {
+        int size = (int) handle->input_tensor_attr[i].n_elems;
+        if (size != (int) handle->output_tensor_attr[i].n_elems) {
+            LOG_ERROR("State %d has %d elements in input and %d in output \n", i - 1, size,
+                      (int) handle->output_tensor_attr[i].n_elems);
+            delete stream;
+            return RKAI_RET_INVALID_INPUT_PARAM;
+        }
+        stream->state_offsets.push_back(offset);
+        stream->state_sizes.push_back(size);
+        offset += size;
+    }
+    stream->state.assign(offset, 0.0f);
+    stream->silent_chunk_count = 0;
+    memset(&stream->stats, 0, sizeof(rkai_stream_stats_t));
+    handle->session_data = stream;
+    handle->release_session_data = release_stream_state;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_stream_run(rkai_handle_t handle, const float *chunk, int is_silent, float *scores,
+                                      int max_score_num, int *score_num)
+{
+    rkai_stream_state_t *stream = get_stream_state(handle);
+    if (stream == NULL || chunk == NULL || scores == NULL || score_num == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    stream->stats.chunk_count++;
+    if (is_silent) {
+        stream->silent_chunk_count++;
+        if (stream->config.silence_reset_chunks > 0 &&
+            stream->silent_chunk_count == stream->config.silence_reset_chunks) {
+            std::fill(stream->state.begin(), stream->state.end(), 0.0f);
+            stream->stats.reset_count++;
+        }
+        *score_num = std::min(max_score_num, (int) handle->output_tensor_attr[0].n_elems);
+        memset(scores, 0, *score_num * sizeof(float));
+        return RKAI_RET_SUCCESS;
+    }
+    stream->silent_chunk_count = 0;
+
+    int64_t start_us = get_current_time_us();
+    int n_io = (int) handle->io_num.n_input;
+    rknn_input inputs[n_io];
+    memset(inputs, 0, sizeof(inputs));
+    for (int i = 0; i < n_io; ++i) {
+        inputs[i].index = i;
+        inputs[i].type = RKNN_TENSOR_FLOAT32;
+        inputs[i].fmt = handle->input_tensor_attr[i].fmt;
+    }
+    inputs[0].size = stream->chunk_size * sizeof(float);
+    inputs[0].buf = (void *) chunk;
+    for (int i = 0; i < stream->state_num; ++i) {
+        inputs[i + 1].size = stream->state_sizes[i] * sizeof(float);
+        inputs[i + 1].buf = stream->state.data() + stream->state_offsets[i];
+    }
+
+    int rknn_ret_code = rknn_inputs_set(handle->context, n_io, inputs);
+    if (rknn_ret_code != RKNN_SUCC) {
+        LOG_WARN("Failed to set streaming model inputs, rknn_inputs_set return code %d \n", rknn_ret_code);
+        return RKAI_RET_COMMON_FAIL;
+    }
+    rknn_ret_code = model_run(handle);
+    if (rknn_ret_code != RKNN_SUCC) {
+        LOG_WARN("Failed to run streaming model, rknn_run return code %d \n", rknn_ret_code);
+        return RKAI_RET_COMMON_FAIL;
+    }
+
+    rknn_output outputs[n_io];
+    memset(outputs, 0, sizeof(outputs));
+    for (int i = 0; i < n_io; ++i) {
+        outputs[i].want_float = 1;
+    }
+    rknn_ret_code = rknn_outputs_get(handle->context, n_io, outputs, NULL);
+    if (rknn_ret_code != RKNN_SUCC) {
+        LOG_WARN("Failed to get streaming model outputs, rknn_outputs_get return code %d \n", rknn_ret_code);
+        return RKAI_RET_COMMON_FAIL;
+    }
+    *score_num = std::min(max_score_num, (int) (outputs[0].size / sizeof(float)));
+    memcpy(scores, outputs[0].buf, *score_num * sizeof(float));
+    // The inputs were copied by rknn_inputs_set, the state can be overwritten now
+    for (int i = 0; i < stream->state_num; ++i) {
+        memcpy(stream->state.data() + stream->state_offsets[i], outputs[i + 1].buf,
+               stream->state_sizes[i] * sizeof(float));
+    }
+    rknn_outputs_release(handle->context, n_io, outputs);
+
+    stream->stats.run_count++;
+    stream->stats.total_run_us += get_current_time_us() - start_us;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_stream_reset(rkai_handle_t handle)
+{
+    rkai_stream_state_t *stream = get_stream_state(handle);
+    if (stream == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::fill(stream->state.begin(), stream->state.end(), 0.0f);
+    stream->silent_chunk_count = 0;
+    stream->stats.reset_count++;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_stream_get_state_size(rkai_handle_t handle, int *size)
+{
+    rkai_stream_state_t *stream = get_stream_state(handle);
+    if (stream == NULL || size == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *size = (int) stream->state.size();
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_stream_snapshot(rkai_handle_t handle, float *snapshot, int size)
+{
+    rkai_stream_state_t *stream = get_stream_state(handle);
+    if (stream == NULL || snapshot == NULL || size != (int) stream->state.size()) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::copy(stream->state.begin(), stream->state.end(), snapshot);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_stream_restore(rkai_handle_t handle, const float *snapshot, int size)
+{
+    rkai_stream_state_t *stream = get_stream_state(handle);
+    if (stream == NULL || snapshot == NULL || size != (int) stream->state.size()) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::copy(snapshot, snapshot + size, stream->state.begin());
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_stream_get_stats(rkai_handle_t handle, rkai_stream_stats_t *stats)
+{
+    rkai_stream_state_t *stream = get_stream_state(handle);
+    if (stream == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *stats = stream->stats;
+    return RKAI_RET_SUCCESS;
+}
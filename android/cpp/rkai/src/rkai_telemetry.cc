@@ -0,0 +1,140 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_telemetry.h"
+
+#define TELEMETRY_WORD_NUM (sizeof(rkai_telemetry_entry_t) / sizeof(uint32_t))
+
+static_assert(sizeof(rkai_telemetry_entry_t) == 56, "The telemetry entry layout is read as it is through the JNI");
+static_assert(sizeof(rkai_telemetry_entry_t) % sizeof(uint32_t) == 0, "Entries are copied as 32 bit words");
+
+/**
+ * @brief Slot of the ring under a sequence lock. The entry is stored as atomic words so that a reader racing a
+ *        writer reads stale words, never undefined ones, and tells it from the version
+ */
+struct telemetry_slot_t {
+    // 2 * (sequence + 1) once the entry of that sequence is complete, odd while it is written, 0 if never written
+    std::atomic<uint64_t> version;
+    std::atomic<uint32_t> words[TELEMETRY_WORD_NUM];
+};
+
+struct _rkai_telemetry_t {
+    int capacity;
+    telemetry_slot_t *slots;
+    std::atomic<uint64_t> next_sequence;
+    std::atomic<uint64_t> dropped_count;
+};
+
+extern "C" rkai_telemetry_t rkai_create_telemetry(int capacity)
+{
+    if (capacity <= 0) {
+        LOG_ERROR("Invalid telemetry capacity %d \n", capacity);
+        return NULL;
+    }
+    rkai_telemetry_t telemetry = new _rkai_telemetry_t();
+    telemetry->capacity = capacity;
+    telemetry->slots = new telemetry_slot_t[capacity];
+    for (int i = 0; i < capacity; ++i) {
+        telemetry->slots[i].version.store(0, std::memory_order_relaxed);
+    }
+    telemetry->next_sequence.store(0, std::memory_order_relaxed);
+    telemetry->dropped_count.store(0, std::memory_order_relaxed);
+    return telemetry;
+}
+
+extern "C" rkai_ret_t rkai_release_telemetry(rkai_telemetry_t telemetry)
+{
+    if (telemetry == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete[] telemetry->slots;
+    delete telemetry;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_telemetry_write(rkai_telemetry_t telemetry, const rkai_telemetry_entry_t *entry)
+{
+    if (telemetry == NULL || entry == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    uint64_t sequence = telemetry->next_sequence.fetch_add(1, std::memory_order_relaxed);
+    telemetry_slot_t *slot = &telemetry->slots[sequence % telemetry->capacity];
+    uint64_t version = slot->version.load(std::memory_order_relaxed);
+    // A writer still in the slot, or a newer entry already there: this one would tear or reorder the ring
+    if ((version & 1) || version >= 2 * (sequence + 1) ||
+        !slot->version.compare_exchange_strong(version, 2 * sequence + 1, std::memory_order_relaxed)) {
+        telemetry->dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return RKAI_RET_SUCCESS;
+    }
+    // The odd version is visible before any word of the entry
+    std::atomic_thread_fence(std::memory_order_release);
+
+    rkai_telemetry_entry_t stamped = *entry;
+    stamped.sequence = sequence;
+    stamped.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    uint32_t words[TELEMETRY_WORD_NUM];
+    memcpy(words, &stamped, sizeof(rkai_telemetry_entry_t));
+    for (size_t i = 0; i < TELEMETRY_WORD_NUM; ++i) {
+        slot->words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot->version.store(2 * (sequence + 1), std::memory_order_release);
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_telemetry_snapshot(rkai_telemetry_t telemetry, rkai_telemetry_entry_t *entries,
+                                              int max_entry_num, int *entry_num)
+{
+    if (telemetry == NULL || entries == NULL || max_entry_num < 0 || entry_num == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *entry_num = 0;
+    uint64_t end = telemetry->next_sequence.load(std::memory_order_acquire);
+    uint64_t keep = (uint64_t) std::min(telemetry->capacity, max_entry_num);
+    uint64_t begin = end > keep ? end - keep : 0;
+    for (uint64_t sequence = begin; sequence < end; ++sequence) {
+        telemetry_slot_t *slot = &telemetry->slots[sequence % telemetry->capacity];
+        uint64_t version = slot->version.load(std::memory_order_acquire);
+        // Being written, dropped, or already overwritten by a newer entry
+        if (version != 2 * (sequence + 1)) {
+            continue;
+        }
+        uint32_t words[TELEMETRY_WORD_NUM];
+        for (size_t i = 0; i < TELEMETRY_WORD_NUM; ++i) {
+            words[i] = slot->words[i].load(std::memory_order_relaxed);
+        }
+        // The words are read before the version is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->version.load(std::memory_order_relaxed) != version) {
+            continue;
+        }
+        memcpy(&entries[(*entry_num)++], words, sizeof(rkai_telemetry_entry_t));
+    }
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_telemetry_get_stats(rkai_telemetry_t telemetry, rkai_telemetry_stats_t *stats)
+{
+    if (telemetry == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    stats->dropped_count = telemetry->dropped_count.load(std::memory_order_relaxed);
+    stats->write_count = telemetry->next_sequence.load(std::memory_order_relaxed) - stats->dropped_count;
+    stats->capacity = telemetry->capacity;
+    return RKAI_RET_SUCCESS;
+}
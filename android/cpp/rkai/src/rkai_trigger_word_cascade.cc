@@ -0,0 +1,193 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <mutex>
+#include "utils/util.h"
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_trigger_word_cascade.h"
+
+struct _rkai_trigger_word_cascade_t {
+    int stage_num;
+    rkai_cascade_stage_t stages[RKAI_CASCADE_MAX_STAGES];
+    rkai_melspectrogram_config_t configs[RKAI_CASCADE_MAX_STAGES];
+    rkai_noise_suppressor_t noise_suppressor;   // Not owned, NULL for none
+    int is_denoised[RKAI_CASCADE_MAX_STAGES];   // The front-end of the stage has the transform of the suppressor
+    std::mutex stats_mutex;
+    rkai_cascade_stats_t stats;
+};
+
+extern "C" rkai_trigger_word_cascade_t rkai_create_trigger_word_cascade(const rkai_cascade_stage_t *stages,
+                                                                        int stage_num) {
+    if (stages == NULL || stage_num < 1 || stage_num > RKAI_CASCADE_MAX_STAGES) {
+        LOG_ERROR("Invalid number of cascade stages %d \n", stage_num);
+        return NULL;
+    }
+
+    rkai_trigger_word_cascade_t cascade = new _rkai_trigger_word_cascade_t();
+    cascade->stage_num = stage_num;
+    cascade->noise_suppressor = NULL;
+    memset(cascade->is_denoised, 0, sizeof(cascade->is_denoised));
+    memset(&cascade->stats, 0, sizeof(rkai_cascade_stats_t));
+    cascade->stats.stage_num = stage_num;
+    for (int i = 0; i < stage_num; ++i) {
+        cascade->stages[i] = stages[i];
+        // Read the config once, instead of copying it from the handle at every window
+        if (rkai_get_trigger_word_config(stages[i].handle, &cascade->configs[i]) != RKAI_RET_SUCCESS) {
+            LOG_ERROR("Stage %d of the cascade is not an initialized trigger word handle \n", i);
+            delete cascade;
+            return NULL;
+        }
+    }
+    return cascade;
+}
+
+extern "C" rkai_ret_t rkai_release_trigger_word_cascade(rkai_trigger_word_cascade_t cascade) {
+    if (cascade == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete cascade;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_trigger_word_cascade_set_threshold(rkai_trigger_word_cascade_t cascade, int stage,
+                                                              float threshold) {
+    if (cascade == NULL || stage < 0 || stage >= cascade->stage_num) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    cascade->stages[stage].threshold = threshold;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_trigger_word_cascade_set_noise_suppressor(rkai_trigger_word_cascade_t cascade,
+                                                                     rkai_noise_suppressor_t suppressor)
+{
+    if (cascade == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    rkai_noise_suppressor_stats_t suppressor_stats;
+    if (suppressor != NULL && rkai_noise_suppressor_get_stats(suppressor, &suppressor_stats) != RKAI_RET_SUCCESS) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    int denoised_num = 0;
+    for (int i = 0; i < cascade->stage_num; ++i) {
+        const rkai_melspectrogram_config_t *config = &cascade->configs[i];
+        const rkai_noise_suppressor_config_t *suppressor_config = &suppressor_stats.config;
+        cascade->is_denoised[i] = suppressor != NULL && config->sample_rate == suppressor_config->sample_rate &&
+                                  config->n_fft == suppressor_config->n_fft &&
+                                  config->win_length == suppressor_config->win_length &&
+                                  config->hop_length == suppressor_config->hop_length;
+        denoised_num += cascade->is_denoised[i];
+    }
+    if (suppressor != NULL && denoised_num < cascade->stage_num) {
+        LOG_WARN("Noise suppressor only matches %d of the %d cascade stages \n", denoised_num, cascade->stage_num);
+    }
+    cascade->noise_suppressor = suppressor;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_trigger_word_cascade_detect(rkai_trigger_word_cascade_t cascade, rkai_audio_t *audio,
+                                                       rkai_cascade_result_t *result)
+{
+    return rkai_trigger_word_cascade_detect_at(cascade, audio, -1, result);
+}
+
+extern "C" rkai_ret_t rkai_trigger_word_cascade_detect_at(rkai_trigger_word_cascade_t cascade, rkai_audio_t *audio,
+                                                          int64_t position, rkai_cascade_result_t *result)
+{
+    if (cascade == NULL || audio == NULL || result == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+
+    memset(result, 0, sizeof(rkai_cascade_result_t));
+    result->exit_stage = -1;
+    int64_t stage_us[RKAI_CASCADE_MAX_STAGES] = {0};
+    rkai_melspectrogram_t melspectrograms[RKAI_CASCADE_MAX_STAGES];
+    memset(melspectrograms, 0, sizeof(melspectrograms));
+    rkai_ret_t ret = RKAI_RET_SUCCESS;
+    for (int i = 0; i < cascade->stage_num; ++i) {
+        rkai_cascade_stage_t *stage = &cascade->stages[i];
+        int64_t start_us = get_current_time_us();
+        // A stage with the front-end of an earlier stage reads its melspectrogram, the noise estimate learns once
+        int source = i;
+        for (int j = 0; j < i; ++j) {
+            if (melspectrograms[j].data != NULL && cascade->is_denoised[j] == cascade->is_denoised[i] &&
+                rkai_audio_is_same_front_end(&cascade->configs[j], &cascade->configs[i])) {
+                source = j;
+                break;
+            }
+        }
+        if (source == i) {
+            rkai_noise_suppressor_t suppressor =
+                    position >= 0 && cascade->is_denoised[i] ? cascade->noise_suppressor : NULL;
+            ret = rkai_audio_to_denoised_melspectrogram(audio, position, suppressor, &melspectrograms[i],
+                                                        cascade->configs[i], NULL);
+        }
+        // Binary models: class 0 is the background, class 1 the trigger word
+        float scores[2];
+        int score_num = 0;
+        if (ret == RKAI_RET_SUCCESS) {
+            ret = rkai_trigger_word_infer(stage->handle, &melspectrograms[source], scores, 2, &score_num);
+        }
+        if (ret == RKAI_RET_SUCCESS && score_num < 2) {
+            LOG_ERROR("Trigger word model has %d output classes, expected 2 \n", score_num);
+            ret = RKAI_RET_COMMON_FAIL;
+        }
+        stage_us[i] = get_current_time_us() - start_us;
+        result->stage_count = i + 1;
+        if (ret != RKAI_RET_SUCCESS) {
+            LOG_ERROR("Failed to run stage %d of the trigger word cascade \n", i);
+            result->exit_stage = i;
+            break;
+        }
+        result->scores[i] = scores[1];
+        if (scores[1] <= stage->threshold) {
+            // Early exit, the later stages are not run on this window
+            result->exit_stage = i;
+            break;
+        }
+    }
+    for (int i = 0; i < cascade->stage_num; ++i) {
+        rkai_audio_melspectrogram_release(&melspectrograms[i]);
+    }
+    result->is_detected = ret == RKAI_RET_SUCCESS && result->exit_stage < 0;
+
+    std::lock_guard<std::mutex> lock(cascade->stats_mutex);
+    cascade->stats.window_count++;
+    if (result->is_detected) {
+        cascade->stats.detected_count++;
+    }
+    for (int i = 0; i < cascade->stage_num; ++i) {
+        rkai_cascade_stage_stats_t *stage_stats = &cascade->stats.stages[i];
+        if (i >= result->stage_count) {
+            stage_stats->skip_count++;
+            continue;
+        }
+        stage_stats->run_count++;
+        stage_stats->total_us += stage_us[i];
+        if (i != result->exit_stage) {
+            stage_stats->pass_count++;
+        }
+    }
+    return ret;
+}
+
+extern "C" rkai_ret_t rkai_trigger_word_cascade_get_stats(rkai_trigger_word_cascade_t cascade,
+                                                          rkai_cascade_stats_t *stats) {
+    if (cascade == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(cascade->stats_mutex);
+    *stats = cascade->stats;
+    return RKAI_RET_SUCCESS;
+}
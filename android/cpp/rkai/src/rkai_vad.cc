@@ -8,75 +8,60 @@
 #include "utils/logger.h"
 #include "rkai.h"
 #include "android_porting/android_fopen.h"
-#include <vector>
 #include "rkai_vad.h"
 
 #define VAD_MODEL_PATH "model/vad/vad.rknn"
 #define VAD_MODEL_INFORMATION_PATH "model/vad/vad_config.txt"
-
-rkai_melspectrogram_config_t vad_model_config_t;
+// Frames of a 1 s window at 16kHz with a 320 hop, the layout rkai_vad_postprocess expects
+#define VAD_WINDOW_FRAME_NUM 51
+// Frames of the longest window the model outputs
+#define VAD_MAX_FRAME_NUM 256
 
 extern "C" rkai_ret_t rkai_init_vad_model(rkai_handle_t handle){
-    rkai_ret_t ret = load_config_file(VAD_MODEL_INFORMATION_PATH, &vad_model_config_t);
-    if (ret != RKAI_RET_SUCCESS) {
-        LOG_ERROR("Cannot load config file for vad model \n");
-        return RKAI_RET_COMMON_FAIL;
-    }
-    return model_init(handle, VAD_MODEL_PATH);
+    return rkai_init_vad_android_model(handle, NULL);
 }
 
 extern "C" rkai_ret_t rkai_init_vad_android_model(rkai_handle_t handle, AAssetManager *asset_mgr){
-    rkai_ret_t ret = load_config_file(VAD_MODEL_INFORMATION_PATH, &vad_model_config_t);
+    handle->asset_manager = asset_mgr;
+    rkai_ret_t ret = audio_model_init(handle, VAD_MODEL_INFORMATION_PATH, VAD_MODEL_PATH);
     if (ret != RKAI_RET_SUCCESS) {
-        LOG_ERROR("Cannot load config file for vad model \n");
-        return RKAI_RET_COMMON_FAIL;
+        LOG_ERROR("Cannot init vad model \n");
     }
-    return model_init(handle, VAD_MODEL_PATH);
+    return ret;
 }
 
-extern "C" rkai_melspectrogram_config_t rkai_get_vad_config() {
-    return vad_model_config_t;
+extern "C" rkai_ret_t rkai_get_vad_config(rkai_handle_t handle, rkai_melspectrogram_config_t *config) {
+    return audio_model_get_config(handle, config);
 }
 
-extern "C" rkai_ret_t rkai_vad_detect(rkai_handle_t handle, rkai_audio_t *audio,
-                                      rkai_melspectrogram_config_t vad_model_config,
-                                      rkai_vad_result_t *vad_result,
-                                      float low_threshold, float high_threshold) {
+/**
+ * @brief Run the vad model on the input_size values of a melspectrogram and copy the speech probability of each
+ *        frame
+ */
+static rkai_ret_t vad_run(rkai_handle_t handle, float *input, int input_size,
+                          float *frame_scores, int max_frame_num, int *frame_num) {
     int rknn_ret_code;
-    rkai_ret_t rkai_ret_code = RKAI_RET_SUCCESS;
-
-    // Convert audio waveform to mel spectrogram for vad model
-    rkai_melspectrogram_t melspectrogram;
-    rkai_ret_code = rkai_audio_to_melspectrogram(audio, &melspectrogram, vad_model_config);
-    if (rkai_ret_code != RKAI_RET_SUCCESS){
-        LOG_ERROR("Cannot convert audio to melspectrogram \n");
-        return rkai_ret_code;
-    }
 
     // Setup input for rknn model
     rknn_input inputs[1];
     memset(inputs, 0, sizeof(inputs));
     inputs[0].index = 0;
     inputs[0].type = RKNN_TENSOR_FLOAT32;
-    inputs[0].size = vad_model_config.output_size * sizeof(float);
+    inputs[0].size = input_size * sizeof(float);
     inputs[0].fmt = RKNN_TENSOR_NHWC;
-    inputs[0].buf = melspectrogram.data;
+    inputs[0].buf = input;
 
     rknn_ret_code = rknn_inputs_set(handle->context, handle->io_num.n_input, inputs);
     if (rknn_ret_code != RKNN_SUCC) {
-        LOG_WARN("Failed to Init vad detection input data. Return code of function rknn_input_set = $d\n", rknn_ret_code);
-        rkai_ret_code = RKAI_RET_COMMON_FAIL;
-        rkai_audio_melspectrogram_release(&melspectrogram);
-        return rkai_ret_code;
+        LOG_WARN("Failed to Init vad detection input data. Return code of function rknn_input_set = %d\n", rknn_ret_code);
+        return RKAI_RET_COMMON_FAIL;
     }
 
     // model inference
-    rknn_ret_code = rknn_run(handle->context, NULL);
+    rknn_ret_code = model_run(handle);
     if (rknn_ret_code != RKNN_SUCC) {
-        LOG_WARN("Failed to run vad detection model. Return code of function rknn_run = $d\n", rknn_ret_code);
-        rkai_ret_code = RKAI_RET_COMMON_FAIL;
-        rkai_audio_melspectrogram_release(&melspectrogram);
-        return rkai_ret_code;
+        LOG_WARN("Failed to run vad detection model. Return code of function rknn_run = %d\n", rknn_ret_code);
+        return RKAI_RET_COMMON_FAIL;
     }
 
     // Get model output
@@ -88,87 +73,118 @@ extern "C" rkai_ret_t rkai_vad_detect(rkai_handle_t handle, rkai_audio_t *audio,
 
     rknn_ret_code = rknn_outputs_get(handle->context, handle->io_num.n_output, outputs, NULL);
     if (rknn_ret_code != RKNN_SUCC) {
-        LOG_WARN("Failed to get vad detection model output. Return code of function rknn_outputs_get = $d\n", rknn_ret_code);
-        rkai_ret_code = RKAI_RET_COMMON_FAIL;
-        rkai_audio_melspectrogram_release(&melspectrogram);
-        return rkai_ret_code;
+        LOG_WARN("Failed to get vad detection model output. Return code of function rknn_outputs_get = %d\n", rknn_ret_code);
+        return RKAI_RET_COMMON_FAIL;
     }
 
+    // Two classes per frame, the second one is speech
     float *vad_output = (float *) outputs[0].buf;
-    rkai_ret_code = rkai_vad_postprocess(vad_output, vad_result, low_threshold, high_threshold);
-    if (rkai_ret_code != RKAI_RET_SUCCESS) {
-        LOG_ERROR("Cannot postprocess vad detection model output \n");
-        rkai_audio_melspectrogram_release(&melspectrogram);
-        return rkai_ret_code;
+    int output_frame_num = (int) (outputs[0].size / sizeof(float) / 2);
+    *frame_num = output_frame_num < max_frame_num ? output_frame_num : max_frame_num;
+    for (int i = 0; i < *frame_num; ++i) {
+        frame_scores[i] = vad_output[2 * i + 1];
     }
+    rknn_outputs_release(handle->context, handle->io_num.n_output, outputs);
+    return RKAI_RET_SUCCESS;
+}
 
+/**
+ * @brief Run the vad model on a window and copy the speech probability of each frame
+ */
+static rkai_ret_t vad_inference(rkai_handle_t handle, rkai_audio_t *audio,
+                                const rkai_melspectrogram_config_t *vad_model_config,
+                                float *frame_scores, int max_frame_num, int *frame_num) {
+    rkai_ret_t rkai_ret_code = RKAI_RET_SUCCESS;
+
+    // Convert audio waveform to mel spectrogram for vad model
+    rkai_melspectrogram_t melspectrogram;
+    rkai_ret_code = rkai_audio_to_melspectrogram(audio, &melspectrogram, *vad_model_config);
+    if (rkai_ret_code != RKAI_RET_SUCCESS){
+        LOG_ERROR("Cannot convert audio to melspectrogram \n");
+        return rkai_ret_code;
+    }
+    rkai_ret_code = vad_run(handle, melspectrogram.data, vad_model_config->output_size, frame_scores,
+                            max_frame_num, frame_num);
     rkai_audio_melspectrogram_release(&melspectrogram);
     return rkai_ret_code;
 }
 
-std::vector<int> find_contiguous_regions(std::vector<bool> locations) {
-    std::vector<int> regions;
-    std::vector<bool> tmp1 = {locations.begin() + 1, locations.end()};
-    std::vector<bool> tmp2 = {locations.begin(), locations.end() -1};
-
-    for (int i = 0; i < tmp1.size(); ++i) {
-        if (tmp1.at(i) xor tmp2.at(i)) {
-            regions.push_back(i+1);
-        }
+extern "C" rkai_ret_t rkai_vad_detect(rkai_handle_t handle, rkai_audio_t *audio,
+                                      rkai_melspectrogram_config_t vad_model_config,
+                                      rkai_vad_result_t *vad_result,
+                                      float low_threshold, float high_threshold) {
+    float frame_scores[VAD_MAX_FRAME_NUM];
+    int frame_num = 0;
+    rkai_ret_t rkai_ret_code = vad_inference(handle, audio, &vad_model_config, frame_scores, VAD_MAX_FRAME_NUM,
+                                             &frame_num);
+    if (rkai_ret_code != RKAI_RET_SUCCESS) {
+        return rkai_ret_code;
     }
-
-    if (locations.at(0)) {
-        regions.insert(regions.begin(), 0);
+    rkai_ret_code = rkai_vad_postprocess_frames(frame_scores, frame_num, vad_result, low_threshold, high_threshold);
+    if (rkai_ret_code != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Cannot postprocess vad detection model output \n");
     }
+    return rkai_ret_code;
+}
 
-    if (locations.at(locations.size() - 1)) {
-        regions.push_back(locations.size());
+extern "C" rkai_ret_t rkai_vad_detect_frames(rkai_handle_t handle, rkai_audio_t *audio,
+                                             rkai_melspectrogram_config_t vad_model_config,
+                                             float *frame_scores, int max_frame_num, int *frame_num) {
+    if (handle == NULL || audio == NULL || frame_scores == NULL || frame_num == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
     }
-
-    return regions;
+    return vad_inference(handle, audio, &vad_model_config, frame_scores, max_frame_num, frame_num);
 }
 
-rkai_ret_t rkai_vad_postprocess(float *output,
-                                rkai_vad_result_t *vad_result,
-                                float low_threshold, float high_threshold) {
-    std::vector<float> score_time_stamp;
-    for (int i = 0; i < 51; ++i) {
-        score_time_stamp.push_back(output[2*i + 1]);
+extern "C" rkai_ret_t rkai_vad_infer_frames(rkai_handle_t handle, const rkai_melspectrogram_t *melspectrogram,
+                                            float *frame_scores, int max_frame_num, int *frame_num) {
+    if (handle == NULL || melspectrogram == NULL || melspectrogram->data == NULL || frame_scores == NULL ||
+        frame_num == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
     }
-    std::vector<int> high_locations;
-    std::vector<bool> locations;
-
-    for (int i = 0; i < score_time_stamp.size(); ++i) {
-        if(score_time_stamp[i] > high_threshold) {
-            high_locations.push_back(i);
-        }
+    return vad_run(handle, melspectrogram->data, melspectrogram->size, frame_scores, max_frame_num, frame_num);
+}
 
-        if(score_time_stamp[i] > low_threshold) {
-            locations.push_back(true);
-        } else {
-            locations.push_back(false);
-        }
+extern "C" rkai_ret_t rkai_vad_postprocess_frames(const float *frame_scores, int frame_num,
+                                                  rkai_vad_result_t *vad_result,
+                                                  float low_threshold, float high_threshold) {
+    if (frame_scores == NULL || frame_num <= 0 || vad_result == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
     }
-    // Find the contiguous regions (continuous true values)
-    std::vector<int> change_indexes = find_contiguous_regions(locations);
-    std::vector<int> filtered_list;
-    for (int i = 0; i < change_indexes.size(); i+=2) {
-        int pair0 = change_indexes.at(i);
-        int pair1 = change_indexes.at(i + 1);
-        for (int j = 0; j < high_locations.size(); ++j) {
-            if (pair0 <= high_locations.at(j) && high_locations.at(j) <= pair1) {
-                filtered_list.push_back(pair0);
-                filtered_list.push_back(pair1);
-                break;
+    // Count the frames of the runs over the low threshold that reach the high threshold somewhere
+    int total_voice = 0;
+    int region_start = -1;
+    int region_is_voice = 0;
+    for (int i = 0; i <= frame_num; ++i) {
+        if (i < frame_num && frame_scores[i] > low_threshold) {
+            if (region_start < 0) {
+                region_start = i;
+                region_is_voice = 0;
+            }
+            region_is_voice |= frame_scores[i] > high_threshold;
+        } else if (region_start >= 0) {
+            if (region_is_voice) {
+                total_voice += i - region_start;
             }
+            region_start = -1;
         }
     }
-    int total_voice = 0;
-    for (int i = 0; i < filtered_list.size(); i = i + 2)
-    {
-        total_voice += filtered_list.at(i + 1) - filtered_list.at(i);
-    }
-    vad_result->conf = (float) total_voice / 51.0;
-    vad_result->is_speech = 1 ? vad_result->conf > 0.4 : 0;
+    vad_result->conf = (float) total_voice / (float) frame_num;
+    vad_result->is_speech = vad_result->conf > 0.4;
     return RKAI_RET_SUCCESS;
-}
\ No newline at end of file
+}
+
+extern "C" rkai_ret_t rkai_vad_postprocess(float *output,
+                                           rkai_vad_result_t *vad_result,
+                                           float low_threshold, float high_threshold) {
+    if (output == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    // Two classes per frame of a 1 s window, the second one is speech
+    float frame_scores[VAD_WINDOW_FRAME_NUM];
+    for (int i = 0; i < VAD_WINDOW_FRAME_NUM; ++i) {
+        frame_scores[i] = output[2 * i + 1];
+    }
+    return rkai_vad_postprocess_frames(frame_scores, VAD_WINDOW_FRAME_NUM, vad_result, low_threshold,
+                                       high_threshold);
+}
@@ -0,0 +1,194 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_vad_score_stream.h"
+
+struct _rkai_vad_score_stream_t {
+    rkai_vad_score_stream_config_t config;
+    // Ring of config.capacity frames, frame i at i % capacity
+    float *score_sum;
+    float *score_max;
+    int *estimate_count;
+    int64_t read_frame;     // Oldest frame held
+    int64_t final_frame;    // Frames before it get no more estimates
+    int64_t end_frame;      // Frame after the newest frame held
+    std::mutex stats_mutex;
+    rkai_vad_score_stream_stats_t stats;
+};
+
+static void clear_frame(rkai_vad_score_stream_t stream, int64_t frame)
+{
+    int slot = (int) (frame % stream->config.capacity);
+    stream->score_sum[slot] = 0;
+    stream->score_max[slot] = 0;
+    stream->estimate_count[slot] = 0;
+}
+
+extern "C" rkai_ret_t rkai_vad_score_stream_default_config(const rkai_melspectrogram_config_t *model_config,
+                                                           rkai_vad_score_stream_config_t *config)
+{
+    if (model_config == NULL || config == NULL || model_config->n_mels <= 0 || model_config->hop_length <= 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    // The model input is n_mels x frames, 64 x 51 for 1 s at 16kHz with a 320 hop
+    config->hop_length = model_config->hop_length;
+    config->window_frame_num = model_config->output_size / model_config->n_mels;
+    config->capacity = config->window_frame_num * 4;
+    config->merge = RKAI_VAD_MERGE_MEAN;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_vad_score_stream_t rkai_create_vad_score_stream(const rkai_vad_score_stream_config_t *config)
+{
+    if (config == NULL || config->hop_length <= 0 || config->window_frame_num <= 0 ||
+        config->capacity < config->window_frame_num) {
+        LOG_ERROR("Invalid vad score stream config \n");
+        return NULL;
+    }
+    rkai_vad_score_stream_t stream = new _rkai_vad_score_stream_t();
+    stream->config = *config;
+    stream->score_sum = (float *) malloc(sizeof(float) * config->capacity);
+    stream->score_max = (float *) malloc(sizeof(float) * config->capacity);
+    stream->estimate_count = (int *) malloc(sizeof(int) * config->capacity);
+    if (stream->score_sum == NULL || stream->score_max == NULL || stream->estimate_count == NULL) {
+        LOG_ERROR("Cannot allocate the vad score stream \n");
+        rkai_release_vad_score_stream(stream);
+        return NULL;
+    }
+    memset(&stream->stats, 0, sizeof(rkai_vad_score_stream_stats_t));
+    rkai_vad_score_stream_reset(stream, 0);
+    return stream;
+}
+
+extern "C" rkai_ret_t rkai_release_vad_score_stream(rkai_vad_score_stream_t stream)
+{
+    if (stream == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    free(stream->score_sum);
+    free(stream->score_max);
+    free(stream->estimate_count);
+    delete stream;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_score_stream_add(rkai_vad_score_stream_t stream, int64_t first_frame,
+                                                const float *scores, int frame_num)
+{
+    if (stream == NULL || scores == NULL || frame_num < 0 || first_frame < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (first_frame < stream->final_frame) {
+        LOG_WARN("Vad window at frame %lld added out of order \n", (long long) first_frame);
+    }
+    int64_t end_frame = first_frame + frame_num;
+    uint64_t dropped_count = 0;
+    uint64_t merged_count = 0;
+    // Make room for the new frames, the oldest ones are lost if the reader is late
+    if (end_frame - stream->read_frame > stream->config.capacity) {
+        int64_t read_frame = end_frame - stream->config.capacity;
+        int64_t held_end = stream->end_frame < read_frame ? stream->end_frame : read_frame;
+        dropped_count = held_end > stream->read_frame ? held_end - stream->read_frame : 0;
+        stream->read_frame = read_frame;
+        if (stream->end_frame < read_frame) {
+            stream->end_frame = read_frame;
+        }
+        if (stream->final_frame < read_frame) {
+            stream->final_frame = read_frame;
+        }
+    }
+    for (; stream->end_frame < end_frame; stream->end_frame++) {
+        clear_frame(stream, stream->end_frame);
+    }
+    int64_t frame = first_frame > stream->read_frame ? first_frame : stream->read_frame;
+    for (; frame < end_frame; frame++) {
+        int slot = (int) (frame % stream->config.capacity);
+        float score = scores[frame - first_frame];
+        if (stream->estimate_count[slot] == 0 || score > stream->score_max[slot]) {
+            stream->score_max[slot] = score;
+        }
+        merged_count += stream->estimate_count[slot] > 0;
+        stream->score_sum[slot] += score;
+        stream->estimate_count[slot]++;
+    }
+    // Later windows start after this one, the frames before it are final
+    if (first_frame > stream->final_frame) {
+        stream->final_frame = first_frame < stream->end_frame ? first_frame : stream->end_frame;
+    }
+    std::lock_guard<std::mutex> lock(stream->stats_mutex);
+    stream->stats.window_count++;
+    stream->stats.merged_frame_count += merged_count;
+    stream->stats.dropped_frame_count += dropped_count;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_score_stream_read(rkai_vad_score_stream_t stream, float *scores, int max_frame_num,
+                                                 int64_t *first_frame, int *frame_num)
+{
+    if (stream == NULL || scores == NULL || max_frame_num < 0 || first_frame == NULL || frame_num == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *first_frame = stream->read_frame;
+    int64_t available = stream->final_frame - stream->read_frame;
+    *frame_num = available < max_frame_num ? (int) available : max_frame_num;
+    for (int i = 0; i < *frame_num; ++i) {
+        int slot = (int) ((stream->read_frame + i) % stream->config.capacity);
+        int count = stream->estimate_count[slot];
+        if (count == 0) {
+            scores[i] = 0;
+        } else if (stream->config.merge == RKAI_VAD_MERGE_MAX) {
+            scores[i] = stream->score_max[slot];
+        } else {
+            scores[i] = stream->score_sum[slot] / (float) count;
+        }
+    }
+    stream->read_frame += *frame_num;
+    std::lock_guard<std::mutex> lock(stream->stats_mutex);
+    stream->stats.read_frame_count += *frame_num;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_score_stream_flush(rkai_vad_score_stream_t stream)
+{
+    if (stream == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    stream->final_frame = stream->end_frame;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_score_stream_reset(rkai_vad_score_stream_t stream, int64_t next_frame)
+{
+    if (stream == NULL || next_frame < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    stream->read_frame = next_frame;
+    stream->final_frame = next_frame;
+    stream->end_frame = next_frame;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_score_stream_get_stats(rkai_vad_score_stream_t stream,
+                                                      rkai_vad_score_stream_stats_t *stats)
+{
+    if (stream == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(stream->stats_mutex);
+    *stats = stream->stats;
+    return RKAI_RET_SUCCESS;
+}
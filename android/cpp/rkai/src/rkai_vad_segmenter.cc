@@ -0,0 +1,195 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <mutex>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_vad_segmenter.h"
+
+typedef enum {
+    VAD_SEGMENTER_SILENCE = 0,
+    VAD_SEGMENTER_CANDIDATE,    // Over the onset, not yet min_speech long
+    VAD_SEGMENTER_SPEECH,
+} vad_segmenter_state_t;
+
+struct _rkai_vad_segmenter_t {
+    rkai_vad_segmenter_config_t config;
+    int min_speech_frames;
+    int hangover_frames;
+    int max_segment_frames;
+    vad_segmenter_state_t state;
+    int64_t next_frame;         // Absolute index of the next frame expected
+    int64_t start_frame;        // First frame of the candidate or of the segment
+    int64_t last_speech_frame;  // Last frame over the offset threshold
+    std::mutex stats_mutex;
+    rkai_vad_segmenter_stats_t stats;
+};
+
+static int samples_to_frames(int samples, int hop_length)
+{
+    return (samples + hop_length - 1) / hop_length;
+}
+
+static void emit_event(rkai_vad_segmenter_t segmenter, rkai_vad_segment_event_type_t type, int is_truncated,
+                       int64_t frame, rkai_vad_segment_event_t *events, int max_event_num, int *event_num)
+{
+    int hop_length = segmenter->config.hop_length;
+    if (type == RKAI_VAD_SEGMENT_END) {
+        std::lock_guard<std::mutex> lock(segmenter->stats_mutex);
+        segmenter->stats.segment_count++;
+        segmenter->stats.truncated_count += is_truncated;
+        segmenter->stats.speech_samples += (segmenter->last_speech_frame + 1 - segmenter->start_frame) * hop_length;
+    }
+    if (*event_num >= max_event_num) {
+        LOG_WARN("No room for the vad segment event of frame %lld \n", (long long) frame);
+        return;
+    }
+    rkai_vad_segment_event_t *event = &events[(*event_num)++];
+    event->type = type;
+    event->is_truncated = is_truncated;
+    event->start_sample = segmenter->start_frame * hop_length;
+    event->end_sample = type == RKAI_VAD_SEGMENT_END ? (segmenter->last_speech_frame + 1) * hop_length : -1;
+    // The event is known once the frame that decided it is pushed
+    event->decision_sample = (frame + 1) * hop_length;
+}
+
+static void vad_segmenter_step(rkai_vad_segmenter_t segmenter, int64_t frame, float score,
+                               rkai_vad_segment_event_t *events, int max_event_num, int *event_num)
+{
+    const rkai_vad_segmenter_config_t *config = &segmenter->config;
+    switch (segmenter->state) {
+        case VAD_SEGMENTER_SILENCE:
+            if (score < config->onset_threshold) {
+                break;
+            }
+            segmenter->state = VAD_SEGMENTER_CANDIDATE;
+            segmenter->start_frame = frame;
+            // A one frame minimum starts the segment right away
+            [[fallthrough]];
+        case VAD_SEGMENTER_CANDIDATE:
+            if (score < config->offset_threshold) {
+                // Too short to be speech
+                segmenter->state = VAD_SEGMENTER_SILENCE;
+                break;
+            }
+            segmenter->last_speech_frame = frame;
+            if (frame - segmenter->start_frame + 1 >= segmenter->min_speech_frames) {
+                segmenter->state = VAD_SEGMENTER_SPEECH;
+                emit_event(segmenter, RKAI_VAD_SEGMENT_START, 0, frame, events, max_event_num, event_num);
+            }
+            break;
+        case VAD_SEGMENTER_SPEECH:
+            if (score >= config->offset_threshold) {
+                segmenter->last_speech_frame = frame;
+            } else if (frame - segmenter->last_speech_frame >= segmenter->hangover_frames) {
+                segmenter->state = VAD_SEGMENTER_SILENCE;
+                emit_event(segmenter, RKAI_VAD_SEGMENT_END, 0, frame, events, max_event_num, event_num);
+                break;
+            }
+            if (frame - segmenter->start_frame + 1 >= segmenter->max_segment_frames) {
+                // Cut here, the speech goes on in a new segment starting at the next frame
+                segmenter->last_speech_frame = frame;
+                emit_event(segmenter, RKAI_VAD_SEGMENT_END, 1, frame, events, max_event_num, event_num);
+                segmenter->start_frame = frame + 1;
+                emit_event(segmenter, RKAI_VAD_SEGMENT_START, 0, frame, events, max_event_num, event_num);
+            }
+            break;
+    }
+}
+
+extern "C" rkai_ret_t rkai_vad_segmenter_default_config(int sample_rate, int hop_length,
+                                                        rkai_vad_segmenter_config_t *config)
+{
+    if (sample_rate <= 0 || hop_length <= 0 || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    config->hop_length = hop_length;
+    config->onset_threshold = 0.6f;
+    config->offset_threshold = 0.3f;
+    config->min_speech = sample_rate / 10;
+    config->hangover = sample_rate * 6 / 10;
+    config->max_segment = sample_rate * 15;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_vad_segmenter_t rkai_create_vad_segmenter(const rkai_vad_segmenter_config_t *config)
+{
+    if (config == NULL || config->hop_length <= 0 || config->offset_threshold > config->onset_threshold ||
+        config->min_speech < 0 || config->hangover < 0 || config->max_segment < config->min_speech) {
+        LOG_ERROR("Invalid vad segmenter config \n");
+        return NULL;
+    }
+    rkai_vad_segmenter_t segmenter = new _rkai_vad_segmenter_t();
+    segmenter->config = *config;
+    segmenter->min_speech_frames = samples_to_frames(config->min_speech, config->hop_length);
+    segmenter->hangover_frames = samples_to_frames(config->hangover, config->hop_length);
+    segmenter->max_segment_frames = samples_to_frames(config->max_segment, config->hop_length);
+    memset(&segmenter->stats, 0, sizeof(rkai_vad_segmenter_stats_t));
+    rkai_vad_segmenter_reset(segmenter, 0);
+    return segmenter;
+}
+
+extern "C" rkai_ret_t rkai_release_vad_segmenter(rkai_vad_segmenter_t segmenter)
+{
+    if (segmenter == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete segmenter;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_segmenter_push(rkai_vad_segmenter_t segmenter, int64_t first_frame,
+                                              const float *scores, int frame_num, rkai_vad_segment_event_t *events,
+                                              int max_event_num, int *event_num)
+{
+    if (segmenter == NULL || scores == NULL || frame_num < 0 || events == NULL || event_num == NULL ||
+        first_frame < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *event_num = 0;
+    // Frames skipped between two calls (dropped windows) are silence
+    for (; segmenter->next_frame < first_frame; segmenter->next_frame++) {
+        vad_segmenter_step(segmenter, segmenter->next_frame, 0, events, max_event_num, event_num);
+    }
+    int64_t end_frame = first_frame + frame_num;
+    for (; segmenter->next_frame < end_frame; segmenter->next_frame++) {
+        vad_segmenter_step(segmenter, segmenter->next_frame, scores[segmenter->next_frame - first_frame], events,
+                           max_event_num, event_num);
+    }
+    std::lock_guard<std::mutex> lock(segmenter->stats_mutex);
+    segmenter->stats.frame_count = segmenter->next_frame;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_segmenter_reset(rkai_vad_segmenter_t segmenter, int64_t next_frame)
+{
+    if (segmenter == NULL || next_frame < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    segmenter->state = VAD_SEGMENTER_SILENCE;
+    segmenter->next_frame = next_frame;
+    segmenter->start_frame = -1;
+    segmenter->last_speech_frame = -1;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_vad_segmenter_get_stats(rkai_vad_segmenter_t segmenter,
+                                                   rkai_vad_segmenter_stats_t *stats)
+{
+    if (segmenter == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(segmenter->stats_mutex);
+    *stats = segmenter->stats;
+    return RKAI_RET_SUCCESS;
+}
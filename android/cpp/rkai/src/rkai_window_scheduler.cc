@@ -0,0 +1,201 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include "utils/logger.h"
+#include "rkai.h"
+#include "rkai_window_scheduler.h"
+
+// Lag histogram: 10 ms buckets up to 10 s, the last bucket holds everything above
+#define WINDOW_LAG_BUCKET_MS 10
+#define WINDOW_LAG_BUCKET_NUM 1000
+
+struct _rkai_window_scheduler_t {
+    rkai_window_scheduler_config_t config;
+    int64_t next_start;         // Start of the next window
+    int64_t processed_end;      // End of the last window processed, the audio after it is new
+    int stride;                 // Last stride, spacing of the windows still to come
+    int64_t catch_up_end;       // Windows ending before it are all processed, see rkai_window_scheduler_rewind
+    rkai_scheduled_window_t current;
+    int has_current;
+    std::mutex stats_mutex;
+    rkai_window_scheduler_stats_t stats;
+    uint32_t lag_histogram[WINDOW_LAG_BUCKET_NUM];
+};
+
+static float lag_percentile(rkai_window_scheduler_t scheduler, float percentile)
+{
+    uint64_t rank = (uint64_t) (percentile * scheduler->stats.window_count);
+    uint64_t count = 0;
+    for (int i = 0; i < WINDOW_LAG_BUCKET_NUM; ++i) {
+        count += scheduler->lag_histogram[i];
+        if (count > rank) {
+            return (float) (i + 1) * WINDOW_LAG_BUCKET_MS;
+        }
+    }
+    return (float) WINDOW_LAG_BUCKET_NUM * WINDOW_LAG_BUCKET_MS;
+}
+
+extern "C" rkai_window_scheduler_t rkai_create_window_scheduler(const rkai_window_scheduler_config_t *config)
+{
+    if (config == NULL || config->sample_rate <= 0 || config->window_size <= 0 || config->stride <= 0 ||
+        config->policy < 0 || config->policy >= RKAI_LAG_POLICY_NUM || config->max_lag < 0 ||
+        config->buffer_size < config->window_size || config->keep_every < 1 ||
+        config->max_coalesce_size < config->window_size) {
+        LOG_ERROR("Invalid window scheduler config \n");
+        return NULL;
+    }
+    rkai_window_scheduler_t scheduler = new _rkai_window_scheduler_t();
+    scheduler->config = *config;
+    memset(&scheduler->stats, 0, sizeof(rkai_window_scheduler_stats_t));
+    memset(scheduler->lag_histogram, 0, sizeof(scheduler->lag_histogram));
+    rkai_window_scheduler_reset(scheduler, 0);
+    return scheduler;
+}
+
+extern "C" rkai_ret_t rkai_release_window_scheduler(rkai_window_scheduler_t scheduler)
+{
+    if (scheduler == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    delete scheduler;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_window_scheduler_poll(rkai_window_scheduler_t scheduler, int64_t write_index,
+                                                 int *is_ready, rkai_scheduled_window_t *window)
+{
+    if (scheduler == NULL || is_ready == NULL || window == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    const rkai_window_scheduler_config_t *config = &scheduler->config;
+    int64_t start = scheduler->next_start;
+    if (start + config->window_size > write_index) {
+        *is_ready = 0;
+        return RKAI_RET_SUCCESS;
+    }
+
+    // Windows starting before the oldest sample of the buffer cannot be read any more
+    int64_t overrun_count = 0;
+    int64_t oldest = write_index - config->buffer_size;
+    if (start < oldest) {
+        overrun_count = (oldest - start + scheduler->stride - 1) / scheduler->stride;
+        start += overrun_count * scheduler->stride;
+    }
+
+    // Whole windows pending after the first one
+    int64_t pending_count = (write_index - start - config->window_size) / scheduler->stride;
+    int64_t lag = write_index - start - config->window_size;
+    int64_t dropped_count = 0;
+    int64_t coalesced_count = 0;
+    int is_catching_up = start + config->window_size <= scheduler->catch_up_end;
+    if (lag > config->max_lag && !is_catching_up) {
+        switch (config->policy) {
+            case RKAI_LAG_POLICY_SKIP_TO_NEWEST:
+                dropped_count = pending_count;
+                break;
+            case RKAI_LAG_POLICY_COALESCE:
+                coalesced_count = std::min(pending_count,
+                                           (int64_t) (config->max_coalesce_size - config->window_size) /
+                                           scheduler->stride);
+                // What cannot fit in the span is dropped, the span ends at the newest window
+                dropped_count = pending_count - coalesced_count;
+                break;
+            case RKAI_LAG_POLICY_EVERY_KTH:
+                dropped_count = std::min(pending_count, (int64_t) config->keep_every - 1);
+                break;
+            default:
+                break;
+        }
+    }
+    start += dropped_count * scheduler->stride;
+
+    window->start = start;
+    window->size = config->window_size + (int) (coalesced_count * scheduler->stride);
+    window->new_sample_count = (int) std::min<int64_t>(window->size,
+                                                       start + window->size - scheduler->processed_end);
+    window->lag = write_index - start - window->size;
+    window->skipped_count = (int) (overrun_count + dropped_count);
+    window->coalesced_count = (int) coalesced_count;
+    scheduler->current = *window;
+    scheduler->has_current = 1;
+    *is_ready = 1;
+
+    int64_t lag_ms = window->lag * 1000 / config->sample_rate;
+    std::lock_guard<std::mutex> lock(scheduler->stats_mutex);
+    scheduler->stats.window_count++;
+    scheduler->stats.overrun_count += overrun_count;
+    scheduler->stats.dropped_count += overrun_count + dropped_count;
+    scheduler->stats.coalesced_count += coalesced_count;
+    scheduler->stats.max_lag_ms = std::max(scheduler->stats.max_lag_ms, (float) lag_ms);
+    scheduler->lag_histogram[std::min<int64_t>(lag_ms / WINDOW_LAG_BUCKET_MS, WINDOW_LAG_BUCKET_NUM - 1)]++;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_window_scheduler_advance(rkai_window_scheduler_t scheduler, int stride)
+{
+    if (scheduler == NULL || stride <= 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    if (!scheduler->has_current) {
+        LOG_ERROR("No window to advance from, call rkai_window_scheduler_poll first \n");
+        return RKAI_RET_COMMON_FAIL;
+    }
+    const rkai_scheduled_window_t *current = &scheduler->current;
+    int64_t last_window_start = current->start + current->size - scheduler->config.window_size;
+    scheduler->next_start = last_window_start + stride;
+    scheduler->processed_end = current->start + current->size;
+    scheduler->stride = stride;
+    scheduler->has_current = 0;
+    scheduler->catch_up_end = 0;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_window_scheduler_rewind(rkai_window_scheduler_t scheduler, int64_t start,
+                                                   int64_t write_index)
+{
+    if (rkai_window_scheduler_reset(scheduler, start) != RKAI_RET_SUCCESS) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    scheduler->catch_up_end = write_index;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_window_scheduler_reset(rkai_window_scheduler_t scheduler, int64_t start)
+{
+    if (scheduler == NULL || start < 0) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    scheduler->next_start = start;
+    scheduler->processed_end = start;
+    scheduler->stride = scheduler->config.stride;
+    scheduler->has_current = 0;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_window_scheduler_get_stats(rkai_window_scheduler_t scheduler,
+                                                      rkai_window_scheduler_stats_t *stats)
+{
+    if (scheduler == NULL || stats == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(scheduler->stats_mutex);
+    *stats = scheduler->stats;
+    if (stats->window_count > 0) {
+        stats->lag_p50_ms = lag_percentile(scheduler, 0.5f);
+        stats->lag_p90_ms = lag_percentile(scheduler, 0.9f);
+        stats->lag_p99_ms = lag_percentile(scheduler, 0.99f);
+    }
+    return RKAI_RET_SUCCESS;
+}
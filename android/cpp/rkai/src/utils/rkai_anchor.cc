@@ -0,0 +1,160 @@
+/******************************************************************************
+*    Created on Mon Oct 19 2026
+*
+*    Copyright (c) 2022 Rikkei AI.  All rights reserved.
+*
+*    The material in this file is confidential and contains trade secrets
+*    of Rikkei AI. This is proprietary information owned by Rikkei AI. No
+*    part of this work may be disclosed, reproduced, copied, transmitted,
+*    or used in any way for any purpose,without the express written
+*    permission of Rikkei AI
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rkai_anchor.h"
+#include "logger.h"
+#include "android_porting/android_fopen.h"
+
+extern "C" const rkai_anchor_config_t FACE_DETECT_ANCHOR_CONFIG = {
+        640, 480, 3, 2,
+        {8, 16, 32},
+        {{16, 32}, {64, 128}, {256, 416}}
+};
+
+static int ceil_div(int value, int divisor)
+{
+    return (value + divisor - 1) / divisor;
+}
+
+extern "C" int rkai_anchor_count(const rkai_anchor_config_t *config)
+{
+    int count = 0;
+    for (int level = 0; level < config->level_num; level++) {
+        int step = config->steps[level];
+        count += ceil_div(config->image_height, step) * ceil_div(config->image_width, step) * config->size_num;
+    }
+    return count;
+}
+
+extern "C" rkai_ret_t rkai_generate_anchors(const rkai_anchor_config_t *config, anchors_t *anchors)
+{
+    if (config == NULL || anchors == NULL || config->level_num <= 0 || config->level_num > RKAI_ANCHOR_MAX_LEVEL ||
+        config->size_num <= 0 || config->size_num > RKAI_ANCHOR_MAX_SIZE_PER_LEVEL ||
+        config->image_width <= 0 || config->image_height <= 0) {
+        LOG_ERROR("Invalid anchor config \n");
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    for (int level = 0; level < config->level_num; level++) {
+        if (config->steps[level] <= 0) {
+            LOG_ERROR("Invalid step %d at level %d \n", config->steps[level], level);
+            return RKAI_RET_INVALID_INPUT_PARAM;
+        }
+    }
+
+    int num_anchors = rkai_anchor_count(config);
+    float *data = (float *) malloc(num_anchors * 4 * sizeof(float));
+    if (data == NULL) {
+        LOG_ERROR("Malloc anchors failed \n");
+        return RKAI_RET_COMMON_FAIL;
+    }
+
+    float image_width = (float) config->image_width;
+    float image_height = (float) config->image_height;
+    float *anchor = data;
+    for (int level = 0; level < config->level_num; level++) {
+        int step = config->steps[level];
+        int rows = ceil_div(config->image_height, step);
+        int cols = ceil_div(config->image_width, step);
+        for (int i = 0; i < rows; i++) {
+            float cy = (i + 0.5f) * step / image_height;
+            for (int j = 0; j < cols; j++) {
+                float cx = (j + 0.5f) * step / image_width;
+                for (int k = 0; k < config->size_num; k++) {
+                    anchor[0] = cx;
+                    anchor[1] = cy;
+                    anchor[2] = config->min_sizes[level][k] / image_width;
+                    anchor[3] = config->min_sizes[level][k] / image_height;
+                    anchor += 4;
+                }
+            }
+        }
+    }
+
+    free(anchors->data);
+    anchors->data = data;
+    anchors->num_anchors = num_anchors;
+    anchors->anchors_array_size = num_anchors * 4;
+    anchors->curr_idx = num_anchors;
+    return RKAI_RET_SUCCESS;
+}
+
+extern "C" rkai_ret_t rkai_load_anchor_file(struct AAssetManager *asset_mgr, const char *file_name, anchors_t *anchors,
+                                            rkai_size_t *input_size)
+{
+    if (file_name == NULL || anchors == NULL || input_size == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    AAsset *fp = android_fopen_with_manager(asset_mgr, file_name, "r");
+    if (fp == NULL) {
+        LOG_ERROR("Cannot open file %s \n", file_name);
+        return RKAI_RET_COMMON_FAIL;
+    }
+
+    int file_size = android_ftell(fp);
+    char *line = (char *) malloc(file_size + 1);
+    if (line == NULL) {
+        LOG_ERROR("Malloc buffer of file %s failed \n", file_name);
+        android_close(fp);
+        return RKAI_RET_COMMON_FAIL;
+    }
+    int read_size = android_read(fp, line, file_size);
+    android_close(fp);
+    if (read_size < 0) {
+        LOG_ERROR("Cannot read file %s \n", file_name);
+        free(line);
+        return RKAI_RET_COMMON_FAIL;
+    }
+    line[read_size] = '\0';
+
+    // The header, then one line per prior
+    anchors_t read = {};
+    rkai_ret_t ret = RKAI_RET_SUCCESS;
+    char *token = strtok(line, "\n");
+    if (token == NULL || sscanf(token, "%d %d %d %d", &read.num_anchors, &read.anchors_array_size, &input_size->w,
+                                &input_size->h) != 4 || read.num_anchors <= 0 ||
+        read.anchors_array_size != read.num_anchors * 4) {
+        LOG_ERROR("Failed to read anchor information from file %s, please check the number of anchors and total size of "
+                  "anchor array\n", file_name);
+        ret = RKAI_RET_COMMON_FAIL;
+    } else {
+        read.data = (float *) malloc(read.anchors_array_size * sizeof(float));
+        if (read.data == NULL) {
+            LOG_ERROR("Malloc anchors failed \n");
+            ret = RKAI_RET_COMMON_FAIL;
+        }
+    }
+    for (token = strtok(NULL, "\n"); ret == RKAI_RET_SUCCESS && token != NULL; token = strtok(NULL, "\n")) {
+        float *anchor = read.data + read.curr_idx * 4;
+        if (read.curr_idx >= read.num_anchors ||
+            sscanf(token, "%f %f %f %f", &anchor[0], &anchor[1], &anchor[2], &anchor[3]) != 4) {
+            LOG_ERROR("Bad anchor at line %d of file %s \n", read.curr_idx + 2, file_name);
+            ret = RKAI_RET_COMMON_FAIL;
+            break;
+        }
+        read.curr_idx += 1;
+    }
+    free(line);
+    if (ret == RKAI_RET_SUCCESS && read.curr_idx != read.num_anchors) {
+        LOG_ERROR("File %s has %d of its %d anchors \n", file_name, read.curr_idx, read.num_anchors);
+        ret = RKAI_RET_COMMON_FAIL;
+    }
+    if (ret != RKAI_RET_SUCCESS) {
+        free(read.data);
+        return ret;
+    }
+    free(anchors->data);
+    *anchors = read;
+    return RKAI_RET_SUCCESS;
+}
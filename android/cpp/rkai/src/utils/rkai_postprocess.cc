@@ -10,6 +10,7 @@
 *    permission of Rikkei AI
 ******************************************************************************/
 #include "rkai_postprocess.h"
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include "utils/logger.h"
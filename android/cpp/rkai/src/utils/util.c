@@ -24,10 +24,10 @@
 
 #include "android_porting/android_fopen.h"
 
-unsigned char *rkai_util_load_model_from_file(char *model_path, int *model_size)
+unsigned char *rkai_util_load_model_from_file(AAssetManager *asset_mgr, const char *model_path, int *model_size)
 {
     // 1. Check if model exist or not
-    AAsset *fp = android_fopen(model_path, "r");
+    AAsset *fp = android_fopen_with_manager(asset_mgr, model_path, "r");
 
     if (fp != NULL)
     {
@@ -61,7 +61,7 @@ unsigned char *rkai_util_load_model_from_file(char *model_path, int *model_size)
 rkai_ret_t model_init(rkai_handle_t handle, const char *model_path)
 {
     int model_size;
-    unsigned char *model_data = rkai_util_load_model_from_file(model_path, &model_size);
+    unsigned char *model_data = rkai_util_load_model_from_file(handle->asset_manager, model_path, &model_size);
 
     if (model_data == NULL)
     {
@@ -84,14 +84,7 @@ rkai_ret_t model_init(rkai_handle_t handle, const char *model_path)
         return RKAI_RET_COMMON_FAIL;
     }
 
-//     rknn_core_mask core_mask = RKNN_NPU_CORE_0_1_2;
-//     rknn_ret_code = rknn_set_core_mask(handle->context, core_mask);
-//     if (rknn_ret_code != RKNN_SUCC)
-//     {
-//         LOG_ERROR("Failed to set core mask . \n");
-//         rknn_destroy(handle->context);
-//         return RKAI_RET_COMMON_FAIL;
-//     }
+    // Core mask is set per model by rkai_set_core_mask or rkai_scheduler_attach
     // Query number of input and output
     rknn_ret_code = rknn_query(handle->context, RKNN_QUERY_IN_OUT_NUM, &handle->io_num, sizeof(handle->io_num));
     if (rknn_ret_code != RKNN_SUCC)
@@ -459,19 +452,31 @@ rkai_ret_t crop_new_box(rkai_rect_t *current_box, rkai_rect_t *new_box, int new_
 }
 
 
-rkai_ret_t load_config_file(const char *file_name, rkai_melspectrogram_config_t *config) {
-    AAsset *fp = android_fopen(file_name, "r");
-    char line[1024000];
+rkai_ret_t load_config_file(AAssetManager *asset_mgr, const char *file_name, rkai_melspectrogram_config_t *config) {
+    AAsset *fp = android_fopen_with_manager(asset_mgr, file_name, "r");
     int count = 0;
     if (fp == NULL) {
         LOG_ERROR("Cannot open file %s \n", file_name);
         return RKAI_RET_COMMON_FAIL;
     }
 
-    if (android_read(fp, line, 1024000) == -1) {
+    // On the heap and sized by the file, the init functions may run on threads with a small stack
+    int file_size = android_ftell(fp);
+    char *line = (char *) malloc(file_size + 1);
+    if (line == NULL) {
+        LOG_ERROR("Malloc buffer of file %s failed \n", file_name);
+        android_close(fp);
+        return RKAI_RET_COMMON_FAIL;
+    }
+    // The read does not terminate the text, the config files have no newline at the end
+    int size = android_read(fp, line, file_size);
+    if (size < 0) {
         LOG_ERROR("Cannot read file %s \n", file_name);
+        free(line);
+        android_close(fp);
         return RKAI_RET_COMMON_FAIL;
     }
+    line[size] = '\0';
 
     char *token;
     token = strtok(line, "\n");
@@ -489,6 +494,8 @@ rkai_ret_t load_config_file(const char *file_name, rkai_melspectrogram_config_t
         if (sscanf(token, "%d %d %d %d %d %d %d %d %d %d %d %le", &sample_rate, &n_fft, &f_max, &n_mels, &win_len,
                    &n_hop, &output_length, &transpose_mel, &htk, &norm, &norm_mel, &log_mel) == 0) {
             LOG_ERROR("Cannot read data from file %s \n", file_name);
+            free(line);
+            android_close(fp);
             return RKAI_RET_COMMON_FAIL;
         }
         config->sample_rate = sample_rate;
@@ -509,7 +516,39 @@ rkai_ret_t load_config_file(const char *file_name, rkai_melspectrogram_config_t
         token = strtok(NULL, "\n");
         count++;
     }
+    free(line);
     android_close(fp);
     return RKAI_RET_SUCCESS;
 }
 
+rkai_ret_t audio_model_init(rkai_handle_t handle, const char *config_path, const char *model_path)
+{
+    rkai_melspectrogram_config_t *config = (rkai_melspectrogram_config_t *)calloc(1, sizeof(rkai_melspectrogram_config_t));
+    if (config == NULL) {
+        LOG_ERROR("Error while allocate model config\n");
+        return RKAI_RET_COMMON_FAIL;
+    }
+    rkai_ret_t ret = load_config_file(handle->asset_manager, config_path, config);
+    if (ret != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Cannot load config file %s \n", config_path);
+        free(config);
+        return RKAI_RET_COMMON_FAIL;
+    }
+    ret = model_init(handle, model_path);
+    if (ret != RKAI_RET_SUCCESS) {
+        free(config);
+        return ret;
+    }
+    handle->model_data = config;
+    handle->release_model_data = free;
+    return RKAI_RET_SUCCESS;
+}
+
+rkai_ret_t audio_model_get_config(rkai_handle_t handle, rkai_melspectrogram_config_t *config)
+{
+    if (handle == NULL || handle->model_data == NULL || config == NULL) {
+        return RKAI_RET_INVALID_INPUT_PARAM;
+    }
+    *config = *(rkai_melspectrogram_config_t *)handle->model_data;
+    return RKAI_RET_SUCCESS;
+}
@@ -21,6 +21,7 @@
 
 #include "Eigen/Core"
 #include "unsupported/Eigen/FFT"
+#include <algorithm>
 #include <vector>
 #include <complex>
 #include <iostream>
@@ -105,6 +106,38 @@ namespace librosa {
             return X.leftCols(n_f);
         }
 
+        /// Inverse of stft by weighted overlap-add, X as stft returns it. length samples of the signal are given
+        /// back, zero past the last frame
+        static Vectorf istft(Matrixcf &X, int n_fft, int win_len, int n_hop, bool center, int length) {
+            Vectorf window = 0.5 * (1.f - (Vectorf::LinSpaced(win_len, 0.f,
+                                                              static_cast<float>(win_len - 1)) *
+                                           2.f * M_PI / win_len).array().cos());
+            Vectorf padded_window = Vectorf::Zero(n_fft);
+            padded_window.segment((n_fft - win_len) / 2, win_len) = window;
+
+            int n_frames = X.rows();
+            int y_len = n_fft + n_hop * (n_frames - 1);
+            Vectorf y = Vectorf::Zero(y_len);
+            Vectorf window_sum = Vectorf::Zero(y_len);
+            Eigen::FFT<float> fft;
+            fft.SetFlag(Eigen::FFT<float>::HalfSpectrum);
+            Vectorf x_frame(n_fft);
+            for (int i = 0; i < n_frames; ++i) {
+                Vectorcf X_frame = X.row(i);
+                fft.inv(x_frame, X_frame, n_fft);
+                y.segment(i * n_hop, n_fft) += (x_frame.array() * padded_window.array()).matrix();
+                window_sum.segment(i * n_hop, n_fft) += padded_window.array().square().matrix();
+            }
+            // Samples no window covers stay zero
+            y = (window_sum.array() > 1e-6f).select(y.array() / window_sum.array(), 0.f);
+
+            int start = center ? n_fft / 2 : 0;
+            Vectorf x = Vectorf::Zero(length);
+            int copy_len = std::max(0, std::min(length, y_len - start));
+            x.segment(0, copy_len) = y.segment(start, copy_len);
+            return x;
+        }
+
         static Matrixf spectrogram(Matrixcf &X, float power = 1.f) {
             return X.cwiseAbs().array().pow(power);
         }
@@ -164,17 +197,23 @@ namespace librosa {
             return weights;
         }
 
-        static Matrixf melspectrogram(Vectorf &x, int sr, int n_fft, int win_len,
-                                      int n_hop, const std::string &win, bool center,
-                                      const std::string &mode, float power,
+        /// Mel spectrogram of a short-time fourier transform already computed
+        static Matrixf melspectrogram(Matrixcf &X, int sr, int n_fft, float power,
                                       int n_mels, int fmin, int fmax, bool htk, bool norm) {
-            Matrixcf X = stft(x, n_fft, win_len, n_hop, win, center, mode);
             Matrixf mel_basis = melfilter(sr, n_fft, n_mels, fmin, fmax, htk, norm);
             Matrixf sp = spectrogram(X, power);
             Matrixf mel = mel_basis * sp.transpose();
             return mel;
         }
 
+        static Matrixf melspectrogram(Vectorf &x, int sr, int n_fft, int win_len,
+                                      int n_hop, const std::string &win, bool center,
+                                      const std::string &mode, float power,
+                                      int n_mels, int fmin, int fmax, bool htk, bool norm) {
+            Matrixcf X = stft(x, n_fft, win_len, n_hop, win, center, mode);
+            return melspectrogram(X, sr, n_fft, power, n_mels, fmin, fmax, htk, norm);
+        }
+
         static Matrixf power2db(Matrixf &x) {
             auto log_sp = 10.0f * x.array().max(1e-10).log10();
             return log_sp.cwiseMax(log_sp.maxCoeff() - 80.0f);
@@ -254,8 +293,21 @@ namespace librosa {
                                                               bool is_convert_transpose,
                                                               double log_mel) {
             Vectorf map_x = Eigen::Map<Vectorf>(x.data(), x.size());
-            Matrixf mel = internal::melspectrogram(map_x, sr, n_fft, win_len, n_hop, win, center,
-                                                   mode, power, n_mels, fmin, fmax, htk,
+            Matrixcf X = internal::stft(map_x, n_fft, win_len, n_hop, win, center, mode);
+            return melspectrogram(X, sr, n_fft, power, n_mels, fmin, fmax, htk, norm, mel_norm,
+                                  is_convert_transpose, log_mel);
+        }
+
+        /// \brief      compute mel spectrogram from a short-time fourier transform, e.g. one modified in place
+        /// \param      X             complex short-time fourier transform, frames by bins as internal::stft
+        /// \return     mel spectrogram matrix, the other parameters are the ones of melspectrogram
+        static std::vector<std::vector<float>> melspectrogram(Matrixcf &X, int sr, int n_fft,
+                                                              float power, int n_mels, int fmin,
+                                                              int fmax, bool htk, bool norm,
+                                                              bool mel_norm,
+                                                              bool is_convert_transpose,
+                                                              double log_mel) {
+            Matrixf mel = internal::melspectrogram(X, sr, n_fft, power, n_mels, fmin, fmax, htk,
                                                    norm).transpose();
             std::vector<std::vector<float>> mel_vector(mel.cols(),
                                                        std::vector<float>(mel.rows(), 0.f));
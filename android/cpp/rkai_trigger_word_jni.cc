@@ -3,21 +3,146 @@
 //
 #include <jni.h>
 #include <string>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
 #include <android/asset_manager_jni.h>
 #include <android/log.h>
 #include "rkai.h"
-#include "android_fopen.h"
+#include "npu_scheduler.h"
 
-rkai_handle_t trigger_word_bc_handle;
-rkai_handle_t trigger_word_conv_handle;
-rkai_melspectrogram_config_t triggerword_config_bc;
-rkai_melspectrogram_config_t triggerword_config_conv;
+// Kotlin flows and native callbacks may call the detection from different threads, each call
+// checks out its own context from the pool
+#define TRIGGER_WORD_HANDLE_POOL_SIZE 2
+#define TRIGGER_WORD_CHECKOUT_TIMEOUT_MS 500
+#define TRIGGER_WORD_CASCADE_STAGE_NUM 2
+// The fusion fires when the smoothed conv score reaches the conv threshold of cascadeDetect, and re-arms once it
+// drops this much under it, as the default 0.7 / 0.5 of the fusion
+#define TRIGGER_WORD_FUSION_HYSTERESIS 0.2f
+
+/**
+ * Detection state of one TriggerWord object. initModel creates it and keeps it in the nativeHandle field of the
+ * object, release frees it, so several objects run independent pipelines
+ */
+struct TriggerWordPipeline {
+    rkai_handle_pool_t bc_pool = nullptr;
+    rkai_handle_pool_t conv_pool = nullptr;
+    rkai_melspectrogram_config_t config_bc;
+    rkai_melspectrogram_config_t config_conv;
+    // bc -> conv cascade with its own contexts, the Kotlin flow calls it from its recording thread
+    rkai_handle_t cascade_handles[TRIGGER_WORD_CASCADE_STAGE_NUM] = {nullptr, nullptr};
+    rkai_trigger_word_cascade_t cascade = nullptr;
+    // Windows with no energy above the noise floor are skipped before the cascade, guarded by the cascade mutex
+    rkai_energy_gate_t energy_gate = nullptr;
+    // Debounces the cascade scores into one trigger per utterance, positions are counted in samples given to the gate
+    rkai_decision_fusion_t fusion = nullptr;
+    int64_t stream_end = 0;
+    std::mutex cascade_mutex;
+};
 
 static jclass objCls = NULL;
 static jmethodID constructortorId;
 static jfieldID scoreId;
 static jfieldID passLowThresholdId;
 static jfieldID passHighThresholdId;
+static jfieldID stageCountId;
+static jfieldID isTriggeredId;
+static jfieldID nativeHandleId = NULL;
+
+static void releasePipeline(TriggerWordPipeline *pipeline) {
+    if (pipeline->cascade != nullptr) {
+        rkai_release_trigger_word_cascade(pipeline->cascade);
+    }
+    if (pipeline->energy_gate != nullptr) {
+        rkai_release_energy_gate(pipeline->energy_gate);
+    }
+    if (pipeline->fusion != nullptr) {
+        rkai_release_decision_fusion(pipeline->fusion);
+    }
+    // The cascade contexts are duplicated from the ones of the pools, they share their model state
+    for (rkai_handle_t handle : pipeline->cascade_handles) {
+        if (handle != nullptr) {
+            rkai_release_handle(handle);
+        }
+    }
+    if (pipeline->bc_pool != nullptr) {
+        rkai_release_handle_pool(pipeline->bc_pool);
+    }
+    if (pipeline->conv_pool != nullptr) {
+        rkai_release_handle_pool(pipeline->conv_pool);
+    }
+    delete pipeline;
+}
+
+/**
+ * Load both models and build the pools, the cascade, the gate and the fusion of a pipeline, NULL on failure
+ */
+static TriggerWordPipeline *createPipeline(AAssetManager *mgr) {
+    TriggerWordPipeline *pipeline = new TriggerWordPipeline();
+    rkai_handle_t trigger_word_bc_handle = rkai_create_handle();
+    rkai_handle_t trigger_word_conv_handle = rkai_create_handle();
+    if (trigger_word_bc_handle == nullptr || trigger_word_conv_handle == nullptr ||
+        rkai_init_trigger_word_android_bc_model(trigger_word_bc_handle, mgr) != RKAI_RET_SUCCESS ||
+        rkai_init_trigger_word_android_conv_model(trigger_word_conv_handle, mgr) != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Cannot load the trigger word models \n");
+        if (trigger_word_bc_handle != nullptr) {
+            rkai_release_handle(trigger_word_bc_handle);
+        }
+        if (trigger_word_conv_handle != nullptr) {
+            rkai_release_handle(trigger_word_conv_handle);
+        }
+        delete pipeline;
+        return nullptr;
+    }
+    rkai_scheduler_attach(getNpuScheduler(), trigger_word_bc_handle, RKAI_PRIORITY_AUDIO_CRITICAL,
+                          kTriggerWordDeadlineMs, getTriggerWordCoreMask());
+    rkai_scheduler_attach(getNpuScheduler(), trigger_word_conv_handle, RKAI_PRIORITY_AUDIO_CRITICAL,
+                          kTriggerWordDeadlineMs, getTriggerWordCoreMask());
+    rkai_get_trigger_word_config(trigger_word_bc_handle, &pipeline->config_bc);
+    rkai_get_trigger_word_config(trigger_word_conv_handle, &pipeline->config_conv);
+
+    // The pools own the handles once created, the caller still does if the creation fails
+    pipeline->bc_pool = rkai_create_handle_pool(trigger_word_bc_handle, TRIGGER_WORD_HANDLE_POOL_SIZE);
+    if (pipeline->bc_pool == nullptr) {
+        rkai_release_handle(trigger_word_bc_handle);
+    }
+    pipeline->conv_pool = rkai_create_handle_pool(trigger_word_conv_handle, TRIGGER_WORD_HANDLE_POOL_SIZE);
+    if (pipeline->conv_pool == nullptr) {
+        rkai_release_handle(trigger_word_conv_handle);
+    }
+    if (pipeline->bc_pool == nullptr || pipeline->conv_pool == nullptr) {
+        LOG_ERROR("Cannot create the trigger word handle pools \n");
+        releasePipeline(pipeline);
+        return nullptr;
+    }
+
+    pipeline->cascade_handles[0] = rkai_duplicate_handle(trigger_word_bc_handle);
+    pipeline->cascade_handles[1] = rkai_duplicate_handle(trigger_word_conv_handle);
+    if (pipeline->cascade_handles[0] != nullptr && pipeline->cascade_handles[1] != nullptr) {
+        rkai_cascade_stage_t stages[TRIGGER_WORD_CASCADE_STAGE_NUM] = {{pipeline->cascade_handles[0], 0.6},
+                                                                      {pipeline->cascade_handles[1], 0.6}};
+        pipeline->cascade = rkai_create_trigger_word_cascade(stages, TRIGGER_WORD_CASCADE_STAGE_NUM);
+    }
+    rkai_energy_gate_config_t gate_config;
+    rkai_energy_gate_default_config(8000, &gate_config);
+    pipeline->energy_gate = rkai_create_energy_gate(&gate_config);
+    rkai_fusion_config_t fusion_config;
+    rkai_decision_fusion_default_config(8000, &fusion_config);
+    pipeline->fusion = rkai_create_decision_fusion(&fusion_config, 1);
+    if (pipeline->cascade == nullptr || pipeline->energy_gate == nullptr || pipeline->fusion == nullptr) {
+        LOG_ERROR("Cannot create the trigger word cascade \n");
+        releasePipeline(pipeline);
+        return nullptr;
+    }
+    return pipeline;
+}
+
+static TriggerWordPipeline *getPipeline(JNIEnv *env, jobject thiz) {
+    if (nativeHandleId == NULL) {
+        return nullptr;
+    }
+    return reinterpret_cast<TriggerWordPipeline *>(env->GetLongField(thiz, nativeHandleId));
+}
 
 
 extern "C"
@@ -32,17 +157,24 @@ JNIEXPORT jstring JNICALL Java_org_rikkei_smartrobot_MainActivity_stringFromJNI(
 
 JNIEXPORT void JNICALL Java_com_example_smart_1robot_TriggerWord_initModel(
         JNIEnv *env,
-        jobject,
+        jobject thiz,
         jobject assetManager) {
+    jclass triggerWordCls = env->GetObjectClass(thiz);
+    nativeHandleId = env->GetFieldID(triggerWordCls, "nativeHandle", "J");
+    if (getPipeline(env, thiz) != nullptr) {
+        return;
+    }
     AAssetManager *mgr = AAssetManager_fromJava(env, assetManager);
-    android_fopen_set_asset_manager(mgr);
-    trigger_word_bc_handle = rkai_create_handle();
-    trigger_word_conv_handle = rkai_create_handle();
-    rkai_init_trigger_word_android_bc_model(trigger_word_bc_handle, mgr);
-    rkai_init_trigger_word_android_conv_model(trigger_word_conv_handle, mgr);
-    triggerword_config_bc = rkai_get_bc_config();
-    triggerword_config_conv = rkai_get_conv_config();
+    TriggerWordPipeline *pipeline = createPipeline(mgr);
+    if (pipeline == nullptr) {
+        return;
+    }
+    env->SetLongField(thiz, nativeHandleId, reinterpret_cast<jlong>(pipeline));
 
+    // The result class is shared by all the objects
+    if (objCls != NULL) {
+        return;
+    }
     jclass localObjCls = env->FindClass("com/example/smart_robot/TriggerWord$Obj");
     objCls = reinterpret_cast<jclass>(env->NewGlobalRef(localObjCls));
 
@@ -51,13 +183,31 @@ JNIEXPORT void JNICALL Java_com_example_smart_1robot_TriggerWord_initModel(
     scoreId = env->GetFieldID(objCls, "score", "F");
     passLowThresholdId = env->GetFieldID(objCls, "passLowThreshold", "Z");
     passHighThresholdId = env->GetFieldID(objCls, "passHighThreshold", "Z");
+    stageCountId = env->GetFieldID(objCls, "stageCount", "I");
+    isTriggeredId = env->GetFieldID(objCls, "isTriggered", "Z");
     return;
 }
 
+JNIEXPORT void JNICALL Java_com_example_smart_1robot_TriggerWord_release(
+        JNIEnv *env,
+        jobject thiz) {
+    TriggerWordPipeline *pipeline = getPipeline(env, thiz);
+    if (pipeline == nullptr) {
+        return;
+    }
+    env->SetLongField(thiz, nativeHandleId, 0);
+    releasePipeline(pipeline);
+}
+
 JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_TriggerWord_bcModelDetect(
         JNIEnv *env,
         jobject thiz,
         jfloatArray audio) {
+    TriggerWordPipeline *pipeline = getPipeline(env, thiz);
+    if (pipeline == nullptr) {
+        LOG_ERROR("Trigger word is not initialized \n");
+        return NULL;
+    }
     rkai_trigger_word_result_t bc_detected_trigger_word_result;
     //prepare audio
     rkai_audio_t input_audio;
@@ -66,9 +216,19 @@ JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_TriggerWord_bcModelDetec
     input_audio.sample_rate = 8000;
     input_audio.format = RKAI_AUDIO_FORMAT_FLOAT;
     input_audio.n_channels = 1;
-    rkai_ret_t ret = rkai_trigger_word_detect(trigger_word_bc_handle, &input_audio,
-                                              triggerword_config_bc,
-                                              &bc_detected_trigger_word_result, 0.3, 0.6);
+    rkai_handle_t trigger_word_bc_handle;
+    rkai_ret_t ret = rkai_handle_pool_checkout(pipeline->bc_pool, TRIGGER_WORD_CHECKOUT_TIMEOUT_MS,
+                                               &trigger_word_bc_handle);
+    if (ret != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Cannot get a free handle for trigger word bc model \n");
+        env->ReleaseFloatArrayElements(audio, input_audio.data, JNI_ABORT);
+        return NULL;
+    }
+    ret = rkai_trigger_word_detect(trigger_word_bc_handle, &input_audio,
+                                   pipeline->config_bc,
+                                   &bc_detected_trigger_word_result, 0.3, 0.6);
+    rkai_handle_pool_checkin(pipeline->bc_pool, trigger_word_bc_handle);
+    env->ReleaseFloatArrayElements(audio, input_audio.data, JNI_ABORT);
     if (ret != RKAI_RET_SUCCESS) {
         LOG_ERROR("Cannot run inference session for trigger word bc model  \n");
         return NULL;
@@ -84,6 +244,11 @@ JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_TriggerWord_convModelDet
         JNIEnv *env,
         jobject thiz,
         jfloatArray audio) {
+    TriggerWordPipeline *pipeline = getPipeline(env, thiz);
+    if (pipeline == nullptr) {
+        LOG_ERROR("Trigger word is not initialized \n");
+        return NULL;
+    }
     rkai_trigger_word_result_t conv_detected_trigger_word_result;
     //prepare audio
     rkai_audio_t input_audio;
@@ -92,9 +257,19 @@ JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_TriggerWord_convModelDet
     input_audio.sample_rate = 8000;
     input_audio.format = RKAI_AUDIO_FORMAT_FLOAT;
     input_audio.n_channels = 1;
-    rkai_ret_t ret = rkai_trigger_word_detect(trigger_word_conv_handle, &input_audio,
-                                              triggerword_config_conv,
-                                              &conv_detected_trigger_word_result, 0.6, 0.7);
+    rkai_handle_t trigger_word_conv_handle;
+    rkai_ret_t ret = rkai_handle_pool_checkout(pipeline->conv_pool, TRIGGER_WORD_CHECKOUT_TIMEOUT_MS,
+                                               &trigger_word_conv_handle);
+    if (ret != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Cannot get a free handle for trigger word conv model \n");
+        env->ReleaseFloatArrayElements(audio, input_audio.data, JNI_ABORT);
+        return NULL;
+    }
+    ret = rkai_trigger_word_detect(trigger_word_conv_handle, &input_audio,
+                                   pipeline->config_conv,
+                                   &conv_detected_trigger_word_result, 0.6, 0.7);
+    rkai_handle_pool_checkin(pipeline->conv_pool, trigger_word_conv_handle);
+    env->ReleaseFloatArrayElements(audio, input_audio.data, JNI_ABORT);
     if (ret != RKAI_RET_SUCCESS) {
         LOG_ERROR("Cannot run inference session for trigger word conv model \n");
         return NULL;
@@ -106,4 +281,78 @@ JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_TriggerWord_convModelDet
                          conv_detected_trigger_word_result.pass_high_conf);
     return jObj;
 }
+
+JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_TriggerWord_cascadeDetect(
+        JNIEnv *env,
+        jobject thiz,
+        jfloatArray audio,
+        jint newSampleCount,
+        jfloat bcThreshold,
+        jfloat convThreshold) {
+    TriggerWordPipeline *pipeline = getPipeline(env, thiz);
+    if (pipeline == nullptr) {
+        LOG_ERROR("Trigger word cascade is not initialized \n");
+        return NULL;
+    }
+    //prepare audio
+    rkai_audio_t input_audio;
+    input_audio.data = env->GetFloatArrayElements(audio, 0);
+    input_audio.size = env->GetArrayLength(audio);
+    input_audio.sample_rate = 8000;
+    input_audio.format = RKAI_AUDIO_FORMAT_FLOAT;
+    input_audio.n_channels = 1;
+    rkai_cascade_result_t cascade_result;
+    memset(&cascade_result, 0, sizeof(rkai_cascade_result_t));
+    rkai_fusion_event_t event;
+    memset(&event, 0, sizeof(rkai_fusion_event_t));
+    rkai_ret_t ret = RKAI_RET_SUCCESS;
+    rkai_ret_t fusion_ret = RKAI_RET_SUCCESS;
+    {
+        std::lock_guard<std::mutex> lock(pipeline->cascade_mutex);
+        int is_active = 1;
+        rkai_energy_gate_process(pipeline->energy_gate, &input_audio, newSampleCount, &is_active);
+        // Windows skipped by the gate run no model and leave stage_count at 0
+        if (is_active) {
+            rkai_trigger_word_cascade_set_threshold(pipeline->cascade, 0, bcThreshold);
+            rkai_trigger_word_cascade_set_threshold(pipeline->cascade, 1, convThreshold);
+            ret = rkai_trigger_word_cascade_detect(pipeline->cascade, &input_audio, &cascade_result);
+        }
+        // The conv score is the keyword posterior, zero when the conv model did not run
+        float keyword_score = ret == RKAI_RET_SUCCESS && cascade_result.stage_count > 1 ? cascade_result.scores[1] : 0;
+        pipeline->stream_end += newSampleCount;
+        rkai_decision_fusion_set_thresholds(pipeline->fusion, 0, convThreshold,
+                                            std::max(0.0f, convThreshold - TRIGGER_WORD_FUSION_HYSTERESIS));
+        fusion_ret = rkai_decision_fusion_update(pipeline->fusion, &keyword_score,
+                                                 pipeline->stream_end - input_audio.size, &event);
+    }
+    env->ReleaseFloatArrayElements(audio, input_audio.data, JNI_ABORT);
+    if (ret != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Cannot run trigger word cascade \n");
+        return NULL;
+    }
+    // Score of the last stage run: the rejecting stage, or the conv model if detected
+    jobject jObj = env->NewObject(objCls, constructortorId, thiz);
+    if (cascade_result.stage_count > 0) {
+        env->SetFloatField(jObj, scoreId, cascade_result.scores[cascade_result.stage_count - 1]);
+    }
+    env->SetBooleanField(jObj, passLowThresholdId, cascade_result.stage_count > 1 || cascade_result.is_detected);
+    env->SetBooleanField(jObj, passHighThresholdId, cascade_result.is_detected);
+    env->SetIntField(jObj, stageCountId, cascade_result.stage_count);
+    // Without a fusion event the window triggers on its own cascade decision
+    env->SetBooleanField(jObj, isTriggeredId, fusion_ret == RKAI_RET_SUCCESS ? event.is_triggered
+                                                                           : cascade_result.is_detected);
+    return jObj;
+}
+
+JNIEXPORT jfloat JNICALL Java_com_example_smart_1robot_TriggerWord_gateSkipRate(
+        JNIEnv *env,
+        jobject thiz) {
+    TriggerWordPipeline *pipeline = getPipeline(env, thiz);
+    rkai_energy_gate_stats_t stats;
+    if (pipeline == nullptr || rkai_energy_gate_get_stats(pipeline->energy_gate, &stats) != RKAI_RET_SUCCESS ||
+        stats.window_count == 0) {
+        return 0;
+    }
+    return (jfloat) stats.skipped_count / stats.window_count;
+}
 }
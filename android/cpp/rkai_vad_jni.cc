@@ -3,17 +3,22 @@
 //
 #include <jni.h>
 #include <string>
+#include <atomic>
 #include <android/asset_manager_jni.h>
 #include "rkai.h"
-#include "android_fopen.h"
+#include "npu_scheduler.h"
 
-rkai_handle_t mRkaiVadHandle = nullptr;
+#define VAD_HANDLE_POOL_SIZE 2
+#define VAD_CHECKOUT_TIMEOUT_MS 500
+rkai_handle_pool_t mRkaiVadPool = nullptr;
 rkai_melspectrogram_config_t mVadModelConfig;
 
 static jclass objCls = NULL;
 static jmethodID constructortorId;
 static jfieldID scoreId;
 static jfieldID isSpeech;
+// Each exported segment gets its own dither noise
+static std::atomic<uint32_t> mDitherSeed(1);
 
 extern "C"
 {
@@ -22,10 +27,11 @@ JNIEXPORT void JNICALL Java_com_example_smart_1robot_VAD_initVADModel(
         jobject,
         jobject assetManager) {
     AAssetManager *mgr = AAssetManager_fromJava(env, assetManager);
-    android_fopen_set_asset_manager(mgr);
-    mRkaiVadHandle = rkai_create_handle();
-    rkai_init_vad_android_model(mRkaiVadHandle, mgr);
-    mVadModelConfig = rkai_get_vad_config();
+    rkai_handle_t vad_handle = rkai_create_handle();
+    rkai_init_vad_android_model(vad_handle, mgr);
+    rkai_scheduler_attach(getNpuScheduler(), vad_handle, RKAI_PRIORITY_AUDIO, kVadDeadlineMs, getVadCoreMask());
+    mRkaiVadPool = rkai_create_handle_pool(vad_handle, VAD_HANDLE_POOL_SIZE);
+    rkai_get_vad_config(vad_handle, &mVadModelConfig);
 
     jclass localObjCls = env->FindClass("com/example/smart_robot/VAD$Obj");
     objCls = reinterpret_cast<jclass>(env->NewGlobalRef(localObjCls));
@@ -50,16 +56,24 @@ JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_VAD_detectVAD(
     input_audio.sample_rate = mVadModelConfig.sample_rate;
     input_audio.format = RKAI_AUDIO_FORMAT_FLOAT;
     input_audio.n_channels = 1;
-    rkai_ret_t ret = rkai_vad_detect(mRkaiVadHandle,
-                                     &input_audio,
-                                     mVadModelConfig,
-                                     &vad_result,
-                                     0.5,
-                                     0.9);
+    rkai_handle_t vad_handle;
+    rkai_ret_t ret = rkai_handle_pool_checkout(mRkaiVadPool, VAD_CHECKOUT_TIMEOUT_MS, &vad_handle);
+    if (ret != RKAI_RET_SUCCESS) {
+        LOG_ERROR("Cannot get a free handle for vad model \n");
+        env->ReleaseFloatArrayElements(audio, input_audio.data, JNI_ABORT);
+        return nullptr;
+    }
+    ret = rkai_vad_detect(vad_handle,
+                          &input_audio,
+                          mVadModelConfig,
+                          &vad_result,
+                          0.5,
+                          0.9);
+    rkai_handle_pool_checkin(mRkaiVadPool, vad_handle);
+    env->ReleaseFloatArrayElements(audio, input_audio.data, JNI_ABORT);
 
     if (ret != RKAI_RET_SUCCESS) {
         LOG_ERROR("Cannot detect voice activity \n");
-        rkai_audio_release(&input_audio);
         return nullptr;
     }
 
@@ -68,5 +82,41 @@ JNIEXPORT jobject JNICALL Java_com_example_smart_1robot_VAD_detectVAD(
     env->SetBooleanField(jObj, isSpeech, vad_result.is_speech);
     return jObj;
 }
-}
 
+/**
+ * Convert float samples to little-endian PCM16 into a direct ByteBuffer, after a wav header if wavHeader.
+ * Returns the number of bytes written, -1 if the buffer is not direct or too small
+ */
+JNIEXPORT jint JNICALL Java_com_example_smart_1robot_VAD_encodePcm16(
+        JNIEnv *env,
+        jclass,
+        jfloatArray samples,
+        jint sampleRate,
+        jobject output,
+        jboolean wavHeader,
+        jboolean dither) {
+    uint8_t *out = (uint8_t *) env->GetDirectBufferAddress(output);
+    jlong outSize = env->GetDirectBufferCapacity(output);
+    if (out == nullptr || outSize < 0) {
+        LOG_ERROR("PCM16 output is not a direct buffer \n");
+        return -1;
+    }
+    rkai_pcm16_config_t config;
+    if (rkai_pcm16_default_config(sampleRate, &config) != RKAI_RET_SUCCESS) {
+        return -1;
+    }
+    config.wav_header = wavHeader;
+    config.dither = dither;
+    config.dither_seed = mDitherSeed.fetch_add(1);
+    jsize sampleNum = env->GetArrayLength(samples);
+    // No copy of the samples, nothing else runs until the release
+    float *data = (float *) env->GetPrimitiveArrayCritical(samples, nullptr);
+    if (data == nullptr) {
+        return -1;
+    }
+    int written = 0;
+    rkai_ret_t ret = rkai_pcm16_encode(&config, data, sampleNum, out, (int) outSize, &written);
+    env->ReleasePrimitiveArrayCritical(samples, data, JNI_ABORT);
+    return ret == RKAI_RET_SUCCESS ? written : -1;
+}
+}
@@ -0,0 +1,242 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <string.h>
+#include "logging_macros.h"
+#include "segment_encoder.h"
+
+// Samples given to libsndfile per write
+constexpr int32_t kEncodeBlockSize = 4096;
+
+/**
+ * Growable byte buffer behind SF_VIRTUAL_IO, writes past maxSize fail
+ */
+struct MemoryFile {
+    std::vector<uint8_t> *data;
+    sf_count_t maxSize;
+    sf_count_t position;
+    // Set when a write was refused, some codecs only write on close
+    bool isOverflow;
+};
+
+static sf_count_t memoryGetLength(void *userData) {
+    return (sf_count_t) ((MemoryFile *) userData)->data->size();
+}
+
+static sf_count_t memorySeek(sf_count_t offset, int whence, void *userData) {
+    MemoryFile *file = (MemoryFile *) userData;
+    sf_count_t position;
+    switch (whence) {
+        case SEEK_CUR:
+            position = file->position + offset;
+            break;
+        case SEEK_END:
+            position = (sf_count_t) file->data->size() + offset;
+            break;
+        default:
+            position = offset;
+            break;
+    }
+    if (position < 0 || position > file->maxSize) {
+        return -1;
+    }
+    file->position = position;
+    return position;
+}
+
+static sf_count_t memoryRead(void *ptr, sf_count_t count, void *userData) {
+    MemoryFile *file = (MemoryFile *) userData;
+    sf_count_t available = (sf_count_t) file->data->size() - file->position;
+    if (count > available) {
+        count = available > 0 ? available : 0;
+    }
+    memcpy(ptr, file->data->data() + file->position, (size_t) count);
+    file->position += count;
+    return count;
+}
+
+static sf_count_t memoryWrite(const void *ptr, sf_count_t count, void *userData) {
+    MemoryFile *file = (MemoryFile *) userData;
+    if (file->position + count > file->maxSize) {
+        file->isOverflow = true;
+        return 0;
+    }
+    if (file->position + count > (sf_count_t) file->data->size()) {
+        file->data->resize((size_t) (file->position + count));
+    }
+    memcpy(file->data->data() + file->position, ptr, (size_t) count);
+    file->position += count;
+    return count;
+}
+
+static sf_count_t memoryTell(void *userData) {
+    return ((MemoryFile *) userData)->position;
+}
+
+static SF_VIRTUAL_IO kMemoryIo = {memoryGetLength, memorySeek, memoryRead, memoryWrite, memoryTell};
+
+static SNDFILE *openMemoryFile(MemoryFile *file, int32_t sampleRate, int32_t channels) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    info.samplerate = sampleRate;
+    info.channels = channels;
+    info.format = SegmentEncoder::getFormat(sampleRate, channels);
+    SNDFILE *sndfile = sf_open_virtual(&kMemoryIo, SFM_WRITE, &info, file);
+    if (sndfile == nullptr) {
+        LOG_ERROR("Cannot open the in-memory encoder: %s", sf_strerror(nullptr));
+    }
+    return sndfile;
+}
+
+int SegmentEncoder::getFormat(int32_t sampleRate, int32_t channels) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    info.samplerate = sampleRate;
+    info.channels = channels;
+    info.format = SF_FORMAT_FLAC | SF_FORMAT_PCM_16;
+    if (sf_format_check(&info)) {
+        // A format check passes on builds without the codec, ask the library for its major formats
+        int count = 0;
+        sf_command(nullptr, SFC_GET_FORMAT_MAJOR_COUNT, &count, sizeof(int));
+        for (int i = 0; i < count; i++) {
+            SF_FORMAT_INFO formatInfo;
+            formatInfo.format = i;
+            sf_command(nullptr, SFC_GET_FORMAT_MAJOR, &formatInfo, sizeof(SF_FORMAT_INFO));
+            if (formatInfo.format == SF_FORMAT_FLAC) {
+                return SF_FORMAT_FLAC | SF_FORMAT_PCM_16;
+            }
+        }
+    }
+    return SF_FORMAT_CAF | SF_FORMAT_ALAC_16;
+}
+
+bool SegmentEncoder::encode(const int16_t *samples, int32_t numSamples, int32_t sampleRate, int32_t channels,
+                            std::vector<uint8_t> &output) {
+    output.clear();
+    MemoryFile file = {&output, INT32_MAX, 0, false};
+    SNDFILE *sndfile = openMemoryFile(&file, sampleRate, channels);
+    if (sndfile == nullptr) {
+        return false;
+    }
+    sf_count_t frames = numSamples / channels;
+    bool isWritten = sf_writef_short(sndfile, samples, frames) == frames;
+    // The header is completed on close
+    return sf_close(sndfile) == 0 && isWritten && !file.isOverflow;
+}
+
+SegmentEncoder::SegmentEncoder(int32_t sampleRate, int32_t channels, int32_t maxPendingSamples,
+                               int32_t maxOutputBytes) {
+    mSampleRate = sampleRate;
+    mChannels = channels;
+    mPending.resize(maxPendingSamples);
+    mMaxOutputBytes = maxOutputBytes;
+    mOutput.reserve(maxOutputBytes);
+}
+
+SegmentEncoder::~SegmentEncoder() {
+    std::vector<uint8_t> output;
+    finish(output);
+}
+
+bool SegmentEncoder::begin() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (isStreaming) {
+        LOG_WARN("Segment encoder is already streaming");
+        return false;
+    }
+    isStreaming = true;
+    isFinishing = false;
+    isFailed = false;
+    mPendingStart = 0;
+    mPendingCount = 0;
+    mDroppedSamples = 0;
+    mOutput.clear();
+    mWorker = std::thread(&SegmentEncoder::runWorker, this);
+    return true;
+}
+
+bool SegmentEncoder::append(const int16_t *samples, int32_t numSamples) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    int32_t capacity = (int32_t) mPending.size();
+    if (numSamples % mChannels != 0) {
+        LOG_ERROR("Segment encoder takes whole frames of %d channels", mChannels);
+        return false;
+    }
+    if (!isStreaming || mPendingCount + numSamples > capacity) {
+        // The worker is behind, the caller keeps the audio or drops it
+        mDroppedSamples += numSamples;
+        return false;
+    }
+    for (int32_t i = 0; i < numSamples; i++) {
+        mPending[(mPendingStart + mPendingCount + i) % capacity] = samples[i];
+    }
+    mPendingCount += numSamples;
+    mCondition.notify_one();
+    return true;
+}
+
+bool SegmentEncoder::append(const float *samples, int32_t numSamples) {
+    int16_t block[kEncodeBlockSize];
+    rkai_pcm16_config_t config;
+    rkai_pcm16_default_config(mSampleRate, &config);
+    for (int32_t done = 0; done < numSamples; done += kEncodeBlockSize) {
+        int32_t count = std::min(kEncodeBlockSize, numSamples - done);
+        int written = 0;
+        // Little-endian PCM16 is the int16_t layout on arm64
+        rkai_pcm16_encode(&config, samples + done, count, (uint8_t *) block, sizeof(block), &written);
+        if (!append(block, count)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SegmentEncoder::finish(std::vector<uint8_t> &output) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!isStreaming) {
+            return false;
+        }
+        isFinishing = true;
+        mCondition.notify_one();
+    }
+    mWorker.join();
+    std::lock_guard<std::mutex> lock(mMutex);
+    isStreaming = false;
+    output.assign(mOutput.begin(), mOutput.end());
+    return !isFailed;
+}
+
+void SegmentEncoder::runWorker() {
+    MemoryFile file = {&mOutput, mMaxOutputBytes, 0, false};
+    SNDFILE *sndfile = openMemoryFile(&file, mSampleRate, mChannels);
+    int16_t block[kEncodeBlockSize];
+    bool isWriteFailed = sndfile == nullptr;
+    while (!isWriteFailed) {
+        int32_t count;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this] { return mPendingCount > 0 || isFinishing; });
+            if (mPendingCount == 0) {
+                break;
+            }
+            int32_t capacity = (int32_t) mPending.size();
+            count = std::min(kEncodeBlockSize / mChannels * mChannels, mPendingCount);
+            for (int32_t i = 0; i < count; i++) {
+                block[i] = mPending[(mPendingStart + i) % capacity];
+            }
+            mPendingStart = (mPendingStart + count) % capacity;
+            mPendingCount -= count;
+        }
+        // Encoded out of the lock, append is not blocked by the codec
+        if (sf_writef_short(sndfile, block, count / mChannels) != count / mChannels) {
+            LOG_ERROR("Segment encoder output is full at %d bytes", mMaxOutputBytes);
+            isWriteFailed = true;
+        }
+    }
+    // The header is completed on close
+    bool isClosed = sndfile != nullptr && sf_close(sndfile) == 0;
+    std::lock_guard<std::mutex> lock(mMutex);
+    isFailed = isWriteFailed || !isClosed || file.isOverflow;
+}
@@ -0,0 +1,80 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_SEGMENT_ENCODER_H
+#define SMARTROBOT_SEGMENT_ENCODER_H
+
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sndfile.h>
+#include "rkai.h"
+
+/**
+ * Lossless in-memory compression of speech segments through libsndfile virtual I/O.
+ *
+ * FLAC when libsndfile is built with it, otherwise ALAC in CAF, which libsndfile always has. The samples are
+ * stored as PCM16, decoding gives back exactly the PCM16 of the input.
+ *
+ * A running stream is encoded on a worker thread: append copies the samples into a ring of maxPendingSamples and
+ * returns false when it is full, the output stops growing at maxOutputBytes. Both are allocated at construction.
+ */
+class SegmentEncoder {
+public:
+    SegmentEncoder(int32_t sampleRate, int32_t channels, int32_t maxPendingSamples, int32_t maxOutputBytes);
+
+    ~SegmentEncoder();
+
+    /**
+     * SF_FORMAT_FLAC if libsndfile is built with it, SF_FORMAT_CAF | SF_FORMAT_ALAC_16 otherwise
+     */
+    static int getFormat(int32_t sampleRate, int32_t channels);
+
+    /**
+     * Encode a whole segment on the calling thread
+     */
+    static bool encode(const int16_t *samples, int32_t numSamples, int32_t sampleRate, int32_t channels,
+                       std::vector<uint8_t> &output);
+
+    // Start a stream, the worker encodes what append gives until finish
+    bool begin();
+
+    bool append(const int16_t *samples, int32_t numSamples);
+
+    // Converted to PCM16 without dither, see rkai_pcm16_encode
+    bool append(const float *samples, int32_t numSamples);
+
+    // Wait for the worker to encode everything appended and take the encoded bytes
+    bool finish(std::vector<uint8_t> &output);
+
+    int64_t getDroppedSamples() const { return mDroppedSamples; };
+
+private:
+    const char *TAG = "SegmentEncoder:: %s";
+    int32_t mSampleRate;
+    int32_t mChannels;
+
+    // Ring of the samples appended and not encoded yet
+    std::vector<int16_t> mPending;
+    int32_t mPendingStart = 0;
+    int32_t mPendingCount = 0;
+    int64_t mDroppedSamples = 0;
+
+    // Encoded bytes, capacity fixed at construction
+    std::vector<uint8_t> mOutput;
+    int32_t mMaxOutputBytes;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread mWorker;
+    bool isStreaming = false;
+    bool isFinishing = false;
+    bool isFailed = false;
+
+    void runWorker();
+};
+
+#endif //SMARTROBOT_SEGMENT_ENCODER_H
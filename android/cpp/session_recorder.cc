@@ -0,0 +1,157 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "logging_macros.h"
+#include "session_recorder.h"
+
+// Silence given at once for a gap in the recorded audio
+constexpr int32_t kReplayGapBlock = 4096;
+// Longest sleep of a paced replay between two checks of stopReplay
+constexpr int64_t kReplayMaxSleepUs = 100000;
+
+SessionRecorder::~SessionRecorder() {
+    stopReplay();
+    stopRecording();
+}
+
+bool SessionRecorder::startRecording(const std::string &path, const rkai_session_config_t &config) {
+    rkai_session_writer_t writer = rkai_create_session_writer(path.c_str(), &config);
+    if (writer == nullptr) {
+        return false;
+    }
+    std::shared_ptr<std::remove_pointer<rkai_session_writer_t>::type> session(writer, [](rkai_session_writer_t w) {
+        rkai_session_stats_t stats;
+        rkai_session_get_stats(w, &stats);
+        rkai_release_session_writer(w);
+        LOG_INFO("Session closed, %llu chunks in %llu bytes, %llu chunks dropped",
+                 (unsigned long long) stats.chunk_count, (unsigned long long) stats.byte_count,
+                 (unsigned long long) stats.dropped_count);
+    });
+    // A session already recorded is closed once its last producer is done with it
+    std::atomic_store(&mWriter, session);
+    LOG_INFO("Recording session %s", path.c_str());
+    return true;
+}
+
+void SessionRecorder::stopRecording() {
+    std::atomic_store(&mWriter, std::shared_ptr<std::remove_pointer<rkai_session_writer_t>::type>());
+}
+
+void SessionRecorder::recordAudio(int64_t firstSample, const float *samples, int32_t numSamples) {
+    auto writer = std::atomic_load(&mWriter);
+    if (writer != nullptr) {
+        rkai_session_write_audio(writer.get(), SESSION_SOURCE_CAPTURE, firstSample, samples, numSamples);
+    }
+}
+
+void SessionRecorder::recordImage(int64_t frame, const rkai_image_t &image) {
+    auto writer = std::atomic_load(&mWriter);
+    if (writer != nullptr) {
+        rkai_session_write_image(writer.get(), SESSION_SOURCE_FACE, frame, &image);
+    }
+}
+
+void SessionRecorder::record(rkai_chunk_type type, SessionSource source, int64_t position, const void *payload,
+                             int size) {
+    auto writer = std::atomic_load(&mWriter);
+    if (writer != nullptr) {
+        rkai_session_write(writer.get(), type, source, position, -1, payload, size);
+    }
+}
+
+bool SessionRecorder::replay(const std::string &path, bool isPaced) {
+    isReplaying = true;
+    return runReplay(path, isPaced);
+}
+
+bool SessionRecorder::runReplay(const std::string &path, bool isPaced) {
+    rkai_session_reader_t reader = rkai_open_session_reader(path.c_str(), nullptr);
+    if (reader == nullptr) {
+        isReplaying = false;
+        return false;
+    }
+    LOG_INFO("Replaying session %s%s", path.c_str(), isPaced ? " at the recorded pace" : "");
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> payload;
+    std::vector<float> silence(kReplayGapBlock, 0.0f);
+    int64_t nextSample = -1;
+    int64_t chunkNum = 0;
+    rkai_chunk_header_t header;
+    int hasChunk = 0;
+    while (isReplaying && rkai_session_next_chunk(reader, &header, &hasChunk) == RKAI_RET_SUCCESS && hasChunk) {
+        payload.resize(header.size);
+        if (rkai_session_read_payload(reader, payload.data(), (int) payload.size()) != RKAI_RET_SUCCESS) {
+            LOG_WARN("Session %s ends in a chunk cut short", path.c_str());
+            break;
+        }
+        if (isPaced) {
+            auto due = start + std::chrono::microseconds(header.timestamp_us);
+            while (isReplaying && std::chrono::steady_clock::now() < due) {
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                        due - std::chrono::steady_clock::now(), std::chrono::microseconds(kReplayMaxSleepUs)));
+            }
+        }
+        chunkNum++;
+        if (header.type == RKAI_CHUNK_AUDIO) {
+            if (!mAudioListener) {
+                continue;
+            }
+            // The capture indices stay those of the recording
+            while (nextSample >= 0 && nextSample < header.position) {
+                int32_t count = (int32_t) std::min<int64_t>(kReplayGapBlock, header.position - nextSample);
+                mAudioListener(nextSample, silence.data(), count);
+                nextSample += count;
+            }
+            int32_t sampleNum = (int32_t) (header.size / sizeof(float));
+            mAudioListener(header.position, (const float *) payload.data(), sampleNum);
+            nextSample = header.position + sampleNum;
+        } else if (header.type == RKAI_CHUNK_IMAGE) {
+            rkai_chunk_image_t info;
+            if (!mFrameListener || header.size < sizeof(rkai_chunk_image_t)) {
+                continue;
+            }
+            memcpy(&info, payload.data(), sizeof(rkai_chunk_image_t));
+            rkai_image_t image;
+            memset(&image, 0, sizeof(rkai_image_t));
+            image.data = payload.data() + sizeof(rkai_chunk_image_t);
+            image.size = header.size - sizeof(rkai_chunk_image_t);
+            image.is_prealloc_buf = 1;
+            image.pixel_format = (rkai_pixel_format) info.pixel_format;
+            image.width = info.width;
+            image.height = info.height;
+            image.original_ratio = 1;
+            image.scale_ratio = 1;
+            mFrameListener(header.position, image);
+        } else if (mChunkListener) {
+            mChunkListener(header, payload.data());
+        }
+    }
+    rkai_release_session_reader(reader);
+    bool isComplete = isReplaying;
+    isReplaying = false;
+    LOG_INFO("Replayed %lld chunks of %s in %.1f s%s", (long long) chunkNum, path.c_str(),
+             std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+             isComplete ? "" : ", stopped");
+    return isComplete;
+}
+
+void SessionRecorder::startReplay(const std::string &path, bool isPaced) {
+    stopReplay();
+    // Set before the thread starts, a stopReplay right after is not missed
+    isReplaying = true;
+    mReplayThread = std::thread([this, path, isPaced]() {
+        runReplay(path, isPaced);
+    });
+}
+
+void SessionRecorder::stopReplay() {
+    isReplaying = false;
+    if (mReplayThread.joinable()) {
+        mReplayThread.join();
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_SESSION_RECORDER_H
+#define SMARTROBOT_SESSION_RECORDER_H
+
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "rkai.h"
+
+// Producers of the session chunks
+enum SessionSource {
+    SESSION_SOURCE_CAPTURE = 0,
+    SESSION_SOURCE_TRIGGER_WORD = 1,
+    SESSION_SOURCE_VAD = 2,
+    SESSION_SOURCE_FACE = 3,
+    SESSION_SOURCE_BEAMFORMER = 4,
+};
+
+/**
+ * Records the inputs and the decisions of the perception pipeline into a session file, see rkai_session.h, and
+ * replays it.
+ *
+ * While a session is recorded, the capture callback adds the audio, the face detection its frames, and each
+ * detector its per window outputs and its events. Adding a chunk copies it into the queue of the writer thread, it
+ * is dropped if the queue is full. With no session every record call returns at once.
+ *
+ * A replay reads a session and gives the recorded audio and frames to the listeners, at the recorded pace or as
+ * fast as possible, gaps left by dropped audio chunks are filled with silence. The recorded model outputs and
+ * events go to the chunk listener, to be compared with the ones of the replay.
+ */
+class SessionRecorder {
+public:
+    using AudioListener = std::function<void(int64_t firstSample, const float *samples, int32_t numSamples)>;
+    using FrameListener = std::function<void(int64_t frame, const rkai_image_t &image)>;
+    using ChunkListener = std::function<void(const rkai_chunk_header_t &header, const uint8_t *payload)>;
+
+    ~SessionRecorder();
+
+    bool startRecording(const std::string &path, const rkai_session_config_t &config);
+
+    void stopRecording();
+
+    bool isRecording() const { return std::atomic_load(&mWriter) != nullptr; };
+
+    // Can be called from any thread
+    void recordAudio(int64_t firstSample, const float *samples, int32_t numSamples);
+
+    void recordImage(int64_t frame, const rkai_image_t &image);
+
+    void record(rkai_chunk_type type, SessionSource source, int64_t position, const void *payload, int size);
+
+    // Set before a replay, called on the replay thread
+    void setAudioListener(AudioListener listener) { mAudioListener = listener; };
+
+    void setFrameListener(FrameListener listener) { mFrameListener = listener; };
+
+    void setChunkListener(ChunkListener listener) { mChunkListener = listener; };
+
+    /**
+     * Replay a session on the calling thread. Returns false if it cannot be read or the replay was stopped
+     */
+    bool replay(const std::string &path, bool isPaced);
+
+    // Replay on a thread of its own, a replay already running is stopped first
+    void startReplay(const std::string &path, bool isPaced);
+
+    void stopReplay();
+
+private:
+    const char *TAG = "SessionRecorder:: %s";
+
+    // Swapped atomically, a producer holding the writer keeps it alive until its chunk is queued
+    std::shared_ptr<std::remove_pointer<rkai_session_writer_t>::type> mWriter;
+
+    AudioListener mAudioListener;
+    FrameListener mFrameListener;
+    ChunkListener mChunkListener;
+    std::thread mReplayThread;
+    std::atomic<bool> isReplaying{false};
+
+    bool runReplay(const std::string &path, bool isPaced);
+};
+
+/**
+ * Recorder shared by the audio engine and the face detection, so a session holds both
+ */
+inline SessionRecorder &getSessionRecorder() {
+    static SessionRecorder recorder;
+    return recorder;
+}
+
+#endif //SMARTROBOT_SESSION_RECORDER_H
@@ -8,28 +8,14 @@
 
 int32_t SoundRecording::write(const float *sourceData, int32_t numSamples) {
 
-    // Check that data will fit, if it doesn't then create new array,
-    // copy over old data to new array then delete old array and
-    // point mData to new array.
-    if (mWriteIndex + numSamples > (kMaxSamples * mIteration)) {
-
-        mIteration++;
-
-        int32_t newSize = kMaxSamples * mIteration;
-
-        auto *newData = new float[newSize]{0};
-        std::copy(mData, mData + mTotalSamples, newData);
-
-        delete[] mData;
-        mData = newData;
-
-    }
-
+    // The oldest samples are overwritten, readers check the indices they get against getOldestIndex()
+    int64_t writeIndex = mWriteIndex;
+    mWritingIndex = writeIndex + numSamples;
     for (int i = 0; i < numSamples; ++i) {
-        mData[mWriteIndex++] = sourceData[i] * gain_factor;
+        mData[(writeIndex + i) % kMaxSamples] = sourceData[i] * gain_factor;
     }
-
-    mTotalSamples += numSamples;
+    // Published after the samples, a reader seeing the new index sees the data
+    mWriteIndex = writeIndex + numSamples;
 
     return numSamples;
 }
@@ -38,14 +24,26 @@ int32_t SoundRecording::read(float *targetData, int32_t numSamples) {
 
     int32_t framesRead = 0;
 
-    while (framesRead < numSamples && mReadIndex < mTotalSamples) {
-        targetData[framesRead++] = mData[mReadIndex++];
-        if (mIsLooping && mReadIndex == mTotalSamples) mReadIndex = 0;
+    if (mReadIndex < getOldestIndex()) mReadIndex = getOldestIndex();
+    while (framesRead < numSamples && mReadIndex < mWriteIndex) {
+        targetData[framesRead++] = mData[mReadIndex++ % kMaxSamples];
+        if (mIsLooping && mReadIndex == mWriteIndex) mReadIndex = getOldestIndex();
     }
 
     return framesRead;
 }
 
+bool SoundRecording::getData(float *targetData, int64_t start, int64_t end) {
+    if (start < getOldestIndex() || end > mWriteIndex) {
+        return false;
+    }
+    for (int64_t i = start; i < end; ++i) {
+        targetData[i - start] = mData[i % kMaxSamples];
+    }
+    // The writer may have wrapped over the start while copying
+    return start >= getOldestIndex();
+}
+
 SndfileHandle
 SoundRecording::createFile(const char *outfilename, int32_t outputChannels, int32_t sampleRate) {
     SndfileHandle file;
@@ -57,7 +55,7 @@ SoundRecording::createFile(const char *outfilename, int32_t outputChannels, int3
 void SoundRecording::writeFile(SndfileHandle sndfileHandle) {
     LOGD(TAG, "writeFile(): ");
 
-    int32_t framesRead = 0, bufferLength = mTotalSamples / 3;
+    int32_t framesRead = 0, bufferLength = getTotalSamples() / 3;
     sf_count_t framesWrite = 0;
 
     auto *buffer = new float[bufferLength];
@@ -6,6 +6,7 @@
 #define SMARTROBOT_SOUND_RECORDING_H
 
 #include <cstdint>
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <sndfile.hh>
@@ -19,6 +20,7 @@
 //#include "Utils.h"
 
 //constexpr int kMaxSamples = 8000; // 1s of audio data @ 8kHz float
+// Ring buffer length, the last 30 s @ 16kHz are kept
 constexpr int kMaxSamples = 480000;
 
 class SoundRecording {
@@ -27,6 +29,7 @@ public:
 
     int32_t read(float *targetData, int32_t numSamples);
 
+    // Only the samples the ring still holds are written, the last 30 s of the capture
     void initiateWritingToFile(const char *outfilename, int32_t outputChannels, int32_t sampleRate);
 
     SndfileHandle createFile(const char *outfilename, int32_t outputChannels, int32_t sampleRate);
@@ -35,32 +38,42 @@ public:
 
     void readFileInfo(const char *fileName);
 
-    bool isFull() const { return (mWriteIndex == kMaxSamples); };
+    bool isFull() const { return (mWriteIndex >= kMaxSamples); };
 
-    void setReadPositionToStart() { mReadIndex = 0; };
+    void setReadPositionToStart() { mReadIndex = getOldestIndex(); };
 
-    void clear() { mWriteIndex = 0; };
+    void clear() {
+        mWriteIndex = 0;
+        mWritingIndex = 0;
+        mReadIndex = 0;
+    };
 
     void setLooping(bool isLooping) { mIsLooping = isLooping; };
 
-    int32_t getLength() const { return mWriteIndex; };
+    // Number of samples written since the start, the absolute index of the next sample
+    int64_t getLength() const { return mWriteIndex; };
 
-    int32_t getTotalSamples() const { return mTotalSamples; };
+    // Absolute index of the oldest sample still in the buffer
+    int64_t getOldestIndex() const { return std::max<int64_t>(0, mWritingIndex - kMaxSamples); };
 
-    void getData(float *targetData, uint start, uint end) {
-        for (int i = start; i < end; ++i) {
-            targetData[i-start] = mData[i];
-        }
-    }
+    // Number of samples held in the buffer
+    int32_t getTotalSamples() const { return (int32_t) (mWriteIndex - getOldestIndex()); };
+
+    /**
+     * Copy the samples [start, end) given as absolute indices. Returns false if a part of them is not written yet
+     * or was overwritten, before or during the copy
+     */
+    bool getData(float *targetData, int64_t start, int64_t end);
 
     static const int32_t getMaxSamples() { return kMaxSamples; };
 private:
     const char *TAG = "SoundRecording:: %s";
 
-    std::atomic<int32_t> mIteration{1};
-    std::atomic<int32_t> mWriteIndex{0};
-    std::atomic<int32_t> mReadIndex{0};
-    std::atomic<int32_t> mTotalSamples{0};
+    // Absolute indices, the sample i is stored at mData[i % kMaxSamples]
+    std::atomic<int64_t> mWriteIndex{0};
+    // End of the block being written, its samples are overwritten before mWriteIndex moves
+    std::atomic<int64_t> mWritingIndex{0};
+    std::atomic<int64_t> mReadIndex{0};
     std::atomic<bool> mIsLooping{false};
 
     float *mData = new float[kMaxSamples]{0};
@@ -0,0 +1,262 @@
+//
+// Created on 19/10/2026.
+//
+
+// Runs the echo canceller of the app over captures made during playback and reports the echo return loss
+// enhancement, the double talk detection and the processing cost.
+//
+//  aec_eval --mixes DIR [--synthesize] [--burst N] [--tail-ms N] [--step F] [--output DIR]
+//
+// A mix is DIR/name.far.wav, the played reference, and DIR/name.mic.wav, the capture, see echo_mix.h. With
+// --synthesize the synthetic mixes are written to DIR first. The mixes with name.echo.wav and name.near.wav are
+// scored against their known echo and near end speech, the others by the enhancement the canceller measures.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "echo_mix.h"
+#include "rkai.h"
+
+constexpr int32_t kSampleRate = 16000;
+// Frames the metrics are computed on
+constexpr int32_t kFrameSamples = kSampleRate / 50;
+// A frame has echo or near end speech above this level, dBFS
+constexpr float kActiveLevelDb = -50;
+// A frame has no near end speech under this level, dBFS
+constexpr float kSilentLevelDb = -70;
+// The first seconds of a mix are left out of the enhancement, the filter converges
+constexpr float kConvergenceSeconds = 3;
+
+struct EvalOptions {
+    std::string mixes;
+    std::string output;
+    bool isSynthesized = false;
+    // Samples per call, the burst of the capture callback
+    int burst = 192;
+    int tailMs = 128;
+    float step = 0;
+};
+
+/**
+ * Outcome of one mix, the sums are over the frames of each kind
+ */
+struct MixResult {
+    bool isOk = false;
+    double seconds = 0;
+    double processSeconds = 0;
+    int64_t blockNum = 0;
+    // Echo only frames after the convergence
+    double echoCapture = 0;
+    double echoOutput = 0;
+    int64_t echoFrameNum = 0;
+    int64_t falseDoubleTalkNum = 0;
+    // Frames with echo and near end speech
+    double doubleTalkEcho = 0;
+    double doubleTalkResidual = 0;
+    int64_t doubleTalkFrameNum = 0;
+    int64_t detectedDoubleTalkNum = 0;
+    // Frames with near end speech only
+    double nearSpeech = 0;
+    double nearDistortion = 0;
+    rkai_echo_canceller_stats_t stats;
+};
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: aec_eval --mixes DIR [options]\n"
+            "  --synthesize           write the synthetic mixes to DIR first\n"
+            "  --burst N              samples per call of the canceller (default 192)\n"
+            "  --tail-ms N            echo tail of the filter (default 128)\n"
+            "  --step F               step size of the filter (default of the canceller)\n"
+            "  --output DIR           write the output of the canceller to DIR/name.aec.wav\n");
+}
+
+static bool parseOptions(int argc, char **argv, EvalOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        if (name == "--synthesize") {
+            options.isSynthesized = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", name.c_str());
+            return false;
+        }
+        const char *value = argv[++i];
+        if (name == "--mixes") {
+            options.mixes = value;
+        } else if (name == "--burst") {
+            options.burst = std::max(1, atoi(value));
+        } else if (name == "--tail-ms") {
+            options.tailMs = std::max(1, atoi(value));
+        } else if (name == "--step") {
+            options.step = (float) atof(value);
+        } else if (name == "--output") {
+            options.output = value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    return !options.mixes.empty();
+}
+
+static double sumOfSquares(const float *samples, int size) {
+    double sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += (double) samples[i] * samples[i];
+    }
+    return sum;
+}
+
+static double levelDb(double sum, int size) {
+    return 10 * log10(std::max(sum / size, 1e-12));
+}
+
+static double ratioDb(double numerator, double denominator) {
+    return denominator > 0 && numerator > 0 ? 10 * log10(numerator / denominator) : 0;
+}
+
+static MixResult evaluateMix(const std::string &stem, const EvalOptions &options) {
+    MixResult result;
+    EchoMix mix;
+    if (!readMix(stem, kSampleRate, mix)) {
+        return result;
+    }
+    rkai_echo_canceller_config_t config;
+    rkai_echo_canceller_default_config(kSampleRate, &config);
+    config.filter_length = options.tailMs * kSampleRate / 1000;
+    if (options.step > 0) {
+        config.step_size = options.step;
+    }
+    rkai_echo_canceller_t canceller = rkai_create_echo_canceller(&config);
+    if (canceller == nullptr) {
+        return result;
+    }
+    int64_t length = (int64_t) mix.mic.size();
+    std::vector<float> output(length);
+    // Double talk decision of each sample, from the call that gave it
+    std::vector<uint8_t> doubleTalk(length);
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < length; i += options.burst) {
+        int size = (int) std::min<int64_t>(options.burst, length - i);
+        int isDoubleTalk = 0;
+        rkai_echo_canceller_process(canceller, mix.mic.data() + i, mix.far.data() + i, size, output.data() + i,
+                                    &isDoubleTalk);
+        std::fill(doubleTalk.begin() + i, doubleTalk.begin() + i + size, (uint8_t) isDoubleTalk);
+    }
+    result.processSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    rkai_echo_canceller_get_stats(canceller, &result.stats);
+    rkai_release_echo_canceller(canceller);
+    result.seconds = (double) length / kSampleRate;
+    result.blockNum = (int64_t) result.stats.block_count;
+
+    // The output lags the capture by one block
+    int latency = config.block_size;
+    output.erase(output.begin(), output.begin() + latency);
+    output.resize(length, 0.0f);
+    if (!options.output.empty()) {
+        std::string name = stem.substr(stem.find_last_of('/') + 1);
+        writeWav(options.output + "/" + name + ".aec.wav", kSampleRate, output);
+    }
+
+    bool isKnown = !mix.echo.empty();
+    std::vector<float> residual(kFrameSamples);
+    for (int64_t frame = 0; frame + kFrameSamples <= length - latency; frame += kFrameSamples) {
+        const float *capture = mix.mic.data() + frame;
+        const float *cleaned = output.data() + frame;
+        double captureSum = sumOfSquares(capture, kFrameSamples);
+        double outputSum = sumOfSquares(cleaned, kFrameSamples);
+        bool isDoubleTalkDecided = doubleTalk[frame + latency] != 0;
+        if (!isKnown) {
+            // Without the parts, the frames with reference are echo frames
+            bool hasFar = levelDb(sumOfSquares(mix.far.data() + frame, kFrameSamples), kFrameSamples) > kActiveLevelDb;
+            if (hasFar && frame >= kConvergenceSeconds * kSampleRate) {
+                result.echoCapture += captureSum;
+                result.echoOutput += outputSum;
+                result.echoFrameNum++;
+                result.falseDoubleTalkNum += isDoubleTalkDecided;
+            }
+            continue;
+        }
+        double echoSum = sumOfSquares(mix.echo.data() + frame, kFrameSamples);
+        double nearSum = sumOfSquares(mix.near.data() + frame, kFrameSamples);
+        for (int i = 0; i < kFrameSamples; i++) {
+            residual[i] = cleaned[i] - mix.near[frame + i];
+        }
+        double residualSum = sumOfSquares(residual.data(), kFrameSamples);
+        bool hasEcho = levelDb(echoSum, kFrameSamples) > kActiveLevelDb;
+        bool hasNear = levelDb(nearSum, kFrameSamples) > kActiveLevelDb;
+        bool isNearSilent = levelDb(nearSum, kFrameSamples) < kSilentLevelDb;
+        if (hasEcho && isNearSilent && frame >= kConvergenceSeconds * kSampleRate) {
+            result.echoCapture += captureSum;
+            result.echoOutput += outputSum;
+            result.echoFrameNum++;
+            result.falseDoubleTalkNum += isDoubleTalkDecided;
+        } else if (hasEcho && hasNear) {
+            result.doubleTalkEcho += echoSum;
+            result.doubleTalkResidual += residualSum;
+            result.doubleTalkFrameNum++;
+            result.detectedDoubleTalkNum += isDoubleTalkDecided;
+        } else if (hasNear && levelDb(echoSum, kFrameSamples) < kSilentLevelDb) {
+            result.nearSpeech += nearSum;
+            result.nearDistortion += residualSum;
+        }
+    }
+    result.isOk = true;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    EvalOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    if (options.isSynthesized && !writeSyntheticMixes(options.mixes, kSampleRate)) {
+        return 1;
+    }
+    std::vector<std::string> stems;
+    if (!listMixes(options.mixes, stems)) {
+        return 1;
+    }
+    if (stems.empty()) {
+        fprintf(stderr, "No mix in %s\n", options.mixes.c_str());
+        return 1;
+    }
+
+    int failedNum = 0;
+    double seconds = 0;
+    double processSeconds = 0;
+    int64_t blockNum = 0;
+    printf("%-24s %9s %9s %9s %9s %9s %9s %7s\n", "mix", "erle dB", "dt erle", "dt found", "false dt", "near snr",
+           "delay", "copies");
+    for (const std::string &stem : stems) {
+        MixResult result = evaluateMix(stem, options);
+        std::string name = stem.substr(stem.find_last_of('/') + 1);
+        if (!result.isOk) {
+            failedNum++;
+            fprintf(stderr, "%s: not evaluated\n", stem.c_str());
+            continue;
+        }
+        printf("%-24s %9.1f %9.1f %8.0f%% %8.1f%% %9.1f %9d %7llu\n", name.c_str(),
+               ratioDb(result.echoCapture, result.echoOutput),
+               ratioDb(result.doubleTalkEcho, result.doubleTalkResidual),
+               result.doubleTalkFrameNum > 0 ? 100.0 * result.detectedDoubleTalkNum / result.doubleTalkFrameNum : 0,
+               result.echoFrameNum > 0 ? 100.0 * result.falseDoubleTalkNum / result.echoFrameNum : 0,
+               ratioDb(result.nearSpeech, result.nearDistortion), result.stats.delay,
+               (unsigned long long) result.stats.filter_copy_count);
+        seconds += result.seconds;
+        processSeconds += result.processSeconds;
+        blockNum += result.blockNum;
+    }
+    rkai_echo_canceller_config_t config;
+    rkai_echo_canceller_default_config(kSampleRate, &config);
+    printf("%zu mixes, %.1f s, %d ms blocks, %d ms tail, real-time factor %.4f, %.1f us per block\n",
+           stems.size() - failedNum, seconds, config.block_size * 1000 / kSampleRate, options.tailMs,
+           seconds > 0 ? processSeconds / seconds : 0, blockNum > 0 ? processSeconds * 1e6 / blockNum : 0);
+    return failedNum > 0 ? 1 : 0;
+}
@@ -0,0 +1,283 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <sndfile.h>
+#include "echo_mix.h"
+
+// Frames read from libsndfile at once
+constexpr sf_count_t kReadBlockFrames = 4096;
+// Length of a synthetic mix
+constexpr float kMixSeconds = 30;
+// Levels of the synthetic signals, dBFS over the speech
+constexpr float kFarLevelDb = -20;
+constexpr float kEchoLevelDb = -22;
+constexpr float kNearLevelDb = -26;
+constexpr float kNoiseLevelDb = -65;
+// Energy of the reverberation relative to the direct path
+constexpr float kReverbEnergy = 0.25f;
+// Knee of the speaker clipping, about 10 dB over the far end level
+constexpr float kClipLevel = 0.3f;
+
+static bool endsWith(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool listMixes(const std::string &directory, std::vector<std::string> &stems) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        fprintf(stderr, "Cannot open the mix directory %s\n", directory.c_str());
+        return false;
+    }
+    stems.clear();
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".mic.wav")) {
+            stems.push_back(directory + "/" + name.substr(0, name.size() - 8));
+        }
+    }
+    closedir(dir);
+    std::sort(stems.begin(), stems.end());
+    return true;
+}
+
+static bool readWav(const std::string &path, int32_t sampleRate, std::vector<float> &samples, bool isOptional) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    SNDFILE *sndfile = sf_open(path.c_str(), SFM_READ, &info);
+    if (sndfile == nullptr) {
+        if (!isOptional) {
+            fprintf(stderr, "Cannot open %s: %s\n", path.c_str(), sf_strerror(nullptr));
+        }
+        return isOptional;
+    }
+    if (info.samplerate != sampleRate) {
+        fprintf(stderr, "%s is at %d Hz, the canceller runs at %d Hz\n", path.c_str(), info.samplerate, sampleRate);
+        sf_close(sndfile);
+        return false;
+    }
+    samples.clear();
+    samples.reserve((size_t) info.frames);
+    std::vector<float> block((size_t) (kReadBlockFrames * info.channels));
+    sf_count_t frames;
+    while ((frames = sf_readf_float(sndfile, block.data(), kReadBlockFrames)) > 0) {
+        for (sf_count_t i = 0; i < frames; i++) {
+            float sum = 0;
+            for (int c = 0; c < info.channels; c++) {
+                sum += block[i * info.channels + c];
+            }
+            samples.push_back(sum / info.channels);
+        }
+    }
+    sf_close(sndfile);
+    return true;
+}
+
+bool readMix(const std::string &stem, int32_t sampleRate, EchoMix &mix) {
+    mix.stem = stem;
+    if (!readWav(stem + ".far.wav", sampleRate, mix.far, false) ||
+        !readWav(stem + ".mic.wav", sampleRate, mix.mic, false) ||
+        !readWav(stem + ".echo.wav", sampleRate, mix.echo, true) ||
+        !readWav(stem + ".near.wav", sampleRate, mix.near, true)) {
+        return false;
+    }
+    // The capture decides the length, a short reference is silence after its end
+    mix.far.resize(mix.mic.size(), 0.0f);
+    if (!mix.echo.empty() && !mix.near.empty()) {
+        mix.echo.resize(mix.mic.size(), 0.0f);
+        mix.near.resize(mix.mic.size(), 0.0f);
+    } else {
+        mix.echo.clear();
+        mix.near.clear();
+    }
+    return true;
+}
+
+bool writeWav(const std::string &path, int32_t sampleRate, const std::vector<float> &samples) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    info.samplerate = sampleRate;
+    info.channels = 1;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE *sndfile = sf_open(path.c_str(), SFM_WRITE, &info);
+    if (sndfile == nullptr) {
+        fprintf(stderr, "Cannot create %s: %s\n", path.c_str(), sf_strerror(nullptr));
+        return false;
+    }
+    bool isOk = sf_writef_float(sndfile, samples.data(), (sf_count_t) samples.size()) == (sf_count_t) samples.size();
+    sf_close(sndfile);
+    return isOk;
+}
+
+/**
+ * Two pole resonator of a formant
+ */
+struct Resonator {
+    float a1 = 0, a2 = 0, gain = 0, y1 = 0, y2 = 0;
+
+    void set(float frequency, float bandwidth, int32_t sampleRate) {
+        float r = expf((float) -M_PI * bandwidth / sampleRate);
+        a1 = 2 * r * cosf(2 * (float) M_PI * frequency / sampleRate);
+        a2 = -r * r;
+        gain = 1 - r;
+    }
+
+    float process(float x) {
+        float y = gain * x + a1 * y1 + a2 * y2;
+        y2 = y1;
+        y1 = y;
+        return y;
+    }
+};
+
+void scaleToLevel(std::vector<float> &samples, float levelDb) {
+    double sum = 0;
+    int64_t count = 0;
+    for (float sample : samples) {
+        // The level of the speech, not of the pauses
+        if (sample != 0) {
+            sum += sample * sample;
+            count++;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+    float gain = powf(10.0f, levelDb / 20) / (float) sqrt(sum / count);
+    for (float &sample : samples) {
+        sample *= gain;
+    }
+}
+
+std::vector<float> synthesizeSpeech(int32_t sampleRate, float seconds, float pitchHz, uint32_t seed,
+                                           float start, float end) {
+    static const float kVowels[5][3] = {{730, 1090, 2440}, {270, 2290, 3010}, {300, 870, 2240},
+                                        {530, 1840, 2480}, {570, 840,  2410}};
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    std::vector<float> samples((size_t) (seconds * sampleRate), 0.0f);
+    Resonator formants[3];
+    int64_t position = (int64_t) (start * sampleRate);
+    int64_t last = std::min<int64_t>((int64_t) samples.size(), (int64_t) (end * sampleRate));
+    float phase = 0;
+    while (position < last) {
+        // A talk spurt of syllables, then a pause
+        int64_t spurtEnd = std::min<int64_t>(last, position + (int64_t) ((1.5f + 2.5f * uniform(random)) * sampleRate));
+        while (position < spurtEnd) {
+            int64_t length = (int64_t) ((0.12f + 0.16f * uniform(random)) * sampleRate);
+            const float *vowel = kVowels[random() % 5];
+            for (int f = 0; f < 3; f++) {
+                formants[f].set(vowel[f] * (0.9f + 0.2f * uniform(random)), 80.0f + 40 * f, sampleRate);
+            }
+            bool isFricative = uniform(random) < 0.3f;
+            float pitch = pitchHz * (0.8f + 0.4f * uniform(random));
+            for (int64_t i = 0; i < length && position + i < spurtEnd; i++) {
+                float envelope = 0.5f - 0.5f * cosf(2 * (float) M_PI * i / length);
+                float source;
+                if (isFricative && i < length / 3) {
+                    source = (uniform(random) - 0.5f) * 0.5f;
+                } else {
+                    // Glottal pulses, the pitch glides down over the syllable
+                    phase += pitch * (1 - 0.15f * i / length) / sampleRate;
+                    source = phase >= 1 ? 1.0f : 0.0f;
+                    phase -= floorf(phase);
+                }
+                float sample = 0;
+                for (int f = 0; f < 3; f++) {
+                    sample += formants[f].process(source) / (f + 1);
+                }
+                samples[position + i] = envelope * sample;
+            }
+            position += length;
+        }
+        position += (int64_t) ((0.3f + 1.2f * uniform(random)) * sampleRate);
+    }
+    return samples;
+}
+
+/**
+ * Echo path from the speaker to the microphone: a direct path, then a reverberation decaying by 60 dB in rt60
+ */
+static std::vector<float> roomResponse(int32_t sampleRate, float rt60, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::normal_distribution<float> normal(0, 1);
+    int length = (int) (std::max(0.05f, rt60) * sampleRate);
+    std::vector<float> response(length, 0.0f);
+    int direct = sampleRate / 1000;
+    response[direct] = 1;
+    float decay = 6.9f / (rt60 * sampleRate);
+    // The speaker is next to the microphone, the reverberation is about 6 dB under the direct path
+    float gain = sqrtf(kReverbEnergy * 2 * decay);
+    for (int i = direct + sampleRate / 500; i < length; i++) {
+        response[i] = gain * normal(random) * expf(-decay * (i - direct));
+    }
+    return response;
+}
+
+static void convolve(const std::vector<float> &input, const std::vector<float> &response, int64_t start,
+                     int64_t end, int delay, std::vector<float> &output) {
+    for (int64_t n = start; n < end; n++) {
+        float sum = 0;
+        for (size_t k = 0; k < response.size(); k++) {
+            int64_t i = n - delay - (int64_t) k;
+            if (i < 0) {
+                break;
+            }
+            sum += response[k] * input[i];
+        }
+        output[n] = sum;
+    }
+}
+
+/**
+ * One synthetic mix: the reference goes through the speaker (clipped if asked) and the room, the echo path and the
+ * delay behind the reference can change half way through
+ */
+static bool writeMix(const std::string &stem, int32_t sampleRate, float nearStart, float nearEnd, float rt60,
+                     bool isPathChanged, int delayMs, int changedDelayMs, bool isClipped) {
+    int64_t length = (int64_t) (kMixSeconds * sampleRate);
+    int64_t half = length / 2;
+    std::vector<float> far = synthesizeSpeech(sampleRate, kMixSeconds, 120, 1, 0.5f, kMixSeconds);
+    std::vector<float> near = synthesizeSpeech(sampleRate, kMixSeconds, 210, 2, nearStart, nearEnd);
+    scaleToLevel(far, kFarLevelDb);
+    scaleToLevel(near, kNearLevelDb);
+    std::vector<float> played = far;
+    if (isClipped) {
+        // Soft clipping of an overdriven speaker on the speech peaks
+        for (float &sample : played) {
+            sample = kClipLevel * tanhf(sample / kClipLevel);
+        }
+    }
+    std::vector<float> first = roomResponse(sampleRate, rt60, 3);
+    std::vector<float> second = isPathChanged ? roomResponse(sampleRate, rt60, 4) : first;
+    std::vector<float> echo(length, 0.0f);
+    convolve(played, first, 0, half, delayMs * sampleRate / 1000, echo);
+    convolve(played, second, half, length, changedDelayMs * sampleRate / 1000, echo);
+    scaleToLevel(echo, kEchoLevelDb);
+    std::mt19937 random(5);
+    std::normal_distribution<float> noise(0, powf(10.0f, kNoiseLevelDb / 20));
+    std::vector<float> mic(length);
+    for (int64_t i = 0; i < length; i++) {
+        mic[i] = echo[i] + near[i] + noise(random);
+    }
+    return writeWav(stem + ".far.wav", sampleRate, far) && writeWav(stem + ".mic.wav", sampleRate, mic) &&
+           writeWav(stem + ".echo.wav", sampleRate, echo) && writeWav(stem + ".near.wav", sampleRate, near);
+}
+
+bool writeSyntheticMixes(const std::string &directory, int32_t sampleRate) {
+    // Near end speech out of the mix
+    float none = kMixSeconds;
+    return writeMix(directory + "/echo_only", sampleRate, none, none, 0.15f, false, 120, 120, false) &&
+           writeMix(directory + "/double_talk", sampleRate, 8, 22, 0.15f, false, 120, 120, false) &&
+           writeMix(directory + "/path_change", sampleRate, none, none, 0.15f, true, 120, 120, false) &&
+           writeMix(directory + "/delay_change", sampleRate, none, none, 0.15f, false, 120, 180, false) &&
+           writeMix(directory + "/clipped_speaker", sampleRate, none, none, 0.15f, false, 120, 120, true) &&
+           writeMix(directory + "/long_tail", sampleRate, none, none, 0.4f, false, 120, 120, false);
+}
@@ -0,0 +1,53 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_ECHO_MIX_H
+#define SMARTROBOT_ECHO_MIX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A capture during playback and its parts, named after the stem: stem.far.wav is the played reference and
+ * stem.mic.wav the capture. The synthetic mixes also have stem.echo.wav and stem.near.wav, the echo and the near
+ * end speech the capture is the sum of, so the residual echo is known
+ */
+struct EchoMix {
+    std::string stem;
+    std::vector<float> far;
+    std::vector<float> mic;
+    std::vector<float> echo;
+    std::vector<float> near;
+};
+
+/**
+ * The stems of the DIR/<name>.mic.wav files with a DIR/<name>.far.wav, sorted by path
+ */
+bool listMixes(const std::string &directory, std::vector<std::string> &stems);
+
+/**
+ * Read the mix of a stem, the echo and near parts are left empty if they are missing
+ */
+bool readMix(const std::string &stem, int32_t sampleRate, EchoMix &mix);
+
+bool writeWav(const std::string &path, int32_t sampleRate, const std::vector<float> &samples);
+
+/**
+ * Voiced syllables on a pitch contour through vowel formants, with noise bursts for the consonants. The talk spurts
+ * and pauses are random, a speaker only talks in [start, end) seconds
+ */
+std::vector<float> synthesizeSpeech(int32_t sampleRate, float seconds, float pitchHz, uint32_t seed, float start,
+                                    float end);
+
+// Scale the samples to a level in dBFS over the non zero ones, the speech without its pauses
+void scaleToLevel(std::vector<float> &samples, float levelDb);
+
+/**
+ * Write the synthetic mixes to a directory: formant synthesized speech played through a room response, with near
+ * end speech, echo path and delay changes, a clipping speaker and a tail longer than the filter
+ */
+bool writeSyntheticMixes(const std::string &directory, int32_t sampleRate);
+
+#endif //SMARTROBOT_ECHO_MIX_H
@@ -0,0 +1,289 @@
+//
+// Created on 19/10/2026.
+//
+
+// Checks that the priors generated from FACE_DETECT_ANCHOR_CONFIG are the ones of the legacy anchor file of the face
+// detection model: same count, same model input size in the header, and every value within the rounding of the file.
+// rkai_load_anchor_file, the parser of RKAI_ANCHOR_FROM_FILE, must read the file as is.
+//
+//  anchor_check [--file PATH] [--tolerance T] [--repeat N]
+//
+// The file is "num_anchors array_size width height" then one "cx cy w h" line per prior, rounded to 4 decimals.
+//
+// Both ways of building the priors at the init of the detector are also measured: the time of rkai_load_anchor_file
+// and rkai_generate_anchors over N runs, and the stack each of them touches. The file goes through the host stand-in
+// of the asset reads, not AAsset.
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include "host_assets.h"
+#include "rkai_anchor.h"
+
+#ifndef ANCHOR_CHECK_FILE
+#define ANCHOR_CHECK_FILE "anchor_information.txt"
+#endif
+
+// Stack of the measuring thread, and the pattern it is filled with before the run
+constexpr size_t kMeasureStackSize = 1 << 20;
+constexpr unsigned char kStackFill = 0xa5;
+
+struct CheckOptions {
+    std::string file = ANCHOR_CHECK_FILE;
+    // Half of the last decimal of the file, and some margin for the float rounding of the generator
+    double tolerance = 5.1e-5;
+    int repeat = 200;
+};
+
+// Builds the priors as the init of the detector does
+typedef std::function<rkai_ret_t(anchors_t *)> AnchorBuilder;
+
+/**
+ * A build on the measuring thread
+ */
+struct StackRun {
+    const AnchorBuilder *build;
+    rkai_ret_t ret;
+};
+
+/**
+ * The legacy anchor file
+ */
+struct AnchorFile {
+    int anchorNum = 0;
+    int arraySize = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<float> values;
+};
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: anchor_check [options]\n"
+            "  --file PATH            anchor file (default %s)\n"
+            "  --tolerance T          largest difference allowed (default 5.1e-5)\n"
+            "  --repeat N             timed builds of the priors (default 200)\n", ANCHOR_CHECK_FILE);
+}
+
+static bool parseOptions(int argc, char **argv, CheckOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", name.c_str());
+            return false;
+        }
+        const char *value = argv[++i];
+        if (name == "--file") {
+            options.file = value;
+        } else if (name == "--tolerance") {
+            options.tolerance = atof(value);
+        } else if (name == "--repeat") {
+            options.repeat = std::max(1, atoi(value));
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readAnchorFile(const std::string &path, AnchorFile &anchors) {
+    FILE *file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return false;
+    }
+    bool isOk = fscanf(file, "%d %d %d %d", &anchors.anchorNum, &anchors.arraySize, &anchors.width,
+                       &anchors.height) == 4 && anchors.anchorNum > 0;
+    float value;
+    while (isOk && fscanf(file, "%f", &value) == 1) {
+        anchors.values.push_back(value);
+    }
+    fclose(file);
+    if (!isOk) {
+        fprintf(stderr, "Bad header in %s\n", path.c_str());
+    }
+    return isOk;
+}
+
+/**
+ * The asset name of a file for rkai_load_anchor_file, its directory is the root of the host assets
+ */
+static std::string assetOf(const std::string &file) {
+    size_t slash = file.find_last_of('/');
+    hostAssetsSetRoot(slash == std::string::npos ? "." : file.substr(0, slash));
+    return slash == std::string::npos ? file : file.substr(slash + 1);
+}
+
+/**
+ * Mean time of a build in microseconds, and the shortest one in minUs. -1 if a build fails
+ */
+static double timeBuild(const AnchorBuilder &build, int repeat, double *minUs) {
+    double totalUs = 0;
+    *minUs = HUGE_VAL;
+    for (int i = 0; i < repeat; i++) {
+        anchors_t anchors = {};
+        auto begin = std::chrono::steady_clock::now();
+        rkai_ret_t ret = build(&anchors);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+        free(anchors.data);
+        if (ret != RKAI_RET_SUCCESS) {
+            return -1;
+        }
+        totalUs += us;
+        *minUs = std::min(*minUs, us);
+    }
+    return totalUs / repeat;
+}
+
+static void *runOnStack(void *arg) {
+    StackRun *run = (StackRun *) arg;
+    if (run->build != nullptr) {
+        anchors_t anchors = {};
+        run->ret = (*run->build)(&anchors);
+        free(anchors.data);
+    }
+    return nullptr;
+}
+
+/**
+ * Bytes of stack a thread running the build touches: the stack is filled with a pattern, and the deepest byte
+ * changed is found from its bottom. Without a build, the thread only touches what it needs to start. -1 if the
+ * thread cannot run
+ */
+static long stackHighWater(const AnchorBuilder *build, rkai_ret_t *ret) {
+    void *stack = nullptr;
+    if (posix_memalign(&stack, 4096, kMeasureStackSize) != 0) {
+        return -1;
+    }
+    std::fill((unsigned char *) stack, (unsigned char *) stack + kMeasureStackSize, kStackFill);
+    StackRun run = {build, RKAI_RET_SUCCESS};
+    pthread_attr_t attr;
+    pthread_t thread;
+    bool isRun = pthread_attr_init(&attr) == 0 && pthread_attr_setstack(&attr, stack, kMeasureStackSize) == 0 &&
+                 pthread_create(&thread, &attr, runOnStack, &run) == 0;
+    pthread_attr_destroy(&attr);
+    if (isRun) {
+        pthread_join(thread, nullptr);
+    }
+    // The stack grows down, the bytes left at the bottom were never reached
+    size_t untouched = 0;
+    while (untouched < kMeasureStackSize && ((unsigned char *) stack)[untouched] == kStackFill) {
+        untouched++;
+    }
+    free(stack);
+    *ret = run.ret;
+    return isRun ? (long) (kMeasureStackSize - untouched) : -1;
+}
+
+/**
+ * Time and stack of both ways of building the priors
+ */
+static bool measureBuilds(const CheckOptions &options) {
+    std::string assetName = assetOf(options.file);
+    const AnchorBuilder builds[2] = {
+            [&assetName](anchors_t *anchors) {
+                rkai_size_t inputSize;
+                return rkai_load_anchor_file(nullptr, assetName.c_str(), anchors, &inputSize);
+            },
+            [](anchors_t *anchors) {
+                return rkai_generate_anchors(&FACE_DETECT_ANCHOR_CONFIG, anchors);
+            }};
+    const char *names[2] = {"file", "generated"};
+
+    rkai_ret_t ret;
+    long emptyBytes = stackHighWater(nullptr, &ret);
+    bool isOk = emptyBytes >= 0;
+    printf("build of the priors, mean and shortest of %d runs, stack touched over an empty thread\n",
+           options.repeat);
+    for (int i = 0; isOk && i < 2; i++) {
+        double minUs;
+        double meanUs = timeBuild(builds[i], options.repeat, &minUs);
+        long bytes = stackHighWater(&builds[i], &ret);
+        isOk = meanUs >= 0 && bytes >= 0 && ret == RKAI_RET_SUCCESS;
+        if (isOk) {
+            printf("%-13s %8.1f us %8.1f us %8ld bytes\n", names[i], meanUs, minUs, bytes - emptyBytes);
+        }
+    }
+    if (!isOk) {
+        printf("Cannot measure the builds of the priors\n");
+    }
+    return isOk;
+}
+
+/**
+ * rkai_load_anchor_file reads the values and the input size of the file as they are
+ */
+static bool checkLoadedFile(const CheckOptions &options, const AnchorFile &expected) {
+    std::string assetName = assetOf(options.file);
+    anchors_t loaded = {};
+    rkai_size_t inputSize = {};
+    bool isOk = rkai_load_anchor_file(nullptr, assetName.c_str(), &loaded, &inputSize) == RKAI_RET_SUCCESS &&
+                loaded.num_anchors == expected.anchorNum && inputSize.w == expected.width &&
+                inputSize.h == expected.height && loaded.anchors_array_size == (int) expected.values.size() &&
+                std::equal(expected.values.begin(), expected.values.end(), loaded.data);
+    free(loaded.data);
+    printf("loaded file   %s\n", isOk ? "as read" : "DIFFERENT");
+    return isOk;
+}
+
+int main(int argc, char **argv) {
+    CheckOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    AnchorFile expected;
+    if (!readAnchorFile(options.file, expected)) {
+        return 2;
+    }
+    anchors_t generated = {};
+    if (rkai_generate_anchors(&FACE_DETECT_ANCHOR_CONFIG, &generated) != RKAI_RET_SUCCESS) {
+        fprintf(stderr, "Cannot generate the anchors\n");
+        return 2;
+    }
+
+    bool isOk = true;
+    printf("                    file  generated\n");
+    printf("anchors       %10d %10d\n", expected.anchorNum, generated.num_anchors);
+    printf("values        %10zu %10d\n", expected.values.size(), generated.anchors_array_size);
+    printf("input size    %6dx%d %6dx%d\n", expected.width, expected.height, FACE_DETECT_ANCHOR_CONFIG.image_width,
+           FACE_DETECT_ANCHOR_CONFIG.image_height);
+    if (expected.anchorNum != generated.num_anchors || expected.arraySize != generated.anchors_array_size ||
+        (int) expected.values.size() != generated.anchors_array_size) {
+        printf("The anchor counts differ\n");
+        isOk = false;
+    }
+    if (expected.width != FACE_DETECT_ANCHOR_CONFIG.image_width ||
+        expected.height != FACE_DETECT_ANCHOR_CONFIG.image_height) {
+        printf("The model input sizes differ\n");
+        isOk = false;
+    }
+
+    int count = std::min((int) expected.values.size(), generated.anchors_array_size);
+    double maxDiff = 0;
+    int maxIndex = 0;
+    for (int i = 0; i < count; i++) {
+        double diff = fabs((double) expected.values[i] - generated.data[i]);
+        if (diff > maxDiff) {
+            maxDiff = diff;
+            maxIndex = i;
+        }
+    }
+    printf("max diff      %10.1e at anchor %d value %d\n", maxDiff, maxIndex / 4, maxIndex % 4);
+    if (maxDiff > options.tolerance) {
+        printf("The anchors differ by more than %.1e\n", options.tolerance);
+        isOk = false;
+    }
+    free(generated.data);
+    isOk = checkLoadedFile(options, expected) && isOk;
+    isOk = measureBuilds(options) && isOk;
+    printf("%s anchors\n", isOk ? "PASS" : "FAIL");
+    return isOk ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <sndfile.h>
+#include "array_scene.h"
+#include "echo_mix.h"
+
+// Speed of sound of the simulation, m/s
+constexpr float kSoundSpeed = 343.0f;
+// Length of a synthetic scene
+constexpr float kSceneSeconds = 12;
+// Level of the talker, dBFS over the speech
+constexpr float kSpeechLevelDb = -26;
+// Independent noise of each microphone, dBFS
+constexpr float kSensorNoiseDb = -60;
+// Taps of the simulated delays on each side, longer than the ones of the beamformer
+constexpr int kDelayHalfTaps = 32;
+// Delay of the direct path, keeps every microphone delay positive, in samples
+constexpr int kBaseDelay = kDelayHalfTaps + 8;
+
+static bool endsWith(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool listScenes(const std::string &directory, std::vector<std::string> &stems) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        fprintf(stderr, "Cannot open the scene directory %s\n", directory.c_str());
+        return false;
+    }
+    stems.clear();
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".scene")) {
+            stems.push_back(directory + "/" + name.substr(0, name.size() - 6));
+        }
+    }
+    closedir(dir);
+    std::sort(stems.begin(), stems.end());
+    return true;
+}
+
+static bool readDescription(const std::string &path, ArrayScene &scene) {
+    FILE *file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return false;
+    }
+    char line[256];
+    bool hasAngle = false;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        float x, y;
+        if (sscanf(line, " mic %f %f", &x, &y) == 2) {
+            scene.micX.push_back(x);
+            scene.micY.push_back(y);
+        } else if (sscanf(line, " angle %f", &x) == 1) {
+            scene.angle = x;
+            hasAngle = true;
+        }
+    }
+    fclose(file);
+    scene.channelCount = (int) scene.micX.size();
+    if (scene.channelCount < 2 || !hasAngle) {
+        fprintf(stderr, "%s needs two mic lines and an angle line\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool readWav(const std::string &path, int32_t sampleRate, int channelCount, std::vector<float> &samples,
+                    bool isOptional) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    SNDFILE *sndfile = sf_open(path.c_str(), SFM_READ, &info);
+    if (sndfile == nullptr) {
+        if (!isOptional) {
+            fprintf(stderr, "Cannot open %s: %s\n", path.c_str(), sf_strerror(nullptr));
+        }
+        return isOptional;
+    }
+    if (info.samplerate != sampleRate || info.channels != channelCount) {
+        fprintf(stderr, "%s has %d channels at %d Hz, the scene has %d microphones at %d Hz\n", path.c_str(),
+                info.channels, info.samplerate, channelCount, sampleRate);
+        sf_close(sndfile);
+        return false;
+    }
+    samples.resize((size_t) (info.frames * channelCount));
+    sf_count_t frames = sf_readf_float(sndfile, samples.data(), info.frames);
+    samples.resize((size_t) (frames * channelCount));
+    sf_close(sndfile);
+    return true;
+}
+
+bool readScene(const std::string &stem, int32_t sampleRate, ArrayScene &scene) {
+    scene.stem = stem;
+    if (!readDescription(stem + ".scene", scene) ||
+        !readWav(stem + ".wav", sampleRate, scene.channelCount, scene.capture, false) ||
+        !readWav(stem + ".speech.wav", sampleRate, scene.channelCount, scene.speech, true) ||
+        !readWav(stem + ".noise.wav", sampleRate, scene.channelCount, scene.noise, true)) {
+        return false;
+    }
+    if (scene.speech.size() != scene.capture.size() || scene.noise.size() != scene.capture.size()) {
+        scene.speech.clear();
+        scene.noise.clear();
+    }
+    return true;
+}
+
+static bool writeWav(const std::string &path, int32_t sampleRate, int channelCount, const std::vector<float> &samples) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    info.samplerate = sampleRate;
+    info.channels = channelCount;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE *sndfile = sf_open(path.c_str(), SFM_WRITE, &info);
+    if (sndfile == nullptr) {
+        fprintf(stderr, "Cannot create %s: %s\n", path.c_str(), sf_strerror(nullptr));
+        return false;
+    }
+    sf_count_t frames = (sf_count_t) (samples.size() / channelCount);
+    bool isOk = sf_writef_float(sndfile, samples.data(), frames) == frames;
+    sf_close(sndfile);
+    return isOk;
+}
+
+/**
+ * A plane wave reaching the array: the direction it comes from, its delay and gain relative to the direct path
+ */
+struct Arrival {
+    float angle;
+    float delayMs;
+    float gain;
+};
+
+/**
+ * Add the source as it reaches each microphone from the directions of the arrivals, with fractional delays
+ */
+static void addArrivals(const std::vector<float> &source, const std::vector<float> &micX,
+                        const std::vector<float> &micY, const std::vector<Arrival> &arrivals, int32_t sampleRate,
+                        std::vector<float> &capture) {
+    int channelCount = (int) micX.size();
+    int64_t length = (int64_t) source.size();
+    std::vector<float> taps(2 * kDelayHalfTaps + 1);
+    for (const Arrival &arrival : arrivals) {
+        float radians = arrival.angle * (float) M_PI / 180;
+        for (int c = 0; c < channelCount; c++) {
+            float advance = (micX[c] * cosf(radians) + micY[c] * sinf(radians)) * sampleRate / kSoundSpeed;
+            float delay = kBaseDelay + arrival.delayMs * sampleRate / 1000 - advance;
+            int whole = (int) floorf(delay);
+            float fraction = delay - whole;
+            // Blackman windowed sinc, tap k delays by whole - kDelayHalfTaps + k samples
+            for (int k = 0; k <= 2 * kDelayHalfTaps; k++) {
+                float t = k - kDelayHalfTaps - fraction;
+                float sinc = fabsf(t) < 1e-6f ? 1.0f : sinf((float) M_PI * t) / ((float) M_PI * t);
+                float phase = (float) M_PI * (t + kDelayHalfTaps + 1) / (kDelayHalfTaps + 1);
+                float window = 0.42f - 0.5f * cosf(phase) + 0.08f * cosf(2 * phase);
+                taps[k] = arrival.gain * sinc * std::max(0.0f, window);
+            }
+            for (int64_t n = 0; n < length; n++) {
+                float sum = 0;
+                for (int k = 0; k <= 2 * kDelayHalfTaps; k++) {
+                    int64_t i = n - (whole - kDelayHalfTaps + k);
+                    if (i >= 0 && i < length) {
+                        sum += taps[k] * source[i];
+                    }
+                }
+                capture[n * channelCount + c] += sum;
+            }
+        }
+    }
+}
+
+/**
+ * Direct path from angle then reflections from random directions, decaying with their delay
+ */
+static std::vector<Arrival> roomArrivals(float angle, int reflectionNum, float reflectionGain, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    std::vector<Arrival> arrivals = {{angle, 0, 1}};
+    for (int r = 0; r < reflectionNum; r++) {
+        float delayMs = 3 + 22 * uniform(random);
+        arrivals.push_back({360 * uniform(random), delayMs, reflectionGain * expf(-delayMs / 20)});
+    }
+    return arrivals;
+}
+
+static double channelEnergy(const std::vector<float> &samples, int channelCount, int channel) {
+    double sum = 0;
+    for (size_t i = channel; i < samples.size(); i += channelCount) {
+        sum += (double) samples[i] * samples[i];
+    }
+    return sum;
+}
+
+/**
+ * One synthetic scene: a talker at angle and a noise source at noiseAngle, the noise set snrDb under the speech on
+ * the first microphone
+ */
+static bool writeScene(const std::string &stem, int32_t sampleRate, const std::vector<float> &micX,
+                       const std::vector<float> &micY, float angle, float noiseAngle, float snrDb,
+                       float reflectionGain) {
+    int channelCount = (int) micX.size();
+    int64_t length = (int64_t) (kSceneSeconds * sampleRate);
+    std::vector<float> talker = synthesizeSpeech(sampleRate, kSceneSeconds, 170, 7, 0.5f, kSceneSeconds);
+    scaleToLevel(talker, kSpeechLevelDb);
+    // Fan or television like noise, white with a low frequency hum
+    std::mt19937 random(11);
+    std::normal_distribution<float> normal(0, 1);
+    std::vector<float> source(length);
+    float lowpass = 0;
+    for (int64_t i = 0; i < length; i++) {
+        float white = normal(random);
+        lowpass = 0.95f * lowpass + 0.05f * white;
+        source[i] = 0.3f * white + 3 * lowpass;
+    }
+    std::vector<float> speech(length * channelCount, 0.0f);
+    std::vector<float> noise(length * channelCount, 0.0f);
+    addArrivals(talker, micX, micY, roomArrivals(angle, 6, reflectionGain, 3), sampleRate, speech);
+    addArrivals(source, micX, micY, roomArrivals(noiseAngle, 4, reflectionGain, 4), sampleRate, noise);
+    float noiseGain = (float) sqrt(channelEnergy(speech, channelCount, 0) / channelEnergy(noise, channelCount, 0) /
+                                   pow(10.0, snrDb / 10));
+    std::normal_distribution<float> sensor(0, powf(10.0f, kSensorNoiseDb / 20));
+    std::vector<float> capture(length * channelCount);
+    for (size_t i = 0; i < noise.size(); i++) {
+        noise[i] = noise[i] * noiseGain + sensor(random);
+        capture[i] = speech[i] + noise[i];
+    }
+    FILE *file = fopen((stem + ".scene").c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot create %s.scene\n", stem.c_str());
+        return false;
+    }
+    for (int c = 0; c < channelCount; c++) {
+        fprintf(file, "mic %.4f %.4f\n", micX[c], micY[c]);
+    }
+    fprintf(file, "angle %.1f\n", angle);
+    fclose(file);
+    return writeWav(stem + ".wav", sampleRate, channelCount, capture) &&
+           writeWav(stem + ".speech.wav", sampleRate, channelCount, speech) &&
+           writeWav(stem + ".noise.wav", sampleRate, channelCount, noise);
+}
+
+bool writeSyntheticScenes(const std::string &directory, int32_t sampleRate) {
+    // 6 cm pair, 4 cm spaced line, square of 3.2 cm radius
+    std::vector<float> pairX = {-0.03f, 0.03f};
+    std::vector<float> pairY = {0, 0};
+    std::vector<float> lineX = {-0.06f, -0.02f, 0.02f, 0.06f};
+    std::vector<float> lineY = {0, 0, 0, 0};
+    std::vector<float> squareX = {0.032f, 0, -0.032f, 0};
+    std::vector<float> squareY = {0, 0.032f, 0, -0.032f};
+    return writeScene(directory + "/pair_60", sampleRate, pairX, pairY, 60, 150, 5, 0.4f) &&
+           writeScene(directory + "/line_30", sampleRate, lineX, lineY, 30, 110, 5, 0.4f) &&
+           writeScene(directory + "/line_135", sampleRate, lineX, lineY, 135, 20, 5, 0.4f) &&
+           writeScene(directory + "/square_45", sampleRate, squareX, squareY, 45, 250, 5, 0.4f) &&
+           writeScene(directory + "/square_200", sampleRate, squareX, squareY, 200, 80, 5, 0.4f) &&
+           writeScene(directory + "/square_300_reverberant", sampleRate, squareX, squareY, 300, 160, 0, 0.8f);
+}
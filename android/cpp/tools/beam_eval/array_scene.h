@@ -0,0 +1,46 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_ARRAY_SCENE_H
+#define SMARTROBOT_ARRAY_SCENE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A multichannel capture of a talker at a known direction, named after the stem: stem.scene is the text description,
+ * "mic <x> <y>" per microphone in meters in the channel order and "angle <degrees>" for the talker, and stem.wav the
+ * interleaved capture. The synthetic scenes also have stem.speech.wav and stem.noise.wav, the talker and the noise
+ * the capture is the sum of, so the beam gain is known
+ */
+struct ArrayScene {
+    std::string stem;
+    std::vector<float> micX;
+    std::vector<float> micY;
+    float angle = 0;
+    int channelCount = 0;
+    // Interleaved frames
+    std::vector<float> capture;
+    std::vector<float> speech;
+    std::vector<float> noise;
+};
+
+/**
+ * The stems of the DIR/<name>.scene files, sorted by path
+ */
+bool listScenes(const std::string &directory, std::vector<std::string> &stems);
+
+/**
+ * Read the scene of a stem, the speech and noise parts are left empty if they are missing
+ */
+bool readScene(const std::string &stem, int32_t sampleRate, ArrayScene &scene);
+
+/**
+ * Write the synthetic scenes to a directory: formant synthesized speech from a direction, a noise source from
+ * another one, early reflections and sensor noise, on two and four microphone linear arrays and a square array
+ */
+bool writeSyntheticScenes(const std::string &directory, int32_t sampleRate);
+
+#endif //SMARTROBOT_ARRAY_SCENE_H
@@ -0,0 +1,299 @@
+//
+// Created on 19/10/2026.
+//
+
+// Runs the beamformer of the app over multichannel captures of a talker at a known direction and reports the error
+// of the direction estimates, the gain of the beam on the talker over the noise and the processing cost.
+//
+//  beam_eval --scenes DIR [--synthesize] [--burst N] [--angles N] [--output DIR]
+//
+// A scene is DIR/name.scene, the array and the talker direction, and DIR/name.wav, the capture, see array_scene.h.
+// With --synthesize the synthetic scenes are written to DIR first. The estimates are scored where the talker is
+// louder than the noise when the scene has name.speech.wav and name.noise.wav, everywhere otherwise.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "array_scene.h"
+#include "echo_mix.h"
+#include "rkai.h"
+
+constexpr int32_t kSampleRate = 16000;
+// Span of the direction queries, about a trigger word
+constexpr int32_t kQuerySamples = kSampleRate;
+// An estimate within this many degrees of the talker is a hit
+constexpr float kHitDegrees = 10;
+
+struct EvalOptions {
+    std::string scenes;
+    std::string output;
+    bool isSynthesized = false;
+    // Frames per call, the burst of the capture callback
+    int burst = 160;
+    int angleCount = 0;
+};
+
+/**
+ * Outcome of one scene
+ */
+struct SceneResult {
+    bool isOk = false;
+    double seconds = 0;
+    double processSeconds = 0;
+    int64_t frameNum = 0;
+    std::vector<float> estimateErrors;
+    std::vector<float> queryErrors;
+    float gainDb = NAN;
+    rkai_beamformer_stats_t stats;
+};
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: beam_eval --scenes DIR [options]\n"
+            "  --synthesize           write the synthetic scenes to DIR first\n"
+            "  --burst N              frames per call of the beamformer (default 160)\n"
+            "  --angles N             candidate directions (default of the beamformer)\n"
+            "  --output DIR           write the beam steered by the estimates to DIR/name.beam.wav\n");
+}
+
+static bool parseOptions(int argc, char **argv, EvalOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        if (name == "--synthesize") {
+            options.isSynthesized = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", name.c_str());
+            return false;
+        }
+        const char *value = argv[++i];
+        if (name == "--scenes") {
+            options.scenes = value;
+        } else if (name == "--burst") {
+            options.burst = std::max(1, atoi(value));
+        } else if (name == "--angles") {
+            options.angleCount = std::max(4, atoi(value));
+        } else if (name == "--output") {
+            options.output = value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    return !options.scenes.empty();
+}
+
+static float wrapAngle(float angle) {
+    angle = fmodf(angle, 360.0f);
+    return angle < 0 ? angle + 360.0f : angle;
+}
+
+static float angleDistance(float first, float second) {
+    float distance = wrapAngle(first - second);
+    return std::min(distance, 360.0f - distance);
+}
+
+/**
+ * Error of an estimate, a linear array gives the mirror of the talker across its axis as well
+ */
+static float angleError(const ArrayScene &scene, float estimate) {
+    float error = angleDistance(estimate, scene.angle);
+    float axisX = scene.micX.back() - scene.micX[0];
+    float axisY = scene.micY.back() - scene.micY[0];
+    float aperture = axisX * axisX + axisY * axisY;
+    for (int c = 1; c < scene.channelCount; c++) {
+        float cross = axisX * (scene.micY[c] - scene.micY[0]) - axisY * (scene.micX[c] - scene.micX[0]);
+        if (fabsf(cross) > 1e-3f * aperture) {
+            return error;
+        }
+    }
+    float axisAngle = atan2f(axisY, axisX) * 180 / (float) M_PI;
+    return std::min(error, angleDistance(estimate, 2 * axisAngle - scene.angle));
+}
+
+static double channelEnergy(const std::vector<float> &samples, int channelCount, int64_t start, int64_t end) {
+    double sum = 0;
+    for (int64_t n = std::max<int64_t>(0, start); n < end; n++) {
+        sum += (double) samples[n * channelCount] * samples[n * channelCount];
+    }
+    return sum;
+}
+
+static double energy(const std::vector<float> &samples) {
+    double sum = 0;
+    for (float sample : samples) {
+        sum += (double) sample * sample;
+    }
+    return sum;
+}
+
+static float median(std::vector<float> values) {
+    if (values.empty()) {
+        return NAN;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static bool configure(const ArrayScene &scene, const EvalOptions &options, rkai_beamformer_config_t &config) {
+    if (scene.channelCount > RKAI_BEAMFORMER_MAX_CHANNELS) {
+        fprintf(stderr, "%s has more than %d microphones\n", scene.stem.c_str(), RKAI_BEAMFORMER_MAX_CHANNELS);
+        return false;
+    }
+    rkai_beamformer_default_config(kSampleRate, &config);
+    config.channel_count = scene.channelCount;
+    for (int c = 0; c < scene.channelCount; c++) {
+        config.mic_x[c] = scene.micX[c];
+        config.mic_y[c] = scene.micY[c];
+    }
+    if (options.angleCount > 0) {
+        config.angle_count = options.angleCount;
+    }
+    return true;
+}
+
+/**
+ * Output of a beam fixed on the talker
+ */
+static std::vector<float> fixedBeam(const rkai_beamformer_config_t &trackingConfig, float angle,
+                                    const std::vector<float> &input) {
+    rkai_beamformer_config_t config = trackingConfig;
+    config.look_angle = angle;
+    config.steer_confidence = 2;
+    rkai_beamformer_t beamformer = rkai_create_beamformer(&config);
+    std::vector<float> output(input.size() / config.channel_count);
+    rkai_beamformer_process(beamformer, input.data(), (int) output.size(), output.data());
+    rkai_release_beamformer(beamformer);
+    return output;
+}
+
+static SceneResult evaluateScene(const std::string &stem, const EvalOptions &options) {
+    SceneResult result;
+    ArrayScene scene;
+    rkai_beamformer_config_t config;
+    if (!readScene(stem, kSampleRate, scene) || !configure(scene, options, config)) {
+        return result;
+    }
+    rkai_beamformer_t beamformer = rkai_create_beamformer(&config);
+    if (beamformer == nullptr) {
+        return result;
+    }
+    int channelCount = scene.channelCount;
+    int64_t length = (int64_t) scene.capture.size() / channelCount;
+    bool isKnown = !scene.speech.empty();
+    int hop = config.frame_size / 2;
+    // The talker dominates the frames of an estimate or of a query
+    auto isTalking = [&](int64_t start, int64_t end) {
+        return !isKnown || channelEnergy(scene.speech, channelCount, start, end) >
+                           channelEnergy(scene.noise, channelCount, start, end);
+    };
+    std::vector<float> output(length);
+    uint64_t estimateCount = 0;
+    int64_t nextQuery = kQuerySamples;
+    double processSeconds = 0;
+    int burst = std::min(options.burst, hop);
+    for (int64_t i = 0; i < length; i += burst) {
+        int size = (int) std::min<int64_t>(burst, length - i);
+        auto start = std::chrono::steady_clock::now();
+        rkai_beamformer_process(beamformer, scene.capture.data() + i * channelCount, size, output.data() + i);
+        processSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rkai_beamformer_stats_t stats;
+        rkai_beamformer_get_stats(beamformer, &stats);
+        if (stats.estimate_count > estimateCount) {
+            estimateCount = stats.estimate_count;
+            // Calls are at most a hop long, the estimate ended on the last hop boundary
+            int64_t position = (i + size) / hop * hop;
+            if (isTalking(position - config.frame_size, position)) {
+                result.estimateErrors.push_back(angleError(scene, stats.angle));
+            }
+        }
+        if (i + size >= nextQuery) {
+            rkai_beamformer_direction_t direction;
+            rkai_beamformer_get_direction(beamformer, nextQuery - kQuerySamples, nextQuery, &direction);
+            if (direction.estimate_count > 0 && isTalking(nextQuery - kQuerySamples, nextQuery)) {
+                result.queryErrors.push_back(angleError(scene, direction.angle));
+            }
+            nextQuery += kQuerySamples;
+        }
+    }
+    rkai_beamformer_get_stats(beamformer, &result.stats);
+    rkai_release_beamformer(beamformer);
+    result.processSeconds = processSeconds;
+    result.seconds = (double) length / kSampleRate;
+    result.frameNum = length;
+    if (!options.output.empty()) {
+        std::string name = stem.substr(stem.find_last_of('/') + 1);
+        writeWav(options.output + "/" + name + ".beam.wav", kSampleRate, output);
+    }
+    if (isKnown) {
+        // The beam is linear, the parts go through it apart
+        std::vector<float> speech = fixedBeam(config, scene.angle, scene.speech);
+        std::vector<float> noise = fixedBeam(config, scene.angle, scene.noise);
+        double inputSnr = channelEnergy(scene.speech, channelCount, 0, length) /
+                          channelEnergy(scene.noise, channelCount, 0, length);
+        result.gainDb = (float) (10 * log10(energy(speech) / energy(noise) / inputSnr));
+    }
+    result.isOk = true;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    EvalOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    if (options.isSynthesized && !writeSyntheticScenes(options.scenes, kSampleRate)) {
+        return 1;
+    }
+    std::vector<std::string> stems;
+    if (!listScenes(options.scenes, stems)) {
+        return 1;
+    }
+    if (stems.empty()) {
+        fprintf(stderr, "No scene in %s\n", options.scenes.c_str());
+        return 1;
+    }
+
+    int failedNum = 0;
+    double seconds = 0;
+    double processSeconds = 0;
+    int64_t frameNum = 0;
+    int64_t channelFrameNum = 0;
+    printf("%-24s %5s %9s %9s %9s %9s %9s %7s %9s\n", "scene", "mics", "estimated", "frame err", "hits", "1 s err",
+           "1 s hits", "steers", "gain dB");
+    for (const std::string &stem : stems) {
+        SceneResult result = evaluateScene(stem, options);
+        std::string name = stem.substr(stem.find_last_of('/') + 1);
+        if (!result.isOk) {
+            failedNum++;
+            fprintf(stderr, "%s: not evaluated\n", stem.c_str());
+            continue;
+        }
+        auto hitRate = [](const std::vector<float> &errors) {
+            int64_t hitNum = std::count_if(errors.begin(), errors.end(), [](float error) {
+                return error <= kHitDegrees;
+            });
+            return errors.empty() ? 0.0 : 100.0 * hitNum / errors.size();
+        };
+        int64_t hopNum = result.frameNum / (result.stats.config.frame_size / 2);
+        printf("%-24s %5d %8.0f%% %9.1f %8.0f%% %9.1f %8.0f%% %7llu %9.1f\n", name.c_str(),
+               result.stats.config.channel_count, hopNum > 0 ? 100.0 * result.stats.estimate_count / hopNum : 0,
+               median(result.estimateErrors), hitRate(result.estimateErrors),
+               median(result.queryErrors), hitRate(result.queryErrors),
+               (unsigned long long) result.stats.steer_count, result.gainDb);
+        seconds += result.seconds;
+        processSeconds += result.processSeconds;
+        frameNum += result.frameNum;
+        channelFrameNum += result.frameNum * result.stats.config.channel_count;
+    }
+    printf("%zu scenes, %.1f s, real-time factor %.4f, %.1f us per 10 ms, %.1f ns per frame, %.1f ns per sample\n",
+           stems.size() - failedNum, seconds, seconds > 0 ? processSeconds / seconds : 0,
+           seconds > 0 ? processSeconds * 1e4 / seconds : 0, frameNum > 0 ? processSeconds * 1e9 / frameNum : 0,
+           channelFrameNum > 0 ? processSeconds * 1e9 / channelFrameNum : 0);
+    return failedNum > 0 ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <sndfile.h>
+#include "corpus.h"
+
+// Frames read from libsndfile at once
+constexpr sf_count_t kReadBlockFrames = 4096;
+
+static bool endsWith(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool listCorpus(const std::string &directory, std::vector<CorpusFile> &files) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        fprintf(stderr, "Cannot open the corpus directory %s\n", directory.c_str());
+        return false;
+    }
+    files.clear();
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (!endsWith(name, ".wav") && !endsWith(name, ".WAV")) {
+            continue;
+        }
+        std::string stem = directory + "/" + name.substr(0, name.size() - 4);
+        files.push_back({directory + "/" + name, stem + ".lab", stem + ".scores"});
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end(), [](const CorpusFile &a, const CorpusFile &b) {
+        return a.wavPath < b.wavPath;
+    });
+    return true;
+}
+
+bool readRecording(const std::string &path, int32_t sampleRate, std::vector<float> &samples) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    SNDFILE *sndfile = sf_open(path.c_str(), SFM_READ, &info);
+    if (sndfile == nullptr) {
+        fprintf(stderr, "Cannot open %s: %s\n", path.c_str(), sf_strerror(nullptr));
+        return false;
+    }
+    if (info.samplerate != sampleRate) {
+        fprintf(stderr, "%s is at %d Hz, the pipelines run at %d Hz\n", path.c_str(), info.samplerate, sampleRate);
+        sf_close(sndfile);
+        return false;
+    }
+    samples.clear();
+    samples.reserve((size_t) info.frames);
+    std::vector<float> block((size_t) (kReadBlockFrames * info.channels));
+    sf_count_t frames;
+    // Integer formats are normalized to [-1, 1) as the float capture stream
+    while ((frames = sf_readf_float(sndfile, block.data(), kReadBlockFrames)) > 0) {
+        for (sf_count_t i = 0; i < frames; i++) {
+            float sum = 0;
+            for (int c = 0; c < info.channels; c++) {
+                sum += block[i * info.channels + c];
+            }
+            samples.push_back(sum / info.channels);
+        }
+    }
+    sf_close(sndfile);
+    return true;
+}
+
+bool readLabels(const std::string &path, int32_t sampleRate, const std::string &labelText,
+                std::vector<Label> &labels) {
+    labels.clear();
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return true;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        // Audacity writes the frequency range of a label as a second line starting with a backslash
+        if (line.empty() || line[0] == '#' || line[0] == '\\') {
+            continue;
+        }
+        std::istringstream fields(line);
+        double start, end;
+        if (!(fields >> start >> end) || end < start) {
+            fprintf(stderr, "%s:%d is not a \"start end text\" label\n", path.c_str(), lineNumber);
+            return false;
+        }
+        std::string text;
+        std::getline(fields >> std::ws, text);
+        if (!labelText.empty() && text != labelText) {
+            continue;
+        }
+        labels.push_back({(int64_t) llround(start * sampleRate), (int64_t) llround(end * sampleRate), text});
+    }
+    std::sort(labels.begin(), labels.end(), [](const Label &a, const Label &b) {
+        return a.start < b.start;
+    });
+    return true;
+}
+
+bool readModelConfig(const std::string &path, rkai_melspectrogram_config_t *config) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        fprintf(stderr, "Cannot open the model config %s\n", path.c_str());
+        return false;
+    }
+    memset(config, 0, sizeof(rkai_melspectrogram_config_t));
+    snprintf(config->model_config_name, sizeof(config->model_config_name), "%s", path.c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (sscanf(line.c_str(), "%d %d %d %d %d %d %d %d %d %d %d %le", &config->sample_rate, &config->n_fft,
+                   &config->f_max, &config->n_mels, &config->win_length, &config->hop_length, &config->output_size,
+                   &config->transpose, &config->htk, &config->norm, &config->norm_mel, &config->log_mel) != 12) {
+            fprintf(stderr, "Cannot read the model config %s\n", path.c_str());
+            return false;
+        }
+        return true;
+    }
+    fprintf(stderr, "The model config %s is empty\n", path.c_str());
+    return false;
+}
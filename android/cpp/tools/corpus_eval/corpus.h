@@ -0,0 +1,55 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_CORPUS_H
+#define SMARTROBOT_CORPUS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "rkai_type.h"
+
+/**
+ * Labelled interval of a recording, in samples
+ */
+struct Label {
+    int64_t start;
+    int64_t end;
+    std::string text;
+};
+
+/**
+ * A recording of the corpus and its side files, named after the wav: name.wav, name.lab, name.scores
+ */
+struct CorpusFile {
+    std::string wavPath;
+    // Audacity label track: one "start end text" line per interval, in seconds. No file means nothing labelled
+    std::string labelPath;
+    // Recorded scores for the dump score source, see DumpScoreSource
+    std::string scorePath;
+};
+
+/**
+ * The wav files of a directory, sorted by path so that the report does not depend on the file system order
+ */
+bool listCorpus(const std::string &directory, std::vector<CorpusFile> &files);
+
+/**
+ * Read a recording through libsndfile as float samples, the channels are averaged. Recordings at another sample
+ * rate are refused, the pipelines run at the capture rate of the app
+ */
+bool readRecording(const std::string &path, int32_t sampleRate, std::vector<float> &samples);
+
+/**
+ * Read the labels whose text is labelText, or all of them if labelText is empty. A missing file gives no label
+ */
+bool readLabels(const std::string &path, int32_t sampleRate, const std::string &labelText,
+                std::vector<Label> &labels);
+
+/**
+ * Read a model config of the app assets, e.g. model/vad/vad_config.txt, in the format of load_config_file
+ */
+bool readModelConfig(const std::string &path, rkai_melspectrogram_config_t *config);
+
+#endif //SMARTROBOT_CORPUS_H
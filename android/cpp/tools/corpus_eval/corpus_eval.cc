@@ -0,0 +1,332 @@
+//
+// Created on 19/10/2026.
+//
+
+// Runs the trigger word or vad pipeline of the app over a directory of recordings and reports the false accepts per
+// hour, the miss rate, the boundary errors of the detections against the labels and the real-time factor.
+//
+//  corpus_eval --pipeline trigger|vad --corpus DIR [--scores stub|dump] [--models DIR] [--threads N]
+//              [--label TEXT] [--bc-threshold F] [--conv-threshold F] [--vad-onset F] [--vad-offset F] [--verbose]
+//              [--synthesize silent|noisy] [--no-gate] [--stride fixed|adaptive]
+//
+// The recordings are DIR/name.wav, labelled by DIR/name.lab and scored by DIR/name.scores with --scores dump, see
+// corpus.h. Apart from the timings the report only depends on the corpus and the options, not on the number of
+// threads.
+//
+// The trigger word report also has the work the energy gate saves: the windows it skips, and the melspectrograms and
+// inferences run. With --synthesize the silent or noisy corpus of synthetic_corpus.h is written to DIR first; the
+// skip rate is measured on the silent one, and the misses on the noisy one against a run with --no-gate. The
+// windows and the model runs per audio hour of --stride adaptive are compared with a run with the fixed stride, at
+// the same recall.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "corpus.h"
+#include "pipeline.h"
+#include "synthetic_corpus.h"
+
+#ifndef CORPUS_EVAL_MODEL_DIR
+#define CORPUS_EVAL_MODEL_DIR "model"
+#endif
+
+struct EvalOptions {
+    std::string pipeline;
+    std::string corpus;
+    std::string scores = "stub";
+    std::string models = CORPUS_EVAL_MODEL_DIR;
+    std::string label;
+    int threads = (int) std::max(1u, std::thread::hardware_concurrency());
+    bool isVerbose = false;
+    std::string synthesize;
+    PipelineConfig config;
+};
+
+/**
+ * Outcome of one recording
+ */
+struct FileResult {
+    bool isOk = false;
+    double seconds = 0;
+    double processSeconds = 0;
+    int labelNum = 0;
+    int detectionNum = 0;
+    int falseAcceptNum = 0;
+    int missNum = 0;
+    int64_t missingWindowNum = 0;
+    TriggerWork work;
+    // Detection minus label, in ms, of each matched label
+    std::vector<double> startErrors;
+    std::vector<double> endErrors;
+};
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: corpus_eval --pipeline trigger|vad --corpus DIR [options]\n"
+            "  --scores stub|dump     inference stand-in, dump reads DIR/name.scores (default stub)\n"
+            "  --models DIR           model configs of the app assets (default %s)\n"
+            "  --threads N            recordings evaluated at once (default: cores)\n"
+            "  --label TEXT           only count the labels with this text (default: all)\n"
+            "  --bc-threshold F       bc stage of the trigger word cascade (default 0.6)\n"
+            "  --conv-threshold F     conv stage and decision fusion (default 0.7)\n"
+            "  --vad-onset F          segmenter onset (default 0.6)\n"
+            "  --vad-offset F         segmenter offset (default 0.3)\n"
+            "  --synthesize silent|noisy  write the synthetic corpus to DIR first\n"
+            "  --no-gate              run the trigger word models on every window\n"
+            "  --stride fixed|adaptive  trigger word window stride (default fixed)\n"
+            "  --verbose              one line per recording\n", CORPUS_EVAL_MODEL_DIR);
+}
+
+static bool parseOptions(int argc, char **argv, EvalOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        if (name == "--verbose") {
+            options.isVerbose = true;
+            continue;
+        }
+        if (name == "--no-gate") {
+            options.config.isGated = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", name.c_str());
+            return false;
+        }
+        const char *value = argv[++i];
+        if (name == "--pipeline") {
+            options.pipeline = value;
+        } else if (name == "--corpus") {
+            options.corpus = value;
+        } else if (name == "--scores") {
+            options.scores = value;
+        } else if (name == "--models") {
+            options.models = value;
+        } else if (name == "--stride") {
+            std::string stride = value;
+            if (stride != "fixed" && stride != "adaptive") {
+                fprintf(stderr, "Unknown stride %s\n", value);
+                return false;
+            }
+            options.config.isStrideAdaptive = stride == "adaptive";
+        } else if (name == "--synthesize") {
+            options.synthesize = value;
+        } else if (name == "--label") {
+            options.label = value;
+        } else if (name == "--threads") {
+            options.threads = std::max(1, atoi(value));
+        } else if (name == "--bc-threshold") {
+            options.config.bcThreshold = (float) atof(value);
+        } else if (name == "--conv-threshold") {
+            options.config.convThreshold = (float) atof(value);
+        } else if (name == "--vad-onset") {
+            options.config.vadOnset = (float) atof(value);
+        } else if (name == "--vad-offset") {
+            options.config.vadOffset = (float) atof(value);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    if ((options.pipeline != "trigger" && options.pipeline != "vad") || options.corpus.empty() ||
+        (options.scores != "stub" && options.scores != "dump") ||
+        (!options.synthesize.empty() && options.synthesize != "silent" && options.synthesize != "noisy")) {
+        return false;
+    }
+    PipelineConfig &config = options.config;
+    return readModelConfig(options.models + "/trigger_word/bc_config.txt", &config.bcConfig) &&
+           readModelConfig(options.models + "/trigger_word/conv_config.txt", &config.convConfig) &&
+           readModelConfig(options.models + "/vad/vad_config.txt", &config.vadConfig);
+}
+
+/**
+ * Match each label with the first detection overlapping it that is not matched yet. The detections left are false
+ * accepts
+ */
+static void matchDetections(const std::vector<Label> &labels, const std::vector<Detection> &detections,
+                            int32_t sampleRate, FileResult &result) {
+    std::vector<bool> isMatched(detections.size(), false);
+    for (const Label &label : labels) {
+        size_t j = 0;
+        while (j < detections.size() &&
+               (isMatched[j] || detections[j].end <= label.start || detections[j].start >= label.end)) {
+            j++;
+        }
+        if (j == detections.size()) {
+            result.missNum++;
+            continue;
+        }
+        isMatched[j] = true;
+        result.startErrors.push_back((detections[j].start - label.start) * 1000.0 / sampleRate);
+        result.endErrors.push_back((detections[j].end - label.end) * 1000.0 / sampleRate);
+    }
+    result.labelNum = (int) labels.size();
+    result.detectionNum = (int) detections.size();
+    result.falseAcceptNum = (int) std::count(isMatched.begin(), isMatched.end(), false);
+}
+
+static FileResult evaluateFile(const CorpusFile &file, const EvalOptions &options) {
+    FileResult result;
+    const PipelineConfig &config = options.config;
+    std::vector<float> audio;
+    std::vector<Label> labels;
+    if (!readRecording(file.wavPath, config.sampleRate, audio) ||
+        !readLabels(file.labelPath, config.sampleRate, options.label, labels)) {
+        return result;
+    }
+    std::unique_ptr<ScoreSource> source;
+    if (options.scores == "dump") {
+        DumpScoreSource *dump = new DumpScoreSource(config.vadConfig.hop_length);
+        source.reset(dump);
+        if (!dump->load(file.scorePath)) {
+            return result;
+        }
+    } else {
+        source.reset(new StubScoreSource(config.vadConfig.hop_length));
+    }
+    std::vector<Detection> detections;
+    auto start = std::chrono::steady_clock::now();
+    result.isOk = options.pipeline == "trigger" ? runTriggerPipeline(audio, config, *source, detections, result.work)
+                                                : runVadPipeline(audio, config, *source, detections);
+    result.processSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.seconds = (double) audio.size() / config.sampleRate;
+    if (options.scores == "dump") {
+        result.missingWindowNum = ((DumpScoreSource *) source.get())->getMissingCount();
+    }
+    matchDetections(labels, detections, config.sampleRate, result);
+    return result;
+}
+
+/**
+ * Mean and 90th percentile of the absolute values
+ */
+static void summarize(std::vector<double> values, double *mean, double *p90) {
+    *mean = 0;
+    *p90 = 0;
+    if (values.empty()) {
+        return;
+    }
+    for (double &value : values) {
+        value = value < 0 ? -value : value;
+        *mean += value;
+    }
+    *mean /= values.size();
+    std::sort(values.begin(), values.end());
+    *p90 = values[std::min(values.size() - 1, (size_t) (values.size() * 0.9))];
+}
+
+int main(int argc, char **argv) {
+    EvalOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    if (options.synthesize == "silent" && !writeSilentCorpus(options.corpus, options.config.sampleRate)) {
+        return 1;
+    }
+    if (options.synthesize == "noisy" && !writeNoisyCorpus(options.corpus, options.config.sampleRate)) {
+        return 1;
+    }
+    std::vector<CorpusFile> files;
+    if (!listCorpus(options.corpus, files)) {
+        return 1;
+    }
+    if (files.empty()) {
+        fprintf(stderr, "No wav file in %s\n", options.corpus.c_str());
+        return 1;
+    }
+
+    // Each worker takes the next recording, the results are kept in the corpus order
+    std::vector<FileResult> results(files.size());
+    std::atomic<size_t> nextFile{0};
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    int threadNum = std::min<int>(options.threads, (int) files.size());
+    for (int i = 0; i < threadNum; i++) {
+        workers.emplace_back([&]() {
+            size_t index;
+            while ((index = nextFile++) < files.size()) {
+                results[index] = evaluateFile(files[index], options);
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    FileResult total;
+    int failedNum = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        const FileResult &result = results[i];
+        if (!result.isOk) {
+            failedNum++;
+            fprintf(stderr, "%s: not evaluated\n", files[i].wavPath.c_str());
+            continue;
+        }
+        const TriggerWork &work = result.work;
+        if (options.isVerbose) {
+            printf("%s: %.1f s, %d labels, %d detections, %d false accepts, %d misses", files[i].wavPath.c_str(),
+                   result.seconds, result.labelNum, result.detectionNum, result.falseAcceptNum, result.missNum);
+            if (options.pipeline == "trigger" && options.config.isGated) {
+                printf(", %lld of %lld windows gated, noise floor %.1f dBFS", (long long) work.skippedNum,
+                       (long long) work.windowNum, work.noiseFloorDb);
+            }
+            printf("\n");
+        }
+        total.seconds += result.seconds;
+        total.processSeconds += result.processSeconds;
+        total.labelNum += result.labelNum;
+        total.detectionNum += result.detectionNum;
+        total.falseAcceptNum += result.falseAcceptNum;
+        total.missNum += result.missNum;
+        total.missingWindowNum += result.missingWindowNum;
+        total.work.windowNum += work.windowNum;
+        total.work.skippedNum += work.skippedNum;
+        total.work.melspectrogramNum += work.melspectrogramNum;
+        total.work.inferenceNum += work.inferenceNum;
+        total.work.scoredNum += work.scoredNum;
+        for (int mode = 0; mode < RKAI_STRIDE_MODE_NUM; mode++) {
+            total.work.modeWindowNum[mode] += work.modeWindowNum[mode];
+        }
+        total.startErrors.insert(total.startErrors.end(), result.startErrors.begin(), result.startErrors.end());
+        total.endErrors.insert(total.endErrors.end(), result.endErrors.begin(), result.endErrors.end());
+    }
+
+    double hours = total.seconds / 3600;
+    printf("pipeline %s, scores %s, %zu recordings, %.3f h, %d labels, %d detections\n", options.pipeline.c_str(),
+           options.scores.c_str(), files.size() - failedNum, hours, total.labelNum, total.detectionNum);
+    printf("false accepts %d, %.2f per hour\n", total.falseAcceptNum, hours > 0 ? total.falseAcceptNum / hours : 0);
+    printf("misses %d of %d, %.2f %%, recall %.2f %%\n", total.missNum, total.labelNum,
+           total.labelNum > 0 ? 100.0 * total.missNum / total.labelNum : 0,
+           total.labelNum > 0 ? 100.0 * (total.labelNum - total.missNum) / total.labelNum : 0);
+    double mean, p90;
+    summarize(total.startErrors, &mean, &p90);
+    printf("start error mean %.0f ms, p90 %.0f ms\n", mean, p90);
+    summarize(total.endErrors, &mean, &p90);
+    printf("end error mean %.0f ms, p90 %.0f ms\n", mean, p90);
+    if (options.pipeline == "trigger") {
+        const TriggerWork &work = total.work;
+        printf("gate %s, %lld of %lld windows skipped, %.1f %%\n", options.config.isGated ? "on" : "off",
+               (long long) work.skippedNum, (long long) work.windowNum,
+               work.windowNum > 0 ? 100.0 * work.skippedNum / work.windowNum : 0);
+        printf("melspectrograms %lld, inferences %lld, %.2f per window\n", (long long) work.melspectrogramNum,
+               (long long) work.inferenceNum, work.windowNum > 0 ? (double) work.inferenceNum / work.windowNum : 0);
+        printf("stride %s, %.0f windows and %.0f bc runs per audio hour, %lld coarse %lld normal %lld fine windows\n",
+               options.config.isStrideAdaptive ? "adaptive" : "fixed", hours > 0 ? work.windowNum / hours : 0,
+               hours > 0 ? work.scoredNum / hours : 0, (long long) work.modeWindowNum[RKAI_STRIDE_MODE_COARSE],
+               (long long) work.modeWindowNum[RKAI_STRIDE_MODE_NORMAL],
+               (long long) work.modeWindowNum[RKAI_STRIDE_MODE_FINE]);
+    }
+    if (total.missingWindowNum > 0) {
+        printf("%lld windows had no recorded score\n", (long long) total.missingWindowNum);
+    }
+    printf("real-time factor %.4f on one thread, %.4f wall clock on %d threads\n",
+           total.seconds > 0 ? total.processSeconds / total.seconds : 0,
+           total.seconds > 0 ? wallSeconds / total.seconds : 0, threadNum);
+    return failedNum > 0 ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+//
+// Created on 19/10/2026.
+//
+
+// Host stand-in for the NDK asset header, only the types are used by the host build
+#ifndef SMARTROBOT_HOST_ANDROID_ASSET_MANAGER_H
+#define SMARTROBOT_HOST_ANDROID_ASSET_MANAGER_H
+
+typedef struct AAssetManager AAssetManager;
+typedef struct AAsset AAsset;
+
+#endif //SMARTROBOT_HOST_ANDROID_ASSET_MANAGER_H
@@ -0,0 +1,10 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_HOST_ANDROID_ASSET_MANAGER_JNI_H
+#define SMARTROBOT_HOST_ANDROID_ASSET_MANAGER_JNI_H
+
+#include <android/asset_manager.h>
+
+#endif //SMARTROBOT_HOST_ANDROID_ASSET_MANAGER_JNI_H
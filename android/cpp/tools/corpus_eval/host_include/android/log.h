@@ -0,0 +1,27 @@
+//
+// Created on 19/10/2026.
+//
+
+// Host stand-in for the NDK log header, the rkai logger prints through host_log.c
+#ifndef SMARTROBOT_HOST_ANDROID_LOG_H
+#define SMARTROBOT_HOST_ANDROID_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    ANDROID_LOG_VERBOSE = 2,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL
+};
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //SMARTROBOT_HOST_ANDROID_LOG_H
@@ -0,0 +1,20 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <android/log.h>
+
+// Warnings and errors of the rkai modules go to stderr, the per window info logs are dropped
+int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    if (prio < ANDROID_LOG_WARN) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s ", tag);
+    int ret = vfprintf(stderr, fmt, args);
+    va_end(args);
+    return ret;
+}
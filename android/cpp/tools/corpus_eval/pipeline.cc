@@ -0,0 +1,321 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "pipeline.h"
+
+// Frames of a vad window read at once, as VADCallback
+#define VAD_MAX_FRAME_NUM 256
+#define VAD_MAX_EVENT_NUM 8
+
+// Level of a frame scored 0.5 by the stub, and the level change from 0.27 to 0.73
+constexpr float kStubSpeechDb = -40;
+constexpr float kStubSlopeDb = 3;
+
+/**
+ * Stub score of the frame centered on sample center of the window, as the frames of a centered melspectrogram
+ */
+static float stubFrameScore(const ScoreWindow &window, int64_t center, int frameLength) {
+    int64_t start = std::max<int64_t>(0, center - frameLength / 2);
+    int64_t end = std::min<int64_t>(window.size, center + frameLength / 2);
+    double power = 0;
+    for (int64_t i = start; i < end; i++) {
+        power += window.audio[i] * window.audio[i];
+    }
+    float level = (float) (10 * log10(power / std::max<int64_t>(1, end - start) + 1e-10));
+    return 1.0f / (1.0f + expf(-(level - kStubSpeechDb) / kStubSlopeDb));
+}
+
+bool StubScoreSource::getTriggerScore(int, const ScoreWindow &window, float *score) {
+    // Share of the window over the speech level
+    int frameLength = std::max(1, mVadHopLength / 2);
+    int frameNum = window.size / frameLength;
+    float sum = 0;
+    for (int i = 0; i < frameNum; i++) {
+        sum += stubFrameScore(window, (int64_t) i * frameLength + frameLength / 2, frameLength);
+    }
+    *score = frameNum > 0 ? sum / frameNum : 0;
+    return true;
+}
+
+bool StubScoreSource::getVadScores(const ScoreWindow &window, float *scores, int maxFrameNum, int *frameNum) {
+    *frameNum = std::min(maxFrameNum, window.size / mVadHopLength + 1);
+    for (int i = 0; i < *frameNum; i++) {
+        scores[i] = stubFrameScore(window, (int64_t) i * mVadHopLength, mVadHopLength);
+    }
+    return true;
+}
+
+bool DumpScoreSource::load(const std::string &path) {
+    mPath = path;
+    mScores.clear();
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        fprintf(stderr, "Cannot open the scores %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        int64_t start;
+        if (!(fields >> start)) {
+            fprintf(stderr, "%s: \"%s\" does not start with a window start\n", path.c_str(), line.c_str());
+            return false;
+        }
+        std::vector<float> &scores = mScores[start];
+        scores.clear();
+        float score;
+        while (fields >> score) {
+            scores.push_back(score);
+        }
+    }
+    return true;
+}
+
+const std::vector<float> *DumpScoreSource::find(int64_t start) {
+    auto it = mScores.find(start);
+    return it != mScores.end() ? &it->second : nullptr;
+}
+
+bool DumpScoreSource::getTriggerScore(int stage, const ScoreWindow &window, float *score) {
+    const std::vector<float> *scores = find(window.start);
+    if (scores == nullptr && stage == 0) {
+        mMissingCount++;
+    }
+    *score = scores != nullptr && stage < (int) scores->size() ? (*scores)[stage] : 0;
+    return true;
+}
+
+bool DumpScoreSource::getVadScores(const ScoreWindow &window, float *scores, int maxFrameNum, int *frameNum) {
+    const std::vector<float> *recorded = find(window.start);
+    *frameNum = 0;
+    if (recorded == nullptr) {
+        mMissingCount++;
+        // Scored as silence, the score stream still gets the window
+        *frameNum = std::min(maxFrameNum, window.size / mVadHopLength + 1);
+        memset(scores, 0, sizeof(float) * *frameNum);
+        return true;
+    }
+    *frameNum = std::min(maxFrameNum, (int) recorded->size());
+    memcpy(scores, recorded->data(), sizeof(float) * *frameNum);
+    return true;
+}
+
+/**
+ * Score a window with source, computing its melspectrogram first if the source needs it
+ */
+static bool prepareWindow(ScoreSource &source, rkai_audio_t *audio, int64_t start,
+                          const rkai_melspectrogram_config_t &modelConfig, rkai_melspectrogram_t *melspectrogram,
+                          ScoreWindow *window) {
+    memset(melspectrogram, 0, sizeof(rkai_melspectrogram_t));
+    if (source.needsMelspectrogram() &&
+        rkai_audio_to_melspectrogram(audio, melspectrogram, modelConfig) != RKAI_RET_SUCCESS) {
+        fprintf(stderr, "Cannot compute the melspectrogram of the window at %lld\n", (long long) start);
+        rkai_audio_melspectrogram_release(melspectrogram);
+        return false;
+    }
+    window->start = start;
+    window->audio = audio->data;
+    window->size = audio->size;
+    window->melspectrogram = melspectrogram;
+    return true;
+}
+
+bool runTriggerPipeline(const std::vector<float> &audio, const PipelineConfig &config, ScoreSource &source,
+                        std::vector<Detection> &detections, TriggerWork &work) {
+    detections.clear();
+    work = TriggerWork();
+    int32_t windowSize = (int32_t) (config.sampleRate * config.windowSeconds);
+    int32_t stride = (int32_t) (windowSize * config.strideSeconds);
+    rkai_energy_gate_config_t gateConfig;
+    rkai_energy_gate_default_config(config.sampleRate, &gateConfig);
+    rkai_energy_gate_t gate = rkai_create_energy_gate(&gateConfig);
+    rkai_fusion_config_t fusionConfig;
+    rkai_decision_fusion_default_config(config.sampleRate, &fusionConfig);
+    fusionConfig.on_threshold = config.convThreshold;
+    rkai_decision_fusion_t fusion = rkai_create_decision_fusion(&fusionConfig, 1);
+    rkai_adaptive_stride_t policy = nullptr;
+    if (config.isStrideAdaptive) {
+        rkai_adaptive_stride_config_t strideConfig;
+        rkai_adaptive_stride_default_config(config.sampleRate, &strideConfig);
+        strideConfig.window_size = windowSize;
+        strideConfig.normal_stride = stride;
+        strideConfig.threshold = config.bcThreshold;
+        policy = rkai_create_adaptive_stride(&strideConfig);
+    }
+    if (gate == nullptr || fusion == nullptr || (config.isStrideAdaptive && policy == nullptr)) {
+        rkai_release_energy_gate(gate);
+        rkai_release_decision_fusion(fusion);
+        rkai_release_adaptive_stride(policy);
+        return false;
+    }
+    const rkai_melspectrogram_config_t *stageConfigs[2] = {&config.bcConfig, &config.convConfig};
+    const float stageThresholds[2] = {config.bcThreshold, config.convThreshold};
+    // The melspectrogram takes a mutable window
+    std::vector<float> windowData(windowSize);
+    rkai_audio_t input;
+    memset(&input, 0, sizeof(rkai_audio_t));
+    input.data = windowData.data();
+    input.size = windowSize;
+    input.sample_rate = config.sampleRate;
+    input.n_seconds = (int) config.windowSeconds;
+    input.n_channels = 1;
+    input.format = RKAI_AUDIO_FORMAT_FLOAT;
+    bool isOk = true;
+    int newSampleNum = windowSize;
+    for (int64_t start = 0; isOk && start + windowSize <= (int64_t) audio.size(); start += stride) {
+        memcpy(windowData.data(), audio.data() + start, sizeof(float) * windowSize);
+        int isActive = 1;
+        if (config.isGated) {
+            rkai_energy_gate_process(gate, &input, newSampleNum, &isActive);
+        }
+        work.windowNum++;
+        // Skipped windows count as zero scores so the smoothing decays, as in TriggerCallback
+        float bcScore = -1;
+        float keywordScore = 0;
+        for (int stage = 0; isActive && stage < 2; stage++) {
+            rkai_melspectrogram_t melspectrogram;
+            ScoreWindow window;
+            float score = 0;
+            isOk = prepareWindow(source, &input, start, *stageConfigs[stage], &melspectrogram, &window) &&
+                   source.getTriggerScore(stage, window, &score);
+            rkai_audio_melspectrogram_release(&melspectrogram);
+            if (!isOk) {
+                break;
+            }
+            work.melspectrogramNum += source.needsMelspectrogram();
+            work.inferenceNum++;
+            if (stage == 0) {
+                bcScore = score;
+                work.scoredNum++;
+            } else {
+                keywordScore = score;
+            }
+            // Early exit of rkai_trigger_word_cascade_detect
+            if (score <= stageThresholds[stage]) {
+                break;
+            }
+        }
+        rkai_fusion_event_t event;
+        if (isOk && rkai_decision_fusion_update(fusion, &keywordScore, start, &event) == RKAI_RET_SUCCESS &&
+            event.is_triggered) {
+            detections.push_back({event.onset, start + windowSize});
+        }
+        if (policy != nullptr) {
+            rkai_adaptive_stride_next(policy, bcScore, isActive, &stride);
+        }
+        newSampleNum = std::min(stride, windowSize);
+    }
+    rkai_adaptive_stride_stats_t strideStats;
+    if (policy != nullptr && rkai_adaptive_stride_get_stats(policy, &strideStats) == RKAI_RET_SUCCESS) {
+        for (int mode = 0; mode < RKAI_STRIDE_MODE_NUM; mode++) {
+            work.modeWindowNum[mode] = (int64_t) strideStats.mode_window_count[mode];
+        }
+    } else {
+        work.modeWindowNum[RKAI_STRIDE_MODE_NORMAL] = work.windowNum;
+    }
+    rkai_release_adaptive_stride(policy);
+    rkai_energy_gate_stats_t gateStats;
+    if (rkai_energy_gate_get_stats(gate, &gateStats) == RKAI_RET_SUCCESS) {
+        work.skippedNum = (int64_t) gateStats.skipped_count;
+        work.noiseFloorDb = gateStats.noise_floor_db;
+    }
+    rkai_release_energy_gate(gate);
+    rkai_release_decision_fusion(fusion);
+    return isOk;
+}
+
+/**
+ * Segments of the events of a segmenter push, openStart is the start of the segment not ended yet or -1
+ */
+static void collectSegments(const rkai_vad_segment_event_t *events, int eventNum, int64_t *openStart,
+                            std::vector<Detection> &detections) {
+    for (int i = 0; i < eventNum; i++) {
+        if (events[i].type == RKAI_VAD_SEGMENT_START) {
+            *openStart = events[i].start_sample;
+        } else {
+            detections.push_back({events[i].start_sample, events[i].end_sample});
+            *openStart = -1;
+        }
+    }
+}
+
+bool runVadPipeline(const std::vector<float> &audio, const PipelineConfig &config, ScoreSource &source,
+                    std::vector<Detection> &detections) {
+    detections.clear();
+    int32_t windowSize = (int32_t) (config.sampleRate * config.windowSeconds);
+    int32_t stride = (int32_t) (windowSize * config.strideSeconds);
+    int hopLength = config.vadConfig.hop_length;
+    rkai_vad_score_stream_config_t streamConfig;
+    rkai_vad_score_stream_default_config(&config.vadConfig, &streamConfig);
+    rkai_vad_score_stream_t stream = rkai_create_vad_score_stream(&streamConfig);
+    rkai_vad_segmenter_config_t segmenterConfig;
+    rkai_vad_segmenter_default_config(config.sampleRate, hopLength, &segmenterConfig);
+    segmenterConfig.onset_threshold = config.vadOnset;
+    segmenterConfig.offset_threshold = config.vadOffset;
+    rkai_vad_segmenter_t segmenter = rkai_create_vad_segmenter(&segmenterConfig);
+    if (stream == nullptr || segmenter == nullptr) {
+        rkai_release_vad_score_stream(stream);
+        rkai_release_vad_segmenter(segmenter);
+        return false;
+    }
+    std::vector<float> windowData(windowSize);
+    rkai_audio_t input;
+    memset(&input, 0, sizeof(rkai_audio_t));
+    input.data = windowData.data();
+    input.size = windowSize;
+    input.sample_rate = config.sampleRate;
+    input.n_seconds = (int) config.windowSeconds;
+    input.n_channels = 1;
+    input.format = RKAI_AUDIO_FORMAT_FLOAT;
+    float frameScores[VAD_MAX_FRAME_NUM];
+    rkai_vad_segment_event_t events[VAD_MAX_EVENT_NUM];
+    int64_t openStart = -1;
+    bool isOk = true;
+    for (int64_t start = 0; start + windowSize <= (int64_t) audio.size(); start += stride) {
+        memcpy(windowData.data(), audio.data() + start, sizeof(float) * windowSize);
+        rkai_melspectrogram_t melspectrogram;
+        ScoreWindow window;
+        int frameNum = 0;
+        isOk = prepareWindow(source, &input, start, config.vadConfig, &melspectrogram, &window) &&
+               source.getVadScores(window, frameScores, VAD_MAX_FRAME_NUM, &frameNum);
+        rkai_audio_melspectrogram_release(&melspectrogram);
+        if (!isOk) {
+            break;
+        }
+        rkai_vad_score_stream_add(stream, start / hopLength, frameScores, frameNum);
+        int64_t firstFrame = 0;
+        rkai_vad_score_stream_read(stream, frameScores, VAD_MAX_FRAME_NUM, &firstFrame, &frameNum);
+        int eventNum = 0;
+        rkai_vad_segmenter_push(segmenter, firstFrame, frameScores, frameNum, events, VAD_MAX_EVENT_NUM, &eventNum);
+        collectSegments(events, eventNum, &openStart, detections);
+    }
+    if (isOk) {
+        // The frames only covered by the last windows
+        rkai_vad_score_stream_flush(stream);
+        int64_t firstFrame = 0;
+        int frameNum = 0;
+        while (rkai_vad_score_stream_read(stream, frameScores, VAD_MAX_FRAME_NUM, &firstFrame, &frameNum) ==
+               RKAI_RET_SUCCESS && frameNum > 0) {
+            int eventNum = 0;
+            rkai_vad_segmenter_push(segmenter, firstFrame, frameScores, frameNum, events, VAD_MAX_EVENT_NUM,
+                                    &eventNum);
+            collectSegments(events, eventNum, &openStart, detections);
+        }
+        if (openStart >= 0) {
+            detections.push_back({openStart, (int64_t) audio.size()});
+        }
+    }
+    rkai_release_vad_score_stream(stream);
+    rkai_release_vad_segmenter(segmenter);
+    return isOk;
+}
@@ -0,0 +1,148 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_PIPELINE_H
+#define SMARTROBOT_PIPELINE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "rkai.h"
+
+/**
+ * Window of the capture given to a model, with its melspectrogram in the config of that model
+ */
+struct ScoreWindow {
+    int64_t start;
+    const float *audio;
+    int32_t size;
+    const rkai_melspectrogram_t *melspectrogram;
+};
+
+/**
+ * Stand-in for the NPU inference of the pipelines
+ */
+class ScoreSource {
+public:
+    virtual ~ScoreSource() = default;
+
+    // The pipeline skips the melspectrogram when false
+    virtual bool needsMelspectrogram() const = 0;
+
+    // Trigger word probability of a cascade stage, 0 for the bc model and 1 for the conv model
+    virtual bool getTriggerScore(int stage, const ScoreWindow &window, float *score) = 0;
+
+    // Speech probability of each vad frame of the window, as rkai_vad_detect_frames
+    virtual bool getVadScores(const ScoreWindow &window, float *scores, int maxFrameNum, int *frameNum) = 0;
+};
+
+/**
+ * Deterministic scores from the level of 10 ms frames against -40 dBFS. Not a model: it checks the pipelines end to
+ * end and times the front-end, the melspectrogram is computed and not used
+ */
+class StubScoreSource : public ScoreSource {
+public:
+    explicit StubScoreSource(int vadHopLength) : mVadHopLength(vadHopLength) {};
+
+    bool needsMelspectrogram() const override { return true; };
+
+    bool getTriggerScore(int stage, const ScoreWindow &window, float *score) override;
+
+    bool getVadScores(const ScoreWindow &window, float *scores, int maxFrameNum, int *frameNum) override;
+
+private:
+    int mVadHopLength;
+};
+
+/**
+ * Scores recorded from the models, one "window_start score..." line per window with the start in samples. A
+ * trigger word line holds the bc then the conv score, a vad line the scores of the frames of the window
+ */
+class DumpScoreSource : public ScoreSource {
+public:
+    explicit DumpScoreSource(int vadHopLength) : mVadHopLength(vadHopLength) {};
+
+    bool load(const std::string &path);
+
+    bool needsMelspectrogram() const override { return false; };
+
+    bool getTriggerScore(int stage, const ScoreWindow &window, float *score) override;
+
+    bool getVadScores(const ScoreWindow &window, float *scores, int maxFrameNum, int *frameNum) override;
+
+    // Windows of the pipeline with no recorded line, scored 0
+    int64_t getMissingCount() const { return mMissingCount; };
+
+private:
+    int mVadHopLength;
+    std::string mPath;
+    std::map<int64_t, std::vector<float>> mScores;
+    int64_t mMissingCount = 0;
+
+    const std::vector<float> *find(int64_t start);
+};
+
+/**
+ * Parameters of the pipelines, the defaults are those of TriggerCallback and VADCallback
+ */
+struct PipelineConfig {
+    int32_t sampleRate = 16000;
+    float windowSeconds = 1;
+    float strideSeconds = 0.3;
+    // Cascade stage thresholds, the conv threshold is also the fusion on threshold
+    float bcThreshold = 0.6;
+    float convThreshold = 0.7;
+    // Segmenter thresholds
+    float vadOnset = 0.6;
+    float vadOffset = 0.3;
+    // Energy gate ahead of the trigger word front-end, off to count the detections it misses
+    bool isGated = true;
+    // Trigger word windows advanced by rkai_adaptive_stride instead of the fixed stride
+    bool isStrideAdaptive = false;
+    rkai_melspectrogram_config_t bcConfig;
+    rkai_melspectrogram_config_t convConfig;
+    rkai_melspectrogram_config_t vadConfig;
+};
+
+/**
+ * A trigger word event or a speech segment, in samples
+ */
+struct Detection {
+    int64_t start;
+    int64_t end;
+};
+
+/**
+ * Work of the trigger word pipeline over a recording
+ */
+struct TriggerWork {
+    int64_t windowNum = 0;
+    // Windows the energy gate kept from the front-end and the models
+    int64_t skippedNum = 0;
+    int64_t melspectrogramNum = 0;
+    int64_t inferenceNum = 0;
+    // Windows the bc model ran on
+    int64_t scoredNum = 0;
+    // Windows per rkai_stride_mode_t, all normal with the fixed stride
+    int64_t modeWindowNum[RKAI_STRIDE_MODE_NUM] = {};
+    // Noise floor of the gate at the end of the recording
+    float noiseFloorDb = 0;
+};
+
+/**
+ * The trigger word thread of the app over a whole recording, without lag: energy gate, bc then conv cascade and
+ * decision fusion. A detection spans from the onset of the utterance to the end of the window that fired
+ */
+bool runTriggerPipeline(const std::vector<float> &audio, const PipelineConfig &config, ScoreSource &source,
+                        std::vector<Detection> &detections, TriggerWork &work);
+
+/**
+ * The vad thread of the app over a whole recording, without lag: frame scores of the windows, score stream and
+ * segmenter. A segment still open at the end of the recording ends there
+ */
+bool runVadPipeline(const std::vector<float> &audio, const PipelineConfig &config, ScoreSource &source,
+                    std::vector<Detection> &detections);
+
+#endif //SMARTROBOT_PIPELINE_H
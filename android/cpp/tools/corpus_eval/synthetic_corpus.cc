@@ -0,0 +1,135 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <random>
+#include <vector>
+#include "echo_mix.h"
+#include "synthetic_corpus.h"
+
+constexpr int kRecordingNum = 3;
+constexpr float kRecordingSeconds = 60;
+// A keyword utterance every kKeywordPeriodSeconds, give or take a second
+constexpr float kKeywordSeconds = 1.2f;
+constexpr float kKeywordPeriodSeconds = 8;
+// Near, mid and far talkers, dBFS over the speech
+constexpr float kKeywordLevelsDb[] = {-20, -26, -32};
+constexpr float kDayNoiseLevelDb = -50;
+
+static bool makeDirectory(const std::string &directory) {
+    struct stat info;
+    if (stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        return true;
+    }
+    if (mkdir(directory.c_str(), 0755) != 0) {
+        fprintf(stderr, "Cannot create the corpus directory %s\n", directory.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * A quiet room tone, the 50 Hz hum of the ventilation, and every 20 s a door closing then a few steps
+ */
+static std::vector<float> nightLobby(int32_t sampleRate, int64_t length, uint32_t seed) {
+    std::vector<float> samples(length);
+    std::mt19937 random(seed);
+    std::normal_distribution<float> normal(0, 1);
+    for (int64_t i = 0; i < length; i++) {
+        samples[i] = 0.0005f * normal(random) + 0.001f * sinf(2 * (float) M_PI * 50 * i / sampleRate);
+    }
+    for (float start = 4 + seed % 3; start < kRecordingSeconds - 3; start += 20) {
+        int64_t first = (int64_t) (start * sampleRate);
+        for (int64_t i = first; i < first + sampleRate / 5; i++) {
+            samples[i] += 0.05f * normal(random) * expf(-(float) (i - first) / (sampleRate / 25));
+        }
+        for (int step = 1; step <= 4; step++) {
+            int64_t stepStart = first + step * sampleRate / 2;
+            for (int64_t i = stepStart; i < stepStart + sampleRate / 50; i++) {
+                samples[i] += 0.01f * normal(random);
+            }
+        }
+    }
+    return samples;
+}
+
+/**
+ * Ventilation by day: a rumble under 200 Hz and a broadband hiss, stationary
+ */
+static std::vector<float> dayLobby(int32_t sampleRate, int64_t length, uint32_t seed) {
+    std::vector<float> samples(length);
+    std::mt19937 random(seed);
+    std::normal_distribution<float> normal(0, 1);
+    float rumble = 0;
+    float coefficient = expf(-2 * (float) M_PI * 200 / sampleRate);
+    for (int64_t i = 0; i < length; i++) {
+        rumble = coefficient * rumble + (1 - coefficient) * normal(random);
+        samples[i] = 4 * rumble + 0.3f * normal(random);
+    }
+    scaleToLevel(samples, kDayNoiseLevelDb);
+    return samples;
+}
+
+static bool writeLabels(const std::string &path, const std::vector<float> &starts) {
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot create %s\n", path.c_str());
+        return false;
+    }
+    for (float start : starts) {
+        fprintf(file, "%.3f\t%.3f\tkeyword\n", start, start + kKeywordSeconds);
+    }
+    return fclose(file) == 0;
+}
+
+bool writeSilentCorpus(const std::string &directory, int32_t sampleRate) {
+    if (!makeDirectory(directory)) {
+        return false;
+    }
+    int64_t length = (int64_t) (kRecordingSeconds * sampleRate);
+    for (int r = 0; r < kRecordingNum; r++) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/night_%02d.wav", directory.c_str(), r);
+        if (!writeWav(path, sampleRate, nightLobby(sampleRate, length, 60 + r))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeNoisyCorpus(const std::string &directory, int32_t sampleRate) {
+    if (!makeDirectory(directory)) {
+        return false;
+    }
+    int64_t length = (int64_t) (kRecordingSeconds * sampleRate);
+    int levelNum = sizeof(kKeywordLevelsDb) / sizeof(kKeywordLevelsDb[0]);
+    for (int r = 0; r < kRecordingNum; r++) {
+        std::vector<float> samples = dayLobby(sampleRate, length, 70 + r);
+        std::mt19937 random(80 + r);
+        std::uniform_real_distribution<float> jitter(-1, 1);
+        std::vector<float> starts;
+        int k = 0;
+        for (float start = 3; start + kKeywordSeconds + 1 < kRecordingSeconds; start += kKeywordPeriodSeconds, k++) {
+            float onset = start + jitter(random);
+            // Each talker has its own pitch and syllables
+            std::vector<float> keyword = synthesizeSpeech(sampleRate, kKeywordSeconds, 110 + 20 * (k % 5),
+                                                          90 + 10 * r + k, 0, kKeywordSeconds);
+            scaleToLevel(keyword, kKeywordLevelsDb[k % levelNum]);
+            int64_t first = (int64_t) (onset * sampleRate);
+            for (size_t i = 0; i < keyword.size(); i++) {
+                samples[first + i] += keyword[i];
+            }
+            starts.push_back(onset);
+        }
+        char stem[256];
+        snprintf(stem, sizeof(stem), "%s/day_%02d", directory.c_str(), r);
+        if (!writeWav(std::string(stem) + ".wav", sampleRate, samples) ||
+            !writeLabels(std::string(stem) + ".lab", starts)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_SYNTHETIC_CORPUS_H
+#define SMARTROBOT_SYNTHETIC_CORPUS_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Write the silent corpus to a directory: recordings of a lobby at night, a quiet room tone with the hum of the
+ * ventilation and now and then a door and steps, nothing labelled. Only the windows of the doors and steps should
+ * get through the gate
+ */
+bool writeSilentCorpus(const std::string &directory, int32_t sampleRate);
+
+/**
+ * Write the noisy corpus to a directory: recordings of a lobby by day, ventilation noise with formant synthesized
+ * keyword utterances from near and far talkers, each utterance labelled "keyword" in name.lab
+ */
+bool writeNoisyCorpus(const std::string &directory, int32_t sampleRate);
+
+#endif //SMARTROBOT_SYNTHETIC_CORPUS_H
@@ -0,0 +1,180 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "echo_mix.h"
+#include "module_check.h"
+#include "segment_encoder.h"
+
+constexpr int32_t kSampleRate = 16000;
+constexpr int kSegmentNum = 20;
+constexpr float kSegmentSeconds = 4;
+// Chunks of the recording thread when the segment is streamed
+constexpr int32_t kChunkSamples = kSampleRate / 100;
+
+/**
+ * Encoded bytes read back through SF_VIRTUAL_IO
+ */
+struct EncodedFile {
+    const std::vector<uint8_t> *data;
+    sf_count_t position;
+};
+
+static sf_count_t encodedGetLength(void *userData) {
+    return (sf_count_t) ((EncodedFile *) userData)->data->size();
+}
+
+static sf_count_t encodedSeek(sf_count_t offset, int whence, void *userData) {
+    EncodedFile *file = (EncodedFile *) userData;
+    sf_count_t base = whence == SEEK_CUR ? file->position : whence == SEEK_END ? (sf_count_t) file->data->size() : 0;
+    if (base + offset < 0 || base + offset > (sf_count_t) file->data->size()) {
+        return -1;
+    }
+    file->position = base + offset;
+    return file->position;
+}
+
+static sf_count_t encodedRead(void *ptr, sf_count_t count, void *userData) {
+    EncodedFile *file = (EncodedFile *) userData;
+    count = std::min(count, (sf_count_t) file->data->size() - file->position);
+    memcpy(ptr, file->data->data() + file->position, (size_t) count);
+    file->position += count;
+    return count;
+}
+
+static sf_count_t encodedWrite(const void *, sf_count_t, void *) {
+    return 0;
+}
+
+static sf_count_t encodedTell(void *userData) {
+    return ((EncodedFile *) userData)->position;
+}
+
+static bool decode(const std::vector<uint8_t> &encoded, std::vector<int16_t> &samples) {
+    SF_VIRTUAL_IO io = {encodedGetLength, encodedSeek, encodedRead, encodedWrite, encodedTell};
+    EncodedFile file = {&encoded, 0};
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    SNDFILE *sndfile = sf_open_virtual(&io, SFM_READ, &info, &file);
+    if (sndfile == NULL) {
+        return false;
+    }
+    samples.resize((size_t) (info.frames * info.channels));
+    bool isRead = sf_readf_short(sndfile, samples.data(), info.frames) == info.frames;
+    sf_close(sndfile);
+    return isRead && info.samplerate == kSampleRate && info.channels == 1;
+}
+
+static std::vector<int16_t> toPcm16(const std::vector<float> &samples) {
+    rkai_pcm16_config_t config;
+    rkai_pcm16_default_config(kSampleRate, &config);
+    std::vector<int16_t> pcm(samples.size());
+    int written = 0;
+    rkai_pcm16_encode(&config, samples.data(), (int) samples.size(), (uint8_t *) pcm.data(),
+                      (int) (pcm.size() * sizeof(int16_t)), &written);
+    return pcm;
+}
+
+/**
+ * Speech of several talkers over a little room noise, the VAD segments the encoder gets
+ */
+static std::vector<std::vector<float>> speechSegments(uint32_t seed) {
+    std::vector<std::vector<float>> segments;
+    std::mt19937 random(seed);
+    std::normal_distribution<float> noise(0, 0.001f);
+    for (int i = 0; i < kSegmentNum; i++) {
+        std::vector<float> segment = synthesizeSpeech(kSampleRate, kSegmentSeconds, 100.0f + 10 * (i % 12),
+                                                      seed + i, 0, kSegmentSeconds);
+        scaleToLevel(segment, -20.0f - (float) (i % 4) * 4);
+        for (float &sample : segment) {
+            sample += noise(random);
+        }
+        segments.push_back(segment);
+    }
+    return segments;
+}
+
+/**
+ * Whole segments on the calling thread: decoded back to their PCM16, the compression ratio and the encode time
+ */
+static bool checkSegments(const std::vector<std::vector<float>> &segments) {
+    int exactNum = 0;
+    size_t pcmBytes = 0;
+    size_t encodedBytes = 0;
+    double encodeSeconds = 0;
+    for (const std::vector<float> &segment : segments) {
+        std::vector<int16_t> pcm = toPcm16(segment);
+        std::vector<uint8_t> encoded;
+        auto start = std::chrono::steady_clock::now();
+        bool isEncoded = SegmentEncoder::encode(pcm.data(), (int32_t) pcm.size(), kSampleRate, 1, encoded);
+        encodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::vector<int16_t> decoded;
+        exactNum += isEncoded && decode(encoded, decoded) && decoded == pcm;
+        pcmBytes += pcm.size() * sizeof(int16_t);
+        encodedBytes += encoded.size();
+    }
+    double audioSeconds = segments.size() * kSegmentSeconds;
+    printf("%zu segments, %.0f s: %d decoded bit exact, ratio %.2f, %.1f ms of encoding per audio second\n",
+           segments.size(), audioSeconds, exactNum, (double) pcmBytes / std::max<size_t>(1, encodedBytes),
+           1000 * encodeSeconds / audioSeconds);
+    return exactNum == (int) segments.size();
+}
+
+/**
+ * A segment streamed in chunks of the recording thread, as floats, decodes to the PCM16 of the floats
+ */
+static bool checkStream(const std::vector<float> &segment) {
+    SegmentEncoder encoder(kSampleRate, 1, kSampleRate, 1 << 20);
+    bool isAppended = encoder.begin();
+    for (size_t done = 0; isAppended && done < segment.size(); done += kChunkSamples) {
+        int32_t count = (int32_t) std::min<size_t>(kChunkSamples, segment.size() - done);
+        // The worker drains the ring meanwhile, a refused chunk is tried again
+        for (int attempt = 0; !encoder.append(segment.data() + done, count); attempt++) {
+            if (attempt == 100) {
+                isAppended = false;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    std::vector<uint8_t> encoded;
+    std::vector<int16_t> decoded;
+    bool isExact = encoder.finish(encoded) && isAppended && decode(encoded, decoded) && decoded == toPcm16(segment);
+    printf("streamed in 10 ms float chunks: %s\n", isExact ? "bit exact" : "DIFFERENT");
+    return isExact;
+}
+
+/**
+ * The output cap and the pending ring refuse the samples they have no room for, and say so
+ */
+static bool checkLimits(const std::vector<float> &segment) {
+    std::vector<int16_t> pcm = toPcm16(segment);
+    SegmentEncoder capped(kSampleRate, 1, (int32_t) pcm.size(), 1000);
+    std::vector<uint8_t> encoded;
+    bool isCapped = capped.begin() && capped.append(pcm.data(), (int32_t) pcm.size()) && !capped.finish(encoded) &&
+                    encoded.size() <= 1000;
+
+    SegmentEncoder small(kSampleRate, 1, 100, 1 << 20);
+    bool isRefused = small.begin() && !small.append(pcm.data(), 1000) && small.getDroppedSamples() == 1000 &&
+                     small.finish(encoded);
+    printf("output cap %s, full pending ring %s\n", isCapped ? "fails the stream" : "NOT HONORED",
+           isRefused ? "refuses and counts the samples" : "NOT HONORED");
+    return isCapped && isRefused;
+}
+
+bool runEncoderCheck(const CheckOptions &options) {
+    int format = SegmentEncoder::getFormat(kSampleRate, 1);
+    printf("format %s\n", (format & SF_FORMAT_TYPEMASK) == SF_FORMAT_FLAC ? "FLAC" : "ALAC in CAF, no FLAC codec");
+    std::vector<std::vector<float>> segments = speechSegments(options.seed);
+    bool isExact = checkSegments(segments);
+    bool isStreamed = checkStream(segments[0]);
+    bool isLimited = checkLimits(segments[1]);
+    return isExact && isStreamed && isLimited;
+}
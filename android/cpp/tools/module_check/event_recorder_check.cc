@@ -0,0 +1,264 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "echo_mix.h"
+#include "event_recorder.h"
+#include "module_check.h"
+#include "segment_encoder.h"
+
+constexpr int32_t kSampleRate = 16000;
+constexpr int32_t kSamplesPerMs = kSampleRate / 1000;
+constexpr int kBlockSamples = kSampleRate / 100;
+// 10 ms blocks every 0.5 ms, 20 times real time
+constexpr int kBlockMicros = 500;
+constexpr int64_t kSourceMs = 120000;
+// Short clips so that the merges and the cap show in a few seconds of capture
+constexpr int kPreMs = 1000;
+constexpr int kPostMs = 500;
+constexpr int kMaxClipMs = 4000;
+
+/**
+ * An event at a capture time, recorded as soon as the capture reaches it, as the detectors do
+ */
+struct ScriptedEvent {
+    ClipReason reason;
+    int64_t ms;
+};
+
+struct ExpectedClip {
+    const char *reason;
+    int64_t startMs;
+    int64_t endMs;
+};
+
+static std::vector<float> sourceAudio(uint32_t seed) {
+    std::vector<float> source = synthesizeSpeech(kSampleRate, kSourceMs / 1000.0f, 120.0f, seed, 0,
+                                                 kSourceMs / 1000.0f);
+    scaleToLevel(source, -20.0f);
+    return source;
+}
+
+/**
+ * Write the source into the recording up to endMs in 10 ms blocks, recording the events the capture reaches. Returns
+ * the number of events the recorder refused
+ */
+static int feed(SoundRecording &recording, EventRecorder &recorder, const std::vector<float> &source, int64_t endMs,
+                const std::vector<ScriptedEvent> &events, bool isPaced) {
+    int refusedNum = 0;
+    size_t nextEvent = 0;
+    int64_t endSample = endMs * kSamplesPerMs;
+    while (recording.getLength() < endSample) {
+        int64_t written = recording.getLength();
+        int count = (int) std::min<int64_t>(kBlockSamples, endSample - written);
+        recording.write(source.data() + written, count);
+        for (; nextEvent < events.size() && events[nextEvent].ms * kSamplesPerMs <= written + count; nextEvent++) {
+            refusedNum += recorder.record(events[nextEvent].reason, events[nextEvent].ms * kSamplesPerMs) ? 0 : 1;
+        }
+        if (isPaced) {
+            std::this_thread::sleep_for(std::chrono::microseconds(kBlockMicros));
+        }
+    }
+    return refusedNum;
+}
+
+static std::vector<std::string> listSpool(const std::string &directory) {
+    std::vector<std::string> names;
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return names;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] != '.') {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static void removeDirectory(const std::string &directory) {
+    for (const std::string &name : listSpool(directory)) {
+        std::string path = directory + "/" + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+            removeDirectory(path);
+        } else {
+            unlink(path.c_str());
+        }
+    }
+    rmdir(directory.c_str());
+}
+
+static std::string clipName(int64_t sequence, const char *reason, int64_t startSample) {
+    bool isFlac = (SegmentEncoder::getFormat(kSampleRate, 1) & SF_FORMAT_TYPEMASK) == SF_FORMAT_FLAC;
+    char name[96];
+    snprintf(name, sizeof(name), "clip_%06lld_%s_%lld.%s", (long long) sequence, reason, (long long) startSample,
+             isFlac ? "flac" : "caf");
+    return name;
+}
+
+/**
+ * The clip file decodes to the PCM16 of the source over its bounds
+ */
+static bool isSourceClip(const std::string &path, const std::vector<float> &source, int64_t start, int64_t end) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(SF_INFO));
+    SNDFILE *sndfile = sf_open(path.c_str(), SFM_READ, &info);
+    if (sndfile == NULL) {
+        return false;
+    }
+    std::vector<int16_t> decoded((size_t) info.frames);
+    bool isRead = sf_readf_short(sndfile, decoded.data(), info.frames) == info.frames;
+    sf_close(sndfile);
+    if (!isRead || info.channels != 1 || info.samplerate != kSampleRate || info.frames != end - start) {
+        return false;
+    }
+    rkai_pcm16_config_t config;
+    rkai_pcm16_default_config(kSampleRate, &config);
+    std::vector<int16_t> pcm(decoded.size());
+    int written = 0;
+    rkai_pcm16_encode(&config, source.data() + start, (int) pcm.size(), (uint8_t *) pcm.data(),
+                      (int) (pcm.size() * sizeof(int16_t)), &written);
+    return decoded == pcm;
+}
+
+/**
+ * A capture replayed at 20 times real time with scripted events: a trigger alone, a near miss merged into the
+ * trigger that follows it, a run of near misses split at the clip cap, a vad timeout, and a reason not recorded.
+ * Every clip must have its bounds and decode to the source
+ */
+static bool checkClips(const std::string &directory, const std::vector<float> &source) {
+    std::vector<ScriptedEvent> events = {{CLIP_TRIGGERED, 5000}, {CLIP_NEAR_MISS, 10000}, {CLIP_TRIGGERED, 10300}};
+    // Every 0.4 s from 20 s, the clip from 19 s reaches its 4 s cap at the event of 22.8 s
+    for (int64_t ms = 20000; ms <= 23600; ms += 400) {
+        events.push_back({CLIP_NEAR_MISS, ms});
+    }
+    events.push_back({CLIP_VAD_TIMEOUT, 30000});
+    const std::vector<ExpectedClip> expected = {{"triggered", 4000, 5500}, {"triggered", 9000, 10800},
+                                                {"near_miss", 19000, 23000}, {"near_miss", 23000, 24100},
+                                                {"vad_timeout", 29000, 30500}};
+
+    SoundRecording recording;
+    EventRecorder recorder(&recording, kSampleRate);
+    recorder.setClipSeconds(kPreMs / 1000.0f, kPostMs / 1000.0f, kMaxClipMs / 1000.0f);
+    if (!recorder.setSpool(directory, 100, 1LL << 30)) {
+        printf("Cannot create the spool %s\n", directory.c_str());
+        return false;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    int refusedNum = feed(recording, recorder, source, 32000, events, true);
+    // Not recorded, the reasons leave it out
+    recorder.setReasons(CLIP_TRIGGERED);
+    refusedNum += recorder.record(CLIP_NEAR_MISS, recording.getLength()) ? 0 : 1;
+    recorder.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<std::string> names = listSpool(directory);
+    bool isNamed = names.size() == expected.size();
+    int sourceNum = 0;
+    for (size_t i = 0; isNamed && i < expected.size(); i++) {
+        int64_t start = expected[i].startMs * kSamplesPerMs;
+        isNamed = names[i] == clipName((int64_t) i, expected[i].reason, start);
+        sourceNum += isNamed && isSourceClip(directory + "/" + names[i], source, start,
+                                             expected[i].endMs * kSamplesPerMs) ? 1 : 0;
+    }
+    bool isCounted = recorder.getClipCount() == expected.size() && recorder.getDroppedCount() == 0 &&
+                     refusedNum == 1;
+    printf("32 s replayed in %.1f s: %zu clips, names %s, %d decoded to the source, counters %s\n", seconds,
+           names.size(), isNamed ? "as expected" : "WRONG", sourceNum, isCounted ? "as expected" : "WRONG");
+    return isNamed && sourceNum == (int) expected.size() && isCounted;
+}
+
+static int64_t spoolBytes(const std::string &directory) {
+    int64_t bytes = 0;
+    for (const std::string &name : listSpool(directory)) {
+        struct stat info;
+        if (stat((directory + "/" + name).c_str(), &info) == 0) {
+            bytes += (int64_t) info.st_size;
+        }
+    }
+    return bytes;
+}
+
+/**
+ * The clips of the previous run count in the quotas of a new recorder: a file quota and then a byte quota evict
+ * the oldest, a stale partial clip is removed, and the sequence goes on after the clips kept
+ */
+static bool checkQuotas(const std::string &directory, const std::vector<float> &source) {
+    std::string stalePath = directory + "/" + clipName(9, "near_miss", 0) + ".part";
+    FILE *stale = fopen(stalePath.c_str(), "wb");
+    if (stale != NULL) {
+        fclose(stale);
+    }
+    SoundRecording recording;
+    EventRecorder recorder(&recording, kSampleRate);
+    recorder.setClipSeconds(kPreMs / 1000.0f, kPostMs / 1000.0f, kMaxClipMs / 1000.0f);
+    bool isSet = recorder.setSpool(directory, 3, 1LL << 30);
+    std::vector<std::string> names = listSpool(directory);
+    bool isFileQuotaOk = isSet && names.size() == 3 && names[0].compare(0, 12, "clip_000002_") == 0 &&
+                         recorder.getEvictedCount() == 2 && recorder.getSpoolBytes() == spoolBytes(directory);
+
+    int64_t maxBytes = recorder.getSpoolBytes() / 2;
+    isSet = recorder.setSpool(directory, 100, maxBytes);
+    feed(recording, recorder, source, 3000, {{CLIP_TRIGGERED, 2000}}, false);
+    recorder.flush();
+    names = listSpool(directory);
+    bool isByteQuotaOk = isSet && !names.empty() && names.back() == clipName(5, "triggered", 1000 * kSamplesPerMs) &&
+                         recorder.getSpoolBytes() <= maxBytes && recorder.getSpoolBytes() == spoolBytes(directory);
+    printf("reloaded spool: file quota of 3 %s, stale .part %s, byte quota %s, next clip %s\n",
+           isFileQuotaOk ? "evicts the 2 oldest" : "WRONG", access(stalePath.c_str(), F_OK) != 0 ? "removed" : "KEPT",
+           isByteQuotaOk ? "kept" : "EXCEEDED", names.empty() ? "missing" : names.back().c_str());
+    return isFileQuotaOk && isByteQuotaOk && access(stalePath.c_str(), F_OK) != 0;
+}
+
+/**
+ * Events ahead of the capture fill the queue of 8 clips, the next ones are refused and counted. The queued clips
+ * are written once the capture reaches them
+ */
+static bool checkQueue(const std::string &directory, const std::vector<float> &source) {
+    SoundRecording recording;
+    EventRecorder recorder(&recording, kSampleRate);
+    recorder.setClipSeconds(kPreMs / 1000.0f, kPostMs / 1000.0f, kMaxClipMs / 1000.0f);
+    if (!recorder.setSpool(directory, 100, 1LL << 30)) {
+        return false;
+    }
+    feed(recording, recorder, source, 10000, {}, false);
+    int queuedNum = 0;
+    for (int64_t ms = 100000; ms < 120000; ms += 2000) {
+        queuedNum += recorder.record(CLIP_TRIGGERED, ms * kSamplesPerMs) ? 1 : 0;
+    }
+    feed(recording, recorder, source, kSourceMs, {}, false);
+    recorder.flush();
+    size_t fileNum = listSpool(directory).size();
+    printf("events ahead of the capture: %d of 10 queued, %llu dropped, %zu clips written\n", queuedNum,
+           (unsigned long long) recorder.getDroppedCount(), fileNum);
+    return queuedNum == 8 && recorder.getDroppedCount() == 2 && recorder.getClipCount() == 8 && fileNum == 8;
+}
+
+bool runEventRecorderCheck(const CheckOptions &options) {
+    char root[] = "/tmp/module_check_XXXXXX";
+    if (mkdtemp(root) == NULL) {
+        printf("Cannot create a temporary directory\n");
+        return false;
+    }
+    std::vector<float> source = sourceAudio(options.seed);
+    bool isClipsOk = checkClips(std::string(root) + "/spool", source);
+    bool isQuotasOk = isClipsOk && checkQuotas(std::string(root) + "/spool", source);
+    bool isQueueOk = checkQueue(std::string(root) + "/queue", source);
+    removeDirectory(root);
+    return isClipsOk && isQuotasOk && isQueueOk;
+}
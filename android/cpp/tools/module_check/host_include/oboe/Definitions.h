@@ -0,0 +1,9 @@
+//
+// Created on 19/10/2026.
+//
+
+// Host stand-in for the oboe definitions, the sound recording includes them but uses none
+#ifndef SMARTROBOT_HOST_OBOE_DEFINITIONS_H
+#define SMARTROBOT_HOST_OBOE_DEFINITIONS_H
+
+#endif //SMARTROBOT_HOST_OBOE_DEFINITIONS_H
@@ -0,0 +1,82 @@
+//
+// Created on 19/10/2026.
+//
+
+// Checks the behavior of the rkai modules that run without the NPU on the host: scripted inputs with the outputs
+// they must give, round trips, and stress runs of the lock-free parts. Each check prints what it found and PASS or
+// FAIL, the exit code is non-zero if one fails.
+//
+//  module_check [--check segmenter|score_stream|pcm|encoder|packetizer|telemetry|
+//               event_recorder|session|all] [--seed N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "module_check.h"
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: module_check [options]\n"
+            "  --check NAME           segmenter, score_stream, pcm, encoder, packetizer, telemetry,\n"
+            "                         event_recorder, session or all (default all)\n"
+            "  --seed N               seed of the random inputs (default 1)\n");
+}
+
+static bool parseOptions(int argc, char **argv, CheckOptions &options, std::string &check) {
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", name.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (name == "--check") {
+            check = value;
+        } else if (name == "--seed") {
+            options.seed = (unsigned int) strtoul(value.c_str(), NULL, 10);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    CheckOptions options;
+    std::string check = "all";
+    if (!parseOptions(argc, argv, options, check)) {
+        printUsage();
+        return 1;
+    }
+
+    struct {
+        const char *name;
+        bool (*run)(const CheckOptions &options);
+    } checks[] = {{"segmenter",      runSegmenterCheck},
+                {"score_stream",   runScoreStreamCheck},
+                {"pcm",            runPcmCheck},
+                {"encoder",        runEncoderCheck},
+                {"packetizer",     runPacketizerCheck},
+                {"telemetry",      runTelemetryCheck},
+                {"event_recorder", runEventRecorderCheck},
+                {"session",        runSessionCheck}};
+    bool isKnown = false;
+    bool isPassed = true;
+    for (const auto &entry : checks) {
+        if (check != "all" && check != entry.name) {
+            continue;
+        }
+        isKnown = true;
+        printf("== %s\n", entry.name);
+        bool isEntryPassed = entry.run(options);
+        printf("%s %s\n\n", isEntryPassed ? "PASS" : "FAIL", entry.name);
+        isPassed = isPassed && isEntryPassed;
+    }
+    if (!isKnown) {
+        fprintf(stderr, "Unknown check %s\n", check.c_str());
+        printUsage();
+        return 1;
+    }
+    return isPassed ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_MODULE_CHECK_H
+#define SMARTROBOT_MODULE_CHECK_H
+
+#include "rkai.h"
+
+struct CheckOptions {
+    // Seed of the random inputs
+    unsigned int seed = 1;
+};
+
+/**
+ * Scripted vad scores through the segmenter: short bursts, a segment with its hangover, the one frame minimum, the
+ * cut at the maximum length, missing and overlapping frames. Checks every event and the counters, and that the events
+ * do not depend on how the scores are split between the pushes
+ */
+bool runSegmenterCheck(const CheckOptions &options);
+
+/**
+ * Overlapping windows of random frame scores through the vad score stream, read after each window. Checks that the
+ * frames are final once a later window starts, that they read as the mean or the max of their estimates, the frames
+ * without estimate, the frames a late reader loses and the counters
+ */
+bool runScoreStreamCheck(const CheckOptions &options);
+
+/**
+ * Float samples to PCM16 against a plain scalar conversion, for every length around the vector blocks, with and
+ * without dither and wav header, on the rounding ties and out of range samples. Checks the bytes, the header fields
+ * and the dither level, and measures the throughput
+ */
+bool runPcmCheck(const CheckOptions &options);
+
+/**
+ * Synthetic speech segments through the segment encoder, whole and streamed in 10 ms float chunks, decoded back
+ * through libsndfile. Checks that the decoded PCM16 is the input, that the output cap and the pending ring refuse
+ * what they have no room for, and measures the compression ratio and the encode time
+ */
+bool runEncoderCheck(const CheckOptions &options);
+
+/**
+ * Scripted segmenter events over a known capture through the packetizer, as the vad thread gives them: a hangover
+ * past the packets sent, a cut at the maximum length, a stalled thread losing audio, a full queue. Checks the packet
+ * samples, boundaries, flags and sequence numbers and the counters, then random segments with a consumer thread
+ */
+bool runPacketizerCheck(const CheckOptions &options);
+
+/**
+ * The telemetry ring with one writer, before and after it laps, then writer threads spinning on it while a reader
+ * snapshots it. Checks that every entry read is whole and in order and that the writes and drops add up, and
+ * measures the write and snapshot times
+ */
+bool runTelemetryCheck(const CheckOptions &options);
+
+/**
+ * A capture replayed through the sound recording at 20 times real time with scripted trigger, near miss and vad
+ * timeout events. Checks the clip bounds, merges and names and that every clip decodes to the source, then the file
+ * and byte quotas of a reloaded spool and the bound of the clip queue
+ */
+bool runEventRecorderCheck(const CheckOptions &options);
+
+/**
+ * A capture in uneven bursts with camera frames through the session recorder and a stand-in pipeline, replayed into
+ * a second pipeline. Checks that the replayed audio is the capture and that the recorded and replayed outputs and
+ * events match byte for byte, then the frame decimation, the alignment of a replay with dropped chunks, a session
+ * cut short and the duration of a paced replay
+ */
+bool runSessionCheck(const CheckOptions &options);
+
+#endif //SMARTROBOT_MODULE_CHECK_H
@@ -0,0 +1,342 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "module_check.h"
+
+constexpr int32_t kSampleRate = 16000;
+// Audio added to the recording between two polls of the vad thread
+constexpr int kBlockSamples = kSampleRate / 100;
+// The recording holds the last second, older audio is overwritten
+constexpr int64_t kRingSamples = kSampleRate;
+constexpr int kBufferSamples = kSampleRate;
+constexpr int64_t kStressSamples = 120 * (int64_t) kSampleRate;
+
+/**
+ * The capture, each sample known from its index so that every packet can be checked
+ */
+static float captureSample(int64_t index) {
+    return (float) (index % 30011) / 30011.0f - 0.5f;
+}
+
+/**
+ * Segmenter events in decision order over a capture, and the writes over which the vad thread stalls
+ */
+struct CaptureRun {
+    std::vector<rkai_vad_segment_event_t> events;
+    int64_t sampleNum;
+    int64_t stallStart;
+    int64_t stallEnd;
+};
+
+/**
+ * What the consumer gets of a segment: its start packet, its packet count and its end packet
+ */
+struct SegmentSummary {
+    uint32_t segmentId;
+    int64_t startSample;
+    int packetNum;
+    int64_t endStart;
+    int endSampleNum;
+};
+
+struct PacketizerCase {
+    const char *name;
+    CaptureRun run;
+    std::vector<SegmentSummary> expected;
+    int64_t skippedSamples;
+};
+
+static rkai_vad_segment_event_t segmentStart(int64_t startSample, int64_t decisionSample) {
+    return {RKAI_VAD_SEGMENT_START, 0, startSample, -1, decisionSample};
+}
+
+static rkai_vad_segment_event_t segmentEnd(int64_t startSample, int64_t endSample, int64_t decisionSample,
+                                           int isTruncated = 0) {
+    return {RKAI_VAD_SEGMENT_END, isTruncated, startSample, endSample, decisionSample};
+}
+
+static rkai_packetizer_t createPacketizer(int queueCapacity) {
+    rkai_packetizer_config_t config;
+    rkai_packetizer_default_config(kSampleRate, &config);
+    if (queueCapacity > 0) {
+        config.queue_capacity = queueCapacity;
+    }
+    return rkai_create_packetizer(&config);
+}
+
+/**
+ * The vad thread side, as VADCallback::streamPackets: the open segment from its cursor up to the write index, from
+ * the oldest sample the recording still holds
+ */
+static void producePackets(rkai_packetizer_t packetizer, int64_t writeIndex, std::vector<float> &buffer) {
+    int64_t cursor = -1;
+    rkai_packetizer_get_cursor(packetizer, &cursor);
+    while (cursor >= 0 && cursor < writeIndex) {
+        int64_t start = std::max(cursor, writeIndex - kRingSamples);
+        int64_t end = std::min<int64_t>(writeIndex, start + (int64_t) buffer.size());
+        for (int64_t i = start; i < end; i++) {
+            buffer[i - start] = captureSample(i);
+        }
+        int packetNum = 0;
+        rkai_packetizer_produce(packetizer, buffer.data(), start, (int) (end - start), &packetNum);
+        rkai_packetizer_get_cursor(packetizer, &cursor);
+        if (packetNum == 0) {
+            break;
+        }
+    }
+}
+
+/**
+ * The capture in 10 ms blocks: the events decided by the write index, then the packets. The tail of a segment is
+ * produced after its end event, before the start of the next one
+ */
+static void runCapture(rkai_packetizer_t packetizer, const CaptureRun &run, bool isYielding) {
+    std::vector<float> buffer(kBufferSamples);
+    size_t nextEvent = 0;
+    for (int64_t write = kBlockSamples; write <= run.sampleNum; write += kBlockSamples) {
+        if (write > run.stallStart && write < run.stallEnd) {
+            continue;
+        }
+        for (; nextEvent < run.events.size() && run.events[nextEvent].decision_sample <= write; nextEvent++) {
+            rkai_packetizer_on_event(packetizer, &run.events[nextEvent]);
+            if (run.events[nextEvent].type == RKAI_VAD_SEGMENT_END) {
+                producePackets(packetizer, write, buffer);
+            }
+        }
+        producePackets(packetizer, write, buffer);
+        if (isYielding && write % (100 * kBlockSamples) == 0) {
+            // One second of capture per millisecond, the consumer gets the core now and then
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+static std::vector<rkai_audio_packet_t> drain(rkai_packetizer_t packetizer) {
+    std::vector<rkai_audio_packet_t> packets;
+    rkai_audio_packet_t packet;
+    int hasPacket = 0;
+    while (rkai_packetizer_poll(packetizer, &packet, 0, &hasPacket) == RKAI_RET_SUCCESS && hasPacket) {
+        packets.push_back(packet);
+    }
+    return packets;
+}
+
+static bool isContentOk(const rkai_audio_packet_t &packet) {
+    for (int i = 0; i < packet.sample_num; i++) {
+        if (packet.samples[i] != captureSample(packet.start_sample + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Group the packets by segment. A segment opens on its start packet, goes on with whole packets that follow each
+ * other, or jump over the skipped samples, and closes on its end packet
+ */
+static bool summarize(const std::vector<rkai_audio_packet_t> &packets, int packetSize,
+                      std::vector<SegmentSummary> &segments, int64_t &skippedSamples) {
+    bool isOpen = false;
+    int64_t nextSample = 0;
+    skippedSamples = 0;
+    for (size_t i = 0; i < packets.size(); i++) {
+        const rkai_audio_packet_t &packet = packets[i];
+        if (packet.sequence != (uint32_t) i || !isContentOk(packet)) {
+            return false;
+        }
+        if (packet.flags & RKAI_PACKET_SEGMENT_START) {
+            if (isOpen || (!segments.empty() && packet.segment_id <= segments.back().segmentId)) {
+                return false;
+            }
+            segments.push_back({packet.segment_id, packet.start_sample, 0, -1, 0});
+            isOpen = true;
+            nextSample = packet.start_sample;
+        }
+        SegmentSummary *segment = segments.empty() ? NULL : &segments.back();
+        if (!isOpen || packet.segment_id != segment->segmentId ||
+            (packet.sample_num > 0 && packet.start_sample < nextSample)) {
+            return false;
+        }
+        bool isEnd = (packet.flags & RKAI_PACKET_SEGMENT_END) != 0;
+        // Only an end packet holds less than a whole packet, no sample if the audio up to the end was already sent
+        if (isEnd ? packet.sample_num > packetSize : packet.sample_num != packetSize) {
+            return false;
+        }
+        if (packet.sample_num > 0) {
+            skippedSamples += packet.start_sample - nextSample;
+            nextSample = packet.start_sample + packet.sample_num;
+        }
+        segment->packetNum++;
+        if (isEnd) {
+            segment->endStart = packet.start_sample;
+            segment->endSampleNum = packet.sample_num;
+            isOpen = false;
+        }
+    }
+    return !isOpen;
+}
+
+static std::vector<PacketizerCase> packetizerCases() {
+    std::vector<PacketizerCase> cases;
+    // 25 whole packets from 3200 are sent while the segmenter waits out the hangover, the end packet is empty
+    cases.push_back({"hangover past the packets",
+                     {{segmentStart(3200, 4800), segmentEnd(3200, 9700, 11300)}, 16000, -1, -1},
+                     {{1, 3200, 26, 9700, 0}}, 0});
+    // The first segment ends at its decision, its last packet holds the 100 samples up to the cut
+    cases.push_back({"cut at the maximum length",
+                     {{segmentStart(0, 480), segmentEnd(0, 6500, 6500, 1), segmentStart(6500, 6500),
+                       segmentEnd(6500, 8000, 9600)}, 12000, -1, -1},
+                     {{1, 0, 21, 6400, 100}, {2, 6500, 10, 8000, 0}}, 0});
+    // Nothing is produced from write 4960 to 30080, the recording only holds the audio from 14080 by then
+    cases.push_back({"stalled vad thread",
+                     {{segmentStart(1000, 2000), segmentEnd(1000, 40000, 41600)}, 48000, 5000, 30000},
+                     {{1, 1000, 98, 40000, 0}}, 14080 - 4840});
+    return cases;
+}
+
+static bool checkCase(const PacketizerCase &packetizerCase) {
+    rkai_packetizer_t packetizer = createPacketizer(0);
+    if (packetizer == NULL) {
+        return false;
+    }
+    runCapture(packetizer, packetizerCase.run, false);
+    std::vector<rkai_audio_packet_t> packets = drain(packetizer);
+    rkai_packetizer_stats_t stats;
+    rkai_packetizer_config_t config;
+    rkai_packetizer_default_config(kSampleRate, &config);
+    bool isRun = rkai_packetizer_get_stats(packetizer, &stats) == RKAI_RET_SUCCESS;
+    rkai_release_packetizer(packetizer);
+
+    std::vector<SegmentSummary> segments;
+    int64_t skippedSamples = 0;
+    bool isWellFormed = isRun && summarize(packets, config.packet_size, segments, skippedSamples);
+    bool isOk = isWellFormed && segments.size() == packetizerCase.expected.size();
+    for (size_t i = 0; isOk && i < segments.size(); i++) {
+        const SegmentSummary &segment = segments[i];
+        const SegmentSummary &expected = packetizerCase.expected[i];
+        isOk = segment.segmentId == expected.segmentId && segment.startSample == expected.startSample &&
+               segment.packetNum == expected.packetNum && segment.endStart == expected.endStart &&
+               segment.endSampleNum == expected.endSampleNum;
+    }
+    bool isCounted = isRun && stats.segment_count == packetizerCase.expected.size() &&
+                     stats.packet_count == packets.size() && stats.dropped_count == 0 &&
+                     stats.skipped_samples == packetizerCase.skippedSamples &&
+                     skippedSamples == packetizerCase.skippedSamples;
+    printf("%-28s %3zu packets %-11s segments %-11s counters %s\n", packetizerCase.name, packets.size(),
+           isWellFormed ? "in order" : "MISORDERED", isOk ? "as expected" : "WRONG",
+           isCounted ? "as expected" : "WRONG");
+    return isOk && isCounted;
+}
+
+/**
+ * A full queue drops the newest packets, which leave a gap in the sequence numbers. A reset empties the queue and
+ * closes the open segment
+ */
+static bool checkQueue() {
+    rkai_packetizer_t packetizer = createPacketizer(4);
+    if (packetizer == NULL) {
+        return false;
+    }
+    CaptureRun first = {{segmentStart(3200, 4800), segmentEnd(3200, 9700, 11300)}, 16000, -1, -1};
+    runCapture(packetizer, first, false);
+    std::vector<rkai_audio_packet_t> packets = drain(packetizer);
+    // A second segment after the drain, its packets go on after the dropped numbers
+    rkai_vad_segment_event_t start = segmentStart(20000, 20000);
+    std::vector<float> buffer(kBufferSamples);
+    rkai_packetizer_on_event(packetizer, &start);
+    producePackets(packetizer, 20640, buffer);
+    std::vector<rkai_audio_packet_t> after = drain(packetizer);
+    rkai_packetizer_stats_t stats;
+    rkai_packetizer_get_stats(packetizer, &stats);
+    bool isDropped = packets.size() == 4 && packets[3].sequence == 3 && after.size() == 2 &&
+                     after[0].sequence == 26 && after[0].segment_id == 2 && stats.packet_count == 28 &&
+                     stats.dropped_count == 22;
+
+    // The second segment is still open
+    int64_t cursor = 0;
+    rkai_packetizer_reset(packetizer);
+    rkai_packetizer_get_cursor(packetizer, &cursor);
+    bool isReset = cursor == -1 && drain(packetizer).empty();
+    rkai_release_packetizer(packetizer);
+    printf("4 packet queue: %zu of 26 packets kept, %llu dropped, next sequence %u; reset %s\n", packets.size(),
+           (unsigned long long) stats.dropped_count, after.empty() ? 0 : after[0].sequence,
+           isReset ? "empties the queue" : "KEEPS PACKETS");
+    return isDropped && isReset;
+}
+
+/**
+ * Random segments over two minutes of capture, produced as fast as the host goes while a consumer thread polls.
+ * Every packet received must hold its capture samples, in sequence order, and the gaps must be the dropped packets
+ */
+static bool checkConsumerThread(const CheckOptions &options) {
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<int64_t> silence(kSampleRate / 5, 3 * kSampleRate);
+    std::uniform_int_distribution<int64_t> speech(kSampleRate / 4, 6 * kSampleRate);
+    CaptureRun run = {{}, kStressSamples, -1, -1};
+    const int64_t onset = kSampleRate / 4;
+    const int64_t hangover = kSampleRate * 3 / 10;
+    for (int64_t start = silence(random); start + speech.max() + hangover < kStressSamples;) {
+        int64_t end = start + speech(random);
+        run.events.push_back(segmentStart(start, start + onset));
+        run.events.push_back(segmentEnd(start, end, end + hangover));
+        start = end + hangover + silence(random);
+    }
+    rkai_packetizer_t packetizer = createPacketizer(0);
+    if (packetizer == NULL) {
+        return false;
+    }
+    std::atomic<bool> isProducing(true);
+    std::vector<rkai_audio_packet_t> packets;
+    std::thread consumer([&] {
+        rkai_audio_packet_t packet;
+        int hasPacket = 0;
+        while (rkai_packetizer_poll(packetizer, &packet, 10, &hasPacket) == RKAI_RET_SUCCESS &&
+               (hasPacket || isProducing.load())) {
+            if (hasPacket) {
+                packets.push_back(packet);
+            }
+        }
+    });
+    auto begin = std::chrono::steady_clock::now();
+    runCapture(packetizer, run, true);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    isProducing = false;
+    consumer.join();
+    rkai_packetizer_stats_t stats;
+    rkai_packetizer_get_stats(packetizer, &stats);
+    rkai_release_packetizer(packetizer);
+
+    bool isOrdered = true;
+    int contentErrorNum = 0;
+    uint64_t gapNum = packets.empty() ? 0 : packets[0].sequence;
+    for (size_t i = 0; i < packets.size(); i++) {
+        contentErrorNum += isContentOk(packets[i]) ? 0 : 1;
+        if (i > 0) {
+            isOrdered = isOrdered && packets[i].sequence > packets[i - 1].sequence;
+            gapNum += packets[i].sequence - packets[i - 1].sequence - 1;
+        }
+    }
+    bool isCounted = packets.size() + stats.dropped_count == stats.packet_count && gapNum <= stats.dropped_count &&
+                     stats.segment_count == run.events.size() / 2;
+    printf("consumer thread: %zu segments, %zu packets received, %llu dropped, %d content errors, %s, produced in "
+           "%.0f ms\n", run.events.size() / 2, packets.size(), (unsigned long long) stats.dropped_count,
+           contentErrorNum, isOrdered ? "in order" : "MISORDERED", 1000 * seconds);
+    return isOrdered && contentErrorNum == 0 && isCounted;
+}
+
+bool runPacketizerCheck(const CheckOptions &options) {
+    bool isPassed = true;
+    for (const PacketizerCase &packetizerCase : packetizerCases()) {
+        isPassed = checkCase(packetizerCase) && isPassed;
+    }
+    isPassed = checkQueue() && isPassed;
+    return checkConsumerThread(options) && isPassed;
+}
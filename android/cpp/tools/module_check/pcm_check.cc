@@ -0,0 +1,190 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+#include "module_check.h"
+
+constexpr int kMaxLength = 69;
+constexpr int kBenchmarkSamples = 16000 * 48 / 10;
+constexpr int kBenchmarkRepeats = 200;
+
+/**
+ * The conversion written plainly, one sample at a time: scale by 32767, four interleaved xorshift32 dither
+ * generators, clip, round half to even
+ */
+static std::vector<uint8_t> referenceEncode(const rkai_pcm16_config_t &config, const std::vector<float> &samples) {
+    std::vector<uint8_t> out;
+    if (config.wav_header) {
+        out.resize(RKAI_WAV_HEADER_SIZE);
+        rkai_wav_write_header(config.sample_rate, config.n_channels, (int) samples.size(), out.data());
+    }
+    uint32_t lanes[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        lanes[i] = (config.dither_seed + 0x9e3779b9u * (i + 1)) | 1u;
+    }
+    for (size_t i = 0; i < samples.size(); i++) {
+        float scaled = samples[i] * 32767.0f;
+        if (config.dither) {
+            uint32_t &x = lanes[i % 4];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            scaled += (float) ((int) (x & 0xffff) + (int) (x >> 16) - 65535) / 65536.0f;
+        }
+        scaled = std::min(32767.0f, std::max(-32768.0f, scaled));
+        int value = (int) nearbyintf(scaled);
+        out.push_back((uint8_t) (value & 0xff));
+        out.push_back((uint8_t) ((value >> 8) & 0xff));
+    }
+    return out;
+}
+
+static bool encode(const rkai_pcm16_config_t &config, const std::vector<float> &samples, std::vector<uint8_t> &out) {
+    int size = rkai_pcm16_encoded_size(&config, (int) samples.size());
+    // Valid pointers for the empty segments too
+    float noSample = 0;
+    std::vector<uint8_t> buffer(size + 1);
+    int written = 0;
+    bool isOk = rkai_pcm16_encode(&config, samples.empty() ? &noSample : samples.data(), (int) samples.size(),
+                                  buffer.data(), size, &written) == RKAI_RET_SUCCESS && written == size;
+    out.assign(buffer.begin(), buffer.begin() + written);
+    return isOk;
+}
+
+/**
+ * Random samples with the edge cases spread in them: the rounding ties, full scale and beyond
+ */
+static std::vector<float> edgeSamples(int length, std::mt19937 &random) {
+    const float edges[] = {0.5f / 32767, 1.5f / 32767, -2.5f / 32767, 1.0f, -1.0f, 1.5f, -3.0f, 0.0f, -0.0f};
+    std::uniform_real_distribution<float> uniform(-1.1f, 1.1f);
+    std::vector<float> samples(length);
+    for (int i = 0; i < length; i++) {
+        samples[i] = i % 3 == 0 ? edges[(i / 3) % (sizeof(edges) / sizeof(edges[0]))] : uniform(random);
+    }
+    return samples;
+}
+
+/**
+ * Every length up to kMaxLength, so the vector blocks and the scalar tail meet at every offset, with and without
+ * dither and header
+ */
+static bool checkBytes(std::mt19937 &random) {
+    int mismatchNum = 0;
+    int caseNum = 0;
+    for (int dither = 0; dither < 2; dither++) {
+        for (int header = 0; header < 2; header++) {
+            rkai_pcm16_config_t config;
+            rkai_pcm16_default_config(16000, &config);
+            config.dither = dither;
+            config.dither_seed = 12345;
+            config.wav_header = header;
+            for (int length = 0; length <= kMaxLength; length++) {
+                std::vector<float> samples = edgeSamples(length, random);
+                std::vector<uint8_t> out;
+                bool isSame = encode(config, samples, out) && out == referenceEncode(config, samples);
+                mismatchNum += isSame ? 0 : 1;
+                caseNum++;
+            }
+        }
+    }
+    printf("bytes: %d of %d lengths, dither and header settings differ from the reference\n", mismatchNum, caseNum);
+    return mismatchNum == 0;
+}
+
+static uint32_t readLe32(const uint8_t *bytes) {
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+static bool checkHeader() {
+    uint8_t header[RKAI_WAV_HEADER_SIZE];
+    bool isOk = rkai_wav_write_header(16000, 2, 1000, header) == RKAI_RET_SUCCESS &&
+                memcmp(header, "RIFF", 4) == 0 && readLe32(header + 4) == 36 + 2000 &&
+                memcmp(header + 8, "WAVEfmt ", 8) == 0 && readLe32(header + 16) == 16 &&
+                (header[20] | header[21] << 8) == 1 && (header[22] | header[23] << 8) == 2 &&
+                readLe32(header + 24) == 16000 && readLe32(header + 28) == 64000 &&
+                (header[32] | header[33] << 8) == 4 && (header[34] | header[35] << 8) == 16 &&
+                memcmp(header + 36, "data", 4) == 0 && readLe32(header + 40) == 2000;
+    rkai_pcm16_config_t config;
+    rkai_pcm16_default_config(16000, &config);
+    float samples[4] = {0, 0, 0, 0};
+    uint8_t out[7];
+    int written = -1;
+    bool isRefused = rkai_pcm16_encode(&config, samples, 4, out, (int) sizeof(out), &written) != RKAI_RET_SUCCESS &&
+                     written == 0;
+    printf("wav header fields %s, short output %s\n", isOk ? "as expected" : "WRONG",
+           isRefused ? "refused" : "NOT REFUSED");
+    return isOk && isRefused;
+}
+
+/**
+ * The dither of a silent signal stays within one LSB and averages to zero, the same seed gives the same bytes
+ */
+static bool checkDither() {
+    rkai_pcm16_config_t config;
+    rkai_pcm16_default_config(16000, &config);
+    config.dither = 1;
+    std::vector<float> silence(16000, 0.0f);
+    std::vector<uint8_t> first;
+    std::vector<uint8_t> second;
+    std::vector<uint8_t> otherSeed;
+    bool isRun = encode(config, silence, first) && encode(config, silence, second);
+    config.dither_seed = 2;
+    isRun = isRun && encode(config, silence, otherSeed);
+    double sum = 0;
+    int maxValue = 0;
+    for (size_t i = 0; i + 1 < first.size(); i += 2) {
+        int value = (int16_t) (first[i] | first[i + 1] << 8);
+        sum += value;
+        maxValue = std::max(maxValue, abs(value));
+    }
+    double mean = sum / silence.size();
+    bool isOk = isRun && maxValue <= 1 && fabs(mean) < 0.02 && first == second && first != otherSeed;
+    printf("dither on silence: largest %d LSB, mean %.4f LSB, repeatable %s, seeds differ %s\n", maxValue, mean,
+           first == second ? "yes" : "no", first != otherSeed ? "yes" : "no");
+    return isOk;
+}
+
+static double samplesPerSecond(const std::function<void()> &run) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kBenchmarkRepeats; i++) {
+        run();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (double) kBenchmarkSamples * kBenchmarkRepeats / seconds;
+}
+
+static void measureThroughput(std::mt19937 &random) {
+    std::vector<float> segment = edgeSamples(kBenchmarkSamples, random);
+    rkai_pcm16_config_t config;
+    rkai_pcm16_default_config(16000, &config);
+    std::vector<uint8_t> out(rkai_pcm16_encoded_size(&config, kBenchmarkSamples));
+    int written;
+    double plain = samplesPerSecond([&] {
+        rkai_pcm16_encode(&config, segment.data(), kBenchmarkSamples, out.data(), (int) out.size(), &written);
+    });
+    config.dither = 1;
+    double dithered = samplesPerSecond([&] {
+        rkai_pcm16_encode(&config, segment.data(), kBenchmarkSamples, out.data(), (int) out.size(), &written);
+    });
+    double reference = samplesPerSecond([&] { referenceEncode(config, segment); });
+    printf("4.8 s segment: %.0f Msamples/s, %.0f with dither, %.0f for the reference\n", plain / 1e6,
+           dithered / 1e6, reference / 1e6);
+}
+
+bool runPcmCheck(const CheckOptions &options) {
+    std::mt19937 random(options.seed);
+    bool isSame = checkBytes(random);
+    bool isHeaderOk = checkHeader();
+    bool isDitherOk = checkDither();
+    measureThroughput(random);
+    return isSame && isHeaderOk && isDitherOk;
+}
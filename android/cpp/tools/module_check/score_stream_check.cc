@@ -0,0 +1,206 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "module_check.h"
+
+constexpr int kHopLength = 320;
+constexpr int kWindowFrames = 10;
+constexpr int kStrideFrames = 4;
+constexpr int kWindowNum = 200;
+
+/**
+ * Every estimate of every frame, to merge them on the host
+ */
+struct FrameEstimates {
+    std::vector<std::vector<float>> estimates;
+
+    void add(int64_t firstFrame, const std::vector<float> &scores) {
+        if (estimates.size() < firstFrame + scores.size()) {
+            estimates.resize(firstFrame + scores.size());
+        }
+        for (size_t i = 0; i < scores.size(); i++) {
+            estimates[firstFrame + i].push_back(scores[i]);
+        }
+    }
+
+    float merged(int64_t frame, rkai_vad_merge_t merge) const {
+        const std::vector<float> &frameEstimates = estimates[frame];
+        if (frameEstimates.empty()) {
+            return 0;
+        }
+        if (merge == RKAI_VAD_MERGE_MAX) {
+            return *std::max_element(frameEstimates.begin(), frameEstimates.end());
+        }
+        float sum = 0;
+        for (float estimate : frameEstimates) {
+            sum += estimate;
+        }
+        return sum / (float) frameEstimates.size();
+    }
+};
+
+static rkai_vad_score_stream_t createStream(rkai_vad_merge_t merge, int capacity) {
+    rkai_vad_score_stream_config_t config;
+    config.hop_length = kHopLength;
+    config.window_frame_num = kWindowFrames;
+    config.capacity = capacity;
+    config.merge = merge;
+    return rkai_create_vad_score_stream(&config);
+}
+
+/**
+ * Read all the final frames, checking they follow the frames read before
+ */
+static bool readFrames(rkai_vad_score_stream_t stream, int64_t &nextFrame, std::vector<float> &frames) {
+    float scores[4 * kWindowFrames];
+    int64_t firstFrame = 0;
+    int frameNum = 0;
+    do {
+        if (rkai_vad_score_stream_read(stream, scores, 4 * kWindowFrames, &firstFrame, &frameNum) !=
+            RKAI_RET_SUCCESS || (frameNum > 0 && firstFrame != nextFrame)) {
+            return false;
+        }
+        frames.insert(frames.end(), scores, scores + frameNum);
+        nextFrame += frameNum;
+    } while (frameNum > 0);
+    return true;
+}
+
+/**
+ * Overlapping windows of random scores read after each add: the frames before the window added are final, and each
+ * reads as the mean or the max of its estimates
+ */
+static bool checkMerge(rkai_vad_merge_t merge, std::mt19937 &random) {
+    rkai_vad_score_stream_t stream = createStream(merge, 4 * kWindowFrames);
+    if (stream == NULL) {
+        return false;
+    }
+    std::uniform_real_distribution<float> uniform(0, 1);
+    FrameEstimates reference;
+    std::vector<float> frames;
+    int64_t nextFrame = 0;
+    bool isFinalOk = true;
+    bool isOk = true;
+    for (int w = 0; isOk && w < kWindowNum; w++) {
+        std::vector<float> scores(kWindowFrames);
+        for (float &score : scores) {
+            score = uniform(random);
+        }
+        int64_t firstFrame = (int64_t) w * kStrideFrames;
+        reference.add(firstFrame, scores);
+        isOk = rkai_vad_score_stream_add(stream, firstFrame, scores.data(), kWindowFrames) == RKAI_RET_SUCCESS &&
+               readFrames(stream, nextFrame, frames);
+        isFinalOk = isFinalOk && nextFrame == firstFrame;
+    }
+    isOk = isOk && rkai_vad_score_stream_flush(stream) == RKAI_RET_SUCCESS && readFrames(stream, nextFrame, frames);
+    rkai_vad_score_stream_stats_t stats;
+    isOk = isOk && rkai_vad_score_stream_get_stats(stream, &stats) == RKAI_RET_SUCCESS;
+    rkai_release_vad_score_stream(stream);
+    if (!isOk) {
+        printf("Cannot run the score stream\n");
+        return false;
+    }
+
+    float maxError = 0;
+    uint64_t estimateNum = 0;
+    for (size_t frame = 0; frame < reference.estimates.size(); frame++) {
+        estimateNum += reference.estimates[frame].size();
+        if (frame < frames.size()) {
+            maxError = std::max(maxError, fabsf(frames[frame] - reference.merged((int64_t) frame, merge)));
+        }
+    }
+    uint64_t frameNum = reference.estimates.size();
+    bool isComplete = frames.size() == frameNum;
+    bool isCounted = stats.window_count == kWindowNum && stats.read_frame_count == frameNum &&
+                     stats.merged_frame_count == estimateNum - frameNum && stats.dropped_frame_count == 0;
+    printf("%-4s merge: %zu of %llu frames read, largest difference %.1e, final at each window %s, counters %s\n",
+           merge == RKAI_VAD_MERGE_MAX ? "max" : "mean", frames.size(), (unsigned long long) frameNum, maxError,
+           isFinalOk ? "yes" : "no", isCounted ? "as expected" : "WRONG");
+    return isComplete && maxError < 1e-6f && isFinalOk && isCounted;
+}
+
+/**
+ * Frames between two windows have no estimate and read as 0
+ */
+static bool checkGap() {
+    rkai_vad_score_stream_t stream = createStream(RKAI_VAD_MERGE_MEAN, 4 * kWindowFrames);
+    if (stream == NULL) {
+        return false;
+    }
+    std::vector<float> ones(kWindowFrames, 1.0f);
+    std::vector<float> halves(kWindowFrames, 0.5f);
+    std::vector<float> frames;
+    int64_t nextFrame = 0;
+    // Frames 10 to 14 have no estimate
+    bool isOk = rkai_vad_score_stream_add(stream, 0, ones.data(), kWindowFrames) == RKAI_RET_SUCCESS &&
+                rkai_vad_score_stream_add(stream, 15, ones.data(), kWindowFrames) == RKAI_RET_SUCCESS &&
+                rkai_vad_score_stream_add(stream, 20, halves.data(), kWindowFrames) == RKAI_RET_SUCCESS &&
+                readFrames(stream, nextFrame, frames) && rkai_vad_score_stream_flush(stream) == RKAI_RET_SUCCESS &&
+                readFrames(stream, nextFrame, frames);
+    rkai_release_vad_score_stream(stream);
+    std::vector<float> expected;
+    expected.insert(expected.end(), 10, 1.0f);
+    expected.insert(expected.end(), 5, 0.0f);
+    expected.insert(expected.end(), 5, 1.0f);
+    expected.insert(expected.end(), 5, 0.75f);
+    expected.insert(expected.end(), 5, 0.5f);
+    bool isSame = isOk && frames.size() == expected.size();
+    for (size_t i = 0; isSame && i < frames.size(); i++) {
+        isSame = fabsf(frames[i] - expected[i]) < 1e-6f;
+    }
+    printf("gap: %zu frames %s\n", frames.size(), isSame ? "as expected" : "WRONG");
+    return isSame;
+}
+
+/**
+ * A reader falling behind loses the oldest frames, counted, and goes on from the oldest frame held. After a reset
+ * the frames start at the frame given
+ */
+static bool checkDropAndReset() {
+    constexpr int kCapacity = 2 * kWindowFrames;
+    rkai_vad_score_stream_t stream = createStream(RKAI_VAD_MERGE_MEAN, kCapacity);
+    if (stream == NULL) {
+        return false;
+    }
+    std::vector<float> ones(kWindowFrames, 1.0f);
+    bool isOk = true;
+    // Frames 0 to 39 added without reading, 20 of them held
+    for (int64_t first = 0; isOk && first < 4 * kWindowFrames; first += kWindowFrames) {
+        isOk = rkai_vad_score_stream_add(stream, first, ones.data(), kWindowFrames) == RKAI_RET_SUCCESS;
+    }
+    float scores[kCapacity];
+    int64_t firstFrame = -1;
+    int frameNum = 0;
+    isOk = isOk && rkai_vad_score_stream_read(stream, scores, kCapacity, &firstFrame, &frameNum) == RKAI_RET_SUCCESS;
+    rkai_vad_score_stream_stats_t stats;
+    isOk = isOk && rkai_vad_score_stream_get_stats(stream, &stats) == RKAI_RET_SUCCESS;
+    // The last window is not final yet
+    bool isDropped = isOk && firstFrame == 2 * kWindowFrames && frameNum == kWindowFrames &&
+                     stats.dropped_frame_count == 2 * kWindowFrames;
+
+    int64_t resetFirstFrame = -1;
+    isOk = isOk && rkai_vad_score_stream_reset(stream, 1000) == RKAI_RET_SUCCESS &&
+           rkai_vad_score_stream_add(stream, 1000, ones.data(), kWindowFrames) == RKAI_RET_SUCCESS &&
+           rkai_vad_score_stream_flush(stream) == RKAI_RET_SUCCESS &&
+           rkai_vad_score_stream_read(stream, scores, kCapacity, &resetFirstFrame, &frameNum) == RKAI_RET_SUCCESS;
+    bool isReset = isOk && resetFirstFrame == 1000 && frameNum == kWindowFrames;
+    rkai_release_vad_score_stream(stream);
+    printf("late reader: read from frame %lld, %llu frames dropped; after a reset read from frame %lld\n",
+           (long long) firstFrame, (unsigned long long) stats.dropped_frame_count, (long long) resetFirstFrame);
+    return isDropped && isReset;
+}
+
+bool runScoreStreamCheck(const CheckOptions &options) {
+    std::mt19937 random(options.seed);
+    bool isMean = checkMerge(RKAI_VAD_MERGE_MEAN, random);
+    bool isMax = checkMerge(RKAI_VAD_MERGE_MAX, random);
+    bool isGapOk = checkGap();
+    bool isDropOk = checkDropAndReset();
+    return isMean && isMax && isGapOk && isDropOk;
+}
@@ -0,0 +1,245 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "module_check.h"
+
+constexpr int kHopLength = 160;
+// Short durations so the scripts stay readable: 3 frames of minimum speech, 5 of hangover, 20 per segment at most
+constexpr int kMinSpeechFrames = 3;
+constexpr int kHangoverFrames = 5;
+constexpr int kMaxSegmentFrames = 20;
+constexpr float kSpeech = 0.9f;
+// Over the offset threshold, not over the onset one
+constexpr float kWeakSpeech = 0.4f;
+constexpr int kRandomFrameNum = 5000;
+
+/**
+ * Scores of consecutive frames given to one push
+ */
+struct SegmenterPush {
+    int64_t firstFrame;
+    std::vector<float> scores;
+};
+
+struct ExpectedEvent {
+    rkai_vad_segment_event_type_t type;
+    int isTruncated;
+    int64_t startFrame;
+    // Frame after the last speech frame, -1 for a start
+    int64_t endFrame;
+    int64_t decisionFrame;
+};
+
+struct SegmenterCase {
+    const char *name;
+    int minSpeechFrames;
+    std::vector<SegmenterPush> pushes;
+    std::vector<ExpectedEvent> expected;
+    uint64_t truncatedNum;
+};
+
+static rkai_vad_segmenter_config_t segmenterConfig(int minSpeechFrames) {
+    rkai_vad_segmenter_config_t config;
+    rkai_vad_segmenter_default_config(16000, kHopLength, &config);
+    config.min_speech = minSpeechFrames * kHopLength;
+    config.hangover = kHangoverFrames * kHopLength;
+    config.max_segment = kMaxSegmentFrames * kHopLength;
+    return config;
+}
+
+/**
+ * Consecutive runs of frames, each of a frame count and a score
+ */
+static std::vector<float> scoreRuns(std::initializer_list<std::pair<int, float>> runs) {
+    std::vector<float> scores;
+    for (const auto &run : runs) {
+        scores.insert(scores.end(), run.first, run.second);
+    }
+    return scores;
+}
+
+static ExpectedEvent segmentStart(int64_t startFrame, int64_t decisionFrame) {
+    return {RKAI_VAD_SEGMENT_START, 0, startFrame, -1, decisionFrame};
+}
+
+static ExpectedEvent segmentEnd(int64_t startFrame, int64_t endFrame, int64_t decisionFrame, int isTruncated = 0) {
+    return {RKAI_VAD_SEGMENT_END, isTruncated, startFrame, endFrame, decisionFrame};
+}
+
+static bool isSameEvent(const rkai_vad_segment_event_t &event, const rkai_vad_segment_event_t &other) {
+    return event.type == other.type && event.is_truncated == other.is_truncated &&
+           event.start_sample == other.start_sample && event.end_sample == other.end_sample &&
+           event.decision_sample == other.decision_sample;
+}
+
+static bool matchesEvent(const rkai_vad_segment_event_t &event, const ExpectedEvent &expected) {
+    rkai_vad_segment_event_t sample;
+    sample.type = expected.type;
+    sample.is_truncated = expected.isTruncated;
+    sample.start_sample = expected.startFrame * kHopLength;
+    sample.end_sample = expected.endFrame < 0 ? -1 : expected.endFrame * kHopLength;
+    sample.decision_sample = expected.decisionFrame * kHopLength;
+    return isSameEvent(event, sample);
+}
+
+static bool runPushes(const rkai_vad_segmenter_config_t &config, const std::vector<SegmenterPush> &pushes,
+                      std::vector<rkai_vad_segment_event_t> &events, rkai_vad_segmenter_stats_t &stats) {
+    rkai_vad_segmenter_t segmenter = rkai_create_vad_segmenter(&config);
+    if (segmenter == NULL) {
+        return false;
+    }
+    bool isOk = true;
+    events.clear();
+    for (const SegmenterPush &push : pushes) {
+        // Room for a start and an end per frame, more than a push can emit
+        std::vector<rkai_vad_segment_event_t> pushEvents(2 * push.scores.size() + 2);
+        int eventNum = 0;
+        isOk = isOk && rkai_vad_segmenter_push(segmenter, push.firstFrame, push.scores.data(),
+                                               (int) push.scores.size(), pushEvents.data(),
+                                               (int) pushEvents.size(), &eventNum) == RKAI_RET_SUCCESS;
+        events.insert(events.end(), pushEvents.begin(), pushEvents.begin() + eventNum);
+    }
+    isOk = isOk && rkai_vad_segmenter_get_stats(segmenter, &stats) == RKAI_RET_SUCCESS;
+    rkai_release_vad_segmenter(segmenter);
+    return isOk;
+}
+
+static std::vector<SegmenterCase> segmenterCases() {
+    std::vector<SegmenterCase> cases;
+    cases.push_back({"short burst", kMinSpeechFrames, {{0, scoreRuns({{5, 0}, {2, kSpeech}, {10, 0}})}}, {}, 0});
+    cases.push_back({"candidate dropped under the offset", kMinSpeechFrames,
+                     {{0, scoreRuns({{2, 0}, {1, kSpeech}, {1, 0.2f}, {2, kSpeech}, {10, 0}})}}, {}, 0});
+    // Speech from frame 5, weak up to frame 16, the hangover ends it at frame 21
+    cases.push_back({"segment", kMinSpeechFrames,
+                     {{0, scoreRuns({{5, 0}, {10, kSpeech}, {2, kWeakSpeech}, {14, 0}})}},
+                     {segmentStart(5, 8), segmentEnd(5, 17, 22)}, 0});
+    // The onset frame alone reaches the minimum and starts the segment
+    cases.push_back({"one frame minimum", 1, {{0, scoreRuns({{3, 0}, {1, kSpeech}, {10, 0}})}},
+                     {segmentStart(3, 4), segmentEnd(3, 4, 9)}, 0});
+    cases.push_back({"cut at the maximum length", kMinSpeechFrames, {{0, scoreRuns({{45, kSpeech}, {10, 0}})}},
+                     {segmentStart(0, 3), segmentEnd(0, 20, 20, 1), segmentStart(20, 20), segmentEnd(20, 40, 40, 1),
+                      segmentStart(40, 40), segmentEnd(40, 45, 50)}, 2});
+    // Frames 10 to 29 are never pushed, they are silence
+    cases.push_back({"missing frames", kMinSpeechFrames,
+                     {{0, scoreRuns({{10, kSpeech}})}, {30, scoreRuns({{5, 0}})}},
+                     {segmentStart(0, 3), segmentEnd(0, 10, 15)}, 0});
+    // The second window repeats frames 10 to 19 with other scores, the first ones are kept
+    cases.push_back({"overlapping windows", kMinSpeechFrames,
+                     {{0, scoreRuns({{5, 0}, {15, kSpeech}})}, {10, scoreRuns({{10, 0}, {10, kSpeech}})},
+                      {30, scoreRuns({{10, 0}})}},
+                     {segmentStart(5, 8), segmentEnd(5, 25, 25, 1), segmentStart(25, 25), segmentEnd(25, 30, 35)}, 1});
+    return cases;
+}
+
+static bool checkCase(const SegmenterCase &segmenterCase) {
+    rkai_vad_segmenter_config_t config = segmenterConfig(segmenterCase.minSpeechFrames);
+    std::vector<rkai_vad_segment_event_t> events;
+    rkai_vad_segmenter_stats_t stats;
+    if (!runPushes(config, segmenterCase.pushes, events, stats)) {
+        printf("%-36s cannot run the segmenter\n", segmenterCase.name);
+        return false;
+    }
+    bool isOk = events.size() == segmenterCase.expected.size();
+    uint64_t segmentNum = 0;
+    int64_t speechFrameNum = 0;
+    for (size_t i = 0; i < segmenterCase.expected.size(); i++) {
+        const ExpectedEvent &expected = segmenterCase.expected[i];
+        isOk = isOk && matchesEvent(events[i], expected);
+        if (expected.type == RKAI_VAD_SEGMENT_END) {
+            segmentNum++;
+            speechFrameNum += expected.endFrame - expected.startFrame;
+        }
+    }
+    const SegmenterPush &last = segmenterCase.pushes.back();
+    int64_t frameNum = last.firstFrame + (int64_t) last.scores.size();
+    bool isCounted = stats.frame_count == frameNum && stats.segment_count == segmentNum &&
+                     stats.truncated_count == segmenterCase.truncatedNum &&
+                     stats.speech_samples == speechFrameNum * kHopLength;
+    printf("%-36s %2zu events %-11s counters %s\n", segmenterCase.name, events.size(), isOk ? "as expected" : "WRONG",
+           isCounted ? "as expected" : "WRONG");
+    return isOk && isCounted;
+}
+
+/**
+ * Runs of speech and silence of random lengths with noisy scores, crossing every threshold
+ */
+static std::vector<float> randomScores(std::mt19937 &random) {
+    std::vector<float> scores;
+    std::uniform_int_distribution<int> runLength(1, 40);
+    std::uniform_real_distribution<float> noise(-0.35f, 0.35f);
+    bool isSpeech = false;
+    while ((int) scores.size() < kRandomFrameNum) {
+        int length = runLength(random) * (isSpeech ? 2 : 1);
+        for (int i = 0; i < length; i++) {
+            scores.push_back(std::min(1.0f, std::max(0.0f, (isSpeech ? 0.75f : 0.2f) + noise(random))));
+        }
+        isSpeech = !isSpeech;
+    }
+    scores.resize(kRandomFrameNum);
+    return scores;
+}
+
+/**
+ * The same scores pushed at once, in chunks of random sizes, and as overlapping windows whose repeated frames hold
+ * other scores, must give the same events
+ */
+static bool checkSplits(const CheckOptions &options) {
+    std::mt19937 random(options.seed);
+    std::vector<float> scores = randomScores(random);
+    std::vector<SegmenterPush> whole = {{0, scores}};
+    std::vector<SegmenterPush> chunks;
+    std::uniform_int_distribution<int> chunkLength(1, 37);
+    for (int first = 0; first < kRandomFrameNum;) {
+        int length = std::min(chunkLength(random), kRandomFrameNum - first);
+        chunks.push_back({first, std::vector<float>(scores.begin() + first, scores.begin() + first + length)});
+        first += length;
+    }
+    std::vector<SegmenterPush> windows;
+    constexpr int kWindowFrames = 20;
+    constexpr int kStrideFrames = 7;
+    for (int first = 0; first < kRandomFrameNum; first += kStrideFrames) {
+        int length = std::min(kWindowFrames, kRandomFrameNum - first);
+        std::vector<float> window(scores.begin() + first, scores.begin() + first + length);
+        // The frames the previous window already gave are inverted, they must be ignored
+        for (int i = 0; first > 0 && i < kWindowFrames - kStrideFrames && i < length; i++) {
+            window[i] = 1 - window[i];
+        }
+        windows.push_back({first, window});
+    }
+
+    rkai_vad_segmenter_config_t config = segmenterConfig(kMinSpeechFrames);
+    std::vector<rkai_vad_segment_event_t> expected;
+    std::vector<rkai_vad_segment_event_t> chunked;
+    std::vector<rkai_vad_segment_event_t> windowed;
+    rkai_vad_segmenter_stats_t stats;
+    if (!runPushes(config, whole, expected, stats) || !runPushes(config, chunks, chunked, stats) ||
+        !runPushes(config, windows, windowed, stats)) {
+        printf("Cannot run the segmenter on the random scores\n");
+        return false;
+    }
+    auto isSame = [&expected](const std::vector<rkai_vad_segment_event_t> &events) {
+        return events.size() == expected.size() && std::equal(events.begin(), events.end(), expected.begin(),
+                                                              isSameEvent);
+    };
+    bool isChunkedSame = isSame(chunked);
+    bool isWindowedSame = isSame(windowed);
+    printf("%d random frames: %zu events at once, %zu pushes %s, %zu windows %s\n", kRandomFrameNum, expected.size(),
+           chunks.size(), isChunkedSame ? "same" : "DIFFERENT", windows.size(), isWindowedSame ? "same" : "DIFFERENT");
+    if (expected.empty()) {
+        printf("The random scores give no segment, the split check checks nothing\n");
+    }
+    return !expected.empty() && isChunkedSame && isWindowedSame;
+}
+
+bool runSegmenterCheck(const CheckOptions &options) {
+    bool isPassed = true;
+    for (const SegmenterCase &segmenterCase : segmenterCases()) {
+        isPassed = checkCase(segmenterCase) && isPassed;
+    }
+    return checkSplits(options) && isPassed;
+}
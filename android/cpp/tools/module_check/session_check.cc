@@ -0,0 +1,408 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "echo_mix.h"
+#include "module_check.h"
+#include "session_recorder.h"
+
+constexpr int32_t kSampleRate = 16000;
+constexpr int kHopLength = 320;
+constexpr float kSessionSeconds = 20;
+// A camera frame every 200 ms of capture
+constexpr int kFrameSamples = kSampleRate / 5;
+constexpr int kFrameWidth = 320;
+constexpr int kFrameHeight = 240;
+// The round trip is recorded at 10 times real time
+constexpr int kSpeedUp = 10;
+constexpr float kPacedSeconds = 1;
+
+/**
+ * A chunk of a model output or an event, as produced and as read back
+ */
+struct OutputChunk {
+    uint32_t type;
+    uint32_t source;
+    int64_t position;
+    std::vector<uint8_t> payload;
+
+    bool operator==(const OutputChunk &other) const {
+        return type == other.type && source == other.source && position == other.position &&
+               payload == other.payload;
+    }
+};
+
+/**
+ * Stand-in for the detectors, driven by the audio and the frames it is given: a frame score from the level, the vad
+ * segmenter on it, and a face detector giving a checksum and the brightest row of each frame. Every output is kept,
+ * and recorded if a recorder is given
+ */
+class StubPipeline {
+public:
+    StubPipeline(SessionRecorder *recorder) : mRecorder(recorder) {
+        rkai_vad_segmenter_config_t config;
+        rkai_vad_segmenter_default_config(kSampleRate, kHopLength, &config);
+        mSegmenter = rkai_create_vad_segmenter(&config);
+    }
+
+    ~StubPipeline() {
+        rkai_release_vad_segmenter(mSegmenter);
+    }
+
+    void onAudio(int64_t firstSample, const float *samples, int32_t numSamples) {
+        if (firstSample != mNextSample) {
+            mIsAligned = false;
+        }
+        mNextSample = firstSample + numSamples;
+        mPending.insert(mPending.end(), samples, samples + numSamples);
+        size_t used = 0;
+        for (; used + kHopLength <= mPending.size(); used += kHopLength) {
+            double energy = 0;
+            for (int i = 0; i < kHopLength; i++) {
+                energy += mPending[used + i] * mPending[used + i];
+            }
+            float score = std::min(1.0f, 20 * (float) sqrt(energy / kHopLength));
+            emit(RKAI_CHUNK_MODEL_OUTPUT, SESSION_SOURCE_VAD, mFrame * kHopLength, &score, sizeof(float));
+            rkai_vad_segment_event_t events[4];
+            int eventNum = 0;
+            rkai_vad_segmenter_push(mSegmenter, mFrame, &score, 1, events, 4, &eventNum);
+            for (int i = 0; i < eventNum; i++) {
+                emit(RKAI_CHUNK_EVENT, SESSION_SOURCE_VAD, events[i].decision_sample, &events[i],
+                     sizeof(rkai_vad_segment_event_t));
+            }
+            mFrame++;
+        }
+        mPending.erase(mPending.begin(), mPending.begin() + used);
+    }
+
+    void onFrame(int64_t frame, const rkai_image_t &image) {
+        uint32_t face[2] = {2166136261u, 0};
+        uint32_t brightest = 0;
+        size_t rowSize = (size_t) image.width * 3;
+        for (uint32_t y = 0; y < image.height; y++) {
+            uint32_t brightness = 0;
+            for (size_t x = 0; x < rowSize; x++) {
+                face[0] = (face[0] ^ image.data[y * rowSize + x]) * 16777619u;
+                brightness += image.data[y * rowSize + x];
+            }
+            if (brightness > brightest) {
+                brightest = brightness;
+                face[1] = y;
+            }
+        }
+        emit(RKAI_CHUNK_MODEL_OUTPUT, SESSION_SOURCE_FACE, frame, face, sizeof(face));
+    }
+
+    const std::vector<OutputChunk> &getOutputs() const { return mOutputs; };
+
+    bool isAligned() const { return mIsAligned; };
+
+private:
+    SessionRecorder *mRecorder;
+    rkai_vad_segmenter_t mSegmenter;
+    std::vector<float> mPending;
+    int64_t mNextSample = 0;
+    int64_t mFrame = 0;
+    bool mIsAligned = true;
+    std::vector<OutputChunk> mOutputs;
+
+    void emit(rkai_chunk_type type, SessionSource source, int64_t position, const void *payload, int size) {
+        const uint8_t *bytes = (const uint8_t *) payload;
+        mOutputs.push_back({(uint32_t) type, (uint32_t) source, position, std::vector<uint8_t>(bytes, bytes + size)});
+        if (mRecorder != nullptr) {
+            mRecorder->record(type, source, position, payload, size);
+        }
+    }
+};
+
+static std::vector<uint8_t> makeFrame(int64_t frame, int width, int height) {
+    std::vector<uint8_t> pixels((size_t) width * height * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width * 3; x++) {
+            pixels[(size_t) y * width * 3 + x] = (uint8_t) (x * 7 + y * 13 + frame * 31 + (y == frame % height) * 90);
+        }
+    }
+    return pixels;
+}
+
+static rkai_image_t frameImage(std::vector<uint8_t> &pixels, int width, int height) {
+    rkai_image_t image;
+    memset(&image, 0, sizeof(rkai_image_t));
+    image.data = pixels.data();
+    image.size = (uint32_t) pixels.size();
+    image.is_prealloc_buf = 1;
+    image.pixel_format = RKAI_PIXEL_FORMAT_RGB888;
+    image.width = (uint32_t) width;
+    image.height = (uint32_t) height;
+    image.original_ratio = 1;
+    image.scale_ratio = 1;
+    return image;
+}
+
+static std::vector<float> sourceAudio(uint32_t seed, float seconds) {
+    std::vector<float> source = synthesizeSpeech(kSampleRate, seconds, 110.0f, seed, 0, seconds);
+    scaleToLevel(source, -20.0f);
+    return source;
+}
+
+static int64_t fileSize(const std::string &path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? (int64_t) info.st_size : -1;
+}
+
+/**
+ * The capture in bursts of 5 to 60 ms, as the audio callback gives it, with a frame every 200 ms, through the
+ * recorder and the pipeline. The bursts are paced at speedUp times real time, as fast as possible at 0
+ */
+static void recordCapture(SessionRecorder &recorder, StubPipeline *pipeline, const std::vector<float> &source,
+                          int speedUp, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> burst(kSampleRate / 200, kSampleRate * 6 / 100);
+    auto start = std::chrono::steady_clock::now();
+    int64_t nextFrame = 0;
+    for (int64_t written = 0; written < (int64_t) source.size();) {
+        int count = (int) std::min<int64_t>(burst(random), (int64_t) source.size() - written);
+        recorder.recordAudio(written, source.data() + written, count);
+        if (pipeline != nullptr) {
+            pipeline->onAudio(written, source.data() + written, count);
+        }
+        written += count;
+        for (; pipeline != nullptr && nextFrame * kFrameSamples <= written; nextFrame++) {
+            std::vector<uint8_t> pixels = makeFrame(nextFrame, kFrameWidth, kFrameHeight);
+            rkai_image_t image = frameImage(pixels, kFrameWidth, kFrameHeight);
+            recorder.recordImage(nextFrame, image);
+            pipeline->onFrame(nextFrame, image);
+        }
+        if (speedUp > 0) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(written * 1000000 / kSampleRate /
+                                                                             speedUp));
+        }
+    }
+}
+
+/**
+ * Recorded at 10 times real time with full frames, then replayed as fast as possible into a second pipeline: the
+ * replayed audio is the capture, and the replay gives the recorded outputs and events byte for byte
+ */
+static bool checkRoundTrip(const std::string &path, const std::vector<float> &source, uint32_t seed) {
+    rkai_session_config_t config;
+    rkai_session_default_config(&config);
+    config.max_image_width = 0;
+    config.queue_bytes = 16 << 20;
+    SessionRecorder recorder;
+    StubPipeline live(&recorder);
+    if (!recorder.startRecording(path, config)) {
+        printf("Cannot record the session %s\n", path.c_str());
+        return false;
+    }
+    recordCapture(recorder, &live, source, kSpeedUp, seed);
+    recorder.stopRecording();
+
+    SessionRecorder replayer;
+    StubPipeline replayed(nullptr);
+    std::vector<OutputChunk> recorded;
+    std::vector<float> audio;
+    replayer.setAudioListener([&](int64_t firstSample, const float *samples, int32_t numSamples) {
+        replayed.onAudio(firstSample, samples, numSamples);
+        audio.insert(audio.end(), samples, samples + numSamples);
+    });
+    replayer.setFrameListener([&](int64_t frame, const rkai_image_t &image) { replayed.onFrame(frame, image); });
+    replayer.setChunkListener([&](const rkai_chunk_header_t &header, const uint8_t *payload) {
+        recorded.push_back({header.type, header.source, header.position,
+                            std::vector<uint8_t>(payload, payload + header.size)});
+    });
+    auto start = std::chrono::steady_clock::now();
+    bool isReplayed = replayer.replay(path, false);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const std::vector<OutputChunk> &outputs = live.getOutputs();
+    int eventNum = 0;
+    for (const OutputChunk &output : outputs) {
+        eventNum += output.type == RKAI_CHUNK_EVENT ? 1 : 0;
+    }
+    bool isAudioSame = audio == source && replayed.isAligned();
+    bool isRecordedSame = recorded == outputs;
+    bool isReplayedSame = replayed.getOutputs() == outputs;
+    printf("%.0f s with %d frames of %dx%d, %.1f MB: replayed in %.2f s, audio %s, %zu outputs and %d events "
+           "recorded %s, replayed %s\n", kSessionSeconds, (int) (source.size() / kFrameSamples) + 1, kFrameWidth,
+           kFrameHeight, fileSize(path) / 1e6, seconds, isAudioSame ? "bit exact" : "DIFFERENT",
+           outputs.size() - eventNum, eventNum, isRecordedSame ? "byte for byte" : "DIFFERENT",
+           isReplayedSame ? "byte for byte" : "DIFFERENT");
+    if (eventNum == 0) {
+        printf("The capture gives no vad event, the round trip checks no event\n");
+    }
+    return isReplayed && isAudioSame && isRecordedSame && isReplayedSame && eventNum > 0;
+}
+
+/**
+ * The default writer keeps one pixel in 4 of a 640x480 frame on each axis
+ */
+static bool checkDecimation(const std::string &path) {
+    rkai_session_config_t config;
+    rkai_session_default_config(&config);
+    rkai_session_writer_t writer = rkai_create_session_writer(path.c_str(), &config);
+    if (writer == NULL) {
+        return false;
+    }
+    std::vector<uint8_t> pixels = makeFrame(7, 640, 480);
+    rkai_image_t image = frameImage(pixels, 640, 480);
+    bool isWritten = rkai_session_write_image(writer, SESSION_SOURCE_FACE, 7, &image) == RKAI_RET_SUCCESS;
+    rkai_release_session_writer(writer);
+
+    rkai_session_reader_t reader = rkai_open_session_reader(path.c_str(), NULL);
+    rkai_chunk_header_t header;
+    int hasChunk = 0;
+    std::vector<uint8_t> payload;
+    bool isRead = reader != NULL && rkai_session_next_chunk(reader, &header, &hasChunk) == RKAI_RET_SUCCESS &&
+                  hasChunk && header.type == RKAI_CHUNK_IMAGE && header.position == 7;
+    if (isRead) {
+        payload.resize(header.size);
+        isRead = rkai_session_read_payload(reader, payload.data(), (int) payload.size()) == RKAI_RET_SUCCESS;
+    }
+    if (reader != NULL) {
+        rkai_release_session_reader(reader);
+    }
+    rkai_chunk_image_t info;
+    bool isDecimated = isWritten && isRead && payload.size() == sizeof(rkai_chunk_image_t) + 160 * 120 * 3;
+    if (isDecimated) {
+        memcpy(&info, payload.data(), sizeof(rkai_chunk_image_t));
+        isDecimated = info.width == 160 && info.height == 120 && info.channels == 3;
+        const uint8_t *kept = payload.data() + sizeof(rkai_chunk_image_t);
+        for (int y = 0; isDecimated && y < 120; y++) {
+            for (int x = 0; isDecimated && x < 160; x++) {
+                isDecimated = memcmp(kept + (y * 160 + x) * 3, &pixels[((size_t) y * 4 * 640 + x * 4) * 3], 3) == 0;
+            }
+        }
+    }
+    printf("640x480 frame written as %s, %zu bytes of %zu\n", isDecimated ? "160x120, one pixel in 4" : "WRONG",
+           payload.size(), pixels.size());
+    return isDecimated;
+}
+
+/**
+ * A small queue under a producer going as fast as it can drops chunks. The replay gives every capture index once,
+ * in order, each chunk either the capture or the silence of a dropped one
+ */
+static bool checkDrops(const std::string &path, const std::vector<float> &source, uint32_t seed) {
+    rkai_session_config_t config;
+    rkai_session_default_config(&config);
+    config.queue_bytes = 64 << 10;
+    SessionRecorder recorder;
+    if (!recorder.startRecording(path, config)) {
+        return false;
+    }
+    recordCapture(recorder, nullptr, source, 0, seed);
+    recorder.stopRecording();
+
+    SessionRecorder replayer;
+    int64_t nextSample = 0;
+    int64_t sourceNum = 0;
+    int64_t silentNum = 0;
+    bool isAligned = true;
+    replayer.setAudioListener([&](int64_t firstSample, const float *samples, int32_t numSamples) {
+        isAligned = isAligned && firstSample == nextSample;
+        bool isSource = memcmp(samples, source.data() + firstSample, sizeof(float) * numSamples) == 0;
+        bool isSilent = std::all_of(samples, samples + numSamples, [](float sample) { return sample == 0; });
+        isAligned = isAligned && (isSource || isSilent);
+        (isSource ? sourceNum : silentNum) += numSamples;
+        nextSample = firstSample + numSamples;
+    });
+    bool isReplayed = replayer.replay(path, false);
+    // The chunks dropped after the last one kept are not replayed
+    int64_t droppedNum = (int64_t) source.size() - sourceNum;
+    int64_t tailNum = (int64_t) source.size() - nextSample;
+    printf("64 KB queue: %lld of %zu samples dropped, %lld replayed as silence and %lld after the last chunk, %s\n",
+           (long long) droppedNum, source.size(), (long long) silentNum, (long long) tailNum,
+           isAligned ? "aligned" : "MISALIGNED");
+    if (droppedNum == 0) {
+        printf("Nothing was dropped, the gaps are not checked\n");
+    }
+    return isReplayed && isAligned;
+}
+
+/**
+ * A session cut in a chunk, as by a crash, replays up to its last whole chunk
+ */
+static bool checkTruncated(const std::string &path, const std::string &cutPath) {
+    int64_t size = fileSize(path);
+    FILE *in = fopen(path.c_str(), "rb");
+    FILE *out = fopen(cutPath.c_str(), "wb");
+    bool isCopied = in != NULL && out != NULL;
+    std::vector<uint8_t> bytes(isCopied ? (size_t) (size / 2) : 0);
+    isCopied = isCopied && fread(bytes.data(), 1, bytes.size(), in) == bytes.size() &&
+               fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+    SessionRecorder replayer;
+    int64_t replayedNum = 0;
+    int64_t nextSample = 0;
+    bool isAligned = true;
+    replayer.setAudioListener([&](int64_t firstSample, const float *, int32_t numSamples) {
+        isAligned = isAligned && firstSample == nextSample;
+        nextSample = firstSample + numSamples;
+        replayedNum += numSamples;
+    });
+    bool isReplayed = isCopied && replayer.replay(cutPath, false);
+    printf("session cut at %lld of %lld bytes: %s, %.1f s of audio\n", (long long) (size / 2), (long long) size,
+           isReplayed && isAligned ? "replayed up to the cut" : "NOT REPLAYED", (double) replayedNum / kSampleRate);
+    return isReplayed && isAligned && replayedNum > 0;
+}
+
+/**
+ * A replay at the recorded pace takes the time of the recording
+ */
+static bool checkPaced(const std::string &path, const std::vector<float> &source, uint32_t seed) {
+    std::vector<float> audio(source.begin(), source.begin() + (size_t) (kPacedSeconds * kSampleRate));
+    rkai_session_config_t config;
+    rkai_session_default_config(&config);
+    SessionRecorder recorder;
+    if (!recorder.startRecording(path, config)) {
+        return false;
+    }
+    recordCapture(recorder, nullptr, audio, 1, seed);
+    recorder.stopRecording();
+    SessionRecorder replayer;
+    replayer.setAudioListener([](int64_t, const float *, int32_t) {});
+    auto start = std::chrono::steady_clock::now();
+    bool isReplayed = replayer.replay(path, true);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("paced replay of %.0f s: %.2f s\n", kPacedSeconds, seconds);
+    return isReplayed && fabs(seconds - kPacedSeconds) < 0.1;
+}
+
+bool runSessionCheck(const CheckOptions &options) {
+    char root[] = "/tmp/module_check_XXXXXX";
+    if (mkdtemp(root) == NULL) {
+        printf("Cannot create a temporary directory\n");
+        return false;
+    }
+    std::string directory = root;
+    std::vector<float> source = sourceAudio(options.seed, kSessionSeconds);
+    bool isRoundTripOk = checkRoundTrip(directory + "/round_trip.rks", source, options.seed);
+    bool isDecimated = checkDecimation(directory + "/decimated.rks");
+    bool isDropOk = checkDrops(directory + "/drops.rks", source, options.seed);
+    bool isTruncatedOk = checkTruncated(directory + "/round_trip.rks", directory + "/cut.rks");
+    bool isPacedOk = checkPaced(directory + "/paced.rks", source, options.seed);
+    const char *names[] = {"round_trip.rks", "decimated.rks", "drops.rks", "cut.rks", "paced.rks"};
+    for (const char *name : names) {
+        unlink((directory + "/" + name).c_str());
+    }
+    rmdir(root);
+    return isRoundTripOk && isDecimated && isDropOk && isTruncatedOk && isPacedOk;
+}
@@ -0,0 +1,203 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "module_check.h"
+
+constexpr int kCapacity = 1024;
+constexpr int kWriterNum = 4;
+constexpr double kStressSeconds = 2;
+constexpr int kBenchmarkWrites = 1000000;
+constexpr int kBenchmarkSnapshots = 1000;
+
+/**
+ * Every field of the entry follows from the writer and its write count, so that a torn entry shows
+ */
+static rkai_telemetry_entry_t makeEntry(int writer, int64_t count) {
+    rkai_telemetry_entry_t entry;
+    entry.sequence = 0;
+    entry.timestamp_us = 0;
+    entry.window_index = ((int64_t) writer << 40) | count;
+    entry.energy_db = (float) (count % 1000);
+    entry.gate_decision = writer;
+    entry.stage_num = (int32_t) (count & 0x7fff);
+    entry.decision = (int32_t) ~count;
+    for (int i = 0; i < RKAI_TELEMETRY_MAX_STAGES; i++) {
+        entry.scores[i] = (float) ((count * (i + 3)) % 65536);
+    }
+    return entry;
+}
+
+static bool isWholeEntry(const rkai_telemetry_entry_t &entry) {
+    int writer = (int) (entry.window_index >> 40);
+    int64_t count = entry.window_index & (((int64_t) 1 << 40) - 1);
+    rkai_telemetry_entry_t expected = makeEntry(writer, count);
+    bool isSame = writer >= 0 && writer < kWriterNum && entry.energy_db == expected.energy_db &&
+                  entry.gate_decision == expected.gate_decision && entry.stage_num == expected.stage_num &&
+                  entry.decision == expected.decision;
+    for (int i = 0; isSame && i < RKAI_TELEMETRY_MAX_STAGES; i++) {
+        isSame = entry.scores[i] == expected.scores[i];
+    }
+    return isSame;
+}
+
+/**
+ * One writer: the snapshot holds the newest entries oldest first, numbered by the ring, up to the capacity or the
+ * room given
+ */
+static bool checkSingleWriter() {
+    rkai_telemetry_t telemetry = rkai_create_telemetry(kCapacity);
+    if (telemetry == NULL) {
+        return false;
+    }
+    std::vector<rkai_telemetry_entry_t> entries(kCapacity);
+    int entryNum = 0;
+    bool isOk = true;
+    for (int64_t count = 0; count < 100; count++) {
+        rkai_telemetry_entry_t entry = makeEntry(0, count);
+        isOk = isOk && rkai_telemetry_write(telemetry, &entry) == RKAI_RET_SUCCESS;
+    }
+    isOk = isOk && rkai_telemetry_snapshot(telemetry, entries.data(), kCapacity, &entryNum) == RKAI_RET_SUCCESS;
+    bool isPartialOk = isOk && entryNum == 100;
+    for (int i = 0; isPartialOk && i < entryNum; i++) {
+        isPartialOk = entries[i].sequence == (uint64_t) i && entries[i].window_index == i && isWholeEntry(entries[i]);
+    }
+
+    // Three and a half laps, then a snapshot of the capacity and one of 10 entries
+    for (int64_t count = 100; count < 7 * kCapacity / 2; count++) {
+        rkai_telemetry_entry_t entry = makeEntry(0, count);
+        isOk = isOk && rkai_telemetry_write(telemetry, &entry) == RKAI_RET_SUCCESS;
+    }
+    int lastNum = 0;
+    std::vector<rkai_telemetry_entry_t> last(10);
+    isOk = isOk && rkai_telemetry_snapshot(telemetry, entries.data(), kCapacity, &entryNum) == RKAI_RET_SUCCESS &&
+           rkai_telemetry_snapshot(telemetry, last.data(), (int) last.size(), &lastNum) == RKAI_RET_SUCCESS;
+    int64_t firstKept = 7 * kCapacity / 2 - kCapacity;
+    bool isLappedOk = isOk && entryNum == kCapacity && lastNum == 10;
+    for (int i = 0; isLappedOk && i < entryNum; i++) {
+        isLappedOk = entries[i].sequence == (uint64_t) (firstKept + i) && entries[i].window_index == firstKept + i;
+    }
+    for (int i = 0; isLappedOk && i < lastNum; i++) {
+        isLappedOk = last[i].window_index == 7 * kCapacity / 2 - 10 + i;
+    }
+    rkai_telemetry_stats_t stats;
+    isOk = isOk && rkai_telemetry_get_stats(telemetry, &stats) == RKAI_RET_SUCCESS;
+    bool isCounted = isOk && stats.write_count == (uint64_t) (7 * kCapacity / 2) && stats.dropped_count == 0 &&
+                     stats.capacity == kCapacity;
+    rkai_release_telemetry(telemetry);
+    printf("single writer: %s before the first lap, %s after 3.5 laps, counters %s\n",
+           isPartialOk ? "all entries" : "WRONG", isLappedOk ? "the newest entries" : "WRONG",
+           isCounted ? "as expected" : "WRONG");
+    return isPartialOk && isLappedOk && isCounted;
+}
+
+/**
+ * Writers spinning on the ring while a reader snapshots it. Every entry read must be whole, the sequences must
+ * rise, each writer's entries must come in its write order, and the writes and drops must add up
+ */
+static bool checkStress() {
+    rkai_telemetry_t telemetry = rkai_create_telemetry(kCapacity);
+    if (telemetry == NULL) {
+        return false;
+    }
+    std::atomic<bool> isRunning(true);
+    std::vector<int64_t> writeNums(kWriterNum, 0);
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < kWriterNum; writer++) {
+        writers.emplace_back([&, writer] {
+            int64_t count = 0;
+            while (isRunning.load(std::memory_order_relaxed)) {
+                rkai_telemetry_entry_t entry = makeEntry(writer, count++);
+                rkai_telemetry_write(telemetry, &entry);
+            }
+            writeNums[writer] = count;
+        });
+    }
+
+    std::vector<rkai_telemetry_entry_t> entries(kCapacity);
+    uint64_t snapshotNum = 0;
+    uint64_t checkedNum = 0;
+    uint64_t tornNum = 0;
+    uint64_t orderErrorNum = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < kStressSeconds) {
+        int entryNum = 0;
+        rkai_telemetry_snapshot(telemetry, entries.data(), kCapacity, &entryNum);
+        int64_t lastCounts[kWriterNum];
+        std::fill(lastCounts, lastCounts + kWriterNum, (int64_t) -1);
+        for (int i = 0; i < entryNum; i++) {
+            const rkai_telemetry_entry_t &entry = entries[i];
+            if (!isWholeEntry(entry)) {
+                tornNum++;
+                continue;
+            }
+            int writer = (int) (entry.window_index >> 40);
+            int64_t count = entry.window_index & (((int64_t) 1 << 40) - 1);
+            if ((i > 0 && entry.sequence <= entries[i - 1].sequence) || count <= lastCounts[writer]) {
+                orderErrorNum++;
+            }
+            lastCounts[writer] = count;
+        }
+        snapshotNum++;
+        checkedNum += entryNum;
+    }
+    isRunning = false;
+    for (std::thread &writer : writers) {
+        writer.join();
+    }
+    rkai_telemetry_stats_t stats;
+    rkai_telemetry_get_stats(telemetry, &stats);
+    rkai_release_telemetry(telemetry);
+    uint64_t writeNum = 0;
+    for (int64_t count : writeNums) {
+        writeNum += count;
+    }
+    bool isCounted = stats.write_count + stats.dropped_count == writeNum;
+    printf("%d writers for %.0f s: %llu writes, %llu dropped, %llu snapshots, %llu entries checked, %llu torn, "
+           "%llu out of order, counters %s\n", kWriterNum, kStressSeconds, (unsigned long long) writeNum,
+           (unsigned long long) stats.dropped_count, (unsigned long long) snapshotNum,
+           (unsigned long long) checkedNum, (unsigned long long) tornNum, (unsigned long long) orderErrorNum,
+           isCounted ? "as expected" : "WRONG");
+    if (checkedNum == 0) {
+        printf("The reader got no entry, the stress check checks nothing\n");
+    }
+    return checkedNum > 0 && tornNum == 0 && orderErrorNum == 0 && isCounted;
+}
+
+static void measureSpeed() {
+    rkai_telemetry_t telemetry = rkai_create_telemetry(kCapacity);
+    if (telemetry == NULL) {
+        return;
+    }
+    rkai_telemetry_entry_t entry = makeEntry(0, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kBenchmarkWrites; i++) {
+        entry.window_index = i;
+        rkai_telemetry_write(telemetry, &entry);
+    }
+    double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::vector<rkai_telemetry_entry_t> entries(kCapacity);
+    int entryNum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kBenchmarkSnapshots; i++) {
+        rkai_telemetry_snapshot(telemetry, entries.data(), kCapacity, &entryNum);
+    }
+    double snapshotSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    rkai_release_telemetry(telemetry);
+    printf("single writer: %.0f ns per write, %.1f us per snapshot of %d entries\n",
+           1e9 * writeSeconds / kBenchmarkWrites, 1e6 * snapshotSeconds / kBenchmarkSnapshots, kCapacity);
+}
+
+bool runTelemetryCheck(const CheckOptions &options) {
+    (void) options;
+    bool isSingleOk = checkSingleWriter();
+    bool isStressOk = checkStress();
+    measureSpeed();
+    return isSingleOk && isStressOk;
+}
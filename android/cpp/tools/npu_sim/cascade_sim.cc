@@ -0,0 +1,233 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "corpus.h"
+#include "npu_sim.h"
+#include "utils/util.h"
+
+constexpr int32_t kSampleRate = 8000;
+// Windows of the trigger word thread
+constexpr int32_t kWindowSamples = kSampleRate;
+constexpr int32_t kStrideSamples = kSampleRate * 3 / 10;
+// Inference times of the models on one core, as in the scheduler scenario
+constexpr int64_t kBcRunUs = 5000;
+constexpr int64_t kConvRunUs = 15000;
+constexpr float kBcThreshold = 0.6f;
+constexpr float kConvThreshold = 0.6f;
+constexpr float kLobbySeconds = 60;
+// The cascade must at least halve the work of both models on every window, with some margin
+constexpr double kMaxWorkRatio = 0.6;
+
+/**
+ * Work of a way to run the models over the capture
+ */
+struct CascadeWork {
+    int64_t windowNum = 0;
+    int64_t bcRunNum = 0;
+    int64_t convRunNum = 0;
+    int64_t detectedNum = 0;
+    double seconds = 0;
+
+    int64_t npuUs() const {
+        return bcRunNum * kBcRunUs + convRunNum * kConvRunUs;
+    }
+
+    // Both models have their own front-end, one melspectrogram per model run
+    int64_t melspectrogramNum() const {
+        return bcRunNum + convRunNum;
+    }
+};
+
+/**
+ * A lobby at night: a quiet room tone, the hum of the ventilation, and now and then a door or steps
+ */
+static std::vector<float> lobbyCapture() {
+    int64_t length = (int64_t) (kLobbySeconds * kSampleRate);
+    std::vector<float> capture(length);
+    std::mt19937 random(7);
+    std::normal_distribution<float> normal(0, 1);
+    for (int64_t i = 0; i < length; i++) {
+        float t = (float) i / kSampleRate;
+        capture[i] = 0.001f * normal(random) + 0.002f * sinf(2 * (float) M_PI * 50 * t);
+    }
+    for (float start = 4; start < kLobbySeconds - 1; start += 9.5f) {
+        // A door closing: a broadband knock decaying over 200 ms
+        int64_t first = (int64_t) (start * kSampleRate);
+        for (int64_t i = first; i < first + kSampleRate / 5; i++) {
+            capture[i] += 0.05f * normal(random) * expf(-(float) (i - first) / (kSampleRate / 25));
+        }
+        // A few steps after it
+        for (int step = 1; step <= 4; step++) {
+            int64_t stepStart = first + step * kSampleRate / 2;
+            for (int64_t i = stepStart; i < stepStart + kSampleRate / 50 && i < length; i++) {
+                capture[i] += 0.01f * normal(random);
+            }
+        }
+    }
+    return capture;
+}
+
+static rkai_audio_t wrapWindow(float *window) {
+    rkai_audio_t audio;
+    audio.data = window;
+    audio.size = kWindowSamples;
+    audio.sample_rate = kSampleRate;
+    audio.format = RKAI_AUDIO_FORMAT_FLOAT;
+    audio.n_channels = 1;
+    return audio;
+}
+
+/**
+ * Both models on every window, each with its own copy of the window, as the trigger word thread did before the cascade
+ */
+static bool runBothModels(rkai_handle_t bcHandle, rkai_handle_t convHandle, const std::vector<float> &capture,
+                          CascadeWork &work) {
+    rkai_melspectrogram_config_t bcConfig;
+    rkai_melspectrogram_config_t convConfig;
+    rkai_get_trigger_word_config(bcHandle, &bcConfig);
+    rkai_get_trigger_word_config(convHandle, &convConfig);
+    std::vector<float> bcWindow(kWindowSamples);
+    std::vector<float> convWindow(kWindowSamples);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first + kWindowSamples <= capture.size(); first += kStrideSamples) {
+        memcpy(bcWindow.data(), &capture[first], kWindowSamples * sizeof(float));
+        memcpy(convWindow.data(), &capture[first], kWindowSamples * sizeof(float));
+        rkai_audio_t bcAudio = wrapWindow(bcWindow.data());
+        rkai_audio_t convAudio = wrapWindow(convWindow.data());
+        rkai_trigger_word_result_t bcResult;
+        rkai_trigger_word_result_t convResult;
+        if (rkai_trigger_word_detect(bcHandle, &bcAudio, bcConfig, &bcResult, 0.3, kBcThreshold) != RKAI_RET_SUCCESS ||
+            rkai_trigger_word_detect(convHandle, &convAudio, convConfig, &convResult, 0.3, kConvThreshold) !=
+            RKAI_RET_SUCCESS) {
+            return false;
+        }
+        work.windowNum++;
+        work.bcRunNum++;
+        work.convRunNum++;
+        work.detectedNum += bcResult.pass_high_conf && convResult.pass_high_conf;
+    }
+    work.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+static bool runCascade(rkai_trigger_word_cascade_t cascade, std::vector<float> &capture, CascadeWork &work,
+                       rkai_cascade_stats_t &stats) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first + kWindowSamples <= capture.size(); first += kStrideSamples) {
+        rkai_audio_t audio = wrapWindow(&capture[first]);
+        rkai_cascade_result_t result;
+        if (rkai_trigger_word_cascade_detect(cascade, &audio, &result) != RKAI_RET_SUCCESS) {
+            return false;
+        }
+        work.windowNum++;
+        work.bcRunNum += result.stage_count > 0;
+        work.convRunNum += result.stage_count > 1;
+        work.detectedNum += result.is_detected;
+    }
+    work.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return rkai_trigger_word_cascade_get_stats(cascade, &stats) == RKAI_RET_SUCCESS;
+}
+
+/**
+ * The counters of the cascade against what the runtime and the results saw
+ */
+static bool checkCascadeStats(const rkai_cascade_stats_t &stats, const CascadeWork &work, int64_t runCount) {
+    const rkai_cascade_stage_stats_t &bc = stats.stages[0];
+    const rkai_cascade_stage_stats_t &conv = stats.stages[1];
+    bool isOk = stats.stage_num == 2 && (int64_t) stats.window_count == work.windowNum &&
+                (int64_t) bc.run_count == work.bcRunNum && (int64_t) conv.run_count == work.convRunNum &&
+                bc.skip_count == 0 && conv.run_count == bc.pass_count &&
+                conv.skip_count == stats.window_count - bc.pass_count && conv.pass_count == stats.detected_count &&
+                (int64_t) stats.detected_count == work.detectedNum &&
+                (int64_t) (bc.run_count + conv.run_count) == runCount;
+    if (!isOk) {
+        printf("The cascade counters do not match the windows, the results and the %lld inferences run\n",
+               (long long) runCount);
+    }
+    return isOk;
+}
+
+static void printWork(const char *name, const CascadeWork &work, const CascadeWork &reference) {
+    printf("%-12s %8lld %8lld %8lld %9lld %9.0f %8.0f%% %9.2f\n", name, (long long) work.windowNum,
+           (long long) work.bcRunNum, (long long) work.convRunNum, (long long) work.detectedNum,
+           work.npuUs() / 1000.0, 100.0 * work.npuUs() / reference.npuUs(), work.seconds);
+}
+
+bool runCascadeScenario(const SimOptions &options) {
+    rkai_melspectrogram_config_t bcConfig;
+    rkai_melspectrogram_config_t convConfig;
+    if (!registerTriggerWordModels(kBcRunUs, kConvRunUs, bcConfig, convConfig)) {
+        return false;
+    }
+    std::vector<float> capture;
+    if (options.wav.empty()) {
+        capture = lobbyCapture();
+        printf("%.0f s of a lobby at night, no speech\n", kLobbySeconds);
+    } else {
+        if (!readRecording(options.wav, kSampleRate, capture)) {
+            return false;
+        }
+        printf("%s, %.1f s\n", options.wav.c_str(), (double) capture.size() / kSampleRate);
+    }
+
+    rkai_handle_t bcHandle = rkai_create_handle();
+    rkai_handle_t convHandle = rkai_create_handle();
+    if (rkai_init_trigger_word_android_bc_model(bcHandle, NULL) != RKAI_RET_SUCCESS ||
+        rkai_init_trigger_word_android_conv_model(convHandle, NULL) != RKAI_RET_SUCCESS) {
+        fprintf(stderr, "Cannot load the trigger word models\n");
+        rkai_release_handle(bcHandle);
+        rkai_release_handle(convHandle);
+        return false;
+    }
+    rkai_cascade_stage_t stages[2] = {{bcHandle,   kBcThreshold},
+                                      {convHandle, kConvThreshold}};
+    rkai_trigger_word_cascade_t cascade = rkai_create_trigger_word_cascade(stages, 2);
+    CascadeWork both;
+    CascadeWork cascaded;
+    rkai_cascade_stats_t stats;
+    StubRuntimeStats runtimeStats;
+    bool isRun = cascade != NULL && runBothModels(bcHandle, convHandle, capture, both);
+    if (isRun) {
+        stubResetStats();
+        isRun = runCascade(cascade, capture, cascaded, stats);
+        stubGetStats(&runtimeStats);
+    }
+    if (cascade != NULL) {
+        rkai_release_trigger_word_cascade(cascade);
+    }
+    rkai_release_handle(bcHandle);
+    rkai_release_handle(convHandle);
+    if (!isRun) {
+        fprintf(stderr, "Cannot run the trigger word models\n");
+        return false;
+    }
+
+    printf("models        windows  bc runs conv runs  detected    NPU ms   NPU work   seconds\n");
+    printWork("both", both, both);
+    printWork("cascade", cascaded, both);
+    printf("melspectrograms %lld with both models, %lld with the cascade, conv skipped on %llu windows\n",
+           (long long) both.melspectrogramNum(), (long long) cascaded.melspectrogramNum(),
+           (unsigned long long) stats.stages[1].skip_count);
+    bool isOk = checkCascadeStats(stats, cascaded, runtimeStats.runCount);
+    isOk = isOk && cascaded.detectedNum == both.detectedNum;
+    if (cascaded.detectedNum != both.detectedNum) {
+        printf("The cascade detects other windows than both models\n");
+    }
+    // The drop is only known for the audio without speech
+    if (options.wav.empty()) {
+        bool isHalved = cascaded.npuUs() <= kMaxWorkRatio * both.npuUs() &&
+                        cascaded.melspectrogramNum() <= kMaxWorkRatio * both.melspectrogramNum();
+        if (!isHalved) {
+            printf("The cascade does not halve the NPU and front-end work without speech\n");
+        }
+        isOk = isOk && isHalved;
+    }
+    return isOk;
+}
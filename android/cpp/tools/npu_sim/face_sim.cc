@@ -0,0 +1,214 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "npu_scheduler.h"
+#include "npu_sim.h"
+#include "utils/rkai_anchor.h"
+#include "utils/util.h"
+
+#define FACE_MODEL_PATH "model/face_detect/best.rknn"
+
+// Inference time of the simulated face detector, about the one of the model on one RK3588 core
+constexpr int64_t kFaceRunUs = 8000;
+// Camera frames, NV12 like the camera gives them
+constexpr int kFrameWidth = 1280;
+constexpr int kFrameHeight = 720;
+constexpr int kFrameNum = 120;
+// Least frame rate of the pipeline of 3 over the sequential one. The preprocessing takes about half the inference time,
+// overlapped the frame rate goes up by a third
+constexpr double kMinPipelineSpeedUp = 1.15;
+// Priors the simulated model gives a high face score, a few apart so they survive the NMS
+constexpr int kFaceAnchors[] = {1000, 3000, 5000, 7000};
+
+struct FaceRunResult {
+    double seconds = 0;
+    // Mean time per frame of the preprocessing, the inference and the decoding
+    double stageMs[3] = {0, 0, 0};
+    double meanLatencyMs = 0;
+    double maxLatencyMs = 0;
+    std::vector<int> faceCounts;
+};
+
+/**
+ * The face detector with its real tensor sizes. The loc, conf and landmark outputs are zero but for a few priors
+ * scored as faces, so the decoding and the NMS have something to keep
+ */
+static StubModel faceModel() {
+    int anchorNum = rkai_anchor_count(&FACE_DETECT_ANCHOR_CONFIG);
+    StubModel model;
+    model.inputSizes = {(uint32_t) (FACE_DETECT_ANCHOR_CONFIG.image_width * FACE_DETECT_ANCHOR_CONFIG.image_height *
+                                    3)};
+    model.outputSizes = {(uint32_t) anchorNum * 4, (uint32_t) anchorNum * 2, (uint32_t) anchorNum * 10};
+    model.runUs = kFaceRunUs;
+    model.compute = [anchorNum](const std::vector<std::vector<float>> &inputs,
+                                std::vector<std::vector<float>> &outputs) {
+        (void) inputs;
+        for (int anchor = 0; anchor < anchorNum; anchor++) {
+            outputs[1][anchor * 2] = 1;
+            outputs[1][anchor * 2 + 1] = 0;
+        }
+        for (int anchor : kFaceAnchors) {
+            outputs[1][anchor * 2] = 0.05f;
+            outputs[1][anchor * 2 + 1] = 0.95f;
+        }
+    };
+    return model;
+}
+
+static std::vector<unsigned char> cameraFrame(int index) {
+    std::vector<unsigned char> frame(kFrameWidth * kFrameHeight * 3 / 2);
+    for (size_t i = 0; i < frame.size(); i++) {
+        frame[i] = (unsigned char) (i * 7 + index * 13);
+    }
+    return frame;
+}
+
+static rkai_image_t wrapFrame(std::vector<unsigned char> &frame) {
+    rkai_image_t image;
+    memset(&image, 0, sizeof(image));
+    image.data = frame.data();
+    image.width = kFrameWidth;
+    image.height = kFrameHeight;
+    image.size = (int) frame.size();
+    image.pixel_format = RKAI_PIXEL_FORMAT_YUV420SP_NV12;
+    image.is_prealloc_buf = 1;
+    return image;
+}
+
+/**
+ * Preprocessing, inference and decoding of every frame one after the other, like rkai_face_detect is called
+ */
+static FaceRunResult runSequential(rkai_handle_t handle, std::vector<std::vector<unsigned char>> &frames) {
+    FaceRunResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (std::vector<unsigned char> &frame : frames) {
+        rkai_image_t image = wrapFrame(frame);
+        rkai_det_array_t faces;
+        faces.count = 0;
+        int64_t submitUs = get_current_time_us();
+        rkai_face_detect(handle, &image, &faces);
+        double latencyMs = (get_current_time_us() - submitUs) / 1000.0;
+        result.meanLatencyMs += latencyMs / frames.size();
+        result.maxLatencyMs = std::max(result.maxLatencyMs, latencyMs);
+        result.faceCounts.push_back(faces.count);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+/**
+ * The camera thread submits as fast as the staging buffers allow, a consumer thread collects. With one caller, the
+ * camera thread collects the previous frame after submitting each one, like the app through submitFrame and
+ * collectFaces
+ */
+static FaceRunResult runPipelined(rkai_handle_t handle, int stagingNum, bool isOneCaller,
+                                  std::vector<std::vector<unsigned char>> &frames) {
+    FaceRunResult result;
+    rkai_face_pipeline_t pipeline = rkai_create_face_pipeline(handle, stagingNum);
+    if (pipeline == NULL) {
+        return result;
+    }
+    auto collect = [pipeline, &result] {
+        rkai_det_array_t faces;
+        uint64_t frameId;
+        rkai_face_pipeline_get_result(pipeline, -1, &frameId, &faces);
+        result.faceCounts.push_back(faces.count);
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&frames, isOneCaller, &collect] {
+        for (size_t i = 0; !isOneCaller && i < frames.size(); i++) {
+            collect();
+        }
+    });
+    for (size_t i = 0; i < frames.size(); i++) {
+        rkai_image_t image = wrapFrame(frames[i]);
+        rkai_face_pipeline_submit(pipeline, &image, -1, NULL);
+        if (isOneCaller && i > 0) {
+            collect();
+        }
+    }
+    if (isOneCaller) {
+        collect();
+    }
+    consumer.join();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    rkai_face_pipeline_stats_t stats;
+    rkai_face_pipeline_get_stats(pipeline, &stats);
+    if (stats.completed_count > 0) {
+        result.meanLatencyMs = stats.total_latency_us / 1000.0 / stats.completed_count;
+    }
+    result.maxLatencyMs = stats.max_latency_us / 1000.0;
+    if (stats.submitted_count > 0) {
+        result.stageMs[0] = stats.total_preprocess_us / 1000.0 / stats.submitted_count;
+        result.stageMs[1] = stats.total_inference_us / 1000.0 / stats.submitted_count;
+        result.stageMs[2] = stats.total_postprocess_us / 1000.0 / stats.submitted_count;
+    }
+    rkai_release_face_pipeline(pipeline);
+    return result;
+}
+
+static void printRun(const char *name, const FaceRunResult &result) {
+    printf("%-18s %8.1f %10.1f %10.1f %8s", name, kFrameNum / result.seconds, result.meanLatencyMs,
+           result.maxLatencyMs, result.meanLatencyMs <= kFaceDetectDeadlineMs ? "yes" : "no");
+    if (result.stageMs[1] > 0) {
+        printf("   %.1f / %.1f / %.1f", result.stageMs[0], result.stageMs[1], result.stageMs[2]);
+    }
+    printf("\n");
+}
+
+bool runFaceScenario(const SimOptions &options) {
+    (void) options;
+    if (!stubRegisterModel(FACE_MODEL_PATH, faceModel())) {
+        fprintf(stderr, "Cannot read %s under the asset directory\n", FACE_MODEL_PATH);
+        return false;
+    }
+    rkai_handle_t handle = rkai_create_handle();
+    if (handle == NULL || rkai_init_detector_android(handle, NULL) != RKAI_RET_SUCCESS) {
+        rkai_release_handle(handle);
+        return false;
+    }
+    std::vector<std::vector<unsigned char>> frames;
+    for (int i = 0; i < kFrameNum; i++) {
+        frames.push_back(cameraFrame(i));
+    }
+
+    printf("%d frames of %dx%d NV12, inference %.0f ms, latency budget %d ms\n", kFrameNum, kFrameWidth,
+           kFrameHeight, kFaceRunUs / 1000.0, kFaceDetectDeadlineMs);
+    printf("%-18s %8s %10s %10s %8s   %s\n", "detection", "fps", "mean ms", "max ms", "in time",
+           "pre / NPU / post ms");
+    FaceRunResult sequential = runSequential(handle, frames);
+    printRun("sequential", sequential);
+    FaceRunResult pipelined2 = runPipelined(handle, 2, false, frames);
+    printRun("pipeline of 2", pipelined2);
+    FaceRunResult pipelined3 = runPipelined(handle, 3, false, frames);
+    printRun("pipeline of 3", pipelined3);
+    FaceRunResult oneCaller = runPipelined(handle, 3, true, frames);
+    printRun("submit and collect", oneCaller);
+    rkai_release_handle(handle);
+
+    // The pipeline must give the same faces within the latency budget, and more frames per second: the preprocessing
+    // of a frame overlaps the inference of the previous one, even when all the stages share one CPU
+    bool isSame = pipelined2.faceCounts == sequential.faceCounts && pipelined3.faceCounts == sequential.faceCounts &&
+                  oneCaller.faceCounts == sequential.faceCounts;
+    if (!isSame) {
+        printf("The pipeline results differ from the sequential ones\n");
+    }
+    bool isFaster = true;
+    for (const FaceRunResult *run : {&pipelined3, &oneCaller}) {
+        if (run->seconds * kMinPipelineSpeedUp > sequential.seconds) {
+            printf("A run of the pipeline of 3 is not %.0f%% faster than the sequential detection\n",
+                   (kMinPipelineSpeedUp - 1) * 100);
+            isFaster = false;
+        }
+    }
+    return isSame && sequential.faceCounts[0] > 0 && isFaster && pipelined3.meanLatencyMs <= kFaceDetectDeadlineMs &&
+           oneCaller.meanLatencyMs <= kFaceDetectDeadlineMs;
+}
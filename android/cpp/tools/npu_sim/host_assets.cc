@@ -0,0 +1,90 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include "android_porting/android_fopen.h"
+#include "host_assets.h"
+
+struct AAsset {
+    std::string content;
+    size_t position;
+};
+
+static std::mutex assetMutex;
+static std::string assetRoot = ".";
+static std::map<std::string, std::string> memoryAssets;
+
+void hostAssetsSetRoot(const std::string &root) {
+    std::lock_guard<std::mutex> lock(assetMutex);
+    assetRoot = root;
+}
+
+void hostAssetsAdd(const std::string &path, const std::string &content) {
+    std::lock_guard<std::mutex> lock(assetMutex);
+    memoryAssets[path] = content;
+}
+
+bool hostAssetsRead(const std::string &path, std::string &content) {
+    std::string root;
+    {
+        std::lock_guard<std::mutex> lock(assetMutex);
+        auto found = memoryAssets.find(path);
+        if (found != memoryAssets.end()) {
+            content = found->second;
+            return true;
+        }
+        root = assetRoot;
+    }
+    std::ifstream file(root + "/" + path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+extern "C" void android_fopen_set_asset_manager(AAssetManager *manager) {
+    (void) manager;
+}
+
+extern "C" AAsset *android_fopen(const char *fname, const char *mode) {
+    return android_fopen_with_manager(nullptr, fname, mode);
+}
+
+extern "C" AAsset *android_fopen_with_manager(AAssetManager *manager, const char *fname, const char *mode) {
+    (void) manager;
+    if (mode[0] == 'w') {
+        return nullptr;
+    }
+    AAsset *asset = new AAsset();
+    asset->position = 0;
+    if (!hostAssetsRead(fname, asset->content)) {
+        delete asset;
+        return nullptr;
+    }
+    return asset;
+}
+
+extern "C" int android_close(void *cookie) {
+    delete (AAsset *) cookie;
+    return 0;
+}
+
+extern "C" int android_ftell(void *cookie) {
+    return (int) ((AAsset *) cookie)->content.size();
+}
+
+extern "C" int android_read(void *cookie, char *buf, int size) {
+    AAsset *asset = (AAsset *) cookie;
+    size_t count = std::min((size_t) size, asset->content.size() - asset->position);
+    asset->content.copy(buf, count, asset->position);
+    asset->position += count;
+    return (int) count;
+}
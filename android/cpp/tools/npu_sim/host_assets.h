@@ -0,0 +1,20 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_HOST_ASSETS_H
+#define SMARTROBOT_HOST_ASSETS_H
+
+#include <string>
+
+/**
+ * Host stand-in of android_fopen.c: the asset paths of the rkai modules are read under a root directory, the app
+ * assets in place. Assets added in memory are found first, the simulated models that have no file use them
+ */
+void hostAssetsSetRoot(const std::string &root);
+
+void hostAssetsAdd(const std::string &path, const std::string &content);
+
+bool hostAssetsRead(const std::string &path, std::string &content);
+
+#endif //SMARTROBOT_HOST_ASSETS_H
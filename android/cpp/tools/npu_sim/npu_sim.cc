@@ -0,0 +1,160 @@
+//
+// Created on 19/10/2026.
+//
+
+// Runs the NPU side of the rkai modules on a stub rknn runtime: simulated models with a fixed inference time on a
+// simulated multi-core NPU, which detects the misuse of a context by several threads. Each scenario prints what it
+// measured and PASS or FAIL for the behavior it checks, the exit code is non-zero if one fails.
+//
+//  npu_sim [--scenario pool|scheduler|face|pipelines|cascade|spotter|stream|all] [--assets DIR] [--wav FILE]
+//          [--cores N] [--threads N] [--iterations N] [--pool-size N] [--seconds N]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "host_assets.h"
+#include "npu_sim.h"
+#include "utils/util.h"
+
+#ifndef NPU_SIM_ASSET_DIR
+#define NPU_SIM_ASSET_DIR "assets"
+#endif
+
+rkai_handle_t createSimHandle(const std::string &assetPath, const StubModel &model) {
+    hostAssetsAdd(assetPath, "stub model " + assetPath);
+    if (!stubRegisterModel(assetPath, model)) {
+        fprintf(stderr, "Cannot register the simulated model %s\n", assetPath.c_str());
+        return NULL;
+    }
+    rkai_handle_t handle = rkai_create_handle();
+    if (handle == NULL) {
+        return NULL;
+    }
+    if (model_init(handle, assetPath.c_str()) != RKAI_RET_SUCCESS) {
+        rkai_release_handle(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+/**
+ * A trigger word model at the input size of its melspectrogram, scoring its peak
+ */
+static StubModel triggerWordModel(uint32_t inputSize, int64_t runUs) {
+    StubModel model;
+    model.inputSizes = {inputSize};
+    model.outputSizes = {2};
+    model.runUs = runUs;
+    model.compute = [](const std::vector<std::vector<float>> &inputs, std::vector<std::vector<float>> &outputs) {
+        float peak = *std::max_element(inputs[0].begin(), inputs[0].end());
+        outputs[0][1] = 1 / (1 + expf(-kTriggerScoreSlope * (peak - kTriggerScorePeak)));
+        outputs[0][0] = 1 - outputs[0][1];
+    };
+    return model;
+}
+
+bool registerTriggerWordModels(int64_t bcRunUs, int64_t convRunUs, rkai_melspectrogram_config_t &bcConfig,
+                               rkai_melspectrogram_config_t &convConfig) {
+    if (load_config_file(NULL, TRIGGER_WORD_BC_CONFIG_PATH, &bcConfig) != RKAI_RET_SUCCESS ||
+        load_config_file(NULL, TRIGGER_WORD_CONV_CONFIG_PATH, &convConfig) != RKAI_RET_SUCCESS) {
+        fprintf(stderr, "Cannot read the trigger word configs\n");
+        return false;
+    }
+    return stubRegisterModel(TRIGGER_WORD_BC_MODEL_PATH, triggerWordModel((uint32_t) bcConfig.output_size, bcRunUs)) &&
+           stubRegisterModel(TRIGGER_WORD_CONV_MODEL_PATH,
+                             triggerWordModel((uint32_t) convConfig.output_size, convRunUs));
+}
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: npu_sim [options]\n"
+            "  --scenario NAME        pool, scheduler, face, pipelines, cascade, spotter, stream or all (default all)\n"
+            "  --assets DIR           asset directory of the app (default %s)\n"
+            "  --wav FILE             capture replayed by the audio scenarios, 8 kHz for the trigger word\n"
+            "  --cores N              cores of the simulated NPU, 1 to %d (default 3)\n"
+            "  --threads N            caller threads (default 4)\n"
+            "  --iterations N         inferences per thread (default 50)\n"
+            "  --pool-size N          contexts of a handle pool (default 3)\n"
+            "  --seconds N            length of a simulated workload (default 3)\n", NPU_SIM_ASSET_DIR,
+            kStubMaxCoreNum);
+}
+
+static bool parseOptions(int argc, char **argv, SimOptions &options, std::string &scenario) {
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", name.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (name == "--scenario") {
+            scenario = value;
+        } else if (name == "--assets") {
+            options.assets = value;
+        } else if (name == "--wav") {
+            options.wav = value;
+        } else if (name == "--cores") {
+            options.coreNum = atoi(value.c_str());
+        } else if (name == "--threads") {
+            options.threadNum = atoi(value.c_str());
+        } else if (name == "--iterations") {
+            options.iterationNum = atoi(value.c_str());
+        } else if (name == "--pool-size") {
+            options.poolSize = atoi(value.c_str());
+        } else if (name == "--seconds") {
+            options.seconds = atoi(value.c_str());
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    if (options.coreNum < 1 || options.coreNum > kStubMaxCoreNum || options.threadNum < 1 ||
+        options.iterationNum < 1 || options.poolSize < 1 || options.seconds < 1) {
+        fprintf(stderr, "Invalid core, thread, iteration, pool or second count\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    SimOptions options;
+    options.assets = NPU_SIM_ASSET_DIR;
+    std::string scenario = "all";
+    if (!parseOptions(argc, argv, options, scenario)) {
+        printUsage();
+        return 1;
+    }
+    hostAssetsSetRoot(options.assets);
+    stubSetCoreNum(options.coreNum);
+
+    struct {
+        const char *name;
+        bool (*run)(const SimOptions &options);
+    } scenarios[] = {{"pool",      runPoolScenario},
+                   {"scheduler", runSchedulerScenario},
+                   {"face",      runFaceScenario},
+                   {"pipelines", runPipelinesScenario},
+                   {"cascade",   runCascadeScenario},
+                   {"spotter",   runSpotterScenario},
+                   {"stream",    runStreamScenario}};
+    bool isKnown = false;
+    bool isPassed = true;
+    for (const auto &entry : scenarios) {
+        if (scenario != "all" && scenario != entry.name) {
+            continue;
+        }
+        isKnown = true;
+        printf("== %s\n", entry.name);
+        bool isEntryPassed = entry.run(options);
+        printf("%s %s\n\n", isEntryPassed ? "PASS" : "FAIL", entry.name);
+        isPassed = isPassed && isEntryPassed;
+    }
+    if (!isKnown) {
+        fprintf(stderr, "Unknown scenario %s\n", scenario.c_str());
+        printUsage();
+        return 1;
+    }
+    return isPassed ? 0 : 1;
+}
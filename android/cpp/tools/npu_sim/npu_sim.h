@@ -0,0 +1,95 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_NPU_SIM_H
+#define SMARTROBOT_NPU_SIM_H
+
+#include <string>
+#include "rkai.h"
+#include "stub_rknn.h"
+
+#define TRIGGER_WORD_BC_MODEL_PATH "model/trigger_word/bc.rknn"
+#define TRIGGER_WORD_BC_CONFIG_PATH "model/trigger_word/bc_config.txt"
+#define TRIGGER_WORD_CONV_MODEL_PATH "model/trigger_word/conv.rknn"
+#define TRIGGER_WORD_CONV_CONFIG_PATH "model/trigger_word/conv_config.txt"
+
+// Peak of the normalized log melspectrogram at which the simulated trigger word models score 0.5, between the noise
+// of a room and a voiced sound, and how fast the score rises around it
+constexpr float kTriggerScorePeak = 0.02f;
+constexpr float kTriggerScoreSlope = 200;
+
+struct SimOptions {
+    std::string assets;
+    // Capture replayed by the audio scenarios instead of their synthetic one
+    std::string wav;
+    int coreNum = 3;
+    int threadNum = 4;
+    int iterationNum = 50;
+    int poolSize = 3;
+    int seconds = 3;
+};
+
+/**
+ * Register a simulated model under an in memory asset and initialize a handle with it through model_init, like the
+ * init functions of the rkai modules do with a real model file
+ */
+rkai_handle_t createSimHandle(const std::string &assetPath, const StubModel &model);
+
+/**
+ * Simulate the trigger word models of the app assets: float tensors at the size of their melspectrogram config and a
+ * score rising with the peak of the melspectrogram, so the windows with a voiced sound pass. The configs are returned
+ */
+bool registerTriggerWordModels(int64_t bcRunUs, int64_t convRunUs, rkai_melspectrogram_config_t &bcConfig,
+                               rkai_melspectrogram_config_t &convConfig);
+
+/**
+ * Several threads share one model: on one rknn context, then through a handle pool. Checks that the pool removes the
+ * context conflicts and the wrong results, and that the inferences of the pool overlap on the cores
+ */
+bool runPoolScenario(const SimOptions &options);
+
+/**
+ * The models of the app submit periodic inferences on one and three cores: directly, through a scheduler of one
+ * slot and through the scheduler of one job per core with the core masks of npu_scheduler.h. Checks that every
+ * model is in its deadline with a core per model
+ */
+bool runSchedulerScenario(const SimOptions &options);
+
+/**
+ * Camera frames through the face detector of the app on the simulated model: one after the other, then through the
+ * face pipeline with 2 and 3 staging buffers. Checks that the pipeline gives the same faces within the latency
+ * budget of the face detection, at a higher frame rate when the host has a CPU per stage
+ */
+bool runFaceScenario(const SimOptions &options);
+
+/**
+ * One trigger word pipeline per stream in the same process, like one TriggerWord object each: the models, the
+ * cascade, the noise floor gate and the fusion. Checks that the pipelines running together on their own threads give
+ * each stream the outcomes it gets alone, the streams interleaved through one shared pipeline are shown for comparison
+ */
+bool runPipelinesScenario(const SimOptions &options);
+
+/**
+ * The bc then conv cascade over an 8 kHz capture, a lobby at night without speech unless a wav is given, against both
+ * models on every window. Checks the stage counters against the windows, the results and the inferences the runtime
+ * ran, that both give the same detections, and that the cascade halves the NPU and front-end work without speech
+ */
+bool runCascadeScenario(const SimOptions &options);
+
+/**
+ * Keyword models on the same 8 kHz capture: alone, each with its own melspectrogram, through a keyword spotter sharing
+ * the front-end, as one model of three keywords, and on two front-end configs. Checks the front-ends, keywords and
+ * inferences of each setup, that the shared front-end gives the scores of the models run alone, and that a keyword
+ * on the shared front-end costs less than half a front-end
+ */
+bool runSpotterScenario(const SimOptions &options);
+
+/**
+ * A streaming model carrying its state from one 100 ms chunk to the next, against the 1 s windows of the trigger word
+ * thread. Checks the state against the recurrence of the model, the duplicated handles, the snapshots and the reset
+ * after silence, and that the chunks send less than half the mel frames of the windows through the NPU
+ */
+bool runStreamScenario(const SimOptions &options);
+
+#endif //SMARTROBOT_NPU_SIM_H
@@ -0,0 +1,262 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <thread>
+#include <vector>
+#include "npu_sim.h"
+#include "utils/util.h"
+
+constexpr int32_t kSampleRate = 8000;
+// Windows of TriggerWordDetectionFlow
+constexpr int32_t kWindowSamples = kSampleRate;
+constexpr int32_t kStrideSamples = kSampleRate * 3 / 10;
+constexpr float kStreamSeconds = 20;
+constexpr float kKeywordSeconds = 0.6f;
+// Thresholds TriggerWordDetectionFlow gives to cascadeDetect
+constexpr float kBcThreshold = 0.6f;
+constexpr float kConvThreshold = 0.6f;
+
+/**
+ * The per object state of the trigger word JNI: both models, the cascade, the noise floor gate and the fusion
+ */
+struct TriggerPipeline {
+    rkai_handle_t bcHandle = NULL;
+    rkai_handle_t convHandle = NULL;
+    rkai_trigger_word_cascade_t cascade = NULL;
+    rkai_energy_gate_t gate = NULL;
+    rkai_decision_fusion_t fusion = NULL;
+    int64_t streamEnd = 0;
+};
+
+/**
+ * What a pipeline gave for a window: the models run and whether the fusion fired
+ */
+struct WindowOutcome {
+    int stageCount;
+    int isTriggered;
+
+    bool operator==(const WindowOutcome &other) const {
+        return stageCount == other.stageCount && isTriggered == other.isTriggered;
+    }
+};
+
+static void releasePipeline(TriggerPipeline &pipeline) {
+    if (pipeline.cascade != NULL) {
+        rkai_release_trigger_word_cascade(pipeline.cascade);
+    }
+    if (pipeline.gate != NULL) {
+        rkai_release_energy_gate(pipeline.gate);
+    }
+    if (pipeline.fusion != NULL) {
+        rkai_release_decision_fusion(pipeline.fusion);
+    }
+    if (pipeline.bcHandle != NULL) {
+        rkai_release_handle(pipeline.bcHandle);
+    }
+    if (pipeline.convHandle != NULL) {
+        rkai_release_handle(pipeline.convHandle);
+    }
+    pipeline = TriggerPipeline();
+}
+
+static bool createPipeline(TriggerPipeline &pipeline) {
+    pipeline.bcHandle = rkai_create_handle();
+    pipeline.convHandle = rkai_create_handle();
+    if (rkai_init_trigger_word_android_bc_model(pipeline.bcHandle, NULL) != RKAI_RET_SUCCESS ||
+        rkai_init_trigger_word_android_conv_model(pipeline.convHandle, NULL) != RKAI_RET_SUCCESS) {
+        releasePipeline(pipeline);
+        return false;
+    }
+    rkai_cascade_stage_t stages[2] = {{pipeline.bcHandle,   kBcThreshold},
+                                      {pipeline.convHandle, kConvThreshold}};
+    pipeline.cascade = rkai_create_trigger_word_cascade(stages, 2);
+    rkai_energy_gate_config_t gateConfig;
+    rkai_energy_gate_default_config(kSampleRate, &gateConfig);
+    pipeline.gate = rkai_create_energy_gate(&gateConfig);
+    rkai_fusion_config_t fusionConfig;
+    rkai_decision_fusion_default_config(kSampleRate, &fusionConfig);
+    // The fusion fires at the conv threshold, as set by cascadeDetect
+    fusionConfig.on_threshold = kConvThreshold;
+    fusionConfig.off_threshold = kConvThreshold - 0.2f;
+    pipeline.fusion = rkai_create_decision_fusion(&fusionConfig, 1);
+    if (pipeline.cascade == NULL || pipeline.gate == NULL || pipeline.fusion == NULL) {
+        releasePipeline(pipeline);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * One window through the pipeline, as cascadeDetect of the trigger word JNI
+ */
+static WindowOutcome detectWindow(TriggerPipeline &pipeline, float *window) {
+    rkai_audio_t audio;
+    audio.data = window;
+    audio.size = kWindowSamples;
+    audio.sample_rate = kSampleRate;
+    audio.format = RKAI_AUDIO_FORMAT_FLOAT;
+    audio.n_channels = 1;
+    rkai_cascade_result_t result;
+    memset(&result, 0, sizeof(result));
+    int isActive = 1;
+    rkai_energy_gate_process(pipeline.gate, &audio, kStrideSamples, &isActive);
+    rkai_ret_t ret = RKAI_RET_SUCCESS;
+    if (isActive) {
+        ret = rkai_trigger_word_cascade_detect(pipeline.cascade, &audio, &result);
+    }
+    float keywordScore = ret == RKAI_RET_SUCCESS && result.stage_count > 1 ? result.scores[1] : 0;
+    pipeline.streamEnd += kStrideSamples;
+    rkai_fusion_event_t event;
+    memset(&event, 0, sizeof(event));
+    rkai_decision_fusion_update(pipeline.fusion, &keywordScore, pipeline.streamEnd - audio.size, &event);
+    return {result.stage_count, event.is_triggered};
+}
+
+/**
+ * A room tone with keywords, the keywords of each stream are at other times
+ */
+static std::vector<float> triggerStream(int index) {
+    int64_t length = (int64_t) (kStreamSeconds * kSampleRate);
+    std::vector<float> stream(length);
+    std::mt19937 random(100 + index);
+    std::normal_distribution<float> normal(0, 0.003f);
+    for (float &sample : stream) {
+        sample = normal(random);
+    }
+    for (float start = 2 + 1.5f * index; start + kKeywordSeconds < kStreamSeconds; start += 6) {
+        int64_t first = (int64_t) (start * kSampleRate);
+        int64_t last = (int64_t) ((start + kKeywordSeconds) * kSampleRate);
+        for (int64_t i = first; i < last; i++) {
+            float t = (float) (i - first) / kSampleRate;
+            float envelope = sinf((float) M_PI * t / kKeywordSeconds);
+            for (int h = 1; h <= 4; h++) {
+                stream[i] += 0.1f * envelope * sinf(2 * (float) M_PI * 180 * h * t) / h;
+            }
+        }
+    }
+    return stream;
+}
+
+static void runStream(TriggerPipeline &pipeline, std::vector<float> &stream, std::vector<WindowOutcome> &outcomes) {
+    outcomes.clear();
+    for (size_t start = 0; start + kWindowSamples <= stream.size(); start += kStrideSamples) {
+        outcomes.push_back(detectWindow(pipeline, &stream[start]));
+    }
+}
+
+static int countTriggers(const std::vector<WindowOutcome> &outcomes) {
+    int count = 0;
+    for (const WindowOutcome &outcome : outcomes) {
+        count += outcome.isTriggered;
+    }
+    return count;
+}
+
+static int countDifferences(const std::vector<WindowOutcome> &outcomes, const std::vector<WindowOutcome> &expected) {
+    int count = (int) (outcomes.size() > expected.size() ? outcomes.size() - expected.size()
+                                                         : expected.size() - outcomes.size());
+    for (size_t i = 0; i < outcomes.size() && i < expected.size(); i++) {
+        count += outcomes[i] == expected[i] ? 0 : 1;
+    }
+    return count;
+}
+
+bool runPipelinesScenario(const SimOptions &options) {
+    rkai_melspectrogram_config_t bcConfig;
+    rkai_melspectrogram_config_t convConfig;
+    if (!registerTriggerWordModels(2000, 2000, bcConfig, convConfig)) {
+        return false;
+    }
+    int pipelineNum = options.threadNum;
+    std::vector<std::vector<float>> streams;
+    for (int i = 0; i < pipelineNum; i++) {
+        streams.push_back(triggerStream(i));
+    }
+    printf("%d streams of %.0f s at %d Hz, window %d stride %d, one pipeline per stream\n", pipelineNum,
+           kStreamSeconds, kSampleRate, kWindowSamples, kStrideSamples);
+
+    // Each stream alone on a fresh pipeline gives the expected outcomes
+    std::vector<std::vector<WindowOutcome>> expected(pipelineNum);
+    for (int i = 0; i < pipelineNum; i++) {
+        TriggerPipeline pipeline;
+        if (!createPipeline(pipeline)) {
+            fprintf(stderr, "Cannot create a trigger word pipeline\n");
+            return false;
+        }
+        runStream(pipeline, streams[i], expected[i]);
+        releasePipeline(pipeline);
+    }
+
+    // All the pipelines in the process at once, each stream on its own thread
+    std::vector<TriggerPipeline> pipelines(pipelineNum);
+    bool isConfigOk = true;
+    for (TriggerPipeline &pipeline : pipelines) {
+        if (!createPipeline(pipeline)) {
+            fprintf(stderr, "Cannot create a trigger word pipeline\n");
+            return false;
+        }
+    }
+    for (TriggerPipeline &pipeline : pipelines) {
+        rkai_melspectrogram_config_t config;
+        isConfigOk = isConfigOk && rkai_get_trigger_word_config(pipeline.bcHandle, &config) == RKAI_RET_SUCCESS &&
+                     config.n_mels == bcConfig.n_mels &&
+                     rkai_get_trigger_word_config(pipeline.convHandle, &config) == RKAI_RET_SUCCESS &&
+                     config.n_mels == convConfig.n_mels;
+    }
+    stubResetStats();
+    std::vector<std::vector<WindowOutcome>> parallel(pipelineNum);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < pipelineNum; i++) {
+        threads.emplace_back([&, i] { runStream(pipelines[i], streams[i], parallel[i]); });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    StubRuntimeStats stats;
+    stubGetStats(&stats);
+    for (TriggerPipeline &pipeline : pipelines) {
+        releasePipeline(pipeline);
+    }
+
+    // The streams interleaved through a single pipeline, like the process wide state of the JNI did
+    std::vector<std::vector<WindowOutcome>> shared(pipelineNum);
+    {
+        TriggerPipeline pipeline;
+        if (!createPipeline(pipeline)) {
+            fprintf(stderr, "Cannot create a trigger word pipeline\n");
+            return false;
+        }
+        size_t windowNum = expected[0].size();
+        for (size_t w = 0; w < windowNum; w++) {
+            for (int i = 0; i < pipelineNum; i++) {
+                shared[i].push_back(detectWindow(pipeline, &streams[i][w * kStrideSamples]));
+            }
+        }
+        releasePipeline(pipeline);
+    }
+
+    bool isTriggered = true;
+    int parallelDifferences = 0;
+    printf("stream  windows  triggers  parallel diffs  shared diffs\n");
+    for (int i = 0; i < pipelineNum; i++) {
+        int differences = countDifferences(parallel[i], expected[i]);
+        printf("%6d  %7zu  %8d  %14d  %12d\n", i, expected[i].size(), countTriggers(expected[i]), differences,
+               countDifferences(shared[i], expected[i]));
+        parallelDifferences += differences;
+        isTriggered = isTriggered && countTriggers(expected[i]) > 0;
+    }
+    printf("inferences %lld, most in parallel %d, context conflicts %lld\n", (long long) stats.runCount,
+           stats.maxParallelRuns, (long long) stats.contextConflictCount);
+    if (!isConfigOk) {
+        printf("A handle has the melspectrogram config of another model\n");
+    }
+    if (!isTriggered) {
+        printf("A stream has no trigger, the scenario checks nothing\n");
+    }
+    return isConfigOk && isTriggered && parallelDifferences == 0 && stats.contextConflictCount == 0;
+}
@@ -0,0 +1,150 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "npu_sim.h"
+#include "utils/util.h"
+
+// Inference time of the simulated model
+constexpr int64_t kEchoRunUs = 4000;
+// Elements of its input
+constexpr uint32_t kEchoInputSize = 16;
+
+struct PhaseResult {
+    int64_t inferenceNum = 0;
+    int64_t wrongNum = 0;
+    double seconds = 0;
+    StubRuntimeStats runtime;
+};
+
+/**
+ * The output echoes the input, so a caller sees whether it got the result of its own input
+ */
+static StubModel echoModel() {
+    StubModel model;
+    model.inputSizes = {kEchoInputSize};
+    model.outputSizes = {1};
+    model.runUs = kEchoRunUs;
+    model.compute = [](const std::vector<std::vector<float>> &inputs, std::vector<std::vector<float>> &outputs) {
+        outputs[0][0] = inputs[0][0];
+    };
+    return model;
+}
+
+static bool inferEcho(rkai_handle_t handle, float value) {
+    float data[kEchoInputSize];
+    std::fill(data, data + kEchoInputSize, value);
+    rknn_input inputs[1];
+    memset(inputs, 0, sizeof(inputs));
+    inputs[0].index = 0;
+    inputs[0].type = RKNN_TENSOR_FLOAT32;
+    inputs[0].size = sizeof(data);
+    inputs[0].fmt = RKNN_TENSOR_NHWC;
+    inputs[0].buf = data;
+    if (rknn_inputs_set(handle->context, 1, inputs) != RKNN_SUCC || model_run(handle) != RKNN_SUCC) {
+        return false;
+    }
+    rknn_output outputs[1];
+    memset(outputs, 0, sizeof(outputs));
+    outputs[0].want_float = 1;
+    if (rknn_outputs_get(handle->context, 1, outputs, NULL) != RKNN_SUCC) {
+        return false;
+    }
+    bool isOwnResult = ((float *) outputs[0].buf)[0] == value;
+    rknn_outputs_release(handle->context, 1, outputs);
+    return isOwnResult;
+}
+
+/**
+ * Every thread runs its inferences, on the shared handle or on the ones it checks out of the pool
+ */
+static PhaseResult runPhase(const SimOptions &options, rkai_handle_t sharedHandle, rkai_handle_pool_t pool) {
+    PhaseResult result;
+    std::atomic<int64_t> wrongNum(0);
+    stubResetStats();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < options.threadNum; t++) {
+        threads.emplace_back([&options, &wrongNum, sharedHandle, pool, t] {
+            for (int i = 0; i < options.iterationNum; i++) {
+                float value = (float) (t * options.iterationNum + i + 1);
+                rkai_handle_t handle = sharedHandle;
+                if (pool != NULL && rkai_handle_pool_checkout(pool, -1, &handle) != RKAI_RET_SUCCESS) {
+                    wrongNum++;
+                    continue;
+                }
+                if (!inferEcho(handle, value)) {
+                    wrongNum++;
+                }
+                if (pool != NULL) {
+                    rkai_handle_pool_checkin(pool, handle);
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.inferenceNum = (int64_t) options.threadNum * options.iterationNum;
+    result.wrongNum = wrongNum;
+    stubGetStats(&result.runtime);
+    return result;
+}
+
+static void printPhase(const char *name, const PhaseResult &result) {
+    printf("%-16s %10lld %8.2f %8.1f %10lld %8lld %9d\n", name, (long long) result.inferenceNum, result.seconds,
+           result.inferenceNum / result.seconds, (long long) result.runtime.contextConflictCount,
+           (long long) result.wrongNum, result.runtime.maxParallelRuns);
+}
+
+bool runPoolScenario(const SimOptions &options) {
+    rkai_handle_t sharedHandle = createSimHandle("sim/echo.rknn", echoModel());
+    rkai_handle_t poolHandle = createSimHandle("sim/echo.rknn", echoModel());
+    if (sharedHandle == NULL || poolHandle == NULL) {
+        rkai_release_handle(sharedHandle);
+        rkai_release_handle(poolHandle);
+        return false;
+    }
+    rkai_handle_pool_t pool = rkai_create_handle_pool(poolHandle, options.poolSize);
+    if (pool == NULL) {
+        rkai_release_handle(sharedHandle);
+        rkai_release_handle(poolHandle);
+        return false;
+    }
+
+    printf("%d threads x %d inferences of %.1f ms on %d cores\n", options.threadNum, options.iterationNum,
+           kEchoRunUs / 1000.0, options.coreNum);
+    printf("%-16s %10s %8s %8s %10s %8s %9s\n", "context", "inferences", "seconds", "per s", "conflicts", "wrong",
+           "parallel");
+    PhaseResult shared = runPhase(options, sharedHandle, NULL);
+    printPhase("shared", shared);
+    PhaseResult pooled = runPhase(options, NULL, pool);
+    char name[32];
+    snprintf(name, sizeof(name), "pool of %d", options.poolSize);
+    printPhase(name, pooled);
+
+    rkai_handle_pool_stats_t stats;
+    rkai_handle_pool_get_stats(pool, &stats);
+    printf("pool: peak in use %d, contended %llu of %llu checkouts, mean wait %.2f ms, max wait %.2f ms, "
+           "timeouts %llu\n", stats.peak_in_use, (unsigned long long) stats.contended_count,
+           (unsigned long long) stats.checkout_count,
+           stats.checkout_count > 0 ? stats.total_wait_us / 1000.0 / stats.checkout_count : 0.0,
+           stats.max_wait_us / 1000.0, (unsigned long long) stats.timeout_count);
+
+    rkai_release_handle_pool(pool);
+    rkai_release_handle(sharedHandle);
+
+    // The pool must be free of conflicts, and its inferences must overlap whenever there are cores, contexts and
+    // threads for it
+    int possibleParallelRuns = std::min(options.coreNum, std::min(options.poolSize, options.threadNum));
+    return pooled.runtime.contextConflictCount == 0 && pooled.wrongNum == 0 &&
+           pooled.runtime.maxParallelRuns >= std::min(2, possibleParallelRuns);
+}
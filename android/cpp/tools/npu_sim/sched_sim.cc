@@ -0,0 +1,193 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "npu_scheduler.h"
+#include "npu_sim.h"
+#include "utils/util.h"
+
+/**
+ * One model of the app workload: a thread submits an inference every period, like the detector threads and the
+ * camera frames do
+ */
+struct ModelLoad {
+    const char *name;
+    rkai_priority_class_t priorityClass;
+    int deadlineMs;
+    int periodMs;
+    int64_t runUs;
+    int (*coreMask)(int coreNum);
+};
+
+static int triggerWordMask(int coreNum) {
+    return getTriggerWordCoreMask(coreNum);
+}
+
+static int vadMask(int coreNum) {
+    return getVadCoreMask(coreNum);
+}
+
+static int faceDetectMask(int coreNum) {
+    return getFaceDetectCoreMask(coreNum);
+}
+
+// The cascade runs the small model on every window and the large one on a third of them, the camera is at 30 fps
+static const ModelLoad kModelLoads[] = {
+        {"trigger bc",   RKAI_PRIORITY_AUDIO_CRITICAL, kTriggerWordDeadlineMs, 100, 5000,  triggerWordMask},
+        {"trigger conv", RKAI_PRIORITY_AUDIO_CRITICAL, kTriggerWordDeadlineMs, 300, 15000, triggerWordMask},
+        {"vad",          RKAI_PRIORITY_AUDIO,          kVadDeadlineMs,         100, 10000, vadMask},
+        {"face detect",  RKAI_PRIORITY_VISION,         kFaceDetectDeadlineMs,  33,  30000, faceDetectMask},
+};
+constexpr int kModelLoadNum = sizeof(kModelLoads) / sizeof(kModelLoads[0]);
+
+/**
+ * How the inferences reach the NPU
+ */
+struct SchedulerSetup {
+    const char *name;
+    int npuCoreNum;
+    // 0: every model calls rknn_run directly
+    int schedulerCoreNum;
+    bool isBound;
+};
+
+struct LoadResult {
+    int64_t jobNum = 0;
+    int64_t totalLatencyUs = 0;
+    int64_t maxLatencyUs = 0;
+    int64_t missNum = 0;
+};
+
+static void infer(rkai_handle_t handle) {
+    float data = 0;
+    rknn_input inputs[1];
+    memset(inputs, 0, sizeof(inputs));
+    inputs[0].type = RKNN_TENSOR_FLOAT32;
+    inputs[0].size = sizeof(data);
+    inputs[0].fmt = RKNN_TENSOR_NHWC;
+    inputs[0].buf = &data;
+    rknn_inputs_set(handle->context, 1, inputs);
+    model_run(handle);
+    rknn_output outputs[1];
+    memset(outputs, 0, sizeof(outputs));
+    outputs[0].want_float = 1;
+    if (rknn_outputs_get(handle->context, 1, outputs, NULL) == RKNN_SUCC) {
+        rknn_outputs_release(handle->context, 1, outputs);
+    }
+}
+
+static void runLoad(const ModelLoad &load, rkai_handle_t handle, int seconds, LoadResult &result) {
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::seconds(seconds);
+    auto next = start;
+    while (next < end) {
+        std::this_thread::sleep_until(next);
+        int64_t submitUs = get_current_time_us();
+        infer(handle);
+        int64_t latencyUs = get_current_time_us() - submitUs;
+        result.jobNum++;
+        result.totalLatencyUs += latencyUs;
+        result.maxLatencyUs = std::max(result.maxLatencyUs, latencyUs);
+        if (latencyUs > (int64_t) load.deadlineMs * 1000) {
+            result.missNum++;
+        }
+        // A late submission drops the periods it overran, like a camera drops frames
+        next += std::chrono::milliseconds(load.periodMs);
+        next = std::max(next, std::chrono::steady_clock::now());
+    }
+}
+
+/**
+ * Run the workload with one setup, false if a handle cannot be set up
+ */
+static bool runSetup(const SchedulerSetup &setup, int seconds, LoadResult results[kModelLoadNum]) {
+    stubSetCoreNum(setup.npuCoreNum);
+    rkai_scheduler_t scheduler = setup.schedulerCoreNum > 0 ? rkai_create_scheduler(setup.schedulerCoreNum) : NULL;
+    std::vector<rkai_handle_t> handles;
+    bool isOk = true;
+    for (const ModelLoad &load : kModelLoads) {
+        StubModel model;
+        model.inputSizes = {1};
+        model.outputSizes = {1};
+        model.runUs = load.runUs;
+        rkai_handle_t handle = createSimHandle(std::string("sim/") + load.name + ".rknn", model);
+        if (handle == NULL) {
+            isOk = false;
+            break;
+        }
+        handles.push_back(handle);
+        if (scheduler != NULL) {
+            int coreMask = setup.isBound ? load.coreMask(setup.schedulerCoreNum) : RKNN_NPU_CORE_AUTO;
+            if (rkai_scheduler_attach(scheduler, handle, load.priorityClass, load.deadlineMs, coreMask) !=
+                RKAI_RET_SUCCESS) {
+                isOk = false;
+                break;
+            }
+        }
+    }
+    if (isOk) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kModelLoadNum; i++) {
+            threads.emplace_back(runLoad, std::cref(kModelLoads[i]), handles[i], seconds, std::ref(results[i]));
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+    for (rkai_handle_t handle : handles) {
+        rkai_release_handle(handle);
+    }
+    if (scheduler != NULL) {
+        rkai_release_scheduler(scheduler);
+    }
+    return isOk;
+}
+
+bool runSchedulerScenario(const SimOptions &options) {
+    const SchedulerSetup setups[] = {
+            {"direct, 1 core",          1, 0, false},
+            {"1 slot, 1 core",          1, 1, false},
+            {"1 slot, 3 cores",         kStubMaxCoreNum, 1, false},
+            {"per core, 3 cores",       kStubMaxCoreNum, kStubMaxCoreNum, true},
+    };
+    printf("%d s of the app workload, inference time and period per model:", options.seconds);
+    for (const ModelLoad &load : kModelLoads) {
+        printf(" %s %.0f/%d ms", load.name, load.runUs / 1000.0, load.periodMs);
+    }
+    printf("\n%-20s %-14s %6s %10s %10s %8s\n", "scheduler", "model", "jobs", "mean ms", "max ms", "misses");
+
+    bool isPassed = true;
+    for (const SchedulerSetup &setup : setups) {
+        LoadResult results[kModelLoadNum];
+        stubResetStats();
+        if (!runSetup(setup, options.seconds, results)) {
+            isPassed = false;
+            continue;
+        }
+        StubRuntimeStats runtime;
+        stubGetStats(&runtime);
+        int64_t missNum = 0;
+        for (int i = 0; i < kModelLoadNum; i++) {
+            const LoadResult &result = results[i];
+            printf("%-20s %-14s %6lld %10.1f %10.1f %8lld\n", i == 0 ? setup.name : "", kModelLoads[i].name,
+                   (long long) result.jobNum,
+                   result.jobNum > 0 ? result.totalLatencyUs / 1000.0 / result.jobNum : 0.0,
+                   result.maxLatencyUs / 1000.0, (long long) result.missNum);
+            missNum += result.missNum;
+        }
+        printf("%-20s %d inferences at most in parallel, %lld context conflicts\n", "",
+               runtime.maxParallelRuns, (long long) runtime.contextConflictCount);
+        // With a core per model every model is in its deadline. The other setups are reported to compare
+        if (setup.isBound && (missNum > 0 || runtime.contextConflictCount > 0)) {
+            isPassed = false;
+        }
+    }
+    stubSetCoreNum(options.coreNum);
+    return isPassed;
+}
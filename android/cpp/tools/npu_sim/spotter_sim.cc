@@ -0,0 +1,293 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "host_assets.h"
+#include "npu_sim.h"
+#include "utils/util.h"
+
+constexpr int32_t kSampleRate = 8000;
+constexpr int32_t kWindowSamples = kSampleRate;
+constexpr int32_t kStrideSamples = kSampleRate * 3 / 10;
+constexpr float kCaptureSeconds = 30;
+// Inference time of every keyword model, on a core of its own
+constexpr int64_t kModelRunUs = 1000;
+// Classes of the multi keyword model, the background and three keywords
+constexpr int kMultiClassNum = 4;
+// A keyword sharing the front-end must cost less than this share of a front-end
+constexpr double kMaxSharedFrontEndRatio = 0.5;
+
+#define KEYWORD_FIRST_MODEL_PATH "model/keyword/first.rknn"
+#define KEYWORD_SECOND_MODEL_PATH "model/keyword/second.rknn"
+#define KEYWORD_MULTI_MODEL_PATH "model/keyword/multi.rknn"
+
+/**
+ * Cost of a way to spot the keywords, per window
+ */
+struct SpotterCost {
+    const char *name;
+    int modelNum = 0;
+    int keywordNum = 0;
+    int frontEndNum = 0;
+    int64_t windowNum = 0;
+    int64_t frontEndUs = 0;
+    int64_t inferenceUs = 0;
+    int64_t runCount = 0;
+    // Keyword scores of every window
+    std::vector<float> scores;
+
+    double frontEndMs() const {
+        return windowNum > 0 ? frontEndUs / 1000.0 / windowNum : 0;
+    }
+
+    double inferenceMs() const {
+        return windowNum > 0 ? inferenceUs / 1000.0 / windowNum : 0;
+    }
+};
+
+/**
+ * A keyword model on the input of a melspectrogram config: class k > 0 scores the peak of the k-th part of the
+ * melspectrogram, rising around peakLevel, and class 0 is the background
+ */
+static StubModel keywordModel(uint32_t inputSize, int classNum, float peakLevel) {
+    StubModel model;
+    model.inputSizes = {inputSize};
+    model.outputSizes = {(uint32_t) classNum};
+    model.runUs = kModelRunUs;
+    model.compute = [classNum, peakLevel](const std::vector<std::vector<float>> &inputs,
+                                          std::vector<std::vector<float>> &outputs) {
+        size_t partSize = inputs[0].size() / (classNum - 1);
+        float keyword = 0;
+        for (int k = 1; k < classNum; k++) {
+            auto first = inputs[0].begin() + (k - 1) * partSize;
+            float peak = *std::max_element(first, first + partSize);
+            outputs[0][k] = 1 / (1 + expf(-kTriggerScoreSlope * (peak - peakLevel)));
+            keyword = std::max(keyword, outputs[0][k]);
+        }
+        outputs[0][0] = 1 - keyword;
+    };
+    return model;
+}
+
+/**
+ * A trigger word handle of a simulated keyword model, read with the front-end config of the bc model
+ */
+static rkai_handle_t createKeywordHandle(const char *modelPath, const StubModel &model) {
+    hostAssetsAdd(modelPath, std::string("stub model ") + modelPath);
+    rkai_handle_t handle = rkai_create_handle();
+    if (handle == NULL) {
+        return NULL;
+    }
+    if (!stubRegisterModel(modelPath, model) ||
+        audio_model_init(handle, TRIGGER_WORD_BC_CONFIG_PATH, modelPath) != RKAI_RET_SUCCESS) {
+        fprintf(stderr, "Cannot load the simulated keyword model %s\n", modelPath);
+        rkai_release_handle(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+/**
+ * Room tone with a voiced sound every few seconds, at a pitch changing from one to the next
+ */
+static std::vector<float> keywordCapture() {
+    int64_t length = (int64_t) (kCaptureSeconds * kSampleRate);
+    std::vector<float> capture(length);
+    std::mt19937 random(11);
+    std::normal_distribution<float> normal(0, 0.003f);
+    for (float &sample : capture) {
+        sample = normal(random);
+    }
+    int index = 0;
+    for (float start = 1.5f; start + 1 < kCaptureSeconds; start += 3.5f, index++) {
+        int64_t first = (int64_t) (start * kSampleRate);
+        float pitch = 120 + 40 * (index % 5);
+        for (int64_t i = first; i < first + kSampleRate * 6 / 10; i++) {
+            float t = (float) (i - first) / kSampleRate;
+            float envelope = sinf((float) M_PI * t / 0.6f);
+            for (int h = 1; h <= 6; h++) {
+                capture[i] += 0.08f * envelope * sinf(2 * (float) M_PI * pitch * h * t) / h;
+            }
+        }
+    }
+    return capture;
+}
+
+static rkai_audio_t wrapWindow(float *window) {
+    rkai_audio_t audio;
+    memset(&audio, 0, sizeof(rkai_audio_t));
+    audio.data = window;
+    audio.size = kWindowSamples;
+    audio.sample_rate = kSampleRate;
+    audio.format = RKAI_AUDIO_FORMAT_FLOAT;
+    audio.n_channels = 1;
+    return audio;
+}
+
+/**
+ * Every model with its own melspectrogram, as rkai_trigger_word_detect does, one keyword pair per wake word
+ */
+static bool runSeparate(const std::vector<rkai_handle_t> &handles, std::vector<float> &capture, SpotterCost &cost) {
+    stubResetStats();
+    cost.modelNum = (int) handles.size();
+    cost.keywordNum = (int) handles.size();
+    cost.frontEndNum = (int) handles.size();
+    for (size_t start = 0; start + kWindowSamples <= capture.size(); start += kStrideSamples) {
+        rkai_audio_t audio = wrapWindow(&capture[start]);
+        for (rkai_handle_t handle : handles) {
+            rkai_melspectrogram_config_t config;
+            rkai_get_trigger_word_config(handle, &config);
+            int64_t startUs = get_current_time_us();
+            rkai_melspectrogram_t melspectrogram;
+            rkai_ret_t ret = rkai_audio_to_melspectrogram(&audio, &melspectrogram, config);
+            int64_t endUs = get_current_time_us();
+            float classScores[2];
+            int classNum = 0;
+            ret = ret == RKAI_RET_SUCCESS ? rkai_trigger_word_infer(handle, &melspectrogram, classScores, 2, &classNum)
+                                          : ret;
+            rkai_audio_melspectrogram_release(&melspectrogram);
+            if (ret != RKAI_RET_SUCCESS || classNum != 2) {
+                return false;
+            }
+            cost.frontEndUs += endUs - startUs;
+            cost.inferenceUs += get_current_time_us() - endUs;
+            cost.scores.push_back(classScores[1]);
+        }
+        cost.windowNum++;
+    }
+    StubRuntimeStats stats;
+    stubGetStats(&stats);
+    cost.runCount = stats.runCount;
+    return true;
+}
+
+static bool runSpotter(const std::vector<rkai_handle_t> &handles, std::vector<float> &capture, SpotterCost &cost) {
+    rkai_keyword_spotter_t spotter = rkai_create_keyword_spotter();
+    if (spotter == NULL) {
+        return false;
+    }
+    bool isOk = true;
+    for (rkai_handle_t handle : handles) {
+        int firstKeyword = 0;
+        int keywordNum = 0;
+        isOk = isOk && rkai_keyword_spotter_add_model(spotter, handle, &firstKeyword, &keywordNum) == RKAI_RET_SUCCESS;
+    }
+    stubResetStats();
+    for (size_t start = 0; isOk && start + kWindowSamples <= capture.size(); start += kStrideSamples) {
+        rkai_audio_t audio = wrapWindow(&capture[start]);
+        rkai_keyword_scores_t scores;
+        isOk = rkai_keyword_spotter_detect(spotter, &audio, &scores) == RKAI_RET_SUCCESS;
+        cost.scores.insert(cost.scores.end(), scores.scores, scores.scores + scores.keyword_num);
+    }
+    StubRuntimeStats runtimeStats;
+    stubGetStats(&runtimeStats);
+    rkai_keyword_spotter_stats_t stats;
+    isOk = isOk && rkai_keyword_spotter_get_stats(spotter, &stats) == RKAI_RET_SUCCESS;
+    rkai_release_keyword_spotter(spotter);
+    if (!isOk) {
+        return false;
+    }
+    cost.modelNum = stats.model_num;
+    cost.keywordNum = stats.keyword_num;
+    cost.frontEndNum = stats.front_end_num;
+    cost.windowNum = (int64_t) stats.window_count;
+    cost.frontEndUs = stats.total_front_end_us;
+    cost.inferenceUs = stats.total_inference_us;
+    cost.runCount = runtimeStats.runCount;
+    return true;
+}
+
+static void printCost(const SpotterCost &cost) {
+    printf("%-26s %6d %8d %10d %12.2f %9.2f %9.2f\n", cost.name, cost.modelNum, cost.keywordNum, cost.frontEndNum,
+           cost.frontEndMs(), cost.inferenceMs(), cost.frontEndMs() + cost.inferenceMs());
+}
+
+/**
+ * The spotter counters against the setup: front-ends, keywords and one inference per model and window
+ */
+static bool checkCost(const SpotterCost &cost, int modelNum, int keywordNum, int frontEndNum) {
+    bool isOk = cost.modelNum == modelNum && cost.keywordNum == keywordNum && cost.frontEndNum == frontEndNum &&
+                cost.runCount == cost.windowNum * modelNum &&
+                (int64_t) cost.scores.size() == cost.windowNum * keywordNum;
+    if (!isOk) {
+        printf("%s: %d models, %d keywords, %d front-ends and %lld inferences, expected %d, %d, %d and %lld\n",
+               cost.name, cost.modelNum, cost.keywordNum, cost.frontEndNum, (long long) cost.runCount, modelNum,
+               keywordNum, frontEndNum, (long long) (cost.windowNum * modelNum));
+    }
+    return isOk;
+}
+
+bool runSpotterScenario(const SimOptions &options) {
+    rkai_melspectrogram_config_t bcConfig;
+    rkai_melspectrogram_config_t convConfig;
+    if (!registerTriggerWordModels(kModelRunUs, kModelRunUs, bcConfig, convConfig)) {
+        return false;
+    }
+    uint32_t inputSize = (uint32_t) bcConfig.output_size;
+    rkai_handle_t first = createKeywordHandle(KEYWORD_FIRST_MODEL_PATH, keywordModel(inputSize, 2, kTriggerScorePeak));
+    rkai_handle_t second = createKeywordHandle(KEYWORD_SECOND_MODEL_PATH,
+                                               keywordModel(inputSize, 2, 1.5f * kTriggerScorePeak));
+    rkai_handle_t multi = createKeywordHandle(KEYWORD_MULTI_MODEL_PATH,
+                                              keywordModel(inputSize, kMultiClassNum, kTriggerScorePeak));
+    rkai_handle_t conv = rkai_create_handle();
+    bool isRun = first != NULL && second != NULL && multi != NULL && conv != NULL &&
+                 rkai_init_trigger_word_android_conv_model(conv, NULL) == RKAI_RET_SUCCESS;
+    std::vector<float> capture = keywordCapture();
+    printf("%.0f s at %d Hz, window %d stride %d, %lld us per inference\n", kCaptureSeconds, kSampleRate,
+           kWindowSamples, kStrideSamples, (long long) kModelRunUs);
+
+    SpotterCost one, separate, shared, multiKeyword, twoConfigs;
+    one.name = "one binary model";
+    separate.name = "two models, own front-end";
+    shared.name = "two models, shared";
+    multiKeyword.name = "one 3 keyword model";
+    twoConfigs.name = "bc and conv configs";
+    isRun = isRun && runSpotter({first}, capture, one) && runSeparate({first, second}, capture, separate) &&
+            runSpotter({first, second}, capture, shared) && runSpotter({multi}, capture, multiKeyword) &&
+            runSpotter({first, conv}, capture, twoConfigs);
+    for (rkai_handle_t handle : {first, second, multi, conv}) {
+        if (handle != NULL) {
+            rkai_release_handle(handle);
+        }
+    }
+    if (!isRun) {
+        fprintf(stderr, "Cannot run the keyword models\n");
+        return false;
+    }
+
+    printf("setup                      models keywords front-ends front-end ms  model ms  total ms\n");
+    for (const SpotterCost *cost : {&one, &separate, &shared, &multiKeyword, &twoConfigs}) {
+        printCost(*cost);
+    }
+    bool isOk = checkCost(one, 1, 1, 1) && checkCost(shared, 2, 2, 1) &&
+                checkCost(multiKeyword, 1, kMultiClassNum - 1, 1) && checkCost(twoConfigs, 2, 2, 2) &&
+                separate.runCount == separate.windowNum * 2;
+    // The shared front-end gives each model the melspectrogram it computes alone
+    int64_t keywordWindowNum = std::count_if(shared.scores.begin(), shared.scores.end(),
+                                             [](float score) { return score > 0.5f; });
+    printf("%lld of %zu keyword scores over 0.5 with the shared front-end\n", (long long) keywordWindowNum,
+           shared.scores.size());
+    if (keywordWindowNum == 0) {
+        printf("No window scores a keyword, the scores check nothing\n");
+        isOk = false;
+    }
+    if (shared.scores != separate.scores) {
+        printf("The spotter scores differ from the models run on their own melspectrogram\n");
+        isOk = false;
+    }
+    double addedMs = shared.frontEndMs() - one.frontEndMs();
+    printf("front-end cost of the second keyword: %.2f ms shared, %.2f ms with its own front-end\n", addedMs,
+           separate.frontEndMs() - one.frontEndMs());
+    if (addedMs > kMaxSharedFrontEndRatio * one.frontEndMs()) {
+        printf("A keyword on the shared front-end costs more than %.0f %% of a front-end\n",
+               100 * kMaxSharedFrontEndRatio);
+        isOk = false;
+    }
+    return isOk;
+}
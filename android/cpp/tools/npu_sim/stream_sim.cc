@@ -0,0 +1,305 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "npu_sim.h"
+
+constexpr int32_t kSampleRate = 8000;
+// Mel bands and frames of a chunk of the simulated streaming model, 100 ms at the 80 sample hop of the bc config
+constexpr int kBandNum = 40;
+constexpr int kChunkFrameNum = 10;
+constexpr int kChunkFloatNum = kBandNum * kChunkFrameNum;
+constexpr int32_t kChunkSamples = kSampleRate / 10;
+// The state is a leaky average of the band energies
+constexpr float kStateDecay = 0.8f;
+constexpr int kSilenceResetChunks = 5;
+constexpr int64_t kRunUs = 500;
+// Windows of the trigger word thread
+constexpr int32_t kWindowSamples = kSampleRate;
+constexpr int32_t kStrideSamples = kSampleRate * 3 / 10;
+constexpr float kCaptureSeconds = 30;
+constexpr int kCheckChunkNum = 50;
+
+#define STREAM_MODEL_PATH "model/stream/keyword.rknn"
+
+/**
+ * One chunk through the recurrence of the simulated model: the new state, and the keyword score of its loudest band
+ */
+static void streamStep(const float *chunk, const float *state, float *newState, float *scores) {
+    float loudest = 0;
+    for (int b = 0; b < kBandNum; b++) {
+        float sum = 0;
+        for (int f = 0; f < kChunkFrameNum; f++) {
+            sum += chunk[f * kBandNum + b];
+        }
+        newState[b] = kStateDecay * state[b] + (1 - kStateDecay) * sum / kChunkFrameNum;
+        loudest = std::max(loudest, newState[b]);
+    }
+    scores[1] = 1 / (1 + expf(-10 * (loudest - 0.5f)));
+    scores[0] = 1 - scores[1];
+}
+
+static StubModel streamModel() {
+    StubModel model;
+    model.inputSizes = {kChunkFloatNum, kBandNum};
+    model.outputSizes = {2, kBandNum};
+    model.runUs = kRunUs;
+    model.compute = [](const std::vector<std::vector<float>> &inputs, std::vector<std::vector<float>> &outputs) {
+        streamStep(inputs[0].data(), inputs[1].data(), outputs[1].data(), outputs[0].data());
+    };
+    return model;
+}
+
+static std::vector<float> randomChunks(int chunkNum, uint32_t seed) {
+    std::vector<float> chunks((size_t) chunkNum * kChunkFloatNum);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    for (float &value : chunks) {
+        value = uniform(random);
+    }
+    return chunks;
+}
+
+static std::vector<float> getState(rkai_handle_t handle) {
+    int size = 0;
+    rkai_stream_get_state_size(handle, &size);
+    std::vector<float> state(size);
+    rkai_stream_snapshot(handle, state.data(), size);
+    return state;
+}
+
+static bool runChunk(rkai_handle_t handle, const float *chunk, int isSilent, float *score) {
+    float scores[2];
+    int scoreNum = 0;
+    if (rkai_stream_run(handle, chunk, isSilent, scores, 2, &scoreNum) != RKAI_RET_SUCCESS || scoreNum != 2) {
+        return false;
+    }
+    *score = scores[1];
+    return true;
+}
+
+/**
+ * The state and the scores of every chunk against the recurrence computed on the host
+ */
+static bool checkCarryOver(rkai_handle_t handle) {
+    std::vector<float> chunks = randomChunks(kCheckChunkNum, 1);
+    std::vector<float> state(kBandNum, 0.0f);
+    std::vector<float> newState(kBandNum);
+    float maxError = 0;
+    for (int c = 0; c < kCheckChunkNum; c++) {
+        const float *chunk = &chunks[(size_t) c * kChunkFloatNum];
+        float expected[2];
+        streamStep(chunk, state.data(), newState.data(), expected);
+        state = newState;
+        float score;
+        if (!runChunk(handle, chunk, 0, &score)) {
+            return false;
+        }
+        std::vector<float> carried = getState(handle);
+        maxError = std::max(maxError, fabsf(score - expected[1]));
+        for (int b = 0; b < kBandNum; b++) {
+            maxError = std::max(maxError, fabsf(carried[b] - state[b]));
+        }
+    }
+    printf("carry over: %d chunks, largest difference to the host recurrence %.1e\n", kCheckChunkNum, maxError);
+    return maxError == 0;
+}
+
+/**
+ * A duplicated handle starts from a zero state and runs without touching the state of the original
+ */
+static bool checkDuplicate(rkai_handle_t handle, const rkai_stream_config_t &config) {
+    std::vector<float> before = getState(handle);
+    rkai_handle_t duplicate = rkai_duplicate_handle(handle);
+    if (duplicate == NULL || rkai_stream_init(duplicate, &config) != RKAI_RET_SUCCESS) {
+        if (duplicate != NULL) {
+            rkai_release_handle(duplicate);
+        }
+        return false;
+    }
+    std::vector<float> fresh = getState(duplicate);
+    bool isZero = std::all_of(fresh.begin(), fresh.end(), [](float value) { return value == 0; });
+    std::vector<float> chunks = randomChunks(10, 2);
+    float score;
+    bool isRun = true;
+    for (int c = 0; c < 10; c++) {
+        isRun = isRun && runChunk(duplicate, &chunks[(size_t) c * kChunkFloatNum], 0, &score);
+    }
+    bool isKept = getState(handle) == before && getState(duplicate) != before;
+    rkai_release_handle(duplicate);
+    printf("duplicate: %s state, original %s\n", isZero ? "zero" : "non zero", isKept ? "kept" : "changed");
+    return isRun && isZero && isKept;
+}
+
+/**
+ * Chunks run after a restore give the scores they gave after the snapshot
+ */
+static bool checkSnapshot(rkai_handle_t handle) {
+    std::vector<float> snapshot = getState(handle);
+    std::vector<float> chunks = randomChunks(10, 3);
+    std::vector<float> first(10);
+    std::vector<float> second(10);
+    bool isRun = true;
+    for (int c = 0; c < 10; c++) {
+        isRun = isRun && runChunk(handle, &chunks[(size_t) c * kChunkFloatNum], 0, &first[c]);
+    }
+    isRun = isRun && rkai_stream_restore(handle, snapshot.data(), (int) snapshot.size()) == RKAI_RET_SUCCESS;
+    for (int c = 0; c < 10; c++) {
+        isRun = isRun && runChunk(handle, &chunks[(size_t) c * kChunkFloatNum], 0, &second[c]);
+    }
+    bool isSame = first == second;
+    printf("snapshot: the chunks after the restore give %s scores\n", isSame ? "the same" : "other");
+    return isRun && isSame;
+}
+
+/**
+ * Silent chunks run no model and keep the state until kSilenceResetChunks of them in a row clear it
+ */
+static bool checkSilence(rkai_handle_t handle) {
+    std::vector<float> chunks = randomChunks(1, 4);
+    float score;
+    if (!runChunk(handle, chunks.data(), 0, &score)) {
+        return false;
+    }
+    std::vector<float> spoken = getState(handle);
+    rkai_stream_stats_t before;
+    rkai_stream_get_stats(handle, &before);
+    bool isKept = true;
+    bool isScoredZero = true;
+    for (int c = 1; c < kSilenceResetChunks; c++) {
+        isKept = isKept && runChunk(handle, chunks.data(), 1, &score) && getState(handle) == spoken;
+        isScoredZero = isScoredZero && score == 0;
+    }
+    bool isCleared = runChunk(handle, chunks.data(), 1, &score);
+    std::vector<float> silent = getState(handle);
+    isCleared = isCleared && std::all_of(silent.begin(), silent.end(), [](float value) { return value == 0; });
+    rkai_stream_stats_t after;
+    rkai_stream_get_stats(handle, &after);
+    bool isCounted = after.run_count == before.run_count &&
+                     after.chunk_count == before.chunk_count + kSilenceResetChunks &&
+                     after.reset_count == before.reset_count + 1;
+    printf("silence: state kept for %d chunks %s, cleared at %d %s, no inference %s\n", kSilenceResetChunks - 1,
+           isKept ? "yes" : "no", kSilenceResetChunks, isCleared ? "yes" : "no", isCounted ? "yes" : "no");
+    return isKept && isScoredZero && isCleared && isCounted;
+}
+
+/**
+ * Speech a third of the time over a quiet room tone
+ */
+static std::vector<float> speechCapture() {
+    int64_t length = (int64_t) (kCaptureSeconds * kSampleRate);
+    std::vector<float> capture(length);
+    std::mt19937 random(5);
+    std::normal_distribution<float> normal(0, 0.001f);
+    for (int64_t i = 0; i < length; i++) {
+        float t = (float) i / kSampleRate;
+        bool isSpeech = fmodf(t, 6) >= 2 && fmodf(t, 6) < 4;
+        capture[i] = normal(random) + (isSpeech ? 0.1f * sinf(2 * (float) M_PI * 150 * t) : 0);
+    }
+    return capture;
+}
+
+/**
+ * NPU runs and mel frames through the NPU per second of audio: the window path, then the chunks of the streaming
+ * model, every chunk and with the silent chunks skipped
+ */
+static bool measureRates(rkai_handle_t streamHandle) {
+    rkai_melspectrogram_config_t bcConfig;
+    rkai_melspectrogram_config_t convConfig;
+    if (!registerTriggerWordModels(kRunUs, kRunUs, bcConfig, convConfig)) {
+        return false;
+    }
+    rkai_handle_t bcHandle = rkai_create_handle();
+    if (rkai_init_trigger_word_android_bc_model(bcHandle, NULL) != RKAI_RET_SUCCESS) {
+        rkai_release_handle(bcHandle);
+        return false;
+    }
+    std::vector<float> capture = speechCapture();
+    rkai_audio_t audio;
+    memset(&audio, 0, sizeof(rkai_audio_t));
+    audio.sample_rate = kSampleRate;
+    audio.format = RKAI_AUDIO_FORMAT_FLOAT;
+    audio.n_channels = 1;
+
+    stubResetStats();
+    bool isOk = true;
+    audio.size = kWindowSamples;
+    for (size_t start = 0; isOk && start + kWindowSamples <= capture.size(); start += kStrideSamples) {
+        audio.data = &capture[start];
+        rkai_trigger_word_result_t result;
+        isOk = rkai_trigger_word_detect(bcHandle, &audio, bcConfig, &result, 0.3, 0.6) == RKAI_RET_SUCCESS;
+    }
+    StubRuntimeStats windowStats;
+    stubGetStats(&windowStats);
+    rkai_release_handle(bcHandle);
+    int windowFrameNum = bcConfig.output_size / bcConfig.n_mels;
+
+    // The chunks hold random frames, only the number of runs matters here
+    std::vector<float> chunk = randomChunks(1, 6);
+    int64_t chunkNum = (int64_t) capture.size() / kChunkSamples;
+    int64_t runNums[2] = {0, 0};
+    rkai_energy_gate_config_t gateConfig;
+    rkai_energy_gate_default_config(kSampleRate, &gateConfig);
+    rkai_energy_gate_t gate = rkai_create_energy_gate(&gateConfig);
+    for (int isGated = 0; isOk && isGated < 2; isGated++) {
+        rkai_stream_reset(streamHandle);
+        stubResetStats();
+        audio.size = kChunkSamples;
+        for (int64_t c = 0; isOk && c < chunkNum; c++) {
+            audio.data = &capture[c * kChunkSamples];
+            int isActive = 1;
+            if (isGated) {
+                rkai_energy_gate_process(gate, &audio, kChunkSamples, &isActive);
+            }
+            float score;
+            isOk = runChunk(streamHandle, chunk.data(), !isActive, &score);
+        }
+        StubRuntimeStats stats;
+        stubGetStats(&stats);
+        runNums[isGated] = stats.runCount;
+    }
+    rkai_release_energy_gate(gate);
+    if (!isOk) {
+        return false;
+    }
+
+    printf("path                      runs/s  mel frames/s\n");
+    printf("1 s windows, 0.3 s stride %6.2f %13.1f\n", windowStats.runCount / kCaptureSeconds,
+           windowStats.runCount * windowFrameNum / kCaptureSeconds);
+    printf("100 ms chunks             %6.2f %13.1f\n", runNums[0] / kCaptureSeconds,
+           runNums[0] * kChunkFrameNum / kCaptureSeconds);
+    printf("100 ms chunks, gated      %6.2f %13.1f\n", runNums[1] / kCaptureSeconds,
+           runNums[1] * kChunkFrameNum / kCaptureSeconds);
+    bool isFewer = runNums[0] * kChunkFrameNum * 2 < windowStats.runCount * windowFrameNum;
+    if (!isFewer) {
+        printf("The chunks do not halve the mel frames through the NPU\n");
+    }
+    return isFewer && runNums[1] < runNums[0];
+}
+
+bool runStreamScenario(const SimOptions &options) {
+    rkai_handle_t handle = createSimHandle(STREAM_MODEL_PATH, streamModel());
+    if (handle == NULL) {
+        return false;
+    }
+    rkai_stream_config_t config;
+    config.silence_reset_chunks = kSilenceResetChunks;
+    if (rkai_stream_init(handle, &config) != RKAI_RET_SUCCESS) {
+        fprintf(stderr, "Cannot prepare the streaming model\n");
+        rkai_release_handle(handle);
+        return false;
+    }
+    bool isCarried = checkCarryOver(handle);
+    bool isDuplicated = checkDuplicate(handle, config);
+    bool isRestored = checkSnapshot(handle);
+    bool isSilenced = checkSilence(handle);
+    bool isMeasured = measureRates(handle);
+    rkai_release_handle(handle);
+    return isCarried && isDuplicated && isRestored && isSilenced && isMeasured;
+}
@@ -0,0 +1,57 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <string.h>
+#include <rga/im2d.h>
+#include "rkai_image.h"
+
+// Host stand-in of the RGA calls of util.c: a nearest neighbour RGB888 resize on the CPU, so the preprocessing
+// stage of a simulated model still costs time in proportion to the frame size
+
+IM_C_API rga_buffer_t wrapbuffer_virtualaddr_t(void *vir_addr, int width, int height, int wstride, int hstride,
+                                               int format) {
+    rga_buffer_t buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    buffer.vir_addr = vir_addr;
+    buffer.width = width;
+    buffer.height = height;
+    buffer.wstride = wstride;
+    buffer.hstride = hstride;
+    buffer.format = format;
+    return buffer;
+}
+
+IM_C_API IM_STATUS improcess(rga_buffer_t src, rga_buffer_t dst, rga_buffer_t pat, im_rect srect, im_rect drect,
+                             im_rect prect, int usage) {
+    (void) pat;
+    (void) prect;
+    (void) usage;
+    if (src.format != RK_FORMAT_RGB_888 || dst.format != RK_FORMAT_RGB_888 || drect.width <= 0 ||
+        drect.height <= 0) {
+        return IM_STATUS_NOT_SUPPORTED;
+    }
+    const unsigned char *source = (const unsigned char *) src.vir_addr;
+    unsigned char *destination = (unsigned char *) dst.vir_addr;
+    for (int y = 0; y < drect.height; y++) {
+        int sourceY = srect.y + y * srect.height / drect.height;
+        for (int x = 0; x < drect.width; x++) {
+            int sourceX = srect.x + x * srect.width / drect.width;
+            memcpy(destination + ((drect.y + y) * dst.wstride + drect.x + x) * 3,
+                   source + (sourceY * src.wstride + sourceX) * 3, 3);
+        }
+    }
+    return IM_STATUS_SUCCESS;
+}
+
+IM_C_API const char *imStrError_t(IM_STATUS status) {
+    return status == IM_STATUS_SUCCESS ? "success" : "not supported by the host stand-in";
+}
+
+// Only preprocess_v2 resizes through it, no simulated model goes that way
+extern "C" rkai_ret_t rkai_image_resize_rgb(rkai_image_t *image, rkai_size_t desert_size, rkai_image_t *resized_image) {
+    (void) image;
+    (void) desert_size;
+    (void) resized_image;
+    return RKAI_NOT_SUPPORT;
+}
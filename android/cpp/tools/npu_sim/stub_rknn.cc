@@ -0,0 +1,344 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "host_assets.h"
+#include "rknn/rknn_api.h"
+#include "stub_rknn.h"
+
+struct StubContext {
+    std::shared_ptr<const StubModel> model;
+    int coreMask = RKNN_NPU_CORE_AUTO;
+    std::mutex dataMutex;
+    std::atomic<int> callerNum{0};
+    std::thread::id inputOwner;
+    std::thread::id outputOwner;
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> outputs;
+};
+
+static std::mutex runtimeMutex;
+static std::condition_variable coreReleased;
+static int coreNum = 1;
+static bool coreBusy[kStubMaxCoreNum];
+static int parallelRuns = 0;
+static StubRuntimeStats runtimeStats;
+static rknn_context nextContext = 1;
+static std::map<rknn_context, std::shared_ptr<StubContext>> contexts;
+// Registered models by the fingerprint of their bytes
+static std::map<std::pair<size_t, uint64_t>, std::shared_ptr<const StubModel>> models;
+
+static std::pair<size_t, uint64_t> fingerprint(const void *data, size_t size) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return std::make_pair(size, hash);
+}
+
+static std::shared_ptr<StubContext> findContext(rknn_context context) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    auto found = contexts.find(context);
+    return found == contexts.end() ? nullptr : found->second;
+}
+
+static void countConflict() {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    runtimeStats.contextConflictCount++;
+}
+
+/**
+ * One call on a context. Entering while another thread is inside a call on the same context is a conflict
+ */
+class ContextCall {
+public:
+    explicit ContextCall(StubContext *context) : mContext(context) {
+        if (mContext->callerNum.fetch_add(1) > 0) {
+            countConflict();
+        }
+    }
+
+    ~ContextCall() {
+        mContext->callerNum.fetch_sub(1);
+    }
+
+private:
+    StubContext *mContext;
+};
+
+void stubSetCoreNum(int num) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    coreNum = std::max(1, std::min(kStubMaxCoreNum, num));
+}
+
+bool stubRegisterModel(const std::string &assetPath, const StubModel &model) {
+    std::string content;
+    if (!hostAssetsRead(assetPath, content)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    models[fingerprint(content.data(), content.size())] = std::make_shared<const StubModel>(model);
+    return true;
+}
+
+void stubGetStats(StubRuntimeStats *stats) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    *stats = runtimeStats;
+}
+
+void stubResetStats() {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    memset(&runtimeStats, 0, sizeof(runtimeStats));
+}
+
+/**
+ * Take the cores of an inference, waiting for them like on the driver queue. Returns the taken cores as a mask
+ */
+static int acquireCores(int coreMask) {
+    std::unique_lock<std::mutex> lock(runtimeMutex);
+    int taken = 0;
+    coreReleased.wait(lock, [coreMask, &taken] {
+        taken = 0;
+        for (int core = 0; core < coreNum; core++) {
+            int bit = 1 << core;
+            if (coreMask == RKNN_NPU_CORE_AUTO) {
+                if (!coreBusy[core]) {
+                    taken = bit;
+                    return true;
+                }
+            } else if ((coreMask & bit) != 0) {
+                if (coreBusy[core]) {
+                    return false;
+                }
+                taken |= bit;
+            }
+        }
+        return taken != 0;
+    });
+    for (int core = 0; core < coreNum; core++) {
+        coreBusy[core] = coreBusy[core] || (taken & (1 << core)) != 0;
+    }
+    parallelRuns++;
+    runtimeStats.maxParallelRuns = std::max(runtimeStats.maxParallelRuns, parallelRuns);
+    return taken;
+}
+
+static void releaseCores(int taken, int64_t busyUs) {
+    {
+        std::lock_guard<std::mutex> lock(runtimeMutex);
+        for (int core = 0; core < coreNum; core++) {
+            if ((taken & (1 << core)) != 0) {
+                coreBusy[core] = false;
+                runtimeStats.coreBusyUs[core] += busyUs;
+            }
+        }
+        parallelRuns--;
+        runtimeStats.runCount++;
+    }
+    coreReleased.notify_all();
+}
+
+int rknn_init(rknn_context *context, void *model, uint32_t size, uint32_t flag, rknn_init_extend *extend) {
+    (void) flag;
+    (void) extend;
+    if (context == nullptr || model == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    auto found = models.find(fingerprint(model, size));
+    if (found == models.end()) {
+        return RKNN_ERR_MODEL_INVALID;
+    }
+    std::shared_ptr<StubContext> created = std::make_shared<StubContext>();
+    created->model = found->second;
+    created->inputs.resize(created->model->inputSizes.size());
+    created->outputs.resize(created->model->outputSizes.size());
+    for (size_t i = 0; i < created->inputs.size(); i++) {
+        created->inputs[i].assign(created->model->inputSizes[i], 0.0f);
+    }
+    for (size_t i = 0; i < created->outputs.size(); i++) {
+        created->outputs[i].assign(created->model->outputSizes[i], 0.0f);
+    }
+    *context = nextContext++;
+    contexts[*context] = created;
+    return RKNN_SUCC;
+}
+
+int rknn_dup_context(rknn_context *context_in, rknn_context *context_out) {
+    if (context_in == nullptr || context_out == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::shared_ptr<StubContext> source = findContext(*context_in);
+    if (source == nullptr) {
+        return RKNN_ERR_CTX_INVALID;
+    }
+    // The weights are shared, the IO buffers and the core mask are per context
+    std::shared_ptr<StubContext> duplicated = std::make_shared<StubContext>();
+    duplicated->model = source->model;
+    {
+        std::lock_guard<std::mutex> dataLock(source->dataMutex);
+        duplicated->inputs = source->inputs;
+        duplicated->outputs = source->outputs;
+    }
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    *context_out = nextContext++;
+    contexts[*context_out] = duplicated;
+    return RKNN_SUCC;
+}
+
+int rknn_destroy(rknn_context context) {
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    return contexts.erase(context) == 1 ? RKNN_SUCC : RKNN_ERR_CTX_INVALID;
+}
+
+int rknn_query(rknn_context context, rknn_query_cmd cmd, void *info, uint32_t size) {
+    std::shared_ptr<StubContext> found = findContext(context);
+    if (found == nullptr || info == nullptr) {
+        return RKNN_ERR_CTX_INVALID;
+    }
+    const StubModel &model = *found->model;
+    if (cmd == RKNN_QUERY_IN_OUT_NUM && size >= sizeof(rknn_input_output_num)) {
+        rknn_input_output_num *io_num = (rknn_input_output_num *) info;
+        io_num->n_input = (uint32_t) model.inputSizes.size();
+        io_num->n_output = (uint32_t) model.outputSizes.size();
+        return RKNN_SUCC;
+    }
+    if ((cmd == RKNN_QUERY_INPUT_ATTR || cmd == RKNN_QUERY_OUTPUT_ATTR) && size >= sizeof(rknn_tensor_attr)) {
+        rknn_tensor_attr *attr = (rknn_tensor_attr *) info;
+        const std::vector<uint32_t> &sizes = cmd == RKNN_QUERY_INPUT_ATTR ? model.inputSizes : model.outputSizes;
+        if (attr->index >= sizes.size()) {
+            return RKNN_ERR_PARAM_INVALID;
+        }
+        uint32_t index = attr->index;
+        memset(attr, 0, sizeof(rknn_tensor_attr));
+        attr->index = index;
+        attr->n_dims = 2;
+        attr->dims[0] = 1;
+        attr->dims[1] = sizes[index];
+        snprintf(attr->name, RKNN_MAX_NAME_LEN, "%s%u", cmd == RKNN_QUERY_INPUT_ATTR ? "input" : "output", index);
+        attr->n_elems = sizes[index];
+        attr->size = sizes[index] * sizeof(float);
+        attr->size_with_stride = attr->size;
+        attr->fmt = RKNN_TENSOR_NHWC;
+        attr->type = RKNN_TENSOR_FLOAT32;
+        attr->qnt_type = RKNN_TENSOR_QNT_NONE;
+        attr->scale = 1;
+        return RKNN_SUCC;
+    }
+    return RKNN_ERR_PARAM_INVALID;
+}
+
+int rknn_set_core_mask(rknn_context context, rknn_core_mask core_mask) {
+    std::shared_ptr<StubContext> found = findContext(context);
+    if (found == nullptr) {
+        return RKNN_ERR_CTX_INVALID;
+    }
+    std::lock_guard<std::mutex> lock(runtimeMutex);
+    if (core_mask < RKNN_NPU_CORE_AUTO || (core_mask >> coreNum) != 0) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    found->coreMask = core_mask;
+    return RKNN_SUCC;
+}
+
+int rknn_inputs_set(rknn_context context, uint32_t n_inputs, rknn_input inputs[]) {
+    std::shared_ptr<StubContext> found = findContext(context);
+    if (found == nullptr) {
+        return RKNN_ERR_CTX_INVALID;
+    }
+    ContextCall call(found.get());
+    std::lock_guard<std::mutex> dataLock(found->dataMutex);
+    for (uint32_t i = 0; i < n_inputs; i++) {
+        if (inputs[i].index >= found->inputs.size()) {
+            return RKNN_ERR_INPUT_INVALID;
+        }
+        std::vector<float> &input = found->inputs[inputs[i].index];
+        if (inputs[i].type == RKNN_TENSOR_FLOAT32) {
+            size_t count = std::min(input.size(), (size_t) inputs[i].size / sizeof(float));
+            memcpy(input.data(), inputs[i].buf, count * sizeof(float));
+        } else if (inputs[i].type == RKNN_TENSOR_UINT8) {
+            size_t count = std::min(input.size(), (size_t) inputs[i].size);
+            const uint8_t *bytes = (const uint8_t *) inputs[i].buf;
+            std::transform(bytes, bytes + count, input.begin(), [](uint8_t byte) { return (float) byte; });
+        } else {
+            return RKNN_ERR_INPUT_INVALID;
+        }
+    }
+    found->inputOwner = std::this_thread::get_id();
+    return RKNN_SUCC;
+}
+
+int rknn_run(rknn_context context, rknn_run_extend *extend) {
+    (void) extend;
+    std::shared_ptr<StubContext> found = findContext(context);
+    if (found == nullptr) {
+        return RKNN_ERR_CTX_INVALID;
+    }
+    ContextCall call(found.get());
+    std::lock_guard<std::mutex> dataLock(found->dataMutex);
+    if (found->inputOwner != std::this_thread::get_id()) {
+        countConflict();
+    }
+    int taken = acquireCores(found->coreMask);
+    auto start = std::chrono::steady_clock::now();
+    if (found->model->compute) {
+        found->model->compute(found->inputs, found->outputs);
+    }
+    std::this_thread::sleep_until(start + std::chrono::microseconds(found->model->runUs));
+    int64_t busyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    releaseCores(taken, busyUs);
+    found->outputOwner = std::this_thread::get_id();
+    return RKNN_SUCC;
+}
+
+int rknn_outputs_get(rknn_context context, uint32_t n_outputs, rknn_output outputs[], rknn_output_extend *extend) {
+    (void) extend;
+    std::shared_ptr<StubContext> found = findContext(context);
+    if (found == nullptr) {
+        return RKNN_ERR_CTX_INVALID;
+    }
+    ContextCall call(found.get());
+    std::lock_guard<std::mutex> dataLock(found->dataMutex);
+    if (found->outputOwner != std::this_thread::get_id()) {
+        countConflict();
+    }
+    // The stub only has float tensors, they are returned as float whatever want_float says
+    for (uint32_t i = 0; i < n_outputs && i < found->outputs.size(); i++) {
+        const std::vector<float> &output = found->outputs[i];
+        size_t bytes = output.size() * sizeof(float);
+        if (outputs[i].is_prealloc) {
+            memcpy(outputs[i].buf, output.data(), std::min(bytes, (size_t) outputs[i].size));
+        } else {
+            outputs[i].buf = malloc(bytes);
+            memcpy(outputs[i].buf, output.data(), bytes);
+            outputs[i].size = (uint32_t) bytes;
+        }
+        outputs[i].index = i;
+    }
+    return RKNN_SUCC;
+}
+
+int rknn_outputs_release(rknn_context context, uint32_t n_outputs, rknn_output outputs[]) {
+    (void) context;
+    for (uint32_t i = 0; i < n_outputs; i++) {
+        if (!outputs[i].is_prealloc) {
+            free(outputs[i].buf);
+            outputs[i].buf = nullptr;
+        }
+    }
+    return RKNN_SUCC;
+}
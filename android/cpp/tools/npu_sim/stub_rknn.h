@@ -0,0 +1,58 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_STUB_RKNN_H
+#define SMARTROBOT_STUB_RKNN_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Most NPU cores the stub runtime simulates, the RK3588 has three
+constexpr int kStubMaxCoreNum = 3;
+
+/**
+ * A simulated model: float tensors of the given element counts, an inference time and the function that computes the
+ * outputs from the inputs. The outputs are left at zero without one
+ */
+struct StubModel {
+    std::vector<uint32_t> inputSizes;
+    std::vector<uint32_t> outputSizes;
+    int64_t runUs = 1000;
+    std::function<void(const std::vector<std::vector<float>> &inputs,
+                       std::vector<std::vector<float>> &outputs)> compute;
+};
+
+/**
+ * What the stub runtime saw since the last reset
+ */
+struct StubRuntimeStats {
+    int64_t runCount;
+    // Calls that entered a context while another thread was inside a call on it, or that ran or read the outputs of
+    // inputs another thread set. Both corrupt a real rknn context
+    int64_t contextConflictCount;
+    // Most inferences running on the cores at the same time
+    int maxParallelRuns;
+    // Busy time of each core
+    int64_t coreBusyUs[kStubMaxCoreNum];
+};
+
+/**
+ * Cores of the simulated NPU, 1 to kStubMaxCoreNum. An inference occupies one core, a core mask of a context pins it
+ * to the cores of the mask, and one with RKNN_NPU_CORE_AUTO takes any free core. Inferences wait in rknn_run for a
+ * core like on the driver queue. rknn_set_core_mask fails for cores that do not exist
+ */
+void stubSetCoreNum(int coreNum);
+
+/**
+ * Simulate the model of an asset: the contexts created from the same bytes run it. False if the asset cannot be read
+ */
+bool stubRegisterModel(const std::string &assetPath, const StubModel &model);
+
+void stubGetStats(StubRuntimeStats *stats);
+
+void stubResetStats();
+
+#endif //SMARTROBOT_STUB_RKNN_H
@@ -0,0 +1,168 @@
+//
+// Created on 19/10/2026.
+//
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <random>
+#include "corpus.h"
+#include "echo_mix.h"
+#include "noisy_speech.h"
+
+// Length of a synthetic capture
+constexpr float kCaptureSeconds = 20;
+// The speech starts after this noise only lead, the suppressor learns the noise
+constexpr float kLeadSeconds = 2;
+// Level of the talker, dBFS over the speech
+constexpr float kSpeechLevelDb = -26;
+// Talkers of the crowd babble
+constexpr int kCrowdTalkerNum = 8;
+
+static bool endsWith(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool listNoisySpeech(const std::string &directory, std::vector<std::string> &stems) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        fprintf(stderr, "Cannot open the capture directory %s\n", directory.c_str());
+        return false;
+    }
+    stems.clear();
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".wav") && !endsWith(name, ".clean.wav") && !endsWith(name, ".noise.wav") &&
+            !endsWith(name, ".denoised.wav")) {
+            stems.push_back(directory + "/" + name.substr(0, name.size() - 4));
+        }
+    }
+    closedir(dir);
+    std::sort(stems.begin(), stems.end());
+    return true;
+}
+
+static bool readOptional(const std::string &path, int32_t sampleRate, std::vector<float> &samples) {
+    if (access(path.c_str(), R_OK) != 0) {
+        return true;
+    }
+    return readRecording(path, sampleRate, samples);
+}
+
+bool readNoisySpeech(const std::string &stem, int32_t sampleRate, NoisySpeech &speech) {
+    speech.stem = stem;
+    if (!readRecording(stem + ".wav", sampleRate, speech.capture) ||
+        !readOptional(stem + ".clean.wav", sampleRate, speech.clean) ||
+        !readOptional(stem + ".noise.wav", sampleRate, speech.noise)) {
+        return false;
+    }
+    if (speech.clean.size() != speech.capture.size() || speech.noise.size() != speech.capture.size()) {
+        speech.clean.clear();
+        speech.noise.clear();
+    }
+    return true;
+}
+
+/**
+ * Air handling unit through the ducts: rumble under 100 Hz, the blade tone of the fan and its harmonics slowly
+ * beating, and broadband airflow hiss falling off above a few kHz
+ */
+static std::vector<float> hvacNoise(int32_t sampleRate, int64_t length, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::normal_distribution<float> normal(0, 1);
+    std::vector<float> noise(length);
+    float rumble = 0;
+    float hiss = 0;
+    for (int64_t i = 0; i < length; i++) {
+        float t = (float) i / sampleRate;
+        rumble += 0.02f * (normal(random) - rumble);
+        hiss += 0.5f * (normal(random) - hiss);
+        float beat = 1 + 0.2f * sinf(2 * (float) M_PI * 0.3f * t);
+        float tone = 0;
+        for (int h = 1; h <= 3; h++) {
+            tone += sinf(2 * (float) M_PI * 120 * h * t) / h;
+        }
+        noise[i] = 4 * rumble + 0.1f * beat * tone + 0.3f * hiss;
+    }
+    return noise;
+}
+
+/**
+ * Lobby crowd: synthesized talkers at various pitches and levels, each talking on and off over the whole capture
+ */
+static std::vector<float> crowdNoise(int32_t sampleRate, int64_t length, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    std::vector<float> noise(length, 0.0f);
+    float seconds = (float) length / sampleRate;
+    for (int n = 0; n < kCrowdTalkerNum; n++) {
+        std::vector<float> talker = synthesizeSpeech(sampleRate, seconds, 100 + 150 * uniform(random), seed + 1 + n,
+                                                     0, seconds);
+        scaleToLevel(talker, -6 * uniform(random));
+        for (int64_t i = 0; i < length && i < (int64_t) talker.size(); i++) {
+            noise[i] += talker[i];
+        }
+    }
+    return noise;
+}
+
+static std::vector<float> whiteNoise(int64_t length, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::normal_distribution<float> normal(0, 1);
+    std::vector<float> noise(length);
+    for (float &sample : noise) {
+        sample = normal(random);
+    }
+    return noise;
+}
+
+static double energy(const std::vector<float> &samples) {
+    double sum = 0;
+    for (float sample : samples) {
+        sum += (double) sample * sample;
+    }
+    return sum;
+}
+
+/**
+ * One synthetic capture: the speech with the noise set snrDb under it, over the whole capture
+ */
+static bool writeCapture(const std::string &stem, int32_t sampleRate, const std::vector<float> &clean,
+                         const std::vector<float> &noise, float snrDb) {
+    float noiseGain = (float) sqrt(energy(clean) / energy(noise) / pow(10.0, snrDb / 10));
+    std::vector<float> scaledNoise(clean.size());
+    std::vector<float> capture(clean.size());
+    for (size_t i = 0; i < clean.size(); i++) {
+        scaledNoise[i] = noise[i] * noiseGain;
+        capture[i] = clean[i] + scaledNoise[i];
+    }
+    return writeWav(stem + ".wav", sampleRate, capture) && writeWav(stem + ".clean.wav", sampleRate, clean) &&
+           writeWav(stem + ".noise.wav", sampleRate, scaledNoise);
+}
+
+bool writeSyntheticNoisySpeech(const std::string &directory, int32_t sampleRate) {
+    int64_t length = (int64_t) (kCaptureSeconds * sampleRate);
+    std::vector<float> clean = synthesizeSpeech(sampleRate, kCaptureSeconds, 150, 21, kLeadSeconds, kCaptureSeconds);
+    scaleToLevel(clean, kSpeechLevelDb);
+    clean.resize(length, 0.0f);
+    struct {
+        const char *name;
+        std::vector<float> noise;
+    } noises[] = {{"hvac",  hvacNoise(sampleRate, length, 31)},
+                  {"crowd", crowdNoise(sampleRate, length, 41)},
+                  {"white", whiteNoise(length, 51)}};
+    const float snrs[] = {0, 5, 10};
+    for (const auto &noise : noises) {
+        for (float snr : snrs) {
+            char stem[256];
+            snprintf(stem, sizeof(stem), "%s/%s_%02d", directory.c_str(), noise.name, (int) snr);
+            if (!writeCapture(stem, sampleRate, clean, noise.noise, snr)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+//
+// Created on 19/10/2026.
+//
+
+#ifndef SMARTROBOT_NOISY_SPEECH_H
+#define SMARTROBOT_NOISY_SPEECH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A mono capture in noise, named after the stem: stem.wav is the capture. The synthetic captures also have
+ * stem.clean.wav and stem.noise.wav, the speech and the noise the capture is the sum of, so the SNR before and after
+ * the suppression is known
+ */
+struct NoisySpeech {
+    std::string stem;
+    std::vector<float> capture;
+    std::vector<float> clean;
+    std::vector<float> noise;
+};
+
+/**
+ * The stems of the DIR/<name>.wav captures, the clean, noise and denoised side files left out, sorted by path
+ */
+bool listNoisySpeech(const std::string &directory, std::vector<std::string> &stems);
+
+/**
+ * Read the capture of a stem, the clean and noise parts are left empty if they are missing
+ */
+bool readNoisySpeech(const std::string &stem, int32_t sampleRate, NoisySpeech &speech);
+
+/**
+ * Write the synthetic captures to a directory: formant synthesized speech after a noise only lead, in HVAC noise
+ * (duct rumble, a fan tone and airflow hiss), in crowd babble of several synthesized talkers and in white noise, at
+ * 0, 5 and 10 dB SNR
+ */
+bool writeSyntheticNoisySpeech(const std::string &directory, int32_t sampleRate);
+
+#endif //SMARTROBOT_NOISY_SPEECH_H
@@ -0,0 +1,418 @@
+//
+// Created on 19/10/2026.
+//
+
+// Runs the noise suppressor of the app over captures in noise, through the front-end of a detector model with the
+// windows of the detector threads, and reports the SNR before and after, the noise taken out of the speech pauses,
+// the log-mel error against the clean speech and the cost per window.
+//
+//  ns_eval --captures DIR [--synthesize] [--models DIR] [--model vad|bc|conv] [--gain wiener|subtraction]
+//          [--floor-db F] [--output DIR]
+//
+// A capture is DIR/name.wav, see noisy_speech.h. With --synthesize the synthetic captures are written to DIR first,
+// at the sample rate of the model. The captures with name.clean.wav and name.noise.wav are scored against their
+// known parts, the others only by the reduction the suppressor measures.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "corpus.h"
+#include "echo_mix.h"
+#include "noisy_speech.h"
+#include "rkai.h"
+
+#ifndef NS_EVAL_MODEL_DIR
+#define NS_EVAL_MODEL_DIR "model"
+#endif
+
+// Window and stride of the detector threads
+constexpr float kWindowSeconds = 1.0f;
+constexpr float kStrideSeconds = 0.3f;
+// The first seconds of a capture are left out of the metrics, the noise estimate converges
+constexpr float kConvergenceSeconds = 1.0f;
+// Frames the SNR is computed on
+constexpr float kFrameSeconds = 0.02f;
+// A frame has speech above this level, dBFS
+constexpr float kActiveLevelDb = -50;
+// A frame is a speech pause under this level, dBFS
+constexpr float kSilentLevelDb = -70;
+// The segmental SNR of a frame is clamped to this range, dB
+constexpr float kMinSegmentSnrDb = -10;
+constexpr float kMaxSegmentSnrDb = 35;
+// The mel error is taken on the cells of the clean speech within this many dB of the loudest one of the window
+constexpr float kMelRangeDb = 30;
+
+struct EvalOptions {
+    std::string captures;
+    std::string models = NS_EVAL_MODEL_DIR;
+    std::string model = "vad";
+    std::string output;
+    bool isSynthesized = false;
+    rkai_noise_gain_t gain = RKAI_NOISE_GAIN_WIENER;
+    float floorDb = NAN;
+};
+
+/**
+ * Outcome of one capture
+ */
+struct CaptureResult {
+    bool isOk = false;
+    bool isKnown = false;
+    double seconds = 0;
+    int64_t windowNum = 0;
+    // Time per window of the front-end alone, with the gains, and with the gains and the resynthesis
+    double plainSeconds = 0;
+    double denoisedSeconds = 0;
+    double resynthesisSeconds = 0;
+    // Sums over the scored span
+    double speech = 0;
+    double inputNoise = 0;
+    double outputError = 0;
+    double inputSegmentSnr = 0;
+    double outputSegmentSnr = 0;
+    int64_t activeFrameNum = 0;
+    double pauseInput = 0;
+    double pauseOutput = 0;
+    double noisyMelError = 0;
+    double denoisedMelError = 0;
+    int64_t melCellNum = 0;
+    rkai_noise_suppressor_stats_t stats;
+};
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: ns_eval --captures DIR [options]\n"
+            "  --synthesize           write the synthetic captures to DIR first\n"
+            "  --models DIR           model directory of the app assets (default %s)\n"
+            "  --model NAME           front-end of vad, bc or conv (default vad)\n"
+            "  --gain RULE            wiener or subtraction (default wiener)\n"
+            "  --floor-db F           gain floor (default of the suppressor)\n"
+            "  --output DIR           write the denoised audio to DIR/name.denoised.wav\n", NS_EVAL_MODEL_DIR);
+}
+
+static bool parseOptions(int argc, char **argv, EvalOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        if (name == "--synthesize") {
+            options.isSynthesized = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", name.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (name == "--captures") {
+            options.captures = value;
+        } else if (name == "--models") {
+            options.models = value;
+        } else if (name == "--model") {
+            options.model = value;
+        } else if (name == "--gain") {
+            if (value == "wiener") {
+                options.gain = RKAI_NOISE_GAIN_WIENER;
+            } else if (value == "subtraction") {
+                options.gain = RKAI_NOISE_GAIN_SPECTRAL_SUBTRACTION;
+            } else {
+                fprintf(stderr, "Unknown gain rule %s\n", value.c_str());
+                return false;
+            }
+        } else if (name == "--floor-db") {
+            options.floorDb = (float) atof(value.c_str());
+        } else if (name == "--output") {
+            options.output = value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    return !options.captures.empty();
+}
+
+static bool readFrontEnd(const EvalOptions &options, rkai_melspectrogram_config_t *config) {
+    if (options.model == "vad") {
+        return readModelConfig(options.models + "/vad/vad_config.txt", config);
+    }
+    if (options.model == "bc" || options.model == "conv") {
+        return readModelConfig(options.models + "/trigger_word/" + options.model + "_config.txt", config);
+    }
+    fprintf(stderr, "Unknown model %s\n", options.model.c_str());
+    return false;
+}
+
+static double sumOfSquares(const float *samples, int64_t size) {
+    double sum = 0;
+    for (int64_t i = 0; i < size; i++) {
+        sum += (double) samples[i] * samples[i];
+    }
+    return sum;
+}
+
+static double levelDb(double sum, int64_t size) {
+    return 10 * log10(std::max(sum / size, 1e-12));
+}
+
+static double ratioDb(double numerator, double denominator) {
+    return denominator > 0 && numerator > 0 ? 10 * log10(numerator / denominator) : 0;
+}
+
+static rkai_audio_t windowAudio(float *samples, int size, int32_t sampleRate) {
+    rkai_audio_t audio;
+    memset(&audio, 0, sizeof(rkai_audio_t));
+    audio.size = size;
+    audio.sample_rate = sampleRate;
+    audio.n_channels = 1;
+    audio.format = RKAI_AUDIO_FORMAT_FLOAT;
+    audio.data = samples;
+    return audio;
+}
+
+/**
+ * Without a suppressor the denoised front-end must give the mel spectrogram of the plain one, and the overlap-add the
+ * window back except its last n_fft / 2 samples
+ */
+static bool checkFrontEnd(const rkai_melspectrogram_config_t &config) {
+    int size = (int) (kWindowSeconds * config.sample_rate);
+    std::vector<float> samples = synthesizeSpeech(config.sample_rate, kWindowSeconds, 150, 3, 0, kWindowSeconds);
+    scaleToLevel(samples, -26);
+    std::vector<float> resynthesized(size);
+    rkai_audio_t audio = windowAudio(samples.data(), size, config.sample_rate);
+    rkai_melspectrogram_t plain;
+    rkai_melspectrogram_t melspectrogram;
+    if (rkai_audio_to_melspectrogram(&audio, &plain, config) != RKAI_RET_SUCCESS) {
+        return false;
+    }
+    if (rkai_audio_to_denoised_melspectrogram(&audio, 0, nullptr, &melspectrogram, config,
+                                              resynthesized.data()) != RKAI_RET_SUCCESS) {
+        rkai_audio_melspectrogram_release(&plain);
+        return false;
+    }
+    float melError = 0;
+    for (int i = 0; i < plain.size; i++) {
+        melError = std::max(melError, fabsf(plain.data[i] - melspectrogram.data[i]));
+    }
+    rkai_audio_melspectrogram_release(&plain);
+    rkai_audio_melspectrogram_release(&melspectrogram);
+    double signal = 0;
+    double error = 0;
+    for (int i = 0; i < size - config.n_fft / 2; i++) {
+        signal += (double) samples[i] * samples[i];
+        error += (double) (resynthesized[i] - samples[i]) * (resynthesized[i] - samples[i]);
+    }
+    double resynthesisSnr = error > 0 ? 10 * log10(signal / error) : INFINITY;
+    printf("front-end check: mel difference %.2e, overlap-add SNR %.1f dB\n", melError, resynthesisSnr);
+    return melError < 1e-4f && resynthesisSnr > 60;
+}
+
+static bool melspectrogramOf(float *samples, int size, const rkai_melspectrogram_config_t &config,
+                             std::vector<float> &values) {
+    rkai_audio_t audio = windowAudio(samples, size, config.sample_rate);
+    rkai_melspectrogram_t melspectrogram;
+    if (rkai_audio_to_melspectrogram(&audio, &melspectrogram, config) != RKAI_RET_SUCCESS) {
+        return false;
+    }
+    values.assign(melspectrogram.data, melspectrogram.data + melspectrogram.size);
+    rkai_audio_melspectrogram_release(&melspectrogram);
+    return true;
+}
+
+static CaptureResult evaluateCapture(const std::string &stem, const rkai_melspectrogram_config_t &config,
+                                     const EvalOptions &options) {
+    CaptureResult result;
+    NoisySpeech speech;
+    if (!readNoisySpeech(stem, config.sample_rate, speech)) {
+        return result;
+    }
+    rkai_noise_suppressor_config_t suppressorConfig;
+    rkai_noise_suppressor_default_config(&config, &suppressorConfig);
+    suppressorConfig.gain = options.gain;
+    if (!std::isnan(options.floorDb)) {
+        suppressorConfig.gain_floor_db = options.floorDb;
+    }
+    // The one of the detector with the resynthesis, and one timing the gains alone on the same windows
+    rkai_noise_suppressor_t suppressor = rkai_create_noise_suppressor(&suppressorConfig);
+    rkai_noise_suppressor_t timedSuppressor = rkai_create_noise_suppressor(&suppressorConfig);
+    if (suppressor == nullptr || timedSuppressor == nullptr) {
+        rkai_release_noise_suppressor(suppressor);
+        rkai_release_noise_suppressor(timedSuppressor);
+        return result;
+    }
+    int32_t sampleRate = config.sample_rate;
+    int64_t length = (int64_t) speech.capture.size();
+    int windowSize = (int) (kWindowSeconds * sampleRate);
+    int strideSize = (int) (kStrideSeconds * sampleRate);
+    result.isKnown = !speech.clean.empty();
+    result.seconds = (double) length / sampleRate;
+
+    // The denoised audio is committed as in the VAD thread: each window up to its last n_fft / 2 samples
+    std::vector<float> output(length, 0.0f);
+    int64_t committedEnd = 0;
+    std::vector<float> denoised(windowSize);
+    std::vector<float> plainMel;
+    std::vector<float> cleanMel;
+    int64_t convergence = (int64_t) (kConvergenceSeconds * sampleRate);
+    for (int64_t start = 0; start + windowSize <= length; start += strideSize) {
+        rkai_audio_t audio = windowAudio(speech.capture.data() + start, windowSize, sampleRate);
+        auto begin = std::chrono::steady_clock::now();
+        if (!melspectrogramOf(audio.data, windowSize, config, plainMel)) {
+            break;
+        }
+        auto plainEnd = std::chrono::steady_clock::now();
+        rkai_melspectrogram_t melspectrogram;
+        if (rkai_audio_to_denoised_melspectrogram(&audio, start, timedSuppressor, &melspectrogram, config,
+                                                  nullptr) != RKAI_RET_SUCCESS) {
+            break;
+        }
+        rkai_audio_melspectrogram_release(&melspectrogram);
+        auto denoisedEnd = std::chrono::steady_clock::now();
+        if (rkai_audio_to_denoised_melspectrogram(&audio, start, suppressor, &melspectrogram, config,
+                                                  denoised.data()) != RKAI_RET_SUCCESS) {
+            break;
+        }
+        auto resynthesisEnd = std::chrono::steady_clock::now();
+        result.plainSeconds += std::chrono::duration<double>(plainEnd - begin).count();
+        result.denoisedSeconds += std::chrono::duration<double>(denoisedEnd - plainEnd).count();
+        result.resynthesisSeconds += std::chrono::duration<double>(resynthesisEnd - denoisedEnd).count();
+        result.windowNum++;
+
+        if (result.isKnown && start >= convergence && melspectrogramOf(speech.clean.data() + start, windowSize,
+                                                                        config, cleanMel)) {
+            // Natural log of the power, the cells within the range of the loudest clean one
+            float peak = *std::max_element(cleanMel.begin(), cleanMel.end());
+            float range = kMelRangeDb * logf(10.0f) / 10;
+            for (int i = 0; i < melspectrogram.size; i++) {
+                if (cleanMel[i] >= peak - range) {
+                    result.noisyMelError += fabsf(plainMel[i] - cleanMel[i]);
+                    result.denoisedMelError += fabsf(melspectrogram.data[i] - cleanMel[i]);
+                    result.melCellNum++;
+                }
+            }
+        }
+        rkai_audio_melspectrogram_release(&melspectrogram);
+        int64_t commitEnd = start + windowSize - config.n_fft / 2;
+        for (int64_t i = std::max(committedEnd, start); i < commitEnd; i++) {
+            output[i] = denoised[i - start];
+        }
+        committedEnd = std::max(committedEnd, commitEnd);
+    }
+    rkai_noise_suppressor_get_stats(suppressor, &result.stats);
+    rkai_release_noise_suppressor(suppressor);
+    rkai_release_noise_suppressor(timedSuppressor);
+    if (!options.output.empty()) {
+        std::string name = stem.substr(stem.find_last_of('/') + 1);
+        writeWav(options.output + "/" + name + ".denoised.wav", sampleRate, output);
+    }
+    if (!result.isKnown) {
+        result.isOk = result.windowNum > 0;
+        return result;
+    }
+
+    int frameSize = (int) (kFrameSeconds * sampleRate);
+    std::vector<float> error(frameSize);
+    for (int64_t frame = convergence; frame + frameSize <= committedEnd; frame += frameSize) {
+        const float *clean = speech.clean.data() + frame;
+        const float *noise = speech.noise.data() + frame;
+        const float *denoisedFrame = output.data() + frame;
+        for (int i = 0; i < frameSize; i++) {
+            error[i] = denoisedFrame[i] - clean[i];
+        }
+        double speechSum = sumOfSquares(clean, frameSize);
+        double noiseSum = sumOfSquares(noise, frameSize);
+        double errorSum = sumOfSquares(error.data(), frameSize);
+        result.speech += speechSum;
+        result.inputNoise += noiseSum;
+        result.outputError += errorSum;
+        double speechLevel = levelDb(speechSum, frameSize);
+        if (speechLevel > kActiveLevelDb) {
+            result.inputSegmentSnr += std::min(kMaxSegmentSnrDb, std::max(kMinSegmentSnrDb,
+                                                                          (float) ratioDb(speechSum, noiseSum)));
+            result.outputSegmentSnr += std::min(kMaxSegmentSnrDb, std::max(kMinSegmentSnrDb,
+                                                                           (float) ratioDb(speechSum, errorSum)));
+            result.activeFrameNum++;
+        } else if (speechLevel < kSilentLevelDb) {
+            result.pauseInput += sumOfSquares(speech.capture.data() + frame, frameSize);
+            result.pauseOutput += sumOfSquares(denoisedFrame, frameSize);
+        }
+    }
+    result.isOk = true;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    EvalOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    rkai_melspectrogram_config_t config;
+    if (!readFrontEnd(options, &config)) {
+        return 1;
+    }
+    if (!checkFrontEnd(config)) {
+        fprintf(stderr, "The denoised front-end does not match the plain one\n");
+        return 1;
+    }
+    if (options.isSynthesized && !writeSyntheticNoisySpeech(options.captures, config.sample_rate)) {
+        return 1;
+    }
+    std::vector<std::string> stems;
+    if (!listNoisySpeech(options.captures, stems)) {
+        return 1;
+    }
+    if (stems.empty()) {
+        fprintf(stderr, "No capture in %s\n", options.captures.c_str());
+        return 1;
+    }
+
+    int failedNum = 0;
+    double seconds = 0;
+    double plainSeconds = 0;
+    double denoisedSeconds = 0;
+    double resynthesisSeconds = 0;
+    int64_t windowNum = 0;
+    printf("%-20s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "capture", "snr in", "snr out", "gain", "seg in",
+           "seg out", "pause nr", "mel in", "mel out", "noise");
+    for (const std::string &stem : stems) {
+        CaptureResult result = evaluateCapture(stem, config, options);
+        std::string name = stem.substr(stem.find_last_of('/') + 1);
+        if (!result.isOk) {
+            failedNum++;
+            fprintf(stderr, "%s: not evaluated\n", stem.c_str());
+            continue;
+        }
+        if (result.isKnown) {
+            double snrIn = ratioDb(result.speech, result.inputNoise);
+            double snrOut = ratioDb(result.speech, result.outputError);
+            int64_t activeNum = std::max<int64_t>(result.activeFrameNum, 1);
+            // Natural log of the power to dB
+            double melScale = 10 / log(10.0) / std::max<int64_t>(result.melCellNum, 1);
+            printf("%-20s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.2f %8.2f %8.1f\n", name.c_str(), snrIn, snrOut,
+                   snrOut - snrIn, result.inputSegmentSnr / activeNum, result.outputSegmentSnr / activeNum,
+                   ratioDb(result.pauseInput, result.pauseOutput), result.noisyMelError * melScale,
+                   result.denoisedMelError * melScale, result.stats.noise_level_db);
+        } else {
+            printf("%-20s %8s %8s %8s %8s %8s %8s %8s %8s %8.1f\n", name.c_str(), "-", "-", "-", "-", "-", "-", "-",
+                   "-", result.stats.noise_level_db);
+        }
+        seconds += result.seconds;
+        plainSeconds += result.plainSeconds;
+        denoisedSeconds += result.denoisedSeconds;
+        resynthesisSeconds += result.resynthesisSeconds;
+        windowNum += result.windowNum;
+    }
+    double perWindow = windowNum > 0 ? 1e6 / windowNum : 0;
+    printf("%zu captures, %.1f s, %s front-end, %s gain, %lld windows of %.0f ms every %.0f ms\n",
+           stems.size() - failedNum, seconds, options.model.c_str(),
+           options.gain == RKAI_NOISE_GAIN_WIENER ? "wiener" : "subtraction", (long long) windowNum,
+           kWindowSeconds * 1000, kStrideSeconds * 1000);
+    printf("us per window: front-end %.1f, with the gains %.1f (+%.1f), with the resynthesis %.1f (+%.1f)\n",
+           plainSeconds * perWindow, denoisedSeconds * perWindow, (denoisedSeconds - plainSeconds) * perWindow,
+           resynthesisSeconds * perWindow, (resynthesisSeconds - plainSeconds) * perWindow);
+    printf("denoised audio delay: %.1f ms after the window, up to %.1f ms with the stride\n",
+           config.n_fft / 2 * 1000.0 / config.sample_rate,
+           (config.n_fft / 2 + kStrideSeconds * config.sample_rate) * 1000.0 / config.sample_rate);
+    return failedNum > 0 ? 1 : 0;
+}
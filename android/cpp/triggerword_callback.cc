@@ -2,104 +2,224 @@
 // Created by tannn on 1/8/24.
 //
 
+#include <math.h>
+#include <string.h>
+#include <algorithm>
 #include "logging_macros.h"
 #include "triggerword_callback.h"
+#include "session_recorder.h"
 
 void TriggerCallback::runTriggerThread() {
     // If having data in sound recording
     rkai_ret_t ret;
     rkai_audio_t audio_input;
-    rkai_audio_t second_audio_input;
     memset(&audio_input, 0, sizeof(rkai_audio_t));
-    memset(&second_audio_input, 0, sizeof(rkai_audio_t));
-    float *audio_data = (float *) malloc(
-            sizeof(float) * mSampleRate * mWindowKernelSize);
-    float *second_audio_data = (float *) malloc(
-            sizeof(float) * mSampleRate * mWindowKernelSize);
+    // The window in samples of the models, and in samples of the recording
+    int windowSize = mSampleRate * mWindowKernelSize;
+    int captureWindowSize = mCaptureRate * mWindowKernelSize;
+    float *capture_data = (float *) malloc(sizeof(float) * mMaxSpanSize);
+    float *audio_data = (float *) malloc(sizeof(float) * (mMaxSpanSize / mDecimation));
+    audio_input.data = audio_data;
+    audio_input.sample_rate = mSampleRate;
+    audio_input.n_channels = mNumChannels;
+    audio_input.format = RKAI_AUDIO_FORMAT_FLOAT;
+    int stride = (int) (captureWindowSize * mWindowStride);
+    bool wasSuppressingNoise = false;
     while (isRunning) {
-        if (mSoundRecording->getLength() > 0 &&
-            currentStartIdx +  mSampleRate * mWindowKernelSize < mSoundRecording->getLength()) {
-            // Get data from sound recording from current start index to current end index
-            LOGD(TAG, "Running trigger word detection");
-            LOG_INFO("Current start index %d", currentStartIdx);
-            mSoundRecording->getData(audio_data, currentStartIdx, currentStartIdx + mSampleRate * mWindowKernelSize);
-            mSoundRecording->getData(second_audio_data, currentStartIdx, currentStartIdx + mSampleRate * mWindowKernelSize);
+        int isReady = 0;
+        rkai_scheduled_window_t window;
+        rkai_window_scheduler_poll(mWindowScheduler, mSoundRecording->getLength(), &isReady, &window);
+        if (!isReady) {
+            // Wait for 10ms
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        // Get data from sound recording for the whole span, the newest window is at its end
+        LOGD(TAG, "Running trigger word detection");
+        LOG_INFO("Current start index %lld, lag %lld", (long long) window.start, (long long) window.lag);
+        if (!mSoundRecording->getData(capture_data, window.start, window.start + window.size)) {
+            LOG_WARN("Trigger word window at %lld was overwritten", (long long) window.start);
+            rkai_window_scheduler_advance(mWindowScheduler, stride);
+            continue;
+        }
+        decimate(capture_data, window.size, audio_data);
+        int spanSize = window.size / mDecimation;
+        int64_t windowStart = window.start + window.size - captureWindowSize;
 
+        int isActive = 1;
+        if (mEnergyGate != nullptr) {
             audio_input.data = audio_data;
-            audio_input.sample_rate = mSampleRate;
-            audio_input.n_channels = mNumChannels;
-            audio_input.n_seconds = mWindowKernelSize;
-            audio_input.size = mSampleRate * mWindowKernelSize;
-            audio_input.format = RKAI_AUDIO_FORMAT_FLOAT;
-
-            second_audio_input.data = second_audio_data;
-            second_audio_input.sample_rate = mSampleRate;
-            second_audio_input.n_channels = mNumChannels;
-            second_audio_input.n_seconds = mWindowKernelSize;
-            second_audio_input.size = mSampleRate * mWindowKernelSize;
-            second_audio_input.format = RKAI_AUDIO_FORMAT_FLOAT;
+            audio_input.size = spanSize;
+            rkai_energy_gate_process(mEnergyGate, &audio_input, window.new_sample_count / mDecimation, &isActive);
+        }
 
-            rkai_trigger_word_result_t trigger_word_result_bc;
-            rkai_trigger_word_result_t trigger_word_result_conv;
-//            ret = rkai_trigger_word_detect(mRkaiTriggerBCHandle, &audio_input,
-//                                     mTriggerWordModelConfigBc, &trigger_word_result_bc, 0.3,
-//                                     0.6);
-            ret = rkai_trigger_word_detect(mRkaiTriggerBCHandle, &audio_input,
-                                           mTriggerWordModelConfigBc,
-                                           &trigger_word_result_bc,
-                                           0.3, 0.6);
-            if (ret != RKAI_RET_SUCCESS) {
-                LOG_ERROR("Failed to detect trigger word bc model");
-            }
-            if (trigger_word_result_bc.pass_low_conf) {
-                LOG_INFO("Trigger word bc pass low confidence");
-                LOG_INFO("Trigger word bc result %f\n", trigger_word_result_bc.score);
-            }
-            if(trigger_word_result_bc.pass_high_conf){
-                LOG_INFO("Trigger word bc pass high confidence");
-                LOG_INFO("Trigger word bc result %f\n", trigger_word_result_bc.score);
+        // Both models read the same window, the conv model only runs if the bc model passes
+        float bcScore = -1;
+        float keywordScore = 0;
+        int cascadeStageNum = 0;
+        if (isActive) {
+            audio_input.data = audio_data + spanSize - windowSize;
+            audio_input.size = windowSize;
+            audio_input.n_seconds = mWindowKernelSize;
+            // The noise estimate is learned again after suppression was off, the noise may have changed meanwhile
+            bool isDenoised = isSuppressingNoise && mNoiseSuppressor != nullptr;
+            if (isDenoised && !wasSuppressingNoise) {
+                rkai_noise_suppressor_reset(mNoiseSuppressor);
             }
-
-            ret = rkai_trigger_word_detect(mRkaiTriggerConvHandle, &second_audio_input,
-                                           mTriggerWordModelConfigConv,
-                                           &trigger_word_result_conv,
-                                           0.6, 0.7);
+            wasSuppressingNoise = isDenoised;
+            // The noise suppressor counts its frames in samples of the models
+            rkai_cascade_result_t cascade_result;
+            ret = rkai_trigger_word_cascade_detect_at(mTriggerWordCascade, &audio_input,
+                                                      isDenoised ? windowStart / mDecimation : -1, &cascade_result);
             if (ret != RKAI_RET_SUCCESS) {
-                LOG_ERROR("Failed to detect trigger word conv model");
+                LOG_ERROR("Failed to run trigger word cascade");
+            } else {
+                bcScore = cascade_result.scores[0];
+                cascadeStageNum = cascade_result.stage_count;
+                LOG_INFO("Trigger word bc result %f\n", cascade_result.scores[0]);
+                if (cascade_result.stage_count > 1) {
+                    LOG_INFO("Trigger word conv result %f\n", cascade_result.scores[1]);
+                    keywordScore = cascade_result.scores[1];
+                }
             }
-
-            LOG_INFO("Trigger word conv result %f\n", trigger_word_result_conv.score);
-            if (trigger_word_result_conv.pass_low_conf) {
-                LOG_INFO("Trigger word conv pass low confidence");
-                LOG_INFO("Trigger word conv result %f\n", trigger_word_result_conv.score);
+        }
+        // Skipped windows count as zero scores so the smoothing decays
+        rkai_fusion_event_t event;
+        // Recorded as it is, the padding too
+        memset(&event, 0, sizeof(rkai_fusion_event_t));
+        if (mDecisionFusion != nullptr &&
+            rkai_decision_fusion_update(mDecisionFusion, &keywordScore, windowStart, &event) == RKAI_RET_SUCCESS &&
+            event.is_triggered) {
+            mTriggerOnset = event.onset;
+            mTriggerEnd = window.start + window.size;
+            LOG_INFO("Trigger word detected, onset at sample %lld, end at %lld", (long long) mTriggerOnset,
+                     (long long) mTriggerEnd);
+            isTriggered = 1;
+            getSessionRecorder().record(RKAI_CHUNK_EVENT, SESSION_SOURCE_TRIGGER_WORD, mTriggerEnd, &event,
+                                        sizeof(rkai_fusion_event_t));
+            if (mTriggerListener) {
+                mTriggerListener(mTriggerEnd);
             }
-            if(trigger_word_result_conv.pass_high_conf){
-                LOG_INFO("Trigger word conv pass high confidence");
-                LOG_INFO("Trigger word conv result %f\n", trigger_word_result_conv.score);
+        }
+        if (mEventRecorder != nullptr) {
+            if (event.is_triggered) {
+                mEventRecorder->record(CLIP_TRIGGERED, mTriggerEnd);
+            } else if (cascadeStageNum > 1 && keywordScore >= mEventRecorder->getNearMissThreshold()) {
+                mEventRecorder->record(CLIP_NEAR_MISS, window.start + window.size);
             }
-            // Update current start index
-            currentStartIdx += (int) (mSampleRate * mWindowKernelSize * mWindowStride);
-        } else {
-            // Wait for 10ms
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
+        rkai_telemetry_entry_t entry;
+        memset(&entry, 0, sizeof(rkai_telemetry_entry_t));
+        entry.window_index = windowStart;
+        entry.energy_db = NAN;
+        rkai_energy_gate_stats_t gateStats;
+        if (mEnergyGate != nullptr && rkai_energy_gate_get_stats(mEnergyGate, &gateStats) == RKAI_RET_SUCCESS) {
+            entry.energy_db = gateStats.last_level_db;
+        }
+        entry.gate_decision = isActive;
+        entry.stage_num = cascadeStageNum;
+        entry.scores[0] = bcScore;
+        entry.scores[1] = keywordScore;
+        entry.decision = event.is_triggered;
+        // Before the ring stamps its copy, the recorded entry only depends on the audio
+        getSessionRecorder().record(RKAI_CHUNK_MODEL_OUTPUT, SESSION_SOURCE_TRIGGER_WORD, entry.window_index, &entry,
+                                    sizeof(rkai_telemetry_entry_t));
+        rkai_telemetry_write(mTelemetry, &entry);
+        // Update current start index
+        if (mStridePolicy != nullptr) {
+            rkai_adaptive_stride_next(mStridePolicy, bcScore, isActive, &stride);
+        }
+        rkai_window_scheduler_advance(mWindowScheduler, stride);
     }
+    audio_input.data = audio_data;
     rkai_audio_release(&audio_input);
-    rkai_audio_release(&second_audio_input);
+    free(capture_data);
+    if (mEnergyGate != nullptr) {
+        rkai_energy_gate_stats_t gateStats;
+        rkai_energy_gate_get_stats(mEnergyGate, &gateStats);
+        LOG_INFO("Energy gate skipped %llu of %llu windows, noise floor %.1f dB",
+                 (unsigned long long) gateStats.skipped_count, (unsigned long long) gateStats.window_count,
+                 gateStats.noise_floor_db);
+        // The next start reads the recording from the beginning
+        rkai_energy_gate_reset(mEnergyGate);
+    }
+    if (mStridePolicy != nullptr) {
+        rkai_adaptive_stride_stats_t strideStats;
+        rkai_adaptive_stride_get_stats(mStridePolicy, &strideStats);
+        LOG_INFO("Trigger word ran %.0f inferences per audio hour, %.0f with the fixed stride",
+                 strideStats.inferences_per_hour, strideStats.normal_inferences_per_hour);
+        rkai_adaptive_stride_reset(mStridePolicy);
+    }
+    rkai_noise_suppressor_stats_t suppressorStats;
+    if (rkai_noise_suppressor_get_stats(mNoiseSuppressor, &suppressorStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("Trigger word noise suppressor learned from %llu frames, noise at %.1f dBFS",
+                 (unsigned long long) suppressorStats.update_count, suppressorStats.noise_level_db);
+        // The next start reads the recording from the beginning
+        rkai_noise_suppressor_reset(mNoiseSuppressor);
+    }
+    rkai_fusion_stats_t fusionStats;
+    if (rkai_decision_fusion_get_stats(mDecisionFusion, &fusionStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("Trigger word fired %llu times on %llu windows over the threshold",
+                 (unsigned long long) fusionStats.event_count, (unsigned long long) fusionStats.raw_trigger_count);
+    }
+    rkai_window_scheduler_stats_t schedulerStats;
+    if (rkai_window_scheduler_get_stats(mWindowScheduler, &schedulerStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("Trigger word lag p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, %llu windows dropped, %llu coalesced",
+                 schedulerStats.lag_p50_ms, schedulerStats.lag_p90_ms, schedulerStats.lag_p99_ms,
+                 (unsigned long long) schedulerStats.dropped_count,
+                 (unsigned long long) schedulerStats.coalesced_count);
+    }
+}
+
+void TriggerCallback::setUpDecimationFilter() {
+    // Hamming windowed sinc cut a little under the Nyquist frequency of the models
+    const int tapNum = 8 * mDecimation + 1;
+    const float cutoff = 0.45f / (float) mDecimation;
+    int middle = tapNum / 2;
+    float sum = 0;
+    mDecimationFilter.resize(tapNum);
+    for (int i = 0; i < tapNum; i++) {
+        float x = (float) (i - middle);
+        float sinc = i == middle ? 2 * cutoff : sinf(2 * (float) M_PI * cutoff * x) / ((float) M_PI * x);
+        mDecimationFilter[i] = sinc * (0.54f - 0.46f * cosf(2 * (float) M_PI * i / (tapNum - 1)));
+        sum += mDecimationFilter[i];
+    }
+    for (float &tap : mDecimationFilter) {
+        tap /= sum;
+    }
+}
+
+void TriggerCallback::decimate(const float *capture, int size, float *decimated) {
+    int tapNum = (int) mDecimationFilter.size();
+    int middle = tapNum / 2;
+    for (int i = 0; i < size / mDecimation; i++) {
+        float value = 0;
+        for (int k = 0; k < tapNum; k++) {
+            int index = std::min(size - 1, std::max(0, i * mDecimation + k - middle));
+            value += mDecimationFilter[k] * capture[index];
+        }
+        decimated[i] = value;
+    }
 }
 
 void TriggerCallback::start() {
+    if (!isReady) {
+        LOG_ERROR("Trigger word detection is not started, its models failed to load");
+        return;
+    }
     if (!isRunning) {
         LOGD(TAG, "TriggerCallback::start()");
         isRunning = true;
-        std::thread triggerThread(&TriggerCallback::runTriggerThread, this);
-        triggerThread.detach();
+        mTriggerThread = std::thread(&TriggerCallback::runTriggerThread, this);
     }
 }
 
 void TriggerCallback::stop() {
     isRunning = false;
-    currentStartIdx = 0;
-    currentEndIdx = mSampleRate;
+    if (mTriggerThread.joinable()) {
+        mTriggerThread.join();
+    }
+    rkai_window_scheduler_reset(mWindowScheduler, 0);
+    rkai_decision_fusion_reset(mDecisionFusion);
 }
 
@@ -5,38 +5,97 @@
 #ifndef SMARTROBOT_TRIGGERWORD_CALLBACK_H
 #define SMARTROBOT_TRIGGERWORD_CALLBACK_H
 
+#include <atomic>
+#include <functional>
 #include <thread>
+#include <vector>
 #include "sound_recording.h"
 #include <android/asset_manager_jni.h>
 #include "rkai.h"
+#include "npu_scheduler.h"
+#include "event_recorder.h"
 
 class TriggerCallback {
 private:
     const char* TAG = "TriggerCallback:: %s";
     SoundRecording* mSoundRecording = nullptr;
+    // Rate of the shared recording, the ring indices, strides and trigger positions are in its samples
+    int mCaptureRate = 16000;
+    // Rate of the trigger word models, the windows read from the recording are decimated to it
     int mSampleRate = 8000;
+    int mDecimation = mCaptureRate / mSampleRate;
+    // Low-pass taps applied before keeping one capture sample in mDecimation
+    std::vector<float> mDecimationFilter;
     int mNumChannels = 1;
     // window size
     unsigned int mWindowKernelSize = 1; // seconds
     float mWindowStride = 0.3 ; // seconds
     float mWindowOverlap = 0.7; // seconds
 
-    int currentStartIdx = 0;
-    int currentEndIdx = mSampleRate;
+    // Longest span read at once when the windows are coalesced, in capture samples
+    int mMaxSpanSize = 3 * mCaptureRate;
 
-    int isRunning = false;
+    // Cleared by stop(), which then joins mTriggerThread before resetting the state the thread uses
+    std::atomic<bool> isRunning{false};
+    std::thread mTriggerThread;
+    // Set once the models, the cascade and the window scheduler are created, start() does nothing before
+    bool isReady = false;
     int isTriggered = 0;
+    // First sample of the utterance that triggered, -1 before the first trigger
+    int64_t mTriggerOnset = -1;
+    // Sample after the window the trigger fired on, -1 before the first trigger
+    int64_t mTriggerEnd = -1;
+    // Called from the trigger thread with mTriggerEnd on each trigger
+    std::function<void(int64_t)> mTriggerListener;
     int isNotifiedTrigger = 0;
 
+    // The conv model only runs on windows passing the bc model
+    float mBcThreshold = 0.6;
+    float mConvThreshold = 0.7;
+
     rkai_handle_t mRkaiTriggerBCHandle = nullptr;
     rkai_handle_t mRkaiTriggerConvHandle = nullptr;
-    rkai_melspectrogram_config_t mTriggerWordModelConfigBc;
-    rkai_melspectrogram_config_t mTriggerWordModelConfigConv;
-
+    rkai_trigger_word_cascade_t mTriggerWordCascade = nullptr;
+    // Skips the windows with no energy above the noise floor before the melspectrogram
+    rkai_energy_gate_t mEnergyGate = nullptr;
+    // Coarse stride in quiet audio, fine stride after the bc scores just under the threshold
+    rkai_adaptive_stride_t mStridePolicy = nullptr;
+    // Coalesces the windows the thread is late on, the gate sees all of them and the models only the newest
+    rkai_window_scheduler_t mWindowScheduler = nullptr;
+    // One debounced trigger per utterance from the conv scores of the overlapping windows
+    rkai_decision_fusion_t mDecisionFusion = nullptr;
+    // Last windows of the detector: energy, gate, cascade scores and fusion decision
+    rkai_telemetry_t mTelemetry = nullptr;
+    int mTelemetryCapacity = 1024; // windows, about 5 minutes at the normal stride
+    // Keeps the audio around the triggers and the near misses, not owned
+    EventRecorder *mEventRecorder = nullptr;
+    // Takes the steady noise out of the spectrum of the bc model, off by default
+    rkai_noise_suppressor_t mNoiseSuppressor = nullptr;
+    std::atomic<bool> isSuppressingNoise{false};
 
 
 public:
     TriggerCallback() = default;
+
+    ~TriggerCallback() {
+        stop();
+        // The thread is joined, release what it used. The cascade reads the handles and the suppressor
+        rkai_release_trigger_word_cascade(mTriggerWordCascade);
+        rkai_release_noise_suppressor(mNoiseSuppressor);
+        for (rkai_handle_t handle : {mRkaiTriggerBCHandle, mRkaiTriggerConvHandle}) {
+            if (handle != nullptr) {
+                rkai_scheduler_attach(nullptr, handle, RKAI_PRIORITY_AUDIO_CRITICAL, kTriggerWordDeadlineMs,
+                                      RKNN_NPU_CORE_AUTO);
+                rkai_release_handle(handle);
+            }
+        }
+        rkai_release_energy_gate(mEnergyGate);
+        rkai_release_adaptive_stride(mStridePolicy);
+        rkai_release_window_scheduler(mWindowScheduler);
+        rkai_release_decision_fusion(mDecisionFusion);
+        rkai_release_telemetry(mTelemetry);
+    };
+
     explicit TriggerCallback(SoundRecording* soundRecording, AAssetManager *mgr){
         mSoundRecording = soundRecording;
         mRkaiTriggerBCHandle = rkai_create_handle();
@@ -45,21 +104,108 @@ public:
         ret = rkai_init_trigger_word_android_bc_model(mRkaiTriggerBCHandle, mgr);
         if (ret != RKAI_RET_SUCCESS) {
             LOG_ERROR("Failed to init trigger word bc model");
+            return;
         }
         ret = rkai_init_trigger_word_android_conv_model(mRkaiTriggerConvHandle, mgr);
         if (ret != RKAI_RET_SUCCESS) {
             LOG_ERROR("Failed to init trigger word conv model");
+            return;
         }
-        mTriggerWordModelConfigBc = rkai_get_bc_config();
-        mTriggerWordModelConfigConv = rkai_get_conv_config();
+        rkai_scheduler_attach(getNpuScheduler(), mRkaiTriggerBCHandle, RKAI_PRIORITY_AUDIO_CRITICAL,
+                              kTriggerWordDeadlineMs, getTriggerWordCoreMask());
+        rkai_scheduler_attach(getNpuScheduler(), mRkaiTriggerConvHandle, RKAI_PRIORITY_AUDIO_CRITICAL,
+                              kTriggerWordDeadlineMs, getTriggerWordCoreMask());
+        rkai_cascade_stage_t stages[2] = {{mRkaiTriggerBCHandle,   mBcThreshold},
+                                          {mRkaiTriggerConvHandle, mConvThreshold}};
+        mTriggerWordCascade = rkai_create_trigger_word_cascade(stages, 2);
+        if (mTriggerWordCascade == nullptr) {
+            LOG_ERROR("Failed to create trigger word cascade");
+            return;
+        }
+        rkai_melspectrogram_config_t bcConfig;
+        rkai_noise_suppressor_config_t suppressorConfig;
+        if (rkai_get_trigger_word_config(mRkaiTriggerBCHandle, &bcConfig) == RKAI_RET_SUCCESS &&
+            rkai_noise_suppressor_default_config(&bcConfig, &suppressorConfig) == RKAI_RET_SUCCESS) {
+            mNoiseSuppressor = rkai_create_noise_suppressor(&suppressorConfig);
+            rkai_trigger_word_cascade_set_noise_suppressor(mTriggerWordCascade, mNoiseSuppressor);
+        }
+        // The gate sees the decimated span, at the rate of the models
+        rkai_energy_gate_config_t gateConfig;
+        rkai_energy_gate_default_config(mSampleRate, &gateConfig);
+        mEnergyGate = rkai_create_energy_gate(&gateConfig);
+        rkai_adaptive_stride_config_t strideConfig;
+        rkai_adaptive_stride_default_config(mCaptureRate, &strideConfig);
+        strideConfig.window_size = mCaptureRate * mWindowKernelSize;
+        strideConfig.normal_stride = (int) (mCaptureRate * mWindowKernelSize * mWindowStride);
+        strideConfig.threshold = mBcThreshold;
+        mStridePolicy = rkai_create_adaptive_stride(&strideConfig);
+        rkai_window_scheduler_config_t schedulerConfig;
+        schedulerConfig.sample_rate = mCaptureRate;
+        schedulerConfig.window_size = mCaptureRate * mWindowKernelSize;
+        schedulerConfig.stride = strideConfig.normal_stride;
+        schedulerConfig.buffer_size = SoundRecording::getMaxSamples();
+        schedulerConfig.policy = RKAI_LAG_POLICY_COALESCE;
+        schedulerConfig.max_lag = mCaptureRate / 2;
+        schedulerConfig.keep_every = 2;
+        schedulerConfig.max_coalesce_size = mMaxSpanSize;
+        mWindowScheduler = rkai_create_window_scheduler(&schedulerConfig);
+        if (mWindowScheduler == nullptr) {
+            LOG_ERROR("Failed to create trigger word window scheduler");
+            return;
+        }
+        rkai_fusion_config_t fusionConfig;
+        rkai_decision_fusion_default_config(mCaptureRate, &fusionConfig);
+        fusionConfig.on_threshold = mConvThreshold;
+        mDecisionFusion = rkai_create_decision_fusion(&fusionConfig, 1);
+        mTelemetry = rkai_create_telemetry(mTelemetryCapacity);
+        setUpDecimationFilter();
+        isReady = true;
     };
 
     int getIsTriggered() {
         return isTriggered;
     };
 
+    int64_t getTriggerOnset() {
+        return mTriggerOnset;
+    };
+
+    int64_t getTriggerEnd() {
+        return mTriggerEnd;
+    };
+
+    rkai_telemetry_t getTelemetry() {
+        return mTelemetry;
+    };
+
+    /**
+     * Set before start, the listener gets the capture sample after the window each trigger fired on
+     */
+    void setTriggerListener(std::function<void(int64_t)> listener) {
+        mTriggerListener = listener;
+    };
+
+    void setEventRecorder(EventRecorder *eventRecorder) {
+        mEventRecorder = eventRecorder;
+    };
+
+    /**
+     * Can be called from any thread, the noise estimate starts over from the next window
+     */
+    void setNoiseSuppression(bool isEnabled) {
+        isSuppressingNoise = isEnabled;
+    };
+
     void runTriggerThread();
 
+    void setUpDecimationFilter();
+
+    /**
+     * Low-pass and keep one sample in mDecimation, size / mDecimation samples are written. The samples before and
+     * after the span are taken as its first and last ones
+     */
+    void decimate(const float *capture, int size, float *decimated);
+
     void start();
 
     void stop();
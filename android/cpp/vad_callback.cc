@@ -2,8 +2,13 @@
 // Created by tannn on 16/01/2024.
 //
 
+#include <math.h>
 #include "logging_macros.h"
 #include "vad_callback.h"
+#include "session_recorder.h"
+
+#define VAD_MAX_FRAME_NUM 256
+#define VAD_MAX_EVENT_NUM 8
 
 void VADCallback::runVadThread() {
     // If having data in sound recording
@@ -13,55 +18,231 @@ void VADCallback::runVadThread() {
 
     float *audio_data = (float *) malloc(
             sizeof(float) * mSampleRate * mWindowKernelSize);
+    float *denoised_data = (float *) malloc(sizeof(float) * mSampleRate * mWindowKernelSize);
 
+    int stride = (int) (mSampleRate * mWindowKernelSize * mWindowStride);
+    float frameScores[VAD_MAX_FRAME_NUM];
+    rkai_vad_segment_event_t events[VAD_MAX_EVENT_NUM];
+    // A speech segment is open, as of the last segmenter event
+    int isInSegment = 0;
     while (isRunning) {
-        // TODO: Check correct condition
-        if (mSoundRecording->getLength() > 0 &&
-        currentStartIdx + mSampleRate * mWindowKernelSize < mSoundRecording->getLength()){
-            LOGD(TAG, "Running vad detection");
-            mSoundRecording->getData(audio_data, currentStartIdx, currentStartIdx + mSampleRate * mWindowKernelSize);
-            LOGD(TAG, "Done Get data from sound recording");
-            audio_input.data = audio_data;
-            audio_input.sample_rate = mSampleRate;
-            audio_input.n_channels = mNumChannels;
-            audio_input.n_seconds = mWindowKernelSize;
-            audio_input.size = mSampleRate * mWindowKernelSize;
-            audio_input.format = RKAI_AUDIO_FORMAT_FLOAT;
-
-            rkai_vad_result_t vad_result;
-            ret = rkai_vad_detect(mRkaiVadHandle, &audio_input,
-                                  mVadModelConfig, &vad_result,
-                                  0.3, 0.6);
+        int64_t handoffSample = mHandoffSample.exchange(-1);
+        if (handoffSample >= 0) {
+            applyHandoff(handoffSample);
+            isInSegment = 0;
+        }
+        bool isDenoising = isSuppressingNoise && mNoiseSuppressor != nullptr;
+        if (isDenoising != mIsDenoising) {
+            switchNoiseSuppression(isDenoising);
+        }
+        // Packets do not wait for the next window, the open segment is sent as the audio comes
+        streamPackets(audio_data, mSampleRate * mWindowKernelSize);
+        int isReady = 0;
+        rkai_scheduled_window_t window;
+        rkai_window_scheduler_poll(mWindowScheduler, mSoundRecording->getLength(), &isReady, &window);
+        if (!isReady) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        LOGD(TAG, "Running vad detection");
+        if (!mSoundRecording->getData(audio_data, window.start, window.start + window.size)) {
+            LOG_WARN("VAD window at %lld was overwritten", (long long) window.start);
+            rkai_window_scheduler_advance(mWindowScheduler, stride);
+            continue;
+        }
+        LOGD(TAG, "Done Get data from sound recording");
+        audio_input.data = audio_data;
+        audio_input.sample_rate = mSampleRate;
+        audio_input.n_channels = mNumChannels;
+        audio_input.n_seconds = mWindowKernelSize;
+        audio_input.size = mSampleRate * mWindowKernelSize;
+        audio_input.format = RKAI_AUDIO_FORMAT_FLOAT;
 
-            if (ret != RKAI_RET_SUCCESS) {
-                LOG_ERROR("Failed to detect vad");
+        rkai_telemetry_entry_t entry;
+        memset(&entry, 0, sizeof(rkai_telemetry_entry_t));
+        entry.window_index = window.start;
+        entry.energy_db = NAN;
+        entry.gate_decision = 1;
+        int frameNum = 0;
+        if (mIsDenoising) {
+            // One transform for the model input and the denoised audio of the packets
+            rkai_melspectrogram_t melspectrogram;
+            ret = rkai_audio_to_denoised_melspectrogram(&audio_input, window.start, mNoiseSuppressor,
+                                                        &melspectrogram, mVadModelConfig, denoised_data);
+            if (ret == RKAI_RET_SUCCESS) {
+                ret = rkai_vad_infer_frames(mRkaiVadHandle, &melspectrogram, frameScores, VAD_MAX_FRAME_NUM,
+                                            &frameNum);
+                rkai_audio_melspectrogram_release(&melspectrogram);
+                commitDenoised(denoised_data, window.start, audio_input.size);
             }
-
-            if (vad_result.is_speech) {
-                LOG_INFO("VAD result is speech");
-                LOG_INFO("VAD result %f\n", vad_result.conf);
+        } else {
+            ret = rkai_vad_detect_frames(mRkaiVadHandle, &audio_input, mVadModelConfig,
+                                         frameScores, VAD_MAX_FRAME_NUM, &frameNum);
+        }
+        if (ret != RKAI_RET_SUCCESS) {
+            LOG_ERROR("Failed to detect vad");
+        } else {
+            // Scores of this window alone, before the merge
+            entry.stage_num = 2;
+            for (int i = 0; i < frameNum; i++) {
+                entry.scores[0] += frameScores[i] / frameNum;
+                entry.scores[1] = std::max(entry.scores[1], frameScores[i]);
             }
-            else {
-                LOG_INFO("VAD result is not speech");
-                LOG_INFO("VAD result %f\n", vad_result.conf);
+            // The frames overlapping the previous windows are merged, the segmenter gets each frame once
+            rkai_vad_score_stream_add(mVadScoreStream, window.start / mVadModelConfig.hop_length, frameScores,
+                                      frameNum);
+            int64_t firstFrame = 0;
+            rkai_vad_score_stream_read(mVadScoreStream, frameScores, VAD_MAX_FRAME_NUM, &firstFrame, &frameNum);
+            int eventNum = 0;
+            rkai_vad_segmenter_push(mVadSegmenter, firstFrame, frameScores, frameNum, events, VAD_MAX_EVENT_NUM,
+                                    &eventNum);
+            for (int i = 0; i < eventNum; i++) {
+                rkai_packetizer_on_event(mPacketizer, &events[i]);
+                getSessionRecorder().record(RKAI_CHUNK_EVENT, SESSION_SOURCE_VAD, events[i].decision_sample,
+                                            &events[i], sizeof(rkai_vad_segment_event_t));
+                isInSegment = events[i].type == RKAI_VAD_SEGMENT_START;
+                if (events[i].type == RKAI_VAD_SEGMENT_START) {
+                    LOG_INFO("VAD speech start at sample %lld, decided at %lld",
+                             (long long) events[i].start_sample, (long long) events[i].decision_sample);
+                    if (mPendingHandoff >= 0) {
+                        LOG_INFO("VAD first segment %lld ms of audio after the handoff",
+                                 (long long) ((events[i].decision_sample - mPendingHandoff) * 1000 / mSampleRate));
+                        mPendingHandoff = -1;
+                    }
+                } else {
+                    LOG_INFO("VAD speech end, segment [%lld, %lld)%s", (long long) events[i].start_sample,
+                             (long long) events[i].end_sample, events[i].is_truncated ? " truncated" : "");
+                    // A cut segment is followed by a start in the same push, its last packet is sent before
+                    streamPackets(audio_data, mSampleRate * mWindowKernelSize);
+                }
             }
-            // Update current start index
-            currentStartIdx += mSampleRate * mWindowKernelSize * mWindowStride;
         }
+        entry.decision = isInSegment;
+        getSessionRecorder().record(RKAI_CHUNK_MODEL_OUTPUT, SESSION_SOURCE_VAD, entry.window_index, &entry,
+                                    sizeof(rkai_telemetry_entry_t));
+        rkai_telemetry_write(mTelemetry, &entry);
+        // The audio of a segment that just started is sent at once
+        streamPackets(audio_data, mSampleRate * mWindowKernelSize);
+        // Update current start index
+        rkai_window_scheduler_advance(mWindowScheduler, stride);
     }
     rkai_audio_release(&audio_input);
+    free(denoised_data);
+    rkai_noise_suppressor_stats_t suppressorStats;
+    if (mIsDenoising && rkai_noise_suppressor_get_stats(mNoiseSuppressor, &suppressorStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("VAD noise suppressor learned from %llu frames, noise at %.1f dBFS, last window %.1f dB less",
+                 (unsigned long long) suppressorStats.update_count, suppressorStats.noise_level_db,
+                 suppressorStats.reduction_db);
+        // The next start reads the recording from the beginning
+        switchNoiseSuppression(false);
+    }
+    rkai_window_scheduler_stats_t schedulerStats;
+    if (rkai_window_scheduler_get_stats(mWindowScheduler, &schedulerStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("VAD lag p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, %llu windows dropped",
+                 schedulerStats.lag_p50_ms, schedulerStats.lag_p90_ms, schedulerStats.lag_p99_ms,
+                 (unsigned long long) schedulerStats.dropped_count);
+    }
+    rkai_vad_segmenter_stats_t segmenterStats;
+    if (rkai_vad_segmenter_get_stats(mVadSegmenter, &segmenterStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("VAD %llu segments, %llu truncated, %lld speech samples",
+                 (unsigned long long) segmenterStats.segment_count,
+                 (unsigned long long) segmenterStats.truncated_count, (long long) segmenterStats.speech_samples);
+    }
+    rkai_packetizer_stats_t packetizerStats;
+    if (rkai_packetizer_get_stats(mPacketizer, &packetizerStats) == RKAI_RET_SUCCESS) {
+        LOG_INFO("VAD %llu packets, %llu dropped, %lld samples skipped",
+                 (unsigned long long) packetizerStats.packet_count,
+                 (unsigned long long) packetizerStats.dropped_count, (long long) packetizerStats.skipped_samples);
+    }
+}
+
+void VADCallback::streamPackets(float *buffer, int bufferSize) {
+    // The denoised audio is placed on the capture by its offset, none is sent before the first denoised window
+    if (mIsDenoising && mDenoisedStart < 0) {
+        return;
+    }
+    SoundRecording *recording = mIsDenoising ? &mDenoisedRecording : mSoundRecording;
+    int64_t offset = mIsDenoising ? mDenoisedStart : 0;
+    int64_t cursor = -1;
+    rkai_packetizer_get_cursor(mPacketizer, &cursor);
+    int64_t writeIndex = offset + recording->getLength();
+    while (cursor >= 0 && cursor < writeIndex) {
+        // Overwritten audio is skipped by the packetizer, so is the audio of the windows dropped when denoising
+        int64_t start = std::max<int64_t>(cursor, offset + recording->getOldestIndex());
+        int64_t end = std::min<int64_t>(writeIndex, start + bufferSize);
+        if (!recording->getData(buffer, start - offset, end - offset)) {
+            continue;
+        }
+        int packetNum = 0;
+        rkai_packetizer_produce(mPacketizer, buffer, start, (int) (end - start), &packetNum);
+        rkai_packetizer_get_cursor(mPacketizer, &cursor);
+        if (packetNum == 0) {
+            // Less than a packet left
+            break;
+        }
+    }
+}
+
+void VADCallback::commitDenoised(const float *samples, int64_t start, int size) {
+    // The last n_fft / 2 samples lack the frames after the window
+    int64_t end = start + size - mVadModelConfig.n_fft / 2;
+    int64_t denoisedEnd = mDenoisedStart + mDenoisedRecording.getLength();
+    if (mDenoisedStart < 0 || start < mDenoisedStart || start > denoisedEnd) {
+        // First window, rewind before the denoised audio on a handoff, or a gap after dropped windows
+        mDenoisedRecording.clear();
+        mDenoisedStart = start;
+        denoisedEnd = start;
+    }
+    if (end > denoisedEnd) {
+        mDenoisedRecording.write(samples + (denoisedEnd - start), (int32_t) (end - denoisedEnd));
+    }
+}
+
+void VADCallback::switchNoiseSuppression(bool isEnabled) {
+    LOG_INFO("VAD noise suppression %s", isEnabled ? "on" : "off");
+    if (mNoiseSuppressor != nullptr) {
+        rkai_noise_suppressor_reset(mNoiseSuppressor);
+    }
+    mDenoisedRecording.clear();
+    mDenoisedStart = -1;
+    mIsDenoising = isEnabled;
+}
+
+void VADCallback::applyHandoff(int64_t sample) {
+    // Start on a frame boundary, at most as far back as the recording still holds
+    int hopLength = mVadModelConfig.hop_length;
+    int64_t start = std::max<int64_t>(sample - (int64_t) (mPreRoll * mSampleRate), mSoundRecording->getOldestIndex());
+    start = std::max<int64_t>(0, start) / hopLength * hopLength;
+    LOG_INFO("VAD handoff at sample %lld, reading from %lld", (long long) sample, (long long) start);
+    // The history up to now is caught up on, not dropped for lag
+    rkai_window_scheduler_rewind(mWindowScheduler, start, mSoundRecording->getLength());
+    rkai_vad_score_stream_reset(mVadScoreStream, start / hopLength);
+    rkai_vad_segmenter_reset(mVadSegmenter, start / hopLength);
+    rkai_packetizer_reset(mPacketizer);
+    mPendingHandoff = sample;
+}
+
+void VADCallback::startFrom(int64_t sample) {
+    mHandoffSample = sample;
+    start();
 }
 
 void VADCallback::start() {
     if (!isRunning) {
         isRunning = true;
-        std::thread t(&VADCallback::runVadThread, this);
-        t.detach();
+        mVadThread = std::thread(&VADCallback::runVadThread, this);
     }
 }
 
 void VADCallback::stop() {
     isRunning = false;
-    currentStartIdx = 0;
-    currentEndIdx = mSampleRate;
+    if (mVadThread.joinable()) {
+        mVadThread.join();
+    }
+    rkai_window_scheduler_reset(mWindowScheduler, 0);
+    rkai_vad_score_stream_reset(mVadScoreStream, 0);
+    rkai_vad_segmenter_reset(mVadSegmenter, 0);
+    rkai_packetizer_reset(mPacketizer);
+    mHandoffSample = -1;
+    mPendingHandoff = -1;
 }
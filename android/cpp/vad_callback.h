@@ -5,10 +5,12 @@
 #ifndef SMARTROBOT_VAD_CALLBACK_H
 #define SMARTROBOT_VAD_CALLBACK_H
 
+#include <atomic>
 #include <thread>
 #include "sound_recording.h"
 #include <android/asset_manager_jni.h>
 #include "rkai.h"
+#include "npu_scheduler.h"
 
 class VADCallback {
 private:
@@ -21,20 +23,59 @@ private:
     unsigned int mWindowKernelSize = 1; // seconds
     float mWindowStride = 0.3; // seconds
     float mWindowOverlap = 0.7; // seconds
+    // Audio before the handoff sample given to the vad, speech starting while the trigger word was decided
+    float mPreRoll = 0.3; // seconds
 
-    int currentStartIdx = 0;
-    int currentEndIdx = mSampleRate;
+    // Capture sample to start the vad from, set by startFrom and taken by the vad thread, -1 if none
+    std::atomic<int64_t> mHandoffSample{-1};
+    // Handoff sample being served until the first speech segment starts, -1 if none
+    int64_t mPendingHandoff = -1;
 
-    int isRunning = false;
+    // Cleared by stop(), which then joins mVadThread before resetting the state the thread uses
+    std::atomic<bool> isRunning{false};
+    std::thread mVadThread;
     int isTriggered = 0;
     int isNotifiedTrigger = 0;
 
     rkai_handle_t mRkaiVadHandle = nullptr;
     rkai_melspectrogram_config_t mVadModelConfig;
+    // Only the newest window matters to the speech state, the stale ones are dropped when late
+    rkai_window_scheduler_t mWindowScheduler = nullptr;
+    // Merges the frame scores of the overlapping windows
+    rkai_vad_score_stream_t mVadScoreStream = nullptr;
+    // Turns the merged frame scores into speech segments of the capture stream
+    rkai_vad_segmenter_t mVadSegmenter = nullptr;
+    // Sends the audio of the segments in packets as soon as they start, instead of whole windows
+    rkai_packetizer_t mPacketizer = nullptr;
+    // Last windows of the detector: mean and max frame score, segment state
+    rkai_telemetry_t mTelemetry = nullptr;
+    int mTelemetryCapacity = 1024; // windows, about 5 minutes at the stride
+    // Takes the steady noise out of the windows before the model and out of the packets, off by default
+    rkai_noise_suppressor_t mNoiseSuppressor = nullptr;
+    std::atomic<bool> isSuppressingNoise{false};
+    // As of the last window of the vad thread
+    bool mIsDenoising = false;
+    // Denoised audio of the windows, its sample i is the capture sample mDenoisedStart + i, -1 before any window
+    SoundRecording mDenoisedRecording;
+    int64_t mDenoisedStart = -1;
+
+    // Produce the packets of the open segment from the audio recorded so far
+    void streamPackets(float *buffer, int bufferSize);
+
+    // Append the denoised window to mDenoisedRecording, up to the samples the next window gives better
+    void commitDenoised(const float *samples, int64_t start, int size);
+
+    // Start over the noise estimate and the denoised audio when the suppression is switched
+    void switchNoiseSuppression(bool isEnabled);
 
 public:
     VADCallback() = default;
 
+    ~VADCallback() {
+        stop();
+    };
+
+
     explicit VADCallback(SoundRecording *soundRecording, AAssetManager *mgr) {
         mSoundRecording = soundRecording;
         mRkaiVadHandle = rkai_create_handle();
@@ -43,13 +84,82 @@ public:
         if (ret != RKAI_RET_SUCCESS) {
             LOG_ERROR("Failed to init vad model");
         }
-        mVadModelConfig = rkai_get_vad_config();
+        rkai_scheduler_attach(getNpuScheduler(), mRkaiVadHandle, RKAI_PRIORITY_AUDIO, kVadDeadlineMs,
+                              getVadCoreMask());
+        rkai_get_vad_config(mRkaiVadHandle, &mVadModelConfig);
+        rkai_window_scheduler_config_t schedulerConfig;
+        schedulerConfig.sample_rate = mSampleRate;
+        schedulerConfig.window_size = mSampleRate * mWindowKernelSize;
+        schedulerConfig.stride = (int) (mSampleRate * mWindowKernelSize * mWindowStride);
+        schedulerConfig.buffer_size = SoundRecording::getMaxSamples();
+        schedulerConfig.policy = RKAI_LAG_POLICY_SKIP_TO_NEWEST;
+        schedulerConfig.max_lag = mSampleRate / 2;
+        schedulerConfig.keep_every = 2;
+        schedulerConfig.max_coalesce_size = schedulerConfig.window_size;
+        mWindowScheduler = rkai_create_window_scheduler(&schedulerConfig);
+        if (mWindowScheduler == nullptr) {
+            LOG_ERROR("Failed to create vad window scheduler");
+        }
+        rkai_vad_score_stream_config_t scoreStreamConfig;
+        rkai_vad_score_stream_default_config(&mVadModelConfig, &scoreStreamConfig);
+        mVadScoreStream = rkai_create_vad_score_stream(&scoreStreamConfig);
+        if (mVadScoreStream == nullptr) {
+            LOG_ERROR("Failed to create vad score stream");
+        }
+        rkai_vad_segmenter_config_t segmenterConfig;
+        rkai_vad_segmenter_default_config(mSampleRate, mVadModelConfig.hop_length, &segmenterConfig);
+        mVadSegmenter = rkai_create_vad_segmenter(&segmenterConfig);
+        if (mVadSegmenter == nullptr) {
+            LOG_ERROR("Failed to create vad segmenter");
+        }
+        rkai_packetizer_config_t packetizerConfig;
+        rkai_packetizer_default_config(mSampleRate, &packetizerConfig);
+        mPacketizer = rkai_create_packetizer(&packetizerConfig);
+        if (mPacketizer == nullptr) {
+            LOG_ERROR("Failed to create vad packetizer");
+        }
+        rkai_noise_suppressor_config_t suppressorConfig;
+        if (rkai_noise_suppressor_default_config(&mVadModelConfig, &suppressorConfig) == RKAI_RET_SUCCESS) {
+            mNoiseSuppressor = rkai_create_noise_suppressor(&suppressorConfig);
+        }
+        mTelemetry = rkai_create_telemetry(mTelemetryCapacity);
     };
 
     void runVadThread();
 
+    void applyHandoff(int64_t sample);
+
     void start();
 
+    /**
+     * Run the vad from mPreRoll before a capture sample, e.g. the end of the trigger word, from the audio already
+     * recorded. The vad thread is started if it is not running
+     */
+    void startFrom(int64_t sample);
+
+    void setPreRoll(float seconds) {
+        mPreRoll = seconds;
+    };
+
+    /**
+     * Can be called from any thread, from the next window the model and the packets get the denoised audio. The
+     * packets then wait for the windows, up to a stride and n_fft / 2 samples more
+     */
+    void setNoiseSuppression(bool isEnabled) {
+        isSuppressingNoise = isEnabled;
+    };
+
     void stop();
+
+    /**
+     * Packets of the speech segments, drained by a consumer thread with rkai_packetizer_poll
+     */
+    rkai_packetizer_t getPacketizer() const {
+        return mPacketizer;
+    };
+
+    rkai_telemetry_t getTelemetry() const {
+        return mTelemetry;
+    };
 };
 #endif //SMARTROBOT_VAD_CALLBACK_H
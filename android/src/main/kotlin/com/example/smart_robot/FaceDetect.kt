@@ -20,5 +20,32 @@ class FaceDetect {
 
     external fun initModel(assetManager: AssetManager)
 
+    /**
+     * Faces of one image, waiting for them. Nothing else is in flight, so a camera stream goes faster through
+     * [submitFrame] and [collectFaces]
+     */
     external fun detectModel(bitmap: Bitmap): Array<Obj>
+
+    /**
+     * Queue a camera frame for detection and return at once with its id, -1 on failure. The frame is preprocessed
+     * while the previous ones are on the NPU. Every submitted frame must be collected with [collectFaces]
+     *
+     * ```
+     * val id = faceDetect.submitFrame(frame)
+     * val faces = faceDetect.collectFaces(previousId, -1)
+     * previousId = id
+     * ```
+     */
+    external fun submitFrame(bitmap: Bitmap): Long
+
+    /**
+     * Faces of a submitted frame, waiting up to [timeoutMs] for them, forever if negative. Null if they did not come
+     * in time, the frame can then be collected again
+     */
+    external fun collectFaces(frameId: Long, timeoutMs: Int): Array<Obj>?
+
+    /**
+     * Stop the detection threads and free the model. Must not be called while a detection runs
+     */
+    external fun releaseModel()
 }
@@ -117,12 +117,14 @@ class SmartRobotPlugin : FlutterPlugin, MethodCallHandler, EventChannel.StreamHa
 
         voiceActivityDetectionFlow.addListener(object: VoiceActivityEventListener() {
             override fun onFirstVADDetected(segment: FloatArray) {
+                // Converted on the recording thread, the main thread only sends the bytes
+                val audioSegment = AudioUtils.pcmFloatTo16Bytes(segment, VoiceActivityDetectionFlow.SAMPLE_RATE)
                 // Sending event to flutter are marked with @UiThread so it must be called from the main thread
                 GlobalScope.launch(Dispatchers.Main) {
                     eventSink?.success(
                         AudioEvent.vadRecording(
                             RecordedSegment(
-                                AudioUtils.shortArrayToByteArray(AudioUtils.pcmFloatTo16(segment)),
+                                audioSegment,
                                 RecordedSegment.Type.FIRST
                             )
                         )
@@ -131,11 +133,12 @@ class SmartRobotPlugin : FlutterPlugin, MethodCallHandler, EventChannel.StreamHa
             }
 
             override fun onVADDetected(segment: FloatArray) {
+                val audioSegment = AudioUtils.pcmFloatTo16Bytes(segment, VoiceActivityDetectionFlow.SAMPLE_RATE)
                 // Sending event to flutter are marked with @UiThread so it must be called from the main thread
                 GlobalScope.launch(Dispatchers.Main) {
                     eventSink?.success(AudioEvent.vadRecording(
                         RecordedSegment(
-                            AudioUtils.shortArrayToByteArray(AudioUtils.pcmFloatTo16(segment)),
+                            audioSegment,
                             RecordedSegment.Type.CONTINUE
                         )
                     ))
@@ -238,6 +241,7 @@ class SmartRobotPlugin : FlutterPlugin, MethodCallHandler, EventChannel.StreamHa
         triggerWordAudioRecord?.release()
         voiceActivityDetectionFlow.clearListeners()
         triggerWordDetectionFlow.clearListeners()
+        triggerWordDetectionFlow.release()
     }
 
     private fun decodeUri(selectedImage: Uri): Bitmap {
@@ -7,14 +7,41 @@ class TriggerWord {
         var score = 0f
         var passLowThreshold = false
         var passHighThreshold = false
+        var stageCount = 0
+        var isTriggered = false
     }
 
+    // Native detection state of this object: the models, the cascade, the noise floor gate and the fusion.
+    // Set by initModel, freed by release
+    private var nativeHandle = 0L
+
     external fun initModel(assetManager: AssetManager)
 
+    /**
+     * Free the native state of [initModel], the detections return null afterwards.
+     * Must not be called while a detection of this object runs
+     */
+    external fun release()
+
     external fun bcModelDetect(buffer: FloatArray?): Obj?
 
     external fun convModelDetect(buffer: FloatArray?): Obj?
 
+    /**
+     * Run the BC model, then the Conv model only if the BC score is higher than [bcThreshold].
+     * passHighThreshold is true when both models pass, stageCount is the number of models run.
+     * Windows with no energy above the tracked noise floor are skipped with stageCount 0,
+     * [newSampleCount] is the number of samples at the end of [buffer] not given to the previous call.
+     * isTriggered is set once per utterance, when the conv scores smoothed over the last windows
+     * reach [convThreshold]. It re-arms once they drop 0.2 under it and a refractory period is over.
+     */
+    external fun cascadeDetect(buffer: FloatArray?, newSampleCount: Int, bcThreshold: Float, convThreshold: Float): Obj?
+
+    /**
+     * Ratio of the windows skipped by the noise floor gate of [cascadeDetect]
+     */
+    external fun gateSkipRate(): Float
+
 
     companion object {
         init {
@@ -1,5 +1,6 @@
 package com.example.smart_robot
 import android.content.res.AssetManager
+import java.nio.ByteBuffer
 
 
 class VAD {
@@ -15,6 +16,15 @@ class VAD {
         init {
             System.loadLibrary("smartrobot")
         }
+
+        /**
+         * Convert [samples] to clipped little-endian PCM16 into the direct [output] buffer, after a wav header
+         * if [wavHeader], with one LSB of triangular dither if [dither].
+         * @return the number of bytes written, -1 if [output] is not direct or too small
+         */
+        @JvmStatic
+        external fun encodePcm16(samples: FloatArray, sampleRate: Int, output: ByteBuffer,
+                                 wavHeader: Boolean, dither: Boolean): Int
     }
 }
 
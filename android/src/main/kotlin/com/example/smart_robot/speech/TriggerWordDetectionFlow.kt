@@ -9,8 +9,6 @@ import com.example.smart_robot.AudioWriter
 import com.example.smart_robot.TriggerWord
 import com.example.smart_robot.common.EventEmitter
 import com.example.smart_robot.io.audio.AudioRecordingForAIModel
-import kotlin.math.abs
-import kotlin.math.log10
 
 class TriggerWordDetectionFlow private constructor(
     private val context: Context,
@@ -54,9 +52,13 @@ class TriggerWordDetectionFlow private constructor(
     /**
      * Initialize the trigger word detection model
      */
+    @Synchronized
     fun initModel() {
         // Load the model
         try {
+            if (::triggerWord.isInitialized) {
+                triggerWord.release()
+            }
             triggerWord = TriggerWord().apply {
                 initModel(assetManager)
             }
@@ -66,17 +68,12 @@ class TriggerWordDetectionFlow private constructor(
     }
 
     /**
-     * Detect the trigger word using the BC model
-     */
-    private fun detectBCModel(buffer: FloatArray?): TriggerWord.Obj? {
-        return triggerWord.bcModelDetect(buffer)
-    }
-
-    /**
-     * Detect the trigger word using the Conv model
+     * Detect the trigger word using the BC model then the Conv model, in one native call.
+     * The windows are detected on coroutines that may still run after stop, so the model is not released under them
      */
-    private fun detectConvModel(buffer: FloatArray?): TriggerWord.Obj? {
-        return triggerWord.convModelDetect(buffer)
+    @Synchronized
+    private fun detectCascade(buffer: FloatArray?): TriggerWord.Obj? {
+        return triggerWord.cascadeDetect(buffer, SAMPLE_WINDOW_STRIDE, bcThreshold, convThreshold)
     }
 
     /**
@@ -85,27 +82,22 @@ class TriggerWordDetectionFlow private constructor(
      */
     // TODO: Implement the double-threshold technique to improve the trigger word detection
     private fun isTriggerWord(buffer: FloatArray): TriggerWord.Obj? {
-        // Calculate the dB of the buffer, if the dB is less than the silence threshold, not process the buffer
-        val db = 20 * log10(buffer.maxOf { abs(it) })
-        if (db < SILENCE_THRESHOLD) {
-            return null
-        }
-
-        detectBCModel(buffer)?.also {bcResult ->
-            Log.d(TAG, "BC score: ${bcResult.score}")
-            if (SAVE_FILE_FOR_DEBUG && bcResult.score > 0.5) {
+        // Silent windows are skipped natively, against the noise floor, before the melspectrogram
+        detectCascade(buffer)?.also {result ->
+            if (result.stageCount == 0) {
+                return null
+            }
+            Log.d(TAG, "Cascade score: ${result.score}, models run: ${result.stageCount}")
+            // Windows passing the BC model
+            if (SAVE_FILE_FOR_DEBUG && result.passLowThreshold) {
                 val audioWriter = AudioWriter()
-                val filePath = context.filesDir.absolutePath + "/" + System.currentTimeMillis() + "_" + bcResult.score + ".wav"
+                val filePath = context.filesDir.absolutePath + "/" + System.currentTimeMillis() + "_" + result.score + ".wav"
                 Log.d(TAG, "Writing audio to $filePath")
                 audioWriter.writeWavFile(filePath, SAMPLE_RATE, buffer)
             }
-            if (bcResult.score > bcThreshold) {
-                detectConvModel(buffer)?.also {convResult ->
-                    Log.d(TAG, "Conv score: ${convResult.score}")
-                    if (convResult.score > convThreshold) {
-                        return convResult
-                    }
-                }
+            // One trigger per utterance, the overlapping windows of the same utterance are debounced natively
+            if (result.isTriggered) {
+                return result
             }
         }
 
@@ -143,6 +135,19 @@ class TriggerWordDetectionFlow private constructor(
         }
     }
 
+    /**
+     * Stop listening and free the native state of the model, [initModel] loads it again
+     */
+    @Synchronized
+    fun release() {
+        if (audioRecorder.isRecording) {
+            stop()
+        }
+        if (::triggerWord.isInitialized) {
+            triggerWord.release()
+        }
+    }
+
     companion object {
         @JvmField val TAG: String = TriggerWordDetectionFlow::class.java.simpleName
         const val SAMPLE_RATE = 8000 // Hz
@@ -152,7 +157,6 @@ class TriggerWordDetectionFlow private constructor(
         const val SAMPLE_WINDOW_STRIDE = (WINDOW_STRIDE * SAMPLE_RATE).toInt()
         const val SAMPLE_CHANNELS = AudioFormat.CHANNEL_IN_MONO
         const val SAMPLE_ENCODING = AudioFormat.ENCODING_PCM_FLOAT
-        const val SILENCE_THRESHOLD = -25.0 // dB
         const val SAVE_FILE_FOR_DEBUG = false
 
         // Singleton pattern
@@ -1,5 +1,6 @@
 package com.example.smart_robot.utils
 
+import com.example.smart_robot.VAD
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
 
@@ -31,6 +32,32 @@ class AudioUtils {
             return shorts
         }
 
+        // Reused by each thread for the native conversion, grown as needed
+        private val pcm16Buffer = ThreadLocal<ByteBuffer>()
+
+        /**
+         * Convert PCM float to little-endian PCM 16-bit bytes natively, clipped and dithered
+         * @param pcm PCM float
+         * @param sampleRate Sample rate of the audio, written in the wav header
+         * @param wavHeader Write a wav header before the samples
+         * @return PCM 16-bit bytes
+         */
+        fun pcmFloatTo16Bytes(pcm: FloatArray, sampleRate: Int, wavHeader: Boolean = false): ByteArray {
+            val size = pcm.size * 2 + if (wavHeader) WAV_HEADER_SIZE else 0
+            var buffer = pcm16Buffer.get()
+            if (buffer == null || buffer.capacity() < size) {
+                buffer = ByteBuffer.allocateDirect(size)
+                pcm16Buffer.set(buffer)
+            }
+            val written = VAD.encodePcm16(pcm, sampleRate, buffer!!, wavHeader, true)
+            val bytes = ByteArray(maxOf(written, 0))
+            buffer.clear()
+            buffer.get(bytes)
+            return bytes
+        }
+
+        private const val WAV_HEADER_SIZE = 44
+
         /**
          * Convert short array to byte array
          * @param shortArray Short array